@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMergeBenchmark.cpp
+ * Compare the HTPMerger kernels against a DmxBuffer::HTPMerge loop.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/dmx/HTPMerger.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::HTPMerger;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(sources, s, 10, "The number of sources to merge");
+DEFINE_s_uint32(iterations, i, 200000, "The number of merges to run");
+
+/*
+ * Print the result of a run.
+ */
+void Report(const char *name, const TimeInterval &duration,
+            unsigned int iterations) {
+  double usec = static_cast<double>(duration.AsInt());
+  cout << std::setw(24) << std::left << name << " "
+       << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+       << (usec * 1000.0 / iterations) << " ns/merge, "
+       << std::setw(10) << (iterations * 1000000.0 / usec) << " merges/s"
+       << endl;
+}
+
+/*
+ * The previous Universe::MergeAll behaviour, copy each source and then merge
+ * them one at a time.
+ */
+void RunDmxBufferMerge(const vector<DmxBuffer> &sources,
+                       unsigned int iterations, DmxBuffer *output) {
+  for (unsigned int i = 0; i < iterations; i++) {
+    vector<DmxBuffer> active_sources;
+    vector<DmxBuffer>::const_iterator iter = sources.begin();
+    for (; iter != sources.end(); ++iter) {
+      active_sources.push_back(*iter);
+    }
+
+    output->Reset();
+    for (iter = active_sources.begin(); iter != active_sources.end(); ++iter) {
+      output->HTPMerge(*iter);
+    }
+  }
+}
+
+void RunHTPMerger(HTPMerger *merger, const vector<DmxBuffer> &sources,
+                  unsigned int iterations, DmxBuffer *output) {
+  for (unsigned int i = 0; i < iterations; i++) {
+    merger->Reset();
+    vector<DmxBuffer>::const_iterator iter = sources.begin();
+    for (; iter != sources.end(); ++iter) {
+      merger->AddSource(*iter);
+    }
+    merger->Merge(output);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark HTP merging of full universes.");
+
+  const unsigned int iterations = FLAGS_iterations;
+  if (FLAGS_sources < 2 || iterations == 0) {
+    cout << "Need at least 2 sources and 1 iteration" << endl;
+    return 1;
+  }
+
+  vector<DmxBuffer> sources;
+  for (unsigned int i = 0; i < FLAGS_sources; i++) {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    for (unsigned int j = 0; j < ola::DMX_UNIVERSE_SIZE; j++) {
+      data[j] = rand() % 256;
+    }
+    sources.push_back(DmxBuffer(data, ola::DMX_UNIVERSE_SIZE));
+  }
+
+  cout << "Merging " << sources.size() << " sources, " << iterations
+       << " iterations" << endl;
+
+  Clock clock;
+  TimeStamp start, end;
+  DmxBuffer reference;
+
+  clock.CurrentTime(&start);
+  RunDmxBufferMerge(sources, iterations, &reference);
+  clock.CurrentTime(&end);
+  Report("DmxBuffer::HTPMerge", end - start, iterations);
+
+  const HTPMerger::Kernel kernels[] = {
+    HTPMerger::SCALAR_KERNEL,
+    HTPMerger::SSE2_KERNEL,
+    HTPMerger::AVX2_KERNEL,
+    HTPMerger::NEON_KERNEL,
+  };
+
+  for (unsigned int i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+    if (!HTPMerger::KernelSupported(kernels[i])) {
+      continue;
+    }
+    HTPMerger merger(kernels[i]);
+    DmxBuffer output;
+
+    clock.CurrentTime(&start);
+    RunHTPMerger(&merger, sources, iterations, &output);
+    clock.CurrentTime(&end);
+    std::string name = std::string("HTPMerger (") +
+        HTPMerger::KernelName(kernels[i]) + ")";
+    Report(name.c_str(), end - start, iterations);
+
+    if (output != reference) {
+      cout << "  Output mismatch!" << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
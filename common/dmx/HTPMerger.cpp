@@ -0,0 +1,287 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMerger.cpp
+ * Merge many DMX sources using Highest Takes Precedence in a single pass.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Each kernel walks the universe in blocks of 16 or 32 slots. For each block
+ * the maximum across all sources is accumulated in a register and then
+ * written to the output once. Sources that end part way through a block are
+ * zero padded, which matches DmxBuffer::HTPMerge() where the missing slots
+ * don't contribute to the result.
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/HTPMerger.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#if defined(__SSE2__)
+#define OLA_HTP_SSE2 1
+#include <emmintrin.h>
+#endif  // __SSE2__
+#if defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define OLA_HTP_AVX2 1
+#include <immintrin.h>
+#endif  // gcc >= 4.9
+#endif  // __GNUC__ && x86
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OLA_HTP_NEON 1
+#include <arm_neon.h>
+#endif  // __ARM_NEON
+
+namespace ola {
+namespace dmx {
+
+using std::max;
+
+namespace {
+
+/*
+ * Return the number of slots in the merged output.
+ */
+unsigned int MergedLength(const unsigned int *lengths, unsigned int count) {
+  unsigned int length = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    length = max(length, lengths[i]);
+  }
+  return std::min(length, static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+}
+
+/*
+ * Copy the tail of a source into a zero filled block.
+ */
+inline const uint8_t *PadBlock(const uint8_t *data, unsigned int length,
+                               unsigned int offset, uint8_t *block,
+                               unsigned int block_size) {
+  memset(block, 0, block_size);
+  memcpy(block, data + offset, length - offset);
+  return block;
+}
+
+unsigned int ScalarMerge(const uint8_t *const *sources,
+                         const unsigned int *lengths,
+                         unsigned int count,
+                         uint8_t *output) {
+  const unsigned int length = MergedLength(lengths, count);
+  memset(output, 0, length);
+  for (unsigned int i = 0; i < count; i++) {
+    const uint8_t *data = sources[i];
+    const unsigned int source_length = std::min(lengths[i], length);
+    for (unsigned int slot = 0; slot < source_length; slot++) {
+      output[slot] = max(output[slot], data[slot]);
+    }
+  }
+  return length;
+}
+
+#ifdef OLA_HTP_SSE2
+unsigned int SSE2Merge(const uint8_t *const *sources,
+                       const unsigned int *lengths,
+                       unsigned int count,
+                       uint8_t *output) {
+  static const unsigned int BLOCK_SIZE = 16;
+  const unsigned int length = MergedLength(lengths, count);
+  uint8_t block[BLOCK_SIZE];
+
+  for (unsigned int offset = 0; offset < length; offset += BLOCK_SIZE) {
+    __m128i acc = _mm_setzero_si128();
+    for (unsigned int i = 0; i < count; i++) {
+      const uint8_t *data;
+      if (lengths[i] >= offset + BLOCK_SIZE) {
+        data = sources[i] + offset;
+      } else if (lengths[i] > offset) {
+        data = PadBlock(sources[i], lengths[i], offset, block, BLOCK_SIZE);
+      } else {
+        continue;
+      }
+      acc = _mm_max_epu8(
+          acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset), acc);
+  }
+  return length;
+}
+#endif  // OLA_HTP_SSE2
+
+#ifdef OLA_HTP_AVX2
+__attribute__((target("avx2")))
+unsigned int AVX2Merge(const uint8_t *const *sources,
+                       const unsigned int *lengths,
+                       unsigned int count,
+                       uint8_t *output) {
+  static const unsigned int BLOCK_SIZE = 32;
+  const unsigned int length = MergedLength(lengths, count);
+  uint8_t block[BLOCK_SIZE];
+
+  for (unsigned int offset = 0; offset < length; offset += BLOCK_SIZE) {
+    __m256i acc = _mm256_setzero_si256();
+    for (unsigned int i = 0; i < count; i++) {
+      const uint8_t *data;
+      if (lengths[i] >= offset + BLOCK_SIZE) {
+        data = sources[i] + offset;
+      } else if (lengths[i] > offset) {
+        data = PadBlock(sources[i], lengths[i], offset, block, BLOCK_SIZE);
+      } else {
+        continue;
+      }
+      acc = _mm256_max_epu8(
+          acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + offset), acc);
+  }
+  return length;
+}
+#endif  // OLA_HTP_AVX2
+
+#ifdef OLA_HTP_NEON
+unsigned int NEONMerge(const uint8_t *const *sources,
+                       const unsigned int *lengths,
+                       unsigned int count,
+                       uint8_t *output) {
+  static const unsigned int BLOCK_SIZE = 16;
+  const unsigned int length = MergedLength(lengths, count);
+  uint8_t block[BLOCK_SIZE];
+
+  for (unsigned int offset = 0; offset < length; offset += BLOCK_SIZE) {
+    uint8x16_t acc = vdupq_n_u8(0);
+    for (unsigned int i = 0; i < count; i++) {
+      const uint8_t *data;
+      if (lengths[i] >= offset + BLOCK_SIZE) {
+        data = sources[i] + offset;
+      } else if (lengths[i] > offset) {
+        data = PadBlock(sources[i], lengths[i], offset, block, BLOCK_SIZE);
+      } else {
+        continue;
+      }
+      acc = vmaxq_u8(acc, vld1q_u8(data));
+    }
+    vst1q_u8(output + offset, acc);
+  }
+  return length;
+}
+#endif  // OLA_HTP_NEON
+}  // namespace
+
+
+HTPMerger::HTPMerger()
+    : m_kernel(BestKernel()) {
+}
+
+HTPMerger::HTPMerger(Kernel kernel)
+    : m_kernel(KernelSupported(kernel) ? kernel : BestKernel()) {
+}
+
+void HTPMerger::AddSource(const DmxBuffer &buffer) {
+  if (!buffer.Size()) {
+    return;
+  }
+  m_source_data.push_back(buffer.GetRaw());
+  m_source_lengths.push_back(buffer.Size());
+}
+
+bool HTPMerger::Merge(DmxBuffer *output) const {
+  if (m_source_data.empty()) {
+    return false;
+  }
+
+  if (m_source_data.size() == 1) {
+    return output->Set(m_source_data[0], m_source_lengths[0]);
+  }
+
+  uint8_t merged[DMX_UNIVERSE_SIZE];
+  unsigned int length = MergeSlots(m_kernel, &m_source_data[0],
+                                   &m_source_lengths[0], m_source_data.size(),
+                                   merged);
+  return output->Set(merged, length);
+}
+
+unsigned int HTPMerger::MergeSlots(Kernel kernel,
+                                   const uint8_t *const *sources,
+                                   const unsigned int *lengths,
+                                   unsigned int count,
+                                   uint8_t *output) {
+  switch (kernel) {
+#ifdef OLA_HTP_SSE2
+    case SSE2_KERNEL:
+      return SSE2Merge(sources, lengths, count, output);
+#endif  // OLA_HTP_SSE2
+#ifdef OLA_HTP_AVX2
+    case AVX2_KERNEL:
+      return AVX2Merge(sources, lengths, count, output);
+#endif  // OLA_HTP_AVX2
+#ifdef OLA_HTP_NEON
+    case NEON_KERNEL:
+      return NEONMerge(sources, lengths, count, output);
+#endif  // OLA_HTP_NEON
+    default:
+      return ScalarMerge(sources, lengths, count, output);
+  }
+}
+
+bool HTPMerger::KernelSupported(Kernel kernel) {
+  switch (kernel) {
+    case SCALAR_KERNEL:
+      return true;
+#ifdef OLA_HTP_SSE2
+    case SSE2_KERNEL:
+      return true;
+#endif  // OLA_HTP_SSE2
+#ifdef OLA_HTP_AVX2
+    case AVX2_KERNEL:
+      return __builtin_cpu_supports("avx2");
+#endif  // OLA_HTP_AVX2
+#ifdef OLA_HTP_NEON
+    case NEON_KERNEL:
+      return true;
+#endif  // OLA_HTP_NEON
+    default:
+      return false;
+  }
+}
+
+HTPMerger::Kernel HTPMerger::BestKernel() {
+  static const Kernel kernels[] = {
+    AVX2_KERNEL, SSE2_KERNEL, NEON_KERNEL
+  };
+  for (unsigned int i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+    if (KernelSupported(kernels[i])) {
+      return kernels[i];
+    }
+  }
+  return SCALAR_KERNEL;
+}
+
+const char *HTPMerger::KernelName(Kernel kernel) {
+  switch (kernel) {
+    case SSE2_KERNEL:
+      return "sse2";
+    case AVX2_KERNEL:
+      return "avx2";
+    case NEON_KERNEL:
+      return "neon";
+    case SCALAR_KERNEL:
+    default:
+      return "scalar";
+  }
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,167 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMergerTest.cpp
+ * Test fixture for the HTPMerger class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/HTPMerger.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::HTPMerger;
+using std::string;
+using std::vector;
+
+class HTPMergerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HTPMergerTest);
+  CPPUNIT_TEST(testNoSources);
+  CPPUNIT_TEST(testSingleSource);
+  CPPUNIT_TEST(testMerge);
+  CPPUNIT_TEST(testKernelsMatchDmxBuffer);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testNoSources();
+    void testSingleSource();
+    void testMerge();
+    void testKernelsMatchDmxBuffer();
+
+ private:
+    void checkKernel(HTPMerger::Kernel kernel,
+                     const vector<DmxBuffer> &sources);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTPMergerTest);
+
+
+/*
+ * Check that merging nothing fails and leaves the output alone.
+ */
+void HTPMergerTest::testNoSources() {
+  HTPMerger merger;
+  DmxBuffer output;
+  output.SetFromString("1,2,3");
+  OLA_ASSERT_EQ(0u, merger.SourceCount());
+  OLA_ASSERT_FALSE(merger.Merge(&output));
+  OLA_ASSERT_EQ(string("1,2,3"), output.ToString());
+
+  // empty buffers are ignored
+  DmxBuffer empty;
+  merger.AddSource(empty);
+  OLA_ASSERT_EQ(0u, merger.SourceCount());
+  OLA_ASSERT_FALSE(merger.Merge(&output));
+}
+
+
+/*
+ * Check a single source is copied as is.
+ */
+void HTPMergerTest::testSingleSource() {
+  HTPMerger merger;
+  DmxBuffer source, output;
+  source.SetFromString("10,0,255,3");
+  merger.AddSource(source);
+  OLA_ASSERT_TRUE(merger.Merge(&output));
+  OLA_ASSERT_EQ(source, output);
+}
+
+
+/*
+ * Check merging sources of differing lengths.
+ */
+void HTPMergerTest::testMerge() {
+  DmxBuffer source1, source2, source3, output;
+  source1.SetFromString("1,2,3,4,5");
+  source2.SetFromString("9,8,7,6,5,4,3,2,1");
+  source3.SetFromString("10,11,12");
+
+  HTPMerger merger;
+  merger.AddSource(source1);
+  merger.AddSource(source2);
+  merger.AddSource(source3);
+  OLA_ASSERT_EQ(3u, merger.SourceCount());
+  OLA_ASSERT_TRUE(merger.Merge(&output));
+  OLA_ASSERT_EQ(string("10,11,12,6,5,4,3,2,1"), output.ToString());
+
+  // Reset and merge again, the output should only have the new sources.
+  merger.Reset();
+  OLA_ASSERT_EQ(0u, merger.SourceCount());
+  merger.AddSource(source1);
+  merger.AddSource(source3);
+  OLA_ASSERT_TRUE(merger.Merge(&output));
+  OLA_ASSERT_EQ(string("10,11,12,4,5"), output.ToString());
+}
+
+
+/*
+ * Check that every supported kernel produces the same result as
+ * DmxBuffer::HTPMerge, including for lengths that don't fill a vector.
+ */
+void HTPMergerTest::testKernelsMatchDmxBuffer() {
+  const unsigned int lengths[] = {
+    1, 15, 16, 17, 31, 32, 33, 100, 170, 255, 500, 511, 512
+  };
+  const unsigned int length_count = sizeof(lengths) / sizeof(lengths[0]);
+
+  srand(42);
+  for (unsigned int source_count = 2; source_count <= 12; source_count++) {
+    vector<DmxBuffer> sources;
+    for (unsigned int i = 0; i < source_count; i++) {
+      uint8_t data[ola::DMX_UNIVERSE_SIZE];
+      unsigned int length = lengths[(source_count + i) % length_count];
+      for (unsigned int j = 0; j < length; j++) {
+        data[j] = rand() % 256;
+      }
+      sources.push_back(DmxBuffer(data, length));
+    }
+
+    checkKernel(HTPMerger::SCALAR_KERNEL, sources);
+    checkKernel(HTPMerger::SSE2_KERNEL, sources);
+    checkKernel(HTPMerger::AVX2_KERNEL, sources);
+    checkKernel(HTPMerger::NEON_KERNEL, sources);
+  }
+}
+
+
+void HTPMergerTest::checkKernel(HTPMerger::Kernel kernel,
+                                const vector<DmxBuffer> &sources) {
+  if (!HTPMerger::KernelSupported(kernel)) {
+    return;
+  }
+
+  DmxBuffer expected;
+  HTPMerger merger(kernel);
+  OLA_ASSERT_EQ(kernel, merger.ActiveKernel());
+
+  vector<DmxBuffer>::const_iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    expected.HTPMerge(*iter);
+    merger.AddSource(*iter);
+  }
+
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(merger.Merge(&output));
+  OLA_ASSERT_EQ_MSG(expected, output, HTPMerger::KernelName(kernel));
+}
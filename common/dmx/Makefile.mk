@@ -1,11 +1,40 @@
 # LIBRARIES
 ##################################################
-common_libolacommon_la_SOURCES += common/dmx/RunLengthEncoder.cpp
+common_libolacommon_la_SOURCES += \
+    common/dmx/HTPMerger.cpp \
+    common/dmx/RunLengthEncoder.cpp \
+    common/dmx/SharedDmx.cpp \
+    common/dmx/SharedDmx.h
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/dmx/htp_merge_benchmark \
+                   common/dmx/shared_dmx_benchmark
+
+common_dmx_htp_merge_benchmark_SOURCES = common/dmx/HTPMergeBenchmark.cpp
+common_dmx_htp_merge_benchmark_LDADD = common/libolacommon.la
+
+common_dmx_shared_dmx_benchmark_SOURCES = common/dmx/SharedDmxBenchmark.cpp
+# required, otherwise we get build errors
+common_dmx_shared_dmx_benchmark_CXXFLAGS = $(COMMON_CXXFLAGS_ONLY_WARNINGS)
+common_dmx_shared_dmx_benchmark_LDADD = common/libolacommon.la \
+                                        $(libprotobuf_LIBS)
 
 # TESTS
 ##################################################
-test_programs += common/dmx/RunLengthEncoderTester
+test_programs += \
+    common/dmx/HTPMergerTester \
+    common/dmx/RunLengthEncoderTester \
+    common/dmx/SharedDmxTester
+
+common_dmx_HTPMergerTester_SOURCES = common/dmx/HTPMergerTest.cpp
+common_dmx_HTPMergerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_HTPMergerTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_dmx_RunLengthEncoderTester_SOURCES = common/dmx/RunLengthEncoderTest.cpp
 common_dmx_RunLengthEncoderTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_dmx_RunLengthEncoderTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_SharedDmxTester_SOURCES = common/dmx/SharedDmxTest.cpp
+common_dmx_SharedDmxTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_SharedDmxTester_LDADD = $(COMMON_TESTING_LIBS)
@@ -0,0 +1,635 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmx.cpp
+ * Pass DMX data between processes on the same host using shared memory.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The region is a header followed by SlotCount() fixed size slots:
+ *
+ *   header: magic, version, slot count, slot size
+ *   slot:   sequence, universe, length, priority, data[512]
+ *
+ * Each slot is a sequence lock. The writer makes the sequence number odd,
+ * updates the slot and then makes it even again. The reader copies the slot
+ * and retries if the sequence number was odd or changed during the copy.
+ *
+ * The memfd is sealed so that it can't be shrunk, otherwise the writer could
+ * cause the reader to fault by truncating it.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+
+#if defined(HAVE_MEMFD_CREATE) && defined(HAVE_SYS_EVENTFD_H) && \
+    defined(F_ADD_SEALS)
+#define OLA_SHARED_DMX 1
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif  // HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H && F_ADD_SEALS
+
+#include "common/dmx/SharedDmx.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/io/Descriptor.h"
+
+namespace ola {
+namespace dmx {
+
+using ola::io::UnmanagedFileDescriptor;
+using std::string;
+
+#ifdef OLA_SHARED_DMX
+namespace {
+
+const uint32_t REGION_MAGIC = 0x4f4c4144;  // OLAD
+const uint32_t REGION_VERSION = 1;
+const unsigned int HEADER_SIZE = 64;
+const unsigned int SLOT_SIZE = 576;  // sizeof(Slot) rounded to a cache line
+const unsigned int READ_ATTEMPTS = 4;
+
+struct RegionHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+};
+
+struct Slot {
+  uint32_t sequence;
+  uint32_t universe;
+  uint16_t length;
+  uint8_t priority;
+  uint8_t reserved;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+#ifdef __ATOMIC_ACQUIRE
+inline uint32_t LoadSequence(const uint32_t *sequence) {
+  return __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+}
+
+inline void StoreSequence(uint32_t *sequence, uint32_t value) {
+  __atomic_store_n(sequence, value, __ATOMIC_RELEASE);
+}
+
+inline void ReadFence() {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+inline void WriteFence() {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+#else
+inline uint32_t LoadSequence(const uint32_t *sequence) {
+  uint32_t value = *const_cast<const volatile uint32_t*>(sequence);
+  __sync_synchronize();
+  return value;
+}
+
+inline void StoreSequence(uint32_t *sequence, uint32_t value) {
+  __sync_synchronize();
+  *const_cast<volatile uint32_t*>(sequence) = value;
+}
+
+inline void ReadFence() {
+  __sync_synchronize();
+}
+
+inline void WriteFence() {
+  __sync_synchronize();
+}
+#endif  // __ATOMIC_ACQUIRE
+
+inline unsigned int RegionSize(unsigned int slot_count) {
+  return HEADER_SIZE + slot_count * SLOT_SIZE;
+}
+
+inline Slot *GetSlot(uint8_t *region, unsigned int slot) {
+  return reinterpret_cast<Slot*>(region + HEADER_SIZE + slot * SLOT_SIZE);
+}
+
+void CloseDescriptor(int fd) {
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+/*
+ * Populate a sockaddr_un with a name in the abstract namespace.
+ */
+socklen_t AbstractAddress(const string &name, struct sockaddr_un *address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  size_t length = std::min(name.size(), sizeof(address->sun_path) - 1);
+  memcpy(address->sun_path + 1, name.data(), length);
+  return offsetof(struct sockaddr_un, sun_path) + 1 + length;
+}
+}  // namespace
+#endif  // OLA_SHARED_DMX
+
+
+// SharedDmxWriter
+// ----------------------------------------------------------------------------
+SharedDmxWriter::SharedDmxWriter()
+    : m_region_fd(-1),
+      m_doorbell_fd(-1),
+      m_region(NULL),
+      m_region_size(0),
+      m_slot_count(0) {
+}
+
+SharedDmxWriter::~SharedDmxWriter() {
+  Close();
+}
+
+#ifdef OLA_SHARED_DMX
+bool SharedDmxWriter::Init(unsigned int slot_count) {
+  if (m_region || slot_count == 0) {
+    return false;
+  }
+  slot_count = std::min(slot_count, static_cast<unsigned int>(MAX_SLOTS));
+  unsigned int region_size = RegionSize(slot_count);
+
+  m_region_fd = memfd_create("ola-dmx", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (m_region_fd < 0) {
+    OLA_WARN << "memfd_create() failed, " << strerror(errno);
+    return false;
+  }
+
+  if (ftruncate(m_region_fd, region_size) ||
+      fcntl(m_region_fd, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+    OLA_WARN << "Failed to size the shared region, " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  void *region = mmap(NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      m_region_fd, 0);
+  if (region == MAP_FAILED) {
+    OLA_WARN << "mmap() failed, " << strerror(errno);
+    Close();
+    return false;
+  }
+  m_region = reinterpret_cast<uint8_t*>(region);
+  m_region_size = region_size;
+
+  m_doorbell_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (m_doorbell_fd < 0) {
+    OLA_WARN << "eventfd() failed, " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  // ftruncate() zero fills, so all the slots start out unused.
+  RegionHeader *header = reinterpret_cast<RegionHeader*>(m_region);
+  header->magic = REGION_MAGIC;
+  header->version = REGION_VERSION;
+  header->slot_count = slot_count;
+  header->slot_size = SLOT_SIZE;
+  m_slot_count = slot_count;
+  return true;
+}
+
+bool SharedDmxWriter::SendDescriptors(const string &listener_name,
+                                      uint64_t token) {
+  if (!m_region) {
+    return false;
+  }
+
+  int sd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed, " << strerror(errno);
+    return false;
+  }
+
+  struct sockaddr_un address;
+  socklen_t address_length = AbstractAddress(listener_name, &address);
+
+  struct iovec iov;
+  iov.iov_base = &token;
+  iov.iov_len = sizeof(token);
+
+  int fds[2] = {m_region_fd, m_doorbell_fd};
+  union {
+    char buffer[CMSG_SPACE(sizeof(fds))];
+    struct cmsghdr align;
+  } control;
+  memset(&control, 0, sizeof(control));
+
+  struct msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_name = &address;
+  message.msg_namelen = address_length;
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control.buffer;
+  message.msg_controllen = sizeof(control.buffer);
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  // Don't wait if the listener's queue is full, the caller can use RPCs
+  // instead.
+  bool ok = sendmsg(sd, &message, MSG_NOSIGNAL | MSG_DONTWAIT) ==
+      static_cast<ssize_t>(sizeof(token));
+  if (!ok) {
+    OLA_INFO << "Failed to send the shared region to " << listener_name
+             << ", " << strerror(errno);
+  }
+  close(sd);
+  return ok;
+}
+
+bool SharedDmxWriter::Write(unsigned int slot_index, unsigned int universe,
+                            uint8_t priority, const DmxBuffer &data) {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  Slot *slot = GetSlot(m_region, slot_index);
+  unsigned int length = std::min(data.Size(),
+                                 static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  // Only this process writes the sequence number, so a plain read is fine.
+  uint32_t sequence = slot->sequence;
+
+  StoreSequence(&slot->sequence, sequence + 1);
+  WriteFence();
+  slot->universe = universe;
+  slot->length = length;
+  slot->priority = priority;
+  if (length) {
+    memcpy(slot->data, data.GetRaw(), length);
+  }
+  StoreSequence(&slot->sequence, sequence + 2);
+  return true;
+}
+
+bool SharedDmxWriter::Signal() {
+  if (m_doorbell_fd < 0) {
+    return false;
+  }
+  uint64_t one = 1;
+  return write(m_doorbell_fd, &one, sizeof(one)) ==
+      static_cast<ssize_t>(sizeof(one));
+}
+
+bool SharedDmxWriter::Supported() {
+  return true;
+}
+
+void SharedDmxWriter::Close() {
+  if (m_region) {
+    munmap(m_region, m_region_size);
+    m_region = NULL;
+  }
+  CloseDescriptor(m_region_fd);
+  CloseDescriptor(m_doorbell_fd);
+  m_region_fd = -1;
+  m_doorbell_fd = -1;
+  m_region_size = 0;
+  m_slot_count = 0;
+}
+#else
+bool SharedDmxWriter::Init(unsigned int) {
+  return false;
+}
+
+bool SharedDmxWriter::SendDescriptors(const string&, uint64_t) {
+  return false;
+}
+
+bool SharedDmxWriter::Write(unsigned int, unsigned int, uint8_t,
+                            const DmxBuffer&) {
+  return false;
+}
+
+bool SharedDmxWriter::Signal() {
+  return false;
+}
+
+bool SharedDmxWriter::Supported() {
+  return false;
+}
+
+void SharedDmxWriter::Close() {}
+#endif  // OLA_SHARED_DMX
+
+
+// SharedDmxReader
+// ----------------------------------------------------------------------------
+SharedDmxReader::SharedDmxReader(int doorbell_fd, uint8_t *region,
+                                 unsigned int region_size,
+                                 unsigned int slot_count)
+    : m_doorbell(new UnmanagedFileDescriptor(doorbell_fd)),
+      m_region(region),
+      m_region_size(region_size),
+      m_slot_count(slot_count),
+      m_sequence_numbers(slot_count, 0) {
+}
+
+#ifdef OLA_SHARED_DMX
+SharedDmxReader::~SharedDmxReader() {
+  munmap(m_region, m_region_size);
+  close(m_doorbell->ReadDescriptor());
+}
+
+void SharedDmxReader::DrainDoorbell() {
+  uint64_t count;
+  while (read(m_doorbell->ReadDescriptor(), &count, sizeof(count)) ==
+         static_cast<ssize_t>(sizeof(count))) {
+  }
+}
+
+bool SharedDmxReader::ReadSlot(unsigned int slot_index,
+                               SharedDmxFrame *frame) {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  const Slot *slot = GetSlot(m_region, slot_index);
+  uint8_t data[DMX_UNIVERSE_SIZE];
+
+  for (unsigned int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+    uint32_t sequence = LoadSequence(&slot->sequence);
+    if (sequence == m_sequence_numbers[slot_index]) {
+      return false;
+    }
+    if (sequence & 1) {
+      continue;
+    }
+
+    unsigned int universe = slot->universe;
+    unsigned int length = std::min(
+        static_cast<unsigned int>(slot->length),
+        static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+    uint8_t priority = slot->priority;
+    memcpy(data, slot->data, length);
+
+    ReadFence();
+    if (LoadSequence(&slot->sequence) != sequence) {
+      continue;
+    }
+
+    m_sequence_numbers[slot_index] = sequence;
+    frame->universe = universe;
+    frame->priority = priority;
+    frame->data.Set(data, length);
+    return true;
+  }
+  return false;
+}
+
+SharedDmxReader *SharedDmxReader::Attach(int region_fd, int doorbell_fd) {
+  struct stat stats;
+  int seals = fcntl(region_fd, F_GET_SEALS);
+  if (seals < 0 || !(seals & F_SEAL_SHRINK) ||
+      fstat(region_fd, &stats) ||
+      stats.st_size < static_cast<off_t>(HEADER_SIZE) ||
+      stats.st_size > static_cast<off_t>(RegionSize(
+          SharedDmxWriter::MAX_SLOTS))) {
+    OLA_WARN << "Invalid shared DMX region";
+    CloseDescriptor(region_fd);
+    CloseDescriptor(doorbell_fd);
+    return NULL;
+  }
+
+  unsigned int region_size = stats.st_size;
+  void *mapping = mmap(NULL, region_size, PROT_READ, MAP_SHARED, region_fd,
+                       0);
+  // The mapping holds a reference to the memfd, so we can close it now.
+  close(region_fd);
+  if (mapping == MAP_FAILED) {
+    OLA_WARN << "mmap() failed, " << strerror(errno);
+    CloseDescriptor(doorbell_fd);
+    return NULL;
+  }
+
+  uint8_t *region = reinterpret_cast<uint8_t*>(mapping);
+  RegionHeader header;
+  memcpy(&header, region, sizeof(header));
+  if (header.magic != REGION_MAGIC || header.version != REGION_VERSION ||
+      header.slot_size != SLOT_SIZE || header.slot_count == 0 ||
+      header.slot_count > SharedDmxWriter::MAX_SLOTS ||
+      RegionSize(header.slot_count) > region_size) {
+    OLA_WARN << "Invalid shared DMX region header";
+    munmap(mapping, region_size);
+    CloseDescriptor(doorbell_fd);
+    return NULL;
+  }
+
+  int flags = fcntl(doorbell_fd, F_GETFL);
+  if (flags < 0 || fcntl(doorbell_fd, F_SETFL, flags | O_NONBLOCK)) {
+    OLA_WARN << "Failed to set the doorbell to non-blocking";
+    munmap(mapping, region_size);
+    CloseDescriptor(doorbell_fd);
+    return NULL;
+  }
+  return new SharedDmxReader(doorbell_fd, region, region_size,
+                             header.slot_count);
+}
+#else
+SharedDmxReader::~SharedDmxReader() {}
+
+void SharedDmxReader::DrainDoorbell() {}
+
+bool SharedDmxReader::ReadSlot(unsigned int, SharedDmxFrame*) {
+  return false;
+}
+
+SharedDmxReader *SharedDmxReader::Attach(int, int) {
+  return NULL;
+}
+#endif  // OLA_SHARED_DMX
+
+
+// SharedDmxListener
+// ----------------------------------------------------------------------------
+SharedDmxListener::SharedDmxListener() {}
+
+SharedDmxListener::~SharedDmxListener() {
+#ifdef OLA_SHARED_DMX
+  if (m_descriptor.get()) {
+    close(m_descriptor->ReadDescriptor());
+  }
+
+  PendingMap::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    CloseDescriptor(iter->second.region_fd);
+    CloseDescriptor(iter->second.doorbell_fd);
+  }
+#endif  // OLA_SHARED_DMX
+}
+
+string SharedDmxListener::ListenerName(uint16_t rpc_port) {
+  return "ola-dmx-" + IntToString(rpc_port);
+}
+
+#ifdef OLA_SHARED_DMX
+bool SharedDmxListener::Init(const string &name) {
+  if (m_descriptor.get()) {
+    return false;
+  }
+
+  int sd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed, " << strerror(errno);
+    return false;
+  }
+
+  struct sockaddr_un address;
+  socklen_t address_length = AbstractAddress(name, &address);
+  if (bind(sd, reinterpret_cast<struct sockaddr*>(&address),
+           address_length)) {
+    OLA_WARN << "Failed to bind the shared DMX listener to " << name << ", "
+             << strerror(errno);
+    close(sd);
+    return false;
+  }
+  m_descriptor.reset(new UnmanagedFileDescriptor(sd));
+  return true;
+}
+
+void SharedDmxListener::ReceiveDescriptors() {
+  if (!m_descriptor.get()) {
+    return;
+  }
+
+  while (true) {
+    uint64_t token;
+    struct iovec iov;
+    iov.iov_base = &token;
+    iov.iov_len = sizeof(token);
+
+    union {
+      char buffer[CMSG_SPACE(2 * sizeof(int))];
+      struct cmsghdr align;
+    } control;
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    ssize_t received = recvmsg(m_descriptor->ReadDescriptor(), &message,
+                               MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        OLA_WARN << "recvmsg() failed, " << strerror(errno);
+      }
+      return;
+    }
+
+    int fds[2] = {-1, -1};
+    unsigned int fd_count = 0;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    for (; cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+      unsigned int count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (unsigned int i = 0; i < count; i++) {
+        int fd;
+        memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd));
+        if (fd_count < 2) {
+          fds[fd_count] = fd;
+        } else {
+          close(fd);
+        }
+        fd_count++;
+      }
+    }
+
+    if (received != static_cast<ssize_t>(sizeof(token)) || fd_count != 2 ||
+        (message.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+      OLA_INFO << "Dropping malformed shared DMX message";
+      CloseDescriptor(fds[0]);
+      CloseDescriptor(fds[1]);
+      continue;
+    }
+    AddPending(token, fds[0], fds[1]);
+  }
+}
+
+SharedDmxReader *SharedDmxListener::Claim(uint64_t token) {
+  PendingMap::iterator iter = m_pending.find(token);
+  if (iter == m_pending.end()) {
+    return NULL;
+  }
+
+  PendingRegion region = iter->second;
+  m_pending.erase(iter);
+  m_pending_order.erase(
+      std::find(m_pending_order.begin(), m_pending_order.end(), token));
+  return SharedDmxReader::Attach(region.region_fd, region.doorbell_fd);
+}
+
+void SharedDmxListener::AddPending(uint64_t token, int region_fd,
+                                   int doorbell_fd) {
+  PendingMap::iterator iter = m_pending.find(token);
+  if (iter != m_pending.end()) {
+    // Replace the old region, but keep its place in the queue.
+    CloseDescriptor(iter->second.region_fd);
+    CloseDescriptor(iter->second.doorbell_fd);
+  } else {
+    if (m_pending.size() == MAX_PENDING) {
+      iter = m_pending.find(m_pending_order.front());
+      CloseDescriptor(iter->second.region_fd);
+      CloseDescriptor(iter->second.doorbell_fd);
+      m_pending.erase(iter);
+      m_pending_order.pop_front();
+    }
+    m_pending_order.push_back(token);
+  }
+
+  PendingRegion &region = m_pending[token];
+  region.region_fd = region_fd;
+  region.doorbell_fd = doorbell_fd;
+}
+#else
+bool SharedDmxListener::Init(const string&) {
+  return false;
+}
+
+void SharedDmxListener::ReceiveDescriptors() {}
+
+SharedDmxReader *SharedDmxListener::Claim(uint64_t) {
+  return NULL;
+}
+
+void SharedDmxListener::AddPending(uint64_t, int, int) {}
+#endif  // OLA_SHARED_DMX
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,265 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmx.h
+ * Pass DMX data between processes on the same host using shared memory.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_SHAREDDMX_H_
+#define COMMON_DMX_SHAREDDMX_H_
+
+#include <stdint.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A frame read from a slot of a shared region.
+ */
+struct SharedDmxFrame {
+  unsigned int universe;
+  uint8_t priority;
+  DmxBuffer data;
+};
+
+/**
+ * @brief The client end of the shared memory DMX transport.
+ *
+ * The writer creates a sealed memfd, which holds a fixed number of slots, and
+ * an eventfd that is used to wake the reader. Each slot holds the latest frame
+ * for one universe and is protected by a sequence lock, so the writer never
+ * waits for the reader.
+ *
+ * Both descriptors are passed to the reader with SendDescriptors(). The
+ * reader then claims them using the token, which the client sends over its
+ * RPC connection.
+ *
+ * @examplepara
+ *   @code
+ *   SharedDmxWriter writer;
+ *   writer.Init(64);
+ *   writer.SendDescriptors(SharedDmxListener::ListenerName(9010), token);
+ *   // Claim the region with the AttachSharedDmx RPC, then
+ *   writer.Write(0, universe, priority, buffer);
+ *   writer.Signal();
+ *   @endcode
+ */
+class SharedDmxWriter {
+ public:
+  SharedDmxWriter();
+  ~SharedDmxWriter();
+
+  /**
+   * @brief Create the shared region and the doorbell.
+   * @param slot_count the number of universes the region can hold, this is
+   *   capped at MAX_SLOTS.
+   * @returns true if the region was created, false if shared memory isn't
+   *   supported on this platform or there was an error.
+   */
+  bool Init(unsigned int slot_count);
+
+  /**
+   * @brief The number of slots in the region.
+   */
+  unsigned int SlotCount() const { return m_slot_count; }
+
+  /**
+   * @brief Pass the region and doorbell to a SharedDmxListener.
+   * @param listener_name the name the listener is bound to.
+   * @param token the token the descriptors can be claimed with.
+   * @returns true if the descriptors were sent.
+   */
+  bool SendDescriptors(const std::string &listener_name, uint64_t token);
+
+  /**
+   * @brief Update the frame in a slot.
+   * @param slot the slot to update, this must be less than SlotCount().
+   * @param universe the universe the data is for.
+   * @param priority the priority of the data.
+   * @param data the DMX data.
+   * @returns true if the slot was updated.
+   *
+   * The reader isn't woken until Signal() is called, so many slots can be
+   * updated with one wake up.
+   */
+  bool Write(unsigned int slot, unsigned int universe, uint8_t priority,
+             const DmxBuffer &data);
+
+  /**
+   * @brief Wake the reader.
+   * @returns true if the reader was signalled.
+   */
+  bool Signal();
+
+  /**
+   * @brief Check if shared memory is supported on this platform.
+   */
+  static bool Supported();
+
+  /**
+   * @brief The maximum number of slots in a region.
+   */
+  static const unsigned int MAX_SLOTS = 4096;
+
+ private:
+  int m_region_fd;
+  int m_doorbell_fd;
+  uint8_t *m_region;
+  unsigned int m_region_size;
+  unsigned int m_slot_count;
+
+  void Close();
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxWriter);
+};
+
+
+/**
+ * @brief The server end of the shared memory DMX transport.
+ *
+ * Readers are created by a SharedDmxListener. When the doorbell descriptor
+ * becomes readable, call DrainDoorbell() and then ReadSlot() for each slot.
+ */
+class SharedDmxReader {
+ public:
+  ~SharedDmxReader();
+
+  /**
+   * @brief The descriptor that becomes readable when the writer signals.
+   */
+  ola::io::UnmanagedFileDescriptor *Doorbell() { return m_doorbell.get(); }
+
+  /**
+   * @brief Reset the doorbell, this must be called each time it's readable.
+   */
+  void DrainDoorbell();
+
+  /**
+   * @brief The number of slots in the region.
+   */
+  unsigned int SlotCount() const { return m_slot_count; }
+
+  /**
+   * @brief Read the frame from a slot, if it has changed.
+   * @param slot the slot to read.
+   * @param[out] frame the frame from the slot.
+   * @returns true if the slot has been written to since the last call, false
+   *   if it's unchanged, unused or the writer is part way through an update.
+   *   In the last case the writer will signal again once it's done.
+   */
+  bool ReadSlot(unsigned int slot, SharedDmxFrame *frame);
+
+  /**
+   * @brief Map a region created by a SharedDmxWriter.
+   * @param region_fd the memfd holding the region.
+   * @param doorbell_fd the eventfd used to signal updates.
+   * @returns a new SharedDmxReader or NULL if the region isn't valid. The
+   *   descriptors are closed on failure.
+   */
+  static SharedDmxReader *Attach(int region_fd, int doorbell_fd);
+
+ private:
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_doorbell;
+  uint8_t *m_region;
+  unsigned int m_region_size;
+  unsigned int m_slot_count;
+  std::vector<uint32_t> m_sequence_numbers;
+
+  SharedDmxReader(int doorbell_fd, uint8_t *region, unsigned int region_size,
+                  unsigned int slot_count);
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxReader);
+};
+
+
+/**
+ * @brief Receives the descriptors sent by SharedDmxWriter::SendDescriptors().
+ *
+ * This listens on a datagram socket in the abstract Unix namespace. The
+ * received descriptors are held until they are claimed, or until
+ * MAX_PENDING newer regions have arrived.
+ */
+class SharedDmxListener {
+ public:
+  SharedDmxListener();
+  ~SharedDmxListener();
+
+  /**
+   * @brief Start listening.
+   * @param name the name to listen on, see ListenerName().
+   * @returns true if the listener was started.
+   */
+  bool Init(const std::string &name);
+
+  /**
+   * @brief The descriptor to add to the SelectServer.
+   */
+  ola::io::UnmanagedFileDescriptor *GetDescriptor() {
+    return m_descriptor.get();
+  }
+
+  /**
+   * @brief Receive any descriptors waiting on the socket.
+   */
+  void ReceiveDescriptors();
+
+  /**
+   * @brief Claim the region sent with a token.
+   * @param token the token from SharedDmxWriter::SendDescriptors().
+   * @returns a new SharedDmxReader, ownership is transferred, or NULL if
+   *   the token is unknown or the region was invalid.
+   */
+  SharedDmxReader *Claim(uint64_t token);
+
+  /**
+   * @brief The number of regions waiting to be claimed.
+   */
+  unsigned int PendingCount() const { return m_pending.size(); }
+
+  /**
+   * @brief The name a listener for an olad instance uses.
+   * @param rpc_port the port olad listens for RPCs on.
+   */
+  static std::string ListenerName(uint16_t rpc_port);
+
+  static const unsigned int MAX_PENDING = 16;
+
+ private:
+  struct PendingRegion {
+    int region_fd;
+    int doorbell_fd;
+  };
+  typedef std::map<uint64_t, PendingRegion> PendingMap;
+
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_descriptor;
+  PendingMap m_pending;
+  std::deque<uint64_t> m_pending_order;
+
+  void AddPending(uint64_t token, int region_fd, int doorbell_fd);
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxListener);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_SHAREDDMX_H_
@@ -0,0 +1,396 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxBenchmark.cpp
+ * Compare the shared memory DMX transport with streaming RPCs over TCP.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The receiving end runs in a second thread with its own SelectServer, like
+ * olad would. Each frame carries a sequence number in the first four slots.
+ *
+ * The latency test sends one frame and waits for it to arrive before sending
+ * the next. The throughput test sends a frame for each universe as fast as
+ * possible; with shared memory a frame may be replaced before it's read, so
+ * the number of frames received is also reported.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/dmx/SharedDmx.h"
+#include "common/protocol/Ola.pb.h"
+#include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocket.h"
+#include "ola/network/TCPSocketFactory.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::SharedDmxFrame;
+using ola::dmx::SharedDmxListener;
+using ola::dmx::SharedDmxReader;
+using ola::dmx::SharedDmxWriter;
+using ola::io::SelectServer;
+using ola::network::IPV4SocketAddress;
+using ola::network::TCPAcceptingSocket;
+using ola::network::TCPSocket;
+using ola::proto::OlaServerService_Stub;
+using ola::rpc::RpcChannel;
+using ola::thread::ConditionVariable;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(frames, f, 2000, "The number of frames in the throughput test");
+DEFINE_s_uint32(universes, u, 64,
+                "The number of universes in the throughput test");
+DEFINE_s_uint32(round_trips, r, 5000,
+                "The number of frames in the latency test");
+
+/*
+ * Tracks the latest sequence number received for each universe.
+ */
+class FrameRecorder {
+ public:
+  explicit FrameRecorder(unsigned int universes)
+      : m_sequence_numbers(universes, 0),
+        m_received(0) {
+  }
+
+  void Record(unsigned int universe, const DmxBuffer &data) {
+    uint8_t sequence[4];
+    unsigned int size = sizeof(sequence);
+    data.Get(sequence, &size);
+    if (size != sizeof(sequence) || universe >= m_sequence_numbers.size()) {
+      return;
+    }
+
+    MutexLocker lock(&m_mutex);
+    m_sequence_numbers[universe] = (sequence[0] << 24) + (sequence[1] << 16) +
+                                   (sequence[2] << 8) + sequence[3];
+    m_received++;
+    m_condition.Signal();
+  }
+
+  /*
+   * Wait until the frame with the sequence number has arrived for each of
+   * the first universe_count universes.
+   */
+  void WaitFor(unsigned int universe_count, uint32_t sequence) {
+    MutexLocker lock(&m_mutex);
+    for (unsigned int i = 0; i < universe_count; i++) {
+      while (m_sequence_numbers[i] != sequence) {
+        m_condition.Wait(&m_mutex);
+      }
+    }
+  }
+
+  uint64_t Received() {
+    MutexLocker lock(&m_mutex);
+    return m_received;
+  }
+
+ private:
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+  vector<uint32_t> m_sequence_numbers;
+  uint64_t m_received;
+};
+
+/*
+ * Receives StreamDmxData RPCs.
+ */
+class BenchmarkService: public ola::proto::OlaServerService {
+ public:
+  explicit BenchmarkService(FrameRecorder *recorder) : m_recorder(recorder) {}
+
+  void StreamDmxData(ola::rpc::RpcController*,
+                     const ola::proto::DmxData* request,
+                     ola::proto::STREAMING_NO_RESPONSE*,
+                     CompletionCallback*) {
+    DmxBuffer buffer;
+    buffer.Set(request->data());
+    m_recorder->Record(request->universe(), buffer);
+  }
+
+ private:
+  FrameRecorder *m_recorder;
+};
+
+/*
+ * The receiving end, this runs the SelectServer.
+ */
+class ReceiverThread: public ola::thread::Thread {
+ public:
+  ReceiverThread(SelectServer *ss, FrameRecorder *recorder,
+                 SharedDmxReader *reader)
+      : ola::thread::Thread(Options("receiver")),
+        m_ss(ss),
+        m_recorder(recorder),
+        m_reader(reader) {
+  }
+
+  void *Run() {
+    m_reader->Doorbell()->SetOnData(
+        ola::NewCallback(this, &ReceiverThread::DoorbellReady));
+    m_ss->AddReadDescriptor(m_reader->Doorbell());
+    m_ss->Run();
+    m_ss->RemoveReadDescriptor(m_reader->Doorbell());
+    return NULL;
+  }
+
+ private:
+  SelectServer *m_ss;
+  FrameRecorder *m_recorder;
+  SharedDmxReader *m_reader;
+  SharedDmxFrame m_frame;
+
+  void DoorbellReady() {
+    m_reader->DrainDoorbell();
+    for (unsigned int i = 0; i < m_reader->SlotCount(); i++) {
+      if (m_reader->ReadSlot(i, &m_frame)) {
+        m_recorder->Record(m_frame.universe, m_frame.data);
+      }
+    }
+  }
+};
+
+/*
+ * The two ways of sending a frame.
+ */
+class FrameSender {
+ public:
+  virtual ~FrameSender() {}
+
+  virtual void Send(unsigned int universe, const DmxBuffer &data) = 0;
+  // Called once all universes of a frame have been sent.
+  virtual void Flush() {}
+};
+
+class TCPSender: public FrameSender {
+ public:
+  explicit TCPSender(OlaServerService_Stub *stub) : m_stub(stub) {}
+
+  void Send(unsigned int universe, const DmxBuffer &data) {
+    m_request.set_universe(universe);
+    m_request.set_data(reinterpret_cast<const char*>(data.GetRaw()),
+                       data.Size());
+    m_request.set_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT);
+    m_stub->StreamDmxData(NULL, &m_request, NULL, NULL);
+  }
+
+ private:
+  OlaServerService_Stub *m_stub;
+  ola::proto::DmxData m_request;
+};
+
+class SharedMemorySender: public FrameSender {
+ public:
+  explicit SharedMemorySender(SharedDmxWriter *writer) : m_writer(writer) {}
+
+  void Send(unsigned int universe, const DmxBuffer &data) {
+    m_writer->Write(universe, universe, ola::dmx::SOURCE_PRIORITY_DEFAULT,
+                    data);
+  }
+
+  void Flush() {
+    m_writer->Signal();
+  }
+
+ private:
+  SharedDmxWriter *m_writer;
+};
+
+void SetSequence(DmxBuffer *buffer, uint32_t sequence) {
+  buffer->SetChannel(0, sequence >> 24);
+  buffer->SetChannel(1, sequence >> 16);
+  buffer->SetChannel(2, sequence >> 8);
+  buffer->SetChannel(3, sequence);
+}
+
+void RunLatency(const char *name, FrameSender *sender,
+                FrameRecorder *recorder, uint32_t *sequence) {
+  Clock clock;
+  TimeStamp start, end;
+  DmxBuffer buffer;
+  buffer.Blackout();
+  vector<int64_t> latencies;
+  latencies.reserve(FLAGS_round_trips);
+
+  for (unsigned int i = 0; i < FLAGS_round_trips; i++) {
+    SetSequence(&buffer, ++(*sequence));
+    clock.CurrentTime(&start);
+    sender->Send(0, buffer);
+    sender->Flush();
+    recorder->WaitFor(1, *sequence);
+    clock.CurrentTime(&end);
+    latencies.push_back((end - start).AsInt());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  int64_t total = 0;
+  vector<int64_t>::const_iterator iter = latencies.begin();
+  for (; iter != latencies.end(); ++iter) {
+    total += *iter;
+  }
+  cout << std::setw(14) << std::left << name << " latency: "
+       << std::fixed << std::setprecision(1)
+       << "mean " << (static_cast<double>(total) / latencies.size())
+       << " us, p50 " << latencies[latencies.size() / 2]
+       << " us, p99 " << latencies[latencies.size() * 99 / 100]
+       << " us" << endl;
+}
+
+void RunThroughput(const char *name, FrameSender *sender,
+                   FrameRecorder *recorder, uint32_t *sequence) {
+  Clock clock;
+  TimeStamp start, end;
+  DmxBuffer buffer;
+  buffer.Blackout();
+  const uint64_t received = recorder->Received();
+
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    SetSequence(&buffer, ++(*sequence));
+    for (unsigned int universe = 0; universe < FLAGS_universes; universe++) {
+      sender->Send(universe, buffer);
+    }
+    sender->Flush();
+  }
+  recorder->WaitFor(FLAGS_universes, *sequence);
+  clock.CurrentTime(&end);
+
+  double usec = static_cast<double>((end - start).AsInt());
+  uint64_t sent = static_cast<uint64_t>(FLAGS_frames) * FLAGS_universes;
+  cout << std::setw(14) << std::left << name << " throughput: "
+       << std::fixed << std::setprecision(1)
+       << (FLAGS_frames * 1000000.0 / usec) << " frames/s, "
+       << (sent * 1000000.0 / usec) << " universes/s, "
+       << (recorder->Received() - received) << " of " << sent
+       << " universes received" << endl;
+}
+
+void NewConnection(auto_ptr<TCPSocket> *socket, TCPSocket *new_socket) {
+  socket->reset(new_socket);
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare shared memory and TCP for sending DMX to olad.");
+
+  if (!SharedDmxWriter::Supported()) {
+    cout << "Shared memory isn't supported on this platform" << endl;
+    return 1;
+  }
+  if (FLAGS_frames == 0 || FLAGS_round_trips == 0 || FLAGS_universes == 0 ||
+      FLAGS_universes > SharedDmxWriter::MAX_SLOTS) {
+    cout << "Need at least 1 frame and round trip, and between 1 and "
+         << SharedDmxWriter::MAX_SLOTS << " universes" << endl;
+    return 1;
+  }
+
+  SelectServer ss;
+  FrameRecorder recorder(FLAGS_universes);
+  BenchmarkService service(&recorder);
+
+  // Set up the TCP connection.
+  auto_ptr<TCPSocket> server_socket;
+  ola::network::TCPSocketFactory factory(
+      ola::NewCallback(NewConnection, &server_socket));
+  TCPAcceptingSocket accepting_socket(&factory);
+  if (!accepting_socket.Listen(
+        IPV4SocketAddress(ola::network::IPV4Address::Loopback(), 0))) {
+    return 1;
+  }
+  ss.AddReadDescriptor(&accepting_socket);
+  auto_ptr<TCPSocket> client_socket(TCPSocket::Connect(
+      accepting_socket.GetLocalAddress()));
+  if (!client_socket.get()) {
+    return 1;
+  }
+  while (!server_socket.get()) {
+    ss.RunOnce(TimeInterval(1, 0));
+  }
+  ss.RemoveReadDescriptor(&accepting_socket);
+  client_socket->SetNoDelay();
+  // Block rather than close the channel if the receiver falls behind.
+  int flags = fcntl(client_socket->WriteDescriptor(), F_GETFL);
+  fcntl(client_socket->WriteDescriptor(), F_SETFL, flags & ~O_NONBLOCK);
+
+  RpcChannel server_channel(&service, server_socket.get());
+  ss.AddReadDescriptor(server_socket.get());
+  RpcChannel client_channel(NULL, client_socket.get());
+  OlaServerService_Stub stub(&client_channel);
+
+  // Set up the shared region.
+  const string name = "ola-dmx-benchmark-" + ola::IntToString(getpid());
+  SharedDmxListener listener;
+  SharedDmxWriter writer;
+  if (!listener.Init(name) || !writer.Init(FLAGS_universes) ||
+      !writer.SendDescriptors(name, 1)) {
+    return 1;
+  }
+  listener.ReceiveDescriptors();
+  auto_ptr<SharedDmxReader> reader(listener.Claim(1));
+  if (!reader.get()) {
+    return 1;
+  }
+
+  ReceiverThread thread(&ss, &recorder, reader.get());
+  thread.Start();
+
+  cout << "Sending " << FLAGS_frames << " frames of " << FLAGS_universes
+       << " universes, " << FLAGS_round_trips << " round trips" << endl;
+
+  TCPSender tcp_sender(&stub);
+  SharedMemorySender shared_sender(&writer);
+  uint32_t sequence = 0;
+
+  RunLatency("TCP", &tcp_sender, &recorder, &sequence);
+  RunLatency("Shared memory", &shared_sender, &recorder, &sequence);
+  RunThroughput("TCP", &tcp_sender, &recorder, &sequence);
+  RunThroughput("Shared memory", &shared_sender, &recorder, &sequence);
+
+  ss.Execute(ola::NewSingleCallback(&ss, &SelectServer::Terminate));
+  thread.Join();
+  ss.RemoveReadDescriptor(server_socket.get());
+  return 0;
+}
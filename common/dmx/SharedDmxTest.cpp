@@ -0,0 +1,230 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxTest.cpp
+ * Test fixture for the shared memory DMX transport.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+
+#include "common/dmx/SharedDmx.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::dmx::SharedDmxFrame;
+using ola::dmx::SharedDmxListener;
+using ola::dmx::SharedDmxReader;
+using ola::dmx::SharedDmxWriter;
+using ola::io::SelectServer;
+using std::auto_ptr;
+using std::string;
+
+class SharedDmxTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SharedDmxTest);
+  CPPUNIT_TEST(testReadWrite);
+  CPPUNIT_TEST(testDoorbell);
+  CPPUNIT_TEST(testPendingRegions);
+  CPPUNIT_TEST(testInvalidRegion);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+
+    void testReadWrite();
+    void testDoorbell();
+    void testPendingRegions();
+    void testInvalidRegion();
+
+ private:
+    string m_name;
+
+    void SetFlag(bool *flag) { *flag = true; }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedDmxTest);
+
+
+void SharedDmxTest::setUp() {
+  // The abstract namespace is shared by every process, so use a unique name.
+  m_name = "ola-dmx-test-" + ola::IntToString(getpid());
+}
+
+
+/*
+ * Check frames written by the writer are read once by the reader.
+ */
+void SharedDmxTest::testReadWrite() {
+  if (!SharedDmxWriter::Supported()) {
+    return;
+  }
+
+  SharedDmxListener listener;
+  OLA_ASSERT_TRUE(listener.Init(m_name));
+
+  SharedDmxWriter writer;
+  OLA_ASSERT_FALSE(writer.Write(0, 1, 100, DmxBuffer()));
+  OLA_ASSERT_TRUE(writer.Init(4));
+  OLA_ASSERT_EQ(4u, writer.SlotCount());
+  OLA_ASSERT_TRUE(writer.SendDescriptors(m_name, 42));
+
+  listener.ReceiveDescriptors();
+  OLA_ASSERT_EQ(1u, listener.PendingCount());
+  OLA_ASSERT_NULL(listener.Claim(41));
+  auto_ptr<SharedDmxReader> reader(listener.Claim(42));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  OLA_ASSERT_EQ(0u, listener.PendingCount());
+  OLA_ASSERT_NULL(listener.Claim(42));
+  OLA_ASSERT_EQ(4u, reader->SlotCount());
+
+  // Nothing has been written yet
+  SharedDmxFrame frame;
+  for (unsigned int i = 0; i < reader->SlotCount(); i++) {
+    OLA_ASSERT_FALSE(reader->ReadSlot(i, &frame));
+  }
+
+  DmxBuffer buffer1, buffer2, buffer3;
+  buffer1.SetFromString("1,2,3,4");
+  buffer2.SetFromString("255,0,128");
+  buffer3.SetFromString("9,8,7");
+
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 100, buffer1));
+  OLA_ASSERT_TRUE(writer.Write(2, 7, 50, buffer2));
+  OLA_ASSERT_FALSE(writer.Write(4, 8, 50, buffer2));
+
+  OLA_ASSERT_TRUE(reader->ReadSlot(0, &frame));
+  OLA_ASSERT_EQ(1u, frame.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), frame.priority);
+  OLA_ASSERT_EQ(buffer1, frame.data);
+  OLA_ASSERT_FALSE(reader->ReadSlot(0, &frame));
+  OLA_ASSERT_FALSE(reader->ReadSlot(1, &frame));
+
+  OLA_ASSERT_TRUE(reader->ReadSlot(2, &frame));
+  OLA_ASSERT_EQ(7u, frame.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(50), frame.priority);
+  OLA_ASSERT_EQ(buffer2, frame.data);
+  OLA_ASSERT_FALSE(reader->ReadSlot(4, &frame));
+
+  // Only the latest frame in a slot is seen
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 100, buffer2));
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 90, buffer3));
+  OLA_ASSERT_TRUE(reader->ReadSlot(0, &frame));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(90), frame.priority);
+  OLA_ASSERT_EQ(buffer3, frame.data);
+  OLA_ASSERT_FALSE(reader->ReadSlot(0, &frame));
+
+  // An empty frame is still a change
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 100, DmxBuffer()));
+  OLA_ASSERT_TRUE(reader->ReadSlot(0, &frame));
+  OLA_ASSERT_EQ(0u, frame.data.Size());
+}
+
+
+/*
+ * Check the doorbell wakes the SelectServer.
+ */
+void SharedDmxTest::testDoorbell() {
+  if (!SharedDmxWriter::Supported()) {
+    return;
+  }
+
+  SharedDmxListener listener;
+  OLA_ASSERT_TRUE(listener.Init(m_name));
+  SharedDmxWriter writer;
+  OLA_ASSERT_TRUE(writer.Init(1));
+  OLA_ASSERT_TRUE(writer.SendDescriptors(m_name, 1));
+  listener.ReceiveDescriptors();
+  auto_ptr<SharedDmxReader> reader(listener.Claim(1));
+  OLA_ASSERT_NOT_NULL(reader.get());
+
+  SelectServer ss;
+  bool signalled = false;
+  reader->Doorbell()->SetOnData(
+      ola::NewCallback(this, &SharedDmxTest::SetFlag, &signalled));
+  ss.AddReadDescriptor(reader->Doorbell());
+
+  ss.RunOnce(TimeInterval(0, 0));
+  OLA_ASSERT_FALSE(signalled);
+
+  OLA_ASSERT_TRUE(writer.Signal());
+  OLA_ASSERT_TRUE(writer.Signal());
+  ss.RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT_TRUE(signalled);
+
+  // Once drained, the doorbell is no longer readable
+  reader->DrainDoorbell();
+  signalled = false;
+  ss.RunOnce(TimeInterval(0, 0));
+  OLA_ASSERT_FALSE(signalled);
+  ss.RemoveReadDescriptor(reader->Doorbell());
+}
+
+
+/*
+ * Check unclaimed regions are eventually released.
+ */
+void SharedDmxTest::testPendingRegions() {
+  if (!SharedDmxWriter::Supported()) {
+    return;
+  }
+
+  SharedDmxListener listener;
+  OLA_ASSERT_TRUE(listener.Init(m_name));
+  // A second listener can't use the same name
+  SharedDmxListener listener2;
+  OLA_ASSERT_FALSE(listener2.Init(m_name));
+
+  SharedDmxWriter writer;
+  OLA_ASSERT_TRUE(writer.Init(1));
+  for (unsigned int i = 0; i < SharedDmxListener::MAX_PENDING + 2; i++) {
+    OLA_ASSERT_TRUE(writer.SendDescriptors(m_name, i));
+    listener.ReceiveDescriptors();
+  }
+  // Sending the same token again replaces the region
+  OLA_ASSERT_TRUE(writer.SendDescriptors(m_name, 5));
+  listener.ReceiveDescriptors();
+  const unsigned int max_pending = SharedDmxListener::MAX_PENDING;
+  OLA_ASSERT_EQ(max_pending, listener.PendingCount());
+
+  // The oldest two were dropped
+  OLA_ASSERT_NULL(listener.Claim(0));
+  OLA_ASSERT_NULL(listener.Claim(1));
+  auto_ptr<SharedDmxReader> reader(listener.Claim(5));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  OLA_ASSERT_EQ(max_pending - 1, listener.PendingCount());
+
+  // Nothing is listening on this name
+  OLA_ASSERT_FALSE(writer.SendDescriptors(m_name + "-missing", 1));
+}
+
+
+/*
+ * Check descriptors which aren't a sealed region are rejected.
+ */
+void SharedDmxTest::testInvalidRegion() {
+  int fds[2];
+  OLA_ASSERT_EQ(0, pipe(fds));
+  OLA_ASSERT_NULL(SharedDmxReader::Attach(fds[0], fds[1]));
+}
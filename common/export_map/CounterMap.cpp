@@ -0,0 +1,171 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CounterMap.cpp
+ * A map of counters that can be incremented from any thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+
+namespace ola {
+
+using std::map;
+using std::ostringstream;
+using std::string;
+
+const CounterMap::Handle CounterMap::INVALID_HANDLE =
+    static_cast<CounterMap::Handle>(-1);
+
+namespace {
+
+#ifdef __ATOMIC_RELAXED
+inline void AtomicAdd(uint64_t *counter, uint64_t delta) {
+  __atomic_fetch_add(counter, delta, __ATOMIC_RELAXED);
+}
+
+inline uint64_t AtomicLoad(const uint64_t *counter) {
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+#else
+inline void AtomicAdd(uint64_t *counter, uint64_t delta) {
+  __sync_fetch_and_add(counter, delta);
+}
+
+inline uint64_t AtomicLoad(const uint64_t *counter) {
+  return __sync_fetch_and_add(const_cast<uint64_t*>(counter), 0);
+}
+#endif  // __ATOMIC_RELAXED
+
+unsigned int next_shard = 0;
+}  // namespace
+
+CounterMap::CounterMap(const string &name, const string &label)
+    : BaseVariable(name),
+      m_label(label),
+      m_next_handle(0) {
+  memset(m_blocks, 0, sizeof(m_blocks));
+}
+
+CounterMap::~CounterMap() {
+  for (unsigned int i = 0; i < MAX_BLOCKS; i++) {
+    delete m_blocks[i];
+  }
+}
+
+CounterMap::Handle CounterMap::Register(const string &key) {
+  HandleMap::const_iterator iter = m_handles.find(key);
+  if (iter != m_handles.end()) {
+    return iter->second;
+  }
+
+  Handle handle;
+  if (!m_free_handles.empty()) {
+    handle = m_free_handles.back();
+    m_free_handles.pop_back();
+    for (unsigned int shard = 0; shard < SHARD_COUNT; shard++) {
+      *Counter(handle, shard) = 0;
+    }
+  } else {
+    if (m_next_handle == MAX_BLOCKS * BLOCK_SIZE) {
+      OLA_WARN << "CounterMap " << Name() << " is full, can't add " << key;
+      return INVALID_HANDLE;
+    }
+    handle = m_next_handle++;
+    if (!m_blocks[handle / BLOCK_SIZE]) {
+      Block *block = new Block();
+      memset(block, 0, sizeof(*block));
+      m_blocks[handle / BLOCK_SIZE] = block;
+    }
+  }
+  m_handles[key] = handle;
+  return handle;
+}
+
+void CounterMap::Remove(const string &key) {
+  HandleMap::iterator iter = m_handles.find(key);
+  if (iter != m_handles.end()) {
+    m_free_handles.push_back(iter->second);
+    m_handles.erase(iter);
+  }
+}
+
+void CounterMap::Add(Handle handle, uint64_t delta) {
+  if (handle == INVALID_HANDLE) {
+    return;
+  }
+  AtomicAdd(Counter(handle, ShardIndex()), delta);
+}
+
+uint64_t CounterMap::Get(Handle handle) const {
+  if (handle == INVALID_HANDLE) {
+    return 0;
+  }
+  uint64_t value = 0;
+  for (unsigned int shard = 0; shard < SHARD_COUNT; shard++) {
+    value += AtomicLoad(Counter(handle, shard));
+  }
+  return value;
+}
+
+uint64_t CounterMap::Get(const string &key) const {
+  HandleMap::const_iterator iter = m_handles.find(key);
+  return iter == m_handles.end() ? 0 : Get(iter->second);
+}
+
+void CounterMap::Entries(map<string, uint64_t> *entries) const {
+  HandleMap::const_iterator iter = m_handles.begin();
+  for (; iter != m_handles.end(); ++iter) {
+    (*entries)[iter->first] = Get(iter->second);
+  }
+}
+
+/*
+ * The same format as the other map variables:
+ *   map:label_name key1:value1 key2:value2
+ */
+const string CounterMap::Value() const {
+  ostringstream value;
+  value << "map:" << m_label;
+  HandleMap::const_iterator iter = m_handles.begin();
+  for (; iter != m_handles.end(); ++iter) {
+    value << " " << iter->first << ":" << Get(iter->second);
+  }
+  return value.str();
+}
+
+/*
+ * Threads are given shards in the order they first increment a counter.
+ */
+unsigned int CounterMap::ShardIndex() {
+#ifdef __GNUC__
+  static __thread unsigned int shard = 0;
+  if (!shard) {
+    shard = __sync_add_and_fetch(&next_shard, 1) % SHARD_COUNT + 1;
+  }
+  return shard - 1;
+#else
+  return 0;
+#endif  // __GNUC__
+}
+}  // namespace ola
@@ -30,13 +30,104 @@
 namespace ola {
 
 using std::map;
+using std::ostream;
 using std::ostringstream;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Metric and label names can only contain [a-zA-Z0-9_], and can't start with
+ * a digit.
+ */
+string SanitizeName(const string &name) {
+  string output;
+  output.reserve(name.size());
+  for (string::const_iterator iter = name.begin(); iter != name.end();
+       ++iter) {
+    char c = *iter;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9')) {
+      output.push_back(c);
+    } else {
+      output.push_back('_');
+    }
+  }
+  return output;
+}
+
+string MetricName(const string &name, bool counter) {
+  string metric = "ola_" + SanitizeName(name);
+  // The _total suffix is added to the samples of counters.
+  const string suffix = "_total";
+  if (counter && metric.size() > suffix.size() &&
+      metric.compare(metric.size() - suffix.size(), suffix.size(),
+                     suffix) == 0) {
+    metric.erase(metric.size() - suffix.size());
+  }
+  return metric;
+}
+
+string LabelName(const string &label) {
+  if (label.empty()) {
+    return "key";
+  }
+  string name = SanitizeName(label);
+  if (name[0] >= '0' && name[0] <= '9') {
+    name.insert(0, "_");
+  }
+  return name;
+}
+
+string LabelValue(const string &value) {
+  string output;
+  output.reserve(value.size());
+  for (string::const_iterator iter = value.begin(); iter != value.end();
+       ++iter) {
+    switch (*iter) {
+      case '\\':
+        output.append("\\\\");
+        break;
+      case '"':
+        output.append("\\\"");
+        break;
+      case '\n':
+        output.append("\\n");
+        break;
+      default:
+        output.push_back(*iter);
+    }
+  }
+  return output;
+}
+
+template<typename Value>
+void WriteMetric(ostream *output, const string &name, bool counter,
+                 Value value) {
+  const string metric = MetricName(name, counter);
+  *output << "# TYPE " << metric << (counter ? " counter" : " gauge") << "\n"
+          << metric << (counter ? "_total " : " ") << value << "\n";
+}
+
+template<typename Value>
+void WriteMetrics(ostream *output, const string &name, const string &label,
+                  bool counter, const map<string, Value> &entries) {
+  const string metric = MetricName(name, counter);
+  const string label_name = LabelName(label);
+  *output << "# TYPE " << metric << (counter ? " counter" : " gauge") << "\n";
+  typename map<string, Value>::const_iterator iter = entries.begin();
+  for (; iter != entries.end(); ++iter) {
+    *output << metric << (counter ? "_total{" : "{") << label_name << "=\""
+            << LabelValue(iter->first) << "\"} " << iter->second << "\n";
+  }
+}
+}  // namespace
+
 ExportMap::~ExportMap() {
   STLDeleteValues(&m_bool_variables);
   STLDeleteValues(&m_counter_variables);
+  STLDeleteValues(&m_counter_map_variables);
   STLDeleteValues(&m_int_map_variables);
   STLDeleteValues(&m_int_variables);
   STLDeleteValues(&m_str_map_variables);
@@ -94,6 +185,18 @@ UIntMap *ExportMap::GetUIntMapVar(const string &name, const string &label) {
 }
 
 
+/*
+ * Lookup or create a counter map variable
+ * @param name the name of the variable
+ * @param label the label to use for the map (optional)
+ * @return a CounterMap
+ */
+CounterMap *ExportMap::GetCounterMapVar(const string &name,
+                                        const string &label) {
+  return GetMapVar(&m_counter_map_variables, name, label);
+}
+
+
 /*
  * Return a list of all variables.
  * @return a vector of all variables.
@@ -102,6 +205,7 @@ vector<BaseVariable*> ExportMap::AllVariables() const {
   vector<BaseVariable*> variables;
   STLValues(m_bool_variables, &variables);
   STLValues(m_counter_variables, &variables);
+  STLValues(m_counter_map_variables, &variables);
   STLValues(m_int_map_variables, &variables);
   STLValues(m_int_variables, &variables);
   STLValues(m_str_map_variables, &variables);
@@ -113,6 +217,53 @@ vector<BaseVariable*> ExportMap::AllVariables() const {
 }
 
 
+void ExportMap::ExportOpenMetrics(ostream *output) const {
+  map<string, BoolVariable*>::const_iterator bool_iter =
+      m_bool_variables.begin();
+  for (; bool_iter != m_bool_variables.end(); ++bool_iter) {
+    WriteMetric(output, bool_iter->first, false,
+                bool_iter->second->Get() ? 1 : 0);
+  }
+
+  map<string, IntegerVariable*>::const_iterator int_iter =
+      m_int_variables.begin();
+  for (; int_iter != m_int_variables.end(); ++int_iter) {
+    WriteMetric(output, int_iter->first, false, int_iter->second->Get());
+  }
+
+  map<string, CounterVariable*>::const_iterator counter_iter =
+      m_counter_variables.begin();
+  for (; counter_iter != m_counter_variables.end(); ++counter_iter) {
+    WriteMetric(output, counter_iter->first, true,
+                counter_iter->second->Get());
+  }
+
+  map<string, IntMap*>::const_iterator int_map_iter =
+      m_int_map_variables.begin();
+  for (; int_map_iter != m_int_map_variables.end(); ++int_map_iter) {
+    WriteMetrics(output, int_map_iter->first, int_map_iter->second->Label(),
+                 false, int_map_iter->second->Entries());
+  }
+
+  map<string, UIntMap*>::const_iterator uint_map_iter =
+      m_uint_map_variables.begin();
+  for (; uint_map_iter != m_uint_map_variables.end(); ++uint_map_iter) {
+    WriteMetrics(output, uint_map_iter->first, uint_map_iter->second->Label(),
+                 false, uint_map_iter->second->Entries());
+  }
+
+  map<string, CounterMap*>::const_iterator counter_map_iter =
+      m_counter_map_variables.begin();
+  for (; counter_map_iter != m_counter_map_variables.end();
+       ++counter_map_iter) {
+    map<string, uint64_t> entries;
+    counter_map_iter->second->Entries(&entries);
+    WriteMetrics(output, counter_map_iter->first,
+                 counter_map_iter->second->Label(), true, entries);
+  }
+}
+
+
 template<typename Type>
 Type *ExportMap::GetVar(map<string, Type*> *var_map, const string &name) {
   typename map<string, Type*>::iterator iter;
@@ -19,23 +19,57 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "ola/ExportMap.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
 
 using ola::BaseVariable;
 using ola::BoolVariable;
+using ola::CounterMap;
 using ola::CounterVariable;
 using ola::ExportMap;
 using ola::IntMap;
 using ola::IntegerVariable;
 using ola::StringMap;
 using ola::StringVariable;
+using std::map;
+using std::ostringstream;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Increments a counter from another thread.
+ */
+class IncrementThread: public ola::thread::Thread {
+ public:
+  IncrementThread(CounterMap *map, CounterMap::Handle handle,
+                  unsigned int count)
+      : m_map(map),
+        m_handle(handle),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      m_map->Increment(m_handle);
+    }
+    return NULL;
+  }
+
+ private:
+  CounterMap *m_map;
+  const CounterMap::Handle m_handle;
+  const unsigned int m_count;
+};
+}  // namespace
+
 
 class ExportMapTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ExportMapTest);
@@ -45,7 +79,10 @@ class ExportMapTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testBoolVariable);
   CPPUNIT_TEST(testStringMapVariable);
   CPPUNIT_TEST(testIntMapVariable);
+  CPPUNIT_TEST(testCounterMapVariable);
+  CPPUNIT_TEST(testCounterMapThreads);
   CPPUNIT_TEST(testExportMap);
+  CPPUNIT_TEST(testOpenMetrics);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -55,7 +92,10 @@ class ExportMapTest: public CppUnit::TestFixture {
     void testBoolVariable();
     void testStringMapVariable();
     void testIntMapVariable();
+    void testCounterMapVariable();
+    void testCounterMapThreads();
     void testExportMap();
+    void testOpenMetrics();
 };
 
 
@@ -213,6 +253,80 @@ void ExportMapTest::testIntMapVariable() {
   OLA_ASSERT_EQ(var.Value(), string("map:count key1:1"));
 }
 
+/*
+ * Check that the CounterMap works correctly.
+ */
+void ExportMapTest::testCounterMapVariable() {
+  CounterMap var("counters", "universe");
+  OLA_ASSERT_EQ(string("counters"), var.Name());
+  OLA_ASSERT_EQ(string("universe"), var.Label());
+  OLA_ASSERT_EQ(string("map:universe"), var.Value());
+
+  CounterMap::Handle handle1 = var.Register("1");
+  CounterMap::Handle handle2 = var.Register("2");
+  OLA_ASSERT_NE(CounterMap::INVALID_HANDLE, handle1);
+  OLA_ASSERT_NE(handle1, handle2);
+  OLA_ASSERT_EQ(handle1, var.Register("1"));
+  OLA_ASSERT_EQ(string("map:universe 1:0 2:0"), var.Value());
+
+  var.Increment(handle1);
+  var.Increment(handle1);
+  var.Add(handle2, 10);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), var.Get(handle1));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), var.Get("2"));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), var.Get("3"));
+  OLA_ASSERT_EQ(string("map:universe 1:2 2:10"), var.Value());
+
+  map<string, uint64_t> entries;
+  var.Entries(&entries);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), entries.size());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), entries["1"]);
+
+  // Invalid handles are ignored.
+  var.Increment(CounterMap::INVALID_HANDLE);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0),
+                var.Get(CounterMap::INVALID_HANDLE));
+
+  // A removed handle is reused, starting from 0.
+  var.Remove("1");
+  OLA_ASSERT_EQ(string("map:universe 2:10"), var.Value());
+  CounterMap::Handle handle3 = var.Register("3");
+  OLA_ASSERT_EQ(handle1, handle3);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), var.Get(handle3));
+
+  // Handles span more than one block.
+  for (unsigned int i = 0; i < 200; i++) {
+    ostringstream key;
+    key << "key" << i;
+    var.Increment(var.Register(key.str()));
+  }
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), var.Get("key199"));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), var.Get(handle2));
+}
+
+
+/*
+ * Check increments from many threads are all counted.
+ */
+void ExportMapTest::testCounterMapThreads() {
+  CounterMap var("counters", "");
+  CounterMap::Handle handle = var.Register("frames");
+  const unsigned int count = 10000;
+
+  vector<IncrementThread*> threads;
+  for (unsigned int i = 0; i < 4; i++) {
+    threads.push_back(new IncrementThread(&var, handle, count));
+    threads.back()->Start();
+  }
+  var.Increment(handle);
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4 * count + 1), var.Get(handle));
+}
+
+
 /*
  * Check the export map works correctly.
  */
@@ -238,6 +352,49 @@ void ExportMapTest::testExportMap() {
   OLA_ASSERT_EQ(map_var->Name(), map_var_name);
   OLA_ASSERT_EQ(map_var->Label(), map_var_label);
 
+  CounterMap *counter_map = map.GetCounterMapVar(map_var_name, map_var_label);
+  OLA_ASSERT_EQ(counter_map, map.GetCounterMapVar(map_var_name));
+  OLA_ASSERT_EQ(counter_map->Label(), map_var_label);
+
   vector<BaseVariable*> variables = map.AllVariables();
-  OLA_ASSERT_EQ(variables.size(), (size_t) 4);
+  OLA_ASSERT_EQ(variables.size(), (size_t) 5);
+}
+
+
+/*
+ * Check the OpenMetrics output.
+ */
+void ExportMapTest::testOpenMetrics() {
+  ExportMap map;
+  map.GetBoolVar("running")->Set(true);
+  map.GetIntegerVar("port-count")->Set(-2);
+  (*map.GetCounterVar("rpc-sent")) += 5;
+  (*map.GetCounterVar("bytes_total"))++;
+  map.GetStringVar("version")->Set("1.0");
+  (*map.GetUIntMapVar("universe-ports", "universe"))["1"] = 2;
+  (*map.GetIntMapVar("offsets"))["a\"b"] = -1;
+  CounterMap *frames = map.GetCounterMapVar("universe-dmx-frames",
+                                            "universe");
+  frames->Add(frames->Register("1"), 42);
+  frames->Register("2");
+
+  ostringstream output;
+  map.ExportOpenMetrics(&output);
+  OLA_ASSERT_EQ(string(
+      "# TYPE ola_running gauge\n"
+      "ola_running 1\n"
+      "# TYPE ola_port_count gauge\n"
+      "ola_port_count -2\n"
+      "# TYPE ola_bytes counter\n"
+      "ola_bytes_total 1\n"
+      "# TYPE ola_rpc_sent counter\n"
+      "ola_rpc_sent_total 5\n"
+      "# TYPE ola_offsets gauge\n"
+      "ola_offsets{key=\"a\\\"b\"} -1\n"
+      "# TYPE ola_universe_ports gauge\n"
+      "ola_universe_ports{universe=\"1\"} 2\n"
+      "# TYPE ola_universe_dmx_frames counter\n"
+      "ola_universe_dmx_frames_total{universe=\"1\"} 42\n"
+      "ola_universe_dmx_frames_total{universe=\"2\"} 0\n"),
+      output.str());
 }
@@ -1,6 +1,7 @@
 # LIBRARIES
 ##################################################
 common_libolacommon_la_SOURCES += \
+    common/export_map/CounterMap.cpp \
     common/export_map/ExportMap.cpp
 
 # TESTS
@@ -37,6 +37,8 @@ using std::vector;
 
 const char OlaHTTPServer::K_DATA_DIR_VAR[] = "http_data_dir";
 const char OlaHTTPServer::K_UPTIME_VAR[] = "uptime-in-ms";
+const char OlaHTTPServer::K_OPENMETRICS_CONTENT_TYPE[] =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
 
 /**
  * Create a new OlaHTTPServer.
@@ -49,6 +51,7 @@ OlaHTTPServer::OlaHTTPServer(const HTTPServer::HTTPServerOptions &options,
       m_server(options) {
   RegisterHandler("/debug", &OlaHTTPServer::DisplayDebug);
   RegisterHandler("/help", &OlaHTTPServer::DisplayHandlers);
+  RegisterHandler("/metrics", &OlaHTTPServer::DisplayMetrics);
 
   StringVariable *data_dir_var = export_map->GetStringVar(K_DATA_DIR_VAR);
   data_dir_var->Set(m_server.DataDir());
@@ -93,6 +96,29 @@ int OlaHTTPServer::DisplayDebug(const HTTPRequest*,
 }
 
 
+/**
+ * Display the numeric variables in the ExportMap in the OpenMetrics format,
+ * for Prometheus.
+ */
+int OlaHTTPServer::DisplayMetrics(const HTTPRequest*,
+                                  HTTPResponse *raw_response) {
+  auto_ptr<HTTPResponse> response(raw_response);
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  ola::TimeInterval uptime = now - m_start_time;
+
+  ostringstream str;
+  m_export_map->ExportOpenMetrics(&str);
+  str << "# TYPE ola_uptime_seconds gauge\n"
+      << "ola_uptime_seconds " << uptime.Seconds() << "\n"
+      << "# EOF\n";
+
+  response->SetContentType(K_OPENMETRICS_CONTENT_TYPE);
+  response->Append(str.str());
+  return response->Send();
+}
+
+
 /**
  * Display a list of registered handlers
  */
@@ -361,14 +361,14 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
                               EPollData *epoll_data) {
   if (event->events & (EPOLLHUP | EPOLLRDHUP)) {
     if (epoll_data->read_descriptor) {
-      epoll_data->read_descriptor->PerformRead();
+      HandleRead(epoll_data->read_descriptor);
     } else if (epoll_data->write_descriptor) {
-      epoll_data->write_descriptor->PerformWrite();
+      HandleWrite(epoll_data->write_descriptor);
     } else if (epoll_data->connected_descriptor) {
       ConnectedDescriptor::OnCloseCallback *on_close =
           epoll_data->connected_descriptor->TransferOnClose();
       if (on_close)
-        on_close->Run();
+        HandleClose(on_close);
 
       // At this point the descriptor may be sitting in the orphan list if the
       // OnClose handler called into RemoveReadDescriptor()
@@ -392,9 +392,9 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
 
   if (event->events & EPOLLIN) {
     if (epoll_data->read_descriptor) {
-      epoll_data->read_descriptor->PerformRead();
+      HandleRead(epoll_data->read_descriptor);
     } else if (epoll_data->connected_descriptor) {
-      epoll_data->connected_descriptor->PerformRead();
+      HandleRead(epoll_data->connected_descriptor);
     }
   }
 
@@ -402,7 +402,7 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
     // epoll_data->write_descriptor may be null here if this descriptor was
     // removed between when kevent returned and now.
     if (epoll_data->write_descriptor) {
-      epoll_data->write_descriptor->PerformWrite();
+      HandleWrite(epoll_data->write_descriptor);
     }
   }
 }
@@ -0,0 +1,685 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.cpp
+ * A Poller which uses io_uring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/IOUringPoller.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+using std::pair;
+
+/*
+ * Represents a FD
+ */
+class IOUringData {
+ public:
+  IOUringData() {
+    Reset();
+  }
+
+  void Reset() {
+    fd = INVALID_DESCRIPTOR;
+    events = 0;
+    armed_events = 0;
+    armed = false;
+    cancelling = false;
+    dirty = false;
+    read_descriptor = NULL;
+    write_descriptor = NULL;
+    connected_descriptor = NULL;
+    delete_connected_on_close = false;
+  }
+
+  int fd;
+  // The events we want.
+  uint32_t events;
+  // The events of the outstanding poll request, if armed is true.
+  uint32_t armed_events;
+  bool armed;
+  bool cancelling;
+  bool dirty;
+  ReadFileDescriptor *read_descriptor;
+  WriteFileDescriptor *write_descriptor;
+  ConnectedDescriptor *connected_descriptor;
+  bool delete_connected_on_close;
+};
+
+namespace {
+
+int io_uring_setup(unsigned int entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                   unsigned int flags, void *arg, size_t arg_size) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, arg, arg_size));
+}
+
+unsigned int LoadAcquire(const unsigned int *value) {
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned int *target, unsigned int value) {
+  __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T *RingPointer(void *base, uint32_t offset) {
+  return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(base) + offset);
+}
+}  // namespace
+
+/**
+ * @brief the poll flags used for read descriptors.
+ */
+const uint32_t IOUringPoller::READ_FLAGS = POLLIN | POLLRDHUP;
+
+/**
+ * @brief the poll flags used for write descriptors.
+ */
+const uint32_t IOUringPoller::WRITE_FLAGS = POLLOUT;
+
+/**
+ * @brief The size of the submission ring.
+ *
+ * If more requests than this are queued, they're submitted early.
+ */
+const unsigned int IOUringPoller::RING_SIZE = 256;
+
+/**
+ * @brief The size of the completion ring.
+ *
+ * The kernel holds any completions that don't fit until the next call.
+ */
+const unsigned int IOUringPoller::COMPLETION_RING_SIZE = 4096;
+
+/**
+ * @brief The number of pre-allocated IOUringData to have.
+ */
+const unsigned int IOUringPoller::MAX_FREE_DESCRIPTORS = 10;
+
+IOUringPoller::IOUringPoller(ExportMap *export_map, Clock* clock)
+    : m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_clock(clock),
+      m_ring_fd(INVALID_DESCRIPTOR),
+      m_sq_mmap(MAP_FAILED),
+      m_sq_mmap_size(0),
+      m_cq_mmap(MAP_FAILED),
+      m_cq_mmap_size(0),
+      m_sqe_mmap_size(0) {
+  memset(&m_sq, 0, sizeof(m_sq));
+  memset(&m_cq, 0, sizeof(m_cq));
+
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+  }
+
+  if (SetupRing()) {
+    m_completions.reserve(COMPLETION_RING_SIZE);
+  }
+}
+
+IOUringPoller::~IOUringPoller() {
+  // Closing the ring cancels any outstanding requests.
+  if (m_sq.entries) {
+    munmap(m_sq.entries, m_sqe_mmap_size);
+  }
+  if (m_cq_mmap != MAP_FAILED && m_cq_mmap != m_sq_mmap) {
+    munmap(m_cq_mmap, m_cq_mmap_size);
+  }
+  if (m_sq_mmap != MAP_FAILED) {
+    munmap(m_sq_mmap, m_sq_mmap_size);
+  }
+  if (m_ring_fd != INVALID_DESCRIPTOR) {
+    close(m_ring_fd);
+  }
+
+  {
+    DescriptorMap::iterator iter = m_descriptor_map.begin();
+    for (; iter != m_descriptor_map.end(); ++iter) {
+      if (iter->second->delete_connected_on_close) {
+        delete iter->second->connected_descriptor;
+      }
+      delete iter->second;
+    }
+  }
+
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  for (; iter != m_orphaned_descriptors.end(); ++iter) {
+    if ((*iter)->delete_connected_on_close) {
+      delete (*iter)->connected_descriptor;
+    }
+    delete *iter;
+  }
+
+  STLDeleteElements(&m_free_descriptors);
+}
+
+bool IOUringPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->read_descriptor = descriptor;
+  MarkDirty(result.first);
+  return true;
+}
+
+bool IOUringPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                      bool delete_on_close) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->connected_descriptor = descriptor;
+  result.first->delete_connected_on_close = delete_on_close;
+  MarkDirty(result.first);
+  return true;
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->WriteDescriptor());
+
+  if (result.first->events & WRITE_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  result.first->events |= WRITE_FLAGS;
+  result.first->write_descriptor = descriptor;
+  MarkDirty(result.first);
+  return true;
+}
+
+bool IOUringPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->WriteDescriptor(), WRITE_FLAGS, true);
+}
+
+bool IOUringPoller::Poll(TimeoutManager *timeout_manager,
+                         const TimeInterval &poll_interval) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  TimeInterval sleep_interval = poll_interval;
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (m_wake_up_time.IsSet()) {
+    TimeInterval loop_time = now - m_wake_up_time;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+  }
+
+  if (sleep_interval.IsZero()) {
+    // Match the other pollers, which never busy wait.
+    sleep_interval = TimeInterval(0, 1000);
+  }
+
+  // The poll requests for any new or changed descriptors are submitted with
+  // the wait.
+  UpdateRequests();
+  if (Enter(1, &sleep_interval) < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+    if (errno != ETIME && errno != EBUSY) {
+      OLA_WARN << "io_uring_enter() error, " << strerror(errno);
+      return false;
+    }
+  }
+
+  m_clock->CurrentTime(&m_wake_up_time);
+  ReapCompletions();
+
+  // Now that we're out of the callback phase, clean up descriptors that were
+  // removed.
+  FreeOrphans();
+
+  m_clock->CurrentTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return true;
+}
+
+/*
+ * Create the ring and map the shared memory.
+ */
+bool IOUringPoller::SetupRing() {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = COMPLETION_RING_SIZE;
+
+  int fd = io_uring_setup(RING_SIZE, &params);
+  if (fd < 0) {
+    OLA_WARN << "io_uring_setup() failed: " << strerror(errno);
+    return false;
+  }
+
+  const uint32_t required = IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & required) != required) {
+    OLA_WARN << "io_uring is missing required features, have "
+             << std::hex << params.features;
+    close(fd);
+    return false;
+  }
+
+  m_sq_mmap_size = params.sq_off.array +
+                   params.sq_entries * sizeof(unsigned int);
+  m_cq_mmap_size = params.cq_off.cqes +
+                   params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    m_sq_mmap_size = std::max(m_sq_mmap_size, m_cq_mmap_size);
+  }
+
+  m_sq_mmap = mmap(NULL, m_sq_mmap_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (m_sq_mmap == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring submission ring: "
+             << strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  if (single_mmap) {
+    m_cq_mmap = m_sq_mmap;
+  } else {
+    m_cq_mmap = mmap(NULL, m_cq_mmap_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (m_cq_mmap == MAP_FAILED) {
+      OLA_WARN << "Failed to map the io_uring completion ring: "
+               << strerror(errno);
+      munmap(m_sq_mmap, m_sq_mmap_size);
+      m_sq_mmap = MAP_FAILED;
+      close(fd);
+      return false;
+    }
+  }
+
+  m_sqe_mmap_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = mmap(NULL, m_sqe_mmap_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring submission entries: "
+             << strerror(errno);
+    if (!single_mmap) {
+      munmap(m_cq_mmap, m_cq_mmap_size);
+    }
+    munmap(m_sq_mmap, m_sq_mmap_size);
+    m_sq_mmap = MAP_FAILED;
+    m_cq_mmap = MAP_FAILED;
+    close(fd);
+    return false;
+  }
+
+  m_sq.head = RingPointer<unsigned int>(m_sq_mmap, params.sq_off.head);
+  m_sq.tail = RingPointer<unsigned int>(m_sq_mmap, params.sq_off.tail);
+  m_sq.ring_mask = RingPointer<unsigned int>(m_sq_mmap,
+                                             params.sq_off.ring_mask);
+  m_sq.array = RingPointer<unsigned int>(m_sq_mmap, params.sq_off.array);
+  m_sq.entries = reinterpret_cast<struct io_uring_sqe*>(sqes);
+  m_sq.size = params.sq_entries;
+
+  m_cq.head = RingPointer<unsigned int>(m_cq_mmap, params.cq_off.head);
+  m_cq.tail = RingPointer<unsigned int>(m_cq_mmap, params.cq_off.tail);
+  m_cq.ring_mask = RingPointer<unsigned int>(m_cq_mmap,
+                                             params.cq_off.ring_mask);
+  m_cq.entries = RingPointer<struct io_uring_cqe>(m_cq_mmap,
+                                                  params.cq_off.cqes);
+  m_ring_fd = fd;
+  OLA_DEBUG << "io_uring set up with " << params.sq_entries << " / "
+            << params.cq_entries << " entries";
+  return true;
+}
+
+std::pair<IOUringData*, bool> IOUringPoller::LookupOrCreateDescriptor(
+    int fd) {
+  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
+      DescriptorMap::value_type(fd, NULL));
+  bool new_descriptor = result.second;
+
+  if (new_descriptor) {
+    if (m_free_descriptors.empty()) {
+      result.first->second = new IOUringData();
+    } else {
+      result.first->second = m_free_descriptors.back();
+      m_free_descriptors.pop_back();
+    }
+    result.first->second->fd = fd;
+  }
+  return std::make_pair(result.first->second, new_descriptor);
+}
+
+bool IOUringPoller::RemoveDescriptor(int fd, uint32_t event,
+                                     bool warn_on_missing) {
+  if (fd == INVALID_DESCRIPTOR) {
+    OLA_WARN << "Attempt to remove an invalid file descriptor";
+    return false;
+  }
+
+  IOUringData *data = STLFindOrNull(m_descriptor_map, fd);
+  if (!data) {
+    if (warn_on_missing) {
+      OLA_WARN << "Couldn't find IOUringData for " << fd;
+    }
+    return false;
+  }
+
+  data->events &= (~event);
+
+  if (event & WRITE_FLAGS) {
+    data->write_descriptor = NULL;
+  } else if (event & POLLIN) {
+    data->read_descriptor = NULL;
+    data->connected_descriptor = NULL;
+  }
+
+  if (data->events == 0) {
+    // The fd may be closed and reused as soon as we return, so a new
+    // registration gets new IOUringData. This one lives until the kernel is
+    // done with it.
+    m_orphaned_descriptors.push_back(
+        STLLookupAndRemovePtr(&m_descriptor_map, fd));
+  }
+  MarkDirty(data);
+  return true;
+}
+
+void IOUringPoller::MarkDirty(IOUringData *data) {
+  if (!data->dirty) {
+    data->dirty = true;
+    m_dirty_descriptors.push_back(data);
+  }
+}
+
+/*
+ * Queue poll requests for new descriptors and cancel the requests that no
+ * longer match. Cancelled requests are re-armed once the cancellation
+ * completes.
+ */
+void IOUringPoller::UpdateRequests() {
+  DescriptorList::iterator iter = m_dirty_descriptors.begin();
+  for (; iter != m_dirty_descriptors.end(); ++iter) {
+    IOUringData *data = *iter;
+    data->dirty = false;
+    if (data->armed) {
+      if (data->armed_events != data->events && !data->cancelling) {
+        struct io_uring_sqe *sqe = NextSubmission();
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uintptr_t>(data);
+        data->cancelling = true;
+      }
+    } else if (data->events) {
+      struct io_uring_sqe *sqe = NextSubmission();
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = data->fd;
+      sqe->poll32_events = data->events;
+      sqe->user_data = reinterpret_cast<uintptr_t>(data);
+      data->armed = true;
+      data->armed_events = data->events;
+    }
+  }
+  m_dirty_descriptors.clear();
+}
+
+/*
+ * Return the next free submission entry, submitting the queued entries if
+ * the ring is full.
+ */
+struct io_uring_sqe *IOUringPoller::NextSubmission() {
+  unsigned int tail = *m_sq.tail;
+  if (tail - LoadAcquire(m_sq.head) == m_sq.size) {
+    while (Enter(0, NULL) < 0 && (errno == EINTR || errno == EAGAIN ||
+                                   errno == EBUSY)) {
+    }
+  }
+
+  unsigned int index = tail & *m_sq.ring_mask;
+  struct io_uring_sqe *sqe = &m_sq.entries[index];
+  memset(sqe, 0, sizeof(*sqe));
+  m_sq.array[index] = index;
+  StoreRelease(m_sq.tail, tail + 1);
+  return sqe;
+}
+
+/*
+ * Submit the queued requests, and optionally wait for completions.
+ */
+int IOUringPoller::Enter(unsigned int min_complete,
+                         const TimeInterval *timeout) {
+  unsigned int to_submit = *m_sq.tail - LoadAcquire(m_sq.head);
+  if (!timeout) {
+    return io_uring_enter(m_ring_fd, to_submit, min_complete,
+                          min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  }
+
+  struct __kernel_timespec ts;
+  ts.tv_sec = timeout->Seconds();
+  ts.tv_nsec = timeout->MicroSeconds() * 1000;
+
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.ts = reinterpret_cast<uintptr_t>(&ts);
+  return io_uring_enter(m_ring_fd, to_submit, min_complete,
+                        IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                        sizeof(arg));
+}
+
+/*
+ * Copy the completions out of the ring and run the callbacks.
+ */
+void IOUringPoller::ReapCompletions() {
+  unsigned int head = *m_cq.head;
+  const unsigned int tail = LoadAcquire(m_cq.tail);
+  for (; head != tail; head++) {
+    const struct io_uring_cqe &cqe = m_cq.entries[head & *m_cq.ring_mask];
+    // Cancellations don't have user_data.
+    if (cqe.user_data) {
+      Completion completion;
+      completion.data = reinterpret_cast<IOUringData*>(
+          static_cast<uintptr_t>(cqe.user_data));
+      completion.result = cqe.res;
+      m_completions.push_back(completion);
+    }
+  }
+  StoreRelease(m_cq.head, head);
+
+  std::vector<Completion>::const_iterator iter = m_completions.begin();
+  for (; iter != m_completions.end(); ++iter) {
+    IOUringData *data = iter->data;
+    data->armed = false;
+    data->armed_events = 0;
+    data->cancelling = false;
+
+    if (iter->result < 0 && iter->result != -ECANCELED) {
+      // Don't re-arm, we'd just get the same error again.
+      OLA_WARN << "Poll for " << data->fd << " failed: "
+               << strerror(-iter->result);
+      continue;
+    }
+
+    // Removed descriptors may still have a completion pending.
+    if (iter->result > 0 && data->events) {
+      CheckDescriptor(iter->result, data);
+    }
+    if (data->events) {
+      MarkDirty(data);
+    }
+  }
+  m_completions.clear();
+}
+
+/*
+ * Check a descriptor with events:
+ *  - Execute the callback for descriptors with data
+ *  - Execute OnClose if a remote end closed the connection
+ */
+void IOUringPoller::CheckDescriptor(uint32_t events, IOUringData *data) {
+  if (events & (POLLHUP | POLLRDHUP)) {
+    if (data->read_descriptor) {
+      HandleRead(data->read_descriptor);
+    } else if (data->write_descriptor) {
+      HandleWrite(data->write_descriptor);
+    } else if (data->connected_descriptor) {
+      ConnectedDescriptor::OnCloseCallback *on_close =
+          data->connected_descriptor->TransferOnClose();
+      if (on_close)
+        HandleClose(on_close);
+
+      // At this point the descriptor may be sitting in the orphan list if the
+      // OnClose handler called into RemoveReadDescriptor()
+      if (data->delete_connected_on_close && data->connected_descriptor) {
+        bool removed = RemoveDescriptor(
+            data->connected_descriptor->ReadDescriptor(), READ_FLAGS, false);
+        if (removed && m_export_map) {
+          (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+        }
+        delete data->connected_descriptor;
+        data->connected_descriptor = NULL;
+      }
+    } else {
+      OLA_FATAL << "HUP event for " << data
+                << " but no write or connected descriptor found!";
+    }
+    events = 0;
+  }
+
+  if (events & POLLIN) {
+    if (data->read_descriptor) {
+      HandleRead(data->read_descriptor);
+    } else if (data->connected_descriptor) {
+      HandleRead(data->connected_descriptor);
+    }
+  }
+
+  if (events & POLLOUT) {
+    // data->write_descriptor may be null here if this descriptor was removed
+    // by an earlier callback.
+    if (data->write_descriptor) {
+      HandleWrite(data->write_descriptor);
+    }
+  }
+}
+
+/*
+ * Free the removed descriptors that the kernel is done with.
+ */
+void IOUringPoller::FreeOrphans() {
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  while (iter != m_orphaned_descriptors.end()) {
+    IOUringData *data = *iter;
+    // Orphans with a poll outstanding are cancelled on the next call, and
+    // freed once the cancellation completes.
+    if (data->armed || data->dirty) {
+      ++iter;
+      continue;
+    }
+
+    if (m_free_descriptors.size() == MAX_FREE_DESCRIPTORS) {
+      delete data;
+    } else {
+      data->Reset();
+      m_free_descriptors.push_back(data);
+    }
+    iter = m_orphaned_descriptors.erase(iter);
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,160 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.h
+ * A Poller which uses io_uring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_IOURINGPOLLER_H_
+#define COMMON_IO_IOURINGPOLLER_H_
+
+#include <ola/base/Macro.h>
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/io/Descriptor.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+class IOUringData;
+
+/**
+ * @class IOUringPoller
+ * @brief An implementation of PollerInterface that uses io_uring.
+ *
+ * Each descriptor has a poll request in the submission ring. Adding and
+ * removing descriptors only queues requests, these are submitted along with
+ * the wait for events, so each iteration of the loop is a single system call
+ * no matter how many descriptors change or become ready. Unlike the EPoller
+ * there is no limit on the number of events handled per iteration.
+ *
+ * The poll requests are one-shot and re-armed after the descriptor has been
+ * handled. Multishot polls only report new events, and the descriptors
+ * rely on being told again if they didn't read everything.
+ *
+ * io_uring needs Linux 5.11 or later and may be blocked by a seccomp
+ * policy, so check IsValid() and fall back to another Poller if it fails.
+ */
+class IOUringPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new IOUringPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  IOUringPoller(ExportMap *export_map, Clock *clock);
+
+  ~IOUringPoller();
+
+  /**
+   * @brief Check if the ring was set up.
+   */
+  bool IsValid() const { return m_ring_fd != INVALID_DESCRIPTOR; }
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+ private:
+  typedef std::map<int, IOUringData*> DescriptorMap;
+  typedef std::vector<IOUringData*> DescriptorList;
+
+  struct Completion {
+    IOUringData *data;
+    int32_t result;
+  };
+
+  struct SubmissionRing {
+    unsigned int *head;
+    unsigned int *tail;
+    unsigned int *ring_mask;
+    unsigned int *array;
+    struct io_uring_sqe *entries;
+    unsigned int size;
+  };
+
+  struct CompletionRing {
+    unsigned int *head;
+    unsigned int *tail;
+    unsigned int *ring_mask;
+    struct io_uring_cqe *entries;
+  };
+
+  DescriptorMap m_descriptor_map;
+  // Descriptors that need their poll request updated.
+  DescriptorList m_dirty_descriptors;
+  // Removed descriptors. These are freed once they have no outstanding poll
+  // request and we're out of the callback loop.
+  DescriptorList m_orphaned_descriptors;
+  DescriptorList m_free_descriptors;
+  std::vector<Completion> m_completions;
+
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+
+  int m_ring_fd;
+  void *m_sq_mmap;
+  size_t m_sq_mmap_size;
+  void *m_cq_mmap;
+  size_t m_cq_mmap_size;
+  size_t m_sqe_mmap_size;
+  SubmissionRing m_sq;
+  CompletionRing m_cq;
+
+  bool SetupRing();
+  std::pair<IOUringData*, bool> LookupOrCreateDescriptor(int fd);
+  bool RemoveDescriptor(int fd, uint32_t event, bool warn_on_missing);
+  void MarkDirty(IOUringData *data);
+  void UpdateRequests();
+  struct io_uring_sqe *NextSubmission();
+  int Enter(unsigned int min_complete, const TimeInterval *timeout);
+  void ReapCompletions();
+  void CheckDescriptor(uint32_t events, IOUringData *data);
+  void FreeOrphans();
+
+  static const uint32_t READ_FLAGS;
+  static const uint32_t WRITE_FLAGS;
+  static const unsigned int RING_SIZE;
+  static const unsigned int COMPLETION_RING_SIZE;
+  static const unsigned int MAX_FREE_DESCRIPTORS;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_IOURINGPOLLER_H_
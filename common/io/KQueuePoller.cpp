@@ -311,13 +311,13 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
       event->udata);
   if (event->filter == EVFILT_READ) {
     if (kqueue_data->read_descriptor) {
-      kqueue_data->read_descriptor->PerformRead();
+      HandleRead(kqueue_data->read_descriptor);
     } else if (kqueue_data->connected_descriptor) {
       ConnectedDescriptor *connected_descriptor =
           kqueue_data->connected_descriptor;
 
       if (event->data) {
-        connected_descriptor->PerformRead();
+        HandleRead(connected_descriptor);
       } else if (event->flags & EV_EOF) {
         // The remote end closed the descriptor.
         // According to man kevent, closing the descriptor removes it from the
@@ -331,7 +331,7 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
         ConnectedDescriptor::OnCloseCallback *on_close =
             connected_descriptor->TransferOnClose();
         if (on_close)
-          on_close->Run();
+          HandleClose(on_close);
 
         // At this point the descriptor may be sitting in the orphan list
         // if the OnClose handler called into RemoveReadDescriptor()
@@ -355,7 +355,7 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
     // kqueue_data->write_descriptor may be null here if this descriptor was
     // removed between when kevent returned and now.
     if (kqueue_data->write_descriptor) {
-      kqueue_data->write_descriptor->PerformWrite();
+      HandleWrite(kqueue_data->write_descriptor);
     }
   }
 }
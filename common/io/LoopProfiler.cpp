@@ -0,0 +1,235 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.cpp
+ * Records the time taken by the SelectServer callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/LoopProfiler.h"
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif  // __GNUG__
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+using std::string;
+
+/**
+ * @brief The number of times each callback ran since the last publish.
+ */
+const char LoopProfiler::K_CALLBACK_COUNT_VAR[] = "ss-callback-count";
+
+/**
+ * @brief The 99th percentile of the time taken by each callback.
+ */
+const char LoopProfiler::K_CALLBACK_P99_VAR[] = "ss-callback-p99-us";
+
+/**
+ * @brief The longest time taken by each callback.
+ */
+const char LoopProfiler::K_CALLBACK_MAX_VAR[] = "ss-callback-max-us";
+
+/**
+ * @brief Percentiles of the time spent in callbacks per loop iteration.
+ */
+const char LoopProfiler::K_ITERATION_VAR[] = "ss-loop-busy-us";
+
+/**
+ * @brief The number of iterations that exceeded the stall budget.
+ */
+const char LoopProfiler::K_STALL_COUNT_VAR[] = "ss-loop-stalls";
+
+/**
+ * @brief A description of the last stall.
+ */
+const char LoopProfiler::K_LAST_STALL_VAR[] = "ss-last-stall";
+
+LoopProfiler::LoopProfiler(ExportMap *export_map, Clock *clock,
+                           const TimeInterval &stall_budget)
+    : m_export_map(export_map),
+      m_clock(clock),
+      m_stall_budget(stall_budget.AsInt()),
+      m_busy_usec(0),
+      m_slowest(NULL),
+      m_slowest_usec(0),
+      m_slowest_descriptor(-1),
+      m_stall_count(0) {
+  m_clock->CurrentTime(&m_last_publish);
+  if (m_export_map) {
+    m_export_map->GetCounterVar(K_STALL_COUNT_VAR);
+    m_export_map->GetStringVar(K_LAST_STALL_VAR);
+  }
+}
+
+LoopProfiler::~LoopProfiler() {
+  STLDeleteValues(&m_callbacks);
+}
+
+void LoopProfiler::EndIteration() {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  if (m_slowest) {
+    m_iteration_histogram.Record(m_busy_usec);
+    if (m_stall_budget && m_busy_usec > m_stall_budget) {
+      ReportStall(now);
+    }
+  }
+  m_busy_usec = 0;
+  m_slowest = NULL;
+  m_slowest_usec = 0;
+  m_slowest_descriptor = -1;
+
+  if (now - m_last_publish >= TimeInterval(PUBLISH_INTERVAL_SECONDS, 0)) {
+    Publish();
+    m_last_publish = now;
+  }
+}
+
+void LoopProfiler::Publish() {
+  if (!m_export_map) {
+    return;
+  }
+
+  UIntMap *counts = m_export_map->GetUIntMapVar(K_CALLBACK_COUNT_VAR,
+                                                "callback");
+  UIntMap *p99 = m_export_map->GetUIntMapVar(K_CALLBACK_P99_VAR, "callback");
+  UIntMap *max = m_export_map->GetUIntMapVar(K_CALLBACK_MAX_VAR, "callback");
+  CallbackMap::const_iterator iter = m_callbacks.begin();
+  for (; iter != m_callbacks.end(); ++iter) {
+    CallbackStats *stats = iter->second;
+    counts->Set(stats->name,
+                static_cast<unsigned int>(stats->histogram.Count()));
+    p99->Set(stats->name,
+             static_cast<unsigned int>(stats->histogram.Percentile(99)));
+    max->Set(stats->name, static_cast<unsigned int>(stats->histogram.Max()));
+    stats->histogram.Reset();
+  }
+
+  UIntMap *iteration = m_export_map->GetUIntMapVar(K_ITERATION_VAR,
+                                                   "percentile");
+  iteration->Set("p50",
+                 static_cast<unsigned int>(
+                     m_iteration_histogram.Percentile(50)));
+  iteration->Set("p99",
+                 static_cast<unsigned int>(
+                     m_iteration_histogram.Percentile(99)));
+  iteration->Set("p99.9",
+                 static_cast<unsigned int>(
+                     m_iteration_histogram.Percentile(99.9)));
+  iteration->Set("max",
+                 static_cast<unsigned int>(m_iteration_histogram.Max()));
+  m_iteration_histogram.Reset();
+}
+
+const LatencyHistogram *LoopProfiler::GetHistogram(
+    const std::type_info &type,
+    CallbackType callback_type) const {
+  const CallbackStats *stats = STLFindOrNull(
+      m_callbacks, CallbackKey(&type, callback_type));
+  return stats ? &stats->histogram : NULL;
+}
+
+void LoopProfiler::Record(const std::type_info &type,
+                          CallbackType callback_type,
+                          int descriptor,
+                          const TimeStamp &start) {
+  TimeStamp end;
+  m_clock->CurrentTime(&end);
+  int64_t elapsed = (end - start).AsInt();
+  uint64_t usec = elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0;
+
+  const CallbackKey key(&type, callback_type);
+  CallbackMap::iterator iter = m_callbacks.find(key);
+  if (iter == m_callbacks.end()) {
+    CallbackStats *stats = new CallbackStats();
+    stats->name = CallbackName(type, callback_type);
+    iter = m_callbacks.insert(CallbackMap::value_type(key, stats)).first;
+  }
+  iter->second->histogram.Record(usec);
+
+  m_busy_usec += usec;
+  if (!m_slowest || usec > m_slowest_usec) {
+    m_slowest = iter->second;
+    m_slowest_usec = usec;
+    m_slowest_descriptor = descriptor;
+  }
+}
+
+void LoopProfiler::ReportStall(const TimeStamp &now) {
+  m_stall_count++;
+
+  std::ostringstream str;
+  str << now << ": callbacks took " << m_busy_usec << "us, slowest was "
+      << m_slowest->name;
+  if (m_slowest_descriptor >= 0) {
+    str << " on fd " << m_slowest_descriptor;
+  }
+  str << " at " << m_slowest_usec << "us";
+  m_last_stall = str.str();
+  OLA_WARN << "SelectServer stall: " << m_last_stall;
+
+  if (m_export_map) {
+    (*m_export_map->GetCounterVar(K_STALL_COUNT_VAR))++;
+    m_export_map->GetStringVar(K_LAST_STALL_VAR)->Set(m_last_stall);
+  }
+}
+
+string LoopProfiler::CallbackName(const std::type_info &type,
+                                  CallbackType callback_type) {
+  string name;
+  switch (callback_type) {
+    case READ_CALLBACK:
+      name = "read ";
+      break;
+    case WRITE_CALLBACK:
+      name = "write ";
+      break;
+    case CLOSE_CALLBACK:
+      name = "close ";
+      break;
+    case TIMEOUT_CALLBACK:
+      name = "timeout ";
+      break;
+    case LOOP_CALLBACK:
+      name = "loop ";
+      break;
+  }
+
+#ifdef __GNUG__
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+  if (demangled && status == 0) {
+    name.append(demangled);
+    free(demangled);
+    return name;
+  }
+  free(demangled);
+#endif  // __GNUG__
+  name.append(type.name());
+  return name;
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,201 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.h
+ * Records the time taken by the SelectServer callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_LOOPPROFILER_H_
+#define COMMON_IO_LOOPPROFILER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/util/LatencyHistogram.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @brief Records the time taken by the SelectServer callbacks.
+ *
+ * Each descriptor and timeout callback is timed and recorded in a histogram
+ * for its type, e.g. reads on a UDPSocket. The time spent running callbacks
+ * in each iteration of the loop is also recorded; if it exceeds the stall
+ * budget a warning is logged with the slowest callback.
+ *
+ * The histograms are copied to the ExportMap once a second, so they appear
+ * on the /debug page, and then cleared.
+ *
+ * The SelectServer only creates a LoopProfiler if profiling is enabled.
+ * Otherwise the cost is a NULL check per callback.
+ */
+class LoopProfiler {
+ public:
+  enum CallbackType {
+    READ_CALLBACK,
+    WRITE_CALLBACK,
+    CLOSE_CALLBACK,
+    TIMEOUT_CALLBACK,
+    LOOP_CALLBACK,
+  };
+
+  /**
+   * @brief Times a callback, from construction until it goes out of scope.
+   */
+  class Sample {
+   public:
+    /**
+     * @brief Start timing a callback.
+     * @param profiler the LoopProfiler to record the time in.
+     * @param type the type of the object that runs the callback, usually the
+     *   descriptor or closure.
+     * @param callback_type the kind of callback.
+     * @param descriptor the descriptor number, or -1.
+     */
+    Sample(LoopProfiler *profiler, const std::type_info &type,
+           CallbackType callback_type, int descriptor = -1)
+        : m_profiler(profiler),
+          m_type(type),
+          m_callback_type(callback_type),
+          m_descriptor(descriptor) {
+      m_profiler->m_clock->CurrentTime(&m_start);
+    }
+
+    ~Sample() {
+      m_profiler->Record(m_type, m_callback_type, m_descriptor, m_start);
+    }
+
+   private:
+    LoopProfiler *m_profiler;
+    const std::type_info &m_type;
+    CallbackType m_callback_type;
+    int m_descriptor;
+    TimeStamp m_start;
+
+    DISALLOW_COPY_AND_ASSIGN(Sample);
+  };
+
+  /**
+   * @brief Create a new LoopProfiler.
+   * @param export_map the ExportMap to publish to, may be NULL.
+   * @param clock the Clock to use.
+   * @param stall_budget log a warning when the callbacks in an iteration of
+   *   the loop take longer than this. Zero disables the warnings.
+   */
+  LoopProfiler(ExportMap *export_map, Clock *clock,
+               const TimeInterval &stall_budget);
+  ~LoopProfiler();
+
+  /**
+   * @brief Called at the end of each iteration of the loop.
+   */
+  void EndIteration();
+
+  /**
+   * @brief Copy the histograms to the ExportMap, and clear them.
+   */
+  void Publish();
+
+  /**
+   * @brief Return the histogram for a callback.
+   * @returns the histogram, or NULL if the callback hasn't run.
+   */
+  const LatencyHistogram *GetHistogram(const std::type_info &type,
+                                       CallbackType callback_type) const;
+
+  /**
+   * @brief The histogram of the time spent in callbacks per iteration.
+   */
+  const LatencyHistogram &IterationHistogram() const {
+    return m_iteration_histogram;
+  }
+
+  /**
+   * @brief The number of iterations that exceeded the stall budget.
+   */
+  unsigned int StallCount() const { return m_stall_count; }
+
+  /**
+   * @brief A description of the last stall.
+   */
+  const std::string &LastStall() const { return m_last_stall; }
+
+  static const char K_CALLBACK_COUNT_VAR[];
+  static const char K_CALLBACK_P99_VAR[];
+  static const char K_CALLBACK_MAX_VAR[];
+  static const char K_ITERATION_VAR[];
+  static const char K_STALL_COUNT_VAR[];
+  static const char K_LAST_STALL_VAR[];
+
+ private:
+  struct CallbackStats {
+    std::string name;
+    LatencyHistogram histogram;
+  };
+
+  typedef std::pair<const std::type_info*, CallbackType> CallbackKey;
+
+  struct CallbackKeyLess {
+    bool operator()(const CallbackKey &a, const CallbackKey &b) const {
+      if (*a.first == *b.first) {
+        return a.second < b.second;
+      }
+      return a.first->before(*b.first);
+    }
+  };
+
+  typedef std::map<CallbackKey, CallbackStats*, CallbackKeyLess> CallbackMap;
+
+  ExportMap *m_export_map;
+  Clock *m_clock;
+  const uint64_t m_stall_budget;
+  CallbackMap m_callbacks;
+  LatencyHistogram m_iteration_histogram;
+  TimeStamp m_last_publish;
+
+  // The current iteration.
+  uint64_t m_busy_usec;
+  const CallbackStats *m_slowest;
+  uint64_t m_slowest_usec;
+  int m_slowest_descriptor;
+
+  unsigned int m_stall_count;
+  std::string m_last_stall;
+
+  void Record(const std::type_info &type, CallbackType callback_type,
+              int descriptor, const TimeStamp &start);
+  void ReportStall(const TimeStamp &now);
+
+  static std::string CallbackName(const std::type_info &type,
+                                  CallbackType callback_type);
+
+  static const unsigned int PUBLISH_INTERVAL_SECONDS = 1;
+
+  friend class Sample;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopProfiler);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_LOOPPROFILER_H_
@@ -0,0 +1,193 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfilerTest.cpp
+ * Test fixture for the LoopProfiler class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/io/LoopProfiler.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::ExportMap;
+using ola::LatencyHistogram;
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::io::LoopProfiler;
+using ola::io::SelectServer;
+using std::string;
+
+class LoopProfilerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(LoopProfilerTest);
+  CPPUNIT_TEST(testCallbacks);
+  CPPUNIT_TEST(testStalls);
+  CPPUNIT_TEST(testSelectServer);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testCallbacks();
+  void testStalls();
+  void testSelectServer();
+
+ private:
+  MockClock m_clock;
+
+  class ReadHandler {};
+  class TimeoutHandler {};
+
+  void RunFor(LoopProfiler *profiler, const std::type_info &type,
+              LoopProfiler::CallbackType callback_type,
+              const TimeInterval &duration) {
+    LoopProfiler::Sample sample(profiler, type, callback_type, 7);
+    m_clock.AdvanceTime(duration);
+  }
+
+  void SlowTimeout(SelectServer *ss) {
+    m_clock.AdvanceTime(TimeInterval(0, 20000));
+    ss->Terminate();
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LoopProfilerTest);
+
+
+/*
+ * Check callbacks are recorded by type.
+ */
+void LoopProfilerTest::testCallbacks() {
+  ExportMap export_map;
+  LoopProfiler profiler(&export_map, &m_clock, TimeInterval(0, 5000));
+
+  OLA_ASSERT_NULL(profiler.GetHistogram(typeid(ReadHandler),
+                                        LoopProfiler::READ_CALLBACK));
+
+  RunFor(&profiler, typeid(ReadHandler), LoopProfiler::READ_CALLBACK,
+         TimeInterval(0, 1000));
+  RunFor(&profiler, typeid(ReadHandler), LoopProfiler::READ_CALLBACK,
+         TimeInterval(0, 2000));
+  RunFor(&profiler, typeid(ReadHandler), LoopProfiler::WRITE_CALLBACK,
+         TimeInterval(0, 500));
+  profiler.EndIteration();
+
+  const LatencyHistogram *reads = profiler.GetHistogram(
+      typeid(ReadHandler), LoopProfiler::READ_CALLBACK);
+  OLA_ASSERT_NOT_NULL(reads);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), reads->Count());
+  OLA_ASSERT_TRUE(reads->Max() >= 2000);
+
+  const LatencyHistogram *writes = profiler.GetHistogram(
+      typeid(ReadHandler), LoopProfiler::WRITE_CALLBACK);
+  OLA_ASSERT_NOT_NULL(writes);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), writes->Count());
+
+  OLA_ASSERT_NULL(profiler.GetHistogram(typeid(TimeoutHandler),
+                                        LoopProfiler::READ_CALLBACK));
+
+  // One iteration, which was busy for at least 3.5ms.
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                profiler.IterationHistogram().Count());
+  OLA_ASSERT_TRUE(profiler.IterationHistogram().Max() >= 3500);
+
+  // Idle iterations aren't recorded.
+  profiler.EndIteration();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                profiler.IterationHistogram().Count());
+
+  profiler.Publish();
+  ola::UIntMap *counts = export_map.GetUIntMapVar(
+      LoopProfiler::K_CALLBACK_COUNT_VAR);
+  OLA_ASSERT_EQ(2u, (*counts)["read LoopProfilerTest::ReadHandler"]);
+  OLA_ASSERT_EQ(1u, (*counts)["write LoopProfilerTest::ReadHandler"]);
+  ola::UIntMap *max = export_map.GetUIntMapVar(
+      LoopProfiler::K_CALLBACK_MAX_VAR);
+  OLA_ASSERT_TRUE((*max)["read LoopProfilerTest::ReadHandler"] >= 2000);
+
+  // Publishing clears the histograms.
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), reads->Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0),
+                profiler.IterationHistogram().Count());
+}
+
+
+/*
+ * Check iterations over the budget are reported.
+ */
+void LoopProfilerTest::testStalls() {
+  ExportMap export_map;
+  LoopProfiler profiler(&export_map, &m_clock, TimeInterval(0, 5000));
+
+  RunFor(&profiler, typeid(ReadHandler), LoopProfiler::READ_CALLBACK,
+         TimeInterval(0, 1000));
+  profiler.EndIteration();
+  OLA_ASSERT_EQ(0u, profiler.StallCount());
+
+  RunFor(&profiler, typeid(ReadHandler), LoopProfiler::READ_CALLBACK,
+         TimeInterval(0, 1000));
+  RunFor(&profiler, typeid(TimeoutHandler), LoopProfiler::TIMEOUT_CALLBACK,
+         TimeInterval(0, 8000));
+  profiler.EndIteration();
+  OLA_ASSERT_EQ(1u, profiler.StallCount());
+  OLA_ASSERT_EQ(1u, export_map.GetCounterVar(
+      LoopProfiler::K_STALL_COUNT_VAR)->Get());
+
+  // The slowest callback is named.
+  const string &stall = profiler.LastStall();
+  OLA_ASSERT_NE(string::npos,
+                stall.find("timeout LoopProfilerTest::TimeoutHandler"));
+  OLA_ASSERT_EQ(stall, export_map.GetStringVar(
+      LoopProfiler::K_LAST_STALL_VAR)->Get());
+
+  // A budget of 0 disables stall detection.
+  LoopProfiler unlimited(NULL, &m_clock, TimeInterval());
+  RunFor(&unlimited, typeid(ReadHandler), LoopProfiler::READ_CALLBACK,
+         TimeInterval(10, 0));
+  unlimited.EndIteration();
+  OLA_ASSERT_EQ(0u, unlimited.StallCount());
+}
+
+
+/*
+ * Check a slow timeout in the SelectServer is reported.
+ */
+void LoopProfilerTest::testSelectServer() {
+  ExportMap export_map;
+  SelectServer::Options options;
+  options.export_map = &export_map;
+  options.clock = &m_clock;
+  options.profile_loop = true;
+  SelectServer ss(options);
+
+  ss.RegisterSingleTimeout(
+      0,
+      NewSingleCallback(this, &LoopProfilerTest::SlowTimeout, &ss));
+  ss.Run();
+
+  OLA_ASSERT_TRUE(
+      export_map.GetCounterVar(LoopProfiler::K_STALL_COUNT_VAR)->Get() >= 1);
+  OLA_ASSERT_NE(string::npos,
+                export_map.GetStringVar(
+                    LoopProfiler::K_LAST_STALL_VAR)->Get().find("timeout "));
+}
@@ -7,6 +7,8 @@ common_libolacommon_la_SOURCES += \
     common/io/IOQueue.cpp \
     common/io/IOStack.cpp \
     common/io/IOUtils.cpp \
+    common/io/LoopProfiler.cpp \
+    common/io/LoopProfiler.h \
     common/io/NonBlockingSender.cpp \
     common/io/PollerInterface.cpp \
     common/io/PollerInterface.h \
@@ -14,7 +16,9 @@ common_libolacommon_la_SOURCES += \
     common/io/Serial.cpp \
     common/io/StdinHandler.cpp \
     common/io/TimeoutManager.cpp \
-    common/io/TimeoutManager.h
+    common/io/TimeoutManager.h \
+    common/io/TimerWheel.cpp \
+    common/io/TimerWheel.h
 
 if USING_WIN32
 common_libolacommon_la_SOURCES += \
@@ -38,6 +42,23 @@ common_libolacommon_la_SOURCES += \
     common/io/KQueuePoller.cpp
 endif
 
+if HAVE_IO_URING
+common_libolacommon_la_SOURCES += \
+    common/io/IOUringPoller.h \
+    common/io/IOUringPoller.cpp
+endif
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/io/poller_benchmark \
+                   common/io/timeout_benchmark
+
+common_io_poller_benchmark_SOURCES = common/io/PollerBenchmark.cpp
+common_io_poller_benchmark_LDADD = common/libolacommon.la
+
+common_io_timeout_benchmark_SOURCES = common/io/TimeoutBenchmark.cpp
+common_io_timeout_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -65,12 +86,14 @@ common_io_MemoryBlockTester_SOURCES = common/io/MemoryBlockTest.cpp
 common_io_MemoryBlockTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_MemoryBlockTester_LDADD = $(COMMON_TESTING_LIBS)
 
-common_io_SelectServerTester_SOURCES = common/io/SelectServerTest.cpp \
+common_io_SelectServerTester_SOURCES = common/io/LoopProfilerTest.cpp \
+                                       common/io/SelectServerTest.cpp \
                                        common/io/SelectServerThreadTest.cpp
 common_io_SelectServerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_SelectServerTester_LDADD = $(COMMON_TESTING_LIBS)
 
-common_io_TimeoutManagerTester_SOURCES = common/io/TimeoutManagerTest.cpp
+common_io_TimeoutManagerTester_SOURCES = common/io/TimeoutManagerTest.cpp \
+                                         common/io/TimerWheelTest.cpp
 common_io_TimeoutManagerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_TimeoutManagerTester_LDADD = $(COMMON_TESTING_LIBS)
 
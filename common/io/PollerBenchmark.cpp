@@ -0,0 +1,193 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PollerBenchmark.cpp
+ * Compare the SelectServer pollers with many busy UDP sockets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/stl/STLUtils.h"
+
+using ola::Clock;
+using ola::ExportMap;
+using ola::NewCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(sockets, s, 200, "The number of UDP sockets to receive on");
+DEFINE_s_uint32(rounds, r, 2000,
+                "The number of rounds, each sends one packet to each socket");
+DEFINE_uint32(packet_size, 512, "The size of each packet");
+
+static unsigned int packets_received = 0;
+
+/*
+ * Read one packet, as the Art-Net and E1.31 nodes do.
+ */
+void ReceivePacket(UDPSocket *socket) {
+  uint8_t buffer[1500];
+  ssize_t size = sizeof(buffer);
+  if (socket->RecvFrom(buffer, &size)) {
+    packets_received++;
+  }
+}
+
+struct Result {
+  bool valid;
+  TimeInterval duration;
+  unsigned int iterations;
+};
+
+/*
+ * Run the load with one SelectServer configuration.
+ */
+void RunLoad(const SelectServer::Options &base_options, const char *var,
+             Result *result) {
+  ExportMap export_map;
+  SelectServer::Options options = base_options;
+  options.export_map = &export_map;
+  SelectServer ss(options);
+
+  result->valid = false;
+  if (var && !export_map.GetBoolVar(var)->Get()) {
+    return;
+  }
+
+  UDPSocket sender;
+  if (!sender.Init()) {
+    return;
+  }
+
+  vector<UDPSocket*> sockets;
+  vector<IPV4SocketAddress> addresses;
+  for (unsigned int i = 0; i < FLAGS_sockets; i++) {
+    UDPSocket *socket = new UDPSocket();
+    IPV4SocketAddress address;
+    if (!socket->Init() ||
+        !socket->Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)) ||
+        !socket->GetSocketAddress(&address)) {
+      delete socket;
+      break;
+    }
+    socket->SetOnData(NewCallback(ReceivePacket, socket));
+    ss.AddReadDescriptor(socket);
+    sockets.push_back(socket);
+    addresses.push_back(address);
+  }
+
+  vector<uint8_t> packet(FLAGS_packet_size, 0x55);
+  Clock clock;
+  TimeStamp start, end;
+  packets_received = 0;
+  result->iterations = 0;
+  result->duration = TimeInterval();
+
+  for (unsigned int round = 0; round < FLAGS_rounds; round++) {
+    for (unsigned int i = 0; i < sockets.size(); i++) {
+      sender.SendTo(&packet[0], packet.size(), addresses[i]);
+    }
+
+    // Only the receive side is timed.
+    const unsigned int target = (round + 1) * sockets.size();
+    clock.CurrentTime(&start);
+    while (packets_received < target) {
+      ss.RunOnce(TimeInterval(1, 0));
+      result->iterations++;
+    }
+    clock.CurrentTime(&end);
+    result->duration += end - start;
+  }
+
+  result->valid = sockets.size() == FLAGS_sockets;
+  for (unsigned int i = 0; i < sockets.size(); i++) {
+    ss.RemoveReadDescriptor(sockets[i]);
+  }
+  ola::STLDeleteElements(&sockets);
+}
+
+void Report(const char *name, const Result &result) {
+  if (!result.valid) {
+    cout << std::setw(10) << std::left << name << " not available" << endl;
+    return;
+  }
+  double packets = static_cast<double>(FLAGS_sockets) * FLAGS_rounds;
+  double usec = static_cast<double>(result.duration.AsInt());
+  cout << std::setw(10) << std::left << name << " "
+       << std::setw(8) << std::right << std::fixed << std::setprecision(1)
+       << (usec * 1000.0 / packets) << " ns/packet, "
+       << std::setw(8) << std::setprecision(2)
+       << (static_cast<double>(result.iterations) / FLAGS_rounds)
+       << " loop iterations/round" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the SelectServer pollers with busy UDP sockets.");
+
+  if (FLAGS_sockets == 0 || FLAGS_rounds == 0) {
+    cout << "Need at least 1 socket and 1 round" << endl;
+    return 1;
+  }
+
+  cout << FLAGS_rounds << " rounds of one " << FLAGS_packet_size
+       << " byte packet to each of " << FLAGS_sockets << " sockets" << endl;
+
+  Result result;
+  SelectServer::Options options;
+
+  options.force_select = true;
+  RunLoad(options, NULL, &result);
+  Report("select", result);
+  options.force_select = false;
+
+#ifdef HAVE_EPOLL
+  RunLoad(options, "using-epoll", &result);
+  Report("epoll", result);
+#endif  // HAVE_EPOLL
+
+#ifdef HAVE_IO_URING
+  options.use_io_uring = true;
+  RunLoad(options, "using-io-uring", &result);
+  Report("io_uring", result);
+#endif  // HAVE_IO_URING
+  return 0;
+}
@@ -24,6 +24,9 @@
 #include <ola/Clock.h>
 #include <ola/io/Descriptor.h>
 
+#include <typeinfo>
+
+#include "common/io/LoopProfiler.h"
 #include "common/io/TimeoutManager.h"
 
 namespace ola {
@@ -69,6 +72,8 @@ namespace io {
  */
 class PollerInterface {
  public :
+  PollerInterface() : m_profiler(NULL) {}
+
   /**
    * @brief Destructor
    */
@@ -140,11 +145,62 @@ class PollerInterface {
   virtual bool Poll(TimeoutManager *timeout_manager,
                     const TimeInterval &poll_interval) = 0;
 
+  /**
+   * @brief Record the time taken by the descriptor callbacks.
+   * @param profiler the LoopProfiler to use, or NULL to stop profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
   static const char K_READ_DESCRIPTOR_VAR[];
   static const char K_WRITE_DESCRIPTOR_VAR[];
   static const char K_CONNECTED_DESCRIPTORS_VAR[];
 
  protected:
+  LoopProfiler *m_profiler;
+
+  /**
+   * @brief Call PerformRead() on a descriptor, timing it if profiling is
+   * enabled.
+   */
+  void HandleRead(ReadFileDescriptor *descriptor) {
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler, typeid(*descriptor),
+                                  LoopProfiler::READ_CALLBACK,
+                                  ToFD(descriptor->ReadDescriptor()));
+      descriptor->PerformRead();
+    } else {
+      descriptor->PerformRead();
+    }
+  }
+
+  /**
+   * @brief Call PerformWrite() on a descriptor, timing it if profiling is
+   * enabled.
+   */
+  void HandleWrite(WriteFileDescriptor *descriptor) {
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler, typeid(*descriptor),
+                                  LoopProfiler::WRITE_CALLBACK,
+                                  ToFD(descriptor->WriteDescriptor()));
+      descriptor->PerformWrite();
+    } else {
+      descriptor->PerformWrite();
+    }
+  }
+
+  /**
+   * @brief Run an on close handler, timing it if profiling is enabled.
+   */
+  void HandleClose(ConnectedDescriptor::OnCloseCallback *on_close) {
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler, typeid(*on_close),
+                                  LoopProfiler::CLOSE_CALLBACK);
+      on_close->Run();
+    } else {
+      on_close->Run();
+    }
+  }
+
   static const char K_LOOP_TIME[];
   static const char K_LOOP_COUNT[];
 };
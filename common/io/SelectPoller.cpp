@@ -369,7 +369,7 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
   ReadDescriptorMap::iterator iter = m_read_descriptors.begin();
   for (; iter != m_read_descriptors.end(); ++iter) {
     if (iter->second && FD_ISSET(iter->second->ReadDescriptor(), r_set)) {
-      iter->second->PerformRead();
+      HandleRead(iter->second);
     }
   }
 
@@ -390,7 +390,7 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
       if (descriptor->IsClosed()) {
         closed = true;
       } else {
-        descriptor->PerformRead();
+        HandleRead(descriptor);
       }
     }
 
@@ -406,7 +406,7 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
       }
 
       if (on_close)
-        on_close->Run();
+        HandleClose(on_close);
 
       if (delete_on_close)
         delete descriptor;
@@ -419,7 +419,7 @@ void SelectPoller::CheckDescriptors(fd_set *r_set, fd_set *w_set) {
   for (; write_iter != m_write_descriptors.end(); write_iter++) {
     if (write_iter->second &&
         FD_ISSET(write_iter->second->WriteDescriptor(), w_set)) {
-      write_iter->second->PerformWrite();
+      HandleWrite(write_iter->second);
     }
   }
 }
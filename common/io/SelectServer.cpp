@@ -36,22 +36,37 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #ifdef _WIN32
 #include "common/io/WindowsPoller.h"
 #else
-#include "ola/base/Flags.h"
-
-
 #include "common/io/SelectPoller.h"
 #endif  // _WIN32
 
+#include "common/io/LoopProfiler.h"
+#include "ola/base/Flags.h"
 #include "ola/io/Descriptor.h"
 #include "ola/Logging.h"
 #include "ola/network/Socket.h"
 #include "ola/stl/STLUtils.h"
 
+DEFINE_default_bool(use_timer_wheel, false,
+                    "Use a timing wheel rather than a priority queue for "
+                    "timeouts");
+DEFINE_default_bool(profile_loop, false,
+                    "Record the time taken by the SelectServer callbacks");
+DEFINE_uint32(loop_stall_budget, 5,
+              "When profiling, warn if the callbacks in one iteration of the "
+              "SelectServer take longer than this many ms. 0 disables.");
+
+#ifdef HAVE_IO_URING
+#include "common/io/IOUringPoller.h"
+DEFINE_default_bool(use_io_uring, false,
+                    "Use io_uring rather than epoll() or select()");
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_EPOLL
 #include "common/io/EPoller.h"
 DEFINE_default_bool(use_epoll, true,
@@ -291,14 +306,39 @@ void SelectServer::Init(const Options &options) {
     m_export_map->GetIntegerVar(PollerInterface::K_CONNECTED_DESCRIPTORS_VAR);
   }
 
-  m_timeout_manager.reset(new TimeoutManager(m_export_map, m_clock));
+  m_timeout_manager.reset(new TimeoutManager(
+      m_export_map, m_clock,
+      options.use_timer_wheel || FLAGS_use_timer_wheel));
+  if (options.profile_loop || FLAGS_profile_loop) {
+    m_profiler.reset(new LoopProfiler(
+        m_export_map, m_clock,
+        TimeInterval(static_cast<int64_t>(FLAGS_loop_stall_budget) * 1000)));
+    m_timeout_manager->SetProfiler(m_profiler.get());
+  }
 #ifdef _WIN32
   m_poller.reset(new WindowsPoller(m_export_map, m_clock));
   (void) options;
 #else
 
+#ifdef HAVE_IO_URING
+  bool using_io_uring = false;
+  if ((options.use_io_uring || FLAGS_use_io_uring) && !options.force_select) {
+    std::auto_ptr<IOUringPoller> poller(
+        new IOUringPoller(m_export_map, m_clock));
+    if (poller->IsValid()) {
+      m_poller.reset(poller.release());
+      using_io_uring = true;
+    } else {
+      OLA_WARN << "io_uring isn't available, falling back";
+    }
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-io-uring")->Set(using_io_uring);
+  }
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_EPOLL
-  if (FLAGS_use_epoll && !options.force_select) {
+  if (FLAGS_use_epoll && !m_poller.get() && !options.force_select) {
     m_poller.reset(new EPoller(m_export_map, m_clock));
   }
   if (m_export_map) {
@@ -322,6 +362,7 @@ void SelectServer::Init(const Options &options) {
     m_poller.reset(new SelectPoller(m_export_map, m_clock));
   }
 #endif  // _WIN32
+  m_poller->SetProfiler(m_profiler.get());
 
   // TODO(simon): this should really be in an Init() method that returns a
   // bool.
@@ -342,7 +383,13 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
   for (loop_iter = m_loop_callbacks.begin();
        loop_iter != m_loop_callbacks.end();
        ++loop_iter) {
-    (*loop_iter)->Run();
+    if (m_profiler.get()) {
+      LoopProfiler::Sample sample(m_profiler.get(), typeid(**loop_iter),
+                                  LoopProfiler::LOOP_CALLBACK);
+      (*loop_iter)->Run();
+    } else {
+      (*loop_iter)->Run();
+    }
   }
 
   TimeInterval default_poll_interval = poll_interval;
@@ -351,7 +398,11 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
     default_poll_interval = std::min(
         default_poll_interval, TimeInterval(0, 1000));
   }
-  return m_poller->Poll(m_timeout_manager.get(), default_poll_interval);
+  bool ok = m_poller->Poll(m_timeout_manager.get(), default_poll_interval);
+  if (m_profiler.get()) {
+    m_profiler->EndIteration();
+  }
+  return ok;
 }
 
 void SelectServer::DrainAndExecute() {
@@ -27,9 +27,14 @@
 #include <ola/win/CleanWinSock2.h>
 #endif  // _WIN32
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "common/io/PollerInterface.h"
 #include "ola/Callback.h"
@@ -55,6 +60,7 @@ using ola::io::WriteFileDescriptor;
 using ola::network::UDPSocket;
 using std::auto_ptr;
 using std::set;
+using std::vector;
 
 /*
  * For some of the tests we need precise control over the timing.
@@ -92,12 +98,15 @@ class SelectServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testReadWriteInteraction);
 #endif  // !_WIN32
   CPPUNIT_TEST(testShutdownWithActiveDescriptors);
+  CPPUNIT_TEST(testManyReadyDescriptors);
   CPPUNIT_TEST(testTimeout);
   CPPUNIT_TEST(testOffByOneTimeout);
   CPPUNIT_TEST(testLoopCallbacks);
   CPPUNIT_TEST_SUITE_END();
 
  public:
+  SelectServerTest() : m_use_io_uring(false) {}
+
   void setUp();
   void tearDown();
   void testAddInvalidDescriptor();
@@ -112,6 +121,7 @@ class SelectServerTest: public CppUnit::TestFixture {
   void testRemoveOthersWhenWriteable();
   void testReadWriteInteraction();
   void testShutdownWithActiveDescriptors();
+  void testManyReadyDescriptors();
   void testTimeout();
   void testOffByOneTimeout();
   void testLoopCallbacks();
@@ -187,9 +197,21 @@ class SelectServerTest: public CppUnit::TestFixture {
 
   void IncrementLoopCounter() { m_loop_counter++; }
 
+  void ReadAndCount(ConnectedDescriptor *descriptor) {
+    uint8_t data[10];
+    unsigned int size;
+    descriptor->Receive(data, arraysize(data), size);
+    m_read_counter++;
+  }
+
+ protected:
+  // Run the tests with the io_uring poller.
+  bool m_use_io_uring;
+
  private:
   unsigned int m_timeout_counter;
   unsigned int m_loop_counter;
+  unsigned int m_read_counter;
   ExportMap m_map;
   IntegerVariable *connected_read_descriptor_count;
   IntegerVariable *read_descriptor_count;
@@ -200,6 +222,37 @@ class SelectServerTest: public CppUnit::TestFixture {
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SelectServerTest);
 
+#ifdef HAVE_IO_URING
+/*
+ * Run the descriptor tests again with the io_uring poller.
+ */
+class IOUringSelectServerTest: public SelectServerTest {
+  CPPUNIT_TEST_SUITE(IOUringSelectServerTest);
+  CPPUNIT_TEST(testAddInvalidDescriptor);
+  CPPUNIT_TEST(testDoubleAddAndRemove);
+  CPPUNIT_TEST(testAddRemoveReadDescriptor);
+  CPPUNIT_TEST(testRemoteEndClose);
+  CPPUNIT_TEST(testRemoteEndCloseWithDelete);
+  CPPUNIT_TEST(testRemoteEndCloseWithRemoveAndDelete);
+  CPPUNIT_TEST(testRemoveWriteWhenOtherReadable);
+  CPPUNIT_TEST(testRemoveWriteWhenReadable);
+  CPPUNIT_TEST(testRemoveOthersWhenReadable);
+  CPPUNIT_TEST(testRemoveOthersWhenWriteable);
+  CPPUNIT_TEST(testReadWriteInteraction);
+  CPPUNIT_TEST(testShutdownWithActiveDescriptors);
+  CPPUNIT_TEST(testManyReadyDescriptors);
+  CPPUNIT_TEST(testLoopCallbacks);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  IOUringSelectServerTest() {
+    m_use_io_uring = true;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IOUringSelectServerTest);
+#endif  // HAVE_IO_URING
+
 void SelectServerTest::setUp() {
   connected_read_descriptor_count = m_map.GetIntegerVar(
       PollerInterface::K_CONNECTED_DESCRIPTORS_VAR);
@@ -208,9 +261,13 @@ void SelectServerTest::setUp() {
   write_descriptor_count = m_map.GetIntegerVar(
       PollerInterface::K_WRITE_DESCRIPTOR_VAR);
 
-  m_ss = new SelectServer(&m_map);
+  SelectServer::Options options;
+  options.export_map = &m_map;
+  options.use_io_uring = m_use_io_uring;
+  m_ss = new SelectServer(options);
   m_timeout_counter = 0;
   m_loop_counter = 0;
+  m_read_counter = 0;
 
 #if _WIN32
   WSADATA wsa_data;
@@ -566,6 +623,45 @@ void SelectServerTest::testShutdownWithActiveDescriptors() {
   OLA_ASSERT_TRUE(m_ss->AddWriteDescriptor(&loopback));
 }
 
+/*
+ * Check we handle more ready descriptors than the pollers fetch at once.
+ */
+void SelectServerTest::testManyReadyDescriptors() {
+  const unsigned int DESCRIPTOR_COUNT = 32;
+  vector<LoopbackDescriptor*> descriptors;
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    LoopbackDescriptor *descriptor = new LoopbackDescriptor();
+    OLA_ASSERT_TRUE(descriptor->Init());
+    descriptor->SetOnData(
+        NewCallback(this, &SelectServerTest::ReadAndCount,
+                    static_cast<ConnectedDescriptor*>(descriptor)));
+    OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(descriptor));
+    descriptors.push_back(descriptor);
+  }
+
+  const uint8_t data = 1;
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    descriptors[i]->Send(&data, sizeof(data));
+  }
+
+  unsigned int iterations = 0;
+  while (m_read_counter < DESCRIPTOR_COUNT && iterations < 10) {
+    m_ss->RunOnce(ola::TimeInterval(0, 100000));
+    iterations++;
+  }
+  OLA_ASSERT_EQ(DESCRIPTOR_COUNT, m_read_counter);
+
+  // io_uring doesn't limit the number of events per iteration.
+  if (m_use_io_uring && m_map.GetBoolVar("using-io-uring")->Get()) {
+    OLA_ASSERT_EQ(1u, iterations);
+  }
+
+  for (unsigned int i = 0; i < DESCRIPTOR_COUNT; i++) {
+    m_ss->RemoveReadDescriptor(descriptors[i]);
+    delete descriptors[i];
+  }
+}
+
 /*
  * Timeout tests
  */
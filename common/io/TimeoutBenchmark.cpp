@@ -0,0 +1,210 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimeoutBenchmark.cpp
+ * Compare the priority queue and timing wheel TimeoutManagers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::ExportMap;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimeoutManager;
+using ola::thread::timeout_id;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint32(timeouts, t, 100000, "The number of active timeouts");
+DEFINE_s_uint32(ticks, i, 10000, "The number of 1ms steps to run");
+DEFINE_uint32(churn, 100, "The timeouts cancelled and replaced each step");
+DEFINE_uint32(max_timeout, 60000, "The longest timeout, in ms");
+
+/**
+ * A clock that only moves when we tell it to, so both managers see the same
+ * sequence of events.
+ */
+class SimulatedClock: public Clock {
+ public:
+  SimulatedClock() {
+    Clock clock;
+    clock.CurrentTime(&m_now);
+  }
+
+  void CurrentTime(TimeStamp *timestamp) const { *timestamp = m_now; }
+  void Advance(const TimeInterval &interval) { m_now += interval; }
+
+ private:
+  TimeStamp m_now;
+};
+
+struct Load {
+  TimeoutManager *manager;
+  vector<timeout_id> ids;
+  uint32_t seed;
+  unsigned int fired;
+};
+
+struct Result {
+  TimeInterval registration;
+  TimeInterval cancel;
+  TimeInterval execute;
+  unsigned int registrations;
+  unsigned int cancels;
+  unsigned int fired;
+};
+
+uint32_t Random(Load *load) {
+  load->seed = load->seed * 1103515245 + 12345;
+  return load->seed >> 8;
+}
+
+void Fired(Load *load, unsigned int slot);
+
+/*
+ * Register a new timeout for a slot.
+ */
+void Add(Load *load, unsigned int slot) {
+  TimeInterval interval(1000 * (1 + Random(load) % FLAGS_max_timeout));
+  load->ids[slot] = load->manager->RegisterSingleTimeout(
+      interval, NewSingleCallback(Fired, load, slot));
+}
+
+/*
+ * Replace timeouts as they fire, so the number active stays the same.
+ */
+void Fired(Load *load, unsigned int slot) {
+  load->fired++;
+  Add(load, slot);
+}
+
+/*
+ * Run the load against one TimeoutManager.
+ */
+void RunLoad(bool use_timer_wheel, Result *result) {
+  ExportMap export_map;
+  SimulatedClock clock;
+  Clock real_clock;
+  TimeoutManager manager(&export_map, &clock, use_timer_wheel);
+
+  Load load;
+  load.manager = &manager;
+  load.ids.resize(FLAGS_timeouts);
+  load.seed = 1;
+  load.fired = 0;
+
+  TimeStamp start, end;
+  real_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < load.ids.size(); i++) {
+    Add(&load, i);
+  }
+  real_clock.CurrentTime(&end);
+  result->registration = end - start;
+  result->registrations = load.ids.size();
+  result->cancel = TimeInterval();
+  result->cancels = 0;
+  result->execute = TimeInterval();
+
+  const TimeInterval tick(0, 1000);
+  vector<unsigned int> slots(FLAGS_churn);
+  for (unsigned int i = 0; i < FLAGS_ticks; i++) {
+    clock.Advance(tick);
+    for (unsigned int j = 0; j < slots.size(); j++) {
+      slots[j] = Random(&load) % load.ids.size();
+    }
+
+    real_clock.CurrentTime(&start);
+    for (unsigned int j = 0; j < slots.size(); j++) {
+      manager.CancelTimeout(load.ids[slots[j]]);
+      load.ids[slots[j]] = ola::thread::INVALID_TIMEOUT;
+    }
+    real_clock.CurrentTime(&end);
+    result->cancel += end - start;
+    result->cancels += FLAGS_churn;
+
+    real_clock.CurrentTime(&start);
+    for (unsigned int j = 0; j < slots.size(); j++) {
+      if (load.ids[slots[j]] == ola::thread::INVALID_TIMEOUT) {
+        Add(&load, slots[j]);
+        result->registrations++;
+      }
+    }
+    real_clock.CurrentTime(&end);
+    result->registration += end - start;
+
+    TimeStamp now;
+    clock.CurrentTime(&now);
+    real_clock.CurrentTime(&start);
+    manager.ExecuteTimeouts(&now);
+    real_clock.CurrentTime(&end);
+    result->execute += end - start;
+  }
+  result->fired = load.fired;
+}
+
+/*
+ * Print the cost per operation.
+ */
+void Report(const char *name, const TimeInterval &duration,
+            unsigned int operations) {
+  double usec = static_cast<double>(duration.AsInt());
+  cout << "  " << std::setw(16) << std::left << name << " "
+       << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+       << (operations ? usec * 1000.0 / operations : 0.0) << " ns/op"
+       << endl;
+}
+
+void PrintResult(const char *name, const Result &result) {
+  cout << name << ", " << result.fired << " timeouts ran" << endl;
+  Report("Register", result.registration, result.registrations);
+  Report("Cancel", result.cancel, result.cancels);
+  Report("Execute (fired)", result.execute, result.fired);
+  Report("Execute (tick)", result.execute, FLAGS_ticks);
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the SelectServer timeout implementations.");
+
+  if (FLAGS_timeouts == 0 || FLAGS_max_timeout == 0) {
+    cout << "Need at least 1 timeout" << endl;
+    return 1;
+  }
+
+  cout << FLAGS_timeouts << " active timeouts of up to " << FLAGS_max_timeout
+       << "ms, " << FLAGS_churn << " replaced every 1ms for "
+       << FLAGS_ticks << " ticks" << endl;
+
+  Result result;
+  RunLoad(false, &result);
+  PrintResult("Priority queue", result);
+  RunLoad(true, &result);
+  PrintResult("Timing wheel", result);
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "ola/Logging.h"
+#include "common/io/LoopProfiler.h"
 #include "common/io/TimeoutManager.h"
 
 namespace ola {
@@ -37,9 +38,14 @@ using ola::thread::INVALID_TIMEOUT;
 using ola::thread::timeout_id;
 
 TimeoutManager::TimeoutManager(ExportMap *export_map,
-                               Clock *clock)
+                               Clock *clock,
+                               bool use_timer_wheel)
     : m_export_map(export_map),
-      m_clock(clock) {
+      m_clock(clock),
+      m_profiler(NULL) {
+  if (use_timer_wheel) {
+    m_timer_wheel.reset(new TimerWheel(export_map, clock));
+  }
   if (m_export_map) {
     m_export_map->GetIntegerVar(K_TIMER_VAR);
   }
@@ -57,6 +63,8 @@ TimeoutManager::~TimeoutManager() {
 timeout_id TimeoutManager::RegisterRepeatingTimeout(
     const TimeInterval &interval,
     ola::Callback0<bool> *closure) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->RegisterRepeatingTimeout(interval, closure);
   if (!closure)
     return INVALID_TIMEOUT;
 
@@ -71,6 +79,8 @@ timeout_id TimeoutManager::RegisterRepeatingTimeout(
 timeout_id TimeoutManager::RegisterSingleTimeout(
     const TimeInterval &interval,
     ola::SingleUseCallback0<void> *closure) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->RegisterSingleTimeout(interval, closure);
   if (!closure)
     return INVALID_TIMEOUT;
 
@@ -83,6 +93,11 @@ timeout_id TimeoutManager::RegisterSingleTimeout(
 }
 
 void TimeoutManager::CancelTimeout(timeout_id id) {
+  if (m_timer_wheel.get()) {
+    m_timer_wheel->CancelTimeout(id);
+    return;
+  }
+
   // TODO(simon): just mark the timeouts as cancelled rather than using a
   // remove set.
   if (id == INVALID_TIMEOUT)
@@ -92,7 +107,17 @@ void TimeoutManager::CancelTimeout(timeout_id id) {
     OLA_WARN << "timeout " << id << " already in remove set";
 }
 
+void TimeoutManager::SetProfiler(LoopProfiler *profiler) {
+  m_profiler = profiler;
+  if (m_timer_wheel.get()) {
+    m_timer_wheel->SetProfiler(profiler);
+  }
+}
+
 TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->ExecuteTimeouts(now);
+
   Event *e;
   if (m_events.empty())
     return TimeInterval();
@@ -109,7 +134,16 @@ TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
       continue;
     }
 
-    if (e->Trigger()) {
+    bool again;
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler, e->ClosureType(),
+                                  LoopProfiler::TIMEOUT_CALLBACK);
+      again = e->Trigger();
+    } else {
+      again = e->Trigger();
+    }
+
+    if (again) {
       // true implies we need to run this again
       e->UpdateTime(*now);
       m_events.push(e);
@@ -21,10 +21,13 @@
 #ifndef COMMON_IO_TIMEOUTMANAGER_H_
 #define COMMON_IO_TIMEOUTMANAGER_H_
 
+#include <memory>
 #include <queue>
 #include <set>
+#include <typeinfo>
 #include <vector>
 
+#include "common/io/TimerWheel.h"
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/ExportMap.h"
@@ -34,6 +37,7 @@
 namespace ola {
 namespace io {
 
+class LoopProfiler;
 
 /**
  * @class TimeoutManager
@@ -41,6 +45,10 @@ namespace io {
  *
  * The TimeoutManager allows Callbacks to trigger at some point in the future.
  * Callbacks can be invoked once, or periodically.
+ *
+ * By default the timeouts are kept in a priority queue. If use_timer_wheel is
+ * set, they're kept in a TimerWheel instead, which makes registering and
+ * cancelling timeouts cheaper when there are many of them.
  */
 class TimeoutManager {
  public :
@@ -48,8 +56,10 @@ class TimeoutManager {
    * @brief Create a new TimeoutManager.
    * @param export_map an ExportMap to update
    * @param clock the Clock to use.
+   * @param use_timer_wheel use a TimerWheel rather than a priority queue.
    */
-  TimeoutManager(ola::ExportMap *export_map, Clock *clock);
+  TimeoutManager(ola::ExportMap *export_map, Clock *clock,
+                 bool use_timer_wheel = false);
 
   ~TimeoutManager();
 
@@ -89,6 +99,9 @@ class TimeoutManager {
    * @returns true if there are events pending, false otherwise.
    */
   bool EventsPending() const {
+    if (m_timer_wheel.get()) {
+      return m_timer_wheel->EventsPending();
+    }
     return !m_events.empty();
   }
 
@@ -100,6 +113,12 @@ class TimeoutManager {
    */
   TimeInterval ExecuteTimeouts(TimeStamp *now);
 
+  /**
+   * @brief Record the time taken by the timeouts.
+   * @param profiler the LoopProfiler to use, or NULL to stop profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler);
+
   static const char K_TIMER_VAR[];
 
  private :
@@ -113,6 +132,8 @@ class TimeoutManager {
     }
     virtual ~Event() {}
     virtual bool Trigger() = 0;
+    // The type of the closure, used when profiling.
+    virtual const std::type_info &ClosureType() const = 0;
 
     void UpdateTime(const TimeStamp &now) {
       m_next = now + m_interval;
@@ -149,6 +170,13 @@ class TimeoutManager {
       return false;
     }
 
+    const std::type_info &ClosureType() const {
+      if (m_closure) {
+        return typeid(*m_closure);
+      }
+      return typeid(*this);
+    }
+
    private:
      ola::BaseCallback0<void> *m_closure;
   };
@@ -174,6 +202,13 @@ class TimeoutManager {
       return m_closure->Run();
     }
 
+    const std::type_info &ClosureType() const {
+      if (m_closure) {
+        return typeid(*m_closure);
+      }
+      return typeid(*this);
+    }
+
    private:
     ola::BaseCallback0<bool> *m_closure;
   };
@@ -189,9 +224,11 @@ class TimeoutManager {
 
   ola::ExportMap *m_export_map;
   Clock *m_clock;
+  LoopProfiler *m_profiler;
 
   event_queue_t m_events;
   std::set<ola::thread::timeout_id> m_removed_timeouts;
+  std::auto_ptr<TimerWheel> m_timer_wheel;
 
   DISALLOW_COPY_AND_ASSIGN(TimeoutManager);
 };
@@ -0,0 +1,503 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheel.cpp
+ * A hierarchical timing wheel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <typeinfo>
+#include <vector>
+
+#include "common/io/LoopProfiler.h"
+#include "common/io/TimeoutManager.h"
+#include "common/io/TimerWheel.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace io {
+
+using ola::thread::INVALID_TIMEOUT;
+using ola::thread::timeout_id;
+using std::vector;
+
+namespace {
+
+// A timeout_id is the index of the timer plus one, with the timer's
+// generation in the upper bits.
+const unsigned int ID_INDEX_BITS = sizeof(uintptr_t) > 4 ? 32 : 20;
+const uintptr_t ID_INDEX_MASK =
+    (static_cast<uintptr_t>(1) << ID_INDEX_BITS) - 1;
+const uintptr_t ID_GENERATION_MASK =
+    ~static_cast<uintptr_t>(0) >> ID_INDEX_BITS;
+const uint16_t NO_SLOT = 0xffff;
+
+inline unsigned int FirstBit(uint64_t bits) {
+  return __builtin_ctzll(bits);
+}
+}  // namespace
+
+const unsigned int TimerWheel::TICK_USEC;
+const uint64_t TimerWheel::MAX_TICKS;
+
+TimerWheel::TimerWheel(ExportMap *export_map, Clock *clock)
+    : m_export_map(export_map),
+      m_clock(clock),
+      m_profiler(NULL),
+      m_current_tick(0),
+      m_active_count(0),
+      m_free_list(NULL) {
+  m_clock->CurrentTime(&m_origin);
+  memset(m_occupied, 0, sizeof(m_occupied));
+  if (m_export_map) {
+    m_export_map->GetIntegerVar(TimeoutManager::K_TIMER_VAR);
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  vector<Timer*>::iterator iter = m_chunks.begin();
+  for (; iter != m_chunks.end(); ++iter) {
+    for (unsigned int i = 0; i < POOL_CHUNK_SIZE; i++) {
+      Timer *timer = &(*iter)[i];
+      if (timer->state != TIMER_FREE) {
+        delete timer->single_closure;
+        delete timer->repeating_closure;
+      }
+    }
+    delete[] *iter;
+  }
+}
+
+timeout_id TimerWheel::RegisterRepeatingTimeout(const TimeInterval &interval,
+                                                Callback0<bool> *closure) {
+  if (!closure) {
+    return INVALID_TIMEOUT;
+  }
+  return Add(interval, NULL, closure);
+}
+
+timeout_id TimerWheel::RegisterSingleTimeout(
+    const TimeInterval &interval,
+    SingleUseCallback0<void> *closure) {
+  if (!closure) {
+    return INVALID_TIMEOUT;
+  }
+  return Add(interval, closure, NULL);
+}
+
+void TimerWheel::CancelTimeout(timeout_id id) {
+  Timer *timer = Lookup(id);
+  if (!timer) {
+    return;
+  }
+
+  switch (timer->state) {
+    case TIMER_PENDING:
+      Unlink(timer);
+      delete timer->single_closure;
+      delete timer->repeating_closure;
+      Free(timer);
+      break;
+    case TIMER_RUNNING:
+      // The timer is freed once the closure returns.
+      timer->state = TIMER_CANCELLED;
+      break;
+    default:
+      break;
+  }
+}
+
+TimeInterval TimerWheel::ExecuteTimeouts(TimeStamp *now) {
+  if (!m_active_count) {
+    return TimeInterval();
+  }
+
+  TimerList expired;
+  Advance(*now, &expired);
+
+  // Closures may register or cancel timeouts, including those in the expired
+  // list.
+  while (!expired.Empty()) {
+    Timer *timer = expired.head.next;
+    Unlink(timer);
+    Run(timer, now);
+  }
+  return NextTimeout(*now);
+}
+
+timeout_id TimerWheel::Add(const TimeInterval &interval,
+                           BaseCallback0<void> *single_closure,
+                           BaseCallback0<bool> *repeating_closure) {
+  Timer *timer = Allocate();
+  if (!timer) {
+    OLA_WARN << "Too many timeouts registered";
+    delete single_closure;
+    delete repeating_closure;
+    return INVALID_TIMEOUT;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (!m_active_count) {
+    // Nothing to move down, so jump straight to the current time.
+    uint64_t tick = TickOf(now);
+    if (tick > m_current_tick) {
+      m_current_tick = tick;
+    }
+  }
+
+  timer->expiry = now + interval;
+  timer->interval = interval;
+  timer->single_closure = single_closure;
+  timer->repeating_closure = repeating_closure;
+  timer->state = TIMER_PENDING;
+  m_active_count++;
+  UpdateTimerVar(1);
+  Insert(timer);
+
+  uintptr_t id = (
+      (static_cast<uintptr_t>(timer->generation) & ID_GENERATION_MASK) <<
+      ID_INDEX_BITS) | (timer->index + 1);
+  return reinterpret_cast<timeout_id>(id);
+}
+
+TimerWheel::Timer *TimerWheel::Allocate() {
+  if (!m_free_list) {
+    uintptr_t first_index = m_chunks.size() * POOL_CHUNK_SIZE;
+    if (first_index + POOL_CHUNK_SIZE >= ID_INDEX_MASK) {
+      return NULL;
+    }
+
+    Timer *chunk = new Timer[POOL_CHUNK_SIZE];
+    m_chunks.push_back(chunk);
+    for (unsigned int i = POOL_CHUNK_SIZE; i-- > 0;) {
+      Timer *timer = &chunk[i];
+      timer->prev = NULL;
+      timer->single_closure = NULL;
+      timer->repeating_closure = NULL;
+      timer->index = static_cast<uint32_t>(first_index + i);
+      timer->generation = 0;
+      timer->slot = NO_SLOT;
+      timer->state = TIMER_FREE;
+      timer->next = m_free_list;
+      m_free_list = timer;
+    }
+  }
+
+  Timer *timer = m_free_list;
+  m_free_list = timer->next;
+  return timer;
+}
+
+void TimerWheel::Free(Timer *timer) {
+  timer->single_closure = NULL;
+  timer->repeating_closure = NULL;
+  timer->state = TIMER_FREE;
+  timer->generation++;
+  timer->prev = NULL;
+  timer->next = m_free_list;
+  m_free_list = timer;
+  m_active_count--;
+  UpdateTimerVar(-1);
+}
+
+TimerWheel::Timer *TimerWheel::Lookup(timeout_id id) const {
+  uintptr_t value = reinterpret_cast<uintptr_t>(id);
+  uintptr_t index = value & ID_INDEX_MASK;
+  if (!index) {
+    return NULL;
+  }
+  index--;
+
+  if (index / POOL_CHUNK_SIZE >= m_chunks.size()) {
+    return NULL;
+  }
+  Timer *timer = &m_chunks[index / POOL_CHUNK_SIZE][index % POOL_CHUNK_SIZE];
+  if (timer->state == TIMER_FREE ||
+      (timer->generation & ID_GENERATION_MASK) != value >> ID_INDEX_BITS) {
+    return NULL;
+  }
+  return timer;
+}
+
+/*
+ * Add a timer to the slot for its expiry time.
+ */
+void TimerWheel::Insert(Timer *timer) {
+  uint64_t tick = TickOf(timer->expiry);
+  if (tick < m_current_tick) {
+    tick = m_current_tick;
+  }
+  uint64_t delta = tick - m_current_tick;
+
+  unsigned int slot;
+  if (delta < LEVEL0_SIZE) {
+    slot = static_cast<unsigned int>(tick & (LEVEL0_SIZE - 1));
+    if (m_slots[slot].Empty() || timer->expiry < m_slot_expiry[slot]) {
+      m_slot_expiry[slot] = timer->expiry;
+    }
+  } else {
+    if (delta >= MAX_TICKS) {
+      tick = m_current_tick + MAX_TICKS - 1;
+      delta = MAX_TICKS - 1;
+    }
+    unsigned int level = 1;
+    while (delta >=
+           static_cast<uint64_t>(LEVEL0_SIZE) << (level * LEVEL_BITS)) {
+      level++;
+    }
+    unsigned int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    slot = LEVEL0_SIZE + (level - 1) * LEVEL_SIZE +
+           static_cast<unsigned int>((tick >> shift) & (LEVEL_SIZE - 1));
+  }
+
+  Append(&m_slots[slot], timer);
+  timer->slot = static_cast<uint16_t>(slot);
+  m_occupied[slot / 64] |= static_cast<uint64_t>(1) << (slot % 64);
+}
+
+void TimerWheel::Unlink(Timer *timer) {
+  timer->prev->next = timer->next;
+  timer->next->prev = timer->prev;
+  timer->prev = NULL;
+  timer->next = NULL;
+  if (timer->slot != NO_SLOT && m_slots[timer->slot].Empty()) {
+    m_occupied[timer->slot / 64] &= ~(static_cast<uint64_t>(1) <<
+                                      (timer->slot % 64));
+  }
+  timer->slot = NO_SLOT;
+}
+
+/*
+ * Move all the timers in a slot to the end of a list.
+ */
+void TimerWheel::MoveSlot(unsigned int slot, TimerList *list) {
+  TimerList *source = &m_slots[slot];
+  while (!source->Empty()) {
+    Timer *timer = source->head.next;
+    Unlink(timer);
+    Append(list, timer);
+  }
+}
+
+/*
+ * Move the timers in the current slot of a higher level down.
+ */
+void TimerWheel::Cascade(unsigned int level) {
+  unsigned int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+  unsigned int slot = LEVEL0_SIZE + (level - 1) * LEVEL_SIZE +
+      static_cast<unsigned int>((m_current_tick >> shift) & (LEVEL_SIZE - 1));
+  TimerList timers;
+  MoveSlot(slot, &timers);
+  while (!timers.Empty()) {
+    Timer *timer = timers.head.next;
+    Unlink(timer);
+    Insert(timer);
+  }
+}
+
+/*
+ * Move the wheel forward to now, and collect the timers that have expired.
+ */
+void TimerWheel::Advance(const TimeStamp &now, TimerList *expired) {
+  const uint64_t target = TickOf(now);
+  while (m_current_tick < target) {
+    // Everything in this slot expires before the target tick.
+    unsigned int index = static_cast<unsigned int>(
+        m_current_tick & (LEVEL0_SIZE - 1));
+    MoveSlot(index, expired);
+
+    // Skip the empty slots, but stop at the end of the first level so the
+    // higher levels can be moved down.
+    uint64_t next = m_current_tick - index +
+                    NextOccupied(index + 1, LEVEL0_SIZE);
+    if (next > target) {
+      m_current_tick = target;
+      break;
+    }
+    m_current_tick = next;
+
+    if ((m_current_tick & (LEVEL0_SIZE - 1)) == 0) {
+      for (unsigned int level = 1; level < LEVEL_COUNT; level++) {
+        Cascade(level);
+        unsigned int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+        if ((m_current_tick >> shift) & (LEVEL_SIZE - 1)) {
+          break;
+        }
+      }
+    }
+  }
+
+  // The current slot may have timers that expire later in this tick.
+  unsigned int index = static_cast<unsigned int>(
+      m_current_tick & (LEVEL0_SIZE - 1));
+  TimerList *slot = &m_slots[index];
+  Timer *timer = slot->head.next;
+  bool have_expiry = false;
+  while (timer != &slot->head) {
+    Timer *next = timer->next;
+    if (timer->expiry <= now) {
+      Unlink(timer);
+      Append(expired, timer);
+    } else if (!have_expiry || timer->expiry < m_slot_expiry[index]) {
+      m_slot_expiry[index] = timer->expiry;
+      have_expiry = true;
+    }
+    timer = next;
+  }
+}
+
+void TimerWheel::Run(Timer *timer, TimeStamp *now) {
+  timer->state = TIMER_RUNNING;
+  if (timer->single_closure) {
+    BaseCallback0<void> *closure = timer->single_closure;
+    // The closure deletes itself.
+    timer->single_closure = NULL;
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler, typeid(*closure),
+                                  LoopProfiler::TIMEOUT_CALLBACK);
+      closure->Run();
+    } else {
+      closure->Run();
+    }
+    Free(timer);
+  } else {
+    bool again;
+    if (m_profiler) {
+      LoopProfiler::Sample sample(m_profiler,
+                                  typeid(*timer->repeating_closure),
+                                  LoopProfiler::TIMEOUT_CALLBACK);
+      again = timer->repeating_closure->Run();
+    } else {
+      again = timer->repeating_closure->Run();
+    }
+    if (again && timer->state == TIMER_RUNNING) {
+      timer->expiry = *now + timer->interval;
+      timer->state = TIMER_PENDING;
+      Insert(timer);
+    } else {
+      delete timer->repeating_closure;
+      Free(timer);
+    }
+  }
+  m_clock->CurrentTime(now);
+}
+
+/*
+ * Return the time until the next timer expires. This may be early if the next
+ * timer is in one of the higher levels, since those are only sorted to the
+ * start of their slot.
+ */
+TimeInterval TimerWheel::NextTimeout(const TimeStamp &now) {
+  if (!m_active_count) {
+    return TimeInterval();
+  }
+
+  // The first level holds the next LEVEL0_SIZE ticks, starting at the
+  // current one.
+  unsigned int current = static_cast<unsigned int>(
+      m_current_tick & (LEVEL0_SIZE - 1));
+  unsigned int slot = NextOccupied(current, LEVEL0_SIZE);
+  if (slot == LEVEL0_SIZE) {
+    slot = NextOccupied(0, current);
+    if (slot == current) {
+      slot = LEVEL0_SIZE;
+    }
+  }
+
+  bool have_next = slot < LEVEL0_SIZE;
+  TimeStamp next;
+  if (have_next) {
+    next = m_slot_expiry[slot];
+  }
+
+  // A timer in a higher level can be due before the first level timers, so
+  // also check when the next occupied slot on each level is moved down.
+  for (unsigned int level = 1; level < LEVEL_COUNT; level++) {
+    unsigned int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    unsigned int first = LEVEL0_SIZE + (level - 1) * LEVEL_SIZE;
+    unsigned int index = static_cast<unsigned int>(
+        (m_current_tick >> shift) & (LEVEL_SIZE - 1));
+    // Check the slots after the current one, wrapping around to it.
+    for (unsigned int distance = 1; distance <= LEVEL_SIZE; distance++) {
+      unsigned int i = first + ((index + distance) & (LEVEL_SIZE - 1));
+      if (m_occupied[i / 64] & (static_cast<uint64_t>(1) << (i % 64))) {
+        uint64_t tick = ((m_current_tick >> shift) + distance) << shift;
+        TimeStamp cascade = TimeOfTick(tick);
+        if (!have_next || cascade < next) {
+          next = cascade;
+          have_next = true;
+        }
+        break;
+      }
+    }
+  }
+
+  TimeInterval interval = next - now;
+  if (interval <= TimeInterval()) {
+    // Don't return zero, that means there aren't any timeouts.
+    return TimeInterval(0, 1);
+  }
+  return interval;
+}
+
+uint64_t TimerWheel::TickOf(const TimeStamp &time) const {
+  int64_t offset = (time - m_origin).AsInt();
+  return offset < 0 ? 0 : static_cast<uint64_t>(offset) / TICK_USEC;
+}
+
+TimeStamp TimerWheel::TimeOfTick(uint64_t tick) const {
+  return m_origin + TimeInterval(static_cast<int64_t>(tick * TICK_USEC));
+}
+
+/*
+ * Return the first occupied slot in [first, end), or end if there isn't one.
+ */
+unsigned int TimerWheel::NextOccupied(unsigned int first,
+                                      unsigned int end) const {
+  unsigned int i = first;
+  while (i < end) {
+    uint64_t bits = m_occupied[i / 64] >> (i % 64);
+    if (bits) {
+      unsigned int found = i + FirstBit(bits);
+      return found < end ? found : end;
+    }
+    i = (i / 64 + 1) * 64;
+  }
+  return end;
+}
+
+void TimerWheel::UpdateTimerVar(int delta) {
+  if (!m_export_map) {
+    return;
+  }
+  IntegerVariable *var = m_export_map->GetIntegerVar(
+      TimeoutManager::K_TIMER_VAR);
+  if (delta > 0) {
+    (*var)++;
+  } else {
+    (*var)--;
+  }
+}
+
+void TimerWheel::Append(TimerList *list, Timer *timer) {
+  timer->prev = list->head.prev;
+  timer->next = &list->head;
+  list->head.prev->next = timer;
+  list->head.prev = timer;
+}
+}  // namespace io
+}  // namespace ola
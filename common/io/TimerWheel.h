@@ -0,0 +1,200 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheel.h
+ * A hierarchical timing wheel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_TIMERWHEEL_H_
+#define COMMON_IO_TIMERWHEEL_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace io {
+
+class LoopProfiler;
+
+/**
+ * @brief A hierarchical timing wheel.
+ *
+ * This provides the same operations as the TimeoutManager, but registering
+ * and cancelling a timeout are O(1) and don't allocate. Timeouts are stored
+ * in a pool that grows as needed and is only freed when the wheel is
+ * deleted.
+ *
+ * The first level has a slot for each tick, the higher levels each cover
+ * 64 slots of the level below. As time advances, the timeouts in the higher
+ * levels are moved down, until they reach the first level. The wheel keeps
+ * the exact expiry time of each timeout, so timeouts run at the same time
+ * they would with the TimeoutManager. The tick only sets how finely the
+ * timeouts are sorted.
+ *
+ * Timeout ids contain a generation count, so cancelling a timeout that has
+ * already run is safe.
+ */
+class TimerWheel {
+ public:
+  /**
+   * @brief Create a new TimerWheel.
+   * @param export_map an ExportMap to update, may be NULL.
+   * @param clock the Clock to use.
+   */
+  TimerWheel(ola::ExportMap *export_map, Clock *clock);
+  ~TimerWheel();
+
+  /**
+   * @brief Register a repeating timeout.
+   * @see TimeoutManager::RegisterRepeatingTimeout.
+   */
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      const ola::TimeInterval &interval,
+      ola::Callback0<bool> *closure);
+
+  /**
+   * @brief Register a single use timeout.
+   * @see TimeoutManager::RegisterSingleTimeout.
+   */
+  ola::thread::timeout_id RegisterSingleTimeout(
+      const ola::TimeInterval &interval,
+      ola::SingleUseCallback0<void> *closure);
+
+  /**
+   * @brief Cancel a timeout.
+   * @param id the id of the timeout. Ids of timeouts that have already run
+   *   are ignored.
+   */
+  void CancelTimeout(ola::thread::timeout_id id);
+
+  /**
+   * @brief Check if there are any timeouts registered.
+   */
+  bool EventsPending() const { return m_active_count > 0; }
+
+  /**
+   * @brief Execute any expired timeouts.
+   * @see TimeoutManager::ExecuteTimeouts.
+   */
+  TimeInterval ExecuteTimeouts(TimeStamp *now);
+
+  /**
+   * @brief Record the time taken by the timeouts.
+   * @param profiler the LoopProfiler to use, or NULL to stop profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
+  /**
+   * @brief The resolution of the first level, in microseconds.
+   */
+  static const unsigned int TICK_USEC = 1000;
+
+ private:
+  enum TimerState {
+    TIMER_FREE,
+    TIMER_PENDING,
+    TIMER_RUNNING,
+    TIMER_CANCELLED,
+  };
+
+  struct Timer {
+    Timer *prev;
+    Timer *next;
+    TimeStamp expiry;
+    TimeInterval interval;
+    ola::BaseCallback0<void> *single_closure;
+    ola::BaseCallback0<bool> *repeating_closure;
+    uint32_t index;
+    uint32_t generation;
+    uint16_t slot;
+    uint8_t state;
+  };
+
+  // A circular, doubly linked list of timers, with a sentinel.
+  struct TimerList {
+    Timer head;
+
+    TimerList() {
+      head.prev = &head;
+      head.next = &head;
+    }
+
+    bool Empty() const { return head.next == &head; }
+  };
+
+  enum {
+    LEVEL0_BITS = 8,
+    LEVEL_BITS = 6,
+    LEVEL0_SIZE = 1 << LEVEL0_BITS,
+    LEVEL_SIZE = 1 << LEVEL_BITS,
+    LEVEL_COUNT = 4,
+    SLOT_COUNT = LEVEL0_SIZE + (LEVEL_COUNT - 1) * LEVEL_SIZE,
+    POOL_CHUNK_SIZE = 1024,
+  };
+
+  // The number of ticks the wheel covers, timeouts further out than this are
+  // placed in the last slot and re-sorted when they reach the first level.
+  static const uint64_t MAX_TICKS = static_cast<uint64_t>(LEVEL0_SIZE)
+      << ((LEVEL_COUNT - 1) * LEVEL_BITS);
+
+  ola::ExportMap *m_export_map;
+  Clock *m_clock;
+  LoopProfiler *m_profiler;
+  TimeStamp m_origin;
+  uint64_t m_current_tick;
+  unsigned int m_active_count;
+
+  // Slots 0 - 255 are the first level, each higher level has 64 slots.
+  TimerList m_slots[SLOT_COUNT];
+  // One bit per slot, set if the slot has timers.
+  uint64_t m_occupied[SLOT_COUNT / 64];
+  // A lower bound on the expiry of the timers in each first level slot.
+  TimeStamp m_slot_expiry[LEVEL0_SIZE];
+
+  std::vector<Timer*> m_chunks;
+  Timer *m_free_list;
+
+  ola::thread::timeout_id Add(const TimeInterval &interval,
+                              ola::BaseCallback0<void> *single_closure,
+                              ola::BaseCallback0<bool> *repeating_closure);
+  Timer *Allocate();
+  void Free(Timer *timer);
+  Timer *Lookup(ola::thread::timeout_id id) const;
+  void Insert(Timer *timer);
+  void Unlink(Timer *timer);
+  void MoveSlot(unsigned int slot, TimerList *list);
+  void Cascade(unsigned int level);
+  void Advance(const TimeStamp &now, TimerList *expired);
+  void Run(Timer *timer, TimeStamp *now);
+  TimeInterval NextTimeout(const TimeStamp &now);
+  uint64_t TickOf(const TimeStamp &time) const;
+  TimeStamp TimeOfTick(uint64_t tick) const;
+  unsigned int NextOccupied(unsigned int first, unsigned int end) const;
+  void UpdateTimerVar(int delta);
+
+  static void Append(TimerList *list, Timer *timer);
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_TIMERWHEEL_H_
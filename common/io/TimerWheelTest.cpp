@@ -0,0 +1,383 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheelTest.cpp
+ * Test fixture for the TimerWheel class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "common/io/TimeoutManager.h"
+#include "common/io/TimerWheel.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::ExportMap;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimeoutManager;
+using ola::io::TimerWheel;
+using ola::thread::timeout_id;
+using std::vector;
+
+class TimerWheelTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TimerWheelTest);
+  CPPUNIT_TEST(testSingleTimeouts);
+  CPPUNIT_TEST(testRepeatingTimeouts);
+  CPPUNIT_TEST(testCancelFromCallback);
+  CPPUNIT_TEST(testStaleIds);
+  CPPUNIT_TEST(testLongTimeouts);
+  CPPUNIT_TEST(testMixedLevels);
+  CPPUNIT_TEST(testRandomTimeouts);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+
+  void testSingleTimeouts();
+  void testRepeatingTimeouts();
+  void testCancelFromCallback();
+  void testStaleIds();
+  void testLongTimeouts();
+  void testMixedLevels();
+  void testRandomTimeouts();
+
+ private:
+  struct Expected {
+    TimeStamp earliest;
+    TimeStamp latest;
+    TimeStamp ran;
+    unsigned int count;
+    bool cancelled;
+  };
+
+  ExportMap m_map;
+  MockClock m_clock;
+  TimerWheel *m_wheel;
+  TimeStamp m_now;
+  TimeStamp m_last_run;
+  vector<Expected> m_expected;
+  vector<timeout_id> m_ids;
+  unsigned int m_count;
+
+  void Count() { m_count++; }
+
+  bool CountRepeating() {
+    m_count++;
+    return true;
+  }
+
+  void CancelOther(timeout_id *id) {
+    m_count++;
+    m_wheel->CancelTimeout(*id);
+  }
+
+  bool CancelSelf(timeout_id *id) {
+    m_count++;
+    m_wheel->CancelTimeout(*id);
+    return true;
+  }
+
+  void CheckExpiry(unsigned int index) {
+    Expected &expected = m_expected[index];
+    OLA_ASSERT_FALSE(expected.cancelled);
+    // Not before it's due, and not after the first check once it's due.
+    OLA_ASSERT_TRUE(expected.earliest <= m_now);
+    OLA_ASSERT_TRUE(m_last_run < expected.latest);
+    expected.ran = m_now;
+    expected.count++;
+  }
+
+  void Run(const TimeInterval &step);
+  void SleepUntilIdle();
+  void Register(const TimeInterval &interval);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+
+void TimerWheelTest::setUp() {
+  m_wheel = NULL;
+  m_count = 0;
+}
+
+
+/*
+ * Advance the clock and run the timeouts.
+ */
+void TimerWheelTest::Run(const TimeInterval &step) {
+  m_clock.AdvanceTime(step);
+  m_clock.CurrentTime(&m_now);
+  TimeStamp now = m_now;
+  m_wheel->ExecuteTimeouts(&now);
+  m_last_run = m_now;
+}
+
+
+/*
+ * Sleep for exactly as long as the wheel asks, until all the timeouts have
+ * run. This checks the wheel wakes us in time.
+ */
+void TimerWheelTest::SleepUntilIdle() {
+  unsigned int iterations = 0;
+  while (m_wheel->EventsPending()) {
+    m_clock.CurrentTime(&m_now);
+    TimeStamp now = m_now;
+    TimeInterval next = m_wheel->ExecuteTimeouts(&now);
+    m_last_run = m_now;
+    if (!m_wheel->EventsPending()) {
+      break;
+    }
+    OLA_ASSERT_FALSE(next.IsZero());
+    m_clock.AdvanceTime(next);
+    iterations++;
+    OLA_ASSERT_LT(iterations, 1000u);
+  }
+}
+
+
+/*
+ * Register a timeout, and record when it should run.
+ */
+void TimerWheelTest::Register(const TimeInterval &interval) {
+  Expected expected;
+  m_clock.CurrentTime(&expected.earliest);
+  expected.earliest += interval;
+  unsigned int index = m_expected.size();
+  timeout_id id = m_wheel->RegisterSingleTimeout(
+      interval,
+      NewSingleCallback(this, &TimerWheelTest::CheckExpiry, index));
+  m_clock.CurrentTime(&expected.latest);
+  expected.latest += interval;
+  expected.count = 0;
+  expected.cancelled = false;
+  m_expected.push_back(expected);
+  m_ids.push_back(id);
+}
+
+
+/*
+ * Check single use timeouts run once, at the right time.
+ */
+void TimerWheelTest::testSingleTimeouts() {
+  TimeoutManager timeout_manager(&m_map, &m_clock, true);
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+
+  TimeInterval timeout_interval(1, 0);
+  timeout_id id1 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval, NewSingleCallback(this, &TimerWheelTest::Count));
+  OLA_ASSERT_NE(id1, ola::thread::INVALID_TIMEOUT);
+  OLA_ASSERT_TRUE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(1, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  TimeStamp now;
+  m_clock.AdvanceTime(0, 500000);
+  m_clock.CurrentTime(&now);
+  TimeInterval next = timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(0u, m_count);
+  OLA_ASSERT_FALSE(next.IsZero());
+  OLA_ASSERT_LTE(next, TimeInterval(0, 500000));
+
+  m_clock.AdvanceTime(0, 500000);
+  m_clock.CurrentTime(&now);
+  next = timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_TRUE(next.IsZero());
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  // Cancelled timeouts don't run.
+  timeout_id id2 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval, NewSingleCallback(this, &TimerWheelTest::Count));
+  timeout_manager.CancelTimeout(id2);
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  m_clock.AdvanceTime(2, 0);
+  m_clock.CurrentTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+}
+
+
+/*
+ * Check repeating timeouts run until they're cancelled.
+ */
+void TimerWheelTest::testRepeatingTimeouts() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  timeout_id id = wheel.RegisterRepeatingTimeout(
+      TimeInterval(0, 20000),
+      NewCallback(this, &TimerWheelTest::CountRepeating));
+  for (unsigned int i = 0; i < 10; i++) {
+    Run(TimeInterval(0, 20000));
+    OLA_ASSERT_EQ(i + 1, m_count);
+  }
+
+  wheel.CancelTimeout(id);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  Run(TimeInterval(1, 0));
+  OLA_ASSERT_EQ(10u, m_count);
+
+  // Returning false stops the timeout, cancelling it from the callback does
+  // too.
+  id = wheel.RegisterRepeatingTimeout(
+      TimeInterval(0, 20000),
+      NewCallback(this, &TimerWheelTest::CancelSelf, &id));
+  Run(TimeInterval(0, 20000));
+  OLA_ASSERT_EQ(11u, m_count);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+}
+
+
+/*
+ * Check a callback can cancel another timeout which has also expired.
+ */
+void TimerWheelTest::testCancelFromCallback() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  timeout_id other;
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 10000),
+      NewSingleCallback(this, &TimerWheelTest::CancelOther, &other));
+  other = wheel.RegisterSingleTimeout(
+      TimeInterval(0, 10000), NewSingleCallback(this, &TimerWheelTest::Count));
+  OLA_ASSERT_TRUE(wheel.EventsPending());
+
+  Run(TimeInterval(1, 0));
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+}
+
+
+/*
+ * Check cancelling a timeout that has already run doesn't cancel the timeout
+ * that reuses its slot.
+ */
+void TimerWheelTest::testStaleIds() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  timeout_id id1 = wheel.RegisterSingleTimeout(
+      TimeInterval(0, 1000), NewSingleCallback(this, &TimerWheelTest::Count));
+  Run(TimeInterval(0, 2000));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  timeout_id id2 = wheel.RegisterSingleTimeout(
+      TimeInterval(0, 1000), NewSingleCallback(this, &TimerWheelTest::Count));
+  OLA_ASSERT_NE(id1, id2);
+  wheel.CancelTimeout(id1);
+  OLA_ASSERT_TRUE(wheel.EventsPending());
+  Run(TimeInterval(0, 2000));
+  OLA_ASSERT_EQ(2u, m_count);
+
+  // Made up ids are ignored.
+  wheel.CancelTimeout(reinterpret_cast<timeout_id>(12345));
+}
+
+
+/*
+ * Check timeouts in the higher levels, and beyond the end of the wheel.
+ */
+void TimerWheelTest::testLongTimeouts() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  Register(TimeInterval(0, 300000));  // level 1
+  Register(TimeInterval(30, 0));  // level 2
+  Register(TimeInterval(3600, 0));  // level 3
+  Register(TimeInterval(86400, 0));  // beyond the wheel
+
+  SleepUntilIdle();
+  for (unsigned int i = 0; i < m_expected.size(); i++) {
+    OLA_ASSERT_EQ(1u, m_expected[i].count);
+  }
+}
+
+
+/*
+ * Check that a timeout in a higher level isn't delayed by an occupied slot in
+ * the first level which is due later. Each timeout must run when it's due, not
+ * just at the first check after that.
+ */
+void TimerWheelTest::testMixedLevels() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  Register(TimeInterval(0, 300000));  // level 1
+  Run(TimeInterval(0, 200000));
+  // This is in the first level, but due after the level 1 timeout.
+  Register(TimeInterval(0, 255000));
+  Register(TimeInterval(0, 250000));
+  Register(TimeInterval(2, 0));  // level 1
+  Register(TimeInterval(20, 0));  // level 2
+  Run(TimeInterval(0, 1500));
+  Register(TimeInterval(0, 254000));
+
+  SleepUntilIdle();
+  for (unsigned int i = 0; i < m_expected.size(); i++) {
+    OLA_ASSERT_EQ(1u, m_expected[i].count);
+    // The mock clock follows the real clock, so allow for the time the test
+    // takes to run.
+    OLA_ASSERT_TRUE(m_expected[i].ran - m_expected[i].latest <
+                    TimeInterval(0, 5000));
+  }
+}
+
+
+/*
+ * Check a large number of timeouts, compared to the times they should run.
+ */
+void TimerWheelTest::testRandomTimeouts() {
+  TimerWheel wheel(&m_map, &m_clock);
+  m_wheel = &wheel;
+
+  uint32_t seed = 1;
+  for (unsigned int round = 0; round < 2000; round++) {
+    for (unsigned int i = 0; i < 5; i++) {
+      seed = seed * 1103515245 + 12345;
+      // Up to about 70 seconds, with some in the current tick.
+      Register(TimeInterval((seed >> 8) % 70000000));
+    }
+
+    seed = seed * 1103515245 + 12345;
+    unsigned int victim = (seed >> 8) % m_ids.size();
+    if (!m_expected[victim].count && !m_expected[victim].cancelled) {
+      wheel.CancelTimeout(m_ids[victim]);
+      m_expected[victim].cancelled = true;
+    }
+
+    seed = seed * 1103515245 + 12345;
+    Run(TimeInterval((seed >> 8) % 100000));
+  }
+
+  m_clock.AdvanceTime(100, 0);
+  Run(TimeInterval(0, 0));
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  for (unsigned int i = 0; i < m_expected.size(); i++) {
+    OLA_ASSERT_EQ(m_expected[i].cancelled ? 0u : 1u, m_expected[i].count);
+  }
+}
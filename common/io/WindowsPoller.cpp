@@ -355,7 +355,7 @@ bool WindowsPoller::Poll(TimeoutManager *timeout_manager,
               ConnectedDescriptor::OnCloseCallback *on_close =
                 descriptor->connected_descriptor->TransferOnClose();
               if (on_close)
-                on_close->Run();
+                HandleClose(on_close);
               if (descriptor->connected_descriptor) {
                 if (descriptor->delete_connected_on_close) {
                   if (RemoveReadDescriptor(descriptor->connected_descriptor) &&
@@ -527,7 +527,7 @@ bool WindowsPoller::Poll(TimeoutManager *timeout_manager,
     DescriptorHandle handle =
         descriptor->connected_descriptor->ReadDescriptor();
     if (*handle.m_async_data_size > 0) {
-      descriptor->connected_descriptor->PerformRead();
+      HandleRead(descriptor->connected_descriptor);
     }
   }
 
@@ -636,7 +636,7 @@ void WindowsPoller::HandleWakeup(PollData* data) {
               data->buffer, to_copy);
           *handle.m_async_data_size += to_copy;
           if (*handle.m_async_data_size > 0) {
-            descriptor->connected_descriptor->PerformRead();
+            HandleRead(descriptor->connected_descriptor);
           }
         } else if (!data->read && descriptor->write_descriptor) {
           OLA_WARN << "Write wakeup";
@@ -647,7 +647,7 @@ void WindowsPoller::HandleWakeup(PollData* data) {
             return;
           }
 
-          descriptor->write_descriptor->PerformWrite();
+          HandleWrite(descriptor->write_descriptor);
         } else {
           OLA_WARN << "Overlapped wakeup with data mismatch";
         }
@@ -663,9 +663,9 @@ void WindowsPoller::HandleWakeup(PollData* data) {
         } else {
           if (events.lNetworkEvents & (FD_READ | FD_ACCEPT)) {
             if (descriptor->connected_descriptor) {
-              descriptor->connected_descriptor->PerformRead();
+              HandleRead(descriptor->connected_descriptor);
             } else if (descriptor->read_descriptor) {
-              descriptor->read_descriptor->PerformRead();
+              HandleRead(descriptor->read_descriptor);
             } else {
               OLA_WARN << "No read descriptor for socket with read event";
             }
@@ -673,7 +673,7 @@ void WindowsPoller::HandleWakeup(PollData* data) {
 
           if (events.lNetworkEvents & (FD_WRITE | FD_CONNECT)) {
             if (descriptor->write_descriptor) {
-              descriptor->write_descriptor->PerformWrite();
+              HandleWrite(descriptor->write_descriptor);
             } else {
               OLA_WARN << "No write descriptor for socket with write event";
             }
@@ -684,7 +684,7 @@ void WindowsPoller::HandleWakeup(PollData* data) {
               ConnectedDescriptor::OnCloseCallback *on_close =
                   descriptor->connected_descriptor->TransferOnClose();
               if (on_close)
-                on_close->Run();
+                HandleClose(on_close);
               if (descriptor->delete_connected_on_close) {
                 if (RemoveReadDescriptor(descriptor->connected_descriptor) &&
                     m_export_map) {
@@ -746,7 +746,7 @@ void WindowsPoller::FinalCheckIOs(vector<PollData*> data) {
       memcpy(&(handle.m_async_data[*handle.m_async_data_size]),
           poll_data->buffer, to_copy);
       *handle.m_async_data_size += to_copy;
-      descriptor->connected_descriptor->PerformRead();
+      HandleRead(descriptor->connected_descriptor);
     }
   }
 }
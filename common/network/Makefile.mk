@@ -16,7 +16,8 @@ common_libolacommon_la_SOURCES += \
     common/network/SocketHelper.cpp \
     common/network/SocketHelper.h \
     common/network/TCPConnector.cpp \
-    common/network/TCPSocket.cpp
+    common/network/TCPSocket.cpp \
+    common/network/UDPSendQueue.cpp
 
 common_libolacommon_la_LIBADD += $(RESOLV_LIBS)
 
@@ -48,6 +48,7 @@
 #include <netinet/in.h>
 #endif  // HAVE_NETINET_IN_H
 
+#include <algorithm>
 #include <string>
 
 #include "common/network/SocketHelper.h"
@@ -76,8 +77,43 @@ bool ReceiveFrom(int fd, uint8_t *buffer, ssize_t *data_read,
   return true;
 }
 
+#if defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+// The most datagrams we pass to sendmmsg() / recvmmsg() in one call.
+const unsigned int MAX_MMSG_BATCH = 64;
+#endif  // defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+
 }  // namespace
 
+// UDPSocketInterface
+// ------------------------------------------------
+
+unsigned int UDPSocketInterface::SendBatch(const OutgoingDatagram *datagrams,
+                                           unsigned int count) {
+  unsigned int sent = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    ssize_t bytes_sent = SendTo(datagrams[i].data, datagrams[i].size,
+                                datagrams[i].destination);
+    if (bytes_sent == static_cast<ssize_t>(datagrams[i].size)) {
+      sent++;
+    }
+  }
+  return sent;
+}
+
+unsigned int UDPSocketInterface::RecvBatch(IncomingDatagram *datagrams,
+                                           unsigned int count) {
+  if (count == 0) {
+    return 0;
+  }
+
+  ssize_t data_read = datagrams[0].buffer_size;
+  if (!RecvFrom(datagrams[0].buffer, &data_read, &datagrams[0].source)) {
+    return 0;
+  }
+  datagrams[0].size = data_read;
+  return 1;
+}
+
 // UDPSocket
 // ------------------------------------------------
 
@@ -342,6 +378,112 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
   return ok;
 }
 
+unsigned int UDPSocket::SendBatch(const OutgoingDatagram *datagrams,
+                                  unsigned int count) {
+#ifdef HAVE_SENDMMSG
+  if (!ValidWriteDescriptor())
+    return 0;
+
+  struct mmsghdr messages[MAX_MMSG_BATCH];
+  struct iovec iovs[MAX_MMSG_BATCH];
+  struct sockaddr_in destinations[MAX_MMSG_BATCH];
+  unsigned int sent = 0;
+
+  while (count) {
+    const unsigned int batch_size = std::min(count, MAX_MMSG_BATCH);
+    unsigned int message_count = 0;
+    for (unsigned int i = 0; i < batch_size; i++) {
+      if (!datagrams[i].destination.ToSockAddr(
+            reinterpret_cast<sockaddr*>(&destinations[message_count]),
+            sizeof(destinations[message_count]))) {
+        continue;
+      }
+      iovs[message_count].iov_base = const_cast<uint8_t*>(datagrams[i].data);
+      iovs[message_count].iov_len = datagrams[i].size;
+
+      struct msghdr *header = &messages[message_count].msg_hdr;
+      memset(header, 0, sizeof(*header));
+      header->msg_name = &destinations[message_count];
+      header->msg_namelen = sizeof(destinations[message_count]);
+      header->msg_iov = &iovs[message_count];
+      header->msg_iovlen = 1;
+      message_count++;
+    }
+
+    // sendmmsg() stops at the first datagram that fails, so skip over it and
+    // carry on with the rest.
+    unsigned int offset = 0;
+    while (offset < message_count) {
+      int result = sendmmsg(m_handle, messages + offset,
+                            message_count - offset, 0);
+      if (result < 0) {
+        if (errno == EINTR)
+          continue;
+        OLA_INFO << "sendmmsg failed: " << strerror(errno);
+        offset++;
+        continue;
+      }
+
+      for (int i = 0; i < result; i++) {
+        if (messages[offset + i].msg_len == iovs[offset + i].iov_len)
+          sent++;
+      }
+      offset += result;
+    }
+
+    datagrams += batch_size;
+    count -= batch_size;
+  }
+  return sent;
+#else
+  return UDPSocketInterface::SendBatch(datagrams, count);
+#endif  // HAVE_SENDMMSG
+}
+
+unsigned int UDPSocket::RecvBatch(IncomingDatagram *datagrams,
+                                  unsigned int count) {
+#ifdef HAVE_RECVMMSG
+  count = std::min(count, MAX_MMSG_BATCH);
+  if (count == 0)
+    return 0;
+
+  struct mmsghdr messages[MAX_MMSG_BATCH];
+  struct iovec iovs[MAX_MMSG_BATCH];
+  struct sockaddr_in sources[MAX_MMSG_BATCH];
+
+  for (unsigned int i = 0; i < count; i++) {
+    iovs[i].iov_base = datagrams[i].buffer;
+    iovs[i].iov_len = datagrams[i].buffer_size;
+
+    struct msghdr *header = &messages[i].msg_hdr;
+    memset(header, 0, sizeof(*header));
+    header->msg_name = &sources[i];
+    header->msg_namelen = sizeof(sources[i]);
+    header->msg_iov = &iovs[i];
+    header->msg_iovlen = 1;
+  }
+
+  int result = recvmmsg(m_handle, messages, count, MSG_DONTWAIT, NULL);
+  if (result < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      OLA_WARN << "recvmmsg fd: " << m_handle << " failed: "
+               << strerror(errno);
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < result; i++) {
+    datagrams[i].size = messages[i].msg_len;
+    datagrams[i].source = IPV4SocketAddress(
+        IPV4Address(sources[i].sin_addr.s_addr),
+        NetworkToHost(sources[i].sin_port));
+  }
+  return result;
+#else
+  return UDPSocketInterface::RecvBatch(datagrams, count);
+#endif  // HAVE_RECVMMSG
+}
+
 bool UDPSocket::EnableBroadcast() {
   if (m_handle == ola::io::INVALID_DESCRIPTOR)
     return false;
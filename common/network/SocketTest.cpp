@@ -32,6 +32,7 @@
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/Socket.h"
 #include "ola/network/TCPSocketFactory.h"
+#include "ola/network/UDPSendQueue.h"
 #include "ola/testing/TestUtils.h"
 
 
@@ -41,8 +42,11 @@ using ola::io::SelectServer;
 using ola::network::IPV4Address;
 using ola::network::GenericSocketAddress;
 using ola::network::IPV4SocketAddress;
+using ola::network::IncomingDatagram;
+using ola::network::OutgoingDatagram;
 using ola::network::TCPAcceptingSocket;
 using ola::network::TCPSocket;
+using ola::network::UDPSendQueue;
 using ola::network::UDPSocket;
 using std::string;
 
@@ -56,6 +60,8 @@ class SocketTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTCPSocketServerClose);
   CPPUNIT_TEST(testUDPSocket);
   CPPUNIT_TEST(testIOQueueUDPSend);
+  CPPUNIT_TEST(testUDPBatch);
+  CPPUNIT_TEST(testUDPSendQueue);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +71,8 @@ class SocketTest: public CppUnit::TestFixture {
     void testTCPSocketServerClose();
     void testUDPSocket();
     void testIOQueueUDPSend();
+    void testUDPBatch();
+    void testUDPSendQueue();
 
     // timing out indicates something went wrong
     void Timeout() {
@@ -279,6 +287,103 @@ void SocketTest::testIOQueueUDPSend() {
 }
 
 
+/*
+ * Test sending and receiving many datagrams with one call.
+ */
+void SocketTest::testUDPBatch() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+
+  // Nothing is waiting, this must not block
+  uint8_t buffers[4][8];
+  IncomingDatagram incoming[4];
+  for (unsigned int i = 0; i < 4; i++) {
+    incoming[i].buffer = buffers[i];
+    incoming[i].buffer_size = sizeof(buffers[i]);
+  }
+  OLA_ASSERT_EQ(0u, socket.RecvBatch(incoming, 4));
+
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6};
+  OutgoingDatagram outgoing[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    outgoing[i].data = data + i;
+    outgoing[i].size = 2 + i;
+    outgoing[i].destination = local_address;
+  }
+  OLA_ASSERT_EQ(0u, client_socket.SendBatch(outgoing, 0));
+  OLA_ASSERT_EQ(3u, client_socket.SendBatch(outgoing, 3));
+
+  IPV4SocketAddress client_address;
+  OLA_ASSERT_TRUE(client_socket.GetSocketAddress(&client_address));
+
+  // Datagrams are read in order, up to the number of buffers.
+  OLA_ASSERT_EQ(2u, socket.RecvBatch(incoming, 2));
+  OLA_ASSERT_DATA_EQUALS(data, 2, incoming[0].buffer, incoming[0].size);
+  OLA_ASSERT_DATA_EQUALS(data + 1, 3, incoming[1].buffer, incoming[1].size);
+  OLA_ASSERT_EQ(client_address.Port(), incoming[0].source.Port());
+  OLA_ASSERT_EQ(IPV4Address::Loopback(), incoming[0].source.Host());
+
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(incoming, 4));
+  OLA_ASSERT_DATA_EQUALS(data + 2, 4, incoming[0].buffer, incoming[0].size);
+  OLA_ASSERT_EQ(0u, socket.RecvBatch(incoming, 4));
+}
+
+
+/*
+ * Test the UDPSendQueue holds datagrams until it's flushed.
+ */
+void SocketTest::testUDPSendQueue() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+  UDPSendQueue queue(&client_socket, 4, 2);
+  OLA_ASSERT_TRUE(queue.Empty());
+  OLA_ASSERT_EQ(0u, queue.Flush());
+
+  uint8_t buffer[16];
+  IncomingDatagram incoming;
+  incoming.buffer = buffer;
+  incoming.buffer_size = sizeof(buffer);
+
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  OLA_ASSERT_TRUE(queue.Add(data, 4, local_address));
+  OLA_ASSERT_EQ(1u, queue.Size());
+  OLA_ASSERT_EQ(0u, socket.RecvBatch(&incoming, 1));
+
+  // Datagrams larger than the queue's limit are sent straight away
+  OLA_ASSERT_TRUE(queue.Add(data, 8, local_address));
+  OLA_ASSERT_EQ(1u, queue.Size());
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(&incoming, 1));
+  OLA_ASSERT_DATA_EQUALS(data, 8, incoming.buffer, incoming.size);
+
+  // Adding to a full queue flushes it first
+  OLA_ASSERT_TRUE(queue.Add(data + 1, 3, local_address));
+  OLA_ASSERT_TRUE(queue.Add(data + 2, 2, local_address));
+  OLA_ASSERT_EQ(1u, queue.Size());
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(&incoming, 1));
+  OLA_ASSERT_DATA_EQUALS(data, 4, incoming.buffer, incoming.size);
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(&incoming, 1));
+  OLA_ASSERT_DATA_EQUALS(data + 1, 3, incoming.buffer, incoming.size);
+  OLA_ASSERT_EQ(0u, socket.RecvBatch(&incoming, 1));
+
+  OLA_ASSERT_EQ(1u, queue.Flush());
+  OLA_ASSERT_TRUE(queue.Empty());
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(&incoming, 1));
+  OLA_ASSERT_DATA_EQUALS(data + 2, 2, incoming.buffer, incoming.size);
+}
+
+
 /*
  * Receive some data and close the socket
  */
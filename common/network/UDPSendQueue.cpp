@@ -0,0 +1,77 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPSendQueue.cpp
+ * Queue datagrams and send them with a single call.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "ola/network/UDPSendQueue.h"
+
+#include <string.h>
+
+#include "ola/Logging.h"
+
+namespace ola {
+namespace network {
+
+UDPSendQueue::UDPSendQueue(UDPSocketInterface *socket,
+                           unsigned int max_datagram_size,
+                           unsigned int max_datagrams)
+    : m_socket(socket),
+      m_max_datagram_size(max_datagram_size),
+      m_max_datagrams(max_datagrams ? max_datagrams : 1) {
+}
+
+bool UDPSendQueue::Add(const uint8_t *data, unsigned int size,
+                       const IPV4SocketAddress &destination) {
+  if (size > m_max_datagram_size) {
+    return m_socket->SendTo(data, size, destination) ==
+        static_cast<ssize_t>(size);
+  }
+
+  if (m_storage.empty()) {
+    m_storage.resize(m_max_datagram_size * m_max_datagrams);
+    m_datagrams.reserve(m_max_datagrams);
+  }
+
+  if (m_datagrams.size() == m_max_datagrams) {
+    Flush();
+  }
+
+  OutgoingDatagram datagram;
+  datagram.data = &m_storage[m_datagrams.size() * m_max_datagram_size];
+  datagram.size = size;
+  datagram.destination = destination;
+  memcpy(const_cast<uint8_t*>(datagram.data), data, size);
+  m_datagrams.push_back(datagram);
+  return true;
+}
+
+unsigned int UDPSendQueue::Flush() {
+  if (m_datagrams.empty()) {
+    return 0;
+  }
+
+  unsigned int sent = m_socket->SendBatch(&m_datagrams[0], m_datagrams.size());
+  if (sent != m_datagrams.size()) {
+    OLA_INFO << "Only sent " << sent << " of " << m_datagrams.size()
+             << " datagrams";
+  }
+  m_datagrams.clear();
+  return sent;
+}
+}  // namespace network
+}  // namespace ola
@@ -0,0 +1,230 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RpcBenchmark.cpp
+ * Measure the throughput and allocations of the RpcChannel.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Two RpcChannels are connected with a pipe. Streaming requests, which carry
+ * a universe of data by default, are sent in batches like the StreamingClient
+ * does. Echo requests measure the round trip time.
+ *
+ * Global operator new is replaced so we can count the allocations made per
+ * message.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "common/rpc/TestService.pb.h"
+#include "common/rpc/TestServiceService.pb.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::PipeDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::EchoReply;
+using ola::rpc::EchoRequest;
+using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using ola::rpc::TestService_Stub;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_s_uint32(messages, m, 200000, "The number of streaming requests");
+DEFINE_s_uint32(batch, b, 200, "The number of requests to send at once");
+DEFINE_s_uint32(echos, e, 20000, "The number of echo round trips");
+DEFINE_s_uint32(size, s, ola::DMX_UNIVERSE_SIZE,
+                "The size of the data in each request");
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size)
+#if __cplusplus < 201103L
+    throw(std::bad_alloc)
+#endif  // __cplusplus < 201103L
+{  // NOLINT(whitespace/braces)
+  allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+  free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) throw() {
+  free(ptr);
+}
+#endif  // __cplusplus >= 201402L
+
+/*
+ * The server end, this counts the requests.
+ */
+class BenchmarkService: public ola::rpc::TestService {
+ public:
+  BenchmarkService() : m_stream_count(0) {}
+
+  void Echo(RpcController*,
+            const EchoRequest* request,
+            EchoReply* response,
+            CompletionCallback* done) {
+    response->set_data(request->data());
+    done->Run();
+  }
+
+  void Stream(RpcController*,
+              const EchoRequest*,
+              ola::rpc::STREAMING_NO_RESPONSE*,
+              CompletionCallback*) {
+    m_stream_count++;
+  }
+
+  unsigned int StreamCount() const { return m_stream_count; }
+
+ private:
+  unsigned int m_stream_count;
+};
+
+/*
+ * Print the result of a run.
+ */
+void Report(const char *name, const TimeInterval &duration,
+            unsigned int count, uint64_t allocs) {
+  double usec = static_cast<double>(duration.AsInt());
+  cout << std::setw(12) << std::left << name << " "
+       << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+       << (usec * 1000.0 / count) << " ns/msg, "
+       << std::setw(10) << (count * 1000000.0 / usec) << " msgs/s, "
+       << std::setw(6) << std::setprecision(2)
+       << (static_cast<double>(allocs) / count) << " allocs/msg" << endl;
+}
+
+/*
+ * Send the streaming requests, draining each batch before the next.
+ */
+void RunStreaming(SelectServer *ss, TestService_Stub *stub,
+                  const BenchmarkService &service, const EchoRequest &request,
+                  unsigned int messages, unsigned int batch) {
+  const unsigned int received = service.StreamCount();
+  unsigned int sent = 0;
+  while (sent < messages) {
+    for (unsigned int i = 0; i < batch && sent < messages; i++) {
+      stub->Stream(NULL, &request, NULL, NULL);
+      sent++;
+    }
+    while (service.StreamCount() - received < sent) {
+      ss->RunOnce(TimeInterval(0, 0));
+    }
+  }
+}
+
+void EchoComplete(bool *done) {
+  *done = true;
+}
+
+void RunEcho(SelectServer *ss, TestService_Stub *stub,
+             const EchoRequest &request, unsigned int echos) {
+  RpcController controller;
+  EchoReply reply;
+  for (unsigned int i = 0; i < echos; i++) {
+    bool done = false;
+    controller.Reset();
+    stub->Echo(&controller, &request, &reply,
+               ola::NewSingleCallback(EchoComplete, &done));
+    while (!done) {
+      ss->RunOnce(TimeInterval(0, 0));
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark RPC throughput over a pipe.");
+
+  if (FLAGS_messages == 0 || FLAGS_batch == 0) {
+    cout << "Need at least 1 message and a batch size of 1" << endl;
+    return 1;
+  }
+
+  SelectServer ss;
+  PipeDescriptor client_end;
+  if (!client_end.Init()) {
+    cout << "Failed to create the pipe" << endl;
+    return 1;
+  }
+  auto_ptr<PipeDescriptor> server_end(client_end.OppositeEnd());
+
+  BenchmarkService service;
+  RpcChannel client_channel(NULL, &client_end);
+  RpcChannel server_channel(&service, server_end.get());
+  client_channel.EnableNonBlockingWrites(&ss);
+  server_channel.EnableNonBlockingWrites(&ss);
+  ss.AddReadDescriptor(&client_end);
+  ss.AddReadDescriptor(server_end.get());
+  TestService_Stub stub(&client_channel);
+
+  EchoRequest request;
+  request.set_data(string(FLAGS_size, 'x'));
+
+  cout << "Sending " << FLAGS_messages << " requests of "
+       << FLAGS_size << " bytes, in batches of " << FLAGS_batch << endl;
+
+  // Warm up, so the buffers have grown to their final size.
+  RunStreaming(&ss, &stub, service, request, FLAGS_batch, FLAGS_batch);
+  RunEcho(&ss, &stub, request, 1);
+
+  Clock clock;
+  TimeStamp start, end;
+
+  uint64_t allocs = allocations;
+  clock.CurrentTime(&start);
+  RunStreaming(&ss, &stub, service, request, FLAGS_messages, FLAGS_batch);
+  clock.CurrentTime(&end);
+  Report("Stream", end - start, FLAGS_messages, allocations - allocs);
+
+  if (FLAGS_echos) {
+    allocs = allocations;
+    clock.CurrentTime(&start);
+    RunEcho(&ss, &stub, request, FLAGS_echos);
+    clock.CurrentTime(&end);
+    Report("Echo", end - start, FLAGS_echos, allocations - allocs);
+  }
+
+  ss.RemoveReadDescriptor(&client_end);
+  ss.RemoveReadDescriptor(server_end.get());
+  return 0;
+}
@@ -46,6 +46,35 @@ using google::protobuf::ServiceDescriptor;
 using std::auto_ptr;
 using std::string;
 
+namespace {
+/*
+ * Return the serialized size of a message, this also caches the size for
+ * SerializeWithCachedSizesToArray().
+ */
+unsigned int MessageSize(const Message &message) {
+#if GOOGLE_PROTOBUF_VERSION >= 3001000
+  return message.ByteSizeLong();
+#else
+  return message.ByteSize();
+#endif  // GOOGLE_PROTOBUF_VERSION
+}
+
+/*
+ * The keys used to count each type of message received.
+ */
+const struct {
+  Type type;
+  const char *key;
+} RECEIVED_TYPE_KEYS[] = {
+  {REQUEST, "request"},
+  {RESPONSE, "response"},
+  {RESPONSE_CANCEL, "cancelled"},
+  {RESPONSE_FAILED, "failed"},
+  {RESPONSE_NOT_IMPLEMENTED, "not-implemented"},
+  {STREAM_REQUEST, "stream_request"},
+};
+}  // namespace
+
 const char RpcChannel::K_RPC_RECEIVED_TYPE_VAR[] = "rpc-received-type";
 const char RpcChannel::K_RPC_RECEIVED_VAR[] = "rpc-received";
 const char RpcChannel::K_RPC_SENT_ERROR_VAR[] = "rpc-send-errors";
@@ -117,7 +146,20 @@ RpcChannel::RpcChannel(
       m_buffer_size(0),
       m_expected_size(0),
       m_current_size(0),
+      m_header(0),
+      m_header_size(0),
+      m_recv_message(new RpcMessage()),
+      m_send_message(new RpcMessage()),
+      m_send_buffer(NULL),
+      m_send_buffer_size(0),
+      m_ss(NULL),
+      m_output_queue(&m_block_pool),
+      m_max_queued_bytes(DEFAULT_MAX_QUEUED_BYTES),
+      m_write_registered(false),
       m_export_map(export_map),
+      m_received_var(NULL),
+      m_sent_var(NULL),
+      m_send_error_var(NULL),
       m_recv_type_map(NULL) {
   if (descriptor) {
     descriptor->SetOnData(
@@ -130,13 +172,48 @@ RpcChannel::RpcChannel(
     for (unsigned int i = 0; i < arraysize(K_RPC_VARIABLES); ++i) {
       m_export_map->GetCounterVar(string(K_RPC_VARIABLES[i]));
     }
-    m_recv_type_map = m_export_map->GetUIntMapVar(K_RPC_RECEIVED_TYPE_VAR,
-                                                  "type");
+    m_received_var = m_export_map->GetCounterVar(K_RPC_RECEIVED_VAR);
+    m_sent_var = m_export_map->GetCounterVar(K_RPC_SENT_VAR);
+    m_send_error_var = m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR);
+
+    m_recv_type_map = m_export_map->GetCounterMapVar(K_RPC_RECEIVED_TYPE_VAR,
+                                                     "type");
+    for (unsigned int i = 0; i < arraysize(RECEIVED_TYPE_KEYS); ++i) {
+      unsigned int type = RECEIVED_TYPE_KEYS[i].type;
+      if (type >= m_recv_type_handles.size()) {
+        m_recv_type_handles.resize(type + 1, CounterMap::INVALID_HANDLE);
+      }
+      m_recv_type_handles[type] = m_recv_type_map->Register(
+          RECEIVED_TYPE_KEYS[i].key);
+    }
   }
 }
 
 RpcChannel::~RpcChannel() {
+  UnregisterForWrites();
+  if (m_ss && m_descriptor) {
+    m_descriptor->SetOnWritable(NULL);
+  }
   free(m_buffer);
+  free(m_send_buffer);
+  STLDeleteValues(&m_request_cache);
+}
+
+bool RpcChannel::EnableNonBlockingWrites(ola::io::SelectServerInterface *ss,
+                                         unsigned int max_queued_bytes) {
+  if (!(m_descriptor && ss)) {
+    return false;
+  }
+
+  if (!ola::io::ConnectedDescriptor::SetNonBlocking(
+        m_descriptor->WriteDescriptor())) {
+    return false;
+  }
+  m_ss = ss;
+  m_max_queued_bytes = max_queued_bytes;
+  m_descriptor->SetOnWritable(
+      ola::NewCallback(this, &RpcChannel::PerformWrite));
+  return true;
 }
 
 void RpcChannel::DescriptorReady() {
@@ -207,9 +284,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
                             const Message *request,
                             Message *reply,
                             SingleUseCallback0<void> *done) {
-  // TODO(simonn): reduce the number of copies here
-  string output;
-  RpcMessage message;
   bool is_streaming = false;
 
   // Streaming methods are those with a reply set to STREAMING_NO_RESPONSE and
@@ -223,13 +297,13 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
     is_streaming = true;
   }
 
-  message.set_type(is_streaming ? STREAM_REQUEST : REQUEST);
-  message.set_id(m_sequence.Next());
-  message.set_name(method->name());
-
-  request->SerializeToString(&output);
-  message.set_buffer(output);
-  bool r = SendMsg(&message);
+  // The message is reused so that its strings keep their capacity.
+  const int id = m_sequence.Next();
+  m_send_message->set_type(is_streaming ? STREAM_REQUEST : REQUEST);
+  m_send_message->set_id(id);
+  m_send_message->set_name(method->name());
+  request->SerializeToString(m_send_message->mutable_buffer());
+  bool r = SendMsg(*m_send_message);
 
   if (is_streaming)
     return;
@@ -242,10 +316,10 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
   }
 
   OutstandingResponse *response = new OutstandingResponse(
-      message.id(), controller, done, reply);
+      id, controller, done, reply);
 
   auto_ptr<OutstandingResponse> old_response(
-      STLReplacePtr(&m_responses, message.id(), response));
+      STLReplacePtr(&m_responses, id, response));
 
   if (old_response.get()) {
     // fail any outstanding response with the same id
@@ -257,19 +331,16 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
 }
 
 void RpcChannel::RequestComplete(OutstandingRequest *request) {
-  string output;
-  RpcMessage message;
-
   if (request->controller->Failed()) {
     SendRequestFailed(request);
     return;
   }
 
-  message.set_type(RESPONSE);
-  message.set_id(request->id);
-  request->response->SerializeToString(&output);
-  message.set_buffer(output);
-  SendMsg(&message);
+  m_send_message->Clear();
+  m_send_message->set_type(RESPONSE);
+  m_send_message->set_id(request->id);
+  request->response->SerializeToString(m_send_message->mutable_buffer());
+  SendMsg(*m_send_message);
   DeleteOutstandingRequest(request);
 }
 
@@ -282,48 +353,74 @@ RpcSession *RpcChannel::Session() {
 
 /*
  * Write an RpcMessage to the write descriptor.
+ *
+ * The header and message are serialized into the send buffer, which is reused
+ * between calls. If earlier data is still waiting to be written, the message
+ * is copied into the pooled output queue, which is flushed with writev().
  */
-bool RpcChannel::SendMsg(RpcMessage *msg) {
+bool RpcChannel::SendMsg(const RpcMessage &msg) {
   if (!(m_descriptor && m_descriptor->ValidReadDescriptor())) {
     OLA_WARN << "RPC descriptor closed, not sending messages";
     return false;
   }
 
   uint32_t header;
-  // reserve the first 4 bytes for the header
-  string output(sizeof(header), 0);
-  msg->AppendToString(&output);
-  int length = output.size();
-
-  RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
-                                length - sizeof(header));
-  output.replace(
-      0, sizeof(header),
-      reinterpret_cast<const char*>(&header), sizeof(header));
+  const unsigned int msg_size = MessageSize(msg);
+  const ssize_t length = sizeof(header) + msg_size;
+  if (!AllocateSendBuffer(length)) {
+    OLA_WARN << "Failed to allocate " << length << " bytes for RPC message";
+    return false;
+  }
 
-  ssize_t ret = m_descriptor->Send(
-      reinterpret_cast<const uint8_t*>(output.data()), length);
+  RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION, msg_size);
+  memcpy(m_send_buffer, &header, sizeof(header));
+  msg.SerializeWithCachedSizesToArray(m_send_buffer + sizeof(header));
 
-  if (ret != length) {
-    OLA_WARN << "Failed to send full RPC message, closing channel";
+  const uint8_t *data = m_send_buffer;
+  if (!m_output_queue.Empty()) {
+    // Earlier messages are still waiting, so this one goes behind them.
+    if (m_output_queue.Size() + length > m_max_queued_bytes) {
+      OLA_WARN << "RPC write queue full, closing channel";
+      WriteFailed();
+      return false;
+    }
+    QueueData(data, length);
+  } else {
+    ssize_t ret = m_descriptor->Send(data, length);
+    if (ret < 0 && m_ss && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      ret = 0;
+    }
 
-    if (m_export_map) {
-      (*m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR))++;
+    if (ret < 0 || (ret != length && !m_ss)) {
+      OLA_WARN << "Failed to send full RPC message, closing channel";
+      WriteFailed();
+      return false;
+    } else if (ret != length) {
+      QueueData(data + ret, length - ret);
     }
+  }
 
-    // At this point there is no point using the descriptor since framing has
-    // probably been messed up.
-    // TODO(simon): consider if it's worth leaving the descriptor open for
-    // reading.
-    m_descriptor = NULL;
+  if (m_sent_var) {
+    (*m_sent_var)++;
+  }
+  return true;
+}
 
-    HandleChannelClose();
-    return false;
+
+/*
+ * Make sure the send buffer can hold at least size bytes.
+ */
+bool RpcChannel::AllocateSendBuffer(unsigned int size) {
+  if (size <= m_send_buffer_size) {
+    return true;
   }
 
-  if (m_export_map) {
-    (*m_export_map->GetCounterVar(K_RPC_SENT_VAR))++;
+  uint8_t *new_buffer = static_cast<uint8_t*>(realloc(m_send_buffer, size));
+  if (!new_buffer) {
+    return false;
   }
+  m_send_buffer = new_buffer;
+  m_send_buffer_size = size;
   return true;
 }
 
@@ -360,25 +457,92 @@ int RpcChannel::AllocateMsgBuffer(unsigned int size) {
 
 
 /*
- * Read 4 bytes and decode the header fields.
- * @returns: -1 if there is no data is available, version and size are 0
+ * Queue data to be written once the descriptor is writable.
+ */
+void RpcChannel::QueueData(const uint8_t *data, unsigned int length) {
+  m_output_queue.Write(data, length);
+  if (!m_write_registered) {
+    m_write_registered = m_ss->AddWriteDescriptor(m_descriptor);
+  }
+}
+
+
+/*
+ * Called when the descriptor is writable and we have data queued.
+ */
+void RpcChannel::PerformWrite() {
+  if (!m_descriptor) {
+    return;
+  }
+
+  ssize_t ret = m_descriptor->Send(&m_output_queue);
+  if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    OLA_WARN << "Failed to write queued RPC data, closing channel";
+    WriteFailed();
+    return;
+  }
+
+  if (m_output_queue.Empty()) {
+    UnregisterForWrites();
+    if (m_on_drained.get()) {
+      m_on_drained->Run();
+    }
+  }
+}
+
+
+void RpcChannel::UnregisterForWrites() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_descriptor);
+    m_write_registered = false;
+  }
+}
+
+
+/*
+ * Called when we can no longer write to the descriptor.
+ */
+void RpcChannel::WriteFailed() {
+  if (m_send_error_var) {
+    (*m_send_error_var)++;
+  }
+
+  // At this point there is no point using the descriptor since framing has
+  // probably been messed up.
+  // TODO(simon): consider if it's worth leaving the descriptor open for
+  // reading.
+  UnregisterForWrites();
+  m_output_queue.Clear();
+  m_descriptor = NULL;
+
+  HandleChannelClose();
+}
+
+
+/*
+ * Read the 4 byte header and decode the header fields. If the descriptor is
+ * non-blocking the header may arrive over more than one read.
+ * @returns: -1 if there was an error, 0 otherwise. If the header is
+ *   incomplete, version and size are 0.
  */
 int RpcChannel::ReadHeader(unsigned int *version,
-                                 unsigned int *size) const {
-  uint32_t header;
+                           unsigned int *size) {
   unsigned int data_read = 0;
   *version = *size = 0;
 
-  if (m_descriptor->Receive(reinterpret_cast<uint8_t*>(&header),
-                            sizeof(header), data_read)) {
+  if (m_descriptor->Receive(
+        reinterpret_cast<uint8_t*>(&m_header) + m_header_size,
+        sizeof(m_header) - m_header_size, data_read)) {
     OLA_WARN << "read header error: " << strerror(errno);
     return -1;
   }
 
-  if (!data_read)
+  m_header_size += data_read;
+  if (m_header_size < sizeof(m_header))
     return 0;
 
-  RpcHeader::DecodeHeader(header, version, size);
+  m_header_size = 0;
+  RpcHeader::DecodeHeader(m_header, version, size);
   return 0;
 }
 
@@ -387,44 +551,37 @@ int RpcChannel::ReadHeader(unsigned int *version,
  * Parse a new message and handle it.
  */
 bool RpcChannel::HandleNewMsg(uint8_t *data, unsigned int size) {
-  RpcMessage msg;
+  RpcMessage &msg = *m_recv_message;
   if (!msg.ParseFromArray(data, size)) {
     OLA_WARN << "Failed to parse RPC";
     return false;
   }
 
-  if (m_export_map)
-    (*m_export_map->GetCounterVar(K_RPC_RECEIVED_VAR))++;
+  if (m_received_var) {
+    (*m_received_var)++;
+  }
+  if (m_recv_type_map &&
+      static_cast<unsigned int>(msg.type()) < m_recv_type_handles.size()) {
+    m_recv_type_map->Increment(m_recv_type_handles[msg.type()]);
+  }
 
   switch (msg.type()) {
     case REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["request"]++;
       HandleRequest(&msg);
       break;
     case RESPONSE:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["response"]++;
       HandleResponse(&msg);
       break;
     case RESPONSE_CANCEL:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["cancelled"]++;
       HandleCanceledResponse(&msg);
       break;
     case RESPONSE_FAILED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["failed"]++;
       HandleFailedResponse(&msg);
       break;
     case RESPONSE_NOT_IMPLEMENTED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["not-implemented"]++;
       HandleNotImplemented(&msg);
       break;
     case STREAM_REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["stream_request"]++;
       HandleStreamRequest(&msg);
       break;
     default:
@@ -456,16 +613,18 @@ void RpcChannel::HandleRequest(RpcMessage *msg) {
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
+  Message* request_pb = GetRequest(method);
   Message* response_pb = m_service->GetResponsePrototype(method).New();
 
   if (!request_pb || !response_pb) {
     OLA_WARN << "failed to get request or response objects";
+    delete response_pb;
     return;
   }
 
   if (!request_pb->ParseFromString(msg->buffer())) {
     OLA_WARN << "parsing of request pb failed";
+    delete response_pb;
     return;
   }
 
@@ -482,7 +641,6 @@ void RpcChannel::HandleRequest(RpcMessage *msg) {
       this, &RpcChannel::RequestComplete, request);
   m_service->CallMethod(method, request->controller, request_pb, response_pb,
                         callback);
-  delete request_pb;
 }
 
 
@@ -513,7 +671,7 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
+  Message* request_pb = GetRequest(method);
 
   if (!request_pb) {
     OLA_WARN << "failed to get request or response objects";
@@ -527,7 +685,23 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
 
   RpcController controller(m_session.get());
   m_service->CallMethod(method, &controller, request_pb, NULL, NULL);
-  delete request_pb;
+}
+
+
+/*
+ * Return the request object to parse requests for a method into. Since the
+ * services can't hold on to the request once CallMethod() returns, a single
+ * object is reused for each method.
+ */
+Message *RpcChannel::GetRequest(const MethodDescriptor *method) {
+  Message *request = STLFindOrNull(m_request_cache, method);
+  if (!request) {
+    request = m_service->GetRequestPrototype(method).New();
+    if (request) {
+      m_request_cache[method] = request;
+    }
+  }
+  return request;
 }
 
 
@@ -536,11 +710,11 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
  * Notify the caller that the request failed.
  */
 void RpcChannel::SendRequestFailed(OutstandingRequest *request) {
-  RpcMessage message;
-  message.set_type(RESPONSE_FAILED);
-  message.set_id(request->id);
-  message.set_buffer(request->controller->ErrorText());
-  SendMsg(&message);
+  m_send_message->Clear();
+  m_send_message->set_type(RESPONSE_FAILED);
+  m_send_message->set_id(request->id);
+  m_send_message->set_buffer(request->controller->ErrorText());
+  SendMsg(*m_send_message);
   DeleteOutstandingRequest(request);
 }
 
@@ -549,10 +723,10 @@ void RpcChannel::SendRequestFailed(OutstandingRequest *request) {
  * Sent if we get a request for a non-existent method.
  */
 void RpcChannel::SendNotImplemented(int msg_id) {
-  RpcMessage message;
-  message.set_type(RESPONSE_NOT_IMPLEMENTED);
-  message.set_id(msg_id);
-  SendMsg(&message);
+  m_send_message->Clear();
+  m_send_message->set_type(RESPONSE_NOT_IMPLEMENTED);
+  m_send_message->set_id(msg_id);
+  SendMsg(*m_send_message);
 }
 
 
@@ -625,6 +799,7 @@ void RpcChannel::HandleNotImplemented(RpcMessage *msg) {
  * Invoke the Channel close handler/
  */
 void RpcChannel::HandleChannelClose() {
+  UnregisterForWrites();
   if (m_on_close.get()) {
     m_on_close.release()->Run(m_session.get());
   }
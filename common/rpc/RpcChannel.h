@@ -29,8 +29,13 @@
 #include <google/protobuf/service.h>
 #include <ola/Callback.h>
 #include <ola/io/Descriptor.h>
+#include <ola/io/IOQueue.h>
+#include <ola/io/MemoryBlockPool.h>
+#include <ola/io/SelectServerInterface.h>
 #include <ola/util/SequenceNumber.h>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "ola/ExportMap.h"
 
@@ -47,6 +52,11 @@ class RpcService;
  * server.
  * This implementation runs over a ConnectedDescriptor which means it can be
  * used over TCP or pipes.
+ *
+ * Once the buffers have grown to fit the largest message, sending and
+ * receiving RPCs doesn't allocate memory: outgoing messages are serialized
+ * into a reused buffer and incoming messages are parsed into reused
+ * RpcMessage and request objects.
  */
 class RpcChannel {
  public :
@@ -108,6 +118,37 @@ class RpcChannel {
      */
     void SetChannelCloseHandler(CloseCallback *callback);
 
+    /**
+     * @brief Buffer writes that would block, rather than closing the channel.
+     *
+     * By default a short write closes the channel, since the framing is lost.
+     * Once this is called the write side of the descriptor is put into
+     * non-blocking mode and any data that can't be written immediately is
+     * queued and flushed when the descriptor becomes writable. The channel is
+     * only closed if a write fails or the queue grows beyond max_queued_bytes.
+     * @param ss the SelectServer to register the descriptor with for write
+     *   events. Ownership is not transferred.
+     * @param max_queued_bytes the maximum number of bytes to queue.
+     * @returns true if the descriptor could be made non-blocking.
+     */
+    bool EnableNonBlockingWrites(
+        ola::io::SelectServerInterface *ss,
+        unsigned int max_queued_bytes = DEFAULT_MAX_QUEUED_BYTES);
+
+    /**
+     * @brief Return the number of bytes waiting to be written.
+     */
+    unsigned int QueuedBytes() const { return m_output_queue.Size(); }
+
+    /**
+     * @brief Set the Callback to be run when the write queue drains.
+     * @param callback the callback to run once all queued data has been
+     *   written, ownership is transferred.
+     */
+    void SetWriteDrainedHandler(Callback0<void> *callback) {
+      m_on_drained.reset(callback);
+    }
+
     /**
      * @brief Invoke an RPC method on this channel.
      */
@@ -135,13 +176,21 @@ class RpcChannel {
      */
     static const unsigned int PROTOCOL_VERSION = 1;
 
+    /**
+     * @brief The default limit on the number of bytes to queue.
+     */
+    static const unsigned int DEFAULT_MAX_QUEUED_BYTES = 1 << 20;  // 1M
+
  private:
     typedef HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingResponse*>
       ResponseMap;
+    typedef std::map<const google::protobuf::MethodDescriptor*,
+                     google::protobuf::Message*> RequestMap;
 
     std::auto_ptr<RpcSession> m_session;
     RpcService *m_service;  // service to dispatch requests to
     std::auto_ptr<CloseCallback> m_on_close;
+    std::auto_ptr<Callback0<void> > m_on_drained;
     // the descriptor to read/write to.
     class ola::io::ConnectedDescriptor *m_descriptor;
     SequenceNumber<uint32_t> m_sequence;
@@ -149,15 +198,37 @@ class RpcChannel {
     unsigned int m_buffer_size;  // size of the buffer
     unsigned int m_expected_size;  // the total size of the current msg
     unsigned int m_current_size;  // the amount of data read for the current msg
+    uint32_t m_header;  // the header of the next msg
+    unsigned int m_header_size;  // the amount of the header read so far
+    std::auto_ptr<RpcMessage> m_recv_message;  // reused for incoming msgs
+    RequestMap m_request_cache;  // reused request objects, by method
+    std::auto_ptr<RpcMessage> m_send_message;  // reused for outgoing msgs
+    uint8_t *m_send_buffer;  // the serialized outgoing msg
+    unsigned int m_send_buffer_size;  // size of the send buffer
+    // Set if writes are non-blocking.
+    ola::io::SelectServerInterface *m_ss;
+    ola::io::MemoryBlockPool m_block_pool;
+    ola::io::IOQueue m_output_queue;  // data waiting to be written
+    unsigned int m_max_queued_bytes;
+    bool m_write_registered;
     HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingRequest*> m_requests;
     ResponseMap m_responses;
     ExportMap *m_export_map;
-    UIntMap *m_recv_type_map;
+    // Resolved once so counting a message doesn't need a lookup.
+    CounterVariable *m_received_var;
+    CounterVariable *m_sent_var;
+    CounterVariable *m_send_error_var;
+    CounterMap *m_recv_type_map;
+    // Indexed by the RpcMessage type.
+    std::vector<CounterMap::Handle> m_recv_type_handles;
 
-    bool SendMsg(RpcMessage *msg);
+    bool SendMsg(const RpcMessage &msg);
+    bool AllocateSendBuffer(unsigned int size);
     int AllocateMsgBuffer(unsigned int size);
-    int ReadHeader(unsigned int *version, unsigned int *size) const;
+    int ReadHeader(unsigned int *version, unsigned int *size);
     bool HandleNewMsg(uint8_t *buffer, unsigned int size);
+    google::protobuf::Message *GetRequest(
+        const google::protobuf::MethodDescriptor *method);
     void HandleRequest(RpcMessage *msg);
     void HandleStreamRequest(RpcMessage *msg);
 
@@ -172,6 +243,10 @@ class RpcChannel {
     void HandleCanceledResponse(RpcMessage *msg);
     void HandleNotImplemented(RpcMessage *msg);
 
+    void QueueData(const uint8_t *data, unsigned int length);
+    void PerformWrite();
+    void UnregisterForWrites();
+    void WriteFailed();
     void HandleChannelClose();
 
     static const char K_RPC_RECEIVED_TYPE_VAR[];
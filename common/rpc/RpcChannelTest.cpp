@@ -25,6 +25,7 @@
 
 #include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcController.h"
+#include "common/rpc/RpcSession.h"
 #include "common/rpc/TestService.h"
 #include "common/rpc/TestService.pb.h"
 #include "common/rpc/TestServiceService.pb.h"
@@ -35,12 +36,15 @@
 
 
 using ola::NewSingleCallback;
+using ola::TimeInterval;
 using ola::io::LoopbackDescriptor;
+using ola::io::PipeDescriptor;
 using ola::io::SelectServer;
 using ola::rpc::EchoReply;
 using ola::rpc::EchoRequest;
 using ola::rpc::RpcChannel;
 using ola::rpc::RpcController;
+using ola::rpc::RpcSession;
 using ola::rpc::STREAMING_NO_RESPONSE;
 using ola::rpc::RpcController;
 using ola::rpc::TestService;
@@ -53,22 +57,33 @@ class RpcChannelTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testBlockedWrites);
   CPPUNIT_TEST_SUITE_END();
 
  public:
+  RpcChannelTest()
+      : m_channel_closed(false),
+        m_write_drained(false) {
+  }
+
   void setUp();
   void tearDown();
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testBlockedWrites();
   void EchoComplete();
   void FailedEchoComplete();
+  void ChannelClosed(RpcSession*) { m_channel_closed = true; }
+  void WriteDrained() { m_write_drained = true; }
 
  private:
   RpcController m_controller;
   EchoRequest m_request;
   EchoReply m_reply;
   SelectServer m_ss;
+  bool m_channel_closed;
+  bool m_write_drained;
 
   auto_ptr<TestServiceImpl> m_service;
   auto_ptr<RpcChannel> m_channel;
@@ -139,3 +154,55 @@ void RpcChannelTest::testStreamRequest() {
   m_stub->Stream(NULL, &m_request, NULL, NULL);
   m_ss.Run();
 }
+
+/*
+ * Check that a writer which gets ahead of the reader queues the data rather
+ * than closing the channel.
+ */
+void RpcChannelTest::testBlockedWrites() {
+  PipeDescriptor writer;
+  OLA_ASSERT_TRUE(writer.Init());
+  auto_ptr<PipeDescriptor> reader(writer.OppositeEnd());
+
+  RpcChannel sender(NULL, &writer);
+  OLA_ASSERT_TRUE(sender.EnableNonBlockingWrites(&m_ss));
+  sender.SetChannelCloseHandler(
+      NewSingleCallback(this, &RpcChannelTest::ChannelClosed));
+  sender.SetWriteDrainedHandler(
+      ola::NewCallback(this, &RpcChannelTest::WriteDrained));
+  TestService_Stub stub(&sender);
+
+  TestServiceImpl service(&m_ss);
+  RpcChannel receiver(&service, reader.get());
+
+  // Nothing is reading yet, so keep sending until the pipe fills.
+  m_request.set_data("foo");
+  unsigned int sent = 0;
+  while (!sender.QueuedBytes() && sent < 100000) {
+    stub.Stream(NULL, &m_request, NULL, NULL);
+    sent++;
+  }
+  OLA_ASSERT_GT(sender.QueuedBytes(), 0u);
+
+  // Later messages are queued behind the partial one.
+  const unsigned int queued = sender.QueuedBytes();
+  for (unsigned int i = 0; i < 10; i++) {
+    stub.Stream(NULL, &m_request, NULL, NULL);
+    sent++;
+  }
+  OLA_ASSERT_GT(sender.QueuedBytes(), queued);
+  OLA_ASSERT_FALSE(m_channel_closed);
+
+  // Now read everything, the queue should drain.
+  m_ss.AddReadDescriptor(reader.get());
+  for (unsigned int i = 0;
+       service.StreamCount() < sent && i < sent * 2; i++) {
+    m_ss.RunOnce(TimeInterval(0, 0));
+  }
+  m_ss.RemoveReadDescriptor(reader.get());
+
+  OLA_ASSERT_EQ(sent, service.StreamCount());
+  OLA_ASSERT_TRUE(m_write_drained);
+  OLA_ASSERT_EQ(0u, sender.QueuedBytes());
+  OLA_ASSERT_FALSE(m_channel_closed);
+}
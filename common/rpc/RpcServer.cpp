@@ -130,6 +130,9 @@ bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
   // ownership of the socket here.
   RpcChannel *channel = new RpcChannel(m_service, descriptor,
                                        m_options.export_map);
+  // Slow clients shouldn't block the server, queue whatever can't be written
+  // immediately.
+  channel->EnableNonBlockingWrites(m_ss);
 
   if (m_session_handler) {
     m_session_handler->NewClient(channel->Session());
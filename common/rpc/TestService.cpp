@@ -73,6 +73,7 @@ void TestServiceImpl::Stream(RpcController* controller,
   OLA_ASSERT_FALSE(done);
   OLA_ASSERT_TRUE(request);
   OLA_ASSERT_EQ(string(TestClient::kTestData), request->data());
+  m_stream_count++;
   m_ss->Terminate();
 }
 
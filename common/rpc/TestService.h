@@ -31,7 +31,10 @@
 
 class TestServiceImpl: public ola::rpc::TestService {
  public:
-  explicit TestServiceImpl(ola::io::SelectServer *ss) : m_ss(ss) {}
+  explicit TestServiceImpl(ola::io::SelectServer *ss)
+      : m_ss(ss),
+        m_stream_count(0) {
+  }
   ~TestServiceImpl() {}
 
   void Echo(ola::rpc::RpcController* controller,
@@ -48,8 +51,12 @@ class TestServiceImpl: public ola::rpc::TestService {
               const ola::rpc::EchoRequest* request,
               ola::rpc::STREAMING_NO_RESPONSE* response,
               CompletionCallback* done);
+
+  unsigned int StreamCount() const { return m_stream_count; }
+
  private:
   ola::io::SelectServer *m_ss;
+  unsigned int m_stream_count;
 };
 
 
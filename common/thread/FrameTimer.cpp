@@ -0,0 +1,127 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FrameTimer.cpp
+ * Paces a thread that sends frames at a fixed rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "ola/thread/FrameTimer.h"
+
+namespace ola {
+namespace thread {
+
+FrameTimer::FrameTimer(const TimeInterval &period,
+                       const TimeInterval &max_spin_time)
+    : m_period_ns(period.AsInt() * ONE_THOUSAND),
+      m_max_spin_ns(max_spin_time.AsInt() * ONE_THOUSAND),
+      m_spin_ns(m_max_spin_ns),
+      m_next_frame_ns(0) {
+}
+
+unsigned int FrameTimer::WaitForNextFrame() {
+  if (m_period_ns <= 0) {
+    return 0;
+  }
+
+  int64_t now = Now();
+  if (!m_next_frame_ns) {
+    // Line up with the other timers using the same period.
+    m_next_frame_ns = (now / m_period_ns + 1) * m_period_ns;
+  }
+
+  unsigned int skipped = 0;
+  if (now < m_next_frame_ns) {
+    WaitUntil(m_next_frame_ns);
+  } else {
+    // We're late, start this frame now and keep the phase for the next one.
+    skipped = static_cast<unsigned int>(
+        (now - m_next_frame_ns) / m_period_ns);
+    m_next_frame_ns += skipped * m_period_ns;
+  }
+  m_next_frame_ns += m_period_ns;
+  return skipped;
+}
+
+void FrameTimer::Sleep(const TimeInterval &duration) {
+  WaitUntil(Now() + duration.AsInt() * ONE_THOUSAND);
+}
+
+void FrameTimer::WaitUntil(int64_t deadline_ns) {
+  if (!m_max_spin_ns) {
+    SleepUntil(deadline_ns);
+    return;
+  }
+
+  const int64_t wake_ns = deadline_ns - m_spin_ns;
+  if (Now() < wake_ns) {
+    SleepUntil(wake_ns);
+    // Adapt to the latency of the wake up. Wake up twice as early as the
+    // last late wake up, and slowly claw back the CPU time if we're early.
+    const int64_t late_ns = Now() - wake_ns;
+    if (2 * late_ns > m_spin_ns) {
+      m_spin_ns = std::min(2 * late_ns, m_max_spin_ns);
+    } else {
+      m_spin_ns -= m_spin_ns / 64;
+    }
+  }
+
+  while (Now() < deadline_ns) {
+  }
+}
+
+int64_t FrameTimer::Now() {
+#ifdef CLOCK_MONOTONIC
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * ONE_THOUSAND * ONE_THOUSAND *
+         ONE_THOUSAND + now.tv_nsec;
+#else
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentTime(&now);
+  return (now - TimeStamp()).AsInt() * ONE_THOUSAND;
+#endif  // CLOCK_MONOTONIC
+}
+
+void FrameTimer::SleepUntil(int64_t wake_ns) {
+#ifdef HAVE_CLOCK_NANOSLEEP
+  const int64_t one_second = ONE_THOUSAND * ONE_THOUSAND * ONE_THOUSAND;
+  struct timespec wake;
+  wake.tv_sec = static_cast<time_t>(wake_ns / one_second);
+  wake.tv_nsec = static_cast<long>(  // NOLINT(runtime/int)
+      wake_ns % one_second);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) ==
+         EINTR) {
+  }
+#else
+  int64_t delay_ns = wake_ns - Now();
+  if (delay_ns > 0) {
+    usleep(static_cast<useconds_t>(delay_ns / ONE_THOUSAND));
+  }
+#endif  // HAVE_CLOCK_NANOSLEEP
+}
+}  // namespace thread
+}  // namespace ola
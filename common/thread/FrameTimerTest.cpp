@@ -0,0 +1,127 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FrameTimerTest.cpp
+ * Test fixture for the FrameTimer class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+
+#include "ola/Clock.h"
+#include "ola/thread/FrameTimer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::FrameTimer;
+
+class FrameTimerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FrameTimerTest);
+  CPPUNIT_TEST(testFrameRate);
+  CPPUNIT_TEST(testLateFrames);
+  CPPUNIT_TEST(testSleep);
+  CPPUNIT_TEST(testSpin);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testFrameRate();
+    void testLateFrames();
+    void testSleep();
+    void testSpin();
+
+ private:
+    Clock m_clock;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameTimerTest);
+
+
+/*
+ * Check frames are sent at the right rate.
+ */
+void FrameTimerTest::testFrameRate() {
+  FrameTimer timer(TimeInterval(0, 2000));
+
+  // The first frame is after the start, and each frame, sent or skipped, is
+  // a period after the previous one.
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  unsigned int periods = 0;
+  timer.WaitForNextFrame();
+  for (unsigned int i = 0; i < 10; i++) {
+    periods += 1 + timer.WaitForNextFrame();
+  }
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(periods * 2000 - 1000));
+}
+
+
+/*
+ * Check frames are skipped rather than sent back to back when we're late.
+ */
+void FrameTimerTest::testLateFrames() {
+  FrameTimer timer(TimeInterval(0, 2000));
+  OLA_ASSERT_EQ(0u, timer.WaitForNextFrame());
+  usleep(11000);
+  OLA_ASSERT_TRUE(timer.WaitForNextFrame() >= 4);
+
+  // The following frame waits for the next period.
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  timer.WaitForNextFrame();
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start > TimeInterval(0, 0));
+
+  // A zero period doesn't wait.
+  FrameTimer unpaced((TimeInterval()));
+  OLA_ASSERT_EQ(0u, unpaced.WaitForNextFrame());
+}
+
+
+/*
+ * Check Sleep() waits for at least the duration.
+ */
+void FrameTimerTest::testSleep() {
+  FrameTimer timer((TimeInterval()));
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  timer.Sleep(TimeInterval(0, 5000));
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 5000));
+}
+
+
+/*
+ * Check the busy wait stays within the limit.
+ */
+void FrameTimerTest::testSpin() {
+  const TimeInterval max_spin(0, 500);
+  FrameTimer timer(TimeInterval(0, 2000), max_spin);
+  OLA_ASSERT_EQ(max_spin, timer.SpinTime());
+
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < 5; i++) {
+    timer.WaitForNextFrame();
+    timer.Sleep(TimeInterval(0, 100));
+    OLA_ASSERT_TRUE(timer.SpinTime() <= max_spin);
+  }
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 8000));
+}
@@ -3,12 +3,22 @@
 common_libolacommon_la_SOURCES += \
     common/thread/ConsumerThread.cpp \
     common/thread/ExecutorThread.cpp \
+    common/thread/FrameTimer.cpp \
     common/thread/Mutex.cpp \
     common/thread/PeriodicThread.cpp \
     common/thread/SignalThread.cpp \
     common/thread/Thread.cpp \
     common/thread/ThreadPool.cpp \
-    common/thread/Utils.cpp
+    common/thread/Utils.cpp \
+    common/thread/WorkStealingPool.cpp
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/thread/thread_pool_benchmark
+
+common_thread_thread_pool_benchmark_SOURCES = \
+    common/thread/ThreadPoolBenchmark.cpp
+common_thread_thread_pool_benchmark_LDADD = common/libolacommon.la
 
 # TESTS
 ##################################################
@@ -17,8 +27,11 @@ test_programs += common/thread/ExecutorThreadTester \
                  common/thread/FutureTester
 
 common_thread_ThreadTester_SOURCES = \
+    common/thread/FrameTimerTest.cpp \
+    common/thread/SPSCQueueTest.cpp \
     common/thread/ThreadPoolTest.cpp \
-    common/thread/ThreadTest.cpp
+    common/thread/ThreadTest.cpp \
+    common/thread/WorkStealingPoolTest.cpp
 common_thread_ThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_ThreadTester_LDADD = $(COMMON_TESTING_LIBS)
 
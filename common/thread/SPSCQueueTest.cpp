@@ -0,0 +1,166 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueueTest.cpp
+ * Test fixture for the SPSCQueue class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::SPSCQueue;
+
+class SPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPSCQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testWrapAround);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testPushPop();
+    void testWrapAround();
+    void testThreads();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPSCQueueTest);
+
+namespace {
+
+struct Element {
+  uint32_t value;
+  uint32_t check;
+};
+
+static const unsigned int THREAD_ELEMENT_COUNT = 1000000;
+
+/*
+ * Push THREAD_ELEMENT_COUNT elements, yielding when the queue is full so this
+ * doesn't crawl on a single CPU.
+ */
+class Producer : public ola::thread::Thread {
+ public:
+  explicit Producer(SPSCQueue<Element> *queue) : m_queue(queue) {}
+
+ protected:
+  void *Run() {
+    for (uint32_t i = 0; i < THREAD_ELEMENT_COUNT; i++) {
+      Element *element;
+      while (!(element = m_queue->Reserve())) {
+        sched_yield();
+      }
+      element->value = i;
+      element->check = ~i;
+      m_queue->Commit();
+    }
+    return NULL;
+  }
+
+ private:
+  SPSCQueue<Element> *m_queue;
+};
+}  // namespace
+
+
+/*
+ * Check elements come out in the order they went in.
+ */
+void SPSCQueueTest::testPushPop() {
+  SPSCQueue<Element> queue(3);
+  OLA_ASSERT_EQ(4u, queue.Capacity());
+  OLA_ASSERT_TRUE(queue.Empty());
+  OLA_ASSERT_NULL(queue.Front());
+
+  for (uint32_t i = 0; i < 4; i++) {
+    Element *element = queue.Reserve();
+    OLA_ASSERT_NOT_NULL(element);
+    element->value = i;
+    queue.Commit();
+  }
+  OLA_ASSERT_FALSE(queue.Empty());
+  // Full
+  OLA_ASSERT_NULL(queue.Reserve());
+
+  for (uint32_t i = 0; i < 4; i++) {
+    Element *element = queue.Front();
+    OLA_ASSERT_NOT_NULL(element);
+    OLA_ASSERT_EQ(i, element->value);
+    queue.Pop();
+  }
+  OLA_ASSERT_TRUE(queue.Empty());
+  OLA_ASSERT_NULL(queue.Front());
+}
+
+
+/*
+ * Check the queue keeps working as the indices wrap around the elements.
+ */
+void SPSCQueueTest::testWrapAround() {
+  SPSCQueue<Element> queue(4);
+  // Keep a few elements in the queue, so the head and tail are apart.
+  uint32_t next = 0;
+  for (; next < 3; next++) {
+    Element *element = queue.Reserve();
+    OLA_ASSERT_NOT_NULL(element);
+    element->value = next;
+    queue.Commit();
+  }
+
+  for (uint32_t expected = 0; expected < 100; expected++) {
+    Element *element = queue.Reserve();
+    OLA_ASSERT_NOT_NULL(element);
+    element->value = next++;
+    queue.Commit();
+    OLA_ASSERT_NULL(queue.Reserve());
+
+    element = queue.Front();
+    OLA_ASSERT_NOT_NULL(element);
+    OLA_ASSERT_EQ(expected, element->value);
+    queue.Pop();
+  }
+  OLA_ASSERT_FALSE(queue.Empty());
+}
+
+
+/*
+ * Pass elements between two threads.
+ */
+void SPSCQueueTest::testThreads() {
+  SPSCQueue<Element> queue(64);
+  Producer producer(&queue);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  uint32_t expected = 0;
+  while (expected < THREAD_ELEMENT_COUNT) {
+    Element *element = queue.Front();
+    if (!element) {
+      sched_yield();
+      continue;
+    }
+    OLA_ASSERT_EQ(expected, element->value);
+    OLA_ASSERT_EQ(~expected, element->check);
+    queue.Pop();
+    expected++;
+  }
+  OLA_ASSERT_TRUE(producer.Join());
+  OLA_ASSERT_TRUE(queue.Empty());
+}
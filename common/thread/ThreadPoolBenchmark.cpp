@@ -0,0 +1,158 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadPoolBenchmark.cpp
+ * Compare the throughput of the ThreadPool and the WorkStealingPool.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/ThreadPool.h"
+#include "ola/thread/WorkStealingPool.h"
+
+using ola::Clock;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::Thread;
+using ola::thread::ThreadPool;
+using ola::thread::WorkStealingPool;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(threads, t, 4, "The number of threads in each pool");
+DEFINE_s_uint32(producers, p, 2,
+                "The number of threads queueing callbacks");
+DEFINE_s_uint32(callbacks, c, 200000,
+                "The number of callbacks queued by each producer");
+DEFINE_uint32(work, 100, "The number of loop iterations in each callback");
+
+/*
+ * A small amount of work, like encoding a few pixels.
+ */
+void DoWork(unsigned int iterations) {
+  volatile uint32_t value = 0;
+  for (unsigned int i = 0; i < iterations; i++) {
+    value = value * 31 + i;
+  }
+}
+
+/*
+ * Queues the callbacks, Executor is anything with an Execute() method.
+ */
+template <typename Executor>
+class ProducerThread : public Thread {
+ public:
+  explicit ProducerThread(Executor *executor)
+      : Thread(Thread::Options("producer")),
+        m_executor(executor) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < FLAGS_callbacks; i++) {
+      m_executor->Execute(
+          NewSingleCallback(&DoWork, static_cast<unsigned int>(FLAGS_work)));
+    }
+    return NULL;
+  }
+
+ private:
+  Executor *m_executor;
+};
+
+/*
+ * Start the producers and wait for them to finish.
+ */
+template <typename Executor>
+void RunProducers(Executor *executor) {
+  vector<ProducerThread<Executor>*> producers;
+  for (unsigned int i = 0; i < FLAGS_producers; i++) {
+    producers.push_back(new ProducerThread<Executor>(executor));
+    producers.back()->Start();
+  }
+  for (unsigned int i = 0; i < producers.size(); i++) {
+    producers[i]->Join();
+    delete producers[i];
+  }
+}
+
+void PrintResult(const string &name, const TimeInterval &duration) {
+  const uint64_t callbacks = static_cast<uint64_t>(FLAGS_producers) *
+                             FLAGS_callbacks;
+  const int64_t usecs = duration.AsInt();
+  cout << std::left << std::setw(20) << name << std::right << std::setw(10)
+       << duration << "s";
+  if (usecs > 0) {
+    cout << std::setw(12) << callbacks * 1000000 / usecs << " callbacks/s";
+  }
+  cout << endl;
+}
+
+/*
+ * The ThreadPool runs everything that's queued before JoinAll() returns.
+ */
+TimeInterval RunThreadPool() {
+  Clock clock;
+  TimeStamp start, end;
+  ThreadPool pool(FLAGS_threads);
+  pool.Init();
+  clock.CurrentTime(&start);
+  RunProducers(&pool);
+  pool.JoinAll();
+  clock.CurrentTime(&end);
+  return end - start;
+}
+
+TimeInterval RunWorkStealingPool() {
+  Clock clock;
+  TimeStamp start, end;
+  WorkStealingPool pool(FLAGS_threads);
+  pool.Start();
+  clock.CurrentTime(&start);
+  RunProducers(&pool);
+  pool.DrainCallbacks();
+  clock.CurrentTime(&end);
+  pool.Stop();
+  return end - start;
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare the callback throughput of the ThreadPool and the "
+               "WorkStealingPool.");
+
+  cout << FLAGS_producers << " producers, " << FLAGS_threads << " threads, "
+       << FLAGS_callbacks << " callbacks per producer" << endl;
+  PrintResult("ThreadPool", RunThreadPool());
+  PrintResult("WorkStealingPool", RunWorkStealingPool());
+  return 0;
+}
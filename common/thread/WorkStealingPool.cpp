@@ -0,0 +1,677 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingPool.cpp
+ * An executor which runs callbacks on a pool of work stealing threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sstream>
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/thread/WorkStealingPool.h"
+
+namespace ola {
+namespace thread {
+
+namespace {
+
+#ifdef __ATOMIC_ACQUIRE
+template <typename T>
+inline T LoadRelaxed(const T *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+template <typename T>
+inline T LoadAcquire(const T *value) {
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+inline void StoreRelaxed(T *value, T new_value) {
+  __atomic_store_n(value, new_value, __ATOMIC_RELAXED);
+}
+
+template <typename T>
+inline void StoreRelease(T *value, T new_value) {
+  __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+// On failure, expected is updated with the current value.
+template <typename T>
+inline bool CompareAndSwap(T *value, T *expected, T new_value) {
+  return __atomic_compare_exchange_n(value, expected, new_value, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+template <typename T>
+inline T FetchAdd(T *value, T delta) {
+  return __atomic_fetch_add(value, delta, __ATOMIC_SEQ_CST);
+}
+
+template <typename T>
+inline T FetchSub(T *value, T delta) {
+  return __atomic_fetch_sub(value, delta, __ATOMIC_SEQ_CST);
+}
+
+inline void FenceRelease() {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+inline void FenceSeqCst() {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+#else
+template <typename T>
+inline T LoadAcquire(const T *value) {
+  T result = *const_cast<const volatile T*>(value);
+  __sync_synchronize();
+  return result;
+}
+
+template <typename T>
+inline T LoadRelaxed(const T *value) {
+  return LoadAcquire(value);
+}
+
+template <typename T>
+inline void StoreRelease(T *value, T new_value) {
+  __sync_synchronize();
+  *const_cast<volatile T*>(value) = new_value;
+}
+
+template <typename T>
+inline void StoreRelaxed(T *value, T new_value) {
+  StoreRelease(value, new_value);
+}
+
+template <typename T>
+inline bool CompareAndSwap(T *value, T *expected, T new_value) {
+  T old_value = __sync_val_compare_and_swap(value, *expected, new_value);
+  if (old_value == *expected) {
+    return true;
+  }
+  *expected = old_value;
+  return false;
+}
+
+template <typename T>
+inline T FetchAdd(T *value, T delta) {
+  return __sync_fetch_and_add(value, delta);
+}
+
+template <typename T>
+inline T FetchSub(T *value, T delta) {
+  return __sync_fetch_and_sub(value, delta);
+}
+
+inline void FenceRelease() {
+  __sync_synchronize();
+}
+
+inline void FenceSeqCst() {
+  __sync_synchronize();
+}
+#endif  // __ATOMIC_ACQUIRE
+
+unsigned int RoundUp(unsigned int size) {
+  unsigned int result = 1;
+  while (result < size) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// The indices grow without bound and wrap, the difference between two of
+// them is signed.
+inline intptr_t Distance(size_t from, size_t to) {
+  return static_cast<intptr_t>(to - from);
+}
+
+#ifdef __GNUC__
+// The worker that's running in this thread, if any.
+__thread void *current_worker = NULL;
+#endif  // __GNUC__
+}  // namespace
+
+const unsigned int WorkStealingPool::DEQUE_SIZE;
+const unsigned int WorkStealingPool::INJECTION_QUEUE_SIZE;
+const unsigned int WorkStealingPool::BATCH_SIZE;
+
+/*
+ * A worker thread and its deque. This is the fixed size version of the
+ * Chase-Lev deque: the worker pushes and takes at the bottom, other workers
+ * steal from the top.
+ */
+class WorkStealingPool::Worker : public Thread {
+ public:
+  Worker(WorkStealingPool *pool, unsigned int size,
+         const Thread::Options &options)
+      : Thread(options),
+        m_pool(pool),
+        m_mask(RoundUp(size) - 1),
+        m_actions(new Action[m_mask + 1]),
+        m_seed(reinterpret_cast<uintptr_t>(this) | 1),
+        m_steals(0),
+        m_top(0),
+        m_bottom(0) {
+  }
+
+  ~Worker() { delete[] m_actions; }
+
+  WorkStealingPool *Pool() const { return m_pool; }
+
+  void *Run() {
+#ifdef __GNUC__
+    current_worker = this;
+#endif  // __GNUC__
+    m_pool->WorkerLoop(this);
+    return NULL;
+  }
+
+  /*
+   * Called by the worker, returns false if the deque is full.
+   */
+  bool Push(Action action) {
+    const size_t bottom = LoadRelaxed(&m_bottom);
+    const size_t top = LoadAcquire(&m_top);
+    if (Distance(top, bottom) > static_cast<intptr_t>(m_mask)) {
+      return false;
+    }
+    StoreRelaxed(&m_actions[bottom & m_mask], action);
+    FenceRelease();
+    StoreRelaxed(&m_bottom, bottom + 1);
+    return true;
+  }
+
+  /*
+   * Called by the worker, returns the most recently pushed action.
+   */
+  Action Take() {
+    const size_t bottom = LoadRelaxed(&m_bottom) - 1;
+    StoreRelaxed(&m_bottom, bottom);
+    FenceSeqCst();
+    size_t top = LoadRelaxed(&m_top);
+
+    if (Distance(top, bottom) < 0) {
+      StoreRelaxed(&m_bottom, bottom + 1);
+      return NULL;
+    }
+
+    Action action = LoadRelaxed(&m_actions[bottom & m_mask]);
+    if (top == bottom) {
+      // The last one, race the thieves for it.
+      if (!CompareAndSwap(&m_top, &top, top + 1)) {
+        action = NULL;
+      }
+      StoreRelaxed(&m_bottom, bottom + 1);
+    }
+    return action;
+  }
+
+  /*
+   * Called by the other workers, returns the oldest action.
+   */
+  Action Steal() {
+    size_t top = LoadAcquire(&m_top);
+    FenceSeqCst();
+    const size_t bottom = LoadAcquire(&m_bottom);
+    if (Distance(top, bottom) <= 0) {
+      return NULL;
+    }
+
+    Action action = LoadRelaxed(&m_actions[top & m_mask]);
+    if (!CompareAndSwap(&m_top, &top, top + 1)) {
+      return NULL;
+    }
+    return action;
+  }
+
+  bool Empty() const {
+    return Distance(LoadAcquire(&m_top), LoadAcquire(&m_bottom)) <= 0;
+  }
+
+  /*
+   * Pick a victim, a xorshift is good enough for this.
+   */
+  unsigned int Random() {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+  }
+
+  void CountSteal() { FetchAdd(&m_steals, 1u); }
+  unsigned int Steals() const { return LoadRelaxed(&m_steals); }
+
+ private:
+  enum { CACHE_LINE_SIZE = 64 };
+
+  WorkStealingPool *const m_pool;
+  const size_t m_mask;
+  Action *const m_actions;
+  uint32_t m_seed;
+  unsigned int m_steals;
+  uint8_t m_pad0[CACHE_LINE_SIZE];
+
+  // Written by the thieves.
+  size_t m_top;
+  uint8_t m_pad1[CACHE_LINE_SIZE];
+
+  // Written by the worker.
+  size_t m_bottom;
+  uint8_t m_pad2[CACHE_LINE_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+/*
+ * A bounded queue with any number of producers and consumers. Each slot has
+ * a sequence number, which tells a producer if the slot is free and a
+ * consumer if it's been filled in, so neither side needs a lock.
+ */
+class WorkStealingPool::InjectionQueue {
+ public:
+  explicit InjectionQueue(unsigned int size)
+      : m_mask(RoundUp(size) - 1),
+        m_cells(new Cell[m_mask + 1]),
+        m_enqueue_position(0),
+        m_dequeue_position(0) {
+    for (size_t i = 0; i <= m_mask; i++) {
+      m_cells[i].sequence = i;
+      m_cells[i].action = NULL;
+    }
+  }
+
+  ~InjectionQueue() { delete[] m_cells; }
+
+  /*
+   * Returns false if the queue is full.
+   */
+  bool Push(Action action) {
+    Cell *cell;
+    size_t position = LoadRelaxed(&m_enqueue_position);
+    while (true) {
+      cell = &m_cells[position & m_mask];
+      const intptr_t distance = Distance(
+          position, LoadAcquire(&cell->sequence));
+      if (distance == 0) {
+        if (CompareAndSwap(&m_enqueue_position, &position, position + 1)) {
+          break;
+        }
+      } else if (distance < 0) {
+        return false;
+      } else {
+        position = LoadRelaxed(&m_enqueue_position);
+      }
+    }
+    cell->action = action;
+    StoreRelease(&cell->sequence, position + 1);
+    return true;
+  }
+
+  /*
+   * Returns NULL if the queue is empty, or the next action hasn't been filled
+   * in yet.
+   */
+  Action Pop() {
+    Cell *cell;
+    size_t position = LoadRelaxed(&m_dequeue_position);
+    while (true) {
+      cell = &m_cells[position & m_mask];
+      const intptr_t distance = Distance(
+          position + 1, LoadAcquire(&cell->sequence));
+      if (distance == 0) {
+        if (CompareAndSwap(&m_dequeue_position, &position, position + 1)) {
+          break;
+        }
+      } else if (distance < 0) {
+        return NULL;
+      } else {
+        position = LoadRelaxed(&m_dequeue_position);
+      }
+    }
+    Action action = cell->action;
+    StoreRelease(&cell->sequence, position + m_mask + 1);
+    return action;
+  }
+
+  bool Empty() const {
+    return LoadAcquire(&m_dequeue_position) ==
+           LoadAcquire(&m_enqueue_position);
+  }
+
+ private:
+  enum { CACHE_LINE_SIZE = 64 };
+
+  struct Cell {
+    size_t sequence;
+    Action action;
+  };
+
+  const size_t m_mask;
+  Cell *const m_cells;
+  uint8_t m_pad0[CACHE_LINE_SIZE];
+  size_t m_enqueue_position;
+  uint8_t m_pad1[CACHE_LINE_SIZE];
+  size_t m_dequeue_position;
+  uint8_t m_pad2[CACHE_LINE_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN(InjectionQueue);
+};
+
+
+WorkStealingPool::WorkStealingPool(unsigned int thread_count,
+                                   const Thread::Options &options)
+    : m_thread_count(thread_count ? thread_count : 1),
+      m_options(options),
+      m_injection_queue(new InjectionQueue(INJECTION_QUEUE_SIZE)),
+      m_overflow_size(0),
+      m_outstanding(0),
+      m_running(false),
+      m_sleepers(0),
+      m_drainers(0),
+      m_wake_pending(0),
+      m_shutdown(0) {
+  // The workers are created up front so the set of victims never changes.
+  for (unsigned int i = 0; i < m_thread_count; i++) {
+    Thread::Options worker_options(m_options);
+    if (!worker_options.name.empty()) {
+      std::ostringstream str;
+      str << worker_options.name << "-" << i;
+      worker_options.name = str.str();
+    }
+    m_workers.push_back(new Worker(this, DEQUE_SIZE, worker_options));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  Stop();
+  for (unsigned int i = 0; i < m_workers.size(); i++) {
+    delete m_workers[i];
+  }
+  delete m_injection_queue;
+}
+
+bool WorkStealingPool::Start() {
+  if (m_running || LoadAcquire(&m_shutdown)) {
+    return false;
+  }
+  m_running = true;
+
+  for (unsigned int i = 0; i < m_workers.size(); i++) {
+    if (!m_workers[i]->Start()) {
+      OLA_WARN << "Failed to start worker " << i
+               << ", stopping WorkStealingPool";
+      Stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+void WorkStealingPool::Stop() {
+  {
+    MutexLocker locker(&m_mutex);
+    StoreRelease(&m_shutdown, 1u);
+    m_wake_condition.Broadcast();
+  }
+
+  if (m_running) {
+    // Join() returns false for workers that weren't started.
+    for (unsigned int i = 0; i < m_workers.size(); i++) {
+      m_workers[i]->Join();
+    }
+    m_running = false;
+  }
+  RunRemaining();
+}
+
+void WorkStealingPool::Execute(ola::BaseCallback0<void> *callback) {
+  FetchAdd(&m_outstanding, 1u);
+
+#ifdef __GNUC__
+  // Callbacks queued by a worker go on its own deque.
+  Worker *worker = static_cast<Worker*>(current_worker);
+  if (worker && worker->Pool() == this && worker->Push(callback)) {
+    WakeOne();
+    return;
+  }
+#endif  // __GNUC__
+
+  Enqueue(callback);
+  WakeOne();
+}
+
+void WorkStealingPool::DrainCallbacks() {
+  if (!m_running) {
+    RunRemaining();
+    return;
+  }
+
+  MutexLocker locker(&m_mutex);
+  FetchAdd(&m_drainers, 1u);
+  FenceSeqCst();
+  while (LoadAcquire(&m_outstanding)) {
+    m_drain_condition.Wait(&m_mutex);
+  }
+  FetchSub(&m_drainers, 1u);
+}
+
+unsigned int WorkStealingPool::Steals() const {
+  unsigned int steals = 0;
+  for (unsigned int i = 0; i < m_workers.size(); i++) {
+    steals += m_workers[i]->Steals();
+  }
+  return steals;
+}
+
+void WorkStealingPool::Enqueue(Action action) {
+  if (m_injection_queue->Push(action)) {
+    return;
+  }
+  MutexLocker locker(&m_overflow_mutex);
+  m_overflow.push_back(action);
+  FetchAdd(&m_overflow_size, 1u);
+}
+
+/*
+ * Our own deque first, then the callbacks from outside the pool, then the
+ * other workers.
+ */
+WorkStealingPool::Action WorkStealingPool::FindWork(Worker *worker) {
+  Action action = worker->Take();
+  if (action) {
+    return action;
+  }
+  action = TakeInjected(worker);
+  if (action) {
+    return action;
+  }
+  return Steal(worker);
+}
+
+/*
+ * Take a batch of callbacks from the injection queue. The first is returned
+ * and the rest go on our deque, where the other workers can steal them.
+ */
+WorkStealingPool::Action WorkStealingPool::TakeInjected(Worker *worker) {
+  Action action = PopInjected();
+  if (!action) {
+    return NULL;
+  }
+
+  Action batch[BATCH_SIZE];
+  unsigned int count = 0;
+  while (count < BATCH_SIZE - 1 &&
+         (batch[count] = m_injection_queue->Pop())) {
+    count++;
+  }
+
+  // Take() returns the most recent, so push them in reverse to run them in
+  // order.
+  for (unsigned int i = count; i > 0; i--) {
+    if (!worker->Push(batch[i - 1])) {
+      Enqueue(batch[i - 1]);
+    }
+  }
+  if (count) {
+    WakeAnother();
+  }
+  return action;
+}
+
+WorkStealingPool::Action WorkStealingPool::PopInjected() {
+  Action action = m_injection_queue->Pop();
+  if (action || !LoadAcquire(&m_overflow_size)) {
+    return action;
+  }
+
+  MutexLocker locker(&m_overflow_mutex);
+  if (m_overflow.empty()) {
+    return NULL;
+  }
+  action = m_overflow.front();
+  m_overflow.pop_front();
+  FetchSub(&m_overflow_size, 1u);
+  return action;
+}
+
+/*
+ * Try each of the other workers, starting from a random one so the thieves
+ * don't all pick the same victim.
+ */
+WorkStealingPool::Action WorkStealingPool::Steal(Worker *worker) {
+  const unsigned int size = m_workers.size();
+  const unsigned int start = worker->Random() % size;
+  for (unsigned int i = 0; i < size; i++) {
+    Worker *victim = m_workers[(start + i) % size];
+    if (victim == worker) {
+      continue;
+    }
+    Action action = victim->Steal();
+    if (action) {
+      worker->CountSteal();
+      return action;
+    }
+  }
+  return NULL;
+}
+
+bool WorkStealingPool::HasWork() const {
+  if (!m_injection_queue->Empty() || LoadAcquire(&m_overflow_size)) {
+    return true;
+  }
+  for (unsigned int i = 0; i < m_workers.size(); i++) {
+    if (!m_workers[i]->Empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::RunAction(Action action) {
+  action->Run();
+  if (FetchSub(&m_outstanding, 1u) != 1) {
+    return;
+  }
+  FenceSeqCst();
+  if (LoadRelaxed(&m_drainers)) {
+    MutexLocker locker(&m_mutex);
+    m_drain_condition.Broadcast();
+  }
+}
+
+/*
+ * A worker increments m_sleepers before checking for work one last time,
+ * and Execute() queues the callback before checking m_sleepers, so either
+ * the worker sees the callback or Execute() sees the worker.
+ */
+void WorkStealingPool::Sleep() {
+  MutexLocker locker(&m_mutex);
+  StoreRelaxed(&m_wake_pending, 0u);
+  FetchAdd(&m_sleepers, 1u);
+  FenceSeqCst();
+  if (!HasWork() && !LoadAcquire(&m_shutdown)) {
+    m_wake_condition.Wait(&m_mutex);
+  }
+  StoreRelaxed(&m_wake_pending, 0u);
+  FetchSub(&m_sleepers, 1u);
+}
+
+/*
+ * Wake a sleeping worker, unless a wake up is already in progress. The
+ * worker that wakes up wakes another if it finds more than it can run.
+ */
+void WorkStealingPool::WakeOne() {
+  FenceSeqCst();
+  if (!LoadRelaxed(&m_sleepers)) {
+    return;
+  }
+  unsigned int expected = 0;
+  if (!CompareAndSwap(&m_wake_pending, &expected, 1u)) {
+    return;
+  }
+  MutexLocker locker(&m_mutex);
+  m_wake_condition.Signal();
+}
+
+void WorkStealingPool::WakeAnother() {
+  FenceSeqCst();
+  if (!LoadRelaxed(&m_sleepers)) {
+    return;
+  }
+  MutexLocker locker(&m_mutex);
+  m_wake_condition.Signal();
+}
+
+/*
+ * Run the callbacks left once the workers have stopped. These may queue more
+ * callbacks, which end up in the injection queue.
+ */
+void WorkStealingPool::RunRemaining() {
+  while (true) {
+    Action action = NULL;
+    for (unsigned int i = 0; !action && i < m_workers.size(); i++) {
+      action = m_workers[i]->Take();
+    }
+    if (!action) {
+      action = PopInjected();
+    }
+    if (!action) {
+      return;
+    }
+    RunAction(action);
+  }
+}
+
+void WorkStealingPool::WorkerLoop(Worker *worker) {
+  while (true) {
+    Action action = FindWork(worker);
+    if (action) {
+      RunAction(action);
+    } else if (LoadAcquire(&m_shutdown)) {
+      return;
+    } else {
+      Sleep();
+    }
+  }
+}
+}  // namespace thread
+}  // namespace ola
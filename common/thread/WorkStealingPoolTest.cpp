@@ -0,0 +1,223 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingPoolTest.cpp
+ * Test fixture for the WorkStealingPool class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/WorkStealingPool.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::NewSingleCallback;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::thread::Thread;
+using ola::thread::WorkStealingPool;
+using std::vector;
+
+namespace {
+
+/*
+ * Queues callbacks from a thread outside the pool.
+ */
+class ProducerThread : public Thread {
+ public:
+  ProducerThread(WorkStealingPool *pool, ola::BaseCallback0<void> *(*factory)(),
+                 unsigned int count)
+      : Thread(Thread::Options("producer")),
+        m_pool(pool),
+        m_factory(factory),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      m_pool->Execute(m_factory());
+    }
+    return NULL;
+  }
+
+ private:
+  WorkStealingPool *m_pool;
+  ola::BaseCallback0<void> *(*m_factory)();
+  unsigned int m_count;
+};
+
+Mutex counter_mutex;
+unsigned int counter = 0;
+
+void IncrementCounter() {
+  MutexLocker locker(&counter_mutex);
+  counter++;
+}
+
+ola::BaseCallback0<void> *NewIncrement() {
+  return NewSingleCallback(&IncrementCounter);
+}
+
+/*
+ * Each callback queues two more until depth reaches 0.
+ */
+void FanOut(WorkStealingPool *pool, unsigned int depth) {
+  if (!depth) {
+    IncrementCounter();
+    return;
+  }
+  pool->Execute(NewSingleCallback(&FanOut, pool, depth - 1));
+  pool->Execute(NewSingleCallback(&FanOut, pool, depth - 1));
+}
+}  // namespace
+
+
+class WorkStealingPoolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(WorkStealingPoolTest);
+  CPPUNIT_TEST(testExecute);
+  CPPUNIT_TEST(testProducers);
+  CPPUNIT_TEST(testNestedExecute);
+  CPPUNIT_TEST(testOverflow);
+  CPPUNIT_TEST(testStop);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testExecute();
+    void testProducers();
+    void testNestedExecute();
+    void testOverflow();
+    void testStop();
+
+    void setUp() {
+      MutexLocker locker(&counter_mutex);
+      counter = 0;
+    }
+
+ private:
+    unsigned int Counter() {
+      MutexLocker locker(&counter_mutex);
+      return counter;
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WorkStealingPoolTest);
+
+
+/*
+ * Check callbacks queued from the main thread are run.
+ */
+void WorkStealingPoolTest::testExecute() {
+  WorkStealingPool pool(4);
+  OLA_ASSERT_EQ(4u, pool.ThreadCount());
+  OLA_ASSERT_TRUE(pool.Start());
+  OLA_ASSERT_FALSE(pool.Start());
+
+  for (unsigned int i = 0; i < 100; i++) {
+    pool.Execute(NewIncrement());
+  }
+  pool.DrainCallbacks();
+  OLA_ASSERT_EQ(100u, Counter());
+
+  // And again, once the workers have gone to sleep.
+  for (unsigned int i = 0; i < 100; i++) {
+    pool.Execute(NewIncrement());
+  }
+  pool.DrainCallbacks();
+  OLA_ASSERT_EQ(200u, Counter());
+  pool.Stop();
+}
+
+
+/*
+ * Check callbacks queued from several threads at once are run.
+ */
+void WorkStealingPoolTest::testProducers() {
+  WorkStealingPool pool(3);
+  OLA_ASSERT_TRUE(pool.Start());
+
+  vector<ProducerThread*> producers;
+  for (unsigned int i = 0; i < 4; i++) {
+    producers.push_back(new ProducerThread(&pool, &NewIncrement, 2000));
+    OLA_ASSERT_TRUE(producers.back()->Start());
+  }
+  for (unsigned int i = 0; i < producers.size(); i++) {
+    producers[i]->Join();
+    delete producers[i];
+  }
+  pool.DrainCallbacks();
+  OLA_ASSERT_EQ(8000u, Counter());
+}
+
+
+/*
+ * Check callbacks queued by the workers, which go on their own deques, are
+ * run.
+ */
+void WorkStealingPoolTest::testNestedExecute() {
+  WorkStealingPool pool(4);
+  OLA_ASSERT_TRUE(pool.Start());
+  pool.Execute(NewSingleCallback(&FanOut, &pool, 10u));
+  pool.DrainCallbacks();
+  OLA_ASSERT_EQ(1024u, Counter());
+}
+
+
+/*
+ * Check callbacks are run once the injection queue is full.
+ */
+void WorkStealingPoolTest::testOverflow() {
+  WorkStealingPool pool(2);
+  for (unsigned int i = 0; i < 10000; i++) {
+    pool.Execute(NewIncrement());
+  }
+  OLA_ASSERT_EQ(0u, Counter());
+  OLA_ASSERT_TRUE(pool.Start());
+  pool.DrainCallbacks();
+  OLA_ASSERT_EQ(10000u, Counter());
+}
+
+
+/*
+ * Check pending callbacks are run by Stop(), DrainCallbacks() and the
+ * destructor when there are no workers.
+ */
+void WorkStealingPoolTest::testStop() {
+  {
+    WorkStealingPool pool(2);
+    pool.Execute(NewIncrement());
+    pool.DrainCallbacks();
+    OLA_ASSERT_EQ(1u, Counter());
+
+    pool.Execute(NewIncrement());
+    pool.Stop();
+    OLA_ASSERT_EQ(2u, Counter());
+    OLA_ASSERT_FALSE(pool.Start());
+
+    pool.Execute(NewIncrement());
+  }
+  OLA_ASSERT_EQ(3u, Counter());
+
+  {
+    WorkStealingPool pool(2);
+    OLA_ASSERT_TRUE(pool.Start());
+    pool.Execute(NewSingleCallback(&FanOut, &pool, 6u));
+  }
+  OLA_ASSERT_EQ(67u, Counter());
+}
@@ -0,0 +1,148 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.cpp
+ * Recycles the memory used by callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include <new>
+
+#include "ola/CallbackAllocator.h"
+
+namespace ola {
+
+const size_t CallbackAllocator::MAX_SIZE;
+
+namespace {
+
+// Blocks are rounded up to a multiple of GRANULE bytes, so a size class
+// covers GRANULE different sizes.
+const size_t GRANULE = 16;
+const unsigned int CLASS_COUNT = CallbackAllocator::MAX_SIZE / GRANULE;
+// The maximum number of free blocks kept per size class, per thread.
+const unsigned int MAX_FREE_BLOCKS = 64;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct ThreadCache {
+  FreeBlock *blocks[CLASS_COUNT];
+  unsigned int counts[CLASS_COUNT];
+};
+
+bool caching_enabled = true;
+
+inline unsigned int SizeClass(size_t size) {
+  return static_cast<unsigned int>((size - 1) / GRANULE);
+}
+
+#ifdef __GNUC__
+__thread ThreadCache *thread_cache = NULL;
+pthread_key_t cache_key;
+pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Called when a thread exits.
+ */
+void FreeCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  for (unsigned int i = 0; i < CLASS_COUNT; i++) {
+    while (cache->blocks[i]) {
+      FreeBlock *block = cache->blocks[i];
+      cache->blocks[i] = block->next;
+      ::operator delete(block);
+    }
+  }
+  delete cache;
+  thread_cache = NULL;
+}
+
+void CreateKey() {
+  pthread_key_create(&cache_key, FreeCache);
+}
+
+ThreadCache *GetCache() {
+  if (!thread_cache) {
+    pthread_once(&cache_key_once, CreateKey);
+    thread_cache = new ThreadCache;
+    memset(thread_cache, 0, sizeof(*thread_cache));
+    pthread_setspecific(cache_key, thread_cache);
+  }
+  return thread_cache;
+}
+#else
+ThreadCache *GetCache() {
+  return NULL;
+}
+#endif  // __GNUC__
+}  // namespace
+
+void *CallbackAllocator::Allocate(size_t size) {
+  if (!size || size > MAX_SIZE) {
+    return ::operator new(size);
+  }
+
+  const unsigned int size_class = SizeClass(size);
+  ThreadCache *cache = caching_enabled ? GetCache() : NULL;
+  if (cache && cache->blocks[size_class]) {
+    FreeBlock *block = cache->blocks[size_class];
+    cache->blocks[size_class] = block->next;
+    cache->counts[size_class]--;
+    return block;
+  }
+  // Always allocate the whole class, so the block can be reused for any size
+  // in it.
+  return ::operator new((size_class + 1) * GRANULE);
+}
+
+void CallbackAllocator::Release(void *ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+  if (!size || size > MAX_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  const unsigned int size_class = SizeClass(size);
+  ThreadCache *cache = caching_enabled ? GetCache() : NULL;
+  if (!cache || cache->counts[size_class] >= MAX_FREE_BLOCKS) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeBlock *block = static_cast<FreeBlock*>(ptr);
+  block->next = cache->blocks[size_class];
+  cache->blocks[size_class] = block;
+  cache->counts[size_class]++;
+}
+
+void CallbackAllocator::SetCaching(bool enabled) {
+  caching_enabled = enabled;
+}
+
+unsigned int CallbackAllocator::FreeBlocks() {
+  ThreadCache *cache = GetCache();
+  unsigned int count = 0;
+  for (unsigned int i = 0; cache && i < CLASS_COUNT; i++) {
+    count += cache->counts[i];
+  }
+  return count;
+}
+}  // namespace ola
@@ -0,0 +1,197 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocatorTest.cpp
+ * Test fixture for the CallbackAllocator class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/CallbackAllocator.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::BaseCallback0;
+using ola::CallbackAllocator;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using std::string;
+
+namespace {
+
+unsigned int run_count = 0;
+
+void Increment() {
+  run_count++;
+}
+
+void AppendString(string *output, string value) {
+  output->append(value);
+}
+
+/*
+ * Runs callbacks created by another thread, and creates its own.
+ */
+class RunnerThread : public ola::thread::Thread {
+ public:
+  explicit RunnerThread(BaseCallback0<void> *callback)
+      : ola::thread::Thread(ola::thread::Thread::Options("runner")),
+        m_callback(callback) {
+  }
+
+  void *Run() {
+    m_callback->Run();
+    for (unsigned int i = 0; i < 100; i++) {
+      NewSingleCallback(&Increment)->Run();
+    }
+    return NULL;
+  }
+
+ private:
+  BaseCallback0<void> *m_callback;
+};
+}  // namespace
+
+
+class CallbackAllocatorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CallbackAllocatorTest);
+  CPPUNIT_TEST(testReuse);
+  CPPUNIT_TEST(testSizes);
+  CPPUNIT_TEST(testLimit);
+  CPPUNIT_TEST(testNoCaching);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testReuse();
+    void testSizes();
+    void testLimit();
+    void testNoCaching();
+    void testThreads();
+
+    void setUp() {
+      run_count = 0;
+      CallbackAllocator::SetCaching(true);
+    }
+
+    void tearDown() {
+      CallbackAllocator::SetCaching(true);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CallbackAllocatorTest);
+
+
+/*
+ * Check a freed callback's memory is used for the next one.
+ */
+void CallbackAllocatorTest::testReuse() {
+  BaseCallback0<void> *callback = NewSingleCallback(&Increment);
+  const void *first = callback;
+  const unsigned int free_blocks = CallbackAllocator::FreeBlocks();
+  callback->Run();
+  OLA_ASSERT_EQ(1u, run_count);
+  OLA_ASSERT_EQ(free_blocks + 1, CallbackAllocator::FreeBlocks());
+
+  callback = NewSingleCallback(&Increment);
+  OLA_ASSERT_EQ(first, static_cast<const void*>(callback));
+  OLA_ASSERT_EQ(free_blocks, CallbackAllocator::FreeBlocks());
+  callback->Run();
+  OLA_ASSERT_EQ(2u, run_count);
+
+  // Multi-use callbacks are recycled when they're deleted.
+  BaseCallback0<void> *repeated = NewCallback(&Increment);
+  OLA_ASSERT_EQ(first, static_cast<const void*>(repeated));
+  repeated->Run();
+  repeated->Run();
+  OLA_ASSERT_EQ(4u, run_count);
+  delete repeated;
+
+  // Callbacks with bound arguments that own memory.
+  string output;
+  NewSingleCallback(&AppendString, &output,
+                    string("a string long enough to be on the heap"))->Run();
+  OLA_ASSERT_EQ(string("a string long enough to be on the heap"), output);
+}
+
+
+/*
+ * Check all sizes return usable memory.
+ */
+void CallbackAllocatorTest::testSizes() {
+  const size_t max_size = CallbackAllocator::MAX_SIZE;
+  for (size_t size = 0; size <= max_size + 32; size++) {
+    void *ptr = CallbackAllocator::Allocate(size);
+    OLA_ASSERT_NOT_NULL(ptr);
+    memset(ptr, 0xaa, size);
+    CallbackAllocator::Release(ptr, size);
+  }
+  CallbackAllocator::Release(NULL, 8);
+
+  // A block is reused for any size in the same class.
+  void *ptr = CallbackAllocator::Allocate(17);
+  CallbackAllocator::Release(ptr, 17);
+  void *other = CallbackAllocator::Allocate(32);
+  OLA_ASSERT_EQ(ptr, other);
+  memset(other, 0, 32);
+  CallbackAllocator::Release(other, 32);
+}
+
+
+/*
+ * Check the number of free blocks is capped.
+ */
+void CallbackAllocatorTest::testLimit() {
+  const unsigned int count = 200;
+  void *blocks[count];
+  for (unsigned int i = 0; i < count; i++) {
+    blocks[i] = CallbackAllocator::Allocate(48);
+  }
+  const unsigned int free_blocks = CallbackAllocator::FreeBlocks();
+  for (unsigned int i = 0; i < count; i++) {
+    CallbackAllocator::Release(blocks[i], 48);
+  }
+  OLA_ASSERT_TRUE(CallbackAllocator::FreeBlocks() > free_blocks);
+  OLA_ASSERT_TRUE(CallbackAllocator::FreeBlocks() < free_blocks + count);
+}
+
+
+/*
+ * Check nothing is kept when caching is off.
+ */
+void CallbackAllocatorTest::testNoCaching() {
+  CallbackAllocator::SetCaching(false);
+  const unsigned int free_blocks = CallbackAllocator::FreeBlocks();
+  NewSingleCallback(&Increment)->Run();
+  OLA_ASSERT_EQ(1u, run_count);
+  OLA_ASSERT_EQ(free_blocks, CallbackAllocator::FreeBlocks());
+}
+
+
+/*
+ * Check callbacks can be created in one thread and run in another, and that
+ * the thread's free blocks are released when it exits.
+ */
+void CallbackAllocatorTest::testThreads() {
+  RunnerThread thread(NewSingleCallback(&Increment));
+  OLA_ASSERT_TRUE(thread.Start());
+  OLA_ASSERT_TRUE(thread.Join());
+  OLA_ASSERT_EQ(101u, run_count);
+}
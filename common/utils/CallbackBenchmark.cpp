@@ -0,0 +1,139 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackBenchmark.cpp
+ * Count the heap allocations made by the callbacks for each DMX frame.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/CallbackAllocator.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+
+using ola::CallbackAllocator;
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::SelectServer;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_s_uint32(frames, f, 100000, "The number of frames to run");
+
+// Counts every heap allocation made by the program.
+static unsigned int allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) {
+  free(ptr);
+}
+
+/*
+ * The callbacks created for a frame: the completion of a SendDMX() RPC, a
+ * task deferred with Execute() and a timeout.
+ */
+class FrameRunner {
+ public:
+  FrameRunner() : m_checksum(0) {
+    m_buffer.Blackout();
+  }
+
+  void RunFrame(unsigned int frame) {
+    m_ss.Execute(NewSingleCallback(this, &FrameRunner::SendDMXComplete,
+                                   frame, static_cast<const DmxBuffer*>(
+                                       &m_buffer)));
+    m_ss.Execute(NewSingleCallback(this, &FrameRunner::Deferred));
+    m_ss.RegisterSingleTimeout(
+        0, NewSingleCallback(this, &FrameRunner::Timeout, frame));
+    m_ss.RunOnce(TimeInterval(0, 0));
+  }
+
+  unsigned int Checksum() const { return m_checksum; }
+
+ private:
+  SelectServer m_ss;
+  DmxBuffer m_buffer;
+  unsigned int m_checksum;
+
+  void SendDMXComplete(unsigned int universe, const DmxBuffer *buffer) {
+    m_checksum += universe + buffer->Get(0);
+  }
+
+  void Deferred() {
+    m_checksum++;
+  }
+
+  void Timeout(unsigned int frame) {
+    m_checksum += frame;
+  }
+};
+
+void Run(const string &name, bool caching) {
+  CallbackAllocator::SetCaching(caching);
+  FrameRunner runner;
+  // Warm up the free lists and the SelectServer's containers.
+  for (unsigned int i = 0; i < 100; i++) {
+    runner.RunFrame(i);
+  }
+
+  Clock clock;
+  TimeStamp start, end;
+  const unsigned int start_allocations = allocations;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    runner.RunFrame(i);
+  }
+  clock.CurrentTime(&end);
+  const unsigned int frame_allocations = allocations - start_allocations;
+
+  const double frames = FLAGS_frames ? FLAGS_frames : 1;
+  cout << std::setw(16) << std::left << name << std::right << std::fixed
+       << std::setprecision(2) << std::setw(8)
+       << frame_allocations / frames << " allocations/frame, "
+       << std::setprecision(0) << std::setw(8)
+       << (end - start).AsInt() * 1000.0 / frames << " ns/frame" << endl;
+  if (!runner.Checksum()) {
+    cout << "Checksum was 0" << endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Count the heap allocations made by callbacks for each frame.");
+  Run("heap", false);
+  Run("free lists", true);
+  return 0;
+}
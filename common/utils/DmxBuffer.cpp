@@ -44,29 +44,77 @@ using std::max;
 using std::string;
 using std::vector;
 
+/*
+ * The slot data and reference count, allocated as a single block.
+ */
+struct DmxBuffer::Storage {
+  unsigned int ref_count;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+
+namespace {
+
+#ifdef __ATOMIC_ACQ_REL
+inline void IncrementRefCount(unsigned int *ref_count) {
+  __atomic_add_fetch(ref_count, 1, __ATOMIC_RELAXED);
+}
+
+inline unsigned int DecrementRefCount(unsigned int *ref_count) {
+  return __atomic_sub_fetch(ref_count, 1, __ATOMIC_ACQ_REL);
+}
+
+inline unsigned int LoadRefCount(const unsigned int *ref_count) {
+  return __atomic_load_n(ref_count, __ATOMIC_ACQUIRE);
+}
+#else
+inline void IncrementRefCount(unsigned int *ref_count) {
+  __sync_add_and_fetch(ref_count, 1);
+}
+
+inline unsigned int DecrementRefCount(unsigned int *ref_count) {
+  return __sync_sub_and_fetch(ref_count, 1);
+}
+
+inline unsigned int LoadRefCount(const unsigned int *ref_count) {
+  __sync_synchronize();
+  return *ref_count;
+}
+#endif  // __ATOMIC_ACQ_REL
+}  // namespace
+
+
 DmxBuffer::DmxBuffer()
-    : m_ref_count(NULL),
-      m_copy_on_write(false),
+    : m_storage(NULL),
       m_data(NULL),
       m_length(0) {
 }
 
 
 DmxBuffer::DmxBuffer(const DmxBuffer &other)
-    : m_ref_count(NULL),
-      m_copy_on_write(false),
+    : m_storage(NULL),
       m_data(NULL),
       m_length(0) {
-
-  if (other.m_data && other.m_ref_count) {
+  if (other.m_storage) {
     CopyFromOther(other);
   }
 }
 
 
+#if __cplusplus >= 201103L
+DmxBuffer::DmxBuffer(DmxBuffer &&other)
+    : m_storage(other.m_storage),
+      m_data(other.m_data),
+      m_length(other.m_length) {
+  other.m_storage = NULL;
+  other.m_data = NULL;
+  other.m_length = 0;
+}
+#endif  // __cplusplus >= 201103L
+
+
 DmxBuffer::DmxBuffer(const uint8_t *data, unsigned int length)
-    : m_ref_count(0),
-      m_copy_on_write(false),
+    : m_storage(NULL),
       m_data(NULL),
       m_length(0) {
   Set(data, length);
@@ -74,8 +122,7 @@ DmxBuffer::DmxBuffer(const uint8_t *data, unsigned int length)
 
 
 DmxBuffer::DmxBuffer(const string &data)
-    : m_ref_count(0),
-      m_copy_on_write(false),
+    : m_storage(NULL),
       m_data(NULL),
       m_length(0) {
     Set(data);
@@ -88,9 +135,16 @@ DmxBuffer::~DmxBuffer() {
 
 
 DmxBuffer& DmxBuffer::operator=(const DmxBuffer &other) {
-  if (this != &other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  if (m_storage == other.m_storage) {
+    // Already sharing the data, avoid the ref count round trip.
+    m_length = other.m_length;
+  } else {
     CleanupMemory();
-    if (other.m_data) {
+    if (other.m_storage) {
       CopyFromOther(other);
     }
   }
@@ -98,6 +152,29 @@ DmxBuffer& DmxBuffer::operator=(const DmxBuffer &other) {
 }
 
 
+#if __cplusplus >= 201103L
+DmxBuffer& DmxBuffer::operator=(DmxBuffer &&other) {
+  if (this != &other) {
+    CleanupMemory();
+    m_storage = other.m_storage;
+    m_data = other.m_data;
+    m_length = other.m_length;
+    other.m_storage = NULL;
+    other.m_data = NULL;
+    other.m_length = 0;
+  }
+  return *this;
+}
+#endif  // __cplusplus >= 201103L
+
+
+void DmxBuffer::Swap(DmxBuffer &other) {
+  std::swap(m_storage, other.m_storage);
+  std::swap(m_data, other.m_data);
+  std::swap(m_length, other.m_length);
+}
+
+
 bool DmxBuffer::operator==(const DmxBuffer &other) const {
   return (m_length == other.m_length &&
           (m_data == other.m_data ||
@@ -138,7 +215,7 @@ bool DmxBuffer::Set(const uint8_t *data, unsigned int length) {
   if (!data)
     return false;
 
-  if (m_copy_on_write)
+  if (IsShared())
     CleanupMemory();
   if (!m_data) {
     if (!Init())
@@ -165,7 +242,7 @@ bool DmxBuffer::SetFromString(const string &input) {
   vector<string> dmx_values;
   vector<string>::const_iterator iter;
 
-  if (m_copy_on_write)
+  if (IsShared())
     CleanupMemory();
   if (!m_data)
     if (!Init())
@@ -292,7 +369,7 @@ string DmxBuffer::Get() const {
 
 
 bool DmxBuffer::Blackout() {
-  if (m_copy_on_write) {
+  if (IsShared()) {
     CleanupMemory();
   }
   if (!m_data) {
@@ -335,31 +412,30 @@ string DmxBuffer::ToString() const {
  * @return true on success, otherwise raises an exception
  */
 bool DmxBuffer::Init() {
-  m_data = new uint8_t[DMX_UNIVERSE_SIZE];
-  m_ref_count = new unsigned int;
+  m_storage = new Storage;
+  m_storage->ref_count = 1;
+  m_data = m_storage->data;
   m_length = 0;
-  *m_ref_count = 1;
   return true;
 }
 
 
 /*
- * Called before making a change, this duplicates the data if required.
+ * Called before making a change, this duplicates the data if it's shared with
+ * another buffer.
  * @return true on Duplication, and false it duplication was not needed
  */
 bool DmxBuffer::DuplicateIfNeeded() {
-  if (m_copy_on_write && *m_ref_count == 1) {
-    m_copy_on_write = false;
-  }
-
-  if (m_copy_on_write && *m_ref_count > 1) {
-    unsigned int *old_ref_count = m_ref_count;
-    uint8_t *original_data = m_data;
+  if (IsShared()) {
+    Storage *original = m_storage;
     unsigned int length = m_length;
-    m_copy_on_write = false;
     if (Init()) {
-      Set(original_data, length);
-      (*old_ref_count)--;
+      memcpy(m_data, original->data, length);
+      m_length = length;
+      if (!DecrementRefCount(&original->ref_count)) {
+        // The other owners went away since we checked.
+        delete original;
+      }
       return true;
     }
     return false;
@@ -371,13 +447,11 @@ bool DmxBuffer::DuplicateIfNeeded() {
 /*
  * Setup this buffer to point to the data of the other buffer
  * @param other the source buffer
- * @pre other.m_data and other.m_ref_count are not NULL
+ * @pre other.m_storage is not NULL
  */
 void DmxBuffer::CopyFromOther(const DmxBuffer &other) {
-  m_copy_on_write = true;
-  other.m_copy_on_write = true;
-  m_ref_count = other.m_ref_count;
-  (*m_ref_count)++;
+  IncrementRefCount(&other.m_storage->ref_count);
+  m_storage = other.m_storage;
   m_data = other.m_data;
   m_length = other.m_length;
 }
@@ -387,18 +461,24 @@ void DmxBuffer::CopyFromOther(const DmxBuffer &other) {
  * Decrement the ref count by one and free the memory if required
  */
 void DmxBuffer::CleanupMemory() {
-  if (m_ref_count && m_data) {
-    (*m_ref_count)--;
-    if (!*m_ref_count) {
-      delete[] m_data;
-      delete m_ref_count;
+  if (m_storage) {
+    if (!DecrementRefCount(&m_storage->ref_count)) {
+      delete m_storage;
     }
+    m_storage = NULL;
     m_data = NULL;
-    m_ref_count = NULL;
     m_length = 0;
   }
 }
 
+
+/*
+ * Check if the data is shared with another DmxBuffer.
+ */
+bool DmxBuffer::IsShared() const {
+  return m_storage && LoadRefCount(&m_storage->ref_count) > 1;
+}
+
 std::ostream& operator<<(std::ostream &out, const DmxBuffer &data) {
   return out << data.ToString();
 }
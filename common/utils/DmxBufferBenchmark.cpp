@@ -0,0 +1,164 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxBufferBenchmark.cpp
+ * Measure the throughput of the common DmxBuffer operations.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::DmxBufferView;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::cout;
+using std::endl;
+
+DEFINE_s_uint32(iterations, i, 1000000, "The number of operations to run");
+
+// Stops the compiler from optimizing the loops away.
+unsigned int checksum = 0;
+
+/*
+ * Print the result of a run.
+ */
+void Report(const char *name, const TimeInterval &duration,
+            unsigned int iterations) {
+  double usec = static_cast<double>(duration.AsInt());
+  cout << std::setw(20) << std::left << name << " "
+       << std::setw(8) << std::right << std::fixed << std::setprecision(1)
+       << (usec * 1000.0 / iterations) << " ns/op, "
+       << std::setw(12) << (iterations * 1000000.0 / usec) << " ops/s"
+       << endl;
+}
+
+void RunCopy(const DmxBuffer &source, unsigned int iterations) {
+  for (unsigned int i = 0; i < iterations; i++) {
+    DmxBuffer copy(source);
+    checksum += copy.Get(i % ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+void RunView(const DmxBuffer &source, unsigned int iterations) {
+  for (unsigned int i = 0; i < iterations; i++) {
+    DmxBufferView view(source);
+    checksum += view.Get(i % ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+void RunCopyAndWrite(const DmxBuffer &source, unsigned int iterations) {
+  for (unsigned int i = 0; i < iterations; i++) {
+    DmxBuffer copy(source);
+    copy.SetChannel(i % ola::DMX_UNIVERSE_SIZE, 1);
+    checksum += copy.Get(0);
+  }
+}
+
+void RunSetRaw(const uint8_t *data, unsigned int iterations) {
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < iterations; i++) {
+    buffer.Set(data, ola::DMX_UNIVERSE_SIZE);
+    checksum += buffer.Get(i % ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+void RunSetBuffer(const DmxBuffer &source, unsigned int iterations) {
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < iterations; i++) {
+    buffer.Set(source);
+    checksum += buffer.Get(i % ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+void RunMerge(const DmxBuffer &source1, const DmxBuffer &source2,
+              unsigned int iterations) {
+  DmxBuffer buffer;
+  for (unsigned int i = 0; i < iterations; i++) {
+    buffer.Reset();
+    buffer.HTPMerge(source1);
+    buffer.HTPMerge(source2);
+    checksum += buffer.Get(i % ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark DmxBuffer copy, set and merge operations.");
+
+  const unsigned int iterations = FLAGS_iterations;
+  if (iterations == 0) {
+    cout << "Need at least 1 iteration" << endl;
+    return 1;
+  }
+
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    data[i] = rand() % 256;
+  }
+  DmxBuffer source1(data, ola::DMX_UNIVERSE_SIZE);
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    data[i] = rand() % 256;
+  }
+  DmxBuffer source2(data, ola::DMX_UNIVERSE_SIZE);
+
+  cout << iterations << " iterations of a " << ola::DMX_UNIVERSE_SIZE
+       << " slot universe" << endl;
+
+  Clock clock;
+  TimeStamp start, end;
+
+  clock.CurrentTime(&start);
+  RunCopy(source1, iterations);
+  clock.CurrentTime(&end);
+  Report("Copy", end - start, iterations);
+
+  clock.CurrentTime(&start);
+  RunView(source1, iterations);
+  clock.CurrentTime(&end);
+  Report("View", end - start, iterations);
+
+  clock.CurrentTime(&start);
+  RunCopyAndWrite(source1, iterations);
+  clock.CurrentTime(&end);
+  Report("Copy + write", end - start, iterations);
+
+  clock.CurrentTime(&start);
+  RunSetRaw(data, iterations);
+  clock.CurrentTime(&end);
+  Report("Set(uint8_t*)", end - start, iterations);
+
+  clock.CurrentTime(&start);
+  RunSetBuffer(source1, iterations);
+  clock.CurrentTime(&end);
+  Report("Set(DmxBuffer)", end - start, iterations);
+
+  clock.CurrentTime(&start);
+  RunMerge(source1, source2, iterations);
+  clock.CurrentTime(&end);
+  Report("HTPMerge x2", end - start, iterations);
+
+  cout << "checksum " << checksum << endl;
+  return 0;
+}
@@ -21,14 +21,18 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <string>
+#include <vector>
 
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
 
 using std::ostringstream;
 using std::string;
+using std::vector;
 using ola::DmxBuffer;
+using ola::DmxBufferView;
 
 class DmxBufferTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DmxBufferTest);
@@ -40,6 +44,9 @@ class DmxBufferTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testMerge);
   CPPUNIT_TEST(testStringToDmx);
   CPPUNIT_TEST(testCopyOnWrite);
+  CPPUNIT_TEST(testMoveAndSwap);
+  CPPUNIT_TEST(testView);
+  CPPUNIT_TEST(testSharingAcrossThreads);
   CPPUNIT_TEST(testSetRange);
   CPPUNIT_TEST(testSetRangeToValue);
   CPPUNIT_TEST(testSetChannel);
@@ -55,6 +62,9 @@ class DmxBufferTest: public CppUnit::TestFixture {
     void testMerge();
     void testStringToDmx();
     void testCopyOnWrite();
+    void testMoveAndSwap();
+    void testView();
+    void testSharingAcrossThreads();
     void testSetRange();
     void testSetRangeToValue();
     void testSetChannel();
@@ -79,6 +89,39 @@ const uint8_t DmxBufferTest::MERGE_RESULT2[] = {10, 11, 12, 6, 5, 4, 3, 2, 1};
 CPPUNIT_TEST_SUITE_REGISTRATION(DmxBufferTest);
 
 
+/*
+ * Repeatedly takes views of a shared buffer and checks the data is intact.
+ */
+class ViewReaderThread: public ola::thread::Thread {
+ public:
+    ViewReaderThread(const DmxBufferView &view, unsigned int iterations)
+        : Thread(),
+          m_view(view),
+          m_iterations(iterations),
+          m_ok(true) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 0; i < m_iterations; i++) {
+        DmxBufferView copy(m_view);
+        DmxBuffer buffer(copy.AsBuffer());
+        if (buffer.Size() != ola::DMX_UNIVERSE_SIZE ||
+            buffer.Get(i % ola::DMX_UNIVERSE_SIZE) != 42) {
+          m_ok = false;
+        }
+      }
+      return NULL;
+    }
+
+    bool Ok() const { return m_ok; }
+
+ private:
+    const DmxBufferView m_view;
+    const unsigned int m_iterations;
+    bool m_ok;
+};
+
+
 /*
  * Test that Blackout() works
  */
@@ -401,6 +444,137 @@ void DmxBufferTest::testCopyOnWrite() {
 }
 
 
+/*
+ * Check that moving and swapping hand over the data without copying it.
+ */
+void DmxBufferTest::testMoveAndSwap() {
+  DmxBuffer buffer1(TEST_DATA, sizeof(TEST_DATA));
+  DmxBuffer buffer2(TEST_DATA2, sizeof(TEST_DATA2));
+  const uint8_t *data1 = buffer1.GetRaw();
+  const uint8_t *data2 = buffer2.GetRaw();
+
+  buffer1.Swap(buffer2);
+  OLA_ASSERT_EQ(data2, buffer1.GetRaw());
+  OLA_ASSERT_EQ(data1, buffer2.GetRaw());
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA2, sizeof(TEST_DATA2), buffer1.GetRaw(),
+                         buffer1.Size());
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA, sizeof(TEST_DATA), buffer2.GetRaw(),
+                         buffer2.Size());
+
+  // swapping with an empty buffer
+  DmxBuffer empty;
+  empty.Swap(buffer1);
+  OLA_ASSERT_EQ(0u, buffer1.Size());
+  OLA_ASSERT_NULL(buffer1.GetRaw());
+  OLA_ASSERT_EQ(data2, empty.GetRaw());
+
+#if __cplusplus >= 201103L
+  DmxBuffer moved(std::move(buffer2));
+  OLA_ASSERT_EQ(data1, moved.GetRaw());
+  OLA_ASSERT_EQ(0u, buffer2.Size());
+  OLA_ASSERT_NULL(buffer2.GetRaw());
+
+  DmxBuffer assigned;
+  assigned = std::move(moved);
+  OLA_ASSERT_EQ(data1, assigned.GetRaw());
+  OLA_ASSERT_EQ(static_cast<unsigned int>(sizeof(TEST_DATA)),
+                assigned.Size());
+  OLA_ASSERT_NULL(moved.GetRaw());
+
+  // a moved from buffer can be used again
+  OLA_ASSERT_TRUE(moved.Set(TEST_DATA3, sizeof(TEST_DATA3)));
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA3, sizeof(TEST_DATA3), moved.GetRaw(),
+                         moved.Size());
+#endif  // __cplusplus >= 201103L
+}
+
+
+/*
+ * Check that a view shares the data, and isn't affected by later changes to
+ * the buffer.
+ */
+void DmxBufferTest::testView() {
+  DmxBufferView empty_view;
+  OLA_ASSERT_EQ(0u, empty_view.Size());
+  OLA_ASSERT_NULL(empty_view.GetRaw());
+  OLA_ASSERT_EQ((uint8_t) 0, empty_view.Get(0));
+
+  DmxBuffer buffer(TEST_DATA2, sizeof(TEST_DATA2));
+  DmxBufferView view(buffer);
+  OLA_ASSERT_EQ(buffer.GetRaw(), view.GetRaw());
+  OLA_ASSERT_EQ((unsigned int) sizeof(TEST_DATA2), view.Size());
+  OLA_ASSERT_EQ((uint8_t) 9, view.Get(0));
+  OLA_ASSERT_EQ(string("9,8,7,6,5,4,3,2,1"), view.ToString());
+  OLA_ASSERT_DMX_EQUALS(buffer, view.AsBuffer());
+
+  DmxBufferView view_copy(view);
+  OLA_ASSERT_EQ(view.GetRaw(), view_copy.GetRaw());
+  OLA_ASSERT_TRUE(view == view_copy);
+
+  // modifying the buffer leaves the views alone
+  buffer.SetChannel(0, 100);
+  OLA_ASSERT_NE(buffer.GetRaw(), view.GetRaw());
+  OLA_ASSERT_EQ((uint8_t) 100, buffer.Get(0));
+  OLA_ASSERT_EQ((uint8_t) 9, view.Get(0));
+  OLA_ASSERT_EQ((uint8_t) 9, view_copy.Get(0));
+  OLA_ASSERT_TRUE(view != DmxBufferView(buffer));
+
+  buffer.Set(TEST_DATA3, sizeof(TEST_DATA3));
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA2, sizeof(TEST_DATA2), view.GetRaw(),
+                         view.Size());
+
+  // the view keeps the data alive after the buffer is destroyed
+  DmxBufferView *scoped_view;
+  {
+    DmxBuffer scoped_buffer(TEST_DATA, sizeof(TEST_DATA));
+    scoped_view = new DmxBufferView(scoped_buffer);
+  }
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA, sizeof(TEST_DATA), scoped_view->GetRaw(),
+                         scoped_view->Size());
+  delete scoped_view;
+
+  // A buffer created from a view is copy-on-write
+  DmxBuffer from_view(view.AsBuffer());
+  OLA_ASSERT_EQ(view.GetRaw(), from_view.GetRaw());
+  from_view.SetChannel(1, 200);
+  OLA_ASSERT_EQ((uint8_t) 200, from_view.Get(1));
+  OLA_ASSERT_EQ((uint8_t) 8, view.Get(1));
+}
+
+
+/*
+ * Check that buffers sharing data can be used from different threads.
+ */
+void DmxBufferTest::testSharingAcrossThreads() {
+  const unsigned int iterations = 20000;
+  DmxBuffer original;
+  original.SetRangeToValue(0, 42, ola::DMX_UNIVERSE_SIZE);
+  DmxBufferView view(original);
+
+  vector<ViewReaderThread*> threads;
+  for (unsigned int i = 0; i < 4; i++) {
+    threads.push_back(new ViewReaderThread(view, iterations));
+    OLA_ASSERT_TRUE(threads.back()->Start());
+  }
+
+  // Meanwhile, keep taking copies and modifying them.
+  for (unsigned int i = 0; i < iterations; i++) {
+    DmxBuffer copy(original);
+    copy.SetChannel(i % ola::DMX_UNIVERSE_SIZE, 1);
+    original = view.AsBuffer();
+  }
+
+  vector<ViewReaderThread*>::iterator iter = threads.begin();
+  for (; iter != threads.end(); ++iter) {
+    OLA_ASSERT_TRUE((*iter)->Join());
+    OLA_ASSERT_TRUE((*iter)->Ok());
+    delete *iter;
+  }
+  OLA_ASSERT_EQ(view.GetRaw(), original.GetRaw());
+  OLA_ASSERT_EQ((uint8_t) 42, original.Get(0));
+}
+
+
 /*
  * Check that SetRange works.
  */
@@ -0,0 +1,100 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LatencyHistogram.cpp
+ * A histogram of latencies.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+
+#include "ola/util/LatencyHistogram.h"
+
+namespace ola {
+
+LatencyHistogram::LatencyHistogram() {
+  Reset();
+}
+
+void LatencyHistogram::Record(uint64_t usec) {
+  m_buckets[BucketFor(usec)]++;
+  m_count++;
+  if (usec > m_max) {
+    m_max = usec;
+  }
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  if (!m_count) {
+    return 0;
+  }
+
+  uint64_t target = static_cast<uint64_t>(percentile * m_count / 100.0);
+  if (target < m_count && target * 100.0 < percentile * m_count) {
+    target++;  // round up
+  }
+  if (target == 0) {
+    target = 1;
+  }
+
+  uint64_t seen = 0;
+  for (unsigned int i = 0; i < BUCKET_COUNT; i++) {
+    seen += m_buckets[i];
+    if (seen >= target) {
+      uint64_t limit = BucketLimit(i);
+      return limit < m_max ? limit : m_max;
+    }
+  }
+  return m_max;
+}
+
+void LatencyHistogram::Reset() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = 0;
+  m_max = 0;
+}
+
+unsigned int LatencyHistogram::BucketFor(uint64_t usec) {
+  if (usec < LINEAR_LIMIT) {
+    return static_cast<unsigned int>(usec);
+  }
+
+  const uint64_t max_value = (static_cast<uint64_t>(1) << MAX_BITS) - 1;
+  if (usec > max_value) {
+    usec = max_value;
+  }
+  // The index of the highest set bit, at least SUB_BUCKET_BITS + 1.
+  unsigned int msb = 63 - __builtin_clzll(usec);
+  unsigned int shift = msb - SUB_BUCKET_BITS;
+  unsigned int sub_bucket = static_cast<unsigned int>(
+      (usec >> shift) & (SUB_BUCKETS - 1));
+  return LINEAR_LIMIT + (msb - SUB_BUCKET_BITS - 1) * SUB_BUCKETS +
+         sub_bucket;
+}
+
+/*
+ * The largest value that goes in a bucket.
+ */
+uint64_t LatencyHistogram::BucketLimit(unsigned int bucket) {
+  if (bucket < LINEAR_LIMIT) {
+    return bucket;
+  }
+  unsigned int msb = (bucket - LINEAR_LIMIT) / SUB_BUCKETS +
+                     SUB_BUCKET_BITS + 1;
+  unsigned int shift = msb - SUB_BUCKET_BITS;
+  uint64_t sub_bucket = (bucket - LINEAR_LIMIT) % SUB_BUCKETS;
+  return ((SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+}  // namespace ola
@@ -0,0 +1,99 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LatencyHistogramTest.cpp
+ * Test fixture for the LatencyHistogram class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include "ola/util/LatencyHistogram.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::LatencyHistogram;
+
+class LatencyHistogramTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(LatencyHistogramTest);
+  CPPUNIT_TEST(testHistogram);
+  CPPUNIT_TEST(testHistogramAccuracy);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testHistogram();
+  void testHistogramAccuracy();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LatencyHistogramTest);
+
+
+/*
+ * Check the basic histogram operations.
+ */
+void LatencyHistogramTest::testHistogram() {
+  LatencyHistogram histogram;
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Max());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Percentile(50));
+
+  // Small values are exact.
+  for (uint64_t i = 0; i < 10; i++) {
+    histogram.Record(i);
+  }
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), histogram.Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(9), histogram.Max());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), histogram.Percentile(50));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(9), histogram.Percentile(99));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(9), histogram.Percentile(100));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Percentile(0));
+
+  // Percentiles never exceed the max.
+  histogram.Reset();
+  histogram.Record(1000);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1000), histogram.Percentile(50));
+
+  // Very large values are capped, but the max is kept.
+  const uint64_t huge = static_cast<uint64_t>(1) << 50;
+  histogram.Record(huge);
+  OLA_ASSERT_EQ(huge, histogram.Max());
+  OLA_ASSERT_TRUE(histogram.Percentile(100) < huge);
+
+  histogram.Reset();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), histogram.Max());
+}
+
+
+/*
+ * Check the percentiles are within the bucket resolution.
+ */
+void LatencyHistogramTest::testHistogramAccuracy() {
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 100000; i++) {
+    histogram.Record(i);
+  }
+
+  const double percentiles[] = {1, 10, 50, 90, 99, 99.9};
+  for (unsigned int i = 0; i < sizeof(percentiles) / sizeof(double); i++) {
+    double expected = percentiles[i] * 1000;
+    double actual = static_cast<double>(
+        histogram.Percentile(percentiles[i]));
+    OLA_ASSERT_TRUE(actual >= expected);
+    OLA_ASSERT_TRUE(actual <= expected * 1.125);
+  }
+  OLA_ASSERT_EQ(static_cast<uint64_t>(100000), histogram.Percentile(100));
+}
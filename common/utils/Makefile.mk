@@ -2,12 +2,25 @@
 ################################################
 common_libolacommon_la_SOURCES += \
     common/utils/ActionQueue.cpp \
+    common/utils/CallbackAllocator.cpp \
     common/utils/Clock.cpp \
     common/utils/DmxBuffer.cpp \
+    common/utils/LatencyHistogram.cpp \
     common/utils/StringUtils.cpp \
     common/utils/TokenBucket.cpp \
     common/utils/Watchdog.cpp
 
+# PROGRAMS
+################################################
+noinst_PROGRAMS += common/utils/callback_benchmark \
+                   common/utils/dmx_buffer_benchmark
+
+common_utils_callback_benchmark_SOURCES = common/utils/CallbackBenchmark.cpp
+common_utils_callback_benchmark_LDADD = common/libolacommon.la
+
+common_utils_dmx_buffer_benchmark_SOURCES = common/utils/DmxBufferBenchmark.cpp
+common_utils_dmx_buffer_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ################################################
 test_programs += common/utils/UtilsTester
@@ -15,9 +28,11 @@ test_programs += common/utils/UtilsTester
 common_utils_UtilsTester_SOURCES = \
     common/utils/ActionQueueTest.cpp \
     common/utils/BackoffTest.cpp \
+    common/utils/CallbackAllocatorTest.cpp \
     common/utils/CallbackTest.cpp \
     common/utils/ClockTest.cpp \
     common/utils/DmxBufferTest.cpp \
+    common/utils/LatencyHistogramTest.cpp \
     common/utils/MultiCallbackTest.cpp \
     common/utils/StringUtilsTest.cpp \
     common/utils/TokenBucketTest.cpp \
@@ -102,11 +102,14 @@ examples_ola_dmxmonitor_LDADD = $(EXAMPLE_COMMON_LIBS) -lncurses
 endif
 endif
 
-noinst_PROGRAMS += examples/ola_throughput examples/ola_latency
+noinst_PROGRAMS += examples/ola_throughput examples/ola_latency \
+                   examples/ola_loopback_latency
 examples_ola_throughput_SOURCES = examples/ola-throughput.cpp
 examples_ola_throughput_LDADD = $(EXAMPLE_COMMON_LIBS)
 examples_ola_latency_SOURCES = examples/ola-latency.cpp
 examples_ola_latency_LDADD = $(EXAMPLE_COMMON_LIBS)
+examples_ola_loopback_latency_SOURCES = examples/ola-loopback-latency.cpp
+examples_ola_loopback_latency_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 if USING_WIN32
 # rename this program, otherwise UAC will block it
@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ola-loopback-latency.cpp
+ * Send numbered frames to one universe, receive them on another and report
+ * the latency.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+#include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/client/OlaClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/thread/SignalThread.h>
+#include <ola/util/LatencyHistogram.h>
+
+#include <iostream>
+#include <map>
+
+using ola::DmxBuffer;
+using ola::LatencyHistogram;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::DMXMetadata;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::SendDMXArgs;
+using std::cout;
+using std::endl;
+using std::map;
+
+DEFINE_s_uint32(universe, u, 1, "The universe to send frames to.");
+DEFINE_s_uint32(receive_universe, r, 0,
+                "The universe to receive frames on, defaults to --universe.");
+DEFINE_s_uint32(count, c, 1000, "The number of frames to send.");
+DEFINE_s_uint32(rate, f, 40, "The number of frames to send per second.");
+DEFINE_uint16(size, ola::DMX_UNIVERSE_SIZE, "The number of slots per frame.");
+
+/*
+ * Each frame carries a sequence number in the first four slots. The
+ * receive universe should be patched so that frames sent to the send
+ * universe come back on it, e.g. an output port looped to an input port.
+ */
+class LoopbackTester {
+ public:
+  LoopbackTester()
+      : m_receive_universe(FLAGS_receive_universe ?
+                           FLAGS_receive_universe : FLAGS_universe),
+        m_sent(0),
+        m_unknown(0) {
+  }
+
+  bool Setup();
+  void Run();
+  void PrintReport() const;
+
+ private:
+  enum { SEQUENCE_SLOTS = 4 };
+
+  typedef map<uint32_t, TimeStamp> PendingMap;
+
+  const unsigned int m_receive_universe;
+  OlaClientWrapper m_wrapper;
+  ola::thread::SignalThread m_signal_thread;
+  ola::Clock m_clock;
+  DmxBuffer m_buffer;
+  // The frames we're waiting for, by sequence number.
+  PendingMap m_pending;
+  LatencyHistogram m_latency;
+  uint32_t m_sent;
+  uint64_t m_unknown;
+
+  bool SendFrame();
+  void NewDmx(const DMXMetadata &metadata, const DmxBuffer &data);
+  void RegisterComplete(const Result &result);
+  void StartSignalThread();
+};
+
+
+bool LoopbackTester::Setup() {
+  if (!m_wrapper.Setup()) {
+    return false;
+  }
+
+  m_buffer.SetRangeToValue(0, 0, FLAGS_size);
+
+  ola::client::OlaClient *client = m_wrapper.GetClient();
+  client->SetDMXCallback(NewCallback(this, &LoopbackTester::NewDmx));
+  client->RegisterUniverse(
+      m_receive_universe, ola::client::REGISTER,
+      NewSingleCallback(this, &LoopbackTester::RegisterComplete));
+
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  m_signal_thread.InstallSignalHandler(
+      SIGINT, NewCallback(ss, &ola::io::SelectServer::Terminate));
+  m_signal_thread.InstallSignalHandler(
+      SIGTERM, NewCallback(ss, &ola::io::SelectServer::Terminate));
+  return true;
+}
+
+
+void LoopbackTester::Run() {
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  ss->Execute(NewSingleCallback(this, &LoopbackTester::StartSignalThread));
+  ss->Run();
+}
+
+
+void LoopbackTester::PrintReport() const {
+  cout << "--------------" << endl;
+  cout << "Sent " << m_sent << " frames to universe " << FLAGS_universe
+       << ", received " << m_latency.Count() << " on universe "
+       << m_receive_universe << endl;
+  cout << "Lost " << m_pending.size() << ", unknown " << m_unknown << endl;
+  if (m_latency.Count()) {
+    cout << "p50 " << m_latency.Percentile(50) << "us, p99 "
+         << m_latency.Percentile(99) << "us, p99.9 "
+         << m_latency.Percentile(99.9) << "us, max " << m_latency.Max()
+         << "us" << endl;
+  }
+}
+
+
+/*
+ * Send the next frame, once they've all been sent give the last frames a
+ * second to arrive.
+ */
+bool LoopbackTester::SendFrame() {
+  if (m_sent == FLAGS_count) {
+    m_wrapper.GetSelectServer()->RegisterSingleTimeout(
+        1000,
+        NewSingleCallback(m_wrapper.GetSelectServer(),
+                          &ola::io::SelectServer::Terminate));
+    return false;
+  }
+
+  const uint32_t sequence = ++m_sent;
+  for (unsigned int i = 0; i < SEQUENCE_SLOTS; i++) {
+    m_buffer.SetChannel(i, static_cast<uint8_t>(
+        sequence >> (8 * (SEQUENCE_SLOTS - 1 - i))));
+  }
+  m_clock.CurrentTime(&m_pending[sequence]);
+  m_wrapper.GetClient()->SendDMX(FLAGS_universe, m_buffer, SendDMXArgs());
+  return true;
+}
+
+
+void LoopbackTester::NewDmx(const DMXMetadata &metadata,
+                            const DmxBuffer &data) {
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  if (metadata.universe != m_receive_universe ||
+      data.Size() < SEQUENCE_SLOTS) {
+    return;
+  }
+
+  uint32_t sequence = 0;
+  for (unsigned int i = 0; i < SEQUENCE_SLOTS; i++) {
+    sequence = (sequence << 8) | data.Get(i);
+  }
+
+  // Inputs may repeat the last frame, only the first copy is counted.
+  PendingMap::iterator iter = m_pending.find(sequence);
+  if (iter == m_pending.end()) {
+    m_unknown++;
+    return;
+  }
+  const TimeInterval latency = now - iter->second;
+  m_latency.Record(latency.AsInt() > 0 ? latency.AsInt() : 0);
+  OLA_DEBUG << "Frame " << sequence << " took " << latency;
+  m_pending.erase(iter);
+}
+
+
+void LoopbackTester::RegisterComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to register universe: " << result.Error();
+    m_wrapper.GetSelectServer()->Terminate();
+    return;
+  }
+
+  const unsigned int rate = FLAGS_rate ? FLAGS_rate : 1;
+  m_wrapper.GetSelectServer()->RegisterRepeatingTimeout(
+      TimeInterval(0, 1000000 / rate),
+      NewCallback(this, &LoopbackTester::SendFrame));
+}
+
+
+void LoopbackTester::StartSignalThread() {
+  if (!m_signal_thread.Start()) {
+    m_wrapper.GetSelectServer()->Terminate();
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Send numbered frames to a universe, receive them on another "
+               "universe that's looped back to it, and report the latency.");
+
+  if (FLAGS_size < 4 || FLAGS_size > ola::DMX_UNIVERSE_SIZE) {
+    OLA_FATAL << "--size must be between 4 and " << ola::DMX_UNIVERSE_SIZE;
+    exit(ola::EXIT_USAGE);
+  }
+
+  LoopbackTester tester;
+  if (!tester.Setup()) {
+    OLA_FATAL << "Setup failed";
+    exit(ola::EXIT_UNAVAILABLE);
+  }
+
+  tester.Run();
+  tester.PrintReport();
+  return ola::EXIT_OK;
+}
@@ -16,6 +16,10 @@
  * ola-throughput.cpp
  * Send a bunch of frames quickly to load test the server.
  * Copyright (C) 2005 Simon Newton
+ *
+ * With --frames, a fixed number of frames are sent as fast as possible, first
+ * with one RPC per universe and then with a single batched RPC per frame, and
+ * the rate of each is printed.
  */
 
 #include <errno.h>
@@ -23,21 +27,82 @@
 #include <unistd.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
-#include <ola/StreamingClient.h>
 #include <ola/StringUtils.h>
+#include <ola/client/StreamingClient.h>
 
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using std::cout;
 using std::endl;
 using std::string;
-using ola::StreamingClient;
+using std::vector;
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::StreamingClient;
 
-DEFINE_s_uint32(universe, u, 1, "The universe to send data on");
+DEFINE_s_uint32(universe, u, 1, "The first universe to send data on");
+DEFINE_s_uint32(universes, n, 1, "The number of universes to send data on");
 DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
+DEFINE_s_default_bool(batch, b, false,
+                      "Send all universes in a single batched RPC");
+DEFINE_s_uint32(frames, f, 0,
+                "If non-0, send this many frames as fast as possible using "
+                "both methods and report the frame rate");
+DEFINE_default_bool(shared_memory, false,
+                    "Send the DMX data to olad using shared memory");
+
+/*
+ * Send a frame, which is one update for every universe.
+ */
+bool SendFrame(StreamingClient *client,
+               const vector<StreamingClient::UniverseData> &universes,
+               bool batch) {
+  if (batch) {
+    return client->SendDMXBatch(universes);
+  }
+
+  vector<StreamingClient::UniverseData>::const_iterator iter =
+      universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    if (!client->SendDmx(iter->universe, iter->data)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Send a number of frames as fast as we can and print the rate.
+ */
+bool MeasureFrames(StreamingClient *client,
+                   const vector<StreamingClient::UniverseData> &universes,
+                   bool batch) {
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    if (!SendFrame(client, universes, batch)) {
+      return false;
+    }
+  }
+  clock.CurrentTime(&end);
+
+  double usec = static_cast<double>((end - start).AsInt());
+  cout << std::setw(12) << std::left << (batch ? "Batched" : "Per universe")
+       << " " << std::fixed << std::setprecision(1)
+       << (FLAGS_frames * 1000000.0 / usec) << " frames/s, "
+       << (FLAGS_frames * universes.size() * 1000000.0 / usec)
+       << " universes/s" << endl;
+  return true;
+}
 
 /*
  * Main
@@ -45,18 +110,43 @@ DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[options]", "Send DMX512 data to OLA.");
 
-  StreamingClient ola_client;
+  if (FLAGS_universes == 0) {
+    cout << "--universes must be at least 1" << endl;
+    exit(1);
+  }
+
+  StreamingClient::Options options;
+  options.use_shared_memory = FLAGS_shared_memory;
+  options.shared_memory_universes = FLAGS_universes;
+  StreamingClient ola_client(options);
   if (!ola_client.Setup()) {
     OLA_FATAL << "Setup failed";
     exit(1);
   }
 
-  ola::DmxBuffer buffer;
+  DmxBuffer buffer;
   buffer.Blackout();
 
+  vector<StreamingClient::UniverseData> universes;
+  for (unsigned int i = 0; i < FLAGS_universes; i++) {
+    universes.push_back(
+        StreamingClient::UniverseData(FLAGS_universe + i, buffer));
+  }
+
+  if (FLAGS_frames) {
+    cout << "Sending " << FLAGS_frames << " frames of " << FLAGS_universes
+         << " universes" << endl;
+    if (!MeasureFrames(&ola_client, universes, false) ||
+        !MeasureFrames(&ola_client, universes, true)) {
+      cout << "Send DMX failed" << endl;
+      exit(1);
+    }
+    return 0;
+  }
+
   while (1) {
     usleep(FLAGS_sleep);
-    if (!ola_client.SendDmx(FLAGS_universe, buffer)) {
+    if (!SendFrame(&ola_client, universes, FLAGS_batch)) {
       cout << "Send DMX failed" << endl;
       exit(1);
     }
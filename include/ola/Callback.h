@@ -39,6 +39,9 @@
  * Avoid creating Callbacks by directly calling the constructor. Instead use
  * the NewSingleCallback() and NewCallback() helper methods.
  *
+ * Callbacks are allocated from per-thread free lists, so creating and
+ * deleting them doesn't normally touch the heap. See CallbackAllocator.
+ *
  * @examplepara Simple function pointer replacement.
  *   @code
  *   // wrap a function that takes no args and returns a bool
@@ -105,6 +108,9 @@
 #ifndef INCLUDE_OLA_CALLBACK_H_
 #define INCLUDE_OLA_CALLBACK_H_
 
+#include <stddef.h>
+#include <ola/CallbackAllocator.h>
+
 namespace ola {
 
 /**
@@ -129,6 +135,12 @@ template <typename ReturnType>
 class Callback0: public BaseCallback0<ReturnType> {
  public:
   virtual ~Callback0() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run() { return this->DoRun(); }
  private:
   virtual ReturnType DoRun() = 0;
@@ -141,6 +153,12 @@ template <typename ReturnType>
 class SingleUseCallback0: public BaseCallback0<ReturnType> {
  public:
   virtual ~SingleUseCallback0() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run() {
     ReturnType ret = this->DoRun();
     delete this;
@@ -157,6 +175,12 @@ template <>
 class SingleUseCallback0<void>: public BaseCallback0<void> {
  public:
   virtual ~SingleUseCallback0() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   void Run() {
     this->DoRun();
     delete this;
@@ -992,6 +1016,12 @@ template <typename ReturnType, typename Arg0>
 class Callback1: public BaseCallback1<ReturnType, Arg0> {
  public:
   virtual ~Callback1() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0) { return this->DoRun(arg0); }
  private:
   virtual ReturnType DoRun(Arg0 arg0) = 0;
@@ -1004,6 +1034,12 @@ template <typename ReturnType, typename Arg0>
 class SingleUseCallback1: public BaseCallback1<ReturnType, Arg0> {
  public:
   virtual ~SingleUseCallback1() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0) {
     ReturnType ret = this->DoRun(arg0);
     delete this;
@@ -1020,6 +1056,12 @@ template <typename Arg0>
 class SingleUseCallback1<void, Arg0>: public BaseCallback1<void, Arg0> {
  public:
   virtual ~SingleUseCallback1() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   void Run(Arg0 arg0) {
     this->DoRun(arg0);
     delete this;
@@ -1895,6 +1937,12 @@ template <typename ReturnType, typename Arg0, typename Arg1>
 class Callback2: public BaseCallback2<ReturnType, Arg0, Arg1> {
  public:
   virtual ~Callback2() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1) { return this->DoRun(arg0, arg1); }
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1) = 0;
@@ -1907,6 +1955,12 @@ template <typename ReturnType, typename Arg0, typename Arg1>
 class SingleUseCallback2: public BaseCallback2<ReturnType, Arg0, Arg1> {
  public:
   virtual ~SingleUseCallback2() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1) {
     ReturnType ret = this->DoRun(arg0, arg1);
     delete this;
@@ -1923,6 +1977,12 @@ template <typename Arg0, typename Arg1>
 class SingleUseCallback2<void, Arg0, Arg1>: public BaseCallback2<void, Arg0, Arg1> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback2() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1) {
     this->DoRun(arg0, arg1);
     delete this;
@@ -2838,6 +2898,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2>
 class Callback3: public BaseCallback3<ReturnType, Arg0, Arg1, Arg2> {
  public:
   virtual ~Callback3() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) { return this->DoRun(arg0, arg1, arg2); }  // NOLINT(whitespace/line_length)
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2) = 0;
@@ -2850,6 +2916,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2>
 class SingleUseCallback3: public BaseCallback3<ReturnType, Arg0, Arg1, Arg2> {
  public:
   virtual ~SingleUseCallback3() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) {
     ReturnType ret = this->DoRun(arg0, arg1, arg2);
     delete this;
@@ -2866,6 +2938,12 @@ template <typename Arg0, typename Arg1, typename Arg2>
 class SingleUseCallback3<void, Arg0, Arg1, Arg2>: public BaseCallback3<void, Arg0, Arg1, Arg2> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback3() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1, Arg2 arg2) {
     this->DoRun(arg0, arg1, arg2);
     delete this;
@@ -3821,6 +3899,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2, type
 class Callback4: public BaseCallback4<ReturnType, Arg0, Arg1, Arg2, Arg3> {
  public:
   virtual ~Callback4() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) { return this->DoRun(arg0, arg1, arg2, arg3); }  // NOLINT(whitespace/line_length)
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) = 0;
@@ -3833,6 +3917,12 @@ template <typename ReturnType, typename Arg0, typename Arg1, typename Arg2, type
 class SingleUseCallback4: public BaseCallback4<ReturnType, Arg0, Arg1, Arg2, Arg3> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback4() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   ReturnType Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) {
     ReturnType ret = this->DoRun(arg0, arg1, arg2, arg3);
     delete this;
@@ -3849,6 +3939,12 @@ template <typename Arg0, typename Arg1, typename Arg2, typename Arg3>
 class SingleUseCallback4<void, Arg0, Arg1, Arg2, Arg3>: public BaseCallback4<void, Arg0, Arg1, Arg2, Arg3> {  // NOLINT(whitespace/line_length)
  public:
   virtual ~SingleUseCallback4() {}
+  static void *operator new(size_t size) {
+    return CallbackAllocator::Allocate(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    CallbackAllocator::Release(ptr, size);
+  }
   void Run(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) {
     this->DoRun(arg0, arg1, arg2, arg3);
     delete this;
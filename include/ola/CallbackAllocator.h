@@ -0,0 +1,98 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackAllocator.h
+ * Recycles the memory used by callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @addtogroup callbacks
+ * @{
+ * @file CallbackAllocator.h
+ * @brief Recycles the memory used by callbacks.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_CALLBACKALLOCATOR_H_
+#define INCLUDE_OLA_CALLBACKALLOCATOR_H_
+
+#include <stddef.h>
+
+namespace ola {
+
+/**
+ * @addtogroup callbacks
+ * @{
+ */
+
+/**
+ * @brief Provides the memory for the objects returned by NewCallback() and
+ * NewSingleCallback().
+ *
+ * Most callbacks are small and short lived, e.g. a SingleUseCallback that's
+ * created to handle an RPC response. Rather than returning the memory to the
+ * heap when a callback is deleted, each thread keeps a list of free blocks
+ * for each size, and new callbacks are created from these. In the steady
+ * state, creating and running a callback doesn't touch the heap.
+ *
+ * A block freed in a different thread to the one that allocated it is kept
+ * by the thread that freed it. Each list is capped, and the lists are freed
+ * when the thread exits.
+ */
+class CallbackAllocator {
+ public:
+  /**
+   * @brief Allocate memory for a callback.
+   * @param size the size of the callback.
+   * @returns the memory, this never returns NULL.
+   */
+  static void *Allocate(size_t size);
+
+  /**
+   * @brief Release memory returned by Allocate().
+   * @param ptr the memory, may be NULL.
+   * @param size the size passed to Allocate().
+   */
+  static void Release(void *ptr, size_t size);
+
+  /**
+   * @brief Turn the free lists on or off.
+   * @param enabled if false, Allocate() and Release() always use the heap.
+   *
+   * This is for benchmarks and tests, it should be called before any other
+   * threads are started.
+   */
+  static void SetCaching(bool enabled);
+
+  /**
+   * @brief The number of free blocks held by the current thread.
+   */
+  static unsigned int FreeBlocks();
+
+  /**
+   * @brief Callbacks larger than this always use the heap.
+   */
+  static const size_t MAX_SIZE = 256;
+
+ private:
+  CallbackAllocator();
+};
+
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // INCLUDE_OLA_CALLBACKALLOCATOR_H_
@@ -44,7 +44,14 @@ namespace ola {
  * @note DmxBuffer uses a copy-on-write (COW) optimization, more info can be
  * found here: http://en.wikipedia.org/wiki/Copy-on-write
  *
- * @note This class is <b>NOT</b> thread safe.
+ * The slot data and the reference count live in a single allocation, and the
+ * reference count is updated atomically. This means copies of a DmxBuffer
+ * that share data may be used and destroyed in different threads, in the same
+ * way as std::shared_ptr. Use DmxBufferView to hand a frame to another thread
+ * without copying the slot data.
+ *
+ * @note A single DmxBuffer object is <b>NOT</b> thread safe, it must not be
+ * accessed from more than one thread at once.
  */
 class DmxBuffer {
  public:
@@ -56,12 +63,21 @@ class DmxBuffer {
 
     /**
      * @brief Copy constructor.
-     * We just copy the underlying pointers and mark
-     * m_copy_on_write as true if the other buffer has data.
+     * We just copy the underlying pointer and increment the reference count,
+     * the data is copied when either buffer is next modified.
      * @param other The other DmxBuffer to copy from
      */
     DmxBuffer(const DmxBuffer &other);
 
+#if __cplusplus >= 201103L
+    /**
+     * @brief Move constructor.
+     * This takes the data from the other buffer, leaving it empty.
+     * @param other The other DmxBuffer to move from
+     */
+    DmxBuffer(DmxBuffer &&other);
+#endif  // __cplusplus >= 201103L
+
     /**
      * @brief Create a new buffer from raw data.
      * @param data is a pointer to an array of data used to populate DmxBuffer
@@ -90,6 +106,22 @@ class DmxBuffer {
      */
     DmxBuffer& operator=(const DmxBuffer &other);
 
+#if __cplusplus >= 201103L
+    /**
+     * @brief Move assignment operator.
+     * This takes the data from the other buffer, leaving it empty.
+     * @param other the other DmxBuffer to move from
+     */
+    DmxBuffer& operator=(DmxBuffer &&other);
+#endif  // __cplusplus >= 201103L
+
+    /**
+     * @brief Exchange the contents of this buffer with another.
+     * This never copies or allocates.
+     * @param other the DmxBuffer to swap with
+     */
+    void Swap(DmxBuffer &other);
+
     /**
      * @brief Equality operator used to check if two DmxBuffers are equal.
      * @param other is the other DmxBuffer to check against
@@ -265,16 +297,92 @@ class DmxBuffer {
     std::string ToString() const;
 
  private:
+    struct Storage;
+
     bool Init();
     bool DuplicateIfNeeded();
     void CopyFromOther(const DmxBuffer &other);
     void CleanupMemory();
-    unsigned int *m_ref_count;
-    mutable bool m_copy_on_write;
+    bool IsShared() const;
+
+    Storage *m_storage;
     uint8_t *m_data;
     unsigned int m_length;
 };
 
+
+/**
+ * @class DmxBufferView ola/DmxBuffer.h
+ * @brief A read-only reference to the data in a DmxBuffer.
+ *
+ * Creating a view shares the slot data with the DmxBuffer, rather than copying
+ * it. If the DmxBuffer is later modified it makes its own copy, so the view
+ * always sees the frame as it was when the view was created.
+ *
+ * Since the reference count is atomic, a view can be passed to another thread
+ * (e.g. an output plugin's sender thread) and read there while the original
+ * DmxBuffer continues to be updated.
+ *
+ * @examplepara
+ *   @code
+ *   DmxBufferView view(buffer);
+ *   // pass view to another thread
+ *   write(fd, view.GetRaw(), view.Size());
+ *   @endcode
+ */
+class DmxBufferView {
+ public:
+    /**
+     * @brief Create an empty view, Size() == 0.
+     */
+    DmxBufferView() {}
+
+    /**
+     * @brief Create a view of a DmxBuffer's data.
+     * @param buffer the DmxBuffer to share the data with.
+     */
+    explicit DmxBufferView(const DmxBuffer &buffer) : m_buffer(buffer) {}
+
+    /**
+     * @brief The number of slots in the view.
+     */
+    unsigned int Size() const { return m_buffer.Size(); }
+
+    /**
+     * @brief Get a raw pointer to the slot data.
+     * @returns a pointer to the data, or NULL if the view is empty.
+     */
+    const uint8_t *GetRaw() const { return m_buffer.GetRaw(); }
+
+    /**
+     * @brief Return the value of a slot, or 0 if the slot is out-of-bounds.
+     */
+    uint8_t Get(unsigned int channel) const { return m_buffer.Get(channel); }
+
+    /**
+     * @brief Access the data as a const DmxBuffer.
+     * This allows the view to be passed to methods that take a
+     * const DmxBuffer&, without copying.
+     */
+    const DmxBuffer &AsBuffer() const { return m_buffer; }
+
+    /**
+     * @brief Convert the view to a human readable representation.
+     */
+    std::string ToString() const { return m_buffer.ToString(); }
+
+    bool operator==(const DmxBufferView &other) const {
+      return m_buffer == other.m_buffer;
+    }
+
+    bool operator!=(const DmxBufferView &other) const {
+      return m_buffer != other.m_buffer;
+    }
+
+ private:
+    DmxBuffer m_buffer;
+};
+
 /**
  * @brief Stream operator to allow DmxBuffer to be output to stdout
  * @param out is the output stream
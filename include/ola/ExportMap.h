@@ -32,10 +32,12 @@
 
 #include <ola/base/Macro.h>
 #include <ola/StringUtils.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <functional>
 #include <map>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -211,6 +213,7 @@ class MapVariable: public BaseVariable {
   Type &operator[](const std::string &key);
   const std::string Value() const;
   const std::string Label() const { return m_label; }
+  const std::map<std::string, Type> &Entries() const { return m_variables; }
 
  protected:
   std::map<std::string, Type> m_variables;
@@ -250,6 +253,87 @@ class UIntMap: public MapVariable<unsigned int> {
 };
 
 
+/**
+ * @brief A map of counters which can be incremented from any thread.
+ *
+ * Incrementing a UIntMap looks up the key each time. A CounterMap resolves
+ * the key to a Handle once, when it's registered, and each increment is then
+ * a single relaxed atomic add. Each thread adds to its own shard of the
+ * counters, so threads don't contend for the same cache line, and the shards
+ * are summed when the value is read.
+ *
+ * Register(), Remove() and reading the values must be done on the thread
+ * that owns the ExportMap. Once a handle has been passed to another thread,
+ * Add() can be called from that thread, until the key is removed.
+ */
+class CounterMap: public BaseVariable {
+ public:
+  typedef unsigned int Handle;
+
+  CounterMap(const std::string &name, const std::string &label);
+  ~CounterMap();
+
+  /**
+   * @brief Get the handle for a key, adding the key if it doesn't exist.
+   * @returns the handle, or INVALID_HANDLE if the map is full.
+   */
+  Handle Register(const std::string &key);
+
+  /**
+   * @brief Remove a key, the handle must not be used after this.
+   */
+  void Remove(const std::string &key);
+
+  /**
+   * @brief Add to a counter. This is a no-op for INVALID_HANDLE.
+   */
+  void Add(Handle handle, uint64_t delta);
+
+  void Increment(Handle handle) { Add(handle, 1); }
+
+  uint64_t Get(Handle handle) const;
+  uint64_t Get(const std::string &key) const;
+
+  /**
+   * @brief Get the current value of all the counters, by key.
+   */
+  void Entries(std::map<std::string, uint64_t> *entries) const;
+
+  const std::string Value() const;
+  const std::string Label() const { return m_label; }
+
+  static const Handle INVALID_HANDLE;
+
+ private:
+  enum { SHARD_COUNT = 8 };
+  enum { BLOCK_SIZE = 64 };
+  enum { MAX_BLOCKS = 256 };
+
+  // The counters are allocated in blocks which are never moved, so handles
+  // can be added while other threads are incrementing.
+  struct Block {
+    uint64_t counters[SHARD_COUNT][BLOCK_SIZE];
+  };
+
+  typedef std::map<std::string, Handle> HandleMap;
+
+  std::string m_label;
+  HandleMap m_handles;
+  std::vector<Handle> m_free_handles;
+  Handle m_next_handle;
+  Block *m_blocks[MAX_BLOCKS];
+
+  uint64_t *Counter(Handle handle, unsigned int shard) const {
+    return &m_blocks[handle / BLOCK_SIZE]->counters[shard][
+        handle % BLOCK_SIZE];
+  }
+
+  static unsigned int ShardIndex();
+
+  DISALLOW_COPY_AND_ASSIGN(CounterMap);
+};
+
+
 /*
  * Return a value from the Map Variable, this will create an entry in the map
  * if the variable doesn't exist.
@@ -372,12 +456,36 @@ class ExportMap {
   UIntMap *GetUIntMapVar(const std::string &name,
                          const std::string &label = "");
 
+  /**
+   * @brief Lookup or create a CounterMap.
+   * @param name the name of this variable.
+   * @param label the label to use for the keys.
+   * @return a pointer to the CounterMap.
+   *
+   * The variable is created if it doesn't already exist. The pointer is
+   * valid for the lifetime of the ExportMap.
+   */
+  CounterMap *GetCounterMapVar(const std::string &name,
+                               const std::string &label = "");
+
   /**
    * @brief Fetch a list of all known variables.
    * @returns a vector of all variables.
    */
   std::vector<BaseVariable*> AllVariables() const;
 
+  /**
+   * @brief Write the numeric variables in the OpenMetrics text format.
+   * @param output the stream to write to.
+   *
+   * Counters are exported as counters, the other numeric variables as
+   * gauges, and maps use their label as the metric label. The names are
+   * prefixed with ola_ and any characters that aren't allowed are replaced
+   * with underscores. String variables aren't exported. This doesn't write
+   * the "# EOF" line, so the caller can add more metrics.
+   */
+  void ExportOpenMetrics(std::ostream *output) const;
+
  private :
   template<typename Type>
   Type *GetVar(std::map<std::string, Type*> *var_map,
@@ -396,6 +504,7 @@ class ExportMap {
   std::map<std::string, StringMap*> m_str_map_variables;
   std::map<std::string, IntMap*> m_int_map_variables;
   std::map<std::string, UIntMap*> m_uint_map_variables;
+  std::map<std::string, CounterMap*> m_counter_map_variables;
 
   DISALLOW_COPY_AND_ASSIGN(ExportMap);
 };
@@ -96,6 +96,55 @@ struct SendDMXArgs {
   }
 };
 
+/**
+ * @brief Arguments passed to the RegisterUniverse() method.
+ */
+struct RegisterArgs {
+  /**
+   * @brief the Callback to run upon completion. Defaults to NULL.
+   */
+  SetCallback *callback;
+
+  /**
+   * @brief Only deliver frames that differ from the previous one. Defaults to
+   * false.
+   */
+  bool skip_unchanged_frames;
+
+  /**
+   * @brief When skipping unchanged frames, how often in milliseconds to
+   * deliver the frame anyway. Defaults to 0, which uses the server's default.
+   */
+  unsigned int keep_alive_ms;
+
+  /**
+   * @brief The maximum number of frames per second to deliver. If DMX
+   * changes faster than this, intermediate frames are dropped. Defaults to 0,
+   * which means no limit.
+   */
+  unsigned int max_frame_rate;
+
+  /**
+   * @brief Create a new RegisterArgs object
+   */
+  RegisterArgs()
+      : callback(NULL),
+        skip_unchanged_frames(false),
+        keep_alive_ms(0),
+        max_frame_rate(0) {
+  }
+
+  /**
+   * @brief Create a new RegisterArgs object
+   */
+  explicit RegisterArgs(SetCallback *_callback)
+      : callback(_callback),
+        skip_unchanged_frames(false),
+        keep_alive_ms(0),
+        max_frame_rate(0) {
+  }
+};
+
 /**
  * @brief Arguments used with OlaClient::RDMGet() and OlaClient::RDMSet()
  * methods.
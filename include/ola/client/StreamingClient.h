@@ -25,16 +25,23 @@
 #ifndef INCLUDE_OLA_CLIENT_STREAMINGCLIENT_H_
 #define INCLUDE_OLA_CLIENT_STREAMINGCLIENT_H_
 
+#include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/base/Macro.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <map>
+#include <vector>
 
 namespace ola {
 
+namespace dmx { class SharedDmxWriter; }
 namespace io { class SelectServer; }
 namespace network { class TCPSocket; }
-namespace proto { class OlaServerService_Stub; }
+namespace proto {
+class DmxDataBatch;
+class OlaServerService_Stub;
+}
 namespace rpc {
 class RpcChannel;
 class RpcSession;
@@ -97,7 +104,12 @@ class StreamingClient : public StreamingClientInterface {
      * Create a new options structure with the default options. This
      * includes automatically starting olad if it's not already running.
      */
-    Options() : auto_start(true), server_port(OLA_DEFAULT_PORT) {}
+    Options()
+        : auto_start(true),
+          server_port(OLA_DEFAULT_PORT),
+          use_shared_memory(false),
+          shared_memory_universes(DEFAULT_SHARED_MEMORY_UNIVERSES) {
+    }
 
     /**
      * If true, the client will automatically start olad if it's not
@@ -109,8 +121,65 @@ class StreamingClient : public StreamingClientInterface {
      * The RPC port olad is listening on.
      */
     uint16_t server_port;
+
+    /**
+     * If true, DMX data is passed to olad using shared memory rather than
+     * the RPC socket. This is only available if olad runs on the same host
+     * and the platform supports it, otherwise the RPC socket is used.
+     */
+    bool use_shared_memory;
+
+    /**
+     * The number of universes that can be sent using shared memory. Any
+     * further universes are sent over the RPC socket.
+     */
+    unsigned int shared_memory_universes;
+
+    static const unsigned int DEFAULT_SHARED_MEMORY_UNIVERSES = 64;
   };
 
+  /**
+   * @brief The data for one universe in a call to SendDMXBatch().
+   */
+  class UniverseData {
+   public:
+    UniverseData()
+        : universe(0),
+          priority(ola::dmx::SOURCE_PRIORITY_DEFAULT) {
+    }
+
+    UniverseData(unsigned int universe, const DmxBuffer &data,
+                 uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT)
+        : universe(universe),
+          data(data),
+          priority(priority) {
+    }
+
+    /**
+     * @brief the universe to send to.
+     */
+    unsigned int universe;
+
+    /**
+     * @brief the DMX512 data.
+     */
+    DmxBuffer data;
+
+    /**
+     * @brief the priority of the data.
+     * This should be between ola::dmx::SOURCE_PRIORITY_MIN and
+     * ola::dmx::SOURCE_PRIORITY_MAX.
+     */
+    uint8_t priority;
+  };
+
+  /**
+   * The largest number of universes sent in a single RPC by SendDMXBatch().
+   * Larger batches are split into several RPCs, which keeps each message
+   * well below the RPC size limit of 1MB.
+   */
+  static const unsigned int MAX_BATCH_UNIVERSES = 1024;
+
   /**
    * Create a new StreamingClient.
    * @param auto_start if set to true, this will automatically start olad if
@@ -164,6 +233,19 @@ class StreamingClient : public StreamingClientInterface {
                const DmxBuffer &data,
                const SendArgs &args);
 
+  /**
+   * @brief Send DMX data for many universes at once.
+   *
+   * This is more efficient than calling SendDMX() for each universe, since
+   * the data is sent to olad in a single RPC (or one per
+   * MAX_BATCH_UNIVERSES universes) and olad only updates each universe's
+   * outputs once.
+   * @param universes the data for each universe.
+   * @returns true if sent successfully, false if the connection to the server
+   *   has been closed.
+   */
+  bool SendDMXBatch(const std::vector<UniverseData> &universes);
+
   void ChannelClosed(ola::rpc::RpcSession *session);
 
  private:
@@ -174,8 +256,20 @@ class StreamingClient : public StreamingClientInterface {
   class ola::rpc::RpcChannel *m_channel;
   class ola::proto::OlaServerService_Stub *m_stub;
   bool m_socket_closed;
+  class ola::proto::DmxDataBatch *m_batch;
+  bool m_use_shared_memory;
+  unsigned int m_shared_memory_universes;
+  class ola::dmx::SharedDmxWriter *m_shared_writer;
+  std::map<unsigned int, unsigned int> m_shared_slots;
+  ola::Clock m_clock;
+  TimeStamp m_last_connection_check;
 
   bool Send(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  bool CheckConnection();
+  bool CheckSharedConnection();
+  bool SendBatch();
+  bool AttachSharedMemory();
+  bool SharedSlot(unsigned int universe, unsigned int *slot);
 
   DISALLOW_COPY_AND_ASSIGN(StreamingClient);
 };
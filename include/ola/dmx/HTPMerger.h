@@ -0,0 +1,159 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMerger.h
+ * Merge many DMX sources using Highest Takes Precedence in a single pass.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file HTPMerger.h
+ * @brief Merge many DMX sources using Highest Takes Precedence (HTP).
+ */
+
+#ifndef INCLUDE_OLA_DMX_HTPMERGER_H_
+#define INCLUDE_OLA_DMX_HTPMERGER_H_
+
+#include <stdint.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief Merges N DmxBuffers using HTP in a single pass over the slots.
+ *
+ * DmxBuffer::HTPMerge() merges one buffer at a time, which means the output
+ * is read and written once per source. The HTPMerger instead walks the slots
+ * once, taking the maximum across all sources with a vector max instruction
+ * (SSE2, AVX2 or NEON) where available, and falls back to a scalar loop
+ * otherwise.
+ *
+ * The merger only holds pointers to the sources, so the buffers must outlive
+ * the call to Merge(). The source list is reused between merges, so once it
+ * has grown to the number of sources in use no further allocations occur.
+ *
+ * @examplepara
+ *   @code
+ *   HTPMerger merger;
+ *   merger.AddSource(buffer1);
+ *   merger.AddSource(buffer2);
+ *   merger.Merge(&output);
+ *   merger.Reset();
+ *   @endcode
+ */
+class HTPMerger {
+ public:
+  /**
+   * @brief The merge kernel in use.
+   */
+  typedef enum {
+    SCALAR_KERNEL,  /**< Plain C++ loop */
+    SSE2_KERNEL,  /**< 16 slots at a time using SSE2 */
+    AVX2_KERNEL,  /**< 32 slots at a time using AVX2 */
+    NEON_KERNEL  /**< 16 slots at a time using NEON */
+  } Kernel;
+
+  /**
+   * @brief Create a new HTPMerger, using the best kernel for this CPU.
+   */
+  HTPMerger();
+
+  /**
+   * @brief Create a new HTPMerger with a specific kernel.
+   * @param kernel the kernel to use. If the kernel isn't supported by this
+   *   CPU, the best supported kernel is used instead.
+   */
+  explicit HTPMerger(Kernel kernel);
+
+  /**
+   * @brief Remove all sources.
+   */
+  void Reset() {
+    m_source_data.clear();
+    m_source_lengths.clear();
+  }
+
+  /**
+   * @brief Add a source to the next merge.
+   * @param buffer the DMX data for the source. Buffers with no data are
+   *   ignored.
+   */
+  void AddSource(const DmxBuffer &buffer);
+
+  /**
+   * @brief The number of sources that will be merged.
+   */
+  unsigned int SourceCount() const {
+    return static_cast<unsigned int>(m_source_data.size());
+  }
+
+  /**
+   * @brief Merge the sources.
+   * @param[out] output the DmxBuffer to store the merged result in. The size
+   *   of the result is the size of the largest source.
+   * @returns true if the merge succeeded, false if there were no sources.
+   */
+  bool Merge(DmxBuffer *output) const;
+
+  /**
+   * @brief Return the kernel this merger uses.
+   */
+  Kernel ActiveKernel() const { return m_kernel; }
+
+  /**
+   * @brief Merge raw slot data.
+   * @param kernel the kernel to use, this must be supported by the CPU.
+   * @param sources an array of pointers to the slot data for each source.
+   * @param lengths an array of the number of slots in each source.
+   * @param count the number of sources.
+   * @param[out] output the merged slot data, this must be at least
+   *   DMX_UNIVERSE_SIZE long.
+   * @returns the number of slots in the merged output.
+   */
+  static unsigned int MergeSlots(Kernel kernel,
+                                 const uint8_t *const *sources,
+                                 const unsigned int *lengths,
+                                 unsigned int count,
+                                 uint8_t *output);
+
+  /**
+   * @brief Check if a kernel is supported on this CPU.
+   */
+  static bool KernelSupported(Kernel kernel);
+
+  /**
+   * @brief Return the fastest kernel supported on this CPU.
+   */
+  static Kernel BestKernel();
+
+  /**
+   * @brief Return the name of a kernel, e.g. "sse2".
+   */
+  static const char *KernelName(Kernel kernel);
+
+ private:
+  Kernel m_kernel;
+  std::vector<const uint8_t*> m_source_data;
+  std::vector<unsigned int> m_source_lengths;
+
+  DISALLOW_COPY_AND_ASSIGN(HTPMerger);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_HTPMERGER_H_
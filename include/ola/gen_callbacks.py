@@ -71,6 +71,9 @@ USA
    * Avoid creating Callbacks by directly calling the constructor. Instead use
    * the NewSingleCallback() and NewCallback() helper methods.
    *
+   * Callbacks are allocated from per-thread free lists, so creating and
+   * deleting them doesn't normally touch the heap. See CallbackAllocator.
+   *
    * @examplepara Simple function pointer replacement.
    *   @code
    *   // wrap a function that takes no args and returns a bool
@@ -137,6 +140,9 @@ USA
   #ifndef INCLUDE_OLA_CALLBACK_H_
   #define INCLUDE_OLA_CALLBACK_H_
 
+  #include <stddef.h>
+  #include <ola/CallbackAllocator.h>
+
   namespace ola {
 
   /**
@@ -155,6 +161,16 @@ def Footer():
   #endif  // INCLUDE_OLA_CALLBACK_H_""")
 
 
+def AllocatorMethods():
+  """Generate the operators which take callbacks from the free lists."""
+  print '  static void *operator new(size_t size) {'
+  print '    return CallbackAllocator::Allocate(size);'
+  print '  }'
+  print '  static void operator delete(void *ptr, size_t size) {'
+  print '    CallbackAllocator::Release(ptr, size);'
+  print '  }'
+
+
 def GenerateBase(number_of_args):
   """Generate the base Callback classes."""
   optional_comma = ''
@@ -193,6 +209,7 @@ def GenerateBase(number_of_args):
          (number_of_args, number_of_args, optional_comma, arg_types))
   print ' public:'
   print '  virtual ~Callback%d() {}' % number_of_args
+  AllocatorMethods()
   PrintLongLine('  ReturnType Run(%s) { return this->DoRun(%s); }' %
                 (arg_list, args))
   print ' private:'
@@ -212,6 +229,7 @@ def GenerateBase(number_of_args):
                 (number_of_args, number_of_args, optional_comma, arg_types))
   print ' public:'
   print '  virtual ~SingleUseCallback%d() {}' % number_of_args
+  AllocatorMethods()
   print '  ReturnType Run(%s) {' % arg_list
   print '    ReturnType ret = this->DoRun(%s);' % args
   print '    delete this;'
@@ -234,6 +252,7 @@ def GenerateBase(number_of_args):
                  optional_comma, arg_types))
   print ' public:'
   print '  virtual ~SingleUseCallback%d() {}' % number_of_args
+  AllocatorMethods()
   print '  void Run(%s) {' % arg_list
   print '    this->DoRun(%s);' % args
   print '    delete this;'
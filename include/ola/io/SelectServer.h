@@ -66,6 +66,9 @@ class SelectServer: public SelectServerInterface {
    public:
     Options()
         : force_select(false),
+          use_io_uring(false),
+          use_timer_wheel(false),
+          profile_loop(false),
           export_map(NULL),
           clock(NULL) {
     }
@@ -76,6 +79,32 @@ class SelectServer: public SelectServerInterface {
      */
     bool force_select;
 
+    /**
+     * @brief Use io_uring rather than epoll, if the kernel supports it.
+     *
+     * This is only available on Linux. The --use-io-uring flag also enables
+     * this. force_select takes precedence.
+     */
+    bool use_io_uring;
+
+    /**
+     * @brief Keep the timeouts in a timing wheel rather than a priority
+     * queue.
+     *
+     * This makes registering and removing timeouts O(1), which helps when
+     * there are many of them. The --use-timer-wheel flag also enables this.
+     */
+    bool use_timer_wheel;
+
+    /**
+     * @brief Record the time taken by each callback and warn when an
+     * iteration of the loop takes longer than --loop-stall-budget.
+     *
+     * The results are published to the export map. The --profile-loop flag
+     * also enables this.
+     */
+    bool profile_loop;
+
     /**
      * @brief The export map to use.
      */
@@ -198,6 +227,7 @@ class SelectServer: public SelectServerInterface {
   ExportMap *m_export_map;
   bool m_terminate, m_is_running;
   TimeInterval m_poll_interval;
+  std::auto_ptr<class LoopProfiler> m_profiler;
   std::auto_ptr<class TimeoutManager> m_timeout_manager;
   std::auto_ptr<class PollerInterface> m_poller;
 
@@ -39,6 +39,25 @@
 namespace ola {
 namespace network {
 
+/**
+ * @brief A datagram to send with UDPSocketInterface::SendBatch().
+ */
+struct OutgoingDatagram {
+  const uint8_t *data;  /**< The data to send */
+  unsigned int size;  /**< The size of the data */
+  IPV4SocketAddress destination;  /**< Where to send the datagram */
+};
+
+/**
+ * @brief A datagram received with UDPSocketInterface::RecvBatch().
+ */
+struct IncomingDatagram {
+  uint8_t *buffer;  /**< The buffer to receive the datagram into */
+  unsigned int buffer_size;  /**< The size of the buffer */
+  unsigned int size;  /**< Set to the size of the datagram */
+  IPV4SocketAddress source;  /**< Set to the source of the datagram */
+};
+
 /**
  * @brief The interface for UDPSockets.
  *
@@ -227,6 +246,37 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
    */
   virtual bool SetTos(uint8_t tos) = 0;
 
+  // These have default implementations and are kept at the end of the class,
+  // so subclasses written against the older interface keep the same vtable
+  // layout.
+
+  /**
+   * @brief Send many datagrams at once.
+   * @param datagrams the datagrams to send.
+   * @param count the number of datagrams.
+   * @return the number of datagrams that were sent in full.
+   *
+   * Where the platform supports it, the datagrams are passed to the kernel
+   * with a single system call. A datagram that can't be sent doesn't stop the
+   * remaining datagrams from being sent.
+   */
+  virtual unsigned int SendBatch(const OutgoingDatagram *datagrams,
+                                 unsigned int count);
+
+  /**
+   * @brief Receive many datagrams at once.
+   * @param datagrams the buffers to receive into.
+   * @param count the number of buffers.
+   * @return the number of datagrams received, the first N entries in
+   *   datagrams are filled in.
+   *
+   * This should be called when the socket is readable. It doesn't wait for
+   * further datagrams to arrive, and on platforms that can't receive many
+   * datagrams in one system call only a single datagram is returned.
+   */
+  virtual unsigned int RecvBatch(IncomingDatagram *datagrams,
+                                 unsigned int count);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(UDPSocketInterface);
 };
@@ -286,6 +336,10 @@ class UDPSocket: public UDPSocketInterface {
 
   bool SetTos(uint8_t tos);
 
+  unsigned int SendBatch(const OutgoingDatagram *datagrams,
+                         unsigned int count);
+  unsigned int RecvBatch(IncomingDatagram *datagrams, unsigned int count);
+
  private:
   ola::io::DescriptorHandle m_handle;
   bool m_bound_to_port;
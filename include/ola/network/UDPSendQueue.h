@@ -0,0 +1,113 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UDPSendQueue.h
+ * Queue datagrams and send them with a single call.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @addtogroup network
+ * @{
+ * @file UDPSendQueue.h
+ * @brief Queue datagrams and send them with a single call.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_UDPSENDQUEUE_H_
+#define INCLUDE_OLA_NETWORK_UDPSENDQUEUE_H_
+
+#include <stdint.h>
+#include <ola/base/Macro.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <vector>
+
+namespace ola {
+namespace network {
+
+/**
+ * @addtogroup network
+ * @{
+ */
+
+/**
+ * @brief Copies datagrams into a buffer and sends them using
+ * UDPSocketInterface::SendBatch().
+ *
+ * Once the buffers have been allocated by the first call to Add(), queueing
+ * and sending datagrams doesn't allocate memory.
+ */
+class UDPSendQueue {
+ public:
+  /**
+   * @brief Create a new UDPSendQueue.
+   * @param socket the socket to send on, ownership is not transferred.
+   * @param max_datagram_size the size of the largest datagram to queue.
+   * @param max_datagrams the number of datagrams to hold, if the queue is
+   *   full when Add() is called, the queue is flushed first.
+   */
+  UDPSendQueue(UDPSocketInterface *socket,
+               unsigned int max_datagram_size,
+               unsigned int max_datagrams = DEFAULT_MAX_DATAGRAMS);
+
+  /**
+   * @brief Queue a datagram.
+   * @param data the datagram, this is copied.
+   * @param size the size of the datagram.
+   * @param destination where to send the datagram.
+   * @returns true if the datagram was queued. Datagrams larger than
+   *   max_datagram_size are sent immediately, in which case this returns true
+   *   if the datagram was sent.
+   */
+  bool Add(const uint8_t *data, unsigned int size,
+           const IPV4SocketAddress &destination);
+
+  /**
+   * @brief The number of queued datagrams.
+   */
+  unsigned int Size() const {
+    return static_cast<unsigned int>(m_datagrams.size());
+  }
+
+  /**
+   * @brief Check if the queue is empty.
+   */
+  bool Empty() const { return m_datagrams.empty(); }
+
+  /**
+   * @brief Send all queued datagrams.
+   * @returns the number of datagrams that were sent in full.
+   */
+  unsigned int Flush();
+
+  /**
+   * @brief The default number of datagrams to hold.
+   */
+  static const unsigned int DEFAULT_MAX_DATAGRAMS = 256;
+
+ private:
+  UDPSocketInterface *m_socket;
+  const unsigned int m_max_datagram_size;
+  const unsigned int m_max_datagrams;
+  std::vector<uint8_t> m_storage;
+  std::vector<OutgoingDatagram> m_datagrams;
+
+  DISALLOW_COPY_AND_ASSIGN(UDPSendQueue);
+};
+/**@}*/
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_UDPSENDQUEUE_H_
@@ -0,0 +1,103 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FrameTimer.h
+ * Paces a thread that sends frames at a fixed rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_FRAMETIMER_H_
+#define INCLUDE_OLA_THREAD_FRAMETIMER_H_
+
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <stdint.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Paces a thread that sends frames at a fixed rate.
+ *
+ * Frames start on multiples of the period on the monotonic clock, rather
+ * than a period after the last frame finished. The time taken to send a
+ * frame doesn't change the rate, and timers with the same rate, including
+ * the olad frame clock, stay in phase.
+ *
+ * Threads are often woken up late. If a spin time is given, the thread
+ * sleeps until shortly before the deadline and then busy waits for the
+ * rest. How early it wakes adapts to how late the wake ups have been, up to
+ * the spin time. This uses more CPU but keeps the jitter to a few
+ * microseconds.
+ *
+ * @examplepara
+ *   @code
+ *   FrameTimer timer(TimeInterval(0, 25000));  // 40 frames per second
+ *   while (running) {
+ *     timer.WaitForNextFrame();
+ *     SendFrame();
+ *   }
+ *   @endcode
+ */
+class FrameTimer {
+ public:
+  /**
+   * @brief Create a new FrameTimer.
+   * @param period the time between frames. This may be zero if only Sleep()
+   *   is used.
+   * @param max_spin_time the longest time to busy wait for before a
+   *   deadline, zero disables busy waiting.
+   */
+  explicit FrameTimer(const TimeInterval &period,
+                      const TimeInterval &max_spin_time = TimeInterval());
+
+  /**
+   * @brief Wait until the start of the next frame.
+   * @returns the number of frames that were skipped because the caller was
+   *   late.
+   */
+  unsigned int WaitForNextFrame();
+
+  /**
+   * @brief Sleep for a short time, for example the DMX break.
+   * @param duration the time to sleep for.
+   */
+  void Sleep(const TimeInterval &duration);
+
+  /**
+   * @brief How long before a deadline the busy wait starts.
+   */
+  TimeInterval SpinTime() const {
+    return TimeInterval(m_spin_ns / ONE_THOUSAND);
+  }
+
+ private:
+  const int64_t m_period_ns;
+  const int64_t m_max_spin_ns;
+  int64_t m_spin_ns;
+  int64_t m_next_frame_ns;
+
+  void WaitUntil(int64_t deadline_ns);
+
+  static int64_t Now();
+  static void SleepUntil(int64_t wake_ns);
+
+  static const int64_t ONE_THOUSAND = 1000;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTimer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_FRAMETIMER_H_
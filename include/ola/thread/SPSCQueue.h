@@ -0,0 +1,182 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueue.h
+ * A lock free, single producer, single consumer queue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+
+#include <stdint.h>
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A bounded queue between exactly one producer thread and one consumer
+ * thread.
+ *
+ * The elements are allocated up front and are updated in place, so pushing
+ * and popping don't allocate or copy anything other than what the caller
+ * writes. The producer uses Reserve() and Commit(), the consumer uses Front()
+ * and Pop().
+ *
+ * @code
+ *   // producer
+ *   Frame *frame = queue.Reserve();
+ *   if (frame) {
+ *     frame->length = ...;
+ *     queue.Commit();
+ *   }
+ *
+ *   // consumer
+ *   const Frame *frame;
+ *   while ((frame = queue.Front())) {
+ *     ...
+ *     queue.Pop();
+ *   }
+ * @endcode
+ */
+template <typename T>
+class SPSCQueue {
+ public:
+  /**
+   * @brief Create a new queue.
+   * @param capacity the number of elements, this is rounded up to a power of
+   *   two.
+   */
+  explicit SPSCQueue(unsigned int capacity)
+      : m_mask(RoundUp(capacity) - 1),
+        m_elements(new T[m_mask + 1]),
+        m_head(0),
+        m_cached_tail(0),
+        m_tail(0),
+        m_cached_head(0) {
+  }
+
+  ~SPSCQueue() { delete[] m_elements; }
+
+  /**
+   * @brief The number of elements the queue can hold.
+   */
+  unsigned int Capacity() const { return m_mask + 1; }
+
+  /**
+   * @brief Get the next free element, called by the producer.
+   * @returns the element to fill in, or NULL if the queue is full.
+   */
+  T *Reserve() {
+    if (m_tail - m_cached_head > m_mask) {
+      m_cached_head = Load(&m_head);
+      if (m_tail - m_cached_head > m_mask) {
+        return NULL;
+      }
+    }
+    return &m_elements[m_tail & m_mask];
+  }
+
+  /**
+   * @brief Make the element returned by Reserve() visible to the consumer.
+   */
+  void Commit() {
+    Store(&m_tail, m_tail + 1);
+  }
+
+  /**
+   * @brief Get the oldest element, called by the consumer.
+   * @returns the element, or NULL if the queue is empty.
+   */
+  T *Front() {
+    if (m_cached_tail == m_head) {
+      m_cached_tail = Load(&m_tail);
+      if (m_cached_tail == m_head) {
+        return NULL;
+      }
+    }
+    return &m_elements[m_head & m_mask];
+  }
+
+  /**
+   * @brief Release the element returned by Front() back to the producer.
+   */
+  void Pop() {
+    Store(&m_head, m_head + 1);
+  }
+
+  /**
+   * @brief Check if the queue is empty. This is only a hint unless it's
+   * called by the consumer.
+   */
+  bool Empty() const {
+    return Load(&m_head) == Load(&m_tail);
+  }
+
+ private:
+  // The indices grow without bound and wrap at 2^32, m_mask selects the
+  // element. Each thread keeps a copy of the other's index, so it only reads
+  // the shared one when the queue looks full or empty.
+  enum { CACHE_LINE_SIZE = 64 };
+
+  const uint32_t m_mask;
+  T *const m_elements;
+  uint8_t m_pad0[CACHE_LINE_SIZE];
+
+  // Written by the consumer.
+  uint32_t m_head;
+  uint32_t m_cached_tail;
+  uint8_t m_pad1[CACHE_LINE_SIZE];
+
+  // Written by the producer.
+  uint32_t m_tail;
+  uint32_t m_cached_head;
+  uint8_t m_pad2[CACHE_LINE_SIZE];
+
+  static uint32_t RoundUp(unsigned int capacity) {
+    uint32_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+#ifdef __ATOMIC_ACQUIRE
+  static uint32_t Load(const uint32_t *index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+  }
+
+  static void Store(uint32_t *index, uint32_t value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+  }
+#else
+  static uint32_t Load(const uint32_t *index) {
+    uint32_t value = *const_cast<const volatile uint32_t*>(index);
+    __sync_synchronize();
+    return value;
+  }
+
+  static void Store(uint32_t *index, uint32_t value) {
+    __sync_synchronize();
+    *const_cast<volatile uint32_t*>(index) = value;
+  }
+#endif  // __ATOMIC_ACQUIRE
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_SPSCQUEUE_H_
@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingPool.h
+ * An executor which runs callbacks on a pool of work stealing threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
+#define INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
+
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+
+#include <deque>
+#include <vector>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Runs callbacks on a pool of threads without a shared lock.
+ *
+ * Each worker owns a deque of callbacks. Callbacks queued from outside the
+ * pool go into a bounded lock-free queue which the workers drain in batches;
+ * callbacks queued from a worker go onto that worker's own deque. Idle
+ * workers steal from the other workers' deques before going to sleep.
+ *
+ * The queues are allocated up front and their slots are reused, so apart
+ * from the callback itself, Execute() doesn't allocate. The mutex is only
+ * taken to put a worker to sleep or wake it up, and Execute() only wakes a
+ * worker if one is asleep and a wake up isn't already on the way.
+ *
+ * @code
+ *   WorkStealingPool pool(4);
+ *   pool.Start();
+ *   pool.Execute(NewSingleCallback(&EncodePixels, buffer));
+ *   ...
+ *   pool.Stop();
+ * @endcode
+ *
+ * With more than one worker, callbacks may run concurrently and callbacks
+ * from the same thread may complete out of order.
+ */
+class WorkStealingPool : public ExecutorInterface {
+ public:
+  /**
+   * @brief Create a new WorkStealingPool.
+   * @param thread_count the number of workers.
+   * @param options the options used for the worker threads.
+   */
+  explicit WorkStealingPool(
+      unsigned int thread_count,
+      const Thread::Options &options = Thread::Options());
+
+  /**
+   * @brief Destructor, this stops the pool and runs any pending callbacks.
+   */
+  ~WorkStealingPool();
+
+  /**
+   * @brief Start the workers.
+   * @returns true if the workers started, false if the pool was already
+   *   started or a thread couldn't be started.
+   *
+   * Not thread safe, should only be called once.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the workers.
+   *
+   * This waits for the workers to exit and then runs any pending callbacks in
+   * the current thread.
+   *
+   * Not thread safe, should only be called once.
+   */
+  void Stop();
+
+  /**
+   * @brief Queue a callback to be run by one of the workers.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * This may be called from any thread, including the workers.
+   */
+  void Execute(ola::BaseCallback0<void> *callback);
+
+  /**
+   * @brief Block until all pending callbacks have been run.
+   *
+   * If the pool hasn't been started or has been stopped, the callbacks are
+   * run in the current thread. This must not be called from a worker.
+   */
+  void DrainCallbacks();
+
+  /**
+   * @brief The number of workers.
+   */
+  unsigned int ThreadCount() const { return m_thread_count; }
+
+  /**
+   * @brief The number of callbacks that have been taken from another
+   * worker's deque.
+   */
+  unsigned int Steals() const;
+
+ private:
+  typedef ola::BaseCallback0<void>* Action;
+
+  class Worker;
+  class InjectionQueue;
+
+  static const unsigned int DEQUE_SIZE = 1024;
+  static const unsigned int INJECTION_QUEUE_SIZE = 4096;
+  // The number of callbacks a worker takes from the injection queue at once.
+  static const unsigned int BATCH_SIZE = 16;
+
+  const unsigned int m_thread_count;
+  const Thread::Options m_options;
+  std::vector<Worker*> m_workers;
+  InjectionQueue *m_injection_queue;
+
+  // Used if the injection queue is full, m_overflow_size avoids taking the
+  // lock when it's empty.
+  Mutex m_overflow_mutex;
+  std::deque<Action> m_overflow;
+  unsigned int m_overflow_size;
+
+  // Callbacks that have been queued but haven't completed.
+  unsigned int m_outstanding;
+  bool m_running;
+
+  // Sleeping and waking.
+  Mutex m_mutex;
+  ConditionVariable m_wake_condition;
+  ConditionVariable m_drain_condition;
+  unsigned int m_sleepers;
+  unsigned int m_drainers;
+  unsigned int m_wake_pending;
+  unsigned int m_shutdown;
+
+  void Enqueue(Action action);
+  Action FindWork(Worker *worker);
+  Action TakeInjected(Worker *worker);
+  Action PopInjected();
+  Action Steal(Worker *worker);
+  bool HasWork() const;
+  void RunAction(Action action);
+  void Sleep();
+  void WakeOne();
+  void WakeAnother();
+  void RunRemaining();
+  void WorkerLoop(Worker *worker);
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingPool);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_WORKSTEALINGPOOL_H_
@@ -0,0 +1,88 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LatencyHistogram.h
+ * A histogram of latencies.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_UTIL_LATENCYHISTOGRAM_H_
+#define INCLUDE_OLA_UTIL_LATENCYHISTOGRAM_H_
+
+#include <stdint.h>
+
+namespace ola {
+
+/**
+ * @brief A histogram of latencies, in microseconds.
+ *
+ * Values are grouped into buckets with 8 sub-buckets for each power of two,
+ * so percentiles are within 12.5% of the true value. Values up to 15us are
+ * exact. Recording a value is a few instructions and never allocates.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  /**
+   * @brief Record a value.
+   * @param usec the value in microseconds.
+   */
+  void Record(uint64_t usec);
+
+  /**
+   * @brief The number of values recorded.
+   */
+  uint64_t Count() const { return m_count; }
+
+  /**
+   * @brief The largest value recorded.
+   */
+  uint64_t Max() const { return m_max; }
+
+  /**
+   * @brief Return a percentile.
+   * @param percentile the percentile, from 0 to 100.
+   * @returns the upper bound of the bucket containing the percentile, or 0 if
+   *   no values have been recorded.
+   */
+  uint64_t Percentile(double percentile) const;
+
+  /**
+   * @brief Clear the histogram.
+   */
+  void Reset();
+
+ private:
+  enum {
+    SUB_BUCKET_BITS = 3,
+    SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+    // Values below this have a bucket each.
+    LINEAR_LIMIT = 2 * SUB_BUCKETS,
+    // Values are capped at 2^36us, about 19 hours.
+    MAX_BITS = 36,
+    BUCKET_COUNT = LINEAR_LIMIT + (MAX_BITS - SUB_BUCKET_BITS - 1) *
+                   SUB_BUCKETS,
+  };
+
+  uint64_t m_buckets[BUCKET_COUNT];
+  uint64_t m_count;
+  uint64_t m_max;
+
+  static unsigned int BucketFor(uint64_t usec);
+  static uint64_t BucketLimit(unsigned int bucket);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLA_UTIL_LATENCYHISTOGRAM_H_
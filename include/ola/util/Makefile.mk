@@ -2,6 +2,7 @@ olautilincludedir = $(pkgincludedir)/util/
 olautilinclude_HEADERS = \
     include/ola/util/Backoff.h \
     include/ola/util/Deleter.h \
+    include/ola/util/LatencyHistogram.h \
     include/ola/util/SequenceNumber.h \
     include/ola/util/Utils.h \
     include/ola/util/Watchdog.h
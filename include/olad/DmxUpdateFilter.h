@@ -0,0 +1,98 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxUpdateFilter.h
+ * Decides which universe frames are written to a port or client.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_DMXUPDATEFILTER_H_
+#define INCLUDE_OLAD_DMXUPDATEFILTER_H_
+
+#include <ola/Clock.h>
+
+namespace ola {
+
+/**
+ * @brief Decides which universe frames are written to a port or client.
+ *
+ * By default every merged frame is sent. A port or client can instead opt in
+ * to skip frames that are identical to the previous one, or to be told only
+ * which slots changed. In both cases the full frame is still sent once every
+ * keep-alive interval, so receivers that time out idle sources continue to
+ * see data.
+ */
+class DmxUpdateFilter {
+ public:
+    enum UpdateMode {
+      SEND_ALL_FRAMES,  /**< Send every frame, the default */
+      SKIP_UNCHANGED_FRAMES,  /**< Only send frames that changed */
+      SEND_CHANGED_SLOTS,  /**< Only send the slots that changed */
+    };
+
+    enum Action {
+      SKIP_FRAME,  /**< Don't send anything */
+      SEND_FRAME,  /**< Send the full frame */
+      SEND_CHANGES,  /**< Send the changed slots */
+    };
+
+    DmxUpdateFilter();
+
+    UpdateMode Mode() const { return m_mode; }
+
+    /**
+     * @brief Change the update mode.
+     * The next frame is always sent in full.
+     */
+    void SetMode(UpdateMode mode);
+
+    const TimeInterval &KeepAliveInterval() const { return m_keep_alive; }
+
+    /**
+     * @brief Set how often the full frame is resent if nothing changes.
+     * @param interval the keep-alive interval, 0 disables the keep-alive.
+     */
+    void SetKeepAliveInterval(const TimeInterval &interval) {
+      m_keep_alive = interval;
+    }
+
+    /**
+     * @brief Check if this filter lets every frame through.
+     */
+    bool SendsAllFrames() const { return m_mode == SEND_ALL_FRAMES; }
+
+    /**
+     * @brief Decide what to do with a new frame.
+     * @param frame_changed true if the frame differs from the last one.
+     * @param now the current time.
+     * @returns the Action to take.
+     */
+    Action Filter(bool frame_changed, const TimeStamp &now);
+
+    /**
+     * @brief Force the next frame to be sent in full.
+     */
+    void Reset() { m_send_full_frame = true; }
+
+    static const TimeInterval DEFAULT_KEEP_ALIVE;
+
+ private:
+    UpdateMode m_mode;
+    TimeInterval m_keep_alive;
+    TimeStamp m_last_sent;
+    bool m_send_full_frame;
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_DMXUPDATEFILTER_H_
@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClock.h
+ * Emits output frames at a fixed rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_FRAMECLOCK_H_
+#define INCLUDE_OLAD_FRAMECLOCK_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+namespace ola {
+
+/**
+ * @brief Emits output frames at a fixed rate.
+ *
+ * Without a FrameClock, a universe writes to its output ports as soon as new
+ * data arrives, so the output timing follows the inputs. With a FrameClock,
+ * the universe asks for a frame instead, and the latest merged data is
+ * written on the next tick. Inputs that arrive between ticks are coalesced,
+ * which bounds the latency to one period and gives the output devices a
+ * steady rate.
+ *
+ * On Linux the ticks come from a timerfd, so they don't drift and are lined
+ * up with multiples of the period on the monotonic clock, the same as
+ * ola::thread::FrameTimer. Elsewhere a repeating timeout is used.
+ *
+ * The clock keeps ticking while it's running, but ticks with no frames
+ * requested don't do anything.
+ */
+class FrameClock {
+ public:
+  /**
+   * @brief Something that is sent on the frame clock.
+   */
+  class Subscriber {
+   public:
+    virtual ~Subscriber() {}
+
+    /**
+     * @brief Called on the tick after RequestFrame().
+     */
+    virtual void EmitFrame() = 0;
+  };
+
+  /**
+   * @brief Create a new FrameClock.
+   * @param ss the SelectServer to run the clock on.
+   * @param rate the number of ticks per second, between 1 and MAX_RATE.
+   * @param export_map the ExportMap to use for the tick counters, may be
+   *   NULL.
+   */
+  FrameClock(ola::io::SelectServerInterface *ss,
+             unsigned int rate,
+             ExportMap *export_map);
+  ~FrameClock();
+
+  /**
+   * @brief Start the clock.
+   * @returns false if the clock couldn't be started, or the rate is out of
+   *   range.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the clock.
+   */
+  void Stop();
+
+  /**
+   * @brief The number of ticks per second.
+   */
+  unsigned int Rate() const { return m_rate; }
+
+  /**
+   * @brief The time between ticks.
+   */
+  TimeInterval Period() const { return m_period; }
+
+  /**
+   * @brief Request a call to EmitFrame() on the next tick.
+   *
+   * The subscriber should only request one frame per tick.
+   */
+  void RequestFrame(Subscriber *subscriber);
+
+  /**
+   * @brief Cancel a request, this must be called if the subscriber is
+   * deleted before the tick.
+   */
+  void CancelFrame(Subscriber *subscriber);
+
+  /**
+   * @brief Emit the requested frames.
+   *
+   * This is called on each tick, and is public for testing.
+   */
+  void Tick();
+
+  /**
+   * @brief The highest rate the clock will run at.
+   */
+  static const unsigned int MAX_RATE = 10000;
+
+  static const char K_FRAME_CLOCK_RATE_VAR[];
+  static const char K_FRAME_CLOCK_TICKS_VAR[];
+  static const char K_FRAME_CLOCK_MISSED_VAR[];
+
+ private:
+  typedef std::vector<Subscriber*> Subscribers;
+
+  ola::io::SelectServerInterface *m_ss;
+  const unsigned int m_rate;
+  const TimeInterval m_period;
+  ExportMap *m_export_map;
+  Subscribers m_pending;
+  Subscribers m_emitting;
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_timer;
+  ola::thread::timeout_id m_timeout_id;
+
+  bool StartTimer();
+  void TimerExpired();
+  bool TimeoutTick();
+  void CountTicks(uint64_t ticks);
+
+  DISALLOW_COPY_AND_ASSIGN(FrameClock);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_FRAMECLOCK_H_
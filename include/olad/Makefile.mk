@@ -1,8 +1,11 @@
 oladinclude_HEADERS = \
     include/olad/Device.h \
     include/olad/DmxSource.h \
+    include/olad/DmxUpdateFilter.h \
+    include/olad/FrameClock.h \
     include/olad/Plugin.h \
     include/olad/PluginAdaptor.h \
+    include/olad/PluginThread.h \
     include/olad/Port.h \
     include/olad/PortBroker.h \
     include/olad/PortConstants.h \
@@ -102,6 +102,26 @@ class AbstractPlugin {
 
   virtual void ConflictsWith(std::set<ola_plugin_id> *conflict_set) const = 0;
 
+  /**
+   * @brief Check if this plugin can run in its own thread.
+   * @return true if the plugin only talks to olad through the PluginAdaptor,
+   *   its devices and its ports.
+   */
+  virtual bool SupportsThreads() const = 0;
+
+  /**
+   * @brief Set the thread this plugin runs in.
+   * @param thread the PluginThread, or NULL if the plugin runs in the main
+   *   thread.
+   */
+  virtual void SetThread(class PluginThread *thread) = 0;
+
+  /**
+   * @brief Get the thread this plugin runs in.
+   * @return the PluginThread, or NULL if the plugin runs in the main thread.
+   */
+  virtual class PluginThread *GetThread() const = 0;
+
   // used to sort plugins
   virtual bool operator<(const AbstractPlugin &other) const = 0;
 };
@@ -121,7 +141,8 @@ class Plugin: public AbstractPlugin {
     AbstractPlugin(),
     m_plugin_adaptor(plugin_adaptor),
     m_preferences(NULL),
-    m_enabled(false) {
+    m_enabled(false),
+    m_thread(NULL) {
   }
   virtual ~Plugin() {}
 
@@ -145,6 +166,11 @@ class Plugin: public AbstractPlugin {
   // by default we don't conflict with any other plugins
   virtual void ConflictsWith(std::set<ola_plugin_id>*) const {}
 
+  // by default plugins run in the main thread
+  virtual bool SupportsThreads() const { return false; }
+  void SetThread(class PluginThread *thread) { m_thread = thread; }
+  class PluginThread *GetThread() const { return m_thread; }
+
   bool operator<(const AbstractPlugin &other) const {
     return Id() < other.Id();
   }
@@ -164,6 +190,7 @@ class Plugin: public AbstractPlugin {
 
  private:
   bool m_enabled;  // are we running
+  class PluginThread *m_thread;
 
   DISALLOW_COPY_AND_ASSIGN(Plugin);
 };
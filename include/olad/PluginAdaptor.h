@@ -48,13 +48,16 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
    * @param preferences_factory pointer to the PreferencesFactory object
    * @param port_broker pointer to the PortBroker object
    * @param instance_name the instance name of this OlaServer
+   * @param frame_clock the FrameClock the universes write their output ports
+   *   on, or NULL if they write as soon as new data arrives.
    */
   PluginAdaptor(class DeviceManager *device_manager,
                 ola::io::SelectServerInterface *select_server,
                 ExportMap *export_map,
                 class PreferencesFactory *preferences_factory,
                 class PortBrokerInterface *port_broker,
-                const std::string *instance_name);
+                const std::string *instance_name,
+                class FrameClock *frame_clock = NULL);
 
   // The following methods are part of the SelectServerInterface
   bool AddReadDescriptor(ola::io::ReadFileDescriptor *descriptor);
@@ -125,6 +128,14 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
     return m_port_broker;
   }
 
+  /**
+   * @brief Return the clock the universes write their output ports on.
+   * @return the FrameClock, or NULL if the output ports are written as soon as
+   *   new data arrives. The clock runs in the main thread, so this is always
+   *   NULL in a plugin thread.
+   */
+  class FrameClock *GetFrameClock() const;
+
   void DrainCallbacks();
 
  private:
@@ -134,6 +145,12 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
   class PreferencesFactory *m_preferences_factory;
   class PortBrokerInterface *m_port_broker;
   const std::string *m_instance_name;
+  class FrameClock *m_frame_clock;
+
+  ola::io::SelectServerInterface *CurrentSelectServer() const;
+  static bool UnregisterInMainThread(DeviceManager *device_manager,
+                                     class PluginThread *thread,
+                                     class AbstractDevice *device);
 
   DISALLOW_COPY_AND_ASSIGN(PluginAdaptor);
 };
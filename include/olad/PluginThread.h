@@ -0,0 +1,270 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThread.h
+ * Runs a plugin in its own thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_PLUGINTHREAD_H_
+#define INCLUDE_OLAD_PLUGINTHREAD_H_
+
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/SelectServer.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMControllerInterface.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SPSCQueue.h>
+#include <ola/thread/Thread.h>
+#include <ola/timecode/TimeCode.h>
+
+#include <deque>
+#include <string>
+
+namespace ola {
+
+namespace rpc {
+class RpcController;
+}
+
+class AbstractDevice;
+class AbstractPlugin;
+class BasicInputPort;
+class OutputPort;
+class Port;
+class Universe;
+
+/**
+ * @brief Runs a plugin, and everything it registers with the PluginAdaptor,
+ * in a thread with its own SelectServer.
+ *
+ * The universes and the rest of olad stay in the main thread. DMX frames
+ * are passed between the threads with lock free queues, everything else,
+ * like patching, RDM and device configuration, is run synchronously in the
+ * other thread.
+ *
+ * While one thread is blocked waiting for the other, it runs any calls the
+ * other thread makes back to it. This means the plugin code and the main
+ * thread code are never run at the same time for a single call, and a call
+ * can't deadlock.
+ *
+ * Plugins opt in with AbstractPlugin::SupportsThreads(). Plugins that
+ * support threads must only use the PluginAdaptor, ports and devices to talk
+ * to olad.
+ */
+class PluginThread : private ola::thread::Thread {
+ public:
+  /**
+   * @brief Create a new PluginThread.
+   * @param plugin the plugin to run.
+   * @param main_ss the SelectServer of the main thread.
+   * @param export_map the ExportMap to use for the drop counters, may be
+   *   NULL.
+   */
+  PluginThread(AbstractPlugin *plugin,
+               ola::io::SelectServerInterface *main_ss,
+               ExportMap *export_map);
+  ~PluginThread();
+
+  /**
+   * @brief Start the thread.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the thread, this blocks until the thread exits.
+   *
+   * Any frames still in the queues are discarded.
+   */
+  void Stop();
+
+  /**
+   * @brief The SelectServer the plugin uses.
+   */
+  ola::io::SelectServer *GetSelectServer() { return &m_ss; }
+
+  // Called from the main thread
+  /**
+   * @brief Run a callback in the plugin thread and wait for it to complete.
+   */
+  void RunInPluginThread(BaseCallback0<void> *callback);
+  bool RunInPluginThread(BaseCallback0<bool> *callback);
+
+  /**
+   * @brief Queue a frame for an output port.
+   * @returns false if the queue was full and the frame was dropped.
+   */
+  bool QueueOutput(OutputPort *port, const DmxBuffer &buffer,
+                   uint8_t priority, unsigned int first_changed_slot,
+                   unsigned int changed_slot_count, bool changes_only);
+
+  /**
+   * @brief Pass the frames received by the plugin to the input ports.
+   */
+  void DeliverInput();
+
+  // Called from the plugin thread
+  /**
+   * @brief Run a callback in the main thread and wait for it to complete.
+   */
+  void RunInMainThread(BaseCallback0<void> *callback);
+  bool RunInMainThread(BaseCallback0<bool> *callback);
+
+  /**
+   * @brief Queue a frame received by an input port.
+   */
+  void QueueInput(BasicInputPort *port, const DmxBuffer &buffer,
+                  uint8_t priority, const TimeStamp &received);
+
+  /**
+   * @brief Write the queued frames to the output ports.
+   */
+  void DeliverOutput();
+
+  /**
+   * @brief Wrap a callback so it runs in the main thread.
+   *
+   * This is used for RDM requests from the main thread, which may complete
+   * at any time.
+   */
+  ola::rdm::RDMCallback *MainThreadCallback(ola::rdm::RDMCallback *callback);
+  ola::rdm::RDMDiscoveryCallback *MainThreadCallback(
+      ola::rdm::RDMDiscoveryCallback *callback);
+  BaseCallback0<void> *MainThreadCallback(BaseCallback0<void> *callback);
+
+  /**
+   * @brief Wrap a callback so it runs in the plugin thread.
+   *
+   * This is used for RDM requests from input ports.
+   */
+  ola::rdm::RDMCallback *PluginThreadCallback(
+      ola::rdm::RDMCallback *callback);
+  ola::rdm::RDMDiscoveryCallback *PluginThreadCallback(
+      ola::rdm::RDMDiscoveryCallback *callback);
+
+  /**
+   * @brief Return the PluginThread we're running in.
+   * @returns the PluginThread, or NULL if this is the main thread.
+   */
+  static PluginThread *Current();
+
+  /**
+   * @brief Return the PluginThread for a device.
+   * @returns the PluginThread, or NULL if the device's plugin runs in the
+   *   main thread.
+   */
+  static PluginThread *ForDevice(const AbstractDevice *device);
+
+  // Helpers for the main thread, these call into a port or device in the
+  // thread of the plugin that owns it.
+  static bool SetUniverse(Port *port, Universe *universe);
+  static void WriteDMX(OutputPort *port, const DmxBuffer &buffer,
+                       uint8_t priority);
+  static void WriteDMXChanges(OutputPort *port, const DmxBuffer &buffer,
+                              unsigned int first_slot,
+                              unsigned int slot_count, uint8_t priority);
+  static void UniverseNameChanged(OutputPort *port, const std::string &name);
+  static void SendRDMRequest(OutputPort *port,
+                             ola::rdm::RDMRequest *request,
+                             ola::rdm::RDMCallback *callback);
+  static void RunDiscovery(OutputPort *port, bool full,
+                           ola::rdm::RDMDiscoveryCallback *on_complete);
+  static bool SendTimeCode(OutputPort *port,
+                           const ola::timecode::TimeCode &timecode);
+  static void Configure(AbstractDevice *device,
+                        ola::rpc::RpcController *controller,
+                        const std::string &request,
+                        std::string *response,
+                        BaseCallback0<void> *done);
+
+  // The plugin thread may change these at any time, so they're read in that
+  // thread.
+  static std::string PluginDescription(const AbstractPlugin *plugin);
+  static std::string PortDescription(const Port *port);
+
+  static const unsigned int QUEUE_SIZE = 256;
+  static const char INPUT_DROPS_VAR[];
+  static const char OUTPUT_DROPS_VAR[];
+
+ protected:
+  void *Run();
+
+ private:
+  struct InputFrame {
+    BasicInputPort *port;
+    TimeStamp received;
+    uint8_t priority;
+    unsigned int length;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  };
+
+  struct OutputFrame {
+    OutputPort *port;
+    uint8_t priority;
+    bool changes_only;
+    unsigned int first_changed_slot;
+    unsigned int changed_slot_count;
+    unsigned int length;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+  };
+
+  struct PendingCall {
+    BaseCallback0<void> *callback;
+    bool done;
+  };
+
+  AbstractPlugin *m_plugin;
+  ola::io::SelectServerInterface *m_main_ss;
+  ExportMap *m_export_map;
+  ola::io::SelectServer m_ss;
+  bool m_running;
+  bool m_exited;
+
+  ola::thread::SPSCQueue<InputFrame> m_input_queue;
+  ola::thread::SPSCQueue<OutputFrame> m_output_queue;
+  // Non zero if a delivery has been scheduled in the other thread.
+  uint32_t m_input_pending;
+  uint32_t m_output_pending;
+  uint32_t m_input_drops;
+  uint32_t m_reported_input_drops;
+  DmxBuffer m_input_buffer;
+  DmxBuffer m_output_buffer;
+  Callback0<void> *m_deliver_input;
+  Callback0<void> *m_deliver_output;
+  Callback0<void> *m_run_main_calls;
+
+  // Protects m_main_calls, m_exited and the done flags.
+  ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_condition;
+  std::deque<PendingCall*> m_main_calls;
+  // The number of calls from the plugin thread the main thread is running.
+  unsigned int m_main_call_depth;
+
+  void RunPluginCall(PendingCall *call);
+  void RunMainCalls();
+  void RunMainCall(PendingCall *call);
+  void WaitFor(const bool *done);
+  void UpdateDropCounters();
+
+  DISALLOW_COPY_AND_ASSIGN(PluginThread);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_PLUGINTHREAD_H_
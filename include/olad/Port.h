@@ -27,6 +27,7 @@
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/timecode/TimeCode.h>
 #include <olad/DmxSource.h>
+#include <olad/DmxUpdateFilter.h>
 #include <olad/PluginAdaptor.h>
 #include <olad/PortConstants.h>
 #include <olad/Universe.h>
@@ -172,6 +173,32 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
    */
   virtual bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) = 0;
 
+  /**
+   * @brief Write the slots that changed since the last frame.
+   *
+   * This is called instead of WriteDMX() if the port's DmxUpdateFilter is in
+   * SEND_CHANGED_SLOTS mode. The default implementation writes the full frame.
+   * @param buffer the full DmxBuffer
+   * @param first_slot the first slot that changed
+   * @param slot_count the number of slots from first_slot that changed
+   * @param priority the priority of the DMX data
+   * @return true on success, false on failure
+   */
+  virtual bool WriteDMXChanges(const DmxBuffer &buffer,
+                               unsigned int first_slot,
+                               unsigned int slot_count,
+                               uint8_t priority) {
+    (void) first_slot;
+    (void) slot_count;
+    return WriteDMX(buffer, priority);
+  }
+
+  /**
+   * @brief Get the filter that controls which frames are written to this port.
+   * @returns the DmxUpdateFilter, or NULL if every frame is written.
+   */
+  virtual DmxUpdateFilter *UpdateFilter() { return NULL; }
+
   /**
    * @brief Called if the universe name changes
    */
@@ -222,6 +249,15 @@ class BasicInputPort: public InputPort {
   void DmxChanged();
   const DmxSource &SourceData() const { return m_dmx_source; }
 
+  /**
+   * @brief Update the source data and notify the universe.
+   *
+   * This is called by DmxChanged(), or from the main thread if the plugin runs
+   * in its own thread.
+   */
+  void UpdateSource(const DmxBuffer &buffer, const TimeStamp &received,
+                    uint8_t priority);
+
   // RDM methods, the child class provides HandleRDMResponse
   /**
    * @brief Handle an RDM Request on this port.
@@ -299,6 +335,13 @@ class BasicOutputPort: public OutputPort {
   void SetPriorityMode(port_priority_mode mode) { m_priority_mode = mode; }
   port_priority_mode GetPriorityMode() const { return m_priority_mode; }
 
+  /**
+   * @brief Return the DmxUpdateFilter for this port.
+   *
+   * Subclasses can change the filter's mode to skip unchanged frames.
+   */
+  DmxUpdateFilter *UpdateFilter() { return &m_update_filter; }
+
   virtual void UniverseNameChanged(const std::string &new_name) {
     (void) new_name;
   }
@@ -358,6 +401,7 @@ class BasicOutputPort: public OutputPort {
   Universe *m_universe;  // the universe this port belongs to
   AbstractDevice *m_device;
   bool m_supports_rdm;
+  DmxUpdateFilter m_update_filter;
 
   DISALLOW_COPY_AND_ASSIGN(BasicOutputPort);
 };
@@ -25,12 +25,16 @@
 #include <ola/DmxBuffer.h>
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
+#include <ola/dmx/HTPMerger.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/rdm/UID.h>
 #include <ola/rdm/UIDSet.h>
+#include <ola/util/LatencyHistogram.h>
 #include <ola/util/SequenceNumber.h>
 #include <olad/DmxSource.h>
+#include <olad/DmxUpdateFilter.h>
+#include <olad/FrameClock.h>
 
 #include <set>
 #include <map>
@@ -43,16 +47,27 @@ class Client;
 class InputPort;
 class OutputPort;
 
-class Universe: public ola::rdm::RDMControllerInterface {
+class Universe: public ola::rdm::RDMControllerInterface,
+                private FrameClock::Subscriber {
  public:
     enum merge_mode {
       MERGE_HTP,
       MERGE_LTP
     };
 
+    /**
+     * @brief Create a new universe.
+     * @param uid the universe id of this universe.
+     * @param store the store this universe came from.
+     * @param export_map the ExportMap that we update.
+     * @param clock the Clock to use.
+     * @param frame_clock if not NULL, the output ports are written on the
+     *   ticks of this clock rather than as soon as new data arrives.
+     */
     Universe(unsigned int uid, class UniverseStore *store,
              ExportMap *export_map,
-             Clock *clock);
+             Clock *clock,
+             FrameClock *frame_clock = NULL);
     ~Universe();
 
     // Properties for this universe
@@ -93,6 +108,22 @@ class Universe: public ola::rdm::RDMControllerInterface {
     bool SetDMX(const DmxBuffer &buffer);
     const DmxBuffer &GetDMX() const { return m_buffer; }
 
+    /**
+     * @brief Check if the last frame differed from the one before it.
+     */
+    bool FrameChanged() const { return m_frame_changed; }
+
+    /**
+     * @brief The first slot that changed in the last frame.
+     */
+    unsigned int FirstChangedSlot() const { return m_first_changed_slot; }
+
+    /**
+     * @brief The number of slots, starting from FirstChangedSlot(), that
+     * changed in the last frame.
+     */
+    unsigned int ChangedSlotCount() const { return m_changed_slot_count; }
+
     // These are the ports we need to notify when data changes
     bool AddPort(InputPort *port);
     bool AddPort(OutputPort *port);
@@ -135,14 +166,42 @@ class Universe: public ola::rdm::RDMControllerInterface {
     unsigned int UIDCount() const;
     uint8_t GetRDMTransactionNumber();
 
+    /**
+     * @brief The latency from a frame arriving to it being written to all
+     * the output ports, in microseconds.
+     *
+     * With an ExportMap, this is cleared each time it's published, about
+     * once a second.
+     */
+    const LatencyHistogram &Latency() const { return m_latency; }
+
+    /**
+     * @brief The latency from a frame arriving to it being written to a
+     * port.
+     * @returns the histogram, or NULL if no frames have been written to the
+     *   port.
+     */
+    const LatencyHistogram *PortLatency(const OutputPort *port) const;
+
     bool operator==(const Universe &other) {
       return m_universe_id == other.UniverseId();
     }
 
     static const char K_FPS_VAR[];
+    static const char K_FRAMES_SUPPRESSED_VAR[];
+    static const char K_FRAMES_SUPPRESSED_PERCENT_VAR[];
     static const char K_MERGE_HTP_STR[];
     static const char K_MERGE_LTP_STR[];
+    static const char K_PORT_LATENCY_P50_VAR[];
+    static const char K_PORT_LATENCY_P99_VAR[];
+    static const char K_PORT_LATENCY_P999_VAR[];
+    static const char K_PORT_LATENCY_MAX_VAR[];
     static const char K_UNIVERSE_INPUT_PORT_VAR[];
+    static const char K_UNIVERSE_LATENCY_P50_VAR[];
+    static const char K_UNIVERSE_LATENCY_P99_VAR[];
+    static const char K_UNIVERSE_LATENCY_P999_VAR[];
+    static const char K_UNIVERSE_LATENCY_MAX_VAR[];
+    static const char K_UNIVERSE_MERGES_VAR[];
     static const char K_UNIVERSE_MODE_VAR[];
     static const char K_UNIVERSE_NAME_VAR[];
     static const char K_UNIVERSE_OUTPUT_PORT_VAR[];
@@ -162,6 +221,12 @@ class Universe: public ola::rdm::RDMControllerInterface {
 
     typedef std::map<Client*, bool> SourceClientMap;
 
+    struct PortLatencyStats {
+      std::string port_id;
+      LatencyHistogram histogram;
+    };
+    typedef std::map<const OutputPort*, PortLatencyStats*> PortLatencyMap;
+
     std::string m_universe_name;
     unsigned int m_universe_id;
     std::string m_universe_id_str;
@@ -178,20 +243,62 @@ class Universe: public ola::rdm::RDMControllerInterface {
     class UniverseStore *m_universe_store;
     DmxBuffer m_buffer;
     ExportMap *m_export_map;
+    // Resolved once, these are updated for every frame.
+    CounterMap *m_fps_map;
+    CounterMap::Handle m_fps_handle;
+    CounterMap *m_merges_map;
+    CounterMap::Handle m_merges_handle;
+    // This universe's entries in the suppressed frame UIntMaps.
+    unsigned int *m_frames_suppressed_var;
+    unsigned int *m_frames_suppressed_percent_var;
     std::map<ola::rdm::UID, OutputPort*> m_output_uids;
     Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
     ola::SequenceNumber<uint8_t> m_transaction_number_sequence;
+    std::vector<const DmxSource*> m_active_sources;
+    ola::dmx::HTPMerger m_merger;
+    DmxBuffer m_last_frame;
+    bool m_frame_changed;
+    unsigned int m_first_changed_slot;
+    unsigned int m_changed_slot_count;
+    uint64_t m_frames_sent;
+    uint64_t m_frames_suppressed;
+    FrameClock *m_frame_clock;
+    // Set when a frame has been requested from the frame clock.
+    bool m_output_pending;
+    // The slots that changed since the last frame was emitted.
+    bool m_pending_changed;
+    unsigned int m_pending_first_slot;
+    unsigned int m_pending_end_slot;
+    // When the oldest data in the next frame was received, this is unset if
+    // the frame didn't come from a port or client.
+    TimeStamp m_frame_received;
+    LatencyHistogram m_latency;
+    PortLatencyMap m_port_latency;
+    TimeStamp m_last_latency_publish;
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::RDMReply *reply);
     void HandleBroadcastDiscovery(broadcast_request_tracker *tracker,
                                   ola::rdm::RDMReply *reply);
     bool UpdateDependants();
+    void UpdateChangedSlots();
+    unsigned int WriteOutputPorts(bool changed, unsigned int first_slot,
+                                  unsigned int slot_count, TimeStamp *now);
+    void QueueOutput();
+    void EmitFrame();
+    DmxUpdateFilter::Action FilterFrame(DmxUpdateFilter *filter,
+                                        bool changed,
+                                        TimeStamp *now);
+    void UpdateSuppressedFrames(unsigned int sent, unsigned int suppressed);
+    void FrameReceived(const TimeStamp &received);
+    void RecordLatency(const OutputPort *port, const TimeStamp &now);
+    void PublishLatency(const TimeStamp &now);
+    void RemovePortLatency(const OutputPort *port);
     void UpdateName();
     void UpdateMode();
-    void HTPMergeSources(const std::vector<DmxSource> &sources);
+    void HTPMergeSources(const std::vector<const DmxSource*> &sources);
     bool MergeAll(const InputPort *port, const Client *client);
     void PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                OutputPort *output_port,
@@ -18,12 +18,13 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <string.h>
 #include <sys/time.h>
 #include <algorithm>
 #include <map>
-#include <memory>
 #include <vector>
 #include "ola/Logging.h"
+#include "ola/network/NetworkUtils.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/DMPHeader.h"
 #include "libs/acn/DMPPDU.h"
@@ -33,7 +34,8 @@ namespace acn {
 
 using ola::Callback0;
 using ola::acn::CID;
-using ola::io::OutputStream;
+using ola::dmx::HTPMerger;
+using ola::network::NetworkToHost;
 using std::map;
 using std::pair;
 using std::vector;
@@ -41,10 +43,20 @@ using std::vector;
 const TimeInterval DMPE131Inflator::EXPIRY_INTERVAL(2500000);
 
 
+DMPE131Inflator::DMPE131Inflator(bool ignore_preview, const Clock *clock)
+    : DMPInflator(),
+      m_ignore_preview(ignore_preview),
+      m_clock(clock ? clock : &m_system_clock),
+      m_merge_kernel(HTPMerger::BestKernel()),
+      m_expiry_tick(-1) {
+}
+
+
 DMPE131Inflator::~DMPE131Inflator() {
   UniverseHandlers::iterator iter;
   for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
+    delete iter->second->closure;
+    delete iter->second;
   }
   m_handlers.clear();
 }
@@ -62,19 +74,23 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  E131Header e131_header = headers.GetE131Header();
-  UniverseHandlers::iterator universe_iter =
-      m_handlers.find(e131_header.Universe());
-
+  const E131Header &e131_header = headers.GetE131Header();
   if (e131_header.PreviewData() && m_ignore_preview) {
     OLA_DEBUG << "Ignoring preview data";
     return true;
   }
 
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  ExpireSources(now);
+
+  UniverseHandlers::iterator universe_iter =
+      m_handlers.find(e131_header.Universe());
   if (universe_iter == m_handlers.end())
     return true;
+  universe_handler *universe_data = universe_iter->second;
 
-  DMPHeader dmp_header = headers.GetDMPHeader();
+  const DMPHeader &dmp_header = headers.GetDMPHeader();
 
   if (!dmp_header.IsVirtual() || dmp_header.IsRelative() ||
       dmp_header.Size() != TWO_BYTES ||
@@ -90,20 +106,21 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  unsigned int available_length = pdu_len;
-  std::auto_ptr<const BaseDMPAddress> address(
-      DecodeAddress(dmp_header.Size(),
-                    dmp_header.Type(),
-                    data,
-                    &available_length));
-
-  if (!address.get()) {
+  // We've checked the header, so decode the two byte range address in place
+  // rather than using DecodeAddress(), which allocates.
+  uint16_t address[3];
+  if (pdu_len < sizeof(address)) {
     OLA_INFO << "DMP address parsing failed, the length is probably too small";
     return true;
   }
-
-  if (address->Increment() != 1) {
-    OLA_INFO << "E1.31 DMP packet with increment " << address->Increment()
+  memcpy(address, data, sizeof(address));
+  const unsigned int address_start = NetworkToHost(address[0]);
+  const unsigned int address_increment = NetworkToHost(address[1]);
+  const unsigned int address_number = NetworkToHost(address[2]);
+  const unsigned int available_length = sizeof(address);
+
+  if (address_increment != 1) {
+    OLA_INFO << "E1.31 DMP packet with increment " << address_increment
       << ", disarding";
     return true;
   }
@@ -111,8 +128,8 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
   unsigned int length_remaining = pdu_len - available_length;
   int start_code = -1;
   if (e131_header.UsingRev2())
-    start_code = static_cast<int>(address->Start());
-  else if (length_remaining && address->Number())
+    start_code = static_cast<int>(address_start);
+  else if (length_remaining && address_number)
     start_code = *(data + available_length);
 
   // The only time we want to continue processing a non-0 start code is if it
@@ -122,44 +139,33 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  DmxBuffer *target_buffer;
-  if (!TrackSourceIfRequired(&universe_iter->second, headers,
-                             &target_buffer)) {
+  dmx_source *source;
+  if (!TrackSourceIfRequired(universe_data, headers, now, &source)) {
     // no need to continue processing
     return true;
   }
 
   // Reaching here means that we actually have new data and we should merge.
-  if (target_buffer && start_code == 0) {
-    unsigned int channels = std::min(length_remaining, address->Number());
-    if (e131_header.UsingRev2())
-      target_buffer->Set(data + available_length, channels);
-    else
-     target_buffer->Set(data + available_length + 1, channels - 1);
+  const uint8_t *dmx_data = NULL;
+  unsigned int dmx_length = 0;
+  if (source && start_code == 0) {
+    unsigned int channels = std::min(length_remaining, address_number);
+    if (e131_header.UsingRev2()) {
+      dmx_data = data + available_length;
+      dmx_length = channels;
+    } else {
+      dmx_data = data + available_length + 1;
+      dmx_length = channels - 1;
+    }
+    dmx_length = std::min(dmx_length,
+                          static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
   }
 
-  if (universe_iter->second.priority)
-    *universe_iter->second.priority = universe_iter->second.active_priority;
-
-  // merge the sources
-  switch (universe_iter->second.sources.size()) {
-    case 0:
-      universe_iter->second.buffer->Reset();
-      break;
-    case 1:
-      universe_iter->second.buffer->Set(
-          universe_iter->second.sources[0].buffer);
-      universe_iter->second.closure->Run();
-      break;
-    default:
-      // HTP Merge
-      universe_iter->second.buffer->Reset();
-      std::vector<dmx_source>::const_iterator source_iter =
-        universe_iter->second.sources.begin();
-      for (; source_iter != universe_iter->second.sources.end(); ++source_iter)
-        universe_iter->second.buffer->HTPMerge(source_iter->buffer);
-      universe_iter->second.closure->Run();
-  }
+  if (universe_data->priority)
+    *universe_data->priority = universe_data->active_priority;
+
+  UpdateSyncAddress(universe_data, e131_header.SyncAddress(), now);
+  MergeSources(universe_data, source, dmx_data, dmx_length);
   return true;
 }
 
@@ -181,17 +187,25 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
   UniverseHandlers::iterator iter = m_handlers.find(universe);
 
   if (iter == m_handlers.end()) {
-    universe_handler handler;
-    handler.buffer = buffer;
-    handler.closure = closure;
-    handler.active_priority = 0;
-    handler.priority = priority;
+    universe_handler *handler = new universe_handler;
+    handler->buffer = buffer;
+    handler->closure = closure;
+    handler->active_priority = 0;
+    handler->priority = priority;
+    handler->source_count = 0;
+    handler->sync_address = 0;
+    handler->hold_for_sync = false;
+    handler->sync_pending = false;
+    for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+      handler->sources[i].in_use = false;
+      handler->sources[i].generation = 0;
+    }
     m_handlers[universe] = handler;
   } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    iter->second.buffer = buffer;
-    iter->second.priority = priority;
+    Callback0<void> *old_closure = iter->second->closure;
+    iter->second->closure = closure;
+    iter->second->buffer = buffer;
+    iter->second->priority = priority;
     delete old_closure;
   }
   return true;
@@ -207,9 +221,24 @@ bool DMPE131Inflator::RemoveHandler(uint16_t universe) {
   UniverseHandlers::iterator iter = m_handlers.find(universe);
 
   if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
+    universe_handler *handler = iter->second;
     m_handlers.erase(iter);
-    delete old_closure;
+
+    // Drop any expiry entries which point to this handler.
+    for (unsigned int i = 0; i < EXPIRY_WHEEL_SIZE; i++) {
+      ExpiryBucket &bucket = m_expiry_wheel[i];
+      ExpiryBucket::iterator out = bucket.begin();
+      ExpiryBucket::const_iterator entry = bucket.begin();
+      for (; entry != bucket.end(); ++entry) {
+        if (entry->handler != handler) {
+          *out++ = *entry;
+        }
+      }
+      bucket.erase(out, bucket.end());
+    }
+
+    delete handler->closure;
+    delete handler;
     return true;
   }
   return false;
@@ -236,44 +265,27 @@ void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
  * priority.
  * @param universe_data the universe_handler struct for this universe,
  * @param HeaderSet the set of headers in this packet
- * @param buffer, if set to a non-NULL pointer, the caller should copy the data
- * in the buffer.
+ * @param now the current time
+ * @param source, if set to a non-NULL pointer, the caller should merge the
+ * data from the packet for this source.
  * @returns true if we should remerge the data, false otherwise.
  */
 bool DMPE131Inflator::TrackSourceIfRequired(
     universe_handler *universe_data,
     const HeaderSet &headers,
-    DmxBuffer **buffer) {
+    const TimeStamp &now,
+    dmx_source **source) {
 
-  *buffer = NULL;  // default the buffer to NULL
-  ola::TimeStamp now;
-  m_clock.CurrentTime(&now);
+  *source = NULL;  // default the source to NULL
   const E131Header &e131_header = headers.GetE131Header();
   uint8_t priority = e131_header.Priority();
-  vector<dmx_source> &sources = universe_data->sources;
-  vector<dmx_source>::iterator iter = sources.begin();
-
-  while (iter != sources.end()) {
-    if (iter->cid != headers.GetRootHeader().GetCid()) {
-      TimeStamp expiry_time = iter->last_heard_from + EXPIRY_INTERVAL;
-      if (now > expiry_time) {
-        OLA_INFO << "source " << iter->cid.ToString() << " has expired";
-        iter = sources.erase(iter);
-        continue;
-      }
-    }
-    iter++;
-  }
-
-  if (sources.empty())
-    universe_data->active_priority = 0;
+  const CID &cid = headers.GetRootHeader().GetCid();
+  uint8_t packed_cid[CID::CID_LENGTH];
+  cid.Pack(packed_cid);
 
-  for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    if (iter->cid == headers.GetRootHeader().GetCid())
-      break;
-  }
+  dmx_source *tracked = FindSource(universe_data, packed_cid);
 
-  if (iter == sources.end()) {
+  if (!tracked) {
     // This is an untracked source
     if (e131_header.StreamTerminated() ||
         priority < universe_data->active_priority)
@@ -284,72 +296,351 @@ bool DMPE131Inflator::TrackSourceIfRequired(
         e131_header.Universe() << " from " <<
         static_cast<int>(universe_data->active_priority) << " to " <<
         static_cast<int>(priority);
-      sources.clear();
+      RemoveAllSources(universe_data);
       universe_data->active_priority = priority;
     }
 
-    if (sources.size() == MAX_MERGE_SOURCES) {
+    if (universe_data->source_count == MAX_MERGE_SOURCES) {
       // TODO(simon): flag this in the export map
       OLA_WARN << "Max merge sources reached for universe " <<
-        e131_header.Universe() << ", " <<
-        headers.GetRootHeader().GetCid().ToString() << " won't be tracked";
+        e131_header.Universe() << ", " << cid.ToString() <<
+        " won't be tracked";
         return false;
     } else {
-      OLA_INFO << "Added new E1.31 source: " <<
-        headers.GetRootHeader().GetCid().ToString();
-      dmx_source new_source;
-      new_source.cid = headers.GetRootHeader().GetCid();
-      new_source.sequence = e131_header.Sequence();
-      new_source.last_heard_from = now;
-      iter = sources.insert(sources.end(), new_source);
-      *buffer = &iter->buffer;
+      OLA_INFO << "Added new E1.31 source: " << cid.ToString();
+      tracked = AddSource(universe_data, packed_cid);
+      tracked->sequence = e131_header.Sequence();
+      tracked->last_heard_from = now;
+      ScheduleExpiry(universe_data, tracked);
+      *source = tracked;
       return true;
     }
 
   } else {
     // We already know about this one, check the seq #
     int8_t seq_diff = static_cast<int8_t>(e131_header.Sequence() -
-                                          iter->sequence);
+                                          tracked->sequence);
     if (seq_diff <= 0 && seq_diff > SEQUENCE_DIFF_THRESHOLD) {
       OLA_INFO << "Old packet received, ignoring, this # " <<
         static_cast<int>(e131_header.Sequence()) << ", last " <<
-        static_cast<int>(iter->sequence);
+        static_cast<int>(tracked->sequence);
       return false;
     }
-    iter->sequence = e131_header.Sequence();
+    tracked->sequence = e131_header.Sequence();
 
     if (e131_header.StreamTerminated()) {
-      OLA_INFO << "CID " << headers.GetRootHeader().GetCid().ToString() <<
+      OLA_INFO << "CID " << cid.ToString() <<
         " sent a termination for universe " << e131_header.Universe();
-      sources.erase(iter);
-      if (sources.empty())
-        universe_data->active_priority = 0;
+      RemoveSource(universe_data, tracked);
       // We need to trigger a merge here else the buffer will be stale, we keep
-      // the buffer as NULL though so we don't use the data.
+      // the source as NULL though so we don't use the data.
       return true;
     }
 
-    iter->last_heard_from = now;
+    // The expiry wheel checks this when the source's entry comes due.
+    tracked->last_heard_from = now;
     if (priority < universe_data->active_priority) {
-      if (sources.size() == 1) {
+      if (universe_data->source_count == 1) {
         universe_data->active_priority = priority;
       } else {
-        sources.erase(iter);
+        RemoveSource(universe_data, tracked);
         return true;
       }
     } else if (priority > universe_data->active_priority) {
       // new active priority
       universe_data->active_priority = priority;
-      if (sources.size() != 1) {
-        // clear all sources other than this one
-        dmx_source this_source = *iter;
-        sources.clear();
-        iter = sources.insert(sources.end(), this_source);
-      }
+      // clear all sources other than this one
+      RemoveAllSources(universe_data, tracked);
     }
-    *buffer = &iter->buffer;
+    *source = tracked;
     return true;
   }
 }
+
+
+/*
+ * Merge the sources for a universe and run the closure.
+ * @param universe_data the universe to merge
+ * @param source the source the data belongs to, or NULL if there's no new data
+ * @param data the new DMX data, this is still in the packet.
+ * @param length the length of the new data
+ */
+void DMPE131Inflator::MergeSources(universe_handler *universe_data,
+                                   dmx_source *source,
+                                   const uint8_t *data,
+                                   unsigned int length) {
+  DmxBuffer *output = universe_data->buffer;
+
+  if (universe_data->source_count == 0) {
+    output->Reset();
+    return;
+  }
+
+  if (universe_data->source_count == 1) {
+    if (data) {
+      // The common case, copy straight from the packet.
+      output->Set(data, length);
+      source->data_valid = false;
+    } else {
+      for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+        const dmx_source &remaining = universe_data->sources[i];
+        if (remaining.in_use && remaining.data_valid) {
+          output->Set(remaining.data, remaining.length);
+        }
+      }
+    }
+    RunHandler(universe_data);
+    return;
+  }
+
+  // A source that was merged on its own only has its data in the output
+  // buffer, so save it before the buffer is overwritten.
+  for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+    dmx_source &other = universe_data->sources[i];
+    if (other.in_use && !other.data_valid) {
+      unsigned int other_length = DMX_UNIVERSE_SIZE;
+      output->Get(other.data, &other_length);
+      other.length = static_cast<uint16_t>(other_length);
+      other.data_valid = true;
+    }
+  }
+
+  if (data) {
+    memcpy(source->data, data, length);
+    source->length = static_cast<uint16_t>(length);
+    source->data_valid = true;
+  }
+
+  // HTP Merge
+  const uint8_t *source_data[SOURCE_TABLE_SIZE];
+  unsigned int source_lengths[SOURCE_TABLE_SIZE];
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+    const dmx_source &other = universe_data->sources[i];
+    if (other.in_use) {
+      source_data[count] = other.data;
+      source_lengths[count] = other.length;
+      count++;
+    }
+  }
+  uint8_t merged[DMX_UNIVERSE_SIZE];
+  const unsigned int merged_length = HTPMerger::MergeSlots(
+      m_merge_kernel, source_data, source_lengths, count, merged);
+  output->Set(merged, merged_length);
+  RunHandler(universe_data);
+}
+
+
+/*
+ * Track the synchronization address used by a universe.
+ */
+void DMPE131Inflator::UpdateSyncAddress(universe_handler *universe_data,
+                                        uint16_t sync_address,
+                                        const TimeStamp &now) {
+  if (sync_address != universe_data->sync_address) {
+    universe_data->sync_address = sync_address;
+    // Don't hold anything back until the first sync packet arrives.
+    universe_data->last_sync = TimeStamp();
+    if (sync_address && m_sync_address_handler.get()) {
+      m_sync_address_handler->Run(sync_address);
+    }
+  }
+
+  // If the sync packets stop, go back to using the data as it arrives.
+  universe_data->hold_for_sync = (
+      sync_address && universe_data->last_sync.IsSet() &&
+      now - universe_data->last_sync < EXPIRY_INTERVAL);
+  if (!universe_data->hold_for_sync) {
+    universe_data->sync_pending = false;
+  }
+}
+
+
+/*
+ * Tell the handler there's new data, unless it's waiting for a sync packet.
+ */
+void DMPE131Inflator::RunHandler(universe_handler *universe_data) {
+  if (universe_data->hold_for_sync) {
+    universe_data->sync_pending = true;
+  } else {
+    universe_data->closure->Run();
+  }
+}
+
+
+void DMPE131Inflator::HandleSync(uint16_t sync_address) {
+  if (!sync_address) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  UniverseHandlers::iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    universe_handler *universe_data = iter->second;
+    if (universe_data->sync_address != sync_address) {
+      continue;
+    }
+    universe_data->last_sync = now;
+    universe_data->hold_for_sync = true;
+    if (universe_data->sync_pending) {
+      universe_data->sync_pending = false;
+      universe_data->closure->Run();
+    }
+  }
+}
+
+
+/*
+ * Find a tracked source.
+ * @param universe_data the universe to search
+ * @param cid the packed CID of the source
+ * @returns the source, or NULL if it's not tracked.
+ */
+DMPE131Inflator::dmx_source *DMPE131Inflator::FindSource(
+    universe_handler *universe_data,
+    const uint8_t *cid) {
+  if (!universe_data->source_count) {
+    return NULL;
+  }
+
+  // Slots are freed without moving the other entries, so we can't stop at
+  // the first empty slot. The table is small enough that checking every slot
+  // on a miss is cheap.
+  const unsigned int start = CIDHash(cid);
+  for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+    dmx_source *source =
+        &universe_data->sources[(start + i) % SOURCE_TABLE_SIZE];
+    if (source->in_use && memcmp(source->cid, cid, CID::CID_LENGTH) == 0) {
+      return source;
+    }
+  }
+  return NULL;
+}
+
+
+/*
+ * Add a source to a universe, the caller must check there is space.
+ */
+DMPE131Inflator::dmx_source *DMPE131Inflator::AddSource(
+    universe_handler *universe_data,
+    const uint8_t *cid) {
+  const unsigned int start = CIDHash(cid);
+  for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+    dmx_source *source =
+        &universe_data->sources[(start + i) % SOURCE_TABLE_SIZE];
+    if (!source->in_use) {
+      memcpy(source->cid, cid, CID::CID_LENGTH);
+      source->in_use = true;
+      source->data_valid = true;
+      source->length = 0;
+      source->generation++;
+      universe_data->source_count++;
+      return source;
+    }
+  }
+  return NULL;
+}
+
+
+void DMPE131Inflator::RemoveSource(universe_handler *universe_data,
+                                   dmx_source *source) {
+  source->in_use = false;
+  universe_data->source_count--;
+  if (!universe_data->source_count)
+    universe_data->active_priority = 0;
+}
+
+
+/*
+ * Remove all sources from a universe.
+ * @param universe_data the universe
+ * @param except if not NULL, this source is kept.
+ */
+void DMPE131Inflator::RemoveAllSources(universe_handler *universe_data,
+                                       const dmx_source *except) {
+  for (unsigned int i = 0; i < SOURCE_TABLE_SIZE; i++) {
+    dmx_source *source = &universe_data->sources[i];
+    if (source->in_use && source != except) {
+      source->in_use = false;
+      universe_data->source_count--;
+    }
+  }
+}
+
+
+/*
+ * Add an entry to the expiry wheel for when this source would expire.
+ */
+void DMPE131Inflator::ScheduleExpiry(universe_handler *universe_data,
+                                     dmx_source *source) {
+  // Round up, so the entry never comes due before the source expires.
+  int64_t tick = ExpiryTick(source->last_heard_from + EXPIRY_INTERVAL) + 1;
+  expiry_entry entry = {
+    universe_data,
+    static_cast<uint8_t>(source - universe_data->sources),
+    source->generation
+  };
+  m_expiry_wheel[tick % EXPIRY_WHEEL_SIZE].push_back(entry);
+}
+
+
+/*
+ * Advance the expiry wheel and remove any sources we haven't heard from
+ * within EXPIRY_INTERVAL. Sources that have sent data since their entry was
+ * added are moved to a later bucket.
+ */
+void DMPE131Inflator::ExpireSources(const TimeStamp &now) {
+  const int64_t tick = ExpiryTick(now);
+  if (m_expiry_tick < 0) {
+    m_expiry_tick = tick;
+  } else if (tick - m_expiry_tick > EXPIRY_WHEEL_SIZE) {
+    // The clock jumped, every bucket needs to be checked once.
+    m_expiry_tick = tick - EXPIRY_WHEEL_SIZE;
+  }
+
+  while (m_expiry_tick < tick) {
+    m_expiry_tick++;
+    ExpiryBucket &bucket = m_expiry_wheel[m_expiry_tick % EXPIRY_WHEEL_SIZE];
+    if (bucket.empty()) {
+      continue;
+    }
+
+    // Entries may be rescheduled into this bucket if we're catching up, so
+    // work from a copy. Swapping keeps the capacity of both vectors.
+    m_due_entries.swap(bucket);
+    ExpiryBucket::const_iterator iter = m_due_entries.begin();
+    for (; iter != m_due_entries.end(); ++iter) {
+      universe_handler *universe_data = iter->handler;
+      dmx_source *source = &universe_data->sources[iter->slot];
+      if (!source->in_use || source->generation != iter->generation) {
+        continue;
+      }
+
+      if (now > source->last_heard_from + EXPIRY_INTERVAL) {
+        uint8_t cid[CID::CID_LENGTH];
+        memcpy(cid, source->cid, sizeof(cid));
+        OLA_INFO << "source " << CID::FromData(cid).ToString()
+                 << " has expired";
+        RemoveSource(universe_data, source);
+      } else {
+        ScheduleExpiry(universe_data, source);
+      }
+    }
+    m_due_entries.clear();
+  }
+}
+
+
+unsigned int DMPE131Inflator::CIDHash(const uint8_t *cid) {
+  // CIDs are UUIDs, so the bytes are already well distributed.
+  return (cid[CID::CID_LENGTH - 1] ^ cid[0]) % SOURCE_TABLE_SIZE;
+}
+
+
+int64_t DMPE131Inflator::ExpiryTick(const TimeStamp &time) {
+  return (static_cast<int64_t>(time.Seconds()) * 1000 +
+          time.MicroSeconds() / 1000) / EXPIRY_TICK_MS;
+}
 }  // namespace acn
 }  // namespace ola
@@ -23,10 +23,14 @@
 #define LIBS_ACN_DMPE131INFLATOR_H_
 
 #include <map>
+#include <memory>
 #include <vector>
 #include "ola/Clock.h"
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
+#include "ola/dmx/HTPMerger.h"
 #include "libs/acn/DMPInflator.h"
 
 namespace ola {
@@ -36,18 +40,39 @@ class DMPE131Inflator: public DMPInflator {
   friend class DMPE131InflatorTest;
 
  public:
-    explicit DMPE131Inflator(bool ignore_preview):
-      DMPInflator(),
-      m_ignore_preview(ignore_preview) {
-    }
+    /*
+     * @param ignore_preview true if preview data should be dropped.
+     * @param clock the clock used to expire sources, if NULL the system
+     *   clock is used.
+     */
+    explicit DMPE131Inflator(bool ignore_preview,
+                             const ola::Clock *clock = NULL);
     ~DMPE131Inflator();
 
     bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
                     uint8_t *priority, ola::Callback0<void> *handler);
     bool RemoveHandler(uint16_t universe);
+    bool HasHandler(uint16_t universe) const {
+      return m_handlers.find(universe) != m_handlers.end();
+    }
 
     void RegisteredUniverses(std::vector<uint16_t> *universes);
 
+    /*
+     * Called when a synchronization packet arrives. Data for universes that
+     * are synchronized to this address is held until then.
+     */
+    void HandleSync(uint16_t sync_address);
+
+    /*
+     * Set the callback that's run when a universe starts using a new
+     * synchronization address, so the caller can listen for the sync
+     * packets. Ownership is transferred.
+     */
+    void SetSyncAddressHandler(ola::Callback1<void, uint16_t> *handler) {
+      m_sync_address_handler.reset(handler);
+    }
+
  protected:
     virtual bool HandlePDUData(uint32_t vector,
                                const HeaderSet &headers,
@@ -55,11 +80,27 @@ class DMPE131Inflator: public DMPInflator {
                                unsigned int pdu_len);
 
  private:
+    enum {
+      // The source table for each universe is a fixed size hash table, keyed
+      // by the CID, so tracking sources doesn't allocate.
+      SOURCE_TABLE_SIZE = 8,
+      // The number of buckets in the expiry wheel, this must cover more than
+      // EXPIRY_INTERVAL.
+      EXPIRY_WHEEL_SIZE = 16
+    };
+
     typedef struct {
-      ola::acn::CID cid;
+      uint8_t cid[CID::CID_LENGTH];
+      bool in_use;
+      // False if the data only exists in the universe's buffer. This happens
+      // when there's a single source, since it's merged straight from the
+      // packet.
+      bool data_valid;
       uint8_t sequence;
+      uint16_t length;
+      uint32_t generation;
       TimeStamp last_heard_from;
-      DmxBuffer buffer;
+      uint8_t data[DMX_UNIVERSE_SIZE];
     } dmx_source;
 
     typedef struct {
@@ -67,18 +108,62 @@ class DMPE131Inflator: public DMPInflator {
       Callback0<void> *closure;
       uint8_t active_priority;
       uint8_t *priority;
-      std::vector<dmx_source> sources;
+      uint8_t source_count;
+      // The sync address of the last packet, and when we last got a sync
+      // packet for it. Data is only held while sync packets are arriving.
+      uint16_t sync_address;
+      bool hold_for_sync;
+      bool sync_pending;
+      TimeStamp last_sync;
+      dmx_source sources[SOURCE_TABLE_SIZE];
     } universe_handler;
 
-    typedef std::map<uint16_t, universe_handler> UniverseHandlers;
+    // An entry in the expiry timer wheel.
+    typedef struct {
+      universe_handler *handler;
+      uint8_t slot;
+      uint32_t generation;
+    } expiry_entry;
+
+    typedef std::map<uint16_t, universe_handler*> UniverseHandlers;
+    typedef std::vector<expiry_entry> ExpiryBucket;
 
     UniverseHandlers m_handlers;
     bool m_ignore_preview;
-    ola::Clock m_clock;
+    ola::Clock m_system_clock;
+    const ola::Clock *m_clock;
+    const ola::dmx::HTPMerger::Kernel m_merge_kernel;
+    ExpiryBucket m_expiry_wheel[EXPIRY_WHEEL_SIZE];
+    ExpiryBucket m_due_entries;
+    int64_t m_expiry_tick;
+    std::auto_ptr<ola::Callback1<void, uint16_t> > m_sync_address_handler;
 
     bool TrackSourceIfRequired(universe_handler *universe_data,
                                const HeaderSet &headers,
-                               DmxBuffer **buffer);
+                               const TimeStamp &now,
+                               dmx_source **source);
+    void MergeSources(universe_handler *universe_data,
+                      dmx_source *source,
+                      const uint8_t *data,
+                      unsigned int length);
+    void UpdateSyncAddress(universe_handler *universe_data,
+                           uint16_t sync_address,
+                           const TimeStamp &now);
+    void RunHandler(universe_handler *universe_data);
+
+    dmx_source *FindSource(universe_handler *universe_data,
+                           const uint8_t *cid);
+    dmx_source *AddSource(universe_handler *universe_data,
+                          const uint8_t *cid);
+    void RemoveSource(universe_handler *universe_data, dmx_source *source);
+    void RemoveAllSources(universe_handler *universe_data,
+                          const dmx_source *except = NULL);
+
+    void ScheduleExpiry(universe_handler *universe_data, dmx_source *source);
+    void ExpireSources(const TimeStamp &now);
+
+    static unsigned int CIDHash(const uint8_t *cid);
+    static int64_t ExpiryTick(const TimeStamp &time);
 
     // The max number of sources we'll track per universe.
     static const uint8_t MAX_MERGE_SOURCES = 6;
@@ -88,6 +173,8 @@ class DMPE131Inflator: public DMPInflator {
     static const int8_t SEQUENCE_DIFF_THRESHOLD = -20;
     // expire sources after 2.5s
     static const TimeInterval EXPIRY_INTERVAL;
+    // The resolution of the expiry wheel.
+    static const unsigned int EXPIRY_TICK_MS = 250;
 };
 }  // namespace acn
 }  // namespace ola
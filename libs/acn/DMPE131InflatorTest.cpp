@@ -0,0 +1,401 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DMPE131InflatorTest.cpp
+ * Test fixture for the DMPE131Inflator class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/DMPHeader.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/HeaderSet.h"
+#include "libs/acn/RootHeader.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::string;
+
+class DMPE131InflatorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DMPE131InflatorTest);
+  CPPUNIT_TEST(testSingleSource);
+  CPPUNIT_TEST(testHTPMerge);
+  CPPUNIT_TEST(testPriorities);
+  CPPUNIT_TEST(testTermination);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testMaxSources);
+  CPPUNIT_TEST(testSync);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    DMPE131InflatorTest()
+        : m_inflator(true, &m_clock),
+          m_priority(0),
+          m_updates(0),
+          m_sync_address(0) {
+    }
+
+    void setUp();
+    void tearDown();
+
+    void testSingleSource();
+    void testHTPMerge();
+    void testPriorities();
+    void testTermination();
+    void testExpiry();
+    void testMaxSources();
+    void testSync();
+
+ private:
+    MockClock m_clock;
+    DMPE131Inflator m_inflator;
+    DmxBuffer m_buffer;
+    uint8_t m_priority;
+    unsigned int m_updates;
+    uint16_t m_sync_address;
+
+    void NewData() { m_updates++; }
+    void NewSyncAddress(uint16_t sync_address) {
+      m_sync_address = sync_address;
+    }
+
+    void SendData(const CID &cid, uint8_t sequence, uint8_t priority,
+                  const string &data, bool terminated = false,
+                  uint16_t sync_address = 0);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DMPE131InflatorTest);
+
+static const uint16_t UNIVERSE = 1;
+
+
+void DMPE131InflatorTest::setUp() {
+  m_updates = 0;
+  m_inflator.SetHandler(
+      UNIVERSE, &m_buffer, &m_priority,
+      NewCallback(this, &DMPE131InflatorTest::NewData));
+}
+
+
+void DMPE131InflatorTest::tearDown() {
+  m_inflator.RemoveHandler(UNIVERSE);
+}
+
+
+/*
+ * Pass a DMP PDU to the inflator, like the E131Inflator would.
+ */
+void DMPE131InflatorTest::SendData(const CID &cid,
+                                   uint8_t sequence,
+                                   uint8_t priority,
+                                   const string &data,
+                                   bool terminated,
+                                   uint16_t sync_address) {
+  DmxBuffer buffer;
+  buffer.SetFromString(data);
+
+  HeaderSet headers;
+  RootHeader root_header;
+  root_header.SetCid(cid);
+  headers.SetRootHeader(root_header);
+  E131Header e131_header("source", priority, sequence, UNIVERSE, false,
+                         terminated);
+  e131_header.SetSyncAddress(sync_address);
+  headers.SetE131Header(e131_header);
+  headers.SetDMPHeader(DMPHeader(true, false, RANGE_EQUAL, TWO_BYTES));
+
+  // The range address, the start code and the data.
+  uint8_t pdu_data[6 + 1 + DMX_UNIVERSE_SIZE];
+  const uint16_t count = static_cast<uint16_t>(buffer.Size() + 1);
+  const uint8_t address[] = {0, 0, 0, 1,
+                             static_cast<uint8_t>(count >> 8),
+                             static_cast<uint8_t>(count & 0xff)};
+  memcpy(pdu_data, address, sizeof(address));
+  pdu_data[sizeof(address)] = 0;
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(pdu_data + sizeof(address) + 1, &length);
+
+  OLA_ASSERT_TRUE(m_inflator.HandlePDUData(
+      ola::acn::DMP_SET_PROPERTY_VECTOR, headers, pdu_data,
+      static_cast<unsigned int>(sizeof(address) + 1 + length)));
+}
+
+
+/*
+ * Check a single source, including the sequence number checks.
+ */
+void DMPE131InflatorTest::testSingleSource() {
+  CID cid = CID::Generate();
+  SendData(cid, 1, 100, "1,2,3");
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_EQ(string("1,2,3"), m_buffer.ToString());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_priority);
+
+  SendData(cid, 2, 100, "4,5,6,7");
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_EQ(string("4,5,6,7"), m_buffer.ToString());
+
+  // Old packets are ignored
+  SendData(cid, 2, 100, "9");
+  SendData(cid, 0, 100, "9");
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_EQ(string("4,5,6,7"), m_buffer.ToString());
+
+  // But a large jump is accepted
+  SendData(cid, 200, 100, "8,8");
+  OLA_ASSERT_EQ(3u, m_updates);
+  OLA_ASSERT_EQ(string("8,8"), m_buffer.ToString());
+
+  // Data for other universes is ignored
+  m_inflator.RemoveHandler(UNIVERSE);
+  SendData(cid, 201, 100, "1");
+  OLA_ASSERT_EQ(3u, m_updates);
+}
+
+
+/*
+ * Check sources at the same priority are merged.
+ */
+void DMPE131InflatorTest::testHTPMerge() {
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+  CID cid3 = CID::Generate();
+
+  SendData(cid1, 1, 100, "10,0,50");
+  OLA_ASSERT_EQ(string("10,0,50"), m_buffer.ToString());
+
+  SendData(cid2, 1, 100, "0,20,40,5");
+  OLA_ASSERT_EQ(string("10,20,50,5"), m_buffer.ToString());
+
+  SendData(cid1, 2, 100, "0,30");
+  OLA_ASSERT_EQ(string("0,30,40,5"), m_buffer.ToString());
+
+  SendData(cid3, 1, 100, "1,1,1,1,1,1");
+  OLA_ASSERT_EQ(string("1,30,40,5,1,1"), m_buffer.ToString());
+
+  SendData(cid2, 2, 100, "");
+  OLA_ASSERT_EQ(string("1,30,1,1,1,1"), m_buffer.ToString());
+  OLA_ASSERT_EQ(5u, m_updates);
+}
+
+
+/*
+ * Check the highest priority sources win.
+ */
+void DMPE131InflatorTest::testPriorities() {
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+  CID cid3 = CID::Generate();
+
+  SendData(cid1, 1, 100, "10,10");
+  SendData(cid2, 1, 100, "20");
+  OLA_ASSERT_EQ(string("20,10"), m_buffer.ToString());
+
+  // A lower priority source is ignored
+  SendData(cid3, 1, 50, "255,255");
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_EQ(string("20,10"), m_buffer.ToString());
+
+  // A higher priority source replaces the others
+  SendData(cid3, 2, 150, "5");
+  OLA_ASSERT_EQ(string("5"), m_buffer.ToString());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_priority);
+
+  SendData(cid1, 2, 100, "10,10");
+  OLA_ASSERT_EQ(string("5"), m_buffer.ToString());
+
+  // A single source can lower its priority
+  SendData(cid3, 3, 120, "6");
+  OLA_ASSERT_EQ(string("6"), m_buffer.ToString());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), m_priority);
+
+  // A tracked source that raises its priority drops the others
+  SendData(cid1, 3, 120, "1,2");
+  OLA_ASSERT_EQ(string("6,2"), m_buffer.ToString());
+  SendData(cid1, 4, 130, "1,2");
+  OLA_ASSERT_EQ(string("1,2"), m_buffer.ToString());
+  SendData(cid3, 4, 120, "9,9");
+  OLA_ASSERT_EQ(string("1,2"), m_buffer.ToString());
+
+  // And one that lowers its priority is dropped if there are others
+  SendData(cid2, 2, 130, "0,5");
+  OLA_ASSERT_EQ(string("1,5"), m_buffer.ToString());
+  SendData(cid1, 5, 110, "9,9");
+  OLA_ASSERT_EQ(string("0,5"), m_buffer.ToString());
+}
+
+
+/*
+ * Check stream termination removes a source.
+ */
+void DMPE131InflatorTest::testTermination() {
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+
+  SendData(cid1, 1, 100, "10,10");
+  SendData(cid2, 1, 100, "20");
+  OLA_ASSERT_EQ(string("20,10"), m_buffer.ToString());
+
+  SendData(cid2, 2, 100, "", true);
+  OLA_ASSERT_EQ(string("10,10"), m_buffer.ToString());
+
+  // Unknown sources that terminate are ignored
+  const unsigned int updates = m_updates;
+  SendData(cid2, 3, 100, "", true);
+  OLA_ASSERT_EQ(updates, m_updates);
+
+  SendData(cid1, 2, 100, "", true);
+  OLA_ASSERT_EQ(0u, m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), m_priority);
+
+  // Any priority is accepted once all sources are gone
+  SendData(cid2, 4, 10, "7");
+  OLA_ASSERT_EQ(string("7"), m_buffer.ToString());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(10), m_priority);
+}
+
+
+/*
+ * Check sources we stop hearing from expire.
+ */
+void DMPE131InflatorTest::testExpiry() {
+  CID cid1 = CID::Generate();
+  CID cid2 = CID::Generate();
+
+  SendData(cid1, 1, 100, "10,10");
+  SendData(cid2, 1, 100, "20");
+  OLA_ASSERT_EQ(string("20,10"), m_buffer.ToString());
+
+  // cid1 keeps sending, cid2 doesn't
+  for (uint8_t i = 2; i < 12; i++) {
+    m_clock.AdvanceTime(0, 250000);
+    SendData(cid1, i, 100, "10,10");
+  }
+  OLA_ASSERT_EQ(string("20,10"), m_buffer.ToString());
+
+  for (uint8_t i = 12; i < 16; i++) {
+    m_clock.AdvanceTime(0, 250000);
+    SendData(cid1, i, 100, "10,10");
+  }
+  OLA_ASSERT_EQ(string("10,10"), m_buffer.ToString());
+
+  // A lower priority source is accepted once the higher priority one expires.
+  m_clock.AdvanceTime(3, 0);
+  SendData(cid2, 2, 50, "30");
+  OLA_ASSERT_EQ(string("30"), m_buffer.ToString());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(50), m_priority);
+
+  // A large jump expires everything.
+  SendData(cid1, 16, 100, "1");
+  OLA_ASSERT_EQ(string("1"), m_buffer.ToString());
+  m_clock.AdvanceTime(60, 0);
+  SendData(cid2, 3, 50, "2");
+  OLA_ASSERT_EQ(string("2"), m_buffer.ToString());
+}
+
+
+/*
+ * Check we stop tracking sources once the table is full.
+ */
+void DMPE131InflatorTest::testMaxSources() {
+  CID cids[7];
+  for (unsigned int i = 0; i < 6; i++) {
+    cids[i] = CID::Generate();
+    SendData(cids[i], 1, 100, "1");
+  }
+  OLA_ASSERT_EQ(6u, m_updates);
+
+  cids[6] = CID::Generate();
+  SendData(cids[6], 1, 100, "255");
+  OLA_ASSERT_EQ(6u, m_updates);
+  OLA_ASSERT_EQ(string("1"), m_buffer.ToString());
+
+  // Once one leaves, there's room again.
+  SendData(cids[0], 2, 100, "", true);
+  SendData(cids[6], 2, 100, "255");
+  OLA_ASSERT_EQ(8u, m_updates);
+  OLA_ASSERT_EQ(string("255"), m_buffer.ToString());
+
+  // All the sources are still tracked.
+  for (unsigned int i = 1; i < 6; i++) {
+    SendData(cids[i], 3, 100, "");
+  }
+  OLA_ASSERT_EQ(string("255"), m_buffer.ToString());
+  SendData(cids[6], 4, 100, "");
+  OLA_ASSERT_EQ(0u, m_buffer.Size());
+}
+
+
+/*
+ * Check data with a sync address is held until the sync packet arrives.
+ */
+void DMPE131InflatorTest::testSync() {
+  const uint16_t sync_address = 7;
+  m_inflator.SetSyncAddressHandler(
+      NewCallback(this, &DMPE131InflatorTest::NewSyncAddress));
+  CID cid = CID::Generate();
+
+  // Until we've seen a sync packet, the data is used as it arrives.
+  SendData(cid, 1, 100, "1,2", false, sync_address);
+  OLA_ASSERT_EQ(sync_address, m_sync_address);
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_EQ(string("1,2"), m_buffer.ToString());
+
+  // Sync packets for other addresses don't do anything.
+  m_inflator.HandleSync(8);
+  m_inflator.HandleSync(sync_address);
+  OLA_ASSERT_EQ(1u, m_updates);
+
+  SendData(cid, 2, 100, "3,4", false, sync_address);
+  SendData(cid, 3, 100, "5,6", false, sync_address);
+  OLA_ASSERT_EQ(1u, m_updates);
+  m_inflator.HandleSync(8);
+  OLA_ASSERT_EQ(1u, m_updates);
+  m_inflator.HandleSync(sync_address);
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_EQ(string("5,6"), m_buffer.ToString());
+
+  // A sync with no new data doesn't run the handler.
+  m_inflator.HandleSync(sync_address);
+  OLA_ASSERT_EQ(2u, m_updates);
+
+  // If the sync packets stop, we go back to using the data as it arrives.
+  m_clock.AdvanceTime(3, 0);
+  SendData(cid, 4, 100, "7", false, sync_address);
+  OLA_ASSERT_EQ(3u, m_updates);
+
+  // As does data without a sync address.
+  m_inflator.HandleSync(sync_address);
+  SendData(cid, 5, 100, "8", false, sync_address);
+  OLA_ASSERT_EQ(3u, m_updates);
+  SendData(cid, 6, 100, "9");
+  OLA_ASSERT_EQ(4u, m_updates);
+  m_inflator.HandleSync(sync_address);
+  OLA_ASSERT_EQ(4u, m_updates);
+}
+}  // namespace acn
+}  // namespace ola
@@ -115,10 +115,13 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
       m_options(options),
       m_preferred_ip(ip_address),
       m_cid(cid),
+      m_send_queue(&m_socket, PreamblePacker::MAX_DATAGRAM_SIZE),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT),
       m_root_sender(m_cid),
       m_e131_sender(&m_socket, &m_root_sender),
       m_dmp_inflator(options.ignore_preview),
       m_discovery_inflator(NewCallback(this, &E131Node::NewDiscoveryPage)),
+      m_sync_inflator(NewCallback(this, &E131Node::NewSync)),
       m_incoming_udp_transport(&m_socket, &m_root_inflator),
       m_send_buffer(NULL),
       m_discovery_timeout(ola::thread::INVALID_TIMEOUT) {
@@ -130,12 +133,19 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
     m_send_buffer[0] = 0;  // start code is 0
   }
 
+  if (m_options.batch_sends) {
+    m_e131_sender.SetSendQueue(&m_send_queue);
+  }
+
   // setup all the inflators
   m_root_inflator.AddInflator(&m_e131_inflator);
   m_root_inflator.AddInflator(&m_e131_rev2_inflator);
+  m_root_inflator.AddInflator(&m_sync_inflator);
   m_e131_inflator.AddInflator(&m_dmp_inflator);
   m_e131_inflator.AddInflator(&m_discovery_inflator);
   m_e131_rev2_inflator.AddInflator(&m_dmp_inflator);
+  m_dmp_inflator.SetSyncAddressHandler(
+      NewCallback(this, &E131Node::NewSyncAddress));
 }
 
 
@@ -151,10 +161,20 @@ E131Node::~E131Node() {
     RemoveHandler(*iter);
   }
 
+  set<uint16_t>::const_iterator sync_iter = m_sync_groups.begin();
+  for (; sync_iter != m_sync_groups.end(); ++sync_iter) {
+    LeaveUniverseGroup(*sync_iter);
+  }
+
   Stop();
   if (m_send_buffer)
     delete[] m_send_buffer;
 
+  ActiveTxUniverses::iterator tx_iter = m_tx_universes.begin();
+  for (; tx_iter != m_tx_universes.end(); ++tx_iter) {
+    delete tx_iter->second.packet;
+  }
+
   STLDeleteValues(&m_discovered_sources);
 }
 
@@ -204,6 +224,23 @@ bool E131Node::Start() {
 bool E131Node::Stop() {
   m_ss->RemoveTimeout(m_discovery_timeout);
   m_discovery_timeout = ola::thread::INVALID_TIMEOUT;
+
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    FlushSendQueue();
+  }
+  return true;
+}
+
+bool E131Node::SetSyncUniverse(uint16_t universe, uint16_t sync_universe) {
+  ActiveTxUniverses::iterator iter = m_tx_universes.find(universe);
+
+  if (iter == m_tx_universes.end()) {
+    tx_universe *settings = SetupOutgoingSettings(universe);
+    settings->sync_universe = sync_universe;
+  } else {
+    iter->second.sync_universe = sync_universe;
+  }
   return true;
 }
 
@@ -215,6 +252,9 @@ bool E131Node::SetSourceName(uint16_t universe, const string &source) {
     settings->source = source;
   } else {
     iter->second.source = source;
+    // The packet is rebuilt with the new name when the next frame is sent.
+    delete iter->second.packet;
+    iter->second.packet = NULL;
   }
   return true;
 }
@@ -237,7 +277,7 @@ bool E131Node::TerminateStream(uint16_t universe, uint8_t priority) {
   for (unsigned int i = 0; i < 3; i++) {
     SendStreamTerminated(universe, DmxBuffer(), priority);
   }
-  STLRemove(&m_tx_universes, universe);
+  RemoveOutgoingSettings(universe);
   return true;
 }
 
@@ -263,6 +303,29 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
     settings = &iter->second;
   }
 
+  const uint8_t sequence = static_cast<uint8_t>(
+      settings->sequence + sequence_offset);
+  bool result;
+
+  if (m_options.prebuilt_packets && !m_options.use_rev2) {
+    if (!settings->packet) {
+      settings->packet = new E131PacketTemplate(m_cid, settings->source,
+                                                universe);
+    }
+    // An invalid template uses the regular path below.
+    if (settings->packet->IsValid()) {
+      settings->packet->SetSyncAddress(settings->sync_universe);
+      settings->packet->Update(sequence, priority, preview, buffer);
+      result = m_e131_sender.SendPacket(*settings->packet);
+      if (result && !sequence_offset)
+        settings->sequence++;
+      if (result && settings->sync_universe)
+        QueueSync(settings->sync_universe);
+      ScheduleFlush();
+      return result;
+    }
+  }
+
   const uint8_t *dmp_data;
   unsigned int dmp_data_length;
 
@@ -288,16 +351,22 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
 
   E131Header header(settings->source,
                     priority,
-                    static_cast<uint8_t>(settings->sequence + sequence_offset),
+                    sequence,
                     universe,
                     preview,  // preview
                     false,  // terminated
                     m_options.use_rev2);
+  const uint16_t sync_universe = m_options.use_rev2 ?
+      0 : settings->sync_universe;
+  header.SetSyncAddress(sync_universe);
 
-  bool result = m_e131_sender.SendDMP(header, pdu);
+  result = m_e131_sender.SendDMP(header, pdu);
   if (result && !sequence_offset)
     settings->sequence++;
+  if (result && sync_universe)
+    QueueSync(sync_universe);
   delete pdu;
+  ScheduleFlush();
   return result;
 }
 
@@ -342,6 +411,7 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
   if (result && iter != m_tx_universes.end())
     iter->second.sequence++;
   delete pdu;
+  ScheduleFlush();
   return result;
 }
 
@@ -349,35 +419,28 @@ bool E131Node::SetHandler(uint16_t universe,
                           DmxBuffer *buffer,
                           uint8_t *priority,
                           Callback0<void> *closure) {
-  IPV4Address addr;
-  if (!m_e131_sender.UniverseIP(universe, &addr)) {
-    OLA_WARN << "Unable to determine multicast group for universe " <<
-      universe;
-    return false;
-  }
-
-  if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
-    OLA_WARN << "Failed to join multicast group " << addr;
+  // Replacing an existing handler doesn't add another user of the group.
+  if (!m_dmp_inflator.HasHandler(universe) && !JoinUniverseGroup(universe)) {
     return false;
   }
 
   return m_dmp_inflator.SetHandler(universe, buffer, priority, closure);
 }
 
-bool E131Node::RemoveHandler(uint16_t universe) {
-  IPV4Address addr;
-  if (!m_e131_sender.UniverseIP(universe, &addr)) {
-    OLA_WARN << "Unable to determine multicast group for universe " <<
-      universe;
-    return false;
-  }
+bool E131Node::SendSync(uint16_t sync_universe) {
+  uint8_t &sequence = m_sync_sequences[sync_universe];
+  bool result = m_e131_sender.SendSync(sequence, sync_universe);
+  if (result)
+    sequence++;
+  ScheduleFlush();
+  return result;
+}
 
-  if (!m_socket.LeaveMulticast(m_interface.ip_address, addr)) {
-    OLA_WARN << "Failed to leave multicast group " << addr;
+bool E131Node::RemoveHandler(uint16_t universe) {
+  if (!m_dmp_inflator.RemoveHandler(universe)) {
     return false;
   }
-
-  return m_dmp_inflator.RemoveHandler(universe);
+  return LeaveUniverseGroup(universe);
 }
 
 
@@ -401,12 +464,26 @@ E131Node::tx_universe *E131Node::SetupOutgoingSettings(uint16_t universe) {
   tx_universe settings;
   settings.source = m_options.source_name;
   settings.sequence = 0;
+  settings.sync_universe = m_options.sync_universe;
+  settings.packet = NULL;
   ActiveTxUniverses::iterator iter =
       m_tx_universes.insert(std::make_pair(universe, settings)).first;
   return &iter->second;
 }
 
 
+/*
+ * Remove the settings for an outgoing universe
+ */
+void E131Node::RemoveOutgoingSettings(uint16_t universe) {
+  ActiveTxUniverses::iterator iter = m_tx_universes.find(universe);
+  if (iter != m_tx_universes.end()) {
+    delete iter->second.packet;
+    m_tx_universes.erase(iter);
+  }
+}
+
+
 bool E131Node::PerformDiscoveryHousekeeping() {
   // Send the Universe Discovery packets.
   vector<uint16_t> universes;
@@ -484,6 +561,115 @@ void E131Node::SendDiscoveryPage(const std::vector<uint16_t> &universes,
   m_e131_sender.SendDiscoveryData(
       header, reinterpret_cast<uint8_t*>(page_data), (in_this_page + 1) * 2);
   delete[] page_data;
+  ScheduleFlush();
+}
+
+/*
+ * Send a sync packet for this address once the current event has been handled.
+ */
+void E131Node::QueueSync(uint16_t sync_address) {
+  if (std::find(m_pending_syncs.begin(), m_pending_syncs.end(),
+                sync_address) == m_pending_syncs.end()) {
+    m_pending_syncs.push_back(sync_address);
+  }
+}
+
+/*
+ * Send any queued packets once the current event has been handled.
+ */
+void E131Node::ScheduleFlush() {
+  if ((m_send_queue.Empty() && m_pending_syncs.empty()) ||
+      m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  m_flush_timeout = m_ss->RegisterSingleTimeout(
+      0, NewSingleCallback(this, &E131Node::FlushSendQueue));
+}
+
+void E131Node::FlushSendQueue() {
+  // The sync packets follow the data for all the universes sent during this
+  // event, so the receivers output them together.
+  vector<uint16_t> syncs;
+  syncs.swap(m_pending_syncs);
+  vector<uint16_t>::const_iterator iter = syncs.begin();
+  for (; iter != syncs.end(); ++iter) {
+    SendSync(*iter);
+  }
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  m_send_queue.Flush();
+}
+
+void E131Node::NewSync(OLA_UNUSED const HeaderSet &headers,
+                       uint16_t sync_address) {
+  m_dmp_inflator.HandleSync(sync_address);
+}
+
+/*
+ * Called when a universe we're listening to uses a new sync address.
+ */
+void E131Node::NewSyncAddress(uint16_t sync_address) {
+  if (STLContains(m_sync_groups, sync_address)) {
+    return;
+  }
+
+  if (JoinUniverseGroup(sync_address)) {
+    m_sync_groups.insert(sync_address);
+  }
+}
+
+
+/*
+ * Add a user of the multicast group for a universe, joining the group if this
+ * is the first one.
+ */
+bool E131Node::JoinUniverseGroup(uint16_t universe) {
+  MulticastGroups::iterator iter = m_multicast_groups.find(universe);
+  if (iter != m_multicast_groups.end()) {
+    iter->second++;
+    return true;
+  }
+
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(universe, &addr)) {
+    OLA_WARN << "Unable to determine multicast group for universe " <<
+      universe;
+    return false;
+  }
+
+  if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
+    OLA_WARN << "Failed to join multicast group " << addr;
+    return false;
+  }
+  m_multicast_groups[universe] = 1;
+  return true;
+}
+
+
+/*
+ * Remove a user of the multicast group for a universe, leaving the group once
+ * there are no users left.
+ */
+bool E131Node::LeaveUniverseGroup(uint16_t universe) {
+  MulticastGroups::iterator iter = m_multicast_groups.find(universe);
+  if (iter == m_multicast_groups.end()) {
+    return false;
+  }
+
+  if (--iter->second) {
+    return true;
+  }
+  m_multicast_groups.erase(iter);
+
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(universe, &addr)) {
+    return false;
+  }
+
+  if (!m_socket.LeaveMulticast(m_interface.ip_address, addr)) {
+    OLA_WARN << "Failed to leave multicast group " << addr;
+    return false;
+  }
+  return true;
 }
 }  // namespace acn
 }  // namespace ola
@@ -36,10 +36,13 @@
 #include "ola/thread/SchedulerInterface.h"
 #include "ola/network/Interface.h"
 #include "ola/network/Socket.h"
+#include "ola/network/UDPSendQueue.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/E131DiscoveryInflator.h"
 #include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
 #include "libs/acn/E131Sender.h"
+#include "libs/acn/E131SyncInflator.h"
 #include "libs/acn/RootInflator.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
@@ -60,7 +63,10 @@ class E131Node {
          enable_draft_discovery(false),
          dscp(0),
          port(ola::acn::ACN_PORT),
-         source_name(ola::OLA_DEFAULT_INSTANCE_NAME) {
+         source_name(ola::OLA_DEFAULT_INSTANCE_NAME),
+         batch_sends(false),
+         prebuilt_packets(false),
+         sync_universe(0) {
     }
 
     bool use_rev2;  /**< Use Revision 0.2 of the 2009 draft */
@@ -69,6 +75,24 @@ class E131Node {
     uint8_t dscp;  /**< The DSCP value to tag packets with */
     uint16_t port; /**< The UDP port to use, defaults to ACN_PORT */
     std::string source_name; /**< The source name to use */
+    /**
+     * @brief Queue packets and send them together once the current event has
+     * been handled, rather than sending each one immediately.
+     */
+    bool batch_sends;
+    /**
+     * @brief Keep a pre-encoded packet for each universe and only update the
+     * fields which change, rather than building the packet for each frame.
+     * This is ignored if use_rev2 is set.
+     */
+    bool prebuilt_packets;
+    /**
+     * @brief The default synchronization universe for outgoing universes, 0
+     * disables synchronization. Once all the universes for an event have been
+     * sent, a sync packet is sent to this universe. This is ignored if
+     * use_rev2 is set.
+     */
+    uint16_t sync_universe;
   };
 
   struct KnownController {
@@ -108,6 +132,14 @@ class E131Node {
    */
   bool SetSourceName(uint16_t universe, const std::string &source);
 
+  /**
+   * @brief Set the synchronization universe for a universe.
+   * @param universe the id of the universe to send
+   * @param sync_universe the universe to send the sync packets to, 0
+   *   disables synchronization.
+   */
+  bool SetSyncUniverse(uint16_t universe, uint16_t sync_universe);
+
   /**
    * @brief Signal that we will start sending on this particular universe.
    *   Without sending any DMX data.
@@ -171,6 +203,15 @@ class E131Node {
                             const ola::DmxBuffer &buffer = DmxBuffer(),
                             uint8_t priority = DEFAULT_PRIORITY);
 
+  /**
+   * @brief Send a synchronization packet now.
+   * @param sync_universe the universe to send the sync packet to.
+   *
+   * Sync packets are sent automatically after the data for universes with a
+   * sync universe, so this is only needed for testing.
+   */
+  bool SendSync(uint16_t sync_universe);
+
   /**
    * @brief Set the Callback to be run when we receive data for this universe.
    * @param universe the universe to register the handler for
@@ -211,9 +252,14 @@ class E131Node {
   struct tx_universe {
     std::string source;
     uint8_t sequence;
+    uint16_t sync_universe;
+    E131PacketTemplate *packet;  // owned, NULL until the first frame is sent
   };
 
   typedef std::map<uint16_t, tx_universe> ActiveTxUniverses;
+  typedef std::map<uint16_t, uint8_t> SyncSequences;
+  // Maps universe to the number of users of its multicast group.
+  typedef std::map<uint16_t, unsigned int> MulticastGroups;
   typedef std::map<acn::CID, class TrackedSource*> TrackedSources;
 
   ola::thread::SchedulerInterface *m_ss;
@@ -223,6 +269,8 @@ class E131Node {
 
   ola::network::Interface m_interface;
   ola::network::UDPSocket m_socket;
+  ola::network::UDPSendQueue m_send_queue;
+  ola::thread::timeout_id m_flush_timeout;
   // senders
   RootSender m_root_sender;
   E131Sender m_e131_sender;
@@ -232,16 +280,35 @@ class E131Node {
   E131InflatorRev2 m_e131_rev2_inflator;
   DMPE131Inflator m_dmp_inflator;
   E131DiscoveryInflator m_discovery_inflator;
+  E131SyncInflator m_sync_inflator;
 
   IncomingUDPTransport m_incoming_udp_transport;
   ActiveTxUniverses m_tx_universes;
   uint8_t *m_send_buffer;
 
+  // Synchronization members
+  std::vector<uint16_t> m_pending_syncs;
+  SyncSequences m_sync_sequences;
+  std::set<uint16_t> m_sync_groups;
+  // Shared by data and sync universes
+  MulticastGroups m_multicast_groups;
+
   // Discovery members
   ola::thread::timeout_id m_discovery_timeout;
   TrackedSources m_discovered_sources;
 
   tx_universe *SetupOutgoingSettings(uint16_t universe);
+  void RemoveOutgoingSettings(uint16_t universe);
+
+  void QueueSync(uint16_t sync_address);
+  void ScheduleFlush();
+  void FlushSendQueue();
+
+  void NewSync(const HeaderSet &headers, uint16_t sync_address);
+  void NewSyncAddress(uint16_t sync_address);
+
+  bool JoinUniverseGroup(uint16_t universe);
+  bool LeaveUniverseGroup(uint16_t universe);
 
   bool PerformDiscoveryHousekeeping();
   void NewDiscoveryPage(const HeaderSet &headers,
@@ -0,0 +1,130 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.cpp
+ * A pre-encoded E1.31 data packet.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/acn/ACNVectors.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootPDU.h"
+
+namespace ola {
+namespace acn {
+
+using std::string;
+using std::vector;
+
+E131PacketTemplate::E131PacketTemplate(const CID &cid,
+                                       const string &source,
+                                       uint16_t universe)
+    : m_universe(universe),
+      m_slot_count(DMX_UNIVERSE_SIZE),
+      m_valid(false) {
+  // Pack a full universe the same way E131Sender does, so the layout always
+  // matches.
+  uint8_t dmp_data[DMX_UNIVERSE_SIZE + 1];
+  memset(dmp_data, 0, sizeof(dmp_data));
+  TwoByteRangeDMPAddress range_addr(0, 1, sizeof(dmp_data));
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(
+      &range_addr, dmp_data, sizeof(dmp_data));
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  std::auto_ptr<const DMPPDU> dmp_pdu(
+      NewRangeDMPSetProperty<uint16_t>(true, false, ranged_chunks));
+
+  E131Header header(source, 0, 0, universe);
+  E131PDU e131_pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu.get());
+  PDUBlock<PDU> e131_block;
+  e131_block.AddPDU(&e131_pdu);
+  RootPDU root_pdu(ola::acn::VECTOR_ROOT_E131, cid, &e131_block);
+  PDUBlock<PDU> root_block;
+  root_block.AddPDU(&root_pdu);
+
+  memcpy(m_packet, PreamblePacker::ACN_HEADER,
+         PreamblePacker::ACN_HEADER_SIZE);
+  unsigned int length = MAX_SIZE - PreamblePacker::ACN_HEADER_SIZE;
+  if (!root_block.Pack(m_packet + PreamblePacker::ACN_HEADER_SIZE, &length) ||
+      PreamblePacker::ACN_HEADER_SIZE + length != MAX_SIZE) {
+    OLA_WARN << "E1.31 packet template for universe " << universe
+             << " has an unexpected size, falling back to building each "
+             << "packet";
+    return;
+  }
+  m_valid = true;
+}
+
+
+void E131PacketTemplate::Update(uint8_t sequence,
+                                uint8_t priority,
+                                bool preview,
+                                const DmxBuffer &buffer) {
+  unsigned int slot_count = DMX_UNIVERSE_SIZE;
+  buffer.Get(m_packet + DATA_OFFSET, &slot_count);
+  if (slot_count != m_slot_count) {
+    SetSlotCount(slot_count);
+  }
+
+  m_packet[PRIORITY_OFFSET] = priority;
+  m_packet[SEQUENCE_OFFSET] = sequence;
+  m_packet[OPTIONS_OFFSET] = preview ? E131Header::PREVIEW_DATA_MASK : 0;
+}
+
+
+void E131PacketTemplate::SetSyncAddress(uint16_t sync_address) {
+  m_packet[SYNC_ADDRESS_OFFSET] = static_cast<uint8_t>(sync_address >> 8);
+  m_packet[SYNC_ADDRESS_OFFSET + 1] =
+      static_cast<uint8_t>(sync_address & 0xff);
+}
+
+
+void E131PacketTemplate::SetSlotCount(unsigned int slot_count) {
+  m_slot_count = slot_count;
+  const unsigned int size = Size();
+  SetLength(m_packet + ROOT_LENGTH_OFFSET, size - ROOT_LENGTH_OFFSET);
+  SetLength(m_packet + E131_LENGTH_OFFSET, size - E131_LENGTH_OFFSET);
+  SetLength(m_packet + DMP_LENGTH_OFFSET, size - DMP_LENGTH_OFFSET);
+
+  // The property count includes the start code.
+  const unsigned int count = slot_count + 1;
+  m_packet[PROPERTY_COUNT_OFFSET] = static_cast<uint8_t>(count >> 8);
+  m_packet[PROPERTY_COUNT_OFFSET + 1] = static_cast<uint8_t>(count & 0xff);
+}
+
+
+/*
+ * Set the length in the flags & length field of a PDU, the flags are left as
+ * they are.
+ */
+void E131PacketTemplate::SetLength(uint8_t *flags_and_length,
+                                   unsigned int length) {
+  flags_and_length[0] = static_cast<uint8_t>(
+      (flags_and_length[0] & 0xf0) | ((length >> 8) & 0x0f));
+  flags_and_length[1] = static_cast<uint8_t>(length & 0xff);
+}
+}  // namespace acn
+}  // namespace ola
@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.h
+ * A pre-encoded E1.31 data packet.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131PACKETTEMPLATE_H_
+#define LIBS_ACN_E131PACKETTEMPLATE_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * Holds a complete E1.31 data packet, including the UDP preamble, for one
+ * universe. The packet is built once with the regular PDU classes, after that
+ * Update() patches the fields which change from frame to frame so sending
+ * doesn't need any allocations.
+ *
+ * Only the ratified version of E1.31 is supported, not Revision 0.2. If the
+ * packed packet doesn't match the fixed offsets below, the template is marked
+ * invalid and mustn't be sent.
+ */
+class E131PacketTemplate {
+ public:
+  E131PacketTemplate(const ola::acn::CID &cid,
+                     const std::string &source,
+                     uint16_t universe);
+  ~E131PacketTemplate() {}
+
+  /*
+   * Update the packet with a new frame.
+   * @param sequence the sequence number.
+   * @param priority the priority of the data.
+   * @param preview true if this is preview data.
+   * @param buffer the DMX data, the start code is always 0.
+   */
+  void Update(uint8_t sequence, uint8_t priority, bool preview,
+              const ola::DmxBuffer &buffer);
+
+  /*
+   * Set the synchronization address, 0 means the data isn't synchronized.
+   */
+  void SetSyncAddress(uint16_t sync_address);
+
+  /*
+   * Check if the packet was built with the expected layout.
+   */
+  bool IsValid() const { return m_valid; }
+
+  uint16_t Universe() const { return m_universe; }
+  const uint8_t *Data() const { return m_packet; }
+  unsigned int Size() const { return DATA_OFFSET + m_slot_count; }
+
+  // Offsets into the packet, these are fixed by the standard.
+  static const unsigned int ROOT_LENGTH_OFFSET = 16;
+  static const unsigned int E131_LENGTH_OFFSET = 38;
+  static const unsigned int PRIORITY_OFFSET = 108;
+  static const unsigned int SYNC_ADDRESS_OFFSET = 109;
+  static const unsigned int SEQUENCE_OFFSET = 111;
+  static const unsigned int OPTIONS_OFFSET = 112;
+  static const unsigned int DMP_LENGTH_OFFSET = 115;
+  static const unsigned int PROPERTY_COUNT_OFFSET = 123;
+  static const unsigned int START_CODE_OFFSET = 125;
+  static const unsigned int DATA_OFFSET = START_CODE_OFFSET + 1;
+  static const unsigned int MAX_SIZE = DATA_OFFSET + DMX_UNIVERSE_SIZE;
+
+ private:
+  const uint16_t m_universe;
+  unsigned int m_slot_count;
+  bool m_valid;
+  uint8_t m_packet[MAX_SIZE];
+
+  void SetSlotCount(unsigned int slot_count);
+
+  static void SetLength(uint8_t *flags_and_length, unsigned int length);
+
+  DISALLOW_COPY_AND_ASSIGN(E131PacketTemplate);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131PACKETTEMPLATE_H_
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplateTest.cpp
+ * Test fixture for the E131PacketTemplate class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootPDU.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::string;
+using std::vector;
+
+class E131PacketTemplateTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(E131PacketTemplateTest);
+  CPPUNIT_TEST(testFullUniverse);
+  CPPUNIT_TEST(testSizeChanges);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testFullUniverse();
+    void testSizeChanges();
+
+ private:
+    CID m_cid;
+    PreamblePacker m_packer;
+
+    void CheckPacket(const E131PacketTemplate &packet,
+                     const string &source, uint8_t sequence,
+                     uint8_t priority, bool preview,
+                     const DmxBuffer &buffer,
+                     uint16_t sync_address = 0);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(E131PacketTemplateTest);
+
+static const char SOURCE[] = "foo source";
+static const uint16_t UNIVERSE = 6000;
+
+
+void E131PacketTemplateTest::setUp() {
+  m_cid = CID::Generate();
+}
+
+
+/*
+ * Check a template matches the packet E131Sender would build.
+ */
+void E131PacketTemplateTest::CheckPacket(const E131PacketTemplate &packet,
+                                         const string &source,
+                                         uint8_t sequence,
+                                         uint8_t priority,
+                                         bool preview,
+                                         const DmxBuffer &buffer,
+                                         uint16_t sync_address) {
+  uint8_t dmp_data[DMX_UNIVERSE_SIZE + 1];
+  dmp_data[0] = 0;
+  unsigned int data_size = DMX_UNIVERSE_SIZE;
+  buffer.Get(dmp_data + 1, &data_size);
+  data_size++;
+
+  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) data_size);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(
+      &range_addr, dmp_data, data_size);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  std::auto_ptr<const DMPPDU> dmp_pdu(
+      NewRangeDMPSetProperty<uint16_t>(true, false, ranged_chunks));
+
+  E131Header header(source, priority, sequence, UNIVERSE, preview);
+  header.SetSyncAddress(sync_address);
+  E131PDU e131_pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu.get());
+  PDUBlock<PDU> e131_block;
+  e131_block.AddPDU(&e131_pdu);
+  RootPDU root_pdu(ola::acn::VECTOR_ROOT_E131, m_cid, &e131_block);
+  PDUBlock<PDU> root_block;
+  root_block.AddPDU(&root_pdu);
+
+  unsigned int length;
+  const uint8_t *expected = m_packer.Pack(root_block, &length);
+  OLA_ASSERT_NOT_NULL(expected);
+  OLA_ASSERT_DATA_EQUALS(expected, length, packet.Data(), packet.Size());
+}
+
+
+/*
+ * Check a full universe of data.
+ */
+void E131PacketTemplateTest::testFullUniverse() {
+  E131PacketTemplate packet(m_cid, SOURCE, UNIVERSE);
+  OLA_ASSERT_EQ(UNIVERSE, packet.Universe());
+  OLA_ASSERT_TRUE(packet.IsValid());
+  const unsigned int max_size = E131PacketTemplate::MAX_SIZE;
+  OLA_ASSERT_EQ(max_size, packet.Size());
+
+  DmxBuffer buffer;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+  buffer.Set(data, sizeof(data));
+
+  packet.Update(0, 100, false, buffer);
+  CheckPacket(packet, SOURCE, 0, 100, false, buffer);
+
+  buffer.SetChannel(10, 255);
+  packet.Update(1, 200, true, buffer);
+  CheckPacket(packet, SOURCE, 1, 200, true, buffer);
+
+  packet.Update(255, 0, false, buffer);
+  CheckPacket(packet, SOURCE, 255, 0, false, buffer);
+
+  packet.SetSyncAddress(7000);
+  packet.Update(0, 100, false, buffer);
+  CheckPacket(packet, SOURCE, 0, 100, false, buffer, 7000);
+}
+
+
+/*
+ * Check the lengths are updated when the frame size changes.
+ */
+void E131PacketTemplateTest::testSizeChanges() {
+  E131PacketTemplate packet(m_cid, SOURCE, UNIVERSE);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5");
+  packet.Update(1, 100, false, buffer);
+  const unsigned int expected_size = E131PacketTemplate::DATA_OFFSET + 5;
+  OLA_ASSERT_EQ(expected_size, packet.Size());
+  CheckPacket(packet, SOURCE, 1, 100, false, buffer);
+
+  // An empty frame only carries the start code
+  DmxBuffer empty;
+  packet.Update(2, 100, false, empty);
+  CheckPacket(packet, SOURCE, 2, 100, false, empty);
+
+  // Large enough for the lengths to use the upper bits
+  uint8_t data[300];
+  memset(data, 42, sizeof(data));
+  buffer.Set(data, sizeof(data));
+  packet.Update(3, 100, false, buffer);
+  CheckPacket(packet, SOURCE, 3, 100, false, buffer);
+
+  buffer.Blackout();
+  packet.Update(4, 100, false, buffer);
+  CheckPacket(packet, SOURCE, 4, 100, false, buffer);
+}
+}  // namespace acn
+}  // namespace ola
@@ -19,14 +19,17 @@
  */
 
 #include "ola/Logging.h"
+#include "ola/acn/ACNPort.h"
 #include "ola/acn/ACNVectors.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/SocketAddress.h"
 #include "ola/util/Utils.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131Sender.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
 
@@ -78,6 +81,45 @@ bool E131Sender::SendDMP(const E131Header &header, const DMPPDU *dmp_pdu) {
   return m_root_sender->SendPDU(vector, pdu, &transport);
 }
 
+/*
+ * Send a pre-encoded data packet.
+ * @param packet the packet to send
+ */
+bool E131Sender::SendPacket(const E131PacketTemplate &packet) {
+  IPV4Address addr;
+  if (!UniverseIP(packet.Universe(), &addr)) {
+    OLA_INFO << "Could not convert universe " << packet.Universe()
+             << " to IP.";
+    return false;
+  }
+
+  return m_transport_impl.Send(
+      packet.Data(), packet.Size(),
+      ola::network::IPV4SocketAddress(addr, ola::acn::ACN_PORT));
+}
+
+/*
+ * Send a synchronization packet.
+ * @param sequence the sequence number for the sync address.
+ * @param sync_address the universe to send the packet to.
+ */
+bool E131Sender::SendSync(uint8_t sequence, uint16_t sync_address) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  IPV4Address addr;
+  if (!UniverseIP(sync_address, &addr)) {
+    OLA_INFO << "Could not convert universe " << sync_address << " to IP.";
+    return false;
+  }
+
+  OutgoingUDPTransport transport(&m_transport_impl, addr);
+  E131SyncPDU pdu(sequence, sync_address);
+  return m_root_sender->SendPDU(ola::acn::VECTOR_ROOT_E131_EXTENDED, pdu,
+                                &transport);
+}
+
 bool E131Sender::SendDiscoveryData(const E131Header &header,
                                    const uint8_t *data,
                                    unsigned int data_size) {
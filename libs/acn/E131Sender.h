@@ -25,6 +25,7 @@
 #include "ola/network/Socket.h"
 #include "libs/acn/DMPPDU.h"
 #include "libs/acn/E131Header.h"
+#include "libs/acn/E131PacketTemplate.h"
 #include "libs/acn/PreamblePacker.h"
 #include "libs/acn/Transport.h"
 #include "libs/acn/UDPTransport.h"
@@ -43,6 +44,16 @@ class E131Sender {
   bool SendDMP(const E131Header &header, const DMPPDU *pdu);
   bool SendDiscoveryData(const E131Header &header, const uint8_t *data,
                          unsigned int data_size);
+  bool SendPacket(const E131PacketTemplate &packet);
+  bool SendSync(uint8_t sequence, uint16_t sync_address);
+
+  /*
+   * Queue packets rather than sending them, see
+   * OutgoingUDPTransportImpl::SetSendQueue().
+   */
+  void SetSendQueue(ola::network::UDPSendQueue *queue) {
+    m_transport_impl.SetSendQueue(queue);
+  }
 
   static bool UniverseIP(uint16_t universe,
                          class ola::network::IPV4Address *addr);
@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131SyncInflator.cpp
+ * Handles E1.31 synchronization packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/network/NetworkUtils.h"
+#include "libs/acn/E131SyncInflator.h"
+#include "libs/acn/E131SyncPDU.h"
+
+namespace ola {
+namespace acn {
+
+unsigned int E131SyncInflator::InflatePDUBlock(HeaderSet *headers,
+                                               const uint8_t *data,
+                                               unsigned int len) {
+  if (!m_sync_callback.get()) {
+    return len;
+  }
+
+  // A synchronization packet always fits in the two byte length format, and
+  // only ever has a single PDU.
+  PACK(
+  struct sync_pdu {
+    uint8_t flags_and_length[2];
+    uint32_t vector;
+    E131SyncPDU::e131_sync_header header;
+  });
+  STATIC_ASSERT(sizeof(sync_pdu) == 11);
+
+  sync_pdu pdu;
+  if (len < sizeof(pdu)) {
+    OLA_WARN << "E1.31 extended packet is too small: " << len;
+    return len;
+  }
+  memcpy(reinterpret_cast<uint8_t*>(&pdu), data, sizeof(pdu));
+
+  if (!(pdu.flags_and_length[0] & PDU::VFLAG_MASK) ||
+      ola::network::NetworkToHost(pdu.vector) !=
+      VECTOR_E131_EXTENDED_SYNCHRONIZATION) {
+    OLA_DEBUG << "Ignoring E1.31 extended packet that isn't a sync packet";
+    return len;
+  }
+
+  m_sync_callback->Run(*headers,
+                       ola::network::NetworkToHost(pdu.header.sync_address));
+  return len;
+}
+}  // namespace acn
+}  // namespace ola
@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131SyncInflator.h
+ * Handles E1.31 synchronization packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131SYNCINFLATOR_H_
+#define LIBS_ACN_E131SYNCINFLATOR_H_
+
+#include <memory>
+#include "ola/Callback.h"
+#include "ola/acn/ACNVectors.h"
+#include "libs/acn/BaseInflator.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * Handles the VECTOR_ROOT_E131_EXTENDED packets, only synchronization
+ * packets are understood, anything else is ignored.
+ */
+class E131SyncInflator: public InflatorInterface {
+ public:
+  // Called with the synchronization address of each sync packet.
+  typedef ola::Callback2<void, const HeaderSet&, uint16_t> SyncCallback;
+
+  explicit E131SyncInflator(SyncCallback *callback)
+      : m_sync_callback(callback) {}
+
+  uint32_t Id() const { return acn::VECTOR_ROOT_E131_EXTENDED; }
+
+  unsigned int InflatePDUBlock(HeaderSet *headers,
+                               const uint8_t *data,
+                               unsigned int len);
+
+ private:
+  std::auto_ptr<SyncCallback> m_sync_callback;
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131SYNCINFLATOR_H_
@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131SyncPDU.cpp
+ * The E131SyncPDU
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include "ola/Logging.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/network/NetworkUtils.h"
+#include "libs/acn/E131SyncPDU.h"
+
+namespace ola {
+namespace acn {
+
+using ola::io::OutputStream;
+using ola::network::HostToNetwork;
+
+E131SyncPDU::E131SyncPDU(uint8_t sequence, uint16_t sync_address)
+    : PDU(ola::acn::VECTOR_E131_EXTENDED_SYNCHRONIZATION),
+      m_sequence(sequence),
+      m_sync_address(sync_address) {
+}
+
+
+/*
+ * Pack the header portion.
+ */
+bool E131SyncPDU::PackHeader(uint8_t *data, unsigned int *length) const {
+  if (*length < sizeof(e131_sync_header)) {
+    OLA_WARN << "E131SyncPDU::PackHeader: buffer too small, got " << *length
+             << " required " << sizeof(e131_sync_header);
+    *length = 0;
+    return false;
+  }
+
+  e131_sync_header header = Header();
+  *length = sizeof(e131_sync_header);
+  memcpy(data, &header, *length);
+  return true;
+}
+
+
+/*
+ * There is no data.
+ */
+bool E131SyncPDU::PackData(OLA_UNUSED uint8_t *data,
+                           unsigned int *length) const {
+  *length = 0;
+  return true;
+}
+
+
+void E131SyncPDU::PackHeader(OutputStream *stream) const {
+  e131_sync_header header = Header();
+  stream->Write(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+}
+
+
+void E131SyncPDU::PackData(OLA_UNUSED OutputStream *stream) const {
+}
+
+
+E131SyncPDU::e131_sync_header E131SyncPDU::Header() const {
+  e131_sync_header header;
+  header.sequence = m_sequence;
+  header.sync_address = HostToNetwork(m_sync_address);
+  header.reserved = 0;
+  return header;
+}
+}  // namespace acn
+}  // namespace ola
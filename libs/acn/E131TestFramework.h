@@ -37,6 +37,7 @@
 #include "libs/acn/E131Node.h"
 
 static const unsigned int UNIVERSE_ID = 1;
+static const uint16_t SYNC_UNIVERSE_ID = 2;
 
 /*
  * NodeAction, this reflects an action to be performed on a node.
@@ -215,6 +216,30 @@ class NodeSimpleSend: public NodeAction {
 };
 
 
+/*
+ * This action sends data with a synchronization universe, so each packet is
+ * followed by a sync packet.
+ */
+class NodeSyncSend: public NodeAction {
+ public:
+    NodeSyncSend(uint8_t priority, const std::string &data,
+                 uint16_t sync_universe = SYNC_UNIVERSE_ID)
+        : m_priority(priority),
+          m_sync_universe(sync_universe) {
+      m_buffer.SetFromString(data);
+    }
+    void Tick() {
+      m_node->SetSyncUniverse(UNIVERSE_ID, m_sync_universe);
+      m_node->SendDMX(UNIVERSE_ID, m_buffer, m_priority);
+    }
+
+ private:
+    ola::DmxBuffer m_buffer;
+    uint8_t m_priority;
+    uint16_t m_sync_universe;
+};
+
+
 /*
  * This action sends a terminated msg that does nothing.
  */
@@ -0,0 +1,242 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131TransmitBenchmark.cpp
+ * Measure the cost of building and sending E1.31 data packets.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The first part compares building the packet from PDUs, like E131Node does
+ * by default, with updating an E131PacketTemplate. The second part sends
+ * frames for many universes with an E131Node, with and without prebuilt
+ * packets.
+ *
+ * Global operator new is replaced so we can count the allocations made per
+ * packet.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131Node.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootPDU.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::acn::CID;
+using ola::acn::DMPAddressData;
+using ola::acn::DMPPDU;
+using ola::acn::E131Header;
+using ola::acn::E131Node;
+using ola::acn::E131PDU;
+using ola::acn::E131PacketTemplate;
+using ola::acn::PDU;
+using ola::acn::PDUBlock;
+using ola::acn::PreamblePacker;
+using ola::acn::RootPDU;
+using ola::acn::TwoByteRangeDMPAddress;
+using ola::io::SelectServer;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(packets, p, 1000000, "The number of packets to encode");
+DEFINE_s_uint16(universes, u, 1000, "The number of universes to send");
+DEFINE_s_uint32(frames, f, 200, "The number of frames to send");
+DEFINE_default_bool(send, true, "Send frames with an E131Node");
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size)
+#if __cplusplus < 201103L
+    throw(std::bad_alloc)
+#endif  // __cplusplus < 201103L
+{  // NOLINT(whitespace/braces)
+  allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+  free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) throw() {
+  free(ptr);
+}
+#endif  // __cplusplus >= 201402L
+
+/*
+ * Print the result of a run.
+ */
+void Report(const char *name, const TimeInterval &duration,
+            unsigned int count, uint64_t allocs) {
+  double usec = static_cast<double>(duration.AsInt());
+  cout << std::setw(16) << std::left << name << " "
+       << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+       << (usec * 1000.0 / count) << " ns/packet, "
+       << std::setw(10) << (count * 1000000.0 / usec) << " packets/s, "
+       << std::setw(6) << std::setprecision(2)
+       << (static_cast<double>(allocs) / count) << " allocs/packet" << endl;
+}
+
+/*
+ * Build the packet from PDUs, this follows E131Node::SendDMX.
+ */
+unsigned int PackFromPDUs(const CID &cid, const string &source,
+                          PreamblePacker *packer, uint8_t *send_buffer,
+                          uint8_t sequence, const DmxBuffer &buffer) {
+  unsigned int data_size = ola::DMX_UNIVERSE_SIZE;
+  buffer.Get(send_buffer + 1, &data_size);
+  data_size++;
+
+  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) data_size);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(
+      &range_addr, send_buffer, data_size);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *dmp_pdu = ola::acn::NewRangeDMPSetProperty<uint16_t>(
+      true, false, ranged_chunks);
+
+  E131Header header(source, 100, sequence, 1);
+  E131PDU e131_pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu);
+  PDUBlock<PDU> e131_block;
+  e131_block.AddPDU(&e131_pdu);
+  RootPDU root_pdu(ola::acn::VECTOR_ROOT_E131, cid, &e131_block);
+  PDUBlock<PDU> root_block;
+  root_block.AddPDU(&root_pdu);
+
+  unsigned int length = 0;
+  packer->Pack(root_block, &length);
+  delete dmp_pdu;
+  return length;
+}
+
+void RunEncode(const CID &cid, const DmxBuffer &buffer, unsigned int packets) {
+  const string source = "benchmark";
+  Clock clock;
+  TimeStamp start, end;
+  uint64_t bytes = 0;
+
+  PreamblePacker packer;
+  uint8_t send_buffer[ola::DMX_UNIVERSE_SIZE + 1];
+  send_buffer[0] = 0;
+  PackFromPDUs(cid, source, &packer, send_buffer, 0, buffer);
+
+  uint64_t allocs = allocations;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < packets; i++) {
+    bytes += PackFromPDUs(cid, source, &packer, send_buffer,
+                          static_cast<uint8_t>(i), buffer);
+  }
+  clock.CurrentTime(&end);
+  Report("PDU encode", end - start, packets, allocations - allocs);
+
+  E131PacketTemplate packet(cid, source, 1);
+  allocs = allocations;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < packets; i++) {
+    packet.Update(static_cast<uint8_t>(i), 100, false, buffer);
+    bytes += packet.Size();
+  }
+  clock.CurrentTime(&end);
+  Report("Template encode", end - start, packets, allocations - allocs);
+
+  if (bytes == 0) {
+    cout << "Failed to pack" << endl;
+  }
+}
+
+void RunSend(const CID &cid, const DmxBuffer &buffer, bool prebuilt,
+             uint16_t universes, unsigned int frames) {
+  SelectServer ss;
+  E131Node::Options options;
+  options.prebuilt_packets = prebuilt;
+  E131Node node(&ss, "", options, cid);
+  if (!node.Start()) {
+    cout << "Failed to start the E1.31 node" << endl;
+    return;
+  }
+
+  // The first frame sets up each universe.
+  for (uint16_t universe = 1; universe <= universes; universe++) {
+    node.SendDMX(universe, buffer);
+  }
+
+  Clock clock;
+  TimeStamp start, end;
+  uint64_t allocs = allocations;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < frames; i++) {
+    for (uint16_t universe = 1; universe <= universes; universe++) {
+      node.SendDMX(universe, buffer);
+    }
+  }
+  clock.CurrentTime(&end);
+  Report(prebuilt ? "Node, prebuilt" : "Node, PDUs", end - start,
+         frames * universes, allocations - allocs);
+  node.Stop();
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark building and sending E1.31 packets.");
+
+  if (FLAGS_packets == 0 || FLAGS_universes == 0 || FLAGS_frames == 0) {
+    cout << "Need at least 1 packet, universe and frame" << endl;
+    return 1;
+  }
+
+  CID cid = CID::Generate();
+  DmxBuffer buffer;
+  buffer.Blackout();
+
+  cout << "Encoding " << FLAGS_packets << " packets" << endl;
+  RunEncode(cid, buffer, FLAGS_packets);
+
+  if (FLAGS_send) {
+    cout << "Sending " << FLAGS_frames << " frames to " << FLAGS_universes
+         << " universes" << endl;
+    RunSend(cid, buffer, false, FLAGS_universes, FLAGS_frames);
+    RunSend(cid, buffer, true, FLAGS_universes, FLAGS_frames);
+  }
+  return 0;
+}
@@ -49,8 +49,14 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/E131Node.h \
     libs/acn/E131PDU.cpp \
     libs/acn/E131PDU.h \
+    libs/acn/E131PacketTemplate.cpp \
+    libs/acn/E131PacketTemplate.h \
     libs/acn/E131Sender.cpp \
     libs/acn/E131Sender.h \
+    libs/acn/E131SyncInflator.cpp \
+    libs/acn/E131SyncInflator.h \
+    libs/acn/E131SyncPDU.cpp \
+    libs/acn/E131SyncPDU.h \
     libs/acn/E133Header.h \
     libs/acn/E133Inflator.cpp \
     libs/acn/E133Inflator.h \
@@ -93,7 +99,9 @@ libs_acn_libolae131core_la_LIBADD = $(uuid_LIBS) \
 # PROGRAMS
 ##################################################
 noinst_PROGRAMS += libs/acn/e131_transmit_test \
-                   libs/acn/e131_loadtest
+                   libs/acn/e131_loadtest \
+                   libs/acn/e131_receive_loadtest \
+                   libs/acn/e131_transmit_benchmark
 libs_acn_e131_transmit_test_SOURCES = \
     libs/acn/e131_transmit_test.cpp \
     libs/acn/E131TestFramework.cpp \
@@ -103,6 +111,12 @@ libs_acn_e131_transmit_test_LDADD = libs/acn/libolae131core.la
 libs_acn_e131_loadtest_SOURCES = libs/acn/e131_loadtest.cpp
 libs_acn_e131_loadtest_LDADD = libs/acn/libolae131core.la
 
+libs_acn_e131_receive_loadtest_SOURCES = libs/acn/e131_receive_loadtest.cpp
+libs_acn_e131_receive_loadtest_LDADD = libs/acn/libolae131core.la
+
+libs_acn_e131_transmit_benchmark_SOURCES = libs/acn/E131TransmitBenchmark.cpp
+libs_acn_e131_transmit_benchmark_LDADD = libs/acn/libolae131core.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -114,10 +128,12 @@ libs_acn_E131Tester_SOURCES = \
     libs/acn/BaseInflatorTest.cpp \
     libs/acn/CIDTest.cpp \
     libs/acn/DMPAddressTest.cpp \
+    libs/acn/DMPE131InflatorTest.cpp \
     libs/acn/DMPInflatorTest.cpp \
     libs/acn/DMPPDUTest.cpp \
     libs/acn/E131InflatorTest.cpp \
     libs/acn/E131PDUTest.cpp \
+    libs/acn/E131PacketTemplateTest.cpp \
     libs/acn/HeaderSetTest.cpp \
     libs/acn/PDUTest.cpp \
     libs/acn/RootInflatorTest.cpp \
@@ -57,7 +57,22 @@ bool OutgoingUDPTransportImpl::Send(const PDUBlock<PDU> &pdu_block,
   if (!data)
     return false;
 
-  return m_socket->SendTo(data, data_size, destination);
+  return Send(data, data_size, destination);
+}
+
+
+/*
+ * Send a packed datagram using UDP.
+ * @param data the datagram, including the preamble
+ * @param length the size of the datagram
+ * @param destination the ipv4 address and port to send to
+ */
+bool OutgoingUDPTransportImpl::Send(const uint8_t *data,
+                                    unsigned int length,
+                                    const IPV4SocketAddress &destination) {
+  if (m_send_queue)
+    return m_send_queue->Add(data, length, destination);
+  return m_socket->SendTo(data, length, destination);
 }
 
 
@@ -74,22 +89,39 @@ IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
  * Called when new data arrives.
  */
 void IncomingUDPTransport::Receive() {
-  if (!m_recv_buffer)
-    m_recv_buffer = new uint8_t[PreamblePacker::MAX_DATAGRAM_SIZE];
+  if (!m_recv_buffer) {
+    m_recv_buffer =
+        new uint8_t[RECEIVE_BATCH_SIZE * PreamblePacker::MAX_DATAGRAM_SIZE];
+    m_datagrams.resize(RECEIVE_BATCH_SIZE);
+    for (unsigned int i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+      m_datagrams[i].buffer =
+          m_recv_buffer + i * PreamblePacker::MAX_DATAGRAM_SIZE;
+      m_datagrams[i].buffer_size = PreamblePacker::MAX_DATAGRAM_SIZE;
+    }
+  }
 
-  ssize_t size = PreamblePacker::MAX_DATAGRAM_SIZE;
-  ola::network::IPV4SocketAddress source;
+  unsigned int count = m_socket->RecvBatch(
+      &m_datagrams[0], static_cast<unsigned int>(m_datagrams.size()));
+  for (unsigned int i = 0; i < count; i++) {
+    HandleDatagram(m_datagrams[i].buffer, m_datagrams[i].size,
+                   m_datagrams[i].source);
+  }
+}
 
-  if (!m_socket->RecvFrom(m_recv_buffer, &size, &source))
-    return;
 
+/*
+ * Check the ACN header and inflate a datagram.
+ */
+void IncomingUDPTransport::HandleDatagram(const uint8_t *data,
+                                          unsigned int size,
+                                          const IPV4SocketAddress &source) {
   unsigned int header_size = PreamblePacker::ACN_HEADER_SIZE;
-  if (size < static_cast<ssize_t>(header_size)) {
+  if (size < header_size) {
     OLA_WARN << "short ACN frame, discarding";
     return;
   }
 
-  if (memcmp(m_recv_buffer, PreamblePacker::ACN_HEADER, header_size)) {
+  if (memcmp(data, PreamblePacker::ACN_HEADER, header_size)) {
     OLA_WARN << "ACN header is bad, discarding";
     return;
   }
@@ -98,11 +130,8 @@ void IncomingUDPTransport::Receive() {
   TransportHeader transport_header(source, TransportHeader::UDP);
   header_set.SetTransportHeader(transport_header);
 
-  m_inflator->InflatePDUBlock(
-      &header_set,
-      m_recv_buffer + header_size,
-      static_cast<unsigned int>(size) - header_size);
-  return;
+  m_inflator->InflatePDUBlock(&header_set, data + header_size,
+                              size - header_size);
 }
 }  // namespace acn
 }  // namespace ola
@@ -21,10 +21,13 @@
 #ifndef LIBS_ACN_UDPTRANSPORT_H_
 #define LIBS_ACN_UDPTRANSPORT_H_
 
+#include <vector>
+
 #include "ola/acn/ACNPort.h"
 #include "ola/base/Macro.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Socket.h"
+#include "ola/network/UDPSendQueue.h"
 #include "libs/acn/PDU.h"
 #include "libs/acn/PreamblePacker.h"
 #include "libs/acn/Transport.h"
@@ -65,7 +68,8 @@ class OutgoingUDPTransportImpl {
                              PreamblePacker *packer = NULL)
         : m_socket(socket),
           m_packer(packer),
-          m_free_packer(false) {
+          m_free_packer(false),
+          m_send_queue(NULL) {
       if (!m_packer) {
         m_packer = new PreamblePacker();
         m_free_packer = true;
@@ -79,10 +83,25 @@ class OutgoingUDPTransportImpl {
     bool Send(const PDUBlock<PDU> &pdu_block,
               const ola::network::IPV4SocketAddress &destination);
 
+    /*
+     * Send a datagram which has already been packed, including the preamble.
+     */
+    bool Send(const uint8_t *data, unsigned int length,
+              const ola::network::IPV4SocketAddress &destination);
+
+    /*
+     * Add datagrams to a queue rather than sending them. The caller is
+     * responsible for flushing the queue. Pass NULL to send immediately.
+     */
+    void SetSendQueue(ola::network::UDPSendQueue *queue) {
+      m_send_queue = queue;
+    }
+
  private:
     ola::network::UDPSocket *m_socket;
     PreamblePacker *m_packer;
     bool m_free_packer;
+    ola::network::UDPSendQueue *m_send_queue;
 };
 
 
@@ -102,10 +121,17 @@ class IncomingUDPTransport {
 
     void Receive();
 
+    // The most datagrams read each time the socket is readable.
+    static const unsigned int RECEIVE_BATCH_SIZE = 32;
+
  private:
     ola::network::UDPSocket *m_socket;
     class BaseInflator *m_inflator;
     uint8_t *m_recv_buffer;
+    std::vector<ola::network::IncomingDatagram> m_datagrams;
+
+    void HandleDatagram(const uint8_t *data, unsigned int size,
+                        const ola::network::IPV4SocketAddress &source);
 };
 }  // namespace acn
 }  // namespace ola
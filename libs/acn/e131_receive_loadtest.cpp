@@ -0,0 +1,337 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * e131_receive_loadtest.cpp
+ * Load test the E1.31 receive path.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * A sender thread plays several sources for many universes, at the same
+ * priority so every packet is merged, to a socket on the loopback interface.
+ * The main thread receives them with the same inflator chain E131Node uses,
+ * and reports the update rate, the packets lost and the CPU used by the
+ * receiving thread.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/acn/CID.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/RootInflator.h"
+#include "libs/acn/UDPTransport.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::acn::CID;
+using ola::acn::DMPE131Inflator;
+using ola::acn::E131Inflator;
+using ola::acn::E131PacketTemplate;
+using ola::acn::IncomingUDPTransport;
+using ola::acn::RootInflator;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::OutgoingDatagram;
+using ola::network::UDPSocket;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::cout;
+using std::endl;
+using std::vector;
+
+DEFINE_s_uint16(universes, u, 1000, "Number of universes to send");
+DEFINE_s_uint8(sources, s, 4, "Number of sources for each universe [1 - 6]");
+DEFINE_s_uint32(fps, f, 44, "Frames per second per universe");
+DEFINE_s_uint32(duration, d, 10,
+                "Stop after this many seconds, 0 runs forever");
+DEFINE_uint32(receive_buffer, 8 * 1024 * 1024,
+              "The size of the socket receive buffer");
+
+// DMPE131Inflator merges at most this many sources.
+static const uint8_t MAX_SOURCES = 6;
+
+/**
+ * Plays the sources from a separate thread. The packets for each frame are
+ * spread across the frame period, so the receiver sees a steady load.
+ */
+class SourceThread : public ola::thread::Thread {
+ public:
+  SourceThread(const IPV4SocketAddress &destination, uint16_t universes,
+               uint8_t sources, unsigned int fps)
+      : ola::thread::Thread(Options("e131-sources")),
+        m_destination(destination),
+        m_fps(fps),
+        m_stop(false),
+        m_sent(0) {
+    for (uint8_t source = 0; source < sources; source++) {
+      CID cid = CID::Generate();
+      for (uint16_t universe = 1; universe <= universes; universe++) {
+        m_packets.push_back(new E131PacketTemplate(cid, "loadtest", universe));
+      }
+    }
+  }
+
+  ~SourceThread() {
+    vector<E131PacketTemplate*>::iterator iter = m_packets.begin();
+    for (; iter != m_packets.end(); ++iter) {
+      delete *iter;
+    }
+  }
+
+  bool Init() { return m_socket.Init(); }
+
+  void Stop() {
+    MutexLocker locker(&m_mutex);
+    m_stop = true;
+  }
+
+  uint64_t Sent() {
+    MutexLocker locker(&m_mutex);
+    return m_sent;
+  }
+
+ protected:
+  void *Run();
+
+ private:
+  const IPV4SocketAddress m_destination;
+  const unsigned int m_fps;
+  UDPSocket m_socket;
+  vector<E131PacketTemplate*> m_packets;
+  Mutex m_mutex;
+  bool m_stop;
+  uint64_t m_sent;
+
+  static const unsigned int BATCH_SIZE = 64;
+};
+
+
+void *SourceThread::Run() {
+  Clock clock;
+  DmxBuffer buffer;
+  buffer.Blackout();
+  OutgoingDatagram datagrams[BATCH_SIZE];
+  const unsigned int packet_count = static_cast<unsigned int>(
+      m_packets.size());
+  const unsigned int batches = (packet_count + BATCH_SIZE - 1) / BATCH_SIZE;
+  const int64_t frame_usec = 1000000 / m_fps;
+  uint8_t sequence = 0;
+
+  TimeStamp next_frame;
+  clock.CurrentTime(&next_frame);
+  while (true) {
+    {
+      MutexLocker locker(&m_mutex);
+      if (m_stop) {
+        break;
+      }
+    }
+
+    const TimeStamp frame_start = next_frame;
+    next_frame += TimeInterval(frame_usec);
+    sequence++;
+
+    unsigned int index = 0;
+    for (unsigned int batch = 0; batch < batches; batch++) {
+      unsigned int count = 0;
+      for (; count < BATCH_SIZE && index < packet_count; count++, index++) {
+        E131PacketTemplate *packet = m_packets[index];
+        // Give each source different levels, so the merge has work to do.
+        buffer.SetChannel(0, static_cast<uint8_t>(sequence + index));
+        packet->Update(sequence, 100, false, buffer);
+        datagrams[count].data = packet->Data();
+        datagrams[count].size = packet->Size();
+        datagrams[count].destination = m_destination;
+      }
+      unsigned int sent = m_socket.SendBatch(datagrams, count);
+      {
+        MutexLocker locker(&m_mutex);
+        m_sent += sent;
+      }
+
+      TimeStamp now;
+      clock.CurrentTime(&now);
+      TimeStamp target = frame_start + TimeInterval(
+          frame_usec * (batch + 1) / batches);
+      if (target > now) {
+        usleep(static_cast<useconds_t>((target - now).AsInt()));
+      }
+    }
+  }
+  m_socket.Close();
+  return NULL;
+}
+
+
+/**
+ * Report the update rate, the loss and the CPU used by the receiver.
+ */
+class ReceiveReporter {
+ public:
+  explicit ReceiveReporter(SourceThread *sources)
+      : m_sources(sources),
+        m_updates(0),
+        m_last_updates(0),
+        m_last_sent(0) {
+    m_clock.CurrentTime(&m_last_time);
+    GetUsage(&m_last_usage);
+  }
+
+  void UniverseUpdated() { m_updates++; }
+
+  bool Report() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    struct rusage usage;
+    GetUsage(&usage);
+    uint64_t sent = m_sources->Sent();
+
+    double wall = static_cast<double>((now - m_last_time).AsInt());
+    double cpu = static_cast<double>(CPUTime(usage) - CPUTime(m_last_usage));
+    if (wall > 0) {
+      cout << std::fixed << std::setprecision(0)
+           << ((sent - m_last_sent) * 1000000.0 / wall) << " sent/s, "
+           << ((m_updates - m_last_updates) * 1000000.0 / wall)
+           << " updates/s, " << (sent - m_updates) << " lost, "
+           << std::setprecision(1) << (cpu * 100.0 / wall)
+           << "% receiver CPU" << endl;
+    }
+    m_last_time = now;
+    m_last_usage = usage;
+    m_last_updates = m_updates;
+    m_last_sent = sent;
+    return true;
+  }
+
+ private:
+  SourceThread *m_sources;
+  Clock m_clock;
+  TimeStamp m_last_time;
+  struct rusage m_last_usage;
+  uint64_t m_updates;
+  uint64_t m_last_updates;
+  uint64_t m_last_sent;
+
+  static void GetUsage(struct rusage *usage) {
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, usage);
+#else
+    getrusage(RUSAGE_SELF, usage);
+#endif  // RUSAGE_THREAD
+  }
+
+  static int64_t CPUTime(const struct rusage &usage) {
+    return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+            usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+};
+
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Load test the E1.31 receive path.");
+
+  if (FLAGS_universes == 0 || FLAGS_fps == 0 || FLAGS_sources == 0 ||
+      FLAGS_sources > MAX_SOURCES) {
+    cout << "Need 1 - 6 sources, and at least 1 universe and frame" << endl;
+    return 1;
+  }
+
+  SelectServer ss;
+  UDPSocket socket;
+  if (!socket.Init() ||
+      !socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0))) {
+    return 1;
+  }
+  int receive_buffer = static_cast<int>(FLAGS_receive_buffer);
+  if (setsockopt(socket.ReadDescriptor(), SOL_SOCKET, SO_RCVBUF,
+                 &receive_buffer, sizeof(receive_buffer))) {
+    OLA_WARN << "Failed to set the receive buffer size";
+  }
+  IPV4SocketAddress destination;
+  socket.GetSocketAddress(&destination);
+
+  // This matches the inflators E131Node uses for the ratified standard.
+  RootInflator root_inflator;
+  E131Inflator e131_inflator;
+  DMPE131Inflator dmp_inflator(false);
+  root_inflator.AddInflator(&e131_inflator);
+  e131_inflator.AddInflator(&dmp_inflator);
+  IncomingUDPTransport transport(&socket, &root_inflator);
+  socket.SetOnData(NewCallback(&transport, &IncomingUDPTransport::Receive));
+  ss.AddReadDescriptor(&socket);
+
+  SourceThread sources(destination, FLAGS_universes, FLAGS_sources,
+                       FLAGS_fps);
+  ReceiveReporter reporter(&sources);
+
+  vector<DmxBuffer> buffers(FLAGS_universes);
+  vector<uint8_t> priorities(FLAGS_universes);
+  for (uint16_t i = 0; i < FLAGS_universes; i++) {
+    dmp_inflator.SetHandler(
+        static_cast<uint16_t>(i + 1), &buffers[i], &priorities[i],
+        NewCallback(&reporter, &ReceiveReporter::UniverseUpdated));
+  }
+
+  if (!sources.Init() || !sources.Start()) {
+    return 1;
+  }
+
+  cout << "Sending " << static_cast<int>(FLAGS_sources) << " sources for "
+       << FLAGS_universes << " universes at " << FLAGS_fps << " fps to "
+       << destination << endl;
+  ss.RegisterRepeatingTimeout(
+      1000, NewCallback(&reporter, &ReceiveReporter::Report));
+  if (FLAGS_duration) {
+    ss.RegisterSingleTimeout(
+        FLAGS_duration * 1000,
+        NewSingleCallback(&ss, &SelectServer::Terminate));
+  }
+  ss.Run();
+
+  sources.Stop();
+  sources.Join();
+  ss.RemoveReadDescriptor(&socket);
+  for (uint16_t i = 1; i <= FLAGS_universes; i++) {
+    dmp_inflator.RemoveHandler(i);
+  }
+  return 0;
+}
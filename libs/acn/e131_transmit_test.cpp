@@ -207,10 +207,23 @@ RelaxedTestState s27("Terminate second source",
                      BufferFromString("100,100,100,100"),
                      BufferFromString("20,20,20,20"));
 
+// and finally synchronization, the data should be output once the sync packet
+// arrives.
+TestState s28("Synchronized Source",
+              new NodeSyncSend(20, "40,40,40,40"),
+              new NodeInactive(),
+              "40,40,40,40",
+              BufferFromString("40,40,40,40"));
+TestState s29("Source stops synchronizing",
+              new NodeSimpleSend(20, "50,50,50,50"),
+              new NodeInactive(),
+              "50,50,50,50",
+              BufferFromString("50,50,50,50"));
+
 TestState *states[] = {&s1, &s2, &s3, &s4, &s5, &s6, &s7, &s8, &s9, &s10,
                        &s11, &s11, &s12, &s13, &s14, &s15, &s16, &s17, &s18,
                        &s19, &s20, &s21, &s22, &s23, &s24, &s25, &s26, &s27,
-                       NULL};
+                       &s28, &s29, NULL};
 
 
 /*
@@ -158,6 +158,12 @@ void OlaClient::RegisterUniverse(unsigned int universe,
   m_core->RegisterUniverse(universe, register_action, callback);
 }
 
+void OlaClient::RegisterUniverse(unsigned int universe,
+                                 RegisterAction register_action,
+                                 const RegisterArgs &args) {
+  m_core->RegisterUniverse(universe, register_action, args);
+}
+
 void OlaClient::SendDMX(unsigned int universe,
                         const DmxBuffer &data,
                         const SendDMXArgs &args) {
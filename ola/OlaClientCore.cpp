@@ -444,6 +444,13 @@ void OlaClientCore::Patch(unsigned int device_alias,
 void OlaClientCore::RegisterUniverse(unsigned int universe,
                                      RegisterAction register_action,
                                      SetCallback *callback) {
+  RegisterUniverse(universe, register_action, RegisterArgs(callback));
+}
+
+void OlaClientCore::RegisterUniverse(unsigned int universe,
+                                     RegisterAction register_action,
+                                     const RegisterArgs &args) {
+  SetCallback *callback = args.callback;
   ola::proto::RegisterDmxRequest request;
   RpcController *controller = new RpcController();
   ola::proto::Ack *reply = new ola::proto::Ack();
@@ -453,6 +460,13 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
         ola::proto::UNREGISTER);
   request.set_universe(universe);
   request.set_action(action);
+  if (args.skip_unchanged_frames) {
+    request.set_skip_unchanged_frames(true);
+    request.set_keep_alive_ms(args.keep_alive_ms);
+  }
+  if (args.max_frame_rate) {
+    request.set_max_frame_rate(args.max_frame_rate);
+  }
 
   if (m_connected) {
     CompletionCallback *cb = ola::NewSingleCallback(
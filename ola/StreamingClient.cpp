@@ -30,18 +30,42 @@
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
 
+#include <unistd.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "common/dmx/SharedDmx.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 
 namespace ola {
 namespace client {
 
+using ola::dmx::SharedDmxListener;
+using ola::dmx::SharedDmxWriter;
 using ola::io::SelectServer;
 using ola::network::TCPSocket;
 using ola::proto::OlaServerService_Stub;
 using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using std::auto_ptr;
+using std::map;
+using std::vector;
+
+namespace {
+
+// How often to check the RPC connection when the data is sent using shared
+// memory. Checking costs a call to RunOnce() so we don't do it for each frame.
+const TimeInterval SHARED_CONNECTION_CHECK_INTERVAL(0, 100000);
+
+void AttachComplete(bool *done) {
+  *done = true;
+}
+}  // namespace
 
 StreamingClient::StreamingClient(bool auto_start)
     : m_auto_start(auto_start),
@@ -50,7 +74,11 @@ StreamingClient::StreamingClient(bool auto_start)
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_batch(NULL),
+      m_use_shared_memory(false),
+      m_shared_memory_universes(0),
+      m_shared_writer(NULL) {
 }
 
 StreamingClient::StreamingClient(const Options &options)
@@ -60,11 +88,16 @@ StreamingClient::StreamingClient(const Options &options)
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_batch(NULL),
+      m_use_shared_memory(options.use_shared_memory),
+      m_shared_memory_universes(options.shared_memory_universes),
+      m_shared_writer(NULL) {
 }
 
 StreamingClient::~StreamingClient() {
   Stop();
+  delete m_batch;
 }
 
 bool StreamingClient::Setup() {
@@ -105,10 +138,23 @@ bool StreamingClient::Setup() {
   m_channel->SetChannelCloseHandler(
       NewSingleCallback(this, &StreamingClient::ChannelClosed));
 
+  if (m_use_shared_memory && SharedDmxWriter::Supported()) {
+    if (!AttachSharedMemory()) {
+      if (!m_stub) {
+        // The connection was closed
+        return false;
+      }
+      OLA_WARN << "Failed to set up shared memory, falling back to RPCs";
+    }
+  }
   return true;
 }
 
 void StreamingClient::Stop() {
+  delete m_shared_writer;
+  m_shared_writer = NULL;
+  m_shared_slots.clear();
+
   if (m_stub)
     delete m_stub;
 
@@ -138,8 +184,76 @@ bool StreamingClient::SendDMX(unsigned int universe,
   return Send(universe, args.priority, data);
 }
 
+bool StreamingClient::SendDMXBatch(const vector<UniverseData> &universes) {
+  if (!(m_shared_writer ? CheckSharedConnection() : CheckConnection()))
+    return false;
+
+  if (!m_batch)
+    m_batch = new ola::proto::DmxDataBatch();
+
+  // Clear() keeps the DmxData messages around, so once the batch has grown to
+  // the number of universes in use the DmxData objects are reused.
+  m_batch->Clear();
+  bool signal = false;
+  vector<UniverseData>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    unsigned int slot;
+    if (SharedSlot(iter->universe, &slot)) {
+      m_shared_writer->Write(slot, iter->universe, iter->priority, iter->data);
+      signal = true;
+      continue;
+    }
+
+    ola::proto::DmxData *data = m_batch->add_data();
+    data->set_universe(iter->universe);
+    data->set_data(reinterpret_cast<const char*>(iter->data.GetRaw()),
+                   iter->data.Size());
+    data->set_priority(iter->priority);
+
+    if (static_cast<unsigned int>(m_batch->data_size()) ==
+        MAX_BATCH_UNIVERSES) {
+      if (!SendBatch())
+        return false;
+      m_batch->Clear();
+    }
+  }
+
+  if (signal)
+    m_shared_writer->Signal();
+
+  if (m_batch->data_size())
+    return SendBatch();
+  return true;
+}
+
 bool StreamingClient::Send(unsigned int universe, uint8_t priority,
                            const DmxBuffer &data) {
+  unsigned int slot;
+  if (SharedSlot(universe, &slot)) {
+    if (!CheckSharedConnection())
+      return false;
+    m_shared_writer->Write(slot, universe, priority, data);
+    m_shared_writer->Signal();
+    return true;
+  }
+
+  if (!CheckConnection())
+    return false;
+
+  ola::proto::DmxData request;
+  request.set_universe(universe);
+  request.set_data(data.Get());
+  request.set_priority(priority);
+  m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+
+  if (m_socket_closed) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+bool StreamingClient::CheckConnection() {
   if (!m_stub || !m_socket->ValidReadDescriptor())
     return false;
 
@@ -153,17 +267,100 @@ bool StreamingClient::Send(unsigned int universe, uint8_t priority,
     Stop();
     return false;
   }
+  return true;
+}
 
-  ola::proto::DmxData request;
-  request.set_universe(universe);
-  request.set_data(data.Get());
-  request.set_priority(priority);
-  m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+bool StreamingClient::CheckSharedConnection() {
+  if (!m_stub)
+    return false;
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  if (now - m_last_connection_check < SHARED_CONNECTION_CHECK_INTERVAL)
+    return true;
+  m_last_connection_check = now;
+  return CheckConnection();
+}
+
+bool StreamingClient::SendBatch() {
+  m_stub->StreamDmxDataBatch(NULL, m_batch, NULL, NULL);
+
+  if (m_socket_closed) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Create a shared region and ask olad to attach to it. This blocks until olad
+ * responds.
+ */
+bool StreamingClient::AttachSharedMemory() {
+  auto_ptr<SharedDmxWriter> writer(new SharedDmxWriter());
+  if (!writer->Init(m_shared_memory_universes))
+    return false;
+
+  // The token only needs to be unique amongst the clients attaching at the
+  // same time.
+  static unsigned int attach_count = 0;
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  uint64_t token = (static_cast<uint64_t>(getpid()) << 32) ^
+      (static_cast<uint64_t>(now.Seconds()) * USEC_IN_SECONDS +
+       now.MicroSeconds()) ^
+      (static_cast<uint64_t>(attach_count++) << 48);
+
+  if (!writer->SendDescriptors(SharedDmxListener::ListenerName(m_server_port),
+                               token))
+    return false;
+
+  ola::proto::SharedDmxRequest request;
+  request.set_token(token);
+  ola::proto::Ack reply;
+  RpcController controller;
+  bool done = false;
+  m_socket_closed = false;
+  m_stub->AttachSharedDmx(&controller, &request, &reply,
+                          ola::NewSingleCallback(AttachComplete, &done));
+  while (!done && !m_socket_closed) {
+    m_ss->RunOnce(TimeInterval(1, 0));
+  }
 
   if (m_socket_closed) {
     Stop();
     return false;
   }
+
+  if (controller.Failed()) {
+    OLA_INFO << "olad rejected the shared memory region: "
+             << controller.ErrorText();
+    return false;
+  }
+
+  m_shared_writer = writer.release();
+  m_clock.CurrentTime(&m_last_connection_check);
+  return true;
+}
+
+/*
+ * Find the shared memory slot for a universe, allocating one if required.
+ */
+bool StreamingClient::SharedSlot(unsigned int universe, unsigned int *slot) {
+  if (!m_shared_writer)
+    return false;
+
+  map<unsigned int, unsigned int>::const_iterator iter =
+      m_shared_slots.find(universe);
+  if (iter != m_shared_slots.end()) {
+    *slot = iter->second;
+    return true;
+  }
+
+  if (m_shared_slots.size() >= m_shared_writer->SlotCount())
+    return false;
+  *slot = m_shared_slots.size();
+  m_shared_slots[universe] = *slot;
   return true;
 }
 
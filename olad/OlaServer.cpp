@@ -27,9 +27,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <memory>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "common/dmx/SharedDmx.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcServer.h"
@@ -37,6 +40,7 @@
 #include "ola/Constants.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Flags.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
@@ -45,6 +49,7 @@
 #include "ola/stl/STLUtils.h"
 #include "olad/ClientBroker.h"
 #include "olad/DiscoveryAgent.h"
+#include "olad/FrameClock.h"
 #include "olad/OlaServer.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
@@ -67,9 +72,16 @@ DEFINE_s_uint16(rpc_port, r, ola::OlaServer::DEFAULT_RPC_PORT,
                 "The port to listen for RPCs on. Defaults to 9010.");
 DEFINE_default_bool(register_with_dns_sd, true,
                     "Don't register the web service using DNS-SD (Bonjour).");
+DEFINE_string(plugin_threads, "",
+              "A comma separated list of plugin ids to run in their own "
+              "threads, or 'all'.");
+DEFINE_uint32(frame_clock_rate, 0,
+              "If set, write to the output ports at this many frames per "
+              "second (up to 10000), rather than when new data arrives.");
 
 namespace ola {
 
+using ola::dmx::SharedDmxListener;
 using ola::proto::OlaClientService_Stub;
 using ola::rdm::RootPidStore;
 using ola::rpc::RpcChannel;
@@ -77,6 +89,8 @@ using ola::rpc::RpcSession;
 using ola::rpc::RpcServer;
 using std::auto_ptr;
 using std::pair;
+using std::set;
+using std::string;
 using std::vector;
 
 const char OlaServer::INSTANCE_NAME_KEY[] = "instance-name";
@@ -124,6 +138,11 @@ OlaServer::~OlaServer() {
   // Shutdown the RPC server first since it depends on almost everything else.
   m_rpc_server.reset();
 
+  if (m_shared_dmx_listener.get()) {
+    m_ss->RemoveReadDescriptor(m_shared_dmx_listener->GetDescriptor());
+    m_shared_dmx_listener.reset();
+  }
+
   if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
   }
@@ -137,6 +156,7 @@ OlaServer::~OlaServer() {
     m_universe_store->DeleteAll();
     m_universe_store.reset();
   }
+  m_frame_clock.reset();
 
   if (m_server_preferences) {
     m_server_preferences->Save();
@@ -209,8 +229,20 @@ bool OlaServer::Init() {
       UNIVERSE_PREFERENCES);
   universe_preferences->Load();
 
+  auto_ptr<FrameClock> frame_clock;
+  if (FLAGS_frame_clock_rate) {
+    frame_clock.reset(
+        new FrameClock(m_ss, FLAGS_frame_clock_rate, m_export_map));
+    if (!frame_clock->Start()) {
+      OLA_WARN << "Failed to start the frame clock, output will be sent as "
+               << "soon as it arrives";
+      frame_clock.reset();
+    }
+  }
+
   auto_ptr<UniverseStore> universe_store(
-      new UniverseStore(universe_preferences, m_export_map));
+      new UniverseStore(universe_preferences, m_export_map,
+                        frame_clock.get()));
 
   auto_ptr<PortBroker> port_broker(new PortBroker());
 
@@ -225,11 +257,30 @@ bool OlaServer::Init() {
   auto_ptr<PluginAdaptor> plugin_adaptor(
       new PluginAdaptor(device_manager.get(), m_ss, m_export_map,
                         m_preferences_factory, port_broker.get(),
-                        &m_instance_name));
+                        &m_instance_name, frame_clock.get()));
 
   auto_ptr<PluginManager> plugin_manager(
     new PluginManager(m_plugin_loaders, plugin_adaptor.get()));
 
+  if (!FLAGS_plugin_threads.str().empty()) {
+    set<ola_plugin_id> plugin_ids;
+    bool all_plugins = false;
+    vector<string> tokens;
+    StringSplit(FLAGS_plugin_threads.str(), &tokens, ",");
+    vector<string>::const_iterator iter = tokens.begin();
+    for (; iter != tokens.end(); ++iter) {
+      unsigned int plugin_id;
+      if (*iter == "all") {
+        all_plugins = true;
+      } else if (StringToInt(*iter, &plugin_id) && plugin_id) {
+        plugin_ids.insert(static_cast<ola_plugin_id>(plugin_id));
+      } else {
+        OLA_WARN << "Invalid plugin id in --plugin-threads: " << *iter;
+      }
+    }
+    plugin_manager->EnablePluginThreads(m_ss, plugin_ids, all_plugins);
+  }
+
   auto_ptr<OlaServerServiceImpl> service_impl(new OlaServerServiceImpl(
       universe_store.get(),
       device_manager.get(),
@@ -294,16 +345,34 @@ bool OlaServer::Init() {
         options);
   }
 
+  // Local clients can pass DMX data to us using shared memory. This is
+  // optional, clients fall back to the RPC socket if it's not available.
+  auto_ptr<SharedDmxListener> shared_dmx_listener;
+  if (ola::dmx::SharedDmxWriter::Supported()) {
+    shared_dmx_listener.reset(new SharedDmxListener());
+    if (shared_dmx_listener->Init(SharedDmxListener::ListenerName(
+            rpc_server->ListenAddress().V4Addr().Port()))) {
+      shared_dmx_listener->GetDescriptor()->SetOnData(NewCallback(
+          shared_dmx_listener.get(), &SharedDmxListener::ReceiveDescriptors));
+      m_ss->AddReadDescriptor(shared_dmx_listener->GetDescriptor());
+      service_impl->EnableSharedDmx(m_ss, shared_dmx_listener.get());
+    } else {
+      shared_dmx_listener.reset();
+    }
+  }
+
   // Ok, we've created and initialized everything correctly by this point. Now
   // we save all the pointers and schedule the last of the callbacks.
   m_device_manager.reset(device_manager.release());
   m_discovery_agent.reset(discovery_agent.release());
+  m_frame_clock.reset(frame_clock.release());
   m_plugin_adaptor.reset(plugin_adaptor.release());
   m_plugin_manager.reset(plugin_manager.release());
   m_port_broker.reset(port_broker.release());
   m_port_manager.reset(port_manager.release());
   m_rpc_server.reset(rpc_server.release());
   m_service_impl.reset(service_impl.release());
+  m_shared_dmx_listener.reset(shared_dmx_listener.release());
   m_universe_store.reset(universe_store.release());
 
   UpdatePidStore(pid_store.release());
@@ -357,6 +426,7 @@ ola::network::GenericSocketAddress OlaServer::LocalRPCAddress() const {
 void OlaServer::NewClient(RpcSession *session) {
   OlaClientService_Stub *stub = new OlaClientService_Stub(session->Channel());
   Client *client = new Client(stub, m_default_uid);
+  client->EnableSendQueue(m_ss, m_export_map);
   session->SetData(static_cast<void*>(client));
   m_broker->AddClient(client);
 }
@@ -366,6 +436,9 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   session->SetData(NULL);
 
   m_broker->RemoveClient(client.get());
+  if (m_service_impl.get()) {
+    m_service_impl->ClientRemoved(client.get());
+  }
 
   vector<Universe*> universe_list;
   m_universe_store->GetList(&universe_list);
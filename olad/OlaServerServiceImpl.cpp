@@ -20,8 +20,10 @@
  */
 
 #include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
+#include "common/dmx/SharedDmx.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
@@ -30,15 +32,19 @@
 #include "ola/Logging.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
 #include "ola/timecode/TimeCode.h"
 #include "ola/timecode/TimeCodeEnums.h"
 #include "olad/ClientBroker.h"
 #include "olad/Device.h"
 #include "olad/DmxSource.h"
+#include "olad/DmxUpdateFilter.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
 #include "olad/PluginManager.h"
+#include "olad/PluginThread.h"
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
@@ -49,6 +55,8 @@
 namespace ola {
 
 using ola::CallbackRunner;
+using ola::dmx::SharedDmxFrame;
+using ola::dmx::SharedDmxReader;
 using ola::proto::Ack;
 using ola::proto::DeviceConfigReply;
 using ola::proto::DeviceConfigRequest;
@@ -124,7 +132,26 @@ OlaServerServiceImpl::OlaServerServiceImpl(
       m_port_manager(port_manager),
       m_broker(broker),
       m_wake_up_time(wake_up_time),
-      m_reload_plugins_callback(reload_plugins_callback) {
+      m_reload_plugins_callback(reload_plugins_callback),
+      m_ss(NULL),
+      m_shared_dmx_listener(NULL) {
+}
+
+OlaServerServiceImpl::~OlaServerServiceImpl() {
+  while (!m_shared_dmx.empty()) {
+    RemoveSharedDmx(m_shared_dmx.begin()->first);
+  }
+}
+
+void OlaServerServiceImpl::EnableSharedDmx(
+    ola::io::SelectServerInterface *ss,
+    ola::dmx::SharedDmxListener *listener) {
+  m_ss = ss;
+  m_shared_dmx_listener = listener;
+}
+
+void OlaServerServiceImpl::ClientRemoved(Client *client) {
+  RemoveSharedDmx(client);
 }
 
 void OlaServerServiceImpl::GetDmx(
@@ -157,9 +184,27 @@ void OlaServerServiceImpl::RegisterForDmx(
 
   Client *client = GetClient(controller);
   if (request->action() == ola::proto::REGISTER) {
+    if (client) {
+      TimeInterval keep_alive = DmxUpdateFilter::DEFAULT_KEEP_ALIVE;
+      if (request->keep_alive_ms()) {
+        keep_alive = TimeInterval(
+            static_cast<int64_t>(request->keep_alive_ms()) * ONE_THOUSAND);
+      }
+      client->SetUpdateMode(
+          universe->UniverseId(),
+          request->skip_unchanged_frames() ?
+            DmxUpdateFilter::SKIP_UNCHANGED_FRAMES :
+            DmxUpdateFilter::SEND_ALL_FRAMES,
+          keep_alive);
+      client->SetMaxFrameRate(universe->UniverseId(),
+                              request->max_frame_rate());
+    }
     universe->AddSinkClient(client);
   } else {
     universe->RemoveSinkClient(client);
+    if (client) {
+      client->RemoveUniverse(universe->UniverseId());
+    }
   }
 }
 
@@ -169,25 +214,11 @@ void OlaServerServiceImpl::UpdateDmxData(
     Ack*,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
-  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  Client *client = GetClient(controller);
+  Universe *universe = ApplyDmxData(client, *request);
   if (!universe) {
     return MissingUniverseError(controller);
   }
-
-  Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
-
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
-  }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
   universe->SourceClientDataChanged(client);
 }
 
@@ -196,27 +227,62 @@ void OlaServerServiceImpl::StreamDmxData(
     const ola::proto::DmxData* request,
     ola::proto::STREAMING_NO_RESPONSE*,
     ola::rpc::RpcService::CompletionCallback*) {
-  Universe *universe = m_universe_store->GetUniverse(request->universe());
-
-  if (!universe) {
-    return;
+  Client *client = GetClient(controller);
+  Universe *universe = ApplyDmxData(client, *request);
+  if (universe) {
+    universe->SourceClientDataChanged(client);
   }
+}
 
+void OlaServerServiceImpl::StreamDmxDataBatch(
+    RpcController *controller,
+    const ola::proto::DmxDataBatch* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
   Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
 
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
+  // Store the data for every universe first, so that if a universe appears
+  // more than once in the batch the merge and output only happen once.
+  m_batch_universes.clear();
+  m_batch_seen.clear();
+  for (int i = 0; i < request->data_size(); i++) {
+    Universe *universe = ApplyDmxData(client, request->data(i));
+    if (universe) {
+      AddBatchUniverse(universe);
+    }
   }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
-  universe->SourceClientDataChanged(client);
+
+  UpdateBatchUniverses(client);
+}
+
+void OlaServerServiceImpl::AttachSharedDmx(
+    RpcController *controller,
+    const ola::proto::SharedDmxRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_shared_dmx_listener) {
+    controller->SetFailed("Shared memory is not supported");
+    return;
+  }
+
+  // The client sends the region before the request, so it's either already
+  // been received or is waiting on the socket.
+  m_shared_dmx_listener->ReceiveDescriptors();
+  SharedDmxReader *reader = m_shared_dmx_listener->Claim(request->token());
+  if (!reader) {
+    controller->SetFailed("Unknown shared memory region");
+    return;
+  }
+
+  Client *client = GetClient(controller);
+  RemoveSharedDmx(client);
+  reader->Doorbell()->SetOnData(
+      NewCallback(this, &OlaServerServiceImpl::SharedDmxReady, client));
+  m_ss->AddReadDescriptor(reader->Doorbell());
+  m_shared_dmx[client] = reader;
+  OLA_INFO << "Client attached a shared region with " << reader->SlotCount()
+           << " slots";
 }
 
 void OlaServerServiceImpl::SetUniverseName(
@@ -452,7 +518,7 @@ void OlaServerServiceImpl::GetPluginDescription(
 
   if (plugin) {
     response->set_name(plugin->Name());
-    response->set_description(plugin->Description());
+    response->set_description(PluginThread::PluginDescription(plugin));
   } else {
     controller->SetFailed("Plugin not loaded");
   }
@@ -658,8 +724,8 @@ void OlaServerServiceImpl::ConfigureDevice(
     return;
   }
 
-  device->Configure(controller, request->data(),
-                    response->mutable_data(), done);
+  PluginThread::Configure(device, controller, request->data(),
+                          response->mutable_data(), done);
 }
 
 void OlaServerServiceImpl::GetUIDs(
@@ -1010,7 +1076,7 @@ void OlaServerServiceImpl::PopulatePort(const PortClass &port,
                                         PortInfo *port_info) const {
   port_info->set_port_id(port.PortId());
   port_info->set_priority_capability(port.PriorityCapability());
-  port_info->set_description(port.Description());
+  port_info->set_description(PluginThread::PortDescription(&port));
 
   if (port.GetUniverse()) {
     port_info->set_active(true);
@@ -1035,6 +1101,99 @@ void OlaServerServiceImpl::SetProtoUID(const ola::rdm::UID &uid,
   pb_uid->set_device_id(uid.DeviceId());
 }
 
+/*
+ * Store the data from a DmxData message against the client.
+ * @returns the universe the data is for, or NULL if it doesn't exist.
+ */
+Universe *OlaServerServiceImpl::ApplyDmxData(Client *client,
+                                             const DmxData &data) {
+  DmxBuffer buffer;
+  buffer.Set(data.data());
+
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (data.has_priority()) {
+    priority = data.priority();
+  }
+  return ApplyDmx(client, data.universe(), priority, buffer);
+}
+
+/*
+ * Store DMX data against the client.
+ * @returns the universe the data is for, or NULL if it doesn't exist.
+ */
+Universe *OlaServerServiceImpl::ApplyDmx(Client *client,
+                                         unsigned int universe_id,
+                                         uint8_t priority,
+                                         const DmxBuffer &buffer) {
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (!universe) {
+    return NULL;
+  }
+
+  priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                      priority);
+  priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                      priority);
+  DmxSource source(buffer, *m_wake_up_time, priority);
+  client->DMXReceived(universe_id, source);
+  return universe;
+}
+
+/*
+ * Add a universe to the current batch, unless it's already in it.
+ */
+void OlaServerServiceImpl::AddBatchUniverse(Universe *universe) {
+  if (m_batch_seen.insert(universe).second) {
+    m_batch_universes.push_back(universe);
+  }
+}
+
+/*
+ * Merge and send each of the universes in m_batch_universes once, in the
+ * order the batch listed them.
+ */
+void OlaServerServiceImpl::UpdateBatchUniverses(Client *client) {
+  vector<Universe*>::iterator iter = m_batch_universes.begin();
+  for (; iter != m_batch_universes.end(); ++iter) {
+    (*iter)->SourceClientDataChanged(client);
+  }
+  m_batch_universes.clear();
+  m_batch_seen.clear();
+}
+
+/*
+ * Called when a client signals its shared region has new data.
+ */
+void OlaServerServiceImpl::SharedDmxReady(Client *client) {
+  SharedDmxReader *reader = STLFindOrNull(m_shared_dmx, client);
+  if (!reader) {
+    return;
+  }
+
+  reader->DrainDoorbell();
+  m_batch_universes.clear();
+  m_batch_seen.clear();
+  SharedDmxFrame frame;
+  for (unsigned int slot = 0; slot < reader->SlotCount(); slot++) {
+    if (reader->ReadSlot(slot, &frame)) {
+      Universe *universe = ApplyDmx(client, frame.universe, frame.priority,
+                                    frame.data);
+      if (universe) {
+        AddBatchUniverse(universe);
+      }
+    }
+  }
+  UpdateBatchUniverses(client);
+}
+
+void OlaServerServiceImpl::RemoveSharedDmx(Client *client) {
+  SharedDmxReader *reader = STLLookupAndRemovePtr(&m_shared_dmx, client);
+  if (reader) {
+    m_ss->RemoveReadDescriptor(reader->Doorbell());
+    delete reader;
+  }
+}
+
 Client* OlaServerServiceImpl::GetClient(ola::rpc::RpcController *controller) {
   return reinterpret_cast<Client*>(controller->Session()->GetData());
 }
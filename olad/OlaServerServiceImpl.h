@@ -18,7 +18,10 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <stdint.h>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include "common/protocol/Ola.pb.h"
@@ -34,6 +37,13 @@
 
 namespace ola {
 
+namespace dmx {
+class SharedDmxListener;
+class SharedDmxReader;
+}
+namespace io { class SelectServerInterface; }
+
+class DmxBuffer;
 class Universe;
 
 /**
@@ -43,9 +53,10 @@ class Universe;
  * class. This therefore contains all the methods a client can invoke on the
  * server.
  *
- * There is no client specific member data, so a single OlaServerServiceImpl
- * is created. Any OLA client data is passed via the user data in the
- * ola::rpc::RpcSession object, accessible via the ola::rpc::RpcController.
+ * A single OlaServerServiceImpl is created. Any OLA client data is passed via
+ * the user data in the ola::rpc::RpcSession object, accessible via the
+ * ola::rpc::RpcController. The only client specific state held here is the
+ * shared memory region, if the client has attached one.
  */
 class OlaServerServiceImpl : public ola::proto::OlaServerService {
  public:
@@ -65,7 +76,21 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        const class TimeStamp *wake_up_time,
                        ReloadPluginsCallback *reload_plugins_callback);
 
-  ~OlaServerServiceImpl() {}
+  ~OlaServerServiceImpl();
+
+  /**
+   * @brief Allow clients to send DMX data using shared memory.
+   * @param ss the SelectServer to register the regions' doorbells with.
+   * @param listener the SharedDmxListener that receives the regions.
+   */
+  void EnableSharedDmx(ola::io::SelectServerInterface *ss,
+                       ola::dmx::SharedDmxListener *listener);
+
+  /**
+   * @brief Release any state held for a client.
+   * @param client the client that has disconnected.
+   */
+  void ClientRemoved(class Client *client);
 
   /**
    * @brief Returns the current DMX values for a particular universe.
@@ -98,6 +123,28 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                      const ::ola::proto::DmxData* request,
                      ::ola::proto::STREAMING_NO_RESPONSE* response,
                      ola::rpc::RpcService::CompletionCallback* done);
+  /**
+   * @brief Handle a streaming update for many universes, no response is sent.
+   *
+   * The data for every universe is stored before any merging takes place, so
+   * each universe in the batch is merged and sent to its output ports once.
+   */
+  void StreamDmxDataBatch(ola::rpc::RpcController* controller,
+                          const ::ola::proto::DmxDataBatch* request,
+                          ::ola::proto::STREAMING_NO_RESPONSE* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+  /**
+   * @brief Attach a shared memory region that the client has passed to the
+   * SharedDmxListener.
+   *
+   * Once attached, the client's DMX data is read from the region each time
+   * the region's doorbell is signalled. This replaces any region the client
+   * had previously attached.
+   */
+  void AttachSharedDmx(ola::rpc::RpcController* controller,
+                       const ::ola::proto::SharedDmxRequest* request,
+                       ::ola::proto::Ack* response,
+                       ola::rpc::RpcService::CompletionCallback* done);
 
 
   /**
@@ -288,6 +335,14 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
 
   void SetProtoUID(const ola::rdm::UID &uid, ola::proto::UID *pb_uid);
 
+  Universe *ApplyDmxData(class Client *client,
+                         const ola::proto::DmxData &data);
+  Universe *ApplyDmx(class Client *client, unsigned int universe_id,
+                     uint8_t priority, const DmxBuffer &buffer);
+  void AddBatchUniverse(Universe *universe);
+  void UpdateBatchUniverses(class Client *client);
+  void SharedDmxReady(class Client *client);
+  void RemoveSharedDmx(class Client *client);
   class Client* GetClient(ola::rpc::RpcController *controller);
 
   UniverseStore *m_universe_store;
@@ -297,6 +352,12 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
   class ClientBroker *m_broker;
   const class TimeStamp *m_wake_up_time;
   std::auto_ptr<ReloadPluginsCallback> m_reload_plugins_callback;
+  // The universes in the current batch, in the order they first appeared.
+  std::vector<Universe*> m_batch_universes;
+  std::set<Universe*> m_batch_seen;
+  ola::io::SelectServerInterface *m_ss;
+  ola::dmx::SharedDmxListener *m_shared_dmx_listener;
+  std::map<class Client*, ola::dmx::SharedDmxReader*> m_shared_dmx;
 };
 }  // namespace ola
 #endif  // OLAD_OLASERVERSERVICEIMPL_H_
@@ -23,8 +23,11 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
 #include <string>
+#include <vector>
 
+#include "common/dmx/SharedDmx.h"
 #include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
@@ -33,6 +36,8 @@
 #include "ola/DmxBuffer.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "olad/OlaServerServiceImpl.h"
@@ -49,15 +54,21 @@ using ola::DmxBuffer;
 using ola::OlaServerServiceImpl;
 using ola::Universe;
 using ola::UniverseStore;
+using ola::dmx::SharedDmxListener;
+using ola::dmx::SharedDmxWriter;
+using ola::io::SelectServer;
 using ola::rpc::RpcController;
 using ola::rpc::RpcSession;
 using std::string;
+using std::vector;
 
 class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OlaServerServiceImplTest);
   CPPUNIT_TEST(testGetDmx);
   CPPUNIT_TEST(testRegisterForDmx);
   CPPUNIT_TEST(testUpdateDmxData);
+  CPPUNIT_TEST(testStreamDmxDataBatch);
+  CPPUNIT_TEST(testAttachSharedDmx);
   CPPUNIT_TEST(testSetUniverseName);
   CPPUNIT_TEST(testSetMergeMode);
   CPPUNIT_TEST_SUITE_END();
@@ -74,6 +85,8 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     void testGetDmx();
     void testRegisterForDmx();
     void testUpdateDmxData();
+    void testStreamDmxDataBatch();
+    void testAttachSharedDmx();
     void testSetUniverseName();
     void testSetMergeMode();
 
@@ -81,6 +94,7 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     ola::rdm::UID m_uid;
     ola::Clock m_clock;
 
+    void SetFlag(bool *flag) { *flag = true; }
     void CallGetDmx(OlaServerServiceImpl *service,
                     int universe_id,
                     class GetDmxCheck *check);
@@ -422,6 +436,179 @@ void OlaServerServiceImplTest::CallUpdateDmxData(
   service->UpdateDmxData(&controller, &request, &response, closure);
 }
 
+/*
+ * A sink client which records the universes it's sent DMX for.
+ */
+class RecordingSinkClient: public Client {
+ public:
+  explicit RecordingSinkClient(const ola::rdm::UID &uid)
+      : Client(NULL, uid) {}
+
+  bool SendDMX(unsigned int universe_id, uint8_t, const DmxBuffer&) {
+    universes.push_back(universe_id);
+    return true;
+  }
+
+  vector<unsigned int> universes;
+};
+
+/*
+ * Check the StreamDmxDataBatch method works
+ */
+void OlaServerServiceImplTest::testStreamDmxDataBatch() {
+  UniverseStore store(NULL, NULL);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+  m_clock.CurrentTime(&time1);
+
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  DmxBuffer dmx_data1("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  DmxBuffer dmx_data3("the last update");
+
+  // The batch contains a universe that doesn't exist, and the first universe
+  // twice, in which case the last update wins.
+  ola::proto::DmxDataBatch request;
+  ola::proto::DmxData *data = request.add_data();
+  data->set_universe(1);
+  data->set_data(dmx_data1.Get());
+  data = request.add_data();
+  data->set_universe(2);
+  data->set_data(dmx_data2.Get());
+  data = request.add_data();
+  data->set_universe(3);
+  data->set_data(dmx_data2.Get());
+  data = request.add_data();
+  data->set_universe(1);
+  data->set_data(dmx_data3.Get());
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+
+  OLA_ASSERT_EQ(dmx_data3, universe1->GetDMX());
+  OLA_ASSERT_EQ(dmx_data2, universe2->GetDMX());
+  OLA_ASSERT_FALSE(store.GetUniverse(3));
+  OLA_ASSERT_EQ(1u, universe1->SourceClientCount());
+  OLA_ASSERT_EQ(1u, universe2->SourceClientCount());
+
+  // Each universe is sent once, in the order it first appears in the batch.
+  RecordingSinkClient sink(m_uid);
+  universe1->AddSinkClient(&sink);
+  universe2->AddSinkClient(&sink);
+  request.Clear();
+  data = request.add_data();
+  data->set_universe(2);
+  data->set_data(dmx_data1.Get());
+  data = request.add_data();
+  data->set_universe(1);
+  data->set_data(dmx_data2.Get());
+  data = request.add_data();
+  data->set_universe(2);
+  data->set_data(dmx_data3.Get());
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(sink.universes.size()));
+  OLA_ASSERT_EQ(2u, sink.universes[0]);
+  OLA_ASSERT_EQ(1u, sink.universes[1]);
+  OLA_ASSERT_EQ(dmx_data3, universe2->GetDMX());
+
+  sink.universes.clear();
+  request.Clear();
+  data = request.add_data();
+  data->set_universe(1);
+  data->set_data(dmx_data1.Get());
+  data = request.add_data();
+  data->set_universe(2);
+  data->set_data(dmx_data2.Get());
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(sink.universes.size()));
+  OLA_ASSERT_EQ(1u, sink.universes[0]);
+  OLA_ASSERT_EQ(2u, sink.universes[1]);
+  universe1->RemoveSinkClient(&sink);
+  universe2->RemoveSinkClient(&sink);
+
+  // An empty batch does nothing
+  request.Clear();
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(dmx_data1, universe1->GetDMX());
+}
+
+/*
+ * Check DMX data can be sent using shared memory.
+ */
+void OlaServerServiceImplTest::testAttachSharedDmx() {
+  if (!SharedDmxWriter::Supported()) {
+    return;
+  }
+
+  UniverseStore store(NULL, NULL);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+  m_clock.CurrentTime(&time1);
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  ola::proto::SharedDmxRequest request;
+  request.set_token(1);
+  ola::proto::Ack reply;
+  bool done = false;
+
+  // This fails until shared memory is enabled
+  service.AttachSharedDmx(
+      &controller, &request, &reply,
+      NewSingleCallback(this, &OlaServerServiceImplTest::SetFlag, &done));
+  OLA_ASSERT_TRUE(done);
+  OLA_ASSERT_TRUE(controller.Failed());
+
+  SelectServer ss;
+  const string name = "ola-dmx-test-" + ola::IntToString(getpid());
+  SharedDmxListener listener;
+  OLA_ASSERT_TRUE(listener.Init(name));
+  service.EnableSharedDmx(&ss, &listener);
+
+  // The region hasn't been sent yet
+  controller.Reset();
+  service.AttachSharedDmx(
+      &controller, &request, &reply,
+      NewSingleCallback(this, &OlaServerServiceImplTest::SetFlag, &done));
+  OLA_ASSERT_TRUE(controller.Failed());
+
+  SharedDmxWriter writer;
+  OLA_ASSERT_TRUE(writer.Init(2));
+  OLA_ASSERT_TRUE(writer.SendDescriptors(name, 1));
+  controller.Reset();
+  service.AttachSharedDmx(
+      &controller, &request, &reply,
+      NewSingleCallback(this, &OlaServerServiceImplTest::SetFlag, &done));
+  OLA_ASSERT_FALSE(controller.Failed());
+
+  // Universe 2 doesn't exist, so it's ignored
+  DmxBuffer dmx_data1("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 100, dmx_data1));
+  OLA_ASSERT_TRUE(writer.Write(1, 2, 100, dmx_data1));
+  OLA_ASSERT_TRUE(writer.Signal());
+  ss.RunOnce(ola::TimeInterval(1, 0));
+  OLA_ASSERT_EQ(dmx_data1, universe1->GetDMX());
+  OLA_ASSERT_EQ(1u, universe1->SourceClientCount());
+  OLA_ASSERT_FALSE(store.GetUniverse(2));
+
+  // Once the client has gone, the region is ignored
+  service.ClientRemoved(&client);
+  OLA_ASSERT_TRUE(writer.Write(0, 1, 100, dmx_data2));
+  OLA_ASSERT_TRUE(writer.Signal());
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(dmx_data1, universe1->GetDMX());
+}
+
 /*
  * Check the SetUniverseName method works
  */
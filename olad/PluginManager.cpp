@@ -22,11 +22,13 @@
 
 #include <set>
 #include <vector>
+#include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PluginLoader.h"
+#include "olad/PluginThread.h"
 
 namespace ola {
 
@@ -36,13 +38,24 @@ using std::set;
 PluginManager::PluginManager(const vector<PluginLoader*> &plugin_loaders,
                              class PluginAdaptor *plugin_adaptor)
     : m_plugin_loaders(plugin_loaders),
-      m_plugin_adaptor(plugin_adaptor) {
+      m_plugin_adaptor(plugin_adaptor),
+      m_main_ss(NULL),
+      m_all_plugin_threads(false) {
 }
 
 PluginManager::~PluginManager() {
   UnloadAll();
 }
 
+void PluginManager::EnablePluginThreads(
+    ola::io::SelectServerInterface *ss,
+    const set<ola_plugin_id> &plugin_ids,
+    bool all_plugins) {
+  m_main_ss = ss;
+  m_thread_plugins = plugin_ids;
+  m_all_plugin_threads = all_plugins;
+}
+
 void PluginManager::LoadAll() {
   m_enabled_plugins.clear();
 
@@ -87,7 +100,7 @@ void PluginManager::LoadAll() {
 void PluginManager::UnloadAll() {
   PluginMap::iterator plugin_iter = m_loaded_plugins.begin();
   for (; plugin_iter != m_loaded_plugins.end(); ++plugin_iter) {
-    plugin_iter->second->Stop();
+    StopPlugin(plugin_iter->second);
   }
   m_loaded_plugins.clear();
   m_active_plugins.clear();
@@ -134,7 +147,7 @@ void PluginManager::DisableAndStopPlugin(ola_plugin_id plugin_id) {
   }
 
   if (STLRemove(&m_active_plugins, plugin_id)) {
-    plugin->Stop();
+    StopPlugin(plugin);
   }
 
   if (STLRemove(&m_enabled_plugins, plugin_id)) {
@@ -193,7 +206,7 @@ bool PluginManager::StartIfSafe(AbstractPlugin *plugin) {
   }
 
   OLA_INFO << "Trying to start " << plugin->Name();
-  bool ok = plugin->Start();
+  bool ok = StartPlugin(plugin);
   if (!ok) {
     OLA_WARN << "Failed to start " << plugin->Name();
   } else {
@@ -203,6 +216,70 @@ bool PluginManager::StartIfSafe(AbstractPlugin *plugin) {
   return ok;
 }
 
+/*
+ * @brief Check if a plugin should be run in its own thread.
+ */
+bool PluginManager::UseThread(const AbstractPlugin *plugin) const {
+  if (!m_main_ss) {
+    return false;
+  }
+  bool requested = (m_all_plugin_threads ||
+                    STLContains(m_thread_plugins, plugin->Id()));
+  if (requested && !plugin->SupportsThreads()) {
+    if (!m_all_plugin_threads) {
+      OLA_WARN << plugin->Name() << " doesn't support threads, running it in "
+               << "the main thread";
+    }
+    return false;
+  }
+  return requested;
+}
+
+/*
+ * @brief Start a plugin, in its own thread if required.
+ */
+bool PluginManager::StartPlugin(AbstractPlugin *plugin) {
+  if (!UseThread(plugin)) {
+    return plugin->Start();
+  }
+
+  PluginThread *thread = new PluginThread(plugin, m_main_ss,
+                                          m_plugin_adaptor->GetExportMap());
+  if (!thread->Start()) {
+    OLA_WARN << "Failed to start the thread for " << plugin->Name();
+    delete thread;
+    return false;
+  }
+  plugin->SetThread(thread);
+
+  bool ok = thread->RunInPluginThread(
+      NewSingleCallback(plugin, &AbstractPlugin::Start));
+  if (ok) {
+    OLA_INFO << plugin->Name() << " is running in its own thread";
+  } else {
+    thread->Stop();
+    plugin->SetThread(NULL);
+    delete thread;
+  }
+  return ok;
+}
+
+/*
+ * @brief Stop a plugin, and the thread it runs in.
+ */
+void PluginManager::StopPlugin(AbstractPlugin *plugin) {
+  PluginThread *thread = plugin->GetThread();
+  if (!thread) {
+    plugin->Stop();
+    return;
+  }
+
+  thread->RunInPluginThread(NewSingleCallback(plugin, &AbstractPlugin::Stop));
+  thread->Stop();
+  plugin->SetThread(NULL);
+  delete thread;
+}
+
 /*
  * @brief Check if this plugin conflicts with any of the running plugins.
  * @param plugin The plugin to check
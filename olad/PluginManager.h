@@ -22,9 +22,11 @@
 #define OLAD_PLUGINMANAGER_H_
 
 #include <map>
+#include <set>
 #include <vector>
 
 #include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/plugin_id.h"
 
 namespace ola {
@@ -64,6 +66,20 @@ class PluginManager {
    */
   ~PluginManager();
 
+  /**
+   * @brief Run plugins in their own threads.
+   * @param ss the SelectServer of the main thread.
+   * @param plugin_ids the plugins to run in their own thread.
+   * @param all_plugins if true, run every plugin that supports threads in its
+   *   own thread.
+   *
+   * Plugins that don't support threads always run in the main thread. This
+   * takes effect the next time a plugin is started.
+   */
+  void EnablePluginThreads(ola::io::SelectServerInterface *ss,
+                           const std::set<ola_plugin_id> &plugin_ids,
+                           bool all_plugins);
+
   /**
    * @brief Attempt to load all the plugins and start them.
    *
@@ -150,8 +166,14 @@ class PluginManager {
   PluginMap m_active_plugins;  // active plugins
   PluginMap m_enabled_plugins;  // enabled plugins
   PluginAdaptor *m_plugin_adaptor;
+  ola::io::SelectServerInterface *m_main_ss;
+  std::set<ola_plugin_id> m_thread_plugins;
+  bool m_all_plugin_threads;
 
   bool StartIfSafe(AbstractPlugin *plugin);
+  bool UseThread(const AbstractPlugin *plugin) const;
+  bool StartPlugin(AbstractPlugin *plugin);
+  void StopPlugin(AbstractPlugin *plugin);
   AbstractPlugin* CheckForRunningConflicts(const AbstractPlugin *plugin) const;
 
   DISALLOW_COPY_AND_ASSIGN(PluginManager);
@@ -18,12 +18,16 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <algorithm>
 #include <map>
+#include <string>
 #include <utility>
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
 #include "ola/Callback.h"
 #include "ola/Logging.h"
+#include "ola/strings/Format.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/plugin_api/Client.h"
@@ -33,17 +37,97 @@ namespace ola {
 using ola::rdm::UID;
 using ola::rpc::RpcController;
 using std::map;
+using std::string;
+
+unsigned int Client::s_next_client_id = 0;
+const DmxSource Client::EMPTY_SOURCE;
+const char Client::K_CLIENT_QUEUE_DEPTH_VAR[] = "client-send-queue-depth";
+const char Client::K_CLIENT_DROPPED_FRAMES_VAR[] = "client-frames-dropped";
 
 Client::Client(ola::proto::OlaClientService_Stub *client_stub,
                const ola::rdm::UID &uid)
     : m_client_stub(client_stub),
-      m_uid(uid) {
+      m_uid(uid),
+      m_ss(NULL),
+      m_queue_depth_map(NULL),
+      m_dropped_frames_map(NULL),
+      m_queue_depth(0),
+      m_dropped_frames(0),
+      m_published_queue_depth(0),
+      m_published_dropped_frames(0),
+      m_queue_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
 Client::~Client() {
+  if (m_ss) {
+    if (m_queue_timeout != ola::thread::INVALID_TIMEOUT) {
+      m_ss->RemoveTimeout(m_queue_timeout);
+    }
+    ola::rpc::RpcChannel *channel = m_client_stub->channel();
+    if (channel) {
+      channel->SetWriteDrainedHandler(NULL);
+    }
+  }
+
+  if (m_queue_depth_map) {
+    m_queue_depth_map->Remove(m_client_id);
+    m_dropped_frames_map->Remove(m_client_id);
+  }
   m_data_map.clear();
 }
 
+void Client::EnableSendQueue(ola::io::SelectServerInterface *ss,
+                             ExportMap *export_map) {
+  if (m_ss || !ss || !m_client_stub.get()) {
+    return;
+  }
+
+  m_ss = ss;
+  m_client_id = ola::strings::IntToString(s_next_client_id++);
+
+  ola::rpc::RpcChannel *channel = m_client_stub->channel();
+  if (channel) {
+    channel->SetWriteDrainedHandler(
+        NewCallback(this, &Client::FlushQueue));
+  }
+
+  if (export_map) {
+    m_queue_depth_map = export_map->GetUIntMapVar(K_CLIENT_QUEUE_DEPTH_VAR,
+                                                  "client");
+    m_dropped_frames_map = export_map->GetUIntMapVar(
+        K_CLIENT_DROPPED_FRAMES_VAR, "client");
+    (*m_queue_depth_map)[m_client_id] = m_queue_depth;
+    (*m_dropped_frames_map)[m_client_id] = m_dropped_frames;
+    m_published_queue_depth = m_queue_depth;
+    m_published_dropped_frames = m_dropped_frames;
+  }
+}
+
+void Client::SetMaxFrameRate(unsigned int universe,
+                             unsigned int frames_per_second) {
+  if (frames_per_second) {
+    m_send_queue[universe].min_interval = TimeInterval(
+        0, ola::USEC_IN_SECONDS / frames_per_second);
+  } else {
+    SendQueue::iterator iter = m_send_queue.find(universe);
+    if (iter != m_send_queue.end()) {
+      iter->second.min_interval = TimeInterval();
+    }
+  }
+}
+
+void Client::RemoveUniverse(unsigned int universe) {
+  SendQueue::iterator iter = m_send_queue.find(universe);
+  if (iter != m_send_queue.end()) {
+    if (iter->second.pending) {
+      m_queue_depth--;
+    }
+    m_send_queue.erase(iter);
+    UpdateQueueVariables();
+  }
+  m_update_filters.erase(universe);
+}
+
 bool Client::SendDMX(unsigned int universe, uint8_t priority,
                      const DmxBuffer &buffer) {
   if (!m_client_stub.get()) {
@@ -51,6 +135,27 @@ bool Client::SendDMX(unsigned int universe, uint8_t priority,
     return false;
   }
 
+  if (!m_ss) {
+    SendFrame(universe, priority, buffer);
+    return true;
+  }
+
+  QueuedFrame &frame = m_send_queue[universe];
+  if (frame.pending) {
+    m_dropped_frames++;
+  } else {
+    frame.pending = true;
+    m_queue_depth++;
+  }
+  frame.buffer = buffer;
+  frame.priority = priority;
+
+  FlushQueue();
+  return true;
+}
+
+void Client::SendFrame(unsigned int universe, uint8_t priority,
+                       const DmxBuffer &buffer) {
   RpcController *controller = new RpcController();
   ola::proto::DmxData dmx_data;
   ola::proto::Ack *ack = new ola::proto::Ack();
@@ -65,23 +170,110 @@ bool Client::SendDMX(unsigned int universe, uint8_t priority,
       ack,
       ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
                              controller, ack));
-  return true;
+}
+
+void Client::FlushQueue() {
+  SendDueFrames(*m_ss->WakeUpTime());
+}
+
+/*
+ * Send the pending frames that are due. If the RPC channel is backed up we
+ * wait for it to drain, since any frame sent now would just sit in the
+ * channel's queue and couldn't be replaced by a newer one.
+ */
+void Client::SendDueFrames(const TimeStamp &now) {
+  ola::rpc::RpcChannel *channel = m_client_stub->channel();
+  if (m_queue_depth == 0 || (channel && channel->QueuedBytes())) {
+    UpdateQueueVariables();
+    return;
+  }
+
+  TimeStamp next_due;
+
+  SendQueue::iterator iter = m_send_queue.begin();
+  for (; iter != m_send_queue.end(); ++iter) {
+    QueuedFrame &frame = iter->second;
+    if (!frame.pending) {
+      continue;
+    }
+
+    const TimeStamp due = frame.last_sent + frame.min_interval;
+    if (frame.last_sent.IsSet() && due > now) {
+      if (!next_due.IsSet() || due < next_due) {
+        next_due = due;
+      }
+      continue;
+    }
+
+    frame.pending = false;
+    frame.last_sent = now;
+    m_queue_depth--;
+    SendFrame(iter->first, frame.priority, frame.buffer);
+  }
+
+  if (next_due.IsSet() && m_queue_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_queue_timeout_due = next_due;
+    m_queue_timeout = m_ss->RegisterSingleTimeout(
+        next_due - now, NewSingleCallback(this, &Client::QueueTimeout));
+  }
+  UpdateQueueVariables();
+}
+
+void Client::QueueTimeout() {
+  m_queue_timeout = ola::thread::INVALID_TIMEOUT;
+  // Timeouts may run before the SelectServer updates the wake up time, but
+  // since we've fired we know it's at least the time we asked for.
+  SendDueFrames(std::max(*m_ss->WakeUpTime(), m_queue_timeout_due));
+}
+
+/*
+ * Publish the queue variables, this only touches the maps when a value has
+ * changed.
+ */
+void Client::UpdateQueueVariables() {
+  if (!m_queue_depth_map) {
+    return;
+  }
+  if (m_queue_depth != m_published_queue_depth) {
+    (*m_queue_depth_map)[m_client_id] = m_queue_depth;
+    m_published_queue_depth = m_queue_depth;
+  }
+  if (m_dropped_frames != m_published_dropped_frames) {
+    (*m_dropped_frames_map)[m_client_id] = m_dropped_frames;
+    m_published_dropped_frames = m_dropped_frames;
+  }
 }
 
 void Client::DMXReceived(unsigned int universe, const DmxSource &source) {
   STLReplace(&m_data_map, universe, source);
 }
 
-const DmxSource Client::SourceData(unsigned int universe) const {
+const DmxSource &Client::SourceData(unsigned int universe) const {
   map<unsigned int, DmxSource>::const_iterator iter =
     m_data_map.find(universe);
 
   if (iter != m_data_map.end()) {
     return iter->second;
   } else {
-    DmxSource source;
-    return source;
+    return EMPTY_SOURCE;
+  }
+}
+
+void Client::SetUpdateMode(unsigned int universe,
+                           DmxUpdateFilter::UpdateMode mode,
+                           const TimeInterval &keep_alive) {
+  if (mode == DmxUpdateFilter::SEND_ALL_FRAMES) {
+    m_update_filters.erase(universe);
+    return;
   }
+
+  DmxUpdateFilter &filter = m_update_filters[universe];
+  filter.SetMode(DmxUpdateFilter::SKIP_UNCHANGED_FRAMES);
+  filter.SetKeepAliveInterval(keep_alive);
+}
+
+DmxUpdateFilter *Client::UpdateFilter(unsigned int universe) {
+  return STLFind(&m_update_filters, universe);
 }
 
 ola::rdm::UID Client::GetUID() const {
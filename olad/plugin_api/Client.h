@@ -23,10 +23,17 @@
 
 #include <map>
 #include <memory>
+#include <string>
 #include "common/rpc/RpcController.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "ola/rdm/UID.h"
 #include "olad/DmxSource.h"
+#include "olad/DmxUpdateFilter.h"
 
 namespace ola {
 namespace proto {
@@ -57,12 +64,56 @@ class Client {
 
   virtual ~Client();
 
+  /**
+   * @brief Queue DMX updates to this client, rather than sending them
+   * immediately.
+   *
+   * Each universe has a single slot in the queue, so if a newer frame arrives
+   * before the previous one was sent, the older frame is dropped. Frames are
+   * held while the RPC channel has unwritten data, or if sending would exceed
+   * the maximum frame rate for the universe.
+   * @param ss the SelectServer to use for timers, ownership is not
+   *   transferred.
+   * @param export_map the ExportMap to publish the queue depth and dropped
+   *   frame counts to, may be NULL.
+   */
+  void EnableSendQueue(ola::io::SelectServerInterface *ss,
+                       ExportMap *export_map = NULL);
+
+  /**
+   * @brief Limit the rate DMX updates are sent to this client.
+   * @param universe the id of the universe.
+   * @param frames_per_second the maximum rate, 0 means no limit.
+   * @note This only takes effect once EnableSendQueue() has been called.
+   */
+  void SetMaxFrameRate(unsigned int universe, unsigned int frames_per_second);
+
+  /**
+   * @brief Stop sending DMX for a universe to this client.
+   *
+   * This drops any frame still waiting to be sent for the universe, and
+   * resets the universe's frame rate limit and update mode.
+   * @param universe the id of the universe.
+   */
+  void RemoveUniverse(unsigned int universe);
+
+  /**
+   * @brief The number of universes with a frame waiting to be sent.
+   */
+  unsigned int QueueDepth() const { return m_queue_depth; }
+
+  /**
+   * @brief The number of frames that were replaced by a newer frame before
+   * they could be sent.
+   */
+  unsigned int DroppedFrames() const { return m_dropped_frames; }
+
   /**
    * @brief Push a DMX update to this client.
    * @param universe_id the universe the DMX data belongs to
    * @param priority the priority of the DMX data
    * @param buffer the DMX data.
-   * @return true if the update was sent, false otherwise
+   * @return true if the update was sent or queued, false otherwise
    */
   virtual bool SendDMX(unsigned int universe_id, uint8_t priority,
                        const DmxBuffer &buffer);
@@ -77,8 +128,29 @@ class Client {
   /**
    * @brief Get the most recent DMX data received from this client.
    * @param universe the id of the universe we're interested in
+   * @returns the DmxSource for the universe, or an unset DmxSource if we
+   *   haven't received data for the universe.
+   */
+  const DmxSource &SourceData(unsigned int universe) const;
+
+  /**
+   * @brief Control which frames are sent to this client for a universe.
+   * @param universe the id of the universe.
+   * @param mode the DmxUpdateFilter::UpdateMode to use. Since the client
+   *   always receives the full frame, SEND_CHANGED_SLOTS behaves like
+   *   SKIP_UNCHANGED_FRAMES.
+   * @param keep_alive how often to resend unchanged frames.
+   */
+  void SetUpdateMode(unsigned int universe,
+                     DmxUpdateFilter::UpdateMode mode,
+                     const TimeInterval &keep_alive);
+
+  /**
+   * @brief Get the filter for a universe.
+   * @param universe the id of the universe.
+   * @returns the DmxUpdateFilter, or NULL if every frame is sent.
    */
-  const DmxSource SourceData(unsigned int universe) const;
+  DmxUpdateFilter *UpdateFilter(unsigned int universe);
 
   /**
    * @brief Return the UID associated with this client.
@@ -96,13 +168,53 @@ class Client {
   void SetUID(const ola::rdm::UID &uid);
 
  private:
+  /*
+   * The most recent frame for a universe.
+   */
+  struct QueuedFrame {
+    QueuedFrame() : priority(0), pending(false) {}
+
+    DmxBuffer buffer;
+    uint8_t priority;
+    bool pending;
+    TimeInterval min_interval;
+    TimeStamp last_sent;
+  };
+
+  typedef std::map<unsigned int, QueuedFrame> SendQueue;
+
+  void SendFrame(unsigned int universe, uint8_t priority,
+                 const DmxBuffer &buffer);
+  void FlushQueue();
+  void SendDueFrames(const TimeStamp &now);
+  void QueueTimeout();
+  void UpdateQueueVariables();
   void SendDMXCallback(ola::rpc::RpcController *controller,
                        ola::proto::Ack *ack);
 
   std::auto_ptr<class ola::proto::OlaClientService_Stub> m_client_stub;
   std::map<unsigned int, DmxSource> m_data_map;
+  std::map<unsigned int, DmxUpdateFilter> m_update_filters;
   ola::rdm::UID m_uid;
 
+  ola::io::SelectServerInterface *m_ss;
+  UIntMap *m_queue_depth_map;
+  UIntMap *m_dropped_frames_map;
+  std::string m_client_id;
+  SendQueue m_send_queue;
+  unsigned int m_queue_depth;
+  unsigned int m_dropped_frames;
+  // The values last written to the ExportMap.
+  unsigned int m_published_queue_depth;
+  unsigned int m_published_dropped_frames;
+  ola::thread::timeout_id m_queue_timeout;
+  TimeStamp m_queue_timeout_due;
+
+  static unsigned int s_next_client_id;
+  static const DmxSource EMPTY_SOURCE;
+  static const char K_CLIENT_QUEUE_DEPTH_VAR[];
+  static const char K_CLIENT_DROPPED_FRAMES_VAR[];
+
   DISALLOW_COPY_AND_ASSIGN(Client);
 };
 }  // namespace ola
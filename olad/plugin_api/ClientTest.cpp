@@ -20,6 +20,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -28,6 +29,7 @@
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "olad/DmxSource.h"
@@ -41,21 +43,30 @@ static const char TEST_DATA2[] = "another set of test data";
 
 using ola::Client;
 using ola::DmxBuffer;
+using ola::TimeInterval;
 using std::string;
+using std::vector;
 
 class ClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ClientTest);
   CPPUNIT_TEST(testSendDMX);
   CPPUNIT_TEST(testGetSetDMX);
+  CPPUNIT_TEST(testSendQueue);
+  CPPUNIT_TEST(testMaxFrameRate);
+  CPPUNIT_TEST(testRemoveUniverse);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   ClientTest() : m_test_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {}
   void testSendDMX();
   void testGetSetDMX();
+  void testSendQueue();
+  void testMaxFrameRate();
+  void testRemoveUniverse();
 
  private:
   ola::Clock m_clock;
+  ola::MockClock m_mock_clock;
   ola::rdm::UID m_test_uid;
 };
 
@@ -87,6 +98,27 @@ void MockClientStub::UpdateDmxData(
   done->Run();
 }
 
+
+/*
+ * A ClientStub which records the frames sent.
+ */
+class RecordingClientStub: public ola::proto::OlaClientService_Stub {
+ public:
+  RecordingClientStub(): ola::proto::OlaClientService_Stub(NULL) {}
+
+  void UpdateDmxData(OLA_UNUSED ola::rpc::RpcController *controller,
+                     const ola::proto::DmxData *request,
+                     OLA_UNUSED ola::proto::Ack *response,
+                     ola::rpc::RpcService::CompletionCallback *done) {
+    universes.push_back(request->universe());
+    frames.push_back(request->data());
+    done->Run();
+  }
+
+  vector<int> universes;
+  vector<string> frames;
+};
+
 /*
  * Check that the SendDMX method works correctly.
  */
@@ -142,3 +174,110 @@ void ClientTest::testGetSetDMX() {
   OLA_ASSERT_FALSE(source4.IsSet());
   OLA_ASSERT_DMX_EQUALS(empty, source4.Data());
 }
+
+
+/*
+ * Check that with the send queue enabled, frames are sent straight away when
+ * there is no rate limit.
+ */
+void ClientTest::testSendQueue() {
+  ola::io::SelectServer ss(NULL, &m_mock_clock);
+  ola::ExportMap export_map;
+  RecordingClientStub *stub = new RecordingClientStub();
+  {
+    Client client(stub, m_test_uid);
+    client.EnableSendQueue(&ss, &export_map);
+    ss.RunOnce(TimeInterval(0, 0));
+
+    client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer(TEST_DATA));
+    client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer(TEST_DATA2));
+    client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer(TEST_DATA2));
+    OLA_ASSERT_EQ(3u, static_cast<unsigned int>(stub->frames.size()));
+    OLA_ASSERT_EQ(string(TEST_DATA), stub->frames[0]);
+    OLA_ASSERT_EQ(static_cast<int>(TEST_UNIVERSE2), stub->universes[1]);
+    OLA_ASSERT_EQ(string(TEST_DATA2), stub->frames[2]);
+    OLA_ASSERT_EQ(0u, client.QueueDepth());
+    OLA_ASSERT_EQ(0u, client.DroppedFrames());
+    OLA_ASSERT_NE(
+        string("map:client"),
+        export_map.GetUIntMapVar("client-send-queue-depth")->Value());
+  }
+  // the variables are removed once the client goes away
+  OLA_ASSERT_EQ(
+      string("map:client"),
+      export_map.GetUIntMapVar("client-send-queue-depth")->Value());
+}
+
+
+/*
+ * Check that the max frame rate is enforced, and that only the most recent
+ * frame is sent.
+ */
+void ClientTest::testMaxFrameRate() {
+  ola::io::SelectServer ss(NULL, &m_mock_clock);
+  RecordingClientStub *stub = new RecordingClientStub();
+  Client client(stub, m_test_uid);
+  client.EnableSendQueue(&ss);
+  client.SetMaxFrameRate(TEST_UNIVERSE, 10);
+  ss.RunOnce(TimeInterval(0, 0));
+
+  // the first frame goes straight out
+  client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("1,2,3"));
+  OLA_ASSERT_EQ(1u, static_cast<unsigned int>(stub->frames.size()));
+
+  // the next two are held, and the first of those is replaced
+  client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("4,5,6"));
+  client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("7,8,9"));
+  OLA_ASSERT_EQ(1u, static_cast<unsigned int>(stub->frames.size()));
+  OLA_ASSERT_EQ(1u, client.QueueDepth());
+  OLA_ASSERT_EQ(1u, client.DroppedFrames());
+
+  // other universes aren't limited
+  client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer(TEST_DATA));
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(stub->frames.size()));
+
+  m_mock_clock.AdvanceTime(0, 200000);
+  ss.RunOnce(TimeInterval(0, 0));
+  OLA_ASSERT_EQ(3u, static_cast<unsigned int>(stub->frames.size()));
+  OLA_ASSERT_EQ(string("7,8,9"), stub->frames[2]);
+  OLA_ASSERT_EQ(0u, client.QueueDepth());
+  OLA_ASSERT_EQ(1u, client.DroppedFrames());
+}
+
+
+/*
+ * Check that a frame waiting to be sent is dropped once the universe is
+ * removed.
+ */
+void ClientTest::testRemoveUniverse() {
+  ola::io::SelectServer ss(NULL, &m_mock_clock);
+  RecordingClientStub *stub = new RecordingClientStub();
+  Client client(stub, m_test_uid);
+  client.EnableSendQueue(&ss);
+  client.SetMaxFrameRate(TEST_UNIVERSE, 10);
+  client.SetMaxFrameRate(TEST_UNIVERSE2, 10);
+  ss.RunOnce(TimeInterval(0, 0));
+
+  client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("1,2,3"));
+  client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer("1,2,3"));
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(stub->frames.size()));
+
+  // hold a frame for each universe, then remove the first universe
+  client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("4,5,6"));
+  client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer("7,8,9"));
+  OLA_ASSERT_EQ(2u, client.QueueDepth());
+  client.RemoveUniverse(TEST_UNIVERSE);
+  OLA_ASSERT_EQ(1u, client.QueueDepth());
+
+  // only the frame for the second universe is sent
+  m_mock_clock.AdvanceTime(0, 200000);
+  ss.RunOnce(TimeInterval(0, 0));
+  OLA_ASSERT_EQ(3u, static_cast<unsigned int>(stub->frames.size()));
+  OLA_ASSERT_EQ(static_cast<int>(TEST_UNIVERSE2), stub->universes[2]);
+  OLA_ASSERT_EQ(string("7,8,9"), stub->frames[2]);
+  OLA_ASSERT_EQ(0u, client.QueueDepth());
+
+  // removing an unknown universe is fine
+  client.RemoveUniverse(TEST_UNIVERSE);
+  OLA_ASSERT_EQ(0u, client.QueueDepth());
+}
@@ -31,6 +31,7 @@
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
+#include "olad/PluginThread.h"
 #include "olad/Port.h"
 #include "olad/plugin_api/PortManager.h"
 
@@ -191,7 +192,7 @@ void DeviceManager::UnregisterAllDevices() {
 void DeviceManager::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   set<OutputPort*>::iterator iter = m_timecode_ports.begin();
   for (; iter != m_timecode_ports.end(); iter++) {
-    (*iter)->SendTimeCode(timecode);
+    PluginThread::SendTimeCode(*iter, timecode);
   }
 }
 
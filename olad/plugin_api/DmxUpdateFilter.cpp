@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxUpdateFilter.cpp
+ * Decides which universe frames are written to a port or client.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <olad/DmxUpdateFilter.h>
+
+namespace ola {
+
+const TimeInterval DmxUpdateFilter::DEFAULT_KEEP_ALIVE(1000000);  // 1s
+
+DmxUpdateFilter::DmxUpdateFilter()
+    : m_mode(SEND_ALL_FRAMES),
+      m_keep_alive(DEFAULT_KEEP_ALIVE),
+      m_send_full_frame(true) {
+}
+
+void DmxUpdateFilter::SetMode(UpdateMode mode) {
+  m_mode = mode;
+  m_send_full_frame = true;
+}
+
+DmxUpdateFilter::Action DmxUpdateFilter::Filter(bool frame_changed,
+                                                const TimeStamp &now) {
+  if (m_mode == SEND_ALL_FRAMES) {
+    return SEND_FRAME;
+  }
+
+  bool keep_alive_due = (!m_keep_alive.IsZero() &&
+                         now - m_last_sent >= m_keep_alive);
+  if (m_send_full_frame || keep_alive_due) {
+    m_send_full_frame = false;
+    m_last_sent = now;
+    return SEND_FRAME;
+  }
+
+  if (!frame_changed) {
+    return SKIP_FRAME;
+  }
+
+  m_last_sent = now;
+  return m_mode == SEND_CHANGED_SLOTS ? SEND_CHANGES : SEND_FRAME;
+}
+}  // namespace ola
@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxUpdateFilterTest.cpp
+ * Test fixture for the DmxUpdateFilter class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "olad/DmxUpdateFilter.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxUpdateFilter;
+using ola::TimeInterval;
+using ola::TimeStamp;
+
+class DmxUpdateFilterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxUpdateFilterTest);
+  CPPUNIT_TEST(testSendAllFrames);
+  CPPUNIT_TEST(testSkipUnchangedFrames);
+  CPPUNIT_TEST(testSendChangedSlots);
+  CPPUNIT_TEST(testNoKeepAlive);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testSendAllFrames();
+    void testSkipUnchangedFrames();
+    void testSendChangedSlots();
+    void testNoKeepAlive();
+
+ private:
+    TimeStamp m_now;
+
+    void Advance(unsigned int ms) {
+      m_now += TimeInterval(static_cast<int64_t>(ms) * 1000);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxUpdateFilterTest);
+
+
+void DmxUpdateFilterTest::setUp() {
+  m_now = TimeStamp();
+  Advance(10000);
+}
+
+
+/*
+ * Check the default filter sends everything.
+ */
+void DmxUpdateFilterTest::testSendAllFrames() {
+  DmxUpdateFilter filter;
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_ALL_FRAMES, filter.Mode());
+  OLA_ASSERT_TRUE(filter.SendsAllFrames());
+  OLA_ASSERT_EQ(DmxUpdateFilter::DEFAULT_KEEP_ALIVE,
+                filter.KeepAliveInterval());
+
+  for (unsigned int i = 0; i < 5; i++) {
+    OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+    OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(true, m_now));
+  }
+}
+
+
+/*
+ * Check unchanged frames are skipped until the keep-alive is due.
+ */
+void DmxUpdateFilterTest::testSkipUnchangedFrames() {
+  DmxUpdateFilter filter;
+  filter.SetMode(DmxUpdateFilter::SKIP_UNCHANGED_FRAMES);
+  filter.SetKeepAliveInterval(TimeInterval(1, 0));
+  OLA_ASSERT_FALSE(filter.SendsAllFrames());
+
+  // The first frame is always sent
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+  Advance(25);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+  Advance(25);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(true, m_now));
+  Advance(25);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+
+  // 1s after the last send, the keep-alive is due
+  Advance(974);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+  Advance(1);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+  Advance(1);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+
+  // Reset() forces the next frame out
+  filter.Reset();
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+}
+
+
+/*
+ * Check that in delta mode, changes are sent as deltas and keep-alives are
+ * sent as full frames.
+ */
+void DmxUpdateFilterTest::testSendChangedSlots() {
+  DmxUpdateFilter filter;
+  filter.SetMode(DmxUpdateFilter::SEND_CHANGED_SLOTS);
+  filter.SetKeepAliveInterval(TimeInterval(1, 0));
+
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(true, m_now));
+  Advance(25);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_CHANGES, filter.Filter(true, m_now));
+  Advance(25);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+  Advance(1000);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(true, m_now));
+
+  // Changing the mode sends a full frame
+  filter.SetMode(DmxUpdateFilter::SKIP_UNCHANGED_FRAMES);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(true, m_now));
+}
+
+
+/*
+ * Check a zero keep-alive disables the resend.
+ */
+void DmxUpdateFilterTest::testNoKeepAlive() {
+  DmxUpdateFilter filter;
+  filter.SetMode(DmxUpdateFilter::SKIP_UNCHANGED_FRAMES);
+  filter.SetKeepAliveInterval(TimeInterval());
+
+  OLA_ASSERT_EQ(DmxUpdateFilter::SEND_FRAME, filter.Filter(false, m_now));
+  Advance(3600 * 1000);
+  OLA_ASSERT_EQ(DmxUpdateFilter::SKIP_FRAME, filter.Filter(false, m_now));
+}
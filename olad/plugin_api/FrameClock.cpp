@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClock.cpp
+ * Emits output frames at a fixed rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#endif  // HAVE_SYS_TIMERFD_H
+
+#include <algorithm>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "olad/FrameClock.h"
+
+namespace ola {
+
+using ola::io::SelectServerInterface;
+using ola::io::UnmanagedFileDescriptor;
+using ola::thread::INVALID_TIMEOUT;
+
+const unsigned int FrameClock::MAX_RATE;
+const char FrameClock::K_FRAME_CLOCK_RATE_VAR[] = "frame-clock-rate";
+const char FrameClock::K_FRAME_CLOCK_TICKS_VAR[] = "frame-clock-ticks";
+const char FrameClock::K_FRAME_CLOCK_MISSED_VAR[] = "frame-clock-missed-ticks";
+
+FrameClock::FrameClock(SelectServerInterface *ss,
+                       unsigned int rate,
+                       ExportMap *export_map)
+    : m_ss(ss),
+      m_rate(rate),
+      m_period(static_cast<int64_t>(
+          rate && rate <= MAX_RATE ? ONE_THOUSAND * ONE_THOUSAND / rate : 0)),
+      m_export_map(export_map),
+      m_timeout_id(INVALID_TIMEOUT) {
+  if (m_export_map) {
+    m_export_map->GetIntegerVar(K_FRAME_CLOCK_RATE_VAR)->Set(rate);
+    m_export_map->GetCounterVar(K_FRAME_CLOCK_TICKS_VAR);
+    m_export_map->GetCounterVar(K_FRAME_CLOCK_MISSED_VAR);
+  }
+}
+
+FrameClock::~FrameClock() {
+  Stop();
+}
+
+bool FrameClock::Start() {
+  if (m_timer.get() || m_timeout_id != INVALID_TIMEOUT) {
+    return true;
+  }
+  if (!m_rate || m_rate > MAX_RATE || m_period.IsZero()) {
+    OLA_WARN << "Frame clock rate must be between 1 and " << MAX_RATE
+             << ", was " << m_rate;
+    return false;
+  }
+
+  if (StartTimer()) {
+    return true;
+  }
+
+  m_timeout_id = m_ss->RegisterRepeatingTimeout(
+      m_period, NewCallback(this, &FrameClock::TimeoutTick));
+  return m_timeout_id != INVALID_TIMEOUT;
+}
+
+void FrameClock::Stop() {
+  if (m_timer.get()) {
+    m_ss->RemoveReadDescriptor(m_timer.get());
+    int fd = ola::io::ToFD(m_timer->ReadDescriptor());
+    m_timer.reset();
+    close(fd);
+  }
+  if (m_timeout_id != INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_timeout_id);
+    m_timeout_id = INVALID_TIMEOUT;
+  }
+}
+
+void FrameClock::RequestFrame(Subscriber *subscriber) {
+  m_pending.push_back(subscriber);
+}
+
+void FrameClock::CancelFrame(Subscriber *subscriber) {
+  m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), subscriber),
+                  m_pending.end());
+  // If we're in the middle of a tick, don't call it.
+  std::replace(m_emitting.begin(), m_emitting.end(), subscriber,
+               static_cast<Subscriber*>(NULL));
+}
+
+void FrameClock::Tick() {
+  // Subscribers may request the next frame from EmitFrame().
+  m_emitting.swap(m_pending);
+  for (unsigned int i = 0; i < m_emitting.size(); i++) {
+    if (m_emitting[i]) {
+      m_emitting[i]->EmitFrame();
+    }
+  }
+  m_emitting.clear();
+}
+
+/*
+ * Start a timerfd that expires on multiples of the period.
+ */
+bool FrameClock::StartTimer() {
+#if defined(HAVE_SYS_TIMERFD_H) && defined(CLOCK_MONOTONIC)
+  int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) {
+    OLA_WARN << "timerfd_create() failed, " << strerror(errno);
+    return false;
+  }
+
+  const int64_t period_ns = m_period.AsInt() * ONE_THOUSAND;
+  const int64_t one_second = ONE_THOUSAND * ONE_THOUSAND * ONE_THOUSAND;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t first_ns = static_cast<int64_t>(now.tv_sec) * one_second +
+                     now.tv_nsec;
+  first_ns = (first_ns / period_ns + 1) * period_ns;
+
+  struct itimerspec spec;
+  spec.it_value.tv_sec = static_cast<time_t>(first_ns / one_second);
+  spec.it_value.tv_nsec = static_cast<long>(  // NOLINT(runtime/int)
+      first_ns % one_second);
+  spec.it_interval.tv_sec = static_cast<time_t>(period_ns / one_second);
+  spec.it_interval.tv_nsec = static_cast<long>(  // NOLINT(runtime/int)
+      period_ns % one_second);
+  if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+    OLA_WARN << "timerfd_settime() failed, " << strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  m_timer.reset(new UnmanagedFileDescriptor(fd));
+  m_timer->SetOnData(NewCallback(this, &FrameClock::TimerExpired));
+  if (!m_ss->AddReadDescriptor(m_timer.get())) {
+    m_timer.reset();
+    close(fd);
+    return false;
+  }
+  OLA_INFO << "Frame clock running at " << m_rate << " Hz";
+  return true;
+#else
+  return false;
+#endif  // HAVE_SYS_TIMERFD_H && CLOCK_MONOTONIC
+}
+
+void FrameClock::TimerExpired() {
+  uint64_t expirations = 0;
+  ssize_t r = read(ola::io::ToFD(m_timer->ReadDescriptor()), &expirations,
+                   sizeof(expirations));
+  if (r != static_cast<ssize_t>(sizeof(expirations)) || !expirations) {
+    return;
+  }
+  CountTicks(expirations);
+  Tick();
+}
+
+bool FrameClock::TimeoutTick() {
+  CountTicks(1);
+  Tick();
+  return true;
+}
+
+void FrameClock::CountTicks(uint64_t ticks) {
+  if (!m_export_map) {
+    return;
+  }
+  (*m_export_map->GetCounterVar(K_FRAME_CLOCK_TICKS_VAR))++;
+  // If the loop was busy for more than a period, we only emit one frame.
+  if (ticks > 1) {
+    *m_export_map->GetCounterVar(K_FRAME_CLOCK_MISSED_VAR) +=
+        static_cast<unsigned int>(ticks - 1);
+  }
+}
+}  // namespace ola
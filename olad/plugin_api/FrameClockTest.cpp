@@ -0,0 +1,276 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FrameClockTest.cpp
+ * Test fixture for the FrameClock class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
+#include "olad/DmxUpdateFilter.h"
+#include "olad/FrameClock.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::DmxUpdateFilter;
+using ola::ExportMap;
+using ola::FrameClock;
+using ola::TimeInterval;
+using ola::Universe;
+using ola::UniverseStore;
+using ola::io::SelectServer;
+
+namespace {
+
+class MockSubscriber: public FrameClock::Subscriber {
+ public:
+  explicit MockSubscriber(FrameClock *clock,
+                          SelectServer *ss = NULL)
+      : frames(0),
+        request_again(false),
+        m_clock(clock),
+        m_ss(ss) {
+  }
+
+  void EmitFrame() {
+    frames++;
+    if (request_again) {
+      m_clock->RequestFrame(this);
+    }
+    if (m_ss) {
+      m_ss->Terminate();
+    }
+  }
+
+  unsigned int frames;
+  bool request_again;
+
+ private:
+  FrameClock *m_clock;
+  SelectServer *m_ss;
+};
+
+/*
+ * An output port that records how it was written to.
+ */
+class RecordingOutputPort: public TestMockOutputPort {
+ public:
+  RecordingOutputPort(ola::AbstractDevice *parent, unsigned int port_id)
+      : TestMockOutputPort(parent, port_id),
+        frames(0),
+        changes(0),
+        first_slot(0),
+        slot_count(0) {
+  }
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
+    frames++;
+    return TestMockOutputPort::WriteDMX(buffer, priority);
+  }
+
+  bool WriteDMXChanges(const DmxBuffer &buffer, unsigned int first_slot,
+                       unsigned int slot_count, uint8_t priority) {
+    changes++;
+    this->first_slot = first_slot;
+    this->slot_count = slot_count;
+    return TestMockOutputPort::WriteDMX(buffer, priority);
+  }
+
+  unsigned int frames;
+  unsigned int changes;
+  unsigned int first_slot;
+  unsigned int slot_count;
+};
+}  // namespace
+
+
+class FrameClockTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FrameClockTest);
+  CPPUNIT_TEST(testTick);
+  CPPUNIT_TEST(testUniverseOutput);
+  CPPUNIT_TEST(testTimer);
+  CPPUNIT_TEST(testInvalidRate);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testTick();
+  void testUniverseOutput();
+  void testTimer();
+  void testInvalidRate();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameClockTest);
+
+
+/*
+ * Check requested frames are emitted once, on the next tick.
+ */
+void FrameClockTest::testTick() {
+  FrameClock clock(NULL, 40, NULL);
+  OLA_ASSERT_EQ(40u, clock.Rate());
+  OLA_ASSERT_EQ(TimeInterval(0, 25000), clock.Period());
+
+  MockSubscriber subscriber1(&clock), subscriber2(&clock);
+  clock.Tick();
+  OLA_ASSERT_EQ(0u, subscriber1.frames);
+
+  clock.RequestFrame(&subscriber1);
+  clock.RequestFrame(&subscriber2);
+  clock.Tick();
+  OLA_ASSERT_EQ(1u, subscriber1.frames);
+  OLA_ASSERT_EQ(1u, subscriber2.frames);
+
+  clock.Tick();
+  OLA_ASSERT_EQ(1u, subscriber1.frames);
+  OLA_ASSERT_EQ(1u, subscriber2.frames);
+
+  // Cancelled requests aren't emitted.
+  clock.RequestFrame(&subscriber1);
+  clock.RequestFrame(&subscriber2);
+  clock.CancelFrame(&subscriber1);
+  clock.Tick();
+  OLA_ASSERT_EQ(1u, subscriber1.frames);
+  OLA_ASSERT_EQ(2u, subscriber2.frames);
+
+  // A request made while emitting waits for the following tick.
+  subscriber1.request_again = true;
+  clock.RequestFrame(&subscriber1);
+  clock.Tick();
+  OLA_ASSERT_EQ(2u, subscriber1.frames);
+  subscriber1.request_again = false;
+  clock.Tick();
+  OLA_ASSERT_EQ(3u, subscriber1.frames);
+  clock.Tick();
+  OLA_ASSERT_EQ(3u, subscriber1.frames);
+}
+
+
+/*
+ * Check a universe with a frame clock coalesces updates between ticks.
+ */
+void FrameClockTest::testUniverseOutput() {
+  FrameClock clock(NULL, 40, NULL);
+  UniverseStore store(NULL, NULL, &clock);
+  Universe *universe = store.GetUniverseOrCreate(1);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  const TimeInterval keep_alive(3600, 0);
+  RecordingOutputPort port(NULL, 1);
+  RecordingOutputPort delta_port(NULL, 2);
+  delta_port.UpdateFilter()->SetMode(DmxUpdateFilter::SEND_CHANGED_SLOTS);
+  delta_port.UpdateFilter()->SetKeepAliveInterval(keep_alive);
+  universe->AddPort(&port);
+  universe->AddPort(&delta_port);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5,6");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_EQ(0u, port.frames);
+  clock.Tick();
+  OLA_ASSERT_EQ(1u, port.frames);
+  OLA_ASSERT_EQ(1u, delta_port.frames);
+  OLA_ASSERT_DMX_EQUALS(buffer, port.ReadDMX());
+
+  // Nothing new, so nothing is sent.
+  clock.Tick();
+  OLA_ASSERT_EQ(1u, port.frames);
+
+  // Two updates between ticks only send the latest data, and the changes
+  // cover both.
+  buffer.SetChannel(1, 20);
+  universe->SetDMX(buffer);
+  buffer.SetChannel(4, 50);
+  universe->SetDMX(buffer);
+  OLA_ASSERT_EQ(1u, port.frames);
+  clock.Tick();
+  OLA_ASSERT_EQ(2u, port.frames);
+  OLA_ASSERT_DMX_EQUALS(buffer, port.ReadDMX());
+  OLA_ASSERT_EQ(1u, delta_port.changes);
+  OLA_ASSERT_EQ(1u, delta_port.first_slot);
+  OLA_ASSERT_EQ(4u, delta_port.slot_count);
+  OLA_ASSERT_DMX_EQUALS(buffer, delta_port.ReadDMX());
+
+  // An unchanged frame is sent to the ports that want every frame.
+  universe->SetDMX(buffer);
+  clock.Tick();
+  OLA_ASSERT_EQ(3u, port.frames);
+  OLA_ASSERT_EQ(1u, delta_port.changes);
+
+  // Removing the universe with a frame pending cancels it.
+  universe->SetDMX(buffer);
+  universe->RemovePort(&port);
+  universe->RemovePort(&delta_port);
+  store.DeleteAll();
+  clock.Tick();
+  OLA_ASSERT_EQ(3u, port.frames);
+}
+
+
+/*
+ * Check the clock ticks when run in a SelectServer.
+ */
+void FrameClockTest::testTimer() {
+  ExportMap export_map;
+  SelectServer ss;
+  FrameClock clock(&ss, 200, &export_map);
+  OLA_ASSERT_TRUE(clock.Start());
+
+  MockSubscriber subscriber(&clock, &ss);
+  clock.RequestFrame(&subscriber);
+  // In case the clock doesn't tick.
+  ss.RegisterSingleTimeout(
+      2000, ola::NewSingleCallback(&ss, &SelectServer::Terminate));
+  ss.Run();
+
+  OLA_ASSERT_EQ(1u, subscriber.frames);
+  OLA_ASSERT_TRUE(
+      export_map.GetCounterVar(FrameClock::K_FRAME_CLOCK_TICKS_VAR)->Get() >=
+      1u);
+  OLA_ASSERT_EQ(200, export_map.GetIntegerVar(
+      FrameClock::K_FRAME_CLOCK_RATE_VAR)->Get());
+  clock.Stop();
+}
+
+
+/*
+ * Check the clock refuses to start with a rate that's out of range.
+ */
+void FrameClockTest::testInvalidRate() {
+  SelectServer ss;
+  FrameClock zero_clock(&ss, 0, NULL);
+  OLA_ASSERT_FALSE(zero_clock.Start());
+
+  FrameClock max_clock(&ss, FrameClock::MAX_RATE, NULL);
+  OLA_ASSERT_EQ(TimeInterval(0, 100), max_clock.Period());
+  OLA_ASSERT_TRUE(max_clock.Start());
+  max_clock.Stop();
+
+  // This would have a period of less than a microsecond.
+  FrameClock fast_clock(&ss, 2000000, NULL);
+  OLA_ASSERT_FALSE(fast_clock.Start());
+
+  FrameClock too_fast_clock(&ss, FrameClock::MAX_RATE + 1, NULL);
+  OLA_ASSERT_FALSE(too_fast_clock.Start());
+}
@@ -18,8 +18,11 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/DeviceManager.cpp \
     olad/plugin_api/DeviceManager.h \
     olad/plugin_api/DmxSource.cpp \
+    olad/plugin_api/DmxUpdateFilter.cpp \
+    olad/plugin_api/FrameClock.cpp \
     olad/plugin_api/Plugin.cpp \
     olad/plugin_api/PluginAdaptor.cpp \
+    olad/plugin_api/PluginThread.cpp \
     olad/plugin_api/Port.cpp \
     olad/plugin_api/PortBroker.cpp \
     olad/plugin_api/PortManager.cpp \
@@ -41,6 +44,8 @@ test_programs += \
     olad/plugin_api/ClientTester \
     olad/plugin_api/DeviceTester \
     olad/plugin_api/DmxSourceTester \
+    olad/plugin_api/DmxUpdateFilterTester \
+    olad/plugin_api/PluginThreadTester \
     olad/plugin_api/PortTester \
     olad/plugin_api/PreferencesTester \
     olad/plugin_api/UniverseTester
@@ -64,6 +69,18 @@ olad_plugin_api_DmxSourceTester_SOURCES = olad/plugin_api/DmxSourceTest.cpp
 olad_plugin_api_DmxSourceTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_DmxSourceTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
+olad_plugin_api_DmxUpdateFilterTester_SOURCES = \
+    olad/plugin_api/DmxUpdateFilterTest.cpp
+olad_plugin_api_DmxUpdateFilterTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_DmxUpdateFilterTester_LDADD = \
+    $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+olad_plugin_api_PluginThreadTester_SOURCES = \
+    olad/plugin_api/PluginThreadTest.cpp
+olad_plugin_api_PluginThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+olad_plugin_api_PluginThreadTester_LDADD = \
+    $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
 olad_plugin_api_PortTester_SOURCES = olad/plugin_api/PortTest.cpp \
                                      olad/plugin_api/PortManagerTest.cpp
 olad_plugin_api_PortTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
@@ -73,6 +90,16 @@ olad_plugin_api_PreferencesTester_SOURCES = olad/plugin_api/PreferencesTest.cpp
 olad_plugin_api_PreferencesTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PreferencesTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/UniverseTest.cpp
+olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/FrameClockTest.cpp \
+                                         olad/plugin_api/UniverseTest.cpp
 olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_UniverseTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += olad/plugin_api/plugin_thread_benchmark
+olad_plugin_api_plugin_thread_benchmark_SOURCES = \
+    olad/plugin_api/PluginThreadBenchmark.cpp
+olad_plugin_api_plugin_thread_benchmark_LDADD = \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
@@ -21,7 +21,9 @@
 
 #include <string>
 #include "ola/Callback.h"
+#include "olad/FrameClock.h"
 #include "olad/PluginAdaptor.h"
+#include "olad/PluginThread.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -37,88 +39,113 @@ PluginAdaptor::PluginAdaptor(DeviceManager *device_manager,
                              ExportMap *export_map,
                              PreferencesFactory *preferences_factory,
                              PortBrokerInterface *port_broker,
-                             const std::string *instance_name):
+                             const std::string *instance_name,
+                             FrameClock *frame_clock):
   m_device_manager(device_manager),
   m_ss(select_server),
   m_export_map(export_map),
   m_preferences_factory(preferences_factory),
   m_port_broker(port_broker),
-  m_instance_name(instance_name) {
+  m_instance_name(instance_name),
+  m_frame_clock(frame_clock) {
 }
 
 bool PluginAdaptor::AddReadDescriptor(
     ola::io::ReadFileDescriptor *descriptor) {
-  return m_ss->AddReadDescriptor(descriptor);
+  return CurrentSelectServer()->AddReadDescriptor(descriptor);
 }
 
 bool PluginAdaptor::AddReadDescriptor(
     ola::io::ConnectedDescriptor *descriptor,
     bool delete_on_close) {
-  return m_ss->AddReadDescriptor(descriptor, delete_on_close);
+  return CurrentSelectServer()->AddReadDescriptor(descriptor, delete_on_close);
 }
 
 void PluginAdaptor::RemoveReadDescriptor(
     ola::io::ReadFileDescriptor *descriptor) {
-  m_ss->RemoveReadDescriptor(descriptor);
+  CurrentSelectServer()->RemoveReadDescriptor(descriptor);
 }
 
 void PluginAdaptor::RemoveReadDescriptor(
     ola::io::ConnectedDescriptor *descriptor) {
-  m_ss->RemoveReadDescriptor(descriptor);
+  CurrentSelectServer()->RemoveReadDescriptor(descriptor);
 }
 
 bool PluginAdaptor::AddWriteDescriptor(
     ola::io::WriteFileDescriptor *descriptor) {
-  return m_ss->AddWriteDescriptor(descriptor);
+  return CurrentSelectServer()->AddWriteDescriptor(descriptor);
 }
 
 void PluginAdaptor::RemoveWriteDescriptor(
     ola::io::WriteFileDescriptor *descriptor) {
-  m_ss->RemoveWriteDescriptor(descriptor);
+  CurrentSelectServer()->RemoveWriteDescriptor(descriptor);
 }
 
 timeout_id PluginAdaptor::RegisterRepeatingTimeout(
     unsigned int ms,
     Callback0<bool> *closure) {
-  return m_ss->RegisterRepeatingTimeout(ms, closure);
+  return CurrentSelectServer()->RegisterRepeatingTimeout(ms, closure);
 }
 
 timeout_id PluginAdaptor::RegisterRepeatingTimeout(
     const TimeInterval &interval,
     Callback0<bool> *closure) {
-  return m_ss->RegisterRepeatingTimeout(interval, closure);
+  return CurrentSelectServer()->RegisterRepeatingTimeout(interval, closure);
 }
 
 timeout_id PluginAdaptor::RegisterSingleTimeout(
     unsigned int ms,
     SingleUseCallback0<void> *closure) {
-  return m_ss->RegisterSingleTimeout(ms, closure);
+  return CurrentSelectServer()->RegisterSingleTimeout(ms, closure);
 }
 
 timeout_id PluginAdaptor::RegisterSingleTimeout(
     const TimeInterval &interval,
     SingleUseCallback0<void> *closure) {
-  return m_ss->RegisterSingleTimeout(interval, closure);
+  return CurrentSelectServer()->RegisterSingleTimeout(interval, closure);
 }
 
 void PluginAdaptor::RemoveTimeout(timeout_id id) {
-  m_ss->RemoveTimeout(id);
+  CurrentSelectServer()->RemoveTimeout(id);
 }
 
 void PluginAdaptor::Execute(ola::BaseCallback0<void> *closure) {
-  m_ss->Execute(closure);
+  CurrentSelectServer()->Execute(closure);
 }
 
 void PluginAdaptor::DrainCallbacks() {
-  m_ss->DrainCallbacks();
+  CurrentSelectServer()->DrainCallbacks();
 }
 
 bool PluginAdaptor::RegisterDevice(AbstractDevice *device) const {
-  return m_device_manager->RegisterDevice(device);
+  PluginThread *thread = PluginThread::Current();
+  if (!thread) {
+    return m_device_manager->RegisterDevice(device);
+  }
+  return thread->RunInMainThread(
+      NewSingleCallback(m_device_manager, &DeviceManager::RegisterDevice,
+                        device));
 }
 
 bool PluginAdaptor::UnregisterDevice(AbstractDevice *device) const {
-  return m_device_manager->UnregisterDevice(device);
+  PluginThread *thread = PluginThread::Current();
+  if (!thread) {
+    return m_device_manager->UnregisterDevice(device);
+  }
+  bool ok = thread->RunInMainThread(
+      NewSingleCallback(&PluginAdaptor::UnregisterInMainThread,
+                        m_device_manager, thread, device));
+  // Frames that were queued before the device was unregistered refer to its
+  // ports, deliver them while the ports still exist.
+  thread->DeliverOutput();
+  return ok;
+}
+
+bool PluginAdaptor::UnregisterInMainThread(DeviceManager *device_manager,
+                                           PluginThread *thread,
+                                           AbstractDevice *device) {
+  thread->DeliverInput();
+  return device_manager->UnregisterDevice(device);
 }
 
 Preferences *PluginAdaptor::NewPreference(const string &name) const {
@@ -126,7 +153,7 @@ Preferences *PluginAdaptor::NewPreference(const string &name) const {
 }
 
 const TimeStamp *PluginAdaptor::WakeUpTime() const {
-  return m_ss->WakeUpTime();
+  return CurrentSelectServer()->WakeUpTime();
 }
 
 const std::string PluginAdaptor::InstanceName() const {
@@ -136,4 +163,19 @@ const std::string PluginAdaptor::InstanceName() const {
     return "";
   }
 }
+
+FrameClock *PluginAdaptor::GetFrameClock() const {
+  return PluginThread::Current() ? NULL : m_frame_clock;
+}
+
+/*
+ * Plugins that run in their own thread use that thread's SelectServer.
+ */
+SelectServerInterface *PluginAdaptor::CurrentSelectServer() const {
+  PluginThread *thread = PluginThread::Current();
+  if (thread) {
+    return thread->GetSelectServer();
+  }
+  return m_ss;
+}
 }  // namespace ola
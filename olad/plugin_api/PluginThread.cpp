@@ -0,0 +1,616 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThread.cpp
+ * Runs a plugin in its own thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <pthread.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/Device.h"
+#include "olad/Plugin.h"
+#include "olad/PluginThread.h"
+#include "olad/Port.h"
+
+namespace ola {
+
+using ola::io::SelectServerInterface;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UIDSet;
+using ola::thread::MutexLocker;
+using std::string;
+
+const char PluginThread::INPUT_DROPS_VAR[] = "plugin-thread-input-drops";
+const char PluginThread::OUTPUT_DROPS_VAR[] = "plugin-thread-output-drops";
+
+namespace {
+
+pthread_key_t current_thread_key;
+pthread_once_t current_thread_once = PTHREAD_ONCE_INIT;
+
+void CreateCurrentThreadKey() {
+  pthread_key_create(&current_thread_key, NULL);
+}
+
+#ifdef __ATOMIC_SEQ_CST
+inline uint32_t Exchange(uint32_t *value, uint32_t new_value) {
+  return __atomic_exchange_n(value, new_value, __ATOMIC_SEQ_CST);
+}
+
+inline void Increment(uint32_t *value) {
+  __atomic_add_fetch(value, 1, __ATOMIC_RELAXED);
+}
+
+inline uint32_t Load(const uint32_t *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+#else
+inline uint32_t Exchange(uint32_t *value, uint32_t new_value) {
+  __sync_synchronize();
+  uint32_t old_value = __sync_lock_test_and_set(value, new_value);
+  __sync_synchronize();
+  return old_value;
+}
+
+inline void Increment(uint32_t *value) {
+  __sync_add_and_fetch(value, 1);
+}
+
+inline uint32_t Load(const uint32_t *value) {
+  return __sync_add_and_fetch(const_cast<uint32_t*>(value), 0);
+}
+#endif  // __ATOMIC_SEQ_CST
+
+void RunAndStoreResult(BaseCallback0<bool> *callback, bool *result) {
+  *result = callback->Run();
+}
+
+void RunRDMCallback(RDMCallback *callback, RDMReply *reply) {
+  callback->Run(reply);
+  delete reply;
+}
+
+/*
+ * The reply is only valid for the duration of the callback, so take a copy.
+ */
+void PostRDMReply(SelectServerInterface *ss, RDMCallback *callback,
+                  RDMReply *reply) {
+  RDMReply *copy = new RDMReply(
+      reply->StatusCode(),
+      reply->Response() ? reply->Response()->Duplicate() : NULL,
+      reply->Frames());
+  ss->Execute(NewSingleCallback(&RunRDMCallback, callback, copy));
+}
+
+void RunDiscoveryCallback(RDMDiscoveryCallback *callback, UIDSet uids) {
+  callback->Run(uids);
+}
+
+void PostDiscoveryResult(SelectServerInterface *ss,
+                         RDMDiscoveryCallback *callback,
+                         const UIDSet &uids) {
+  ss->Execute(NewSingleCallback(&RunDiscoveryCallback, callback, uids));
+}
+
+void PostCallback(SelectServerInterface *ss, BaseCallback0<void> *callback) {
+  ss->Execute(callback);
+}
+
+// The callbacks can't bind const references, these take pointers instead.
+// They're only used for synchronous calls.
+void SetUniverseName(OutputPort *port, const string *name) {
+  port->UniverseNameChanged(*name);
+}
+
+bool SendTimeCodeToPort(OutputPort *port,
+                        const ola::timecode::TimeCode *timecode) {
+  return port->SendTimeCode(*timecode);
+}
+
+void GetPluginDescription(const AbstractPlugin *plugin, string *description) {
+  *description = plugin->Description();
+}
+
+void GetPortDescription(const Port *port, string *description) {
+  *description = port->Description();
+}
+
+struct ConfigureCall {
+  AbstractDevice *device;
+  ola::rpc::RpcController *controller;
+  const string *request;
+  string *response;
+  BaseCallback0<void> *done;
+
+  void Run() {
+    device->Configure(controller, *request, response, done);
+  }
+};
+}  // namespace
+
+
+PluginThread::PluginThread(AbstractPlugin *plugin,
+                           SelectServerInterface *main_ss,
+                           ExportMap *export_map)
+    : ola::thread::Thread(Options(plugin->Name())),
+      m_plugin(plugin),
+      m_main_ss(main_ss),
+      m_export_map(export_map),
+      m_running(false),
+      m_exited(false),
+      m_input_queue(QUEUE_SIZE),
+      m_output_queue(QUEUE_SIZE),
+      m_input_pending(0),
+      m_output_pending(0),
+      m_input_drops(0),
+      m_reported_input_drops(0),
+      m_deliver_input(NewCallback(this, &PluginThread::DeliverInput)),
+      m_deliver_output(NewCallback(this, &PluginThread::DeliverOutput)),
+      m_run_main_calls(NewCallback(this, &PluginThread::RunMainCalls)),
+      m_main_call_depth(0) {
+}
+
+
+PluginThread::~PluginThread() {
+  Stop();
+  delete m_deliver_input;
+  delete m_deliver_output;
+  delete m_run_main_calls;
+}
+
+
+bool PluginThread::Start() {
+  if (m_running) {
+    return true;
+  }
+  m_exited = false;
+  if (!ola::thread::Thread::Start()) {
+    OLA_WARN << "Failed to start the thread for " << m_plugin->Name();
+    return false;
+  }
+  m_running = true;
+  return true;
+}
+
+
+void PluginThread::Stop() {
+  if (!m_running) {
+    return;
+  }
+
+  m_ss.Terminate();
+  // The thread may need the main thread before it can exit.
+  WaitFor(&m_exited);
+  Join();
+  m_running = false;
+
+  while (m_output_queue.Front()) {
+    m_output_queue.Pop();
+  }
+  while (m_input_queue.Front()) {
+    m_input_queue.Pop();
+  }
+  // Run anything we scheduled in the main thread, so nothing refers to us
+  // once we're deleted.
+  m_main_ss->DrainCallbacks();
+  UpdateDropCounters();
+}
+
+
+void PluginThread::RunInPluginThread(BaseCallback0<void> *callback) {
+  // If the plugin thread is blocked on a call to us, it's safe to run the
+  // callback here, and waiting for the plugin thread would deadlock.
+  if (!m_running || m_main_call_depth || Current() == this) {
+    callback->Run();
+    return;
+  }
+
+  PendingCall call = {callback, false};
+  m_ss.Execute(NewSingleCallback(this, &PluginThread::RunPluginCall, &call));
+  WaitFor(&call.done);
+}
+
+
+bool PluginThread::RunInPluginThread(BaseCallback0<bool> *callback) {
+  bool result = false;
+  RunInPluginThread(NewSingleCallback(&RunAndStoreResult, callback, &result));
+  return result;
+}
+
+
+bool PluginThread::QueueOutput(OutputPort *port,
+                               const DmxBuffer &buffer,
+                               uint8_t priority,
+                               unsigned int first_changed_slot,
+                               unsigned int changed_slot_count,
+                               bool changes_only) {
+  OutputFrame *frame = m_output_queue.Reserve();
+  if (!frame) {
+    if (m_export_map) {
+      (*m_export_map->GetUIntMapVar(OUTPUT_DROPS_VAR, "plugin"))[
+          m_plugin->Name()]++;
+    }
+    return false;
+  }
+
+  frame->port = port;
+  frame->priority = priority;
+  frame->changes_only = changes_only;
+  frame->first_changed_slot = first_changed_slot;
+  frame->changed_slot_count = changed_slot_count;
+  frame->length = sizeof(frame->data);
+  buffer.Get(frame->data, &frame->length);
+  m_output_queue.Commit();
+
+  if (!Exchange(&m_output_pending, 1)) {
+    m_ss.Execute(m_deliver_output);
+  }
+  return true;
+}
+
+
+void PluginThread::DeliverInput() {
+  Exchange(&m_input_pending, 0);
+
+  InputFrame *frame;
+  while ((frame = m_input_queue.Front())) {
+    BasicInputPort *port = frame->port;
+    const TimeStamp received = frame->received;
+    const uint8_t priority = frame->priority;
+    m_input_buffer.Set(frame->data, frame->length);
+    m_input_queue.Pop();
+    port->UpdateSource(m_input_buffer, received, priority);
+  }
+  UpdateDropCounters();
+}
+
+
+void PluginThread::RunInMainThread(BaseCallback0<void> *callback) {
+  if (Current() != this) {
+    callback->Run();
+    return;
+  }
+
+  PendingCall call = {callback, false};
+  {
+    MutexLocker locker(&m_mutex);
+    m_main_calls.push_back(&call);
+    m_condition.Broadcast();
+  }
+  // If the main thread is waiting for us it'll run the call, otherwise this
+  // runs it from the main thread's event loop.
+  m_main_ss->Execute(m_run_main_calls);
+
+  MutexLocker locker(&m_mutex);
+  while (!call.done) {
+    m_condition.Wait(&m_mutex);
+  }
+}
+
+
+bool PluginThread::RunInMainThread(BaseCallback0<bool> *callback) {
+  bool result = false;
+  RunInMainThread(NewSingleCallback(&RunAndStoreResult, callback, &result));
+  return result;
+}
+
+
+void PluginThread::QueueInput(BasicInputPort *port,
+                              const DmxBuffer &buffer,
+                              uint8_t priority,
+                              const TimeStamp &received) {
+  InputFrame *frame = m_input_queue.Reserve();
+  if (!frame) {
+    Increment(&m_input_drops);
+    return;
+  }
+
+  frame->port = port;
+  frame->received = received;
+  frame->priority = priority;
+  frame->length = sizeof(frame->data);
+  buffer.Get(frame->data, &frame->length);
+  m_input_queue.Commit();
+
+  if (!Exchange(&m_input_pending, 1)) {
+    m_main_ss->Execute(m_deliver_input);
+  }
+}
+
+
+void PluginThread::DeliverOutput() {
+  Exchange(&m_output_pending, 0);
+
+  OutputFrame *frame;
+  while ((frame = m_output_queue.Front())) {
+    m_output_buffer.Set(frame->data, frame->length);
+    if (frame->changes_only) {
+      frame->port->WriteDMXChanges(m_output_buffer, frame->first_changed_slot,
+                                   frame->changed_slot_count,
+                                   frame->priority);
+    } else {
+      frame->port->WriteDMX(m_output_buffer, frame->priority);
+    }
+    m_output_queue.Pop();
+  }
+}
+
+
+RDMCallback *PluginThread::MainThreadCallback(RDMCallback *callback) {
+  return NewSingleCallback(&PostRDMReply, m_main_ss, callback);
+}
+
+
+RDMDiscoveryCallback *PluginThread::MainThreadCallback(
+    RDMDiscoveryCallback *callback) {
+  return NewSingleCallback(&PostDiscoveryResult, m_main_ss, callback);
+}
+
+
+BaseCallback0<void> *PluginThread::MainThreadCallback(
+    BaseCallback0<void> *callback) {
+  return NewSingleCallback(&PostCallback, m_main_ss, callback);
+}
+
+
+RDMCallback *PluginThread::PluginThreadCallback(RDMCallback *callback) {
+  return NewSingleCallback(
+      &PostRDMReply, static_cast<SelectServerInterface*>(&m_ss), callback);
+}
+
+
+RDMDiscoveryCallback *PluginThread::PluginThreadCallback(
+    RDMDiscoveryCallback *callback) {
+  return NewSingleCallback(
+      &PostDiscoveryResult, static_cast<SelectServerInterface*>(&m_ss),
+      callback);
+}
+
+
+PluginThread *PluginThread::Current() {
+  pthread_once(&current_thread_once, CreateCurrentThreadKey);
+  return static_cast<PluginThread*>(pthread_getspecific(current_thread_key));
+}
+
+
+PluginThread *PluginThread::ForDevice(const AbstractDevice *device) {
+  if (!device) {
+    return NULL;
+  }
+  AbstractPlugin *plugin = device->Owner();
+  return plugin ? plugin->GetThread() : NULL;
+}
+
+
+bool PluginThread::SetUniverse(Port *port, Universe *universe) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    return port->SetUniverse(universe);
+  }
+  return thread->RunInPluginThread(
+      NewSingleCallback(port, &Port::SetUniverse, universe));
+}
+
+
+void PluginThread::WriteDMX(OutputPort *port, const DmxBuffer &buffer,
+                            uint8_t priority) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (thread) {
+    thread->QueueOutput(port, buffer, priority, 0, 0, false);
+  } else {
+    port->WriteDMX(buffer, priority);
+  }
+}
+
+
+void PluginThread::WriteDMXChanges(OutputPort *port, const DmxBuffer &buffer,
+                                   unsigned int first_slot,
+                                   unsigned int slot_count,
+                                   uint8_t priority) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (thread) {
+    thread->QueueOutput(port, buffer, priority, first_slot, slot_count, true);
+  } else {
+    port->WriteDMXChanges(buffer, first_slot, slot_count, priority);
+  }
+}
+
+
+void PluginThread::UniverseNameChanged(OutputPort *port, const string &name) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    port->UniverseNameChanged(name);
+    return;
+  }
+  thread->RunInPluginThread(
+      NewSingleCallback(&SetUniverseName, port, &name));
+}
+
+
+void PluginThread::SendRDMRequest(OutputPort *port,
+                                  RDMRequest *request,
+                                  RDMCallback *callback) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    port->SendRDMRequest(request, callback);
+    return;
+  }
+  thread->RunInPluginThread(
+      NewSingleCallback(port, &OutputPort::SendRDMRequest, request,
+                        thread->MainThreadCallback(callback)));
+}
+
+
+void PluginThread::RunDiscovery(OutputPort *port, bool full,
+                                RDMDiscoveryCallback *on_complete) {
+  void (OutputPort::*method)(RDMDiscoveryCallback*) = full ?
+      &OutputPort::RunFullDiscovery : &OutputPort::RunIncrementalDiscovery;
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    (port->*method)(on_complete);
+    return;
+  }
+  thread->RunInPluginThread(
+      NewSingleCallback(port, method, thread->MainThreadCallback(on_complete)));
+}
+
+
+bool PluginThread::SendTimeCode(OutputPort *port,
+                                const ola::timecode::TimeCode &timecode) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    return port->SendTimeCode(timecode);
+  }
+  return thread->RunInPluginThread(
+      NewSingleCallback(&SendTimeCodeToPort, port, &timecode));
+}
+
+
+void PluginThread::Configure(AbstractDevice *device,
+                             ola::rpc::RpcController *controller,
+                             const string &request,
+                             string *response,
+                             BaseCallback0<void> *done) {
+  PluginThread *thread = ForDevice(device);
+  if (!thread) {
+    device->Configure(controller, request, response, done);
+    return;
+  }
+  ConfigureCall call = {device, controller, &request, response,
+                        thread->MainThreadCallback(done)};
+  thread->RunInPluginThread(NewSingleCallback(&call, &ConfigureCall::Run));
+}
+
+
+string PluginThread::PluginDescription(const AbstractPlugin *plugin) {
+  PluginThread *thread = plugin->GetThread();
+  if (!thread) {
+    return plugin->Description();
+  }
+  string description;
+  thread->RunInPluginThread(
+      NewSingleCallback(&GetPluginDescription, plugin, &description));
+  return description;
+}
+
+
+string PluginThread::PortDescription(const Port *port) {
+  PluginThread *thread = ForDevice(port->GetDevice());
+  if (!thread) {
+    return port->Description();
+  }
+  string description;
+  thread->RunInPluginThread(
+      NewSingleCallback(&GetPortDescription, port, &description));
+  return description;
+}
+
+
+void *PluginThread::Run() {
+  pthread_once(&current_thread_once, CreateCurrentThreadKey);
+  pthread_setspecific(current_thread_key, this);
+  m_ss.Run();
+  pthread_setspecific(current_thread_key, NULL);
+
+  MutexLocker locker(&m_mutex);
+  m_exited = true;
+  m_condition.Broadcast();
+  return NULL;
+}
+
+
+/*
+ * Run a call from the main thread, in the plugin thread.
+ */
+void PluginThread::RunPluginCall(PendingCall *call) {
+  call->callback->Run();
+  MutexLocker locker(&m_mutex);
+  call->done = true;
+  m_condition.Broadcast();
+}
+
+
+/*
+ * Run the calls from the plugin thread, in the main thread.
+ */
+void PluginThread::RunMainCalls() {
+  while (true) {
+    PendingCall *call;
+    {
+      MutexLocker locker(&m_mutex);
+      if (m_main_calls.empty()) {
+        return;
+      }
+      call = m_main_calls.front();
+      m_main_calls.pop_front();
+    }
+    RunMainCall(call);
+  }
+}
+
+
+void PluginThread::RunMainCall(PendingCall *call) {
+  m_main_call_depth++;
+  call->callback->Run();
+  m_main_call_depth--;
+
+  MutexLocker locker(&m_mutex);
+  call->done = true;
+  m_condition.Broadcast();
+}
+
+
+/*
+ * Wait in the main thread until the flag is set, running any calls the
+ * plugin thread makes in the meantime.
+ */
+void PluginThread::WaitFor(const bool *done) {
+  m_mutex.Lock();
+  while (!*done) {
+    if (m_main_calls.empty()) {
+      m_condition.Wait(&m_mutex);
+      continue;
+    }
+    PendingCall *call = m_main_calls.front();
+    m_main_calls.pop_front();
+    m_mutex.Unlock();
+    RunMainCall(call);
+    m_mutex.Lock();
+  }
+  m_mutex.Unlock();
+}
+
+
+void PluginThread::UpdateDropCounters() {
+  uint32_t input_drops = Load(&m_input_drops);
+  if (input_drops == m_reported_input_drops) {
+    return;
+  }
+  if (m_export_map) {
+    (*m_export_map->GetUIntMapVar(INPUT_DROPS_VAR, "plugin"))[
+        m_plugin->Name()] += input_drops - m_reported_input_drops;
+  }
+  m_reported_input_drops = input_drops;
+}
+}  // namespace ola
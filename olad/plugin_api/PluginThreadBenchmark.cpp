@@ -0,0 +1,368 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThreadBenchmark.cpp
+ * Compare running plugins in the main thread and in their own threads.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Each plugin has a device with an input port and an output port, both
+ * patched to the plugin's universe. A timer in the plugin stamps the time into
+ * a frame and passes it to the input port, the universe then sends it back to
+ * the output port. Both ports spin for a while on each frame, to stand in for
+ * the work a real plugin does.
+ *
+ * The benchmark is run with every plugin in the main thread, and then with
+ * each plugin in its own thread. It reports how late a 1ms timer in the main
+ * thread fires, and the time from the input port to the output port.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/io/SelectServer.h"
+#include "olad/Device.h"
+#include "olad/Plugin.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PluginThread.h"
+#include "olad/Port.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::PluginAdaptor;
+using ola::PluginThread;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint16(plugins, p, 16, "The number of plugins");
+DEFINE_s_uint16(rate, r, 44, "The frames per second sent by each plugin");
+DEFINE_s_uint32(work, w, 300,
+                "The microseconds each port spends on each frame");
+DEFINE_s_uint16(duration, d, 5, "The seconds to run each test for");
+
+namespace {
+
+const unsigned int CORE_TIMER_MS = 1;
+
+typedef vector<int64_t> Samples;
+
+/*
+ * Spin for the configured time.
+ */
+void DoWork() {
+  Clock clock;
+  TimeStamp start, now;
+  clock.CurrentTime(&start);
+  const int64_t work = FLAGS_work;
+  do {
+    clock.CurrentTime(&now);
+  } while ((now - start).AsInt() < work);
+}
+
+class BenchmarkInputPort: public ola::BasicInputPort {
+ public:
+  BenchmarkInputPort(ola::AbstractDevice *parent,
+                     const PluginAdaptor *plugin_adaptor)
+      : ola::BasicInputPort(parent, 1, plugin_adaptor) {
+  }
+
+  string Description() const { return ""; }
+  const DmxBuffer &ReadDMX() const { return m_buffer; }
+
+  void SendFrame(int64_t stamp) {
+    DoWork();
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    memset(data, 0, sizeof(data));
+    memcpy(data, &stamp, sizeof(stamp));
+    m_buffer.Set(data, sizeof(data));
+    DmxChanged();
+  }
+
+ private:
+  DmxBuffer m_buffer;
+};
+
+class BenchmarkOutputPort: public ola::BasicOutputPort {
+ public:
+  BenchmarkOutputPort(ola::AbstractDevice *parent, const TimeStamp *epoch)
+      : ola::BasicOutputPort(parent, 1),
+        m_epoch(epoch) {
+  }
+
+  string Description() const { return ""; }
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t) {
+    int64_t stamp;
+    if (buffer.Size() < sizeof(stamp)) {
+      return true;
+    }
+    memcpy(&stamp, buffer.GetRaw(), sizeof(stamp));
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_latencies.push_back((now - *m_epoch).AsInt() - stamp);
+    DoWork();
+    return true;
+  }
+
+  const Samples &Latencies() const { return m_latencies; }
+
+ private:
+  const TimeStamp *m_epoch;
+  Clock m_clock;
+  Samples m_latencies;
+};
+
+class BenchmarkDevice: public ola::Device {
+ public:
+  BenchmarkDevice(ola::AbstractPlugin *owner, const string &name)
+      : Device(owner, name) {}
+  string DeviceId() const { return Name(); }
+  bool AllowLooping() const { return true; }
+  bool AllowMultiPortPatching() const { return false; }
+};
+
+/*
+ * A plugin with a single device, which sends a frame on a timer.
+ */
+class BenchmarkPlugin: public ola::Plugin {
+ public:
+  BenchmarkPlugin(PluginAdaptor *plugin_adaptor, unsigned int index,
+                  const TimeStamp *epoch)
+      : Plugin(plugin_adaptor),
+        m_index(index),
+        m_epoch(epoch),
+        m_device(NULL),
+        m_input_port(NULL),
+        m_output_port(NULL),
+        m_timeout(ola::thread::INVALID_TIMEOUT) {
+  }
+
+  string Name() const { return "Benchmark " + Prefix(); }
+  string Description() const { return ""; }
+  ola::ola_plugin_id Id() const { return ola::OLA_PLUGIN_DUMMY; }
+  string PluginPrefix() const { return Prefix(); }
+  bool SupportsThreads() const { return true; }
+
+  ola::InputPort *GetInputPort() { return m_input_port; }
+  ola::OutputPort *GetOutputPort() { return m_output_port; }
+
+  void AddLatencies(Samples *latencies) const {
+    latencies->insert(latencies->end(), m_latencies.begin(),
+                      m_latencies.end());
+  }
+
+ protected:
+  bool StartHook() {
+    m_device = new BenchmarkDevice(this, Prefix());
+    m_input_port = new BenchmarkInputPort(m_device, m_plugin_adaptor);
+    m_output_port = new BenchmarkOutputPort(m_device, m_epoch);
+    m_device->AddPort(m_input_port);
+    m_device->AddPort(m_output_port);
+    m_plugin_adaptor->RegisterDevice(m_device);
+    m_timeout = m_plugin_adaptor->RegisterRepeatingTimeout(
+        TimeInterval(ONE_SECOND_IN_USEC / FLAGS_rate),
+        NewCallback(this, &BenchmarkPlugin::SendFrame));
+    return true;
+  }
+
+  bool StopHook() {
+    m_plugin_adaptor->RemoveTimeout(m_timeout);
+    m_latencies = m_output_port->Latencies();
+    m_plugin_adaptor->UnregisterDevice(m_device);
+    m_device->Stop();
+    delete m_device;
+    m_device = NULL;
+    return true;
+  }
+
+ private:
+  const unsigned int m_index;
+  const TimeStamp *m_epoch;
+  BenchmarkDevice *m_device;
+  BenchmarkInputPort *m_input_port;
+  BenchmarkOutputPort *m_output_port;
+  ola::thread::timeout_id m_timeout;
+  Samples m_latencies;
+  Clock m_clock;
+
+  string Prefix() const {
+    std::ostringstream str;
+    str << "benchmark-" << m_index;
+    return str.str();
+  }
+
+  bool SendFrame() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_input_port->SendFrame((now - *m_epoch).AsInt());
+    return true;
+  }
+
+  static const int64_t ONE_SECOND_IN_USEC = 1000000;
+};
+
+/*
+ * Record how late the main thread's timer fires.
+ */
+class CoreTimer {
+ public:
+  CoreTimer() {
+    m_clock.CurrentTime(&m_last);
+  }
+
+  bool Tick() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_jitter.push_back((now - m_last).AsInt() -
+                       CORE_TIMER_MS * 1000);
+    m_last = now;
+    return true;
+  }
+
+  const Samples &Jitter() const { return m_jitter; }
+
+ private:
+  Clock m_clock;
+  TimeStamp m_last;
+  Samples m_jitter;
+};
+
+int64_t Percentile(const Samples &samples, unsigned int percentile) {
+  if (samples.empty()) {
+    return 0;
+  }
+  size_t index = (samples.size() - 1) * percentile / 100;
+  return samples[index];
+}
+
+void PrintSamples(const string &name, Samples *samples) {
+  std::sort(samples->begin(), samples->end());
+  cout << "  " << std::left << std::setw(22) << name << std::right
+       << " p50 " << std::setw(7) << Percentile(*samples, 50)
+       << "us  p99 " << std::setw(7) << Percentile(*samples, 99)
+       << "us  max " << std::setw(7) << Percentile(*samples, 100)
+       << "us  (" << samples->size() << " samples)" << endl;
+}
+
+/*
+ * Run the benchmark once.
+ */
+void RunBenchmark(bool use_threads) {
+  ola::io::SelectServer ss;
+  ola::ExportMap export_map;
+  ola::MemoryPreferencesFactory preferences_factory;
+  ola::MemoryPreferences universe_preferences("universe");
+  ola::UniverseStore store(&universe_preferences, &export_map);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+  ola::DeviceManager device_manager(&preferences_factory, &port_manager);
+  PluginAdaptor plugin_adaptor(&device_manager, &ss, &export_map,
+                               &preferences_factory, &broker, NULL);
+  TimeStamp epoch;
+  Clock clock;
+  clock.CurrentTime(&epoch);
+
+  vector<BenchmarkPlugin*> plugins;
+  vector<PluginThread*> threads;
+  for (unsigned int i = 0; i < FLAGS_plugins; i++) {
+    BenchmarkPlugin *plugin = new BenchmarkPlugin(&plugin_adaptor, i, &epoch);
+    plugins.push_back(plugin);
+    if (use_threads) {
+      PluginThread *thread = new PluginThread(plugin, &ss, &export_map);
+      thread->Start();
+      plugin->SetThread(thread);
+      thread->RunInPluginThread(
+          NewSingleCallback(static_cast<ola::AbstractPlugin*>(plugin),
+                            &ola::AbstractPlugin::Start));
+      threads.push_back(thread);
+    } else {
+      plugin->Start();
+    }
+    port_manager.PatchPort(plugin->GetInputPort(), i + 1);
+    port_manager.PatchPort(plugin->GetOutputPort(), i + 1);
+  }
+
+  CoreTimer core_timer;
+  ss.RegisterRepeatingTimeout(CORE_TIMER_MS,
+                              NewCallback(&core_timer, &CoreTimer::Tick));
+  ss.RegisterSingleTimeout(
+      FLAGS_duration * 1000,
+      NewSingleCallback(&ss, &ola::io::SelectServer::Terminate));
+  ss.Run();
+
+  Samples latencies;
+  for (unsigned int i = 0; i < plugins.size(); i++) {
+    BenchmarkPlugin *plugin = plugins[i];
+    if (use_threads) {
+      PluginThread *thread = threads[i];
+      thread->RunInPluginThread(
+          NewSingleCallback(static_cast<ola::AbstractPlugin*>(plugin),
+                            &ola::AbstractPlugin::Stop));
+      thread->Stop();
+      plugin->SetThread(NULL);
+      delete thread;
+    } else {
+      plugin->Stop();
+    }
+    plugin->AddLatencies(&latencies);
+    delete plugin;
+  }
+
+  Samples jitter = core_timer.Jitter();
+  cout << (use_threads ? "Plugin threads" : "Main thread") << ":" << endl;
+  PrintSamples("core timer lateness", &jitter);
+  PrintSamples("input to output", &latencies);
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Compare running plugins in the main thread and in their own "
+               "threads.");
+  if (FLAGS_plugins == 0 || FLAGS_rate == 0) {
+    OLA_FATAL << "--plugins and --rate must be non zero";
+    return 1;
+  }
+
+  cout << FLAGS_plugins << " plugins, " << FLAGS_rate << " fps, "
+       << FLAGS_work << "us of work per port per frame" << endl;
+  RunBenchmark(false);
+  RunBenchmark(true);
+  return 0;
+}
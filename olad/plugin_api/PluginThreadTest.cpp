@@ -0,0 +1,308 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PluginThreadTest.cpp
+ * Test fixture for the PluginThread class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PluginThread.h"
+#include "olad/PortBroker.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DeviceManager;
+using ola::DmxBuffer;
+using ola::NewSingleCallback;
+using ola::PluginThread;
+using ola::Universe;
+using std::string;
+
+static const unsigned int TEST_UNIVERSE = 1;
+static const char TEST_DATA[] = "this is some test data";
+
+/*
+ * Describes the thread the description was read in.
+ */
+static string ThreadDescription() {
+  return PluginThread::Current() ? "plugin thread" : "main thread";
+}
+
+class DescribedOutputPort: public TestMockOutputPort {
+ public:
+  DescribedOutputPort(ola::AbstractDevice *parent, unsigned int port_id)
+      : TestMockOutputPort(parent, port_id) {}
+
+  string Description() const { return ThreadDescription(); }
+};
+
+class DescribedPlugin: public TestMockPlugin {
+ public:
+  explicit DescribedPlugin(ola::PluginAdaptor *plugin_adaptor)
+      : TestMockPlugin(plugin_adaptor, ola::OLA_PLUGIN_DUMMY) {}
+
+  string Description() const { return ThreadDescription(); }
+};
+
+class PluginThreadTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PluginThreadTest);
+  CPPUNIT_TEST(testCalls);
+  CPPUNIT_TEST(testOutput);
+  CPPUNIT_TEST(testInput);
+  CPPUNIT_TEST(testRegisterDevice);
+  CPPUNIT_TEST(testDescriptions);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  PluginThreadTest()
+      : m_preferences(NULL),
+        m_store(NULL),
+        m_port_manager(NULL),
+        m_device_manager(NULL),
+        m_plugin_adaptor(NULL),
+        m_plugin(NULL),
+        m_thread(NULL) {
+  }
+
+  void setUp();
+  void tearDown();
+  void testCalls();
+  void testOutput();
+  void testInput();
+  void testRegisterDevice();
+  void testDescriptions();
+
+ private:
+  ola::io::SelectServer m_ss;
+  ola::ExportMap m_export_map;
+  ola::MemoryPreferencesFactory m_preferences_factory;
+  ola::MemoryPreferences *m_preferences;
+  ola::UniverseStore *m_store;
+  ola::PortBroker m_broker;
+  ola::PortManager *m_port_manager;
+  DeviceManager *m_device_manager;
+  ola::PluginAdaptor *m_plugin_adaptor;
+  TestMockPlugin *m_plugin;
+  PluginThread *m_thread;
+
+  void RecordThread(PluginThread **thread) {
+    *thread = PluginThread::Current();
+  }
+
+  void CallMainThread(PluginThread **thread) {
+    m_thread->RunInMainThread(
+        NewSingleCallback(this, &PluginThreadTest::RecordThread, thread));
+  }
+
+  bool ReturnTrue() { return true; }
+
+  void Noop() {}
+
+  void SendInput(TestMockInputPort *port, DmxBuffer buffer) {
+    port->WriteDMX(buffer);
+    port->DmxChanged();
+  }
+
+  void Register(ola::AbstractDevice *device, bool *ok) {
+    *ok = m_plugin_adaptor->RegisterDevice(device);
+  }
+
+  void Unregister(ola::AbstractDevice *device, bool *ok) {
+    *ok = m_plugin_adaptor->UnregisterDevice(device);
+  }
+
+  void WaitForInput(const Universe *universe);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PluginThreadTest);
+
+
+void PluginThreadTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_port_manager = new ola::PortManager(m_store, &m_broker);
+  m_device_manager = new DeviceManager(&m_preferences_factory,
+                                       m_port_manager);
+  m_plugin_adaptor = new ola::PluginAdaptor(m_device_manager, &m_ss,
+                                            &m_export_map, NULL, NULL, NULL);
+  m_plugin = new TestMockPlugin(m_plugin_adaptor, ola::OLA_PLUGIN_DUMMY);
+  m_thread = new PluginThread(m_plugin, &m_ss, &m_export_map);
+  OLA_ASSERT_TRUE(m_thread->Start());
+  m_plugin->SetThread(m_thread);
+}
+
+
+void PluginThreadTest::tearDown() {
+  m_thread->Stop();
+  m_plugin->SetThread(NULL);
+  delete m_thread;
+  delete m_plugin;
+  delete m_plugin_adaptor;
+  delete m_device_manager;
+  delete m_port_manager;
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Run the main SelectServer until the universe has data.
+ */
+void PluginThreadTest::WaitForInput(const Universe *universe) {
+  for (unsigned int i = 0; i < 100 && !universe->GetDMX().Size(); i++) {
+    m_ss.RunOnce(ola::TimeInterval(0, 10000));
+  }
+}
+
+
+/*
+ * Check calls run in the right thread.
+ */
+void PluginThreadTest::testCalls() {
+  PluginThread *thread = NULL;
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::RecordThread, &thread));
+  OLA_ASSERT_EQ(m_thread, thread);
+
+  OLA_ASSERT_TRUE(m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::ReturnTrue)));
+
+  // A call back to the main thread, made while the main thread is waiting for
+  // the plugin thread.
+  thread = m_thread;
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::CallMainThread, &thread));
+  OLA_ASSERT_NULL(thread);
+
+  // Calls from the main thread to itself run inline.
+  thread = m_thread;
+  m_thread->RunInMainThread(
+      NewSingleCallback(this, &PluginThreadTest::RecordThread, &thread));
+  OLA_ASSERT_NULL(thread);
+}
+
+
+/*
+ * Check frames for output ports are written in the plugin thread.
+ */
+void PluginThreadTest::testOutput() {
+  MockDevice device(m_plugin, "foo");
+  TestMockOutputPort port(&device, 1);
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  OLA_ASSERT_TRUE(PluginThread::SetUniverse(&port, universe));
+  OLA_ASSERT_EQ(universe, port.GetUniverse());
+  universe->AddPort(&port);
+
+  DmxBuffer buffer;
+  buffer.Set(TEST_DATA);
+  OLA_ASSERT_TRUE(universe->SetDMX(buffer));
+
+  // The frame is queued before the call, so it's been written once the call
+  // returns.
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::Noop));
+  OLA_ASSERT_DMX_EQUALS(buffer, port.ReadDMX());
+
+  universe->RemovePort(&port);
+  OLA_ASSERT_TRUE(PluginThread::SetUniverse(&port, NULL));
+}
+
+
+/*
+ * Check frames from input ports reach the universe in the main thread.
+ */
+void PluginThreadTest::testInput() {
+  MockDevice device(m_plugin, "foo");
+  TestMockInputPort port(&device, 1, m_plugin_adaptor);
+  OLA_ASSERT_TRUE(m_port_manager->PatchPort(&port, TEST_UNIVERSE));
+  Universe *universe = m_store->GetUniverse(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  OLA_ASSERT_EQ(1u, universe->InputPortCount());
+
+  DmxBuffer buffer;
+  buffer.Set(TEST_DATA);
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::SendInput, &port, buffer));
+
+  // The frame is delivered by the main SelectServer.
+  OLA_ASSERT_EQ(0u, universe->GetDMX().Size());
+  WaitForInput(universe);
+  OLA_ASSERT_DMX_EQUALS(buffer, universe->GetDMX());
+
+  OLA_ASSERT_TRUE(m_port_manager->UnPatchPort(&port));
+}
+
+
+/*
+ * Check the plugin can register devices from its own thread.
+ */
+void PluginThreadTest::testRegisterDevice() {
+  MockDevice device(m_plugin, "foo");
+  TestMockInputPort input_port(&device, 1, m_plugin_adaptor);
+  TestMockOutputPort output_port(&device, 1);
+  device.AddPort(&input_port);
+  device.AddPort(&output_port);
+
+  bool ok = false;
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::Register,
+                        static_cast<ola::AbstractDevice*>(&device), &ok));
+  OLA_ASSERT_TRUE(ok);
+  OLA_ASSERT_EQ(1u, m_device_manager->DeviceCount());
+
+  ok = false;
+  m_thread->RunInPluginThread(
+      NewSingleCallback(this, &PluginThreadTest::Unregister,
+                        static_cast<ola::AbstractDevice*>(&device), &ok));
+  OLA_ASSERT_TRUE(ok);
+  OLA_ASSERT_EQ(0u, m_device_manager->DeviceCount());
+}
+
+
+/*
+ * Check descriptions are read in the plugin's thread.
+ */
+void PluginThreadTest::testDescriptions() {
+  DescribedPlugin plugin(m_plugin_adaptor);
+  OLA_ASSERT_EQ(string("main thread"),
+                PluginThread::PluginDescription(&plugin));
+  plugin.SetThread(m_thread);
+  OLA_ASSERT_EQ(string("plugin thread"),
+                PluginThread::PluginDescription(&plugin));
+
+  MockDevice device(&plugin, "foo");
+  DescribedOutputPort port(&device, 1);
+  OLA_ASSERT_EQ(string("plugin thread"), PluginThread::PortDescription(&port));
+  plugin.SetThread(NULL);
+  OLA_ASSERT_EQ(string("main thread"), PluginThread::PortDescription(&port));
+}
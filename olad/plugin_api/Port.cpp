@@ -27,6 +27,7 @@
 #include "ola/rdm/UIDSet.h"
 #include "olad/Device.h"
 #include "olad/Port.h"
+#include "olad/PluginThread.h"
 #include "olad/PortBroker.h"
 
 namespace ola {
@@ -35,6 +36,13 @@ using std::auto_ptr;
 using std::string;
 using std::vector;
 
+namespace {
+void NewUIDList(Universe *universe, OutputPort *port,
+                const ola::rdm::UIDSet *uids) {
+  universe->NewUIDList(port, *uids);
+}
+}  // namespace
+
 BasicInputPort::BasicInputPort(AbstractDevice *parent,
                                unsigned int port_id,
                                const PluginAdaptor *plugin_adaptor,
@@ -81,13 +89,30 @@ bool BasicInputPort::SetPriority(uint8_t priority) {
 }
 
 void BasicInputPort::DmxChanged() {
+  PluginThread *thread = PluginThread::Current();
+  if (!thread && !GetUniverse()) {
+    return;
+  }
+
+  const DmxBuffer &buffer = ReadDMX();
+  uint8_t priority = (PriorityCapability() == CAPABILITY_FULL &&
+                      GetPriorityMode() == PRIORITY_MODE_INHERIT ?
+                      InheritedPriority() :
+                      GetPriority());
+  if (thread) {
+    // The universe belongs to the main thread, it checks if we're patched.
+    thread->QueueInput(this, buffer, priority,
+                       *m_plugin_adaptor->WakeUpTime());
+  } else {
+    UpdateSource(buffer, *m_plugin_adaptor->WakeUpTime(), priority);
+  }
+}
+
+void BasicInputPort::UpdateSource(const DmxBuffer &buffer,
+                                  const TimeStamp &received,
+                                  uint8_t priority) {
   if (GetUniverse()) {
-    const DmxBuffer &buffer = ReadDMX();
-    uint8_t priority = (PriorityCapability() == CAPABILITY_FULL &&
-                        GetPriorityMode() == PRIORITY_MODE_INHERIT ?
-                        InheritedPriority() :
-                        GetPriority());
-    m_dmx_source.UpdateData(buffer, *m_plugin_adaptor->WakeUpTime(), priority);
+    m_dmx_source.UpdateData(buffer, received, priority);
     GetUniverse()->PortDataChanged(this);
   }
 }
@@ -95,7 +120,14 @@ void BasicInputPort::DmxChanged() {
 void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request_ptr,
                                       ola::rdm::RDMCallback *callback) {
   auto_ptr<ola::rdm::RDMRequest> request(request_ptr);
-  if (m_universe) {
+  PluginThread *thread = PluginThread::Current();
+  if (m_universe && thread) {
+    thread->RunInMainThread(NewSingleCallback(
+        m_plugin_adaptor->GetPortBroker(),
+        &PortBrokerInterface::SendRDMRequest,
+        static_cast<const Port*>(this), m_universe, request.release(),
+        thread->PluginThreadCallback(callback)));
+  } else if (m_universe) {
     m_plugin_adaptor->GetPortBroker()->SendRDMRequest(
         this,
         m_universe,
@@ -109,7 +141,12 @@ void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request_ptr,
 void BasicInputPort::TriggerRDMDiscovery(
     ola::rdm::RDMDiscoveryCallback *on_complete,
     bool full) {
-  if (m_universe) {
+  PluginThread *thread = PluginThread::Current();
+  if (m_universe && thread) {
+    thread->RunInMainThread(NewSingleCallback(
+        m_universe, &Universe::RunRDMDiscovery,
+        thread->PluginThreadCallback(on_complete), full));
+  } else if (m_universe) {
     m_universe->RunRDMDiscovery(on_complete, full);
   } else {
     ola::rdm::UIDSet uids;
@@ -128,7 +165,8 @@ BasicOutputPort::BasicOutputPort(AbstractDevice *parent,
     m_port_string(""),
     m_universe(NULL),
     m_device(parent),
-    m_supports_rdm(supports_rdm) {
+    m_supports_rdm(supports_rdm),
+    m_update_filter() {
 }
 
 bool BasicOutputPort::SetUniverse(Universe *new_universe) {
@@ -138,6 +176,8 @@ bool BasicOutputPort::SetUniverse(Universe *new_universe) {
 
   if (PreSetUniverse(old_universe, new_universe)) {
     m_universe = new_universe;
+    // The first frame from the new universe is always sent in full.
+    m_update_filter.Reset();
     PostSetUniverse(old_universe, new_universe);
     if (m_discover_on_patch)
       RunIncrementalDiscovery(
@@ -193,8 +233,17 @@ void BasicOutputPort::RunIncrementalDiscovery(
 
 void BasicOutputPort::UpdateUIDs(const ola::rdm::UIDSet &uids) {
   Universe *universe = GetUniverse();
-  if (universe)
+  if (!universe) {
+    return;
+  }
+
+  PluginThread *thread = PluginThread::Current();
+  if (thread) {
+    thread->RunInMainThread(NewSingleCallback(
+        &NewUIDList, universe, static_cast<OutputPort*>(this), &uids));
+  } else {
     universe->NewUIDList(this, uids);
+  }
 }
 
 template<class PortClass>
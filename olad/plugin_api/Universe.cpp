@@ -28,8 +28,13 @@
  *   A list of source clients. which provide us with data for updating the
  *     DmxBuffer per the merge mode.
  *   A list of sink clients, which we update whenever the DmxBuffer changes.
+ *
+ * Each time the DmxBuffer is updated we work out which slots changed since the
+ * last frame. Ports and clients with a DmxUpdateFilter can use this to skip
+ * identical frames, or to only write the changed slots.
  */
 
+#include <string.h>
 #include <algorithm>
 #include <iterator>
 #include <map>
@@ -46,6 +51,7 @@
 #include "ola/rdm/RDMEnums.h"
 #include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
+#include "olad/PluginThread.h"
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
@@ -66,11 +72,44 @@ using std::set;
 using std::string;
 using std::vector;
 
+namespace {
+/*
+ * The percentiles exported for the latency histograms, the max is exported
+ * separately.
+ */
+const struct {
+  double percentile;
+  const char *universe_var;
+  const char *port_var;
+} LATENCY_PERCENTILES[] = {
+  {50, Universe::K_UNIVERSE_LATENCY_P50_VAR, Universe::K_PORT_LATENCY_P50_VAR},
+  {99, Universe::K_UNIVERSE_LATENCY_P99_VAR, Universe::K_PORT_LATENCY_P99_VAR},
+  {99.9, Universe::K_UNIVERSE_LATENCY_P999_VAR,
+   Universe::K_PORT_LATENCY_P999_VAR},
+};
+
+const unsigned int LATENCY_PUBLISH_INTERVAL_SECONDS = 1;
+}  // namespace
+
 const char Universe::K_UNIVERSE_UID_COUNT_VAR[] = "universe-uids";
 const char Universe::K_FPS_VAR[] = "universe-dmx-frames";
+const char Universe::K_FRAMES_SUPPRESSED_VAR[] =
+    "universe-dmx-frames-suppressed";
+const char Universe::K_FRAMES_SUPPRESSED_PERCENT_VAR[] =
+    "universe-dmx-frames-suppressed-percent";
 const char Universe::K_MERGE_HTP_STR[] = "htp";
 const char Universe::K_MERGE_LTP_STR[] = "ltp";
+const char Universe::K_PORT_LATENCY_P50_VAR[] = "port-latency-p50-us";
+const char Universe::K_PORT_LATENCY_P99_VAR[] = "port-latency-p99-us";
+const char Universe::K_PORT_LATENCY_P999_VAR[] = "port-latency-p99.9-us";
+const char Universe::K_PORT_LATENCY_MAX_VAR[] = "port-latency-max-us";
 const char Universe::K_UNIVERSE_INPUT_PORT_VAR[] = "universe-input-ports";
+const char Universe::K_UNIVERSE_LATENCY_P50_VAR[] = "universe-latency-p50-us";
+const char Universe::K_UNIVERSE_LATENCY_P99_VAR[] = "universe-latency-p99-us";
+const char Universe::K_UNIVERSE_LATENCY_P999_VAR[] =
+    "universe-latency-p99.9-us";
+const char Universe::K_UNIVERSE_LATENCY_MAX_VAR[] = "universe-latency-max-us";
+const char Universe::K_UNIVERSE_MERGES_VAR[] = "universe-merges";
 const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
@@ -81,23 +120,37 @@ const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
 
 /*
  * Create a new universe
- * @param uid  the universe id of this universe
- * @param store the store this universe came from
- * @param export_map the ExportMap that we update
  */
 Universe::Universe(unsigned int universe_id, UniverseStore *store,
                    ExportMap *export_map,
-                   Clock *clock)
+                   Clock *clock,
+                   FrameClock *frame_clock)
     : m_universe_name(""),
       m_universe_id(universe_id),
       m_active_priority(ola::dmx::SOURCE_PRIORITY_MIN),
       m_merge_mode(Universe::MERGE_LTP),
       m_universe_store(store),
       m_export_map(export_map),
+      m_fps_map(NULL),
+      m_fps_handle(CounterMap::INVALID_HANDLE),
+      m_merges_map(NULL),
+      m_merges_handle(CounterMap::INVALID_HANDLE),
+      m_frames_suppressed_var(NULL),
+      m_frames_suppressed_percent_var(NULL),
       m_clock(clock),
       m_rdm_discovery_interval(),
       m_last_discovery_time(),
-      m_transaction_number_sequence() {
+      m_transaction_number_sequence(),
+      m_frame_changed(false),
+      m_first_changed_slot(0),
+      m_changed_slot_count(0),
+      m_frames_sent(0),
+      m_frames_suppressed(0),
+      m_frame_clock(frame_clock),
+      m_output_pending(false),
+      m_pending_changed(false),
+      m_pending_first_slot(0),
+      m_pending_end_slot(0) {
   ostringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -108,7 +161,8 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
   UpdateMode();
 
   const char *vars[] = {
-    K_FPS_VAR,
+    K_FRAMES_SUPPRESSED_VAR,
+    K_FRAMES_SUPPRESSED_PERCENT_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
     K_UNIVERSE_RDM_REQUESTS,
@@ -121,6 +175,16 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     for (unsigned int i = 0; i < arraysize(vars); ++i) {
       (*m_export_map->GetUIntMapVar(vars[i]))[m_universe_id_str] = 0;
     }
+    m_fps_map = m_export_map->GetCounterMapVar(K_FPS_VAR);
+    m_fps_handle = m_fps_map->Register(m_universe_id_str);
+    m_merges_map = m_export_map->GetCounterMapVar(K_UNIVERSE_MERGES_VAR);
+    m_merges_handle = m_merges_map->Register(m_universe_id_str);
+    // The entries aren't removed until the universe is deleted, so the
+    // pointers stay valid.
+    m_frames_suppressed_var = &(*m_export_map->GetUIntMapVar(
+        K_FRAMES_SUPPRESSED_VAR))[m_universe_id_str];
+    m_frames_suppressed_percent_var = &(*m_export_map->GetUIntMapVar(
+        K_FRAMES_SUPPRESSED_PERCENT_VAR))[m_universe_id_str];
   }
 
   // We set the last discovery time to now, since most ports will trigger
@@ -133,13 +197,18 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
  * Delete this universe
  */
 Universe::~Universe() {
+  if (m_output_pending) {
+    m_frame_clock->CancelFrame(this);
+  }
+
   const char *string_vars[] = {
     K_UNIVERSE_NAME_VAR,
     K_UNIVERSE_MODE_VAR,
   };
 
   const char *uint_vars[] = {
-    K_FPS_VAR,
+    K_FRAMES_SUPPRESSED_VAR,
+    K_FRAMES_SUPPRESSED_PERCENT_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
     K_UNIVERSE_RDM_REQUESTS,
@@ -155,6 +224,20 @@ Universe::~Universe() {
     for (unsigned int i = 0; i < arraysize(uint_vars); ++i) {
       m_export_map->GetUIntMapVar(uint_vars[i])->Remove(m_universe_id_str);
     }
+    m_fps_map->Remove(m_universe_id_str);
+    m_merges_map->Remove(m_universe_id_str);
+  }
+
+  while (!m_port_latency.empty()) {
+    RemovePortLatency(m_port_latency.begin()->first);
+  }
+  if (m_export_map) {
+    for (unsigned int i = 0; i < arraysize(LATENCY_PERCENTILES); ++i) {
+      m_export_map->GetUIntMapVar(LATENCY_PERCENTILES[i].universe_var)->Remove(
+          m_universe_id_str);
+    }
+    m_export_map->GetUIntMapVar(K_UNIVERSE_LATENCY_MAX_VAR)->Remove(
+        m_universe_id_str);
   }
 }
 
@@ -170,7 +253,7 @@ void Universe::SetName(const string &name) {
   // notify ports
   vector<OutputPort*>::const_iterator iter;
   for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->UniverseNameChanged(name);
+    PluginThread::UniverseNameChanged(*iter, name);
   }
 }
 
@@ -220,6 +303,7 @@ bool Universe::RemovePort(InputPort *port) {
  */
 bool Universe::RemovePort(OutputPort *port) {
   bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
+  RemovePortLatency(port);
 
   if (m_export_map) {
     (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
@@ -404,6 +488,7 @@ bool Universe::PortDataChanged(InputPort *port) {
     return false;
   }
   if (MergeAll(port, NULL)) {
+    FrameReceived(port->SourceData().Timestamp());
     UpdateDependants();
   }
   return true;
@@ -420,6 +505,7 @@ bool Universe::SourceClientDataChanged(Client *client) {
 
   AddSourceClient(client);   // always add since this may be the first call
   if (MergeAll(NULL, client)) {
+    FrameReceived(client->SourceData(UniverseId()).Timestamp());
     UpdateDependants();
   }
   return true;
@@ -489,13 +575,15 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
          ++port_iter) {
       // because each port deletes the request, we need to copy it here
       if (request->IsDUB()) {
-        (*port_iter)->SendRDMRequest(
+        PluginThread::SendRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this,
                               &Universe::HandleBroadcastDiscovery,
                               tracker));
       } else  {
-        (*port_iter)->SendRDMRequest(
+        PluginThread::SendRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this, &Universe::HandleBroadcastAck, tracker));
       }
@@ -509,7 +597,8 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
                << " in the output universe map, dropping request";
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
     } else {
-      iter->second->SendRDMRequest(request.release(), callback);
+      PluginThread::SendRDMRequest(iter->second, request.release(),
+                                   callback);
     }
   }
 }
@@ -543,19 +632,12 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
   // will trigger, running the DiscoveryCallback.
   vector<OutputPort*>::iterator iter;
   for (iter = output_ports.begin(); iter != output_ports.end(); ++iter) {
-    if (full) {
-      (*iter)->RunFullDiscovery(
-          NewSingleCallback(this,
-                            &Universe::PortDiscoveryComplete,
-                            discovery_complete,
-                            *iter));
-    } else {
-      (*iter)->RunIncrementalDiscovery(
-          NewSingleCallback(this,
-                            &Universe::PortDiscoveryComplete,
-                            discovery_complete,
-                            *iter));
-    }
+    PluginThread::RunDiscovery(
+        *iter, full,
+        NewSingleCallback(this,
+                          &Universe::PortDiscoveryComplete,
+                          discovery_complete,
+                          *iter));
   }
 }
 
@@ -615,6 +697,12 @@ uint8_t Universe::GetRDMTransactionNumber() {
   return m_transaction_number_sequence.Next();
 }
 
+
+const LatencyHistogram *Universe::PortLatency(const OutputPort *port) const {
+  const PortLatencyStats *latency = STLFindOrNull(m_port_latency, port);
+  return latency ? &latency->histogram : NULL;
+}
+
 /*
  * Return true if this universe is in use (has at least one port or client).
  */
@@ -634,26 +722,312 @@ bool Universe::IsActive() const {
  * updates everyone who needs to know (patched ports and network clients)
  */
 bool Universe::UpdateDependants() {
-  vector<OutputPort*>::const_iterator iter;
   set<Client*>::const_iterator client_iter;
+  TimeStamp now;
+  unsigned int suppressed = 0;
 
-  // write to all ports assigned to this universe
-  for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->WriteDMX(m_buffer, m_active_priority);
+  UpdateChangedSlots();
+
+  // write to all ports assigned to this universe, or wait for the next tick
+  // of the frame clock.
+  unsigned int sent = 0;
+  if (m_frame_clock && !m_output_ports.empty()) {
+    QueueOutput();
+  } else {
+    unsigned int port_suppressed = WriteOutputPorts(
+        m_frame_changed, m_first_changed_slot, m_changed_slot_count, &now);
+    sent += m_output_ports.size() - port_suppressed;
+    suppressed += port_suppressed;
   }
 
   // write to all clients
   for (client_iter = m_sink_clients.begin();
        client_iter != m_sink_clients.end();
        ++client_iter) {
-    (*client_iter)->SendDMX(m_universe_id, m_active_priority, m_buffer);
+    Client *client = *client_iter;
+    if (FilterFrame(client->UpdateFilter(m_universe_id), m_frame_changed,
+                    &now) == DmxUpdateFilter::SKIP_FRAME) {
+      suppressed++;
+    } else {
+      client->SendDMX(m_universe_id, m_active_priority, m_buffer);
+      sent++;
+    }
   }
 
-  SafeIncrement(K_FPS_VAR);
+  if (m_fps_map) {
+    m_fps_map->Increment(m_fps_handle);
+  }
+  UpdateSuppressedFrames(sent, suppressed);
   return true;
 }
 
 
+/*
+ * Write the current frame to the output ports.
+ * @returns the number of ports that skipped the frame.
+ */
+unsigned int Universe::WriteOutputPorts(bool changed,
+                                        unsigned int first_slot,
+                                        unsigned int slot_count,
+                                        TimeStamp *now) {
+  unsigned int suppressed = 0;
+  TimeStamp written;
+  vector<OutputPort*>::const_iterator iter;
+  for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
+    OutputPort *port = *iter;
+    switch (FilterFrame(port->UpdateFilter(), changed, now)) {
+      case DmxUpdateFilter::SKIP_FRAME:
+        suppressed++;
+        continue;
+      case DmxUpdateFilter::SEND_CHANGES:
+        PluginThread::WriteDMXChanges(port, m_buffer, first_slot, slot_count,
+                                      m_active_priority);
+        break;
+      case DmxUpdateFilter::SEND_FRAME:
+      default:
+        PluginThread::WriteDMX(port, m_buffer, m_active_priority);
+    }
+    if (m_frame_received.IsSet()) {
+      m_clock->CurrentTime(&written);
+      RecordLatency(port, written);
+    }
+  }
+
+  if (written.IsSet()) {
+    RecordLatency(NULL, written);
+  }
+  m_frame_received = TimeStamp();
+  return suppressed;
+}
+
+
+/*
+ * Record the slots that changed, and ask the frame clock to emit the frame.
+ */
+void Universe::QueueOutput() {
+  if (m_frame_changed) {
+    const unsigned int end = m_first_changed_slot + m_changed_slot_count;
+    if (m_pending_changed) {
+      m_pending_first_slot = std::min(m_pending_first_slot,
+                                      m_first_changed_slot);
+      m_pending_end_slot = std::max(m_pending_end_slot, end);
+    } else {
+      m_pending_first_slot = m_first_changed_slot;
+      m_pending_end_slot = end;
+      m_pending_changed = true;
+    }
+  }
+
+  if (!m_output_pending) {
+    m_output_pending = true;
+    m_frame_clock->RequestFrame(this);
+  }
+}
+
+
+/*
+ * Called on the tick after QueueOutput(), write the latest frame to the
+ * output ports.
+ */
+void Universe::EmitFrame() {
+  m_output_pending = false;
+  TimeStamp now;
+  unsigned int suppressed = WriteOutputPorts(
+      m_pending_changed, m_pending_first_slot,
+      m_pending_end_slot - m_pending_first_slot, &now);
+  m_pending_changed = false;
+  m_pending_first_slot = 0;
+  m_pending_end_slot = 0;
+  UpdateSuppressedFrames(m_output_ports.size() - suppressed, suppressed);
+}
+
+
+/*
+ * Work out which slots differ from the previous frame.
+ */
+void Universe::UpdateChangedSlots() {
+  const unsigned int size = m_buffer.Size();
+  const unsigned int last_size = m_last_frame.Size();
+  const uint8_t *data = m_buffer.GetRaw();
+  const uint8_t *last_data = m_last_frame.GetRaw();
+
+  if (size == last_size &&
+      (size == 0 || data == last_data || !memcmp(data, last_data, size))) {
+    m_frame_changed = false;
+    m_first_changed_slot = 0;
+    m_changed_slot_count = 0;
+    return;
+  }
+
+  const unsigned int common_size = std::min(size, last_size);
+  unsigned int first = 0;
+  while (first < common_size && data[first] == last_data[first]) {
+    first++;
+  }
+
+  // If the size changed, everything after the first change is dirty.
+  unsigned int end = std::max(size, last_size);
+  if (size == last_size) {
+    while (end > first && data[end - 1] == last_data[end - 1]) {
+      end--;
+    }
+  }
+
+  m_frame_changed = true;
+  m_first_changed_slot = first;
+  m_changed_slot_count = end - first;
+
+  // Copy into the storage m_last_frame already owns. Sharing the data would
+  // make the next write to m_buffer allocate new storage.
+  if (size) {
+    m_last_frame.Set(m_buffer);
+  } else {
+    m_last_frame.Reset();
+  }
+}
+
+
+/*
+ * Run a frame through a DmxUpdateFilter.
+ * @param filter the filter, may be NULL.
+ * @param now the current time, this is only fetched if a filter needs it.
+ */
+DmxUpdateFilter::Action Universe::FilterFrame(DmxUpdateFilter *filter,
+                                              bool changed,
+                                              TimeStamp *now) {
+  if (!filter || filter->SendsAllFrames()) {
+    return DmxUpdateFilter::SEND_FRAME;
+  }
+
+  if (!now->IsSet()) {
+    m_clock->CurrentTime(now);
+  }
+  return filter->Filter(changed, *now);
+}
+
+
+/*
+ * Update the suppressed frame counters in the export map.
+ */
+void Universe::UpdateSuppressedFrames(unsigned int sent,
+                                      unsigned int suppressed) {
+  m_frames_sent += sent;
+  m_frames_suppressed += suppressed;
+  // Nothing to report until a port or client opts in to skipping frames.
+  if (!m_frames_suppressed_var || !m_frames_suppressed) {
+    return;
+  }
+
+  *m_frames_suppressed_var = static_cast<unsigned int>(m_frames_suppressed);
+  *m_frames_suppressed_percent_var = static_cast<unsigned int>(
+      m_frames_suppressed * 100 / (m_frames_sent + m_frames_suppressed));
+}
+
+
+/*
+ * Note when the data for the next frame was received, we keep the oldest
+ * time if the frame clock is coalescing updates.
+ */
+void Universe::FrameReceived(const TimeStamp &received) {
+  if (!m_frame_received.IsSet() || received < m_frame_received) {
+    m_frame_received = received;
+  }
+}
+
+
+/*
+ * Record the latency of the current frame.
+ * @param port the port the frame was written to, or NULL once it's been
+ *   written to all ports.
+ * @param now the time the frame was written.
+ */
+void Universe::RecordLatency(const OutputPort *port, const TimeStamp &now) {
+  // The clock may have stepped backwards.
+  int64_t latency = (now - m_frame_received).AsInt();
+  if (latency < 0) {
+    latency = 0;
+  }
+
+  if (port) {
+    PortLatencyStats *port_latency = STLFindOrNull(m_port_latency, port);
+    if (!port_latency) {
+      // The port may be deleted before it's removed from the universe, so
+      // take a copy of the id.
+      port_latency = new PortLatencyStats();
+      port_latency->port_id = port->UniqueId();
+      m_port_latency[port] = port_latency;
+    }
+    port_latency->histogram.Record(static_cast<uint64_t>(latency));
+    return;
+  }
+
+  m_latency.Record(static_cast<uint64_t>(latency));
+  if (m_export_map && now - m_last_latency_publish >=
+      TimeInterval(LATENCY_PUBLISH_INTERVAL_SECONDS, 0)) {
+    PublishLatency(now);
+  }
+}
+
+
+/*
+ * Copy the latency percentiles to the export map, then clear the histograms
+ * so the next values cover just the following interval.
+ */
+void Universe::PublishLatency(const TimeStamp &now) {
+  m_last_latency_publish = now;
+  for (unsigned int i = 0; i < arraysize(LATENCY_PERCENTILES); ++i) {
+    m_export_map->GetUIntMapVar(LATENCY_PERCENTILES[i].universe_var)->Set(
+        m_universe_id_str,
+        static_cast<unsigned int>(
+            m_latency.Percentile(LATENCY_PERCENTILES[i].percentile)));
+  }
+  m_export_map->GetUIntMapVar(K_UNIVERSE_LATENCY_MAX_VAR)->Set(
+      m_universe_id_str, static_cast<unsigned int>(m_latency.Max()));
+  m_latency.Reset();
+
+  PortLatencyMap::const_iterator iter = m_port_latency.begin();
+  for (; iter != m_port_latency.end(); ++iter) {
+    const string &port_id = iter->second->port_id;
+    LatencyHistogram &histogram = iter->second->histogram;
+    if (port_id.empty()) {
+      histogram.Reset();
+      continue;
+    }
+    for (unsigned int i = 0; i < arraysize(LATENCY_PERCENTILES); ++i) {
+      m_export_map->GetUIntMapVar(LATENCY_PERCENTILES[i].port_var)->Set(
+          port_id,
+          static_cast<unsigned int>(
+              histogram.Percentile(LATENCY_PERCENTILES[i].percentile)));
+    }
+    m_export_map->GetUIntMapVar(K_PORT_LATENCY_MAX_VAR)->Set(
+        port_id, static_cast<unsigned int>(histogram.Max()));
+    histogram.Reset();
+  }
+}
+
+
+/*
+ * Remove the latency histogram for a port.
+ */
+void Universe::RemovePortLatency(const OutputPort *port) {
+  PortLatencyMap::iterator iter = m_port_latency.find(port);
+  if (iter == m_port_latency.end()) {
+    return;
+  }
+  const string port_id = iter->second->port_id;
+  delete iter->second;
+  m_port_latency.erase(iter);
+
+  if (m_export_map && !port_id.empty()) {
+    for (unsigned int i = 0; i < arraysize(LATENCY_PERCENTILES); ++i) {
+      m_export_map->GetUIntMapVar(LATENCY_PERCENTILES[i].port_var)->Remove(
+          port_id);
+    }
+    m_export_map->GetUIntMapVar(K_PORT_LATENCY_MAX_VAR)->Remove(port_id);
+  }
+}
+
+
 /*
  * Update the name in the export map.
  */
@@ -684,13 +1058,14 @@ void Universe::UpdateMode() {
  * @pre sources.size >= 2
  * @param sources the list of DmxSources to merge
  */
-void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
-  vector<DmxSource>::const_iterator iter;
-  m_buffer.Reset();
+void Universe::HTPMergeSources(const vector<const DmxSource*> &sources) {
+  vector<const DmxSource*>::const_iterator iter;
+  m_merger.Reset();
 
   for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    m_buffer.HTPMerge(iter->Data());
+    m_merger.AddSource((*iter)->Data());
   }
+  m_merger.Merge(&m_buffer);
 }
 
 
@@ -703,7 +1078,11 @@ void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
  * @returns true if the data for this universe changed, false otherwise
  */
 bool Universe::MergeAll(const InputPort *port, const Client *client) {
-  vector<DmxSource> active_sources;
+  // m_active_sources is reused between calls so that we don't allocate on
+  // every frame. It only holds pointers, the sources are owned by the
+  // ports & clients.
+  vector<const DmxSource*> &active_sources = m_active_sources;
+  active_sources.clear();
 
   vector<InputPort*>::const_iterator iter;
   SourceClientMap::const_iterator client_iter;
@@ -715,7 +1094,7 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
 
   // Find the highest active ports
   for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
-    DmxSource source = (*iter)->SourceData();
+    const DmxSource &source = (*iter)->SourceData();
     if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
       continue;
     }
@@ -727,7 +1106,7 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
     }
 
     if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
+      active_sources.push_back(&source);
       if (*iter == port) {
         changed_source_is_active = true;
       }
@@ -751,7 +1130,7 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
     }
 
     if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
+      active_sources.push_back(&source);
       if (client_iter->first == client) {
         changed_source_is_active = true;
       }
@@ -771,22 +1150,22 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
 
   // only one source at the active priority
   if (active_sources.size() == 1) {
-    m_buffer.Set(active_sources[0].Data());
+    m_buffer.Set(active_sources[0]->Data());
   } else {
     // multi source merge
+    if (m_merges_map) {
+      m_merges_map->Increment(m_merges_handle);
+    }
     if (m_merge_mode == Universe::MERGE_LTP) {
-      vector<DmxSource>::const_iterator source_iter = active_sources.begin();
-      DmxSource changed_source;
-      if (port) {
-        changed_source = port->SourceData();
-      } else {
-        changed_source = client->SourceData(UniverseId());
-      }
+      vector<const DmxSource*>::const_iterator source_iter =
+          active_sources.begin();
+      const DmxSource &changed_source = port ? port->SourceData() :
+          client->SourceData(UniverseId());
 
       // check that the current port/client is newer than all other active
       // sources
       for (; source_iter != active_sources.end(); source_iter++) {
-        if (changed_source.Timestamp() < source_iter->Timestamp()) {
+        if (changed_source.Timestamp() < (*source_iter)->Timestamp()) {
           return false;
         }
       }
@@ -45,16 +45,23 @@ using std::vector;
 const unsigned int UniverseStore::MINIMUM_RDM_DISCOVERY_INTERVAL = 30;
 
 UniverseStore::UniverseStore(Preferences *preferences,
-                             ExportMap *export_map)
+                             ExportMap *export_map,
+                             FrameClock *frame_clock)
     : m_preferences(preferences),
-      m_export_map(export_map) {
+      m_export_map(export_map),
+      m_frame_clock(frame_clock) {
   if (export_map) {
     export_map->GetStringMapVar(Universe::K_UNIVERSE_NAME_VAR, "universe");
     export_map->GetStringMapVar(Universe::K_UNIVERSE_MODE_VAR, "universe");
+    export_map->GetCounterMapVar(Universe::K_FPS_VAR, "universe");
+    export_map->GetCounterMapVar(Universe::K_UNIVERSE_MERGES_VAR, "universe");
 
     const char *vars[] = {
-      Universe::K_FPS_VAR,
       Universe::K_UNIVERSE_INPUT_PORT_VAR,
+      Universe::K_UNIVERSE_LATENCY_P50_VAR,
+      Universe::K_UNIVERSE_LATENCY_P99_VAR,
+      Universe::K_UNIVERSE_LATENCY_P999_VAR,
+      Universe::K_UNIVERSE_LATENCY_MAX_VAR,
       Universe::K_UNIVERSE_OUTPUT_PORT_VAR,
       Universe::K_UNIVERSE_SINK_CLIENTS_VAR,
       Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -64,6 +71,18 @@ UniverseStore::UniverseStore(Preferences *preferences,
     for (unsigned int i = 0; i < sizeof(vars) / sizeof(vars[0]); ++i) {
       export_map->GetUIntMapVar(string(vars[i]), "universe");
     }
+
+    const char *port_vars[] = {
+      Universe::K_PORT_LATENCY_P50_VAR,
+      Universe::K_PORT_LATENCY_P99_VAR,
+      Universe::K_PORT_LATENCY_P999_VAR,
+      Universe::K_PORT_LATENCY_MAX_VAR,
+    };
+
+    for (unsigned int i = 0; i < sizeof(port_vars) / sizeof(port_vars[0]);
+         ++i) {
+      export_map->GetUIntMapVar(string(port_vars[i]), "port");
+    }
   }
 }
 
@@ -80,7 +99,8 @@ Universe *UniverseStore::GetUniverseOrCreate(unsigned int universe_id) {
       &m_universe_map, universe_id);
 
   if (!iter->second) {
-    iter->second = new Universe(universe_id, this, m_export_map, &m_clock);
+    iter->second = new Universe(universe_id, this, m_export_map, &m_clock,
+                                m_frame_clock);
 
     if (iter->second) {
       if (m_preferences) {
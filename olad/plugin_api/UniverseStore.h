@@ -42,8 +42,11 @@ class UniverseStore {
    * @brief Create a new UniverseStore.
    * @param preferences The Preferences store.
    * @param export_map the ExportMap to use for stats, may be NULL.
+   * @param frame_clock the FrameClock the universes send their output on,
+   *   or NULL to send it as soon as new data arrives.
    */
-  UniverseStore(class Preferences *preferences, class ExportMap *export_map);
+  UniverseStore(class Preferences *preferences, class ExportMap *export_map,
+                class FrameClock *frame_clock = NULL);
 
   /**
    * @brief Destructor.
@@ -97,6 +100,7 @@ class UniverseStore {
 
   Preferences *m_preferences;
   ExportMap *m_export_map;
+  FrameClock *m_frame_clock;
   UniverseMap m_universe_map;
   std::set<Universe*> m_deletion_candidates;  // list of universes we may be
                                               // able to delete
@@ -27,11 +27,13 @@
 #include "ola/Constants.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMReply.h"
 #include "ola/rdm/RDMResponseCodes.h"
 #include "ola/rdm/UID.h"
 #include "olad/DmxSource.h"
+#include "olad/DmxUpdateFilter.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
@@ -47,8 +49,10 @@
 using ola::AbstractDevice;
 using ola::Clock;
 using ola::DmxBuffer;
+using ola::DmxUpdateFilter;
 using ola::NewCallback;
 using ola::NewSingleCallback;
+using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::Universe;
 using ola::rdm::NewDiscoveryUniqueBranchRequest;
@@ -76,6 +80,9 @@ class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testSinkClients);
   CPPUNIT_TEST(testLtpMerging);
   CPPUNIT_TEST(testHtpMerging);
+  CPPUNIT_TEST(testChangeTracking);
+  CPPUNIT_TEST(testUpdateFilters);
+  CPPUNIT_TEST(testLatency);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
   CPPUNIT_TEST_SUITE_END();
@@ -91,6 +98,9 @@ class UniverseTest: public CppUnit::TestFixture {
   void testSinkClients();
   void testLtpMerging();
   void testHtpMerging();
+  void testChangeTracking();
+  void testUpdateFilters();
+  void testLatency();
   void testRDMDiscovery();
   void testRDMSend();
 
@@ -135,6 +145,58 @@ class MockClient: public ola::Client {
 };
 
 
+/*
+ * An output port that counts the writes it receives.
+ */
+class CountingOutputPort: public TestMockOutputPort {
+ public:
+  CountingOutputPort(ola::AbstractDevice *parent, unsigned int port_id)
+      : TestMockOutputPort(parent, port_id),
+        frames(0),
+        changes(0),
+        first_slot(0),
+        slot_count(0) {
+  }
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
+    frames++;
+    return TestMockOutputPort::WriteDMX(buffer, priority);
+  }
+
+  bool WriteDMXChanges(const DmxBuffer &buffer, unsigned int first_slot,
+                       unsigned int slot_count, uint8_t priority) {
+    changes++;
+    this->first_slot = first_slot;
+    this->slot_count = slot_count;
+    return TestMockOutputPort::WriteDMX(buffer, priority);
+  }
+
+  unsigned int frames;
+  unsigned int changes;
+  unsigned int first_slot;
+  unsigned int slot_count;
+};
+
+
+/*
+ * A sink client that counts the frames it receives.
+ */
+class CountingClient: public ola::Client {
+ public:
+  CountingClient()
+      : ola::Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)),
+        frames(0) {
+  }
+
+  bool SendDMX(unsigned int, uint8_t, const DmxBuffer &) {
+    frames++;
+    return true;
+  }
+
+  unsigned int frames;
+};
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(UniverseTest);
 
 
@@ -521,6 +583,230 @@ void UniverseTest::testHtpMerging() {
 }
 
 
+/*
+ * Check that the universe tracks which slots changed between frames.
+ */
+void UniverseTest::testChangeTracking() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_FALSE(universe->FrameChanged());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(0u, universe->FirstChangedSlot());
+  OLA_ASSERT_EQ(4u, universe->ChangedSlotCount());
+
+  // the same frame again
+  universe->SetDMX(buffer);
+  OLA_ASSERT_FALSE(universe->FrameChanged());
+  OLA_ASSERT_EQ(0u, universe->ChangedSlotCount());
+
+  // a change in the middle
+  buffer.SetFromString("1,2,9,4");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(2u, universe->FirstChangedSlot());
+  OLA_ASSERT_EQ(1u, universe->ChangedSlotCount());
+
+  // two changes, the range covers both
+  buffer.SetFromString("0,2,9,5");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_EQ(0u, universe->FirstChangedSlot());
+  OLA_ASSERT_EQ(4u, universe->ChangedSlotCount());
+
+  // growing the frame
+  buffer.SetFromString("0,2,9,5,0");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(4u, universe->FirstChangedSlot());
+  OLA_ASSERT_EQ(1u, universe->ChangedSlotCount());
+
+  // shrinking the frame
+  buffer.SetFromString("0,2");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(2u, universe->FirstChangedSlot());
+  OLA_ASSERT_EQ(3u, universe->ChangedSlotCount());
+
+  // keeping the last frame doesn't make changed frames reallocate
+  const uint8_t *storage = universe->GetDMX().GetRaw();
+  buffer.SetFromString("7,2");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(storage, universe->GetDMX().GetRaw());
+  buffer.SetFromString("7,8");
+  universe->SetDMX(buffer);
+  OLA_ASSERT_TRUE(universe->FrameChanged());
+  OLA_ASSERT_EQ(storage, universe->GetDMX().GetRaw());
+}
+
+
+/*
+ * Check that ports and clients can opt in to skipping unchanged frames.
+ */
+void UniverseTest::testUpdateFilters() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(m_preferences, &export_map);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  const TimeInterval keep_alive(3600, 0);
+  CountingOutputPort port(NULL, 1);  // sends everything
+  CountingOutputPort skipping_port(NULL, 2);
+  skipping_port.UpdateFilter()->SetMode(
+      DmxUpdateFilter::SKIP_UNCHANGED_FRAMES);
+  skipping_port.UpdateFilter()->SetKeepAliveInterval(keep_alive);
+  CountingOutputPort delta_port(NULL, 3);
+  delta_port.UpdateFilter()->SetMode(DmxUpdateFilter::SEND_CHANGED_SLOTS);
+  delta_port.UpdateFilter()->SetKeepAliveInterval(keep_alive);
+  universe->AddPort(&port);
+  universe->AddPort(&skipping_port);
+  universe->AddPort(&delta_port);
+
+  CountingClient client, skipping_client;
+  skipping_client.SetUpdateMode(TEST_UNIVERSE,
+                                DmxUpdateFilter::SKIP_UNCHANGED_FRAMES,
+                                keep_alive);
+  OLA_ASSERT_NOT_NULL(skipping_client.UpdateFilter(TEST_UNIVERSE));
+  OLA_ASSERT_NULL(client.UpdateFilter(TEST_UNIVERSE));
+  universe->AddSinkClient(&client);
+  universe->AddSinkClient(&skipping_client);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  universe->SetDMX(buffer);
+  universe->SetDMX(buffer);
+  universe->SetDMX(buffer);
+
+  OLA_ASSERT_EQ(3u, port.frames);
+  OLA_ASSERT_EQ(1u, skipping_port.frames);
+  OLA_ASSERT_EQ(1u, delta_port.frames);
+  OLA_ASSERT_EQ(0u, delta_port.changes);
+  OLA_ASSERT_EQ(3u, client.frames);
+  OLA_ASSERT_EQ(1u, skipping_client.frames);
+
+  buffer.SetChannel(2, 100);
+  universe->SetDMX(buffer);
+  OLA_ASSERT_EQ(4u, port.frames);
+  OLA_ASSERT_EQ(2u, skipping_port.frames);
+  OLA_ASSERT_EQ(1u, delta_port.frames);
+  OLA_ASSERT_EQ(1u, delta_port.changes);
+  OLA_ASSERT_EQ(2u, delta_port.first_slot);
+  OLA_ASSERT_EQ(1u, delta_port.slot_count);
+  OLA_ASSERT_DMX_EQUALS(buffer, delta_port.ReadDMX());
+  OLA_ASSERT_EQ(2u, skipping_client.frames);
+
+  // 6 of the 20 writes so far were skipped
+  ola::UIntMap *suppressed = export_map.GetUIntMapVar(
+      Universe::K_FRAMES_SUPPRESSED_VAR);
+  ola::UIntMap *percent = export_map.GetUIntMapVar(
+      Universe::K_FRAMES_SUPPRESSED_PERCENT_VAR);
+  OLA_ASSERT_EQ(6u, (*suppressed)["1"]);
+  OLA_ASSERT_EQ(30u, (*percent)["1"]);
+
+  // Opting out sends every frame again
+  skipping_client.SetUpdateMode(TEST_UNIVERSE,
+                                DmxUpdateFilter::SEND_ALL_FRAMES,
+                                keep_alive);
+  OLA_ASSERT_NULL(skipping_client.UpdateFilter(TEST_UNIVERSE));
+  universe->SetDMX(buffer);
+  OLA_ASSERT_EQ(3u, skipping_client.frames);
+
+  universe->RemoveSinkClient(&client);
+  universe->RemoveSinkClient(&skipping_client);
+  universe->RemovePort(&port);
+  universe->RemovePort(&skipping_port);
+  universe->RemovePort(&delta_port);
+}
+
+
+/*
+ * Check the latency from a port receiving a frame to it being written is
+ * recorded.
+ */
+void UniverseTest::testLatency() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(NULL, &export_map);
+  ola::MockClock clock;
+  Universe universe(TEST_UNIVERSE, &store, &export_map, &clock);
+
+  TimeStamp wake_up;
+  MockSelectServer ss(&wake_up);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  TestMockInputPort input_port(&device, 1, &plugin_adaptor);
+  TestMockOutputPort output_port(&device, 1);
+  input_port.SetUniverse(&universe);
+  universe.AddPort(&input_port);
+  universe.AddPort(&output_port);
+  OLA_ASSERT_NULL(universe.PortLatency(&output_port));
+
+  // The frame arrives, and is written at least 250us later. The MockClock
+  // follows the real time, so allow some slack.
+  const uint64_t slack = 100000;
+  clock.CurrentTime(&wake_up);
+  clock.AdvanceTime(0, 250);
+  input_port.WriteDMX(m_buffer);
+  input_port.DmxChanged();
+  OLA_ASSERT_DMX_EQUALS(m_buffer, output_port.ReadDMX());
+
+  // The first frame is published straight away, which clears the
+  // histograms.
+  ola::UIntMap *max_var = export_map.GetUIntMapVar(
+      Universe::K_UNIVERSE_LATENCY_MAX_VAR);
+  ola::UIntMap *p99_var = export_map.GetUIntMapVar(
+      Universe::K_UNIVERSE_LATENCY_P99_VAR);
+  ola::UIntMap *port_max_var = export_map.GetUIntMapVar(
+      Universe::K_PORT_LATENCY_MAX_VAR);
+  const uint64_t first_latency = (*max_var)["1"];
+  OLA_ASSERT_TRUE(first_latency >= 250);
+  OLA_ASSERT_TRUE(first_latency < 250 + slack);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(first_latency), (*p99_var)["1"]);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), universe.Latency().Count());
+  const ola::LatencyHistogram *port_latency = universe.PortLatency(
+      &output_port);
+  OLA_ASSERT_NOT_NULL(port_latency);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), port_latency->Count());
+  const string port_id = output_port.UniqueId();
+  OLA_ASSERT_TRUE((*port_max_var)[port_id] >= 250);
+  OLA_ASSERT_TRUE((*port_max_var)[port_id] <= first_latency);
+
+  // Data that didn't come from a port or client isn't timed.
+  universe.SetDMX(m_buffer);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), universe.Latency().Count());
+
+  // The export map is updated once a second.
+  clock.CurrentTime(&wake_up);
+  clock.AdvanceTime(0, 200000);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), universe.Latency().Count());
+  const uint64_t second_latency = universe.Latency().Max();
+  OLA_ASSERT_TRUE(second_latency >= 200000);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), port_latency->Count());
+  OLA_ASSERT_EQ(static_cast<unsigned int>(first_latency), (*max_var)["1"]);
+
+  clock.AdvanceTime(1, 0);
+  clock.CurrentTime(&wake_up);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), universe.Latency().Count());
+  OLA_ASSERT_EQ(static_cast<unsigned int>(second_latency), (*max_var)["1"]);
+
+  // The next interval doesn't include the slow frame.
+  clock.AdvanceTime(1, 0);
+  clock.CurrentTime(&wake_up);
+  input_port.DmxChanged();
+  OLA_ASSERT_TRUE((*max_var)["1"] < second_latency);
+  OLA_ASSERT_TRUE((*port_max_var)[port_id] < second_latency);
+
+  universe.RemovePort(&output_port);
+  OLA_ASSERT_NULL(universe.PortLatency(&output_port));
+  universe.RemovePort(&input_port);
+  input_port.SetUniverse(NULL);
+}
+
+
 /**
  * Test RDM discovery for a universe/
  */
@@ -64,6 +64,7 @@ const char ArtNetDevice::K_LONG_NAME_KEY[] = "long_name";
 const char ArtNetDevice::K_LOOPBACK_KEY[] = "use_loopback";
 const char ArtNetDevice::K_NET_KEY[] = "net";
 const char ArtNetDevice::K_OUTPUT_PORT_KEY[] = "output_ports";
+const char ArtNetDevice::K_SEND_SYNC_KEY[] = "send_sync";
 const char ArtNetDevice::K_SHORT_NAME_KEY[] = "short_name";
 const char ArtNetDevice::K_SUBNET_KEY[] = "subnet";
 const unsigned int ArtNetDevice::K_ARTNET_NET = 0;
@@ -108,6 +109,9 @@ bool ArtNetDevice::StartHook() {
   node_options.input_port_count = StringToIntOrDefault(
       m_preferences->GetValue(K_OUTPUT_PORT_KEY),
       K_DEFAULT_OUTPUT_PORT_COUNT);
+  // Universes are usually updated together, so send their packets together.
+  node_options.batch_sends = true;
+  node_options.send_sync = m_preferences->GetValueAsBool(K_SEND_SYNC_KEY);
 
   m_node = new ArtNetNode(iface, m_plugin_adaptor, node_options);
   m_node->SetNetAddress(net);
@@ -51,8 +51,10 @@ using ola::network::HostToLittleEndian;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
+using ola::network::IncomingDatagram;
 using ola::network::LittleEndianToHost;
 using ola::network::NetworkToHost;
+using ola::network::UDPSendQueue;
 using ola::network::UDPSocket;
 using ola::rdm::RDMCallback;
 using ola::rdm::RDMCommand;
@@ -207,16 +209,24 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
       m_ss(ss),
       m_always_broadcast(options.always_broadcast),
       m_use_limited_broadcast_address(options.use_limited_broadcast_address),
+      m_send_sync(options.send_sync),
+      m_sync_required(false),
       m_in_configuration_mode(false),
       m_artpoll_required(false),
       m_artpollreply_required(false),
       m_interface(iface),
-      m_socket(socket) {
+      m_socket(socket),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
 
   if (!m_socket.get()) {
     m_socket.reset(new UDPSocket());
   }
 
+  if (options.batch_sends) {
+    m_send_queue.reset(new UDPSendQueue(m_socket.get(),
+                                        sizeof(artnet_packet)));
+  }
+
   for (unsigned int i = 0; i < options.input_port_count; i++) {
     m_input_ports.push_back(new InputPort());
   }
@@ -227,6 +237,9 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
     m_output_ports[i].sequence_number = 0;
     m_output_ports[i].enabled = false;
     m_output_ports[i].is_merging = false;
+    m_output_ports[i].sync_pending = false;
+    m_output_ports[i].sync_source = IPV4Address();
+    m_output_ports[i].last_sync = TimeStamp();
     m_output_ports[i].merge_mode = ARTNET_MERGE_HTP;
     m_output_ports[i].buffer = NULL;
     m_output_ports[i].on_data = NULL;
@@ -239,6 +252,10 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
 ArtNetNodeImpl::~ArtNetNodeImpl() {
   Stop();
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+  }
+
   STLDeleteElements(&m_input_ports);
 
   for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
@@ -302,6 +319,11 @@ bool ArtNetNodeImpl::Stop() {
     }
   }
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    FlushSendQueue();
+  }
+
   m_ss->RemoveReadDescriptor(m_socket.get());
 
   m_running = false;
@@ -596,6 +618,13 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
 
   if (!sent_ok) {
     OLA_WARN << "Failed to send Art-Net DMX packet";
+  } else if (m_send_sync) {
+    // The ArtSync is sent after the DMX for all the ports.
+    m_sync_required = true;
+    if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+      m_flush_timeout = m_ss->RegisterSingleTimeout(
+          0, NewSingleCallback(this, &ArtNetNodeImpl::FlushSendQueue));
+    }
   }
   return sent_ok;
 }
@@ -851,17 +880,34 @@ bool ArtNetNodeImpl::SendTimeCode(const ola::timecode::TimeCode &timecode) {
 }
 
 void ArtNetNodeImpl::SocketReady() {
-  artnet_packet packet;
-  ssize_t packet_size = sizeof(packet);
-  ola::network::IPV4SocketAddress source;
+  if (m_receive_datagrams.empty()) {
+    m_receive_packets.resize(RECEIVE_BATCH_SIZE);
+    m_receive_datagrams.resize(RECEIVE_BATCH_SIZE);
+    for (unsigned int i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+      m_receive_datagrams[i].buffer =
+          reinterpret_cast<uint8_t*>(&m_receive_packets[i]);
+      m_receive_datagrams[i].buffer_size = sizeof(artnet_packet);
+    }
+  }
 
-  if (!m_socket->RecvFrom(reinterpret_cast<uint8_t*>(&packet),
-                          &packet_size,
-                          &source)) {
-    return;
+  unsigned int count = m_socket->RecvBatch(
+      &m_receive_datagrams[0],
+      static_cast<unsigned int>(m_receive_datagrams.size()));
+  for (unsigned int i = 0; i < count; i++) {
+    const IncomingDatagram &datagram = m_receive_datagrams[i];
+    HandlePacket(datagram.source.Host(), m_receive_packets[i], datagram.size);
   }
+}
 
-  HandlePacket(source.Host(), packet, packet_size);
+void ArtNetNodeImpl::FlushSendQueue() {
+  if (m_sync_required) {
+    m_sync_required = false;
+    SendSync();
+  }
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  if (m_send_queue.get()) {
+    m_send_queue->Flush();
+  }
 }
 
 bool ArtNetNodeImpl::SendPollIfAllowed() {
@@ -1004,8 +1050,9 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
                       packet_size - header_size);
       break;
     case ARTNET_SYNC:
-      // TODO(Someone): Implement me, not currently implemented.
-      OLA_DEBUG << "ArtSync input not currently supported";
+      HandleSync(source_address,
+                 packet.data.sync,
+                 packet_size - header_size);
       break;
     case ARTNET_RDM_SUB:
       // TODO(Someone): Implement me, not currently implemented.
@@ -1444,6 +1491,53 @@ void ArtNetNodeImpl::HandleIPProgram(const IPV4Address &source_address,
            << "configuration";
 }
 
+void ArtNetNodeImpl::HandleSync(const IPV4Address &source_address,
+                                const artnet_sync_t &packet,
+                                unsigned int packet_size) {
+  if (!CheckPacketSize(source_address, "ArtSync", packet_size,
+                       sizeof(packet))) {
+    return;
+  }
+
+  if (!CheckPacketVersion(source_address, "ArtSync", packet.version)) {
+    return;
+  }
+
+  // The spec says to ignore an ArtSync from a different IP to the ArtDmx.
+  for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
+    OutputPort *port = &m_output_ports[port_id];
+    if (port->sync_source.IsWildcard() ||
+        port->sync_source != source_address) {
+      continue;
+    }
+    port->last_sync = *m_ss->WakeUpTime();
+    if (port->sync_pending) {
+      port->sync_pending = false;
+      if (port->on_data) {
+        port->on_data->Run();
+      }
+    }
+  }
+}
+
+bool ArtNetNodeImpl::SendSync() {
+  artnet_packet packet;
+  PopulatePacketHeader(&packet, ARTNET_SYNC);
+  memset(&packet.data.sync, 0, sizeof(packet.data.sync));
+  packet.data.sync.version = HostToNetwork(ARTNET_VERSION);
+
+  bool sent_ok = SendPacket(
+      packet,
+      sizeof(packet.data.sync),
+      m_use_limited_broadcast_address ?
+      IPV4Address::Broadcast() :
+      m_interface.bcast_address);
+  if (!sent_ok) {
+    OLA_WARN << "Failed to send ArtSync";
+  }
+  return sent_ok;
+}
+
 void ArtNetNodeImpl::PopulatePacketHeader(artnet_packet *packet,
                                           uint16_t op_code) {
   CopyToFixedLengthBuffer(ARTNET_ID, reinterpret_cast<char*>(packet->id),
@@ -1455,6 +1549,15 @@ bool ArtNetNodeImpl::SendPacket(const artnet_packet &packet,
                                 unsigned int size,
                                 const IPV4Address &ip_destination) {
   size += sizeof(packet.id) + sizeof(packet.op_code);
+  if (m_send_queue.get()) {
+    if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+      m_flush_timeout = m_ss->RegisterSingleTimeout(
+          0, NewSingleCallback(this, &ArtNetNodeImpl::FlushSendQueue));
+    }
+    return m_send_queue->Add(reinterpret_cast<const uint8_t*>(&packet), size,
+                             IPV4SocketAddress(ip_destination, ARTNET_PORT));
+  }
+
   unsigned int bytes_sent = m_socket->SendTo(
       reinterpret_cast<const uint8_t*>(&packet),
       size,
@@ -1569,7 +1672,22 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
       }
     }
   }
-  port->on_data->Run();
+
+  // A new source has to send its own ArtSyncs before we hold its data.
+  if (port->sync_source != source.address) {
+    port->sync_source = source.address;
+    port->last_sync = TimeStamp();
+  }
+
+  // While we're receiving ArtSyncs, hold the data until the next one. The
+  // spec says to ignore ArtSync while merging.
+  if (!port->is_merging && port->last_sync.IsSet() &&
+      *m_ss->WakeUpTime() - port->last_sync < TimeInterval(SYNC_TIMEOUT, 0)) {
+    port->sync_pending = true;
+  } else {
+    port->sync_pending = false;
+    port->on_data->Run();
+  }
 }
 
 bool ArtNetNodeImpl::CheckPacketVersion(const IPV4Address &source_address,
@@ -34,6 +34,7 @@
 #include "ola/network/Interface.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/Socket.h"
+#include "ola/network/UDPSendQueue.h"
 #include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMFrame.h"
@@ -69,7 +70,9 @@ class ArtNetNodeOptions {
         use_limited_broadcast_address(false),
         rdm_queue_size(20),
         broadcast_threshold(30),
-        input_port_count(4) {
+        input_port_count(4),
+        batch_sends(false),
+        send_sync(false) {
   }
 
   bool always_broadcast;
@@ -77,6 +80,12 @@ class ArtNetNodeOptions {
   unsigned int rdm_queue_size;
   unsigned int broadcast_threshold;
   uint8_t input_port_count;
+  // Queue packets and send them together once the current event has been
+  // handled, rather than sending each one immediately.
+  bool batch_sends;
+  // Broadcast an ArtSync once the DMX for the current event has been sent, so
+  // the receivers output all the universes together.
+  bool send_sync;
 };
 
 
@@ -376,6 +385,11 @@ class ArtNetNodeImpl {
     bool enabled;
     artnet_merge_mode merge_mode;
     bool is_merging;
+    bool sync_pending;  // new data is waiting for an ArtSync
+    // Only ArtSyncs from the source of the ArtDmx count. We stay in
+    // synchronous mode while they keep arriving.
+    ola::network::IPV4Address sync_source;
+    TimeStamp last_sync;
     DMXSource sources[MAX_MERGE_SOURCES];
     DmxBuffer *buffer;
     std::map<ola::rdm::UID, ola::network::IPV4Address> uid_map;
@@ -397,6 +411,8 @@ class ArtNetNodeImpl {
   ola::io::SelectServerInterface *m_ss;
   bool m_always_broadcast;
   bool m_use_limited_broadcast_address;
+  bool m_send_sync;
+  bool m_sync_required;
 
   // The following keep track of "Configuration mode"
   bool m_in_configuration_mode;
@@ -407,12 +423,21 @@ class ArtNetNodeImpl {
   OutputPort m_output_ports[ARTNET_MAX_PORTS];
   ola::network::Interface m_interface;
   std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+  std::auto_ptr<ola::network::UDPSendQueue> m_send_queue;
+  ola::thread::timeout_id m_flush_timeout;
+  std::vector<artnet_packet> m_receive_packets;
+  std::vector<ola::network::IncomingDatagram> m_receive_datagrams;
 
   /**
    * @brief Called when there is data on this socket
    */
   void SocketReady();
 
+  /**
+   * @brief Send the packets queued by SendPacket().
+   */
+  void FlushSendQueue();
+
   /**
    * @brief Send an ArtPoll if we're both running and not in configuration mode.
    *
@@ -524,6 +549,18 @@ class ArtNetNodeImpl {
                        const artnet_ip_prog_t &packet,
                        unsigned int packet_size);
 
+  /**
+   * @brief Handle an ArtSync message.
+   */
+  void HandleSync(const ola::network::IPV4Address &source_address,
+                  const artnet_sync_t &packet,
+                  unsigned int packet_size);
+
+  /**
+   * @brief Broadcast an ArtSync.
+   */
+  bool SendSync();
+
   /**
    * @brief Fill in the header for a packet
    */
@@ -643,6 +680,9 @@ class ArtNetNodeImpl {
   static const unsigned int MERGE_TIMEOUT = 10;  // As per the spec
   // seconds after which a node is marked as inactive for the dmx merging
   static const unsigned int NODE_TIMEOUT = 31;
+  // seconds without an ArtSync before we go back to outputting data as it
+  // arrives, as per the spec
+  static const unsigned int SYNC_TIMEOUT = 4;
   // mseconds we wait for a TodData packet before declaring a node missing
   static const unsigned int RDM_TOD_TIMEOUT_MS = 4000;
   // Number of missed TODs before we decide a UID has gone
@@ -652,6 +692,8 @@ class ArtNetNodeImpl {
   static const unsigned int RDM_REQUEST_QUEUE_LIMIT = 100;
   // How long to wait for a response to an RDM Request
   static const unsigned int RDM_REQUEST_TIMEOUT_MS = 2000;
+  // The most packets we'll read each time the socket is readable.
+  static const unsigned int RECEIVE_BATCH_SIZE = 32;
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNodeImpl);
 };
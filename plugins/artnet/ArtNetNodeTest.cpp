@@ -75,10 +75,14 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testExtendedInputPorts);
   CPPUNIT_TEST(testBroadcastSendDMX);
   CPPUNIT_TEST(testBroadcastSendDMXZeroUniverse);
+  CPPUNIT_TEST(testBatchedSendDMX);
+  CPPUNIT_TEST(testSendSync);
   CPPUNIT_TEST(testLimitedBroadcastDMX);
   CPPUNIT_TEST(testNonBroadcastSendDMX);
   CPPUNIT_TEST(testReceiveDMX);
   CPPUNIT_TEST(testReceiveDMXZeroUniverse);
+  CPPUNIT_TEST(testReceiveSync);
+  CPPUNIT_TEST(testReceiveSyncMultipleSources);
   CPPUNIT_TEST(testHTPMerge);
   CPPUNIT_TEST(testLTPMerge);
   CPPUNIT_TEST(testControllerDiscovery);
@@ -116,10 +120,14 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   void testExtendedInputPorts();
   void testBroadcastSendDMX();
   void testBroadcastSendDMXZeroUniverse();
+  void testBatchedSendDMX();
+  void testSendSync();
   void testLimitedBroadcastDMX();
   void testNonBroadcastSendDMX();
   void testReceiveDMX();
   void testReceiveDMXZeroUniverse();
+  void testReceiveSync();
+  void testReceiveSyncMultipleSources();
   void testHTPMerge();
   void testLTPMerge();
   void testControllerDiscovery();
@@ -697,6 +705,172 @@ void ArtNetNodeTest::testBroadcastSendDMX() {
   }
 }
 
+/**
+ * Check batched sends are held until the end of the loop iteration.
+ */
+void ArtNetNodeTest::testBatchedSendDMX() {
+  m_socket->SetDiscardMode(true);
+
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  node_options.batch_sends = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  ss.RunOnce();
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+  const uint8_t DMX_MESSAGE2[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    1,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 4,  // dmx length
+    9, 8, 7, 6
+  };
+
+  DmxBuffer dmx;
+  {
+    SocketVerifier verifer(m_socket);
+    dmx.SetFromString("0,1,2,3,4,5");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    dmx.SetFromString("9,8,7,6");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+  }
+
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(DMX_MESSAGE, sizeof(DMX_MESSAGE));
+    ExpectedBroadcast(DMX_MESSAGE2, sizeof(DMX_MESSAGE2));
+    ss.RunOnce();
+  }
+
+  // Stopping the node sends anything that's queued
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t DMX_MESSAGE3[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      2,  // seq #
+      1,  // physical port
+      0x23, 4,  // subnet & net address
+      0, 2,  // dmx length
+      1, 0
+    };
+    ExpectedBroadcast(DMX_MESSAGE3, sizeof(DMX_MESSAGE3));
+    dmx.SetFromString("1");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    OLA_ASSERT(node.Stop());
+  }
+}
+
+/**
+ * Check an ArtSync is broadcast after the DMX data.
+ */
+void ArtNetNodeTest::testSendSync() {
+  m_socket->SetDiscardMode(true);
+
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  node_options.batch_sends = true;
+  node_options.send_sync = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  ss.RunOnce();
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+  const uint8_t DMX_MESSAGE2[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    1,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 2,  // dmx length
+    1, 0
+  };
+  const uint8_t SYNC_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x52,
+    0x0, 14,
+    0, 0  // aux1 & aux2
+  };
+
+  // One ArtSync follows all the DMX sent during the event.
+  DmxBuffer dmx;
+  {
+    SocketVerifier verifer(m_socket);
+    dmx.SetFromString("0,1,2,3,4,5");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    dmx.SetFromString("1");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+  }
+
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(DMX_MESSAGE, sizeof(DMX_MESSAGE));
+    ExpectedBroadcast(DMX_MESSAGE2, sizeof(DMX_MESSAGE2));
+    ExpectedBroadcast(SYNC_MESSAGE, sizeof(SYNC_MESSAGE));
+    ss.RunOnce();
+  }
+
+  // Nothing is sent if there's no new data.
+  {
+    SocketVerifier verifer(m_socket);
+    ss.RunOnce();
+  }
+
+  // Stopping the node sends the pending ArtSync.
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t DMX_MESSAGE3[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      2,  // seq #
+      1,  // physical port
+      0x23, 4,  // subnet & net address
+      0, 2,  // dmx length
+      2, 0
+    };
+    ExpectedBroadcast(DMX_MESSAGE3, sizeof(DMX_MESSAGE3));
+    ExpectedBroadcast(SYNC_MESSAGE, sizeof(SYNC_MESSAGE));
+    dmx.SetFromString("2");
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    OLA_ASSERT(node.Stop());
+  }
+}
+
 /**
  * Check sending DMX using broadcast works to Art-Net universe 0.
  */
@@ -1093,6 +1267,184 @@ void ArtNetNodeTest::testReceiveDMX() {
   }
 }
 
+/**
+ * Check received DMX is held until the next ArtSync.
+ */
+void ArtNetNodeTest::testReceiveSync() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupOutputPort(&node);
+  DmxBuffer input_buffer;
+  node.SetDMXHandler(m_port_id,
+                     &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+  const uint8_t SYNC_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x52,
+    0x0, 14,
+    0, 0  // aux1 & aux2
+  };
+
+  // Until we get an ArtSync, the data is used as it arrives.
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+
+    m_got_dmx = false;
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+  }
+
+  // Now the data waits for the next ArtSync.
+  {
+    SocketVerifier verifer(m_socket);
+    DMX_MESSAGE[12] = 1;
+    DMX_MESSAGE[18] = 10;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("10,1,2,3,4,5"), input_buffer.ToString());
+  }
+
+  // If the ArtSyncs stop, we go back to using the data as it arrives.
+  {
+    SocketVerifier verifer(m_socket);
+    m_clock.AdvanceTime(5, 0);
+    DMX_MESSAGE[12] = 2;
+    DMX_MESSAGE[18] = 20;
+    m_got_dmx = false;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("20,1,2,3,4,5"), input_buffer.ToString());
+  }
+}
+
+/**
+ * Check an ArtSync only holds and releases data from the same IP.
+ */
+void ArtNetNodeTest::testReceiveSyncMultipleSources() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupOutputPort(&node);
+  node.SetOutputPortUniverse(2, 4);
+  DmxBuffer input_buffer, input_buffer2;
+  node.SetDMXHandler(m_port_id,
+                     &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+  node.SetDMXHandler(2,
+                     &input_buffer2,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+  uint8_t DMX_MESSAGE2[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    2,  // physical port
+    0x24, 4,  // subnet & net address
+    0, 6,  // dmx length
+    5, 4, 3, 2, 1, 0
+  };
+  const uint8_t SYNC_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x52,
+    0x0, 14,
+    0, 0  // aux1 & aux2
+  };
+
+  // The first source starts sending ArtSyncs.
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+
+    m_got_dmx = false;
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+  }
+
+  // Data from the second source, which doesn't sync, isn't held.
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE2, sizeof(DMX_MESSAGE2), peer_ip2);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("5,4,3,2,1,0"), input_buffer2.ToString());
+  }
+
+  // An ArtSync from the second source doesn't release the first source's data
+  {
+    SocketVerifier verifer(m_socket);
+    m_got_dmx = false;
+    DMX_MESSAGE[12] = 1;
+    DMX_MESSAGE[18] = 10;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip2);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("10,1,2,3,4,5"), input_buffer.ToString());
+  }
+
+  // The second source has now sent an ArtSync, so its data is held until the
+  // next one from the same IP.
+  {
+    SocketVerifier verifer(m_socket);
+    m_got_dmx = false;
+    DMX_MESSAGE2[12] = 1;
+    DMX_MESSAGE2[18] = 20;
+    ReceiveFromPeer(DMX_MESSAGE2, sizeof(DMX_MESSAGE2), peer_ip2);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip2);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("20,4,3,2,1,0"), input_buffer2.ToString());
+  }
+}
+
 /**
  * Check that receiving DMX for universe 0 works.
  */
@@ -248,6 +248,15 @@ struct artnet_ip_reply_s {
 
 typedef struct artnet_ip_reply_s artnet_ip_reply_t;
 
+PACK(
+struct artnet_sync_s {
+  uint16_t version;
+  uint8_t aux1;
+  uint8_t aux2;
+});
+
+typedef struct artnet_sync_s artnet_sync_t;
+
 // union of all Art-Net packets
 typedef struct {
   uint8_t id[8];
@@ -263,6 +272,7 @@ typedef struct {
     artnet_rdm_t rdm;
     artnet_ip_prog_t ip_program;
     artnet_ip_reply_t ip_reply;
+    artnet_sync_t sync;
   } data;
 } artnet_packet;
 }  // namespace artnet
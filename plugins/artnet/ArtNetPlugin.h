@@ -43,6 +43,7 @@ class ArtNetPlugin : public Plugin {
   ola_plugin_id Id() const { return OLA_PLUGIN_ARTNET; }
   std::string Description() const;
   std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+  bool SupportsThreads() const { return true; }
 
  private:
   /**
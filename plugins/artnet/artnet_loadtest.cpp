@@ -18,11 +18,16 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <algorithm>
+#include <iomanip>
+#include <iostream>
 #include <memory>
 #include <string>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
@@ -33,6 +38,8 @@
 
 using ola::DmxBuffer;
 using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeStamp;
 using ola::io::SelectServer;
 using ola::network::Interface;
 using ola::network::InterfacePicker;
@@ -46,15 +53,69 @@ using std::min;
 DEFINE_s_uint32(fps, f, 10, "Frames per second per universe [1 - 1000]");
 DEFINE_s_uint16(universes, u, 1, "Number of universes to send");
 DEFINE_string(iface, "", "The interface to send from");
+DEFINE_default_bool(batch, false,
+                    "Send the packets for each frame with one system call");
+DEFINE_s_uint32(duration, d, 0,
+                "Stop after this many seconds, 0 runs forever");
+
+/**
+ * Report the packet rate and the CPU used.
+ */
+class LoadReporter {
+ public:
+  LoadReporter() : m_packets(0), m_last_packets(0) {
+    m_clock.CurrentTime(&m_last_time);
+    getrusage(RUSAGE_SELF, &m_last_usage);
+  }
+
+  void PacketsSent(unsigned int count) { m_packets += count; }
+
+  bool Report() {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    double wall = static_cast<double>((now - m_last_time).AsInt());
+    double cpu = static_cast<double>(CPUTime(usage) - CPUTime(m_last_usage));
+    if (wall > 0) {
+      cout << std::fixed << std::setprecision(0)
+           << ((m_packets - m_last_packets) * 1000000.0 / wall)
+           << " packets/s, " << std::setprecision(1) << (cpu * 100.0 / wall)
+           << "% CPU" << endl;
+    }
+    m_last_time = now;
+    m_last_usage = usage;
+    m_last_packets = m_packets;
+    return true;
+  }
+
+ private:
+  ola::Clock m_clock;
+  TimeStamp m_last_time;
+  struct rusage m_last_usage;
+  uint64_t m_packets;
+  uint64_t m_last_packets;
+
+  static int64_t CPUTime(const struct rusage &usage) {
+    return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+            usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+};
 
 /**
  * Send N DMX frames using Art-Net, where N is given by number_of_universes.
  */
 bool SendFrames(ArtNetNode *node, DmxBuffer *buffer,
-                uint16_t number_of_universes) {
+                uint16_t number_of_universes, LoadReporter *reporter) {
+  unsigned int sent = 0;
   for (uint16_t i = 0; i < number_of_universes; i++) {
-    node->SendDMX(i, *buffer);
+    if (node->SendDMX(i, *buffer)) {
+      sent++;
+    }
   }
+  reporter->PacketsSent(sent);
   return true;
 }
 
@@ -82,6 +143,7 @@ int main(int argc, char* argv[]) {
 
   ArtNetNodeOptions options;
   options.always_broadcast = true;
+  options.batch_sends = FLAGS_batch;
 
   SelectServer ss;
   ArtNetNode node(iface, &ss, options);
@@ -96,10 +158,19 @@ int main(int argc, char* argv[]) {
     return -1;
   }
 
+  LoadReporter reporter;
   ss.RegisterRepeatingTimeout(
       1000 / fps,
-      NewCallback(&SendFrames, &node, &output, universes));
+      NewCallback(&SendFrames, &node, &output, universes, &reporter));
+  ss.RegisterRepeatingTimeout(
+      1000, NewCallback(&reporter, &LoadReporter::Report));
+  if (FLAGS_duration) {
+    ss.RegisterSingleTimeout(
+        FLAGS_duration * 1000,
+        NewSingleCallback(&ss, &SelectServer::Terminate));
+  }
   cout << "Starting loadtester: " << universes << " universe(s), " << fps
-       << " fps" << endl;
+       << " fps" << (FLAGS_batch ? ", batched" : "") << endl;
   ss.Run();
+  node.Stop();
 }
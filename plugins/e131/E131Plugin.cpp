@@ -52,6 +52,7 @@ const char E131Plugin::PREPEND_HOSTNAME_KEY[] = "prepend_hostname";
 const char E131Plugin::REVISION_0_2[] = "0.2";
 const char E131Plugin::REVISION_0_46[] = "0.46";
 const char E131Plugin::REVISION_KEY[] = "revision";
+const char E131Plugin::SYNC_UNIVERSE_KEY[] = "sync_universe";
 const unsigned int E131Plugin::DEFAULT_PORT_COUNT = 5;
 
 
@@ -64,6 +65,9 @@ bool E131Plugin::StartHook() {
 
   E131Device::E131DeviceOptions options;
   options.use_rev2 = (m_preferences->GetValue(REVISION_KEY) == REVISION_0_2);
+  // Universes are usually updated together, so send their packets together.
+  options.batch_sends = true;
+  options.prebuilt_packets = true;
   options.ignore_preview = m_preferences->GetValueAsBool(
       IGNORE_PREVIEW_DATA_KEY);
   options.enable_draft_discovery = m_preferences->GetValueAsBool(
@@ -86,6 +90,12 @@ bool E131Plugin::StartHook() {
     options.dscp = dscp << 2;
   }
 
+  if (!StringToInt(m_preferences->GetValue(SYNC_UNIVERSE_KEY),
+                   &options.sync_universe)) {
+    OLA_WARN << "Invalid value for sync_universe";
+    options.sync_universe = 0;
+  }
+
   if (!StringToInt(m_preferences->GetValue(INPUT_PORT_COUNT_KEY),
                    &options.input_ports)) {
     OLA_WARN << "Invalid value for input_ports";
@@ -189,6 +199,11 @@ bool E131Plugin::SetDefaultPreferences() {
       SetValidator<string>(revision_values),
       REVISION_0_46);
 
+  save |= m_preferences->SetDefaultValue(
+      SYNC_UNIVERSE_KEY,
+      UIntValidator(0, 63999),
+      0);
+
   if (save) {
     m_preferences->Save();
   }
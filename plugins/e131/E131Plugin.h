@@ -42,6 +42,7 @@ class E131Plugin: public ola::Plugin {
     ola_plugin_id Id() const { return OLA_PLUGIN_E131; }
     std::string Description() const;
     std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+    bool SupportsThreads() const { return true; }
 
  private:
     bool StartHook();
@@ -64,6 +65,7 @@ class E131Plugin: public ola::Plugin {
     static const char REVISION_0_2[];
     static const char REVISION_0_46[];
     static const char REVISION_KEY[];
+    static const char SYNC_UNIVERSE_KEY[];
 };
 }  // namespace e131
 }  // namespace plugin
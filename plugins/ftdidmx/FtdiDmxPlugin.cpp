@@ -42,6 +42,7 @@ using std::string;
 using std::vector;
 
 const char FtdiDmxPlugin::K_FREQUENCY[] = "frequency";
+const char FtdiDmxPlugin::K_SPIN_WAIT[] = "spin_wait";
 const char FtdiDmxPlugin::PLUGIN_NAME[] = "FTDI USB DMX";
 const char FtdiDmxPlugin::PLUGIN_PREFIX[] = "ftdidmx";
 
@@ -72,10 +73,13 @@ bool FtdiDmxPlugin::StartHook() {
   unsigned int frequency = StringToIntOrDefault(
       m_preferences->GetValue(K_FREQUENCY),
       DEFAULT_FREQUENCY);
+  unsigned int spin_wait = StringToIntOrDefault(
+      m_preferences->GetValue(K_SPIN_WAIT),
+      DEFAULT_SPIN_WAIT);
 
   FtdiWidgetInfoVector::const_iterator iter;
   for (iter = widgets.begin(); iter != widgets.end(); ++iter) {
-    AddDevice(new FtdiDmxDevice(this, *iter, frequency));
+    AddDevice(new FtdiDmxDevice(this, *iter, frequency, spin_wait));
   }
   return true;
 }
@@ -112,9 +116,13 @@ bool FtdiDmxPlugin::SetDefaultPreferences() {
     return false;
   }
 
-  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
-                                     UIntValidator(1, 44),
-                                     DEFAULT_FREQUENCY)) {
+  bool save = m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
+                                             UIntValidator(1, 44),
+                                             DEFAULT_FREQUENCY);
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_SPIN_WAIT,
+                                         UIntValidator(0, MAX_SPIN_WAIT),
+                                         DEFAULT_SPIN_WAIT);
+  if (save) {
     m_preferences->Save();
   }
 
@@ -64,8 +64,11 @@ class FtdiDmxPlugin : public Plugin {
   bool SetDefaultPreferences();
 
   static const uint8_t DEFAULT_FREQUENCY = 30;
+  static const unsigned int DEFAULT_SPIN_WAIT = 0;
+  static const unsigned int MAX_SPIN_WAIT = 5000;
 
   static const char K_FREQUENCY[];
+  static const char K_SPIN_WAIT[];
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
 };
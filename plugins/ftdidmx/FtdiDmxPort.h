@@ -44,10 +44,11 @@ class FtdiDmxOutputPort : public ola::BasicOutputPort {
     FtdiDmxOutputPort(FtdiDmxDevice *parent,
                       FtdiInterface *interface,
                       unsigned int id,
-                      unsigned int freq)
+                      unsigned int freq,
+                      unsigned int spin_wait)
         : BasicOutputPort(parent, id),
           m_interface(interface),
-          m_thread(interface, freq) {
+          m_thread(interface, freq, spin_wait) {
       m_thread.Start();
     }
     ~FtdiDmxOutputPort() {
@@ -23,14 +23,12 @@
  * by E.S. Rosenberg a.k.a. Keeper of the Keys 5774/2014
  */
 
-#include <math.h>
-#include <unistd.h>
-
 #include <string>
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/FrameTimer.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
 #include "plugins/ftdidmx/FtdiDmxThread.h"
 
@@ -38,11 +36,14 @@ namespace ola {
 namespace plugin {
 namespace ftdidmx {
 
-FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, unsigned int frequency)
-  : m_granularity(UNKNOWN),
-    m_interface(interface),
+using ola::thread::FrameTimer;
+
+FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, unsigned int frequency,
+                             unsigned int spin_wait)
+  : m_interface(interface),
     m_term(false),
-    m_frequency(frequency) {
+    m_frequency(frequency),
+    m_spin_wait(spin_wait) {
 }
 
 FtdiDmxThread::~FtdiDmxThread() {
@@ -78,14 +79,12 @@ bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * @brief The method called by the thread
  */
 void *FtdiDmxThread::Run() {
-  TimeStamp ts1, ts2, ts3;
-  Clock clock;
-  CheckTimeGranularity();
+  // Frames start on multiples of the period, so a slow frame doesn't push
+  // the following ones back.
+  FrameTimer timer(TimeInterval(ONE_THOUSAND * ONE_THOUSAND / m_frequency),
+                   TimeInterval(m_spin_wait));
   DmxBuffer buffer;
 
-  int frameTime = static_cast<int>(floor(
-    (static_cast<double>(1000) / m_frequency) + static_cast<double>(0.5)));
-
   // Setup the interface
   if (!m_interface->IsOpen()) {
     m_interface->SetupOutput();
@@ -104,77 +103,25 @@ void *FtdiDmxThread::Run() {
       buffer.Set(m_buffer);
     }
 
-    clock.CurrentTime(&ts1);
-
-    if (!m_interface->SetBreak(true)) {
-      goto framesleep;
+    unsigned int skipped = timer.WaitForNextFrame();
+    if (skipped) {
+      OLA_DEBUG << "FTDI thread skipped " << skipped << " frames";
     }
 
-    if (m_granularity == GOOD) {
-      usleep(DMX_BREAK);
+    if (!m_interface->SetBreak(true)) {
+      continue;
     }
+    timer.Sleep(TimeInterval(DMX_BREAK));
 
     if (!m_interface->SetBreak(false)) {
-      goto framesleep;
+      continue;
     }
+    timer.Sleep(TimeInterval(DMX_MAB));
 
-    if (m_granularity == GOOD) {
-      usleep(DMX_MAB);
-    }
-
-    if (!m_interface->Write(buffer)) {
-      goto framesleep;
-    }
-
-  framesleep:
-    // Sleep for the remainder of the DMX frame time
-    clock.CurrentTime(&ts2);
-    TimeInterval elapsed = ts2 - ts1;
-
-    if (m_granularity == GOOD) {
-      while (elapsed.InMilliSeconds() < frameTime) {
-        usleep(1000);
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
-    } else {
-      // See if we can drop out of bad mode.
-      usleep(1000);
-      clock.CurrentTime(&ts3);
-      TimeInterval interval = ts3 - ts2;
-      if (interval.InMilliSeconds() < BAD_GRANULARITY_LIMIT) {
-        m_granularity = GOOD;
-        OLA_INFO << "Switching from BAD to GOOD granularity for ftdi thread";
-      }
-
-      elapsed = ts3 - ts1;
-      while (elapsed.InMilliSeconds() < frameTime) {
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
-    }
+    m_interface->Write(buffer);
   }
   return NULL;
 }
-
-
-/**
- * @brief Check the granularity of usleep.
- */
-void FtdiDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-
-  clock.CurrentTime(&ts1);
-  usleep(1000);
-  clock.CurrentTime(&ts2);
-
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = (interval.InMilliSeconds() > BAD_GRANULARITY_LIMIT) ?
-      BAD : GOOD;
-  OLA_INFO << "Granularity for FTDI thread is "
-           << ((m_granularity == GOOD) ? "GOOD" : "BAD");
-}
 }  // namespace ftdidmx
 }  // namespace plugin
 }  // namespace ola
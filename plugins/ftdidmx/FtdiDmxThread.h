@@ -35,7 +35,8 @@ namespace ftdidmx {
 
 class FtdiDmxThread : public ola::thread::Thread {
  public:
-    FtdiDmxThread(FtdiInterface *interface, unsigned int frequency);
+    FtdiDmxThread(FtdiInterface *interface, unsigned int frequency,
+                  unsigned int spin_wait = 0);
     ~FtdiDmxThread();
 
     bool Stop();
@@ -43,21 +44,16 @@ class FtdiDmxThread : public ola::thread::Thread {
     bool WriteDMX(const DmxBuffer &buffer);
 
  private:
-    enum TimerGranularity { UNKNOWN, GOOD, BAD };
-
-    TimerGranularity m_granularity;
     FtdiInterface *m_interface;
     bool m_term;
     unsigned int m_frequency;
+    unsigned int m_spin_wait;
     DmxBuffer m_buffer;
     ola::thread::Mutex m_term_mutex;
     ola::thread::Mutex m_buffer_mutex;
 
-    void CheckTimeGranularity();
-
     static const uint32_t DMX_MAB = 16;
     static const uint32_t DMX_BREAK = 110;
-    static const uint32_t BAD_GRANULARITY_LIMIT = 3;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
@@ -19,6 +19,7 @@
  */
 
 #include <string.h>
+#include <unistd.h>
 #include <numeric>
 #include <string>
 #include "ola/Logging.h"
@@ -32,20 +33,43 @@ namespace spi {
 using ola::thread::MutexLocker;
 
 bool FakeSPIWriter::WriteSPIData(const uint8_t *data, unsigned int length) {
+  SPITransfer transfer(data, length);
+  return WriteSPITransfers(&transfer, 1);
+}
+
+bool FakeSPIWriter::WriteSPITransfers(const SPITransfer *transfers,
+                                      unsigned int count) {
+  TimeInterval write_time;
   {
     MutexLocker lock(&m_mutex);
+    m_clock.CurrentTime(&m_last_write_time);
+
+    unsigned int length = 0;
+    for (unsigned int i = 0; i < count; i++) {
+      length += transfers[i].length;
+    }
 
     if (m_last_write_size != length) {
       delete[] m_data;
       m_data = new uint8_t[length];
     }
-    memcpy(m_data, data, length);
+    uint8_t *output = m_data;
+    for (unsigned int i = 0; i < count; i++) {
+      memcpy(output, transfers[i].data, transfers[i].length);
+      output += transfers[i].length;
+    }
 
     m_writes++;
     m_write_pending = true;
     m_last_write_size = length;
+    m_last_transfer_count = count;
+    write_time = m_write_time;
+  }
+  m_cond_var.Broadcast();
+
+  if (write_time.AsInt()) {
+    usleep(static_cast<useconds_t>(write_time.AsInt()));
   }
-  m_cond_var.Signal();
 
   MutexLocker lock(&m_write_lock);
   return true;
@@ -59,6 +83,11 @@ void FakeSPIWriter::UnblockWriter() {
   m_write_lock.Unlock();
 }
 
+void FakeSPIWriter::SetWriteTime(const TimeInterval &write_time) {
+  MutexLocker lock(&m_mutex);
+  m_write_time = write_time;
+}
+
 void FakeSPIWriter::ResetWrite() {
   MutexLocker lock(&m_mutex);
   m_write_pending = false;
@@ -71,6 +100,21 @@ void FakeSPIWriter::WaitForWrite() {
   m_cond_var.Wait(&m_mutex);
 }
 
+bool FakeSPIWriter::WaitForWriteCount(unsigned int count,
+                                      const TimeInterval &timeout) {
+  TimeStamp wake_up_time;
+  m_clock.CurrentTime(&wake_up_time);
+  wake_up_time += timeout;
+
+  MutexLocker lock(&m_mutex);
+  while (m_writes < count) {
+    if (!m_cond_var.TimedWait(&m_mutex, wake_up_time)) {
+      return m_writes >= count;
+    }
+  }
+  return true;
+}
+
 unsigned int FakeSPIWriter::WriteCount() const {
   MutexLocker lock(&m_mutex);
   return m_writes;
@@ -81,6 +125,16 @@ unsigned int FakeSPIWriter::LastWriteSize() const {
   return m_last_write_size;
 }
 
+unsigned int FakeSPIWriter::LastTransferCount() const {
+  MutexLocker lock(&m_mutex);
+  return m_last_transfer_count;
+}
+
+TimeStamp FakeSPIWriter::LastWriteTime() const {
+  MutexLocker lock(&m_mutex);
+  return m_last_write_time;
+}
+
 void FakeSPIWriter::CheckDataMatches(
     const ola::testing::SourceLine &source_line,
     const uint8_t *expected,
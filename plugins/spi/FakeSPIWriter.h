@@ -21,6 +21,7 @@
 #ifndef PLUGINS_SPI_FAKESPIWRITER_H_
 #define PLUGINS_SPI_FAKESPIWRITER_H_
 
+#include <ola/Clock.h>
 #include <ola/testing/TestUtils.h>
 #include <ola/thread/Mutex.h>
 #include <stdint.h>
@@ -41,6 +42,7 @@ class FakeSPIWriter : public SPIWriterInterface {
       m_write_pending(0),
       m_writes(0),
       m_last_write_size(0),
+      m_last_transfer_count(0),
       m_data(NULL) {
   }
 
@@ -53,16 +55,31 @@ class FakeSPIWriter : public SPIWriterInterface {
   std::string DevicePath() const { return m_device_path; }
 
   bool WriteSPIData(const uint8_t *data, unsigned int length);
+  bool WriteSPITransfers(const SPITransfer *transfers, unsigned int count);
 
   // Methods used for testing
   void BlockWriter();
   void UnblockWriter();
 
+  /**
+   * Make each write take this long, to simulate the time spent clocking the
+   * data out.
+   */
+  void SetWriteTime(const TimeInterval &write_time);
+
   void ResetWrite();
   void WaitForWrite();
 
+  /**
+   * Wait until at least count writes have been made.
+   * @returns false if the timeout expired first.
+   */
+  bool WaitForWriteCount(unsigned int count, const TimeInterval &timeout);
+
   unsigned int WriteCount() const;
   unsigned int LastWriteSize() const;
+  unsigned int LastTransferCount() const;
+  TimeStamp LastWriteTime() const;
   void CheckDataMatches(const ola::testing::SourceLine &source_line,
                         const uint8_t *data,
                         unsigned int length);
@@ -72,7 +89,11 @@ class FakeSPIWriter : public SPIWriterInterface {
   bool m_write_pending;  // GUARDED_BY(m_mutex)
   unsigned int m_writes;  // GUARDED_BY(m_mutex)
   unsigned int m_last_write_size;  // GUARDED_BY(m_mutex)
+  unsigned int m_last_transfer_count;  // GUARDED_BY(m_mutex)
   uint8_t *m_data;  // GUARDED_BY(m_mutex)
+  TimeInterval m_write_time;  // GUARDED_BY(m_mutex)
+  TimeStamp m_last_write_time;  // GUARDED_BY(m_mutex)
+  ola::Clock m_clock;
 
   ola::thread::Mutex m_write_lock;
   mutable ola::thread::Mutex m_mutex;
@@ -0,0 +1,590 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelEncoder.cpp
+ * Converts DMX data to the byte stream for a pixel chip.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The LPD8806 code was based on
+ * https://github.com/adafruit/LPD8806/blob/master/LPD8806.cpp
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define PIXEL_ENCODER_SHUFFLE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_ENCODER_SHUFFLE 1
+#endif  // __SSSE3__
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "ola/StringUtils.h"
+#include "plugins/spi/PixelEncoder.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+using std::min;
+using std::string;
+
+namespace {
+
+const char *const COLOR_ORDERS[] = {
+  "RGB", "RBG", "GRB", "GBR", "BRG", "BGR",
+};
+
+/*
+ * The chip traits. Each has:
+ *  - SLOTS, the number of DMX slots per pixel.
+ *  - BYTES, the number of bytes sent per pixel.
+ *  - COLOR_SLOT, the offset of the first color slot.
+ *  - Write(), which writes a pixel given the corrected colors.
+ */
+struct WS2801Pixel {
+  enum { SLOTS = 3, BYTES = 3, COLOR_SLOT = 0 };
+
+  static inline void Write(const uint8_t*, uint8_t red, uint8_t green,
+                           uint8_t blue, uint8_t *output) {
+    output[0] = red;
+    output[1] = green;
+    output[2] = blue;
+  }
+
+  // The color of each output byte, -1 for a header.
+  static int WireColor(unsigned int byte) {
+    return static_cast<int>(byte);
+  }
+
+  static const uint8_t HEADER = 0;
+};
+
+struct LPD8806Pixel {
+  enum { SLOTS = 3, BYTES = 3, COLOR_SLOT = 0 };
+
+  static inline void Write(const uint8_t*, uint8_t red, uint8_t green,
+                           uint8_t blue, uint8_t *output) {
+    output[0] = 0x80 | (green >> 1);
+    output[1] = 0x80 | (red >> 1);
+    output[2] = 0x80 | (blue >> 1);
+  }
+
+  static int WireColor(unsigned int byte) {
+    const int colors[] = {PixelFormat::GREEN, PixelFormat::RED,
+                          PixelFormat::BLUE};
+    return colors[byte];
+  }
+
+  static const uint8_t HEADER = 0;
+};
+
+/*
+ * For more information please visit:
+ * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
+ */
+struct P9813Pixel {
+  enum { SLOTS = 3, BYTES = 4, COLOR_SLOT = 0 };
+
+  static inline void Write(const uint8_t*, uint8_t red, uint8_t green,
+                           uint8_t blue, uint8_t *output) {
+    uint8_t flag = (red & 0xc0) >> 6;
+    flag |= (green & 0xc0) >> 4;
+    flag |= (blue & 0xc0) >> 2;
+    output[0] = ~flag;
+    output[1] = blue;
+    output[2] = green;
+    output[3] = red;
+  }
+};
+
+/*
+ * Some detailed information on the protocol:
+ * https://cpldcpu.wordpress.com/2014/11/30/understanding-the-apa102-superled/
+ * The first byte contains a 3 bit start mark (111) and 5 bits of brightness.
+ * The brightness is fixed at 31, which reduces flickering.
+ */
+struct APA102Pixel {
+  enum { SLOTS = 3, BYTES = 4, COLOR_SLOT = 0 };
+
+  static inline void Write(const uint8_t*, uint8_t red, uint8_t green,
+                           uint8_t blue, uint8_t *output) {
+    output[0] = HEADER;
+    output[1] = blue;
+    output[2] = green;
+    output[3] = red;
+  }
+
+  static int WireColor(unsigned int byte) {
+    const int colors[] = {-1, PixelFormat::BLUE, PixelFormat::GREEN,
+                          PixelFormat::RED};
+    return colors[byte];
+  }
+
+  static const uint8_t HEADER = 0xFF;
+};
+
+/*
+ * The first slot is the pixel brightness, which is mapped from 8 to 5 bits.
+ */
+struct APA102PBPixel {
+  enum { SLOTS = 4, BYTES = 4, COLOR_SLOT = 1 };
+
+  static inline void Write(const uint8_t *input, uint8_t red, uint8_t green,
+                           uint8_t blue, uint8_t *output) {
+    output[0] = 0xE0 | (input[0] >> 3);
+    output[1] = blue;
+    output[2] = green;
+    output[3] = red;
+  }
+};
+
+/*
+ * The kernel for each chip.
+ */
+template <typename Chip>
+void EncodePixels(const PixelFormat &format, const uint8_t *input,
+                  uint8_t *output, unsigned int count) {
+  const uint8_t *red_table = format.Table(PixelFormat::RED);
+  const uint8_t *green_table = format.Table(PixelFormat::GREEN);
+  const uint8_t *blue_table = format.Table(PixelFormat::BLUE);
+  const unsigned int red = Chip::COLOR_SLOT + format.Offset(PixelFormat::RED);
+  const unsigned int green =
+      Chip::COLOR_SLOT + format.Offset(PixelFormat::GREEN);
+  const unsigned int blue =
+      Chip::COLOR_SLOT + format.Offset(PixelFormat::BLUE);
+
+  for (unsigned int i = 0; i < count; i++) {
+    Chip::Write(input, red_table[input[red]], green_table[input[green]],
+                blue_table[input[blue]], output);
+    input += Chip::SLOTS;
+    output += Chip::BYTES;
+  }
+}
+
+#if defined(__SSSE3__)
+/*
+ * Applied to each block of bytes after the shuffle.
+ */
+template <typename Chip>
+inline __m128i FinishBlock(__m128i data) {
+  return data;
+}
+
+template <>
+inline __m128i FinishBlock<LPD8806Pixel>(__m128i data) {
+  // There's no 8 bit shift, so mask off the bits shifted in from the
+  // neighbouring byte.
+  return _mm_or_si128(
+      _mm_and_si128(_mm_srli_epi16(data, 1), _mm_set1_epi8(0x7f)),
+      _mm_set1_epi8(static_cast<char>(0x80)));
+}
+
+/*
+ * Encode as many pixels as possible with 16 byte shuffles.
+ * @returns the number of pixels encoded.
+ */
+template <typename Chip>
+unsigned int ShufflePixels(const PixelFormat &format, const uint8_t *input,
+                           uint8_t *output, unsigned int count) {
+  const unsigned int block = 16 / Chip::BYTES;
+  uint8_t mask[16];
+  uint8_t header[16];
+  for (unsigned int i = 0; i < 16; i++) {
+    const unsigned int pixel = i / Chip::BYTES;
+    const int color = Chip::WireColor(i % Chip::BYTES);
+    header[i] = 0;
+    if (pixel >= block) {
+      mask[i] = 0x80;  // zero
+    } else if (color < 0) {
+      mask[i] = 0x80;
+      header[i] = Chip::HEADER;
+    } else {
+      mask[i] = pixel * Chip::SLOTS + Chip::COLOR_SLOT +
+                format.Offset(static_cast<PixelFormat::Color>(color));
+    }
+  }
+  const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<__m128i*>(mask));
+  const __m128i headers = _mm_loadu_si128(reinterpret_cast<__m128i*>(header));
+
+  // The loads and stores are 16 bytes, which can be more than a block, so stop
+  // while there's still room for them.
+  unsigned int done = 0;
+  while (count - done >= block &&
+         (count - done) * Chip::SLOTS >= 16 &&
+         (count - done) * Chip::BYTES >= 16) {
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    data = _mm_or_si128(_mm_shuffle_epi8(data, shuffle), headers);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                     FinishBlock<Chip>(data));
+    input += block * Chip::SLOTS;
+    output += block * Chip::BYTES;
+    done += block;
+  }
+  return done;
+}
+#elif defined(PIXEL_ENCODER_SHUFFLE)
+/*
+ * Write 16 pixels, colors is indexed by PixelFormat::Color.
+ */
+template <typename Chip>
+void StorePixels(const uint8x16_t *colors, uint8_t *output);
+
+template <>
+inline void StorePixels<WS2801Pixel>(const uint8x16_t *colors,
+                                     uint8_t *output) {
+  uint8x16x3_t pixels;
+  pixels.val[0] = colors[PixelFormat::RED];
+  pixels.val[1] = colors[PixelFormat::GREEN];
+  pixels.val[2] = colors[PixelFormat::BLUE];
+  vst3q_u8(output, pixels);
+}
+
+template <>
+inline void StorePixels<LPD8806Pixel>(const uint8x16_t *colors,
+                                      uint8_t *output) {
+  const uint8x16_t high_bit = vdupq_n_u8(0x80);
+  uint8x16x3_t pixels;
+  pixels.val[0] = vorrq_u8(vshrq_n_u8(colors[PixelFormat::GREEN], 1),
+                           high_bit);
+  pixels.val[1] = vorrq_u8(vshrq_n_u8(colors[PixelFormat::RED], 1), high_bit);
+  pixels.val[2] = vorrq_u8(vshrq_n_u8(colors[PixelFormat::BLUE], 1),
+                           high_bit);
+  vst3q_u8(output, pixels);
+}
+
+template <>
+inline void StorePixels<APA102Pixel>(const uint8x16_t *colors,
+                                     uint8_t *output) {
+  uint8x16x4_t pixels;
+  pixels.val[0] = vdupq_n_u8(APA102Pixel::HEADER);
+  pixels.val[1] = colors[PixelFormat::BLUE];
+  pixels.val[2] = colors[PixelFormat::GREEN];
+  pixels.val[3] = colors[PixelFormat::RED];
+  vst4q_u8(output, pixels);
+}
+
+/*
+ * Encode as many pixels as possible, 16 at a time.
+ * @returns the number of pixels encoded.
+ */
+template <typename Chip>
+unsigned int ShufflePixels(const PixelFormat &format, const uint8_t *input,
+                           uint8_t *output, unsigned int count) {
+  const unsigned int red = format.Offset(PixelFormat::RED);
+  const unsigned int green = format.Offset(PixelFormat::GREEN);
+  const unsigned int blue = format.Offset(PixelFormat::BLUE);
+  unsigned int done = 0;
+  while (count - done >= 16) {
+    const uint8x16x3_t slots = vld3q_u8(input);
+    uint8x16_t colors[3];
+    colors[PixelFormat::RED] = slots.val[red];
+    colors[PixelFormat::GREEN] = slots.val[green];
+    colors[PixelFormat::BLUE] = slots.val[blue];
+    StorePixels<Chip>(colors, output);
+    input += 16 * Chip::SLOTS;
+    output += 16 * Chip::BYTES;
+    done += 16;
+  }
+  return done;
+}
+#endif  // __SSSE3__
+
+/*
+ * Encode pixels for a chip which only reorders the bytes, using SIMD if
+ * possible.
+ */
+template <typename Chip>
+void ShuffleOrEncodePixels(const PixelFormat &format, const uint8_t *input,
+                           uint8_t *output, unsigned int count) {
+  unsigned int done = 0;
+#ifdef PIXEL_ENCODER_SHUFFLE
+  if (format.IsLinear()) {
+    done = ShufflePixels<Chip>(format, input, output, count);
+  }
+#endif  // PIXEL_ENCODER_SHUFFLE
+  EncodePixels<Chip>(format, input + done * Chip::SLOTS,
+                     output + done * Chip::BYTES, count - done);
+}
+
+/*
+ * Write the colors which are present in a partial WS2801 pixel.
+ */
+void EncodePartialWS2801Pixel(const PixelFormat &format, const uint8_t *input,
+                              unsigned int length, uint8_t *output) {
+  for (unsigned int i = 0; i < WS2801Pixel::SLOTS; i++) {
+    const PixelFormat::Color color = static_cast<PixelFormat::Color>(i);
+    const unsigned int offset = format.Offset(color);
+    if (offset < length) {
+      output[i] = format.Table(color)[input[offset]];
+    }
+  }
+}
+
+/*
+ * Look up the 8.8 level for a 16 bit value, interpolating between the table
+ * entries. The value is scaled so 0xffff maps to the last step.
+ */
+inline unsigned int WideLevel(const uint16_t *table, unsigned int value) {
+  value += value >> 15;
+  const unsigned int step = value >> 8;
+  const unsigned int low = table[step];
+  return low + (((table[step + 1] - low) * (value & 0xff)) >> 8);
+}
+
+/*
+ * The 16 bit kernel. The fraction of a header byte is 0, this only supports
+ * chips with the header in the first byte.
+ */
+template <typename Chip>
+void EncodeWidePixels(const PixelFormat &format, const uint8_t *input,
+                      uint8_t *output, uint8_t *fraction, unsigned int count) {
+  const uint16_t *red_table = format.WideTable(PixelFormat::RED);
+  const uint16_t *green_table = format.WideTable(PixelFormat::GREEN);
+  const uint16_t *blue_table = format.WideTable(PixelFormat::BLUE);
+  const unsigned int red =
+      2 * (Chip::COLOR_SLOT + format.Offset(PixelFormat::RED));
+  const unsigned int green =
+      2 * (Chip::COLOR_SLOT + format.Offset(PixelFormat::GREEN));
+  const unsigned int blue =
+      2 * (Chip::COLOR_SLOT + format.Offset(PixelFormat::BLUE));
+
+  for (unsigned int i = 0; i < count; i++) {
+    const unsigned int red_level = WideLevel(
+        red_table, (input[red] << 8) | input[red + 1]);
+    const unsigned int green_level = WideLevel(
+        green_table, (input[green] << 8) | input[green + 1]);
+    const unsigned int blue_level = WideLevel(
+        blue_table, (input[blue] << 8) | input[blue + 1]);
+    Chip::Write(input, red_level >> 8, green_level >> 8, blue_level >> 8,
+                output);
+    Chip::Write(input, red_level & 0xff, green_level & 0xff,
+                blue_level & 0xff, fraction);
+    if (Chip::HEADER) {
+      fraction[0] = 0;
+    }
+    input += 2 * Chip::SLOTS;
+    output += Chip::BYTES;
+    fraction += Chip::BYTES;
+  }
+}
+
+void EncodeString(PixelEncoder::Chip chip, const PixelFormat &format,
+                  const uint8_t *input, uint8_t *output, unsigned int count) {
+  switch (chip) {
+    case PixelEncoder::WS2801:
+      ShuffleOrEncodePixels<WS2801Pixel>(format, input, output, count);
+      break;
+    case PixelEncoder::LPD8806:
+      ShuffleOrEncodePixels<LPD8806Pixel>(format, input, output, count);
+      break;
+    case PixelEncoder::P9813:
+      EncodePixels<P9813Pixel>(format, input, output, count);
+      break;
+    case PixelEncoder::APA102:
+      ShuffleOrEncodePixels<APA102Pixel>(format, input, output, count);
+      break;
+    case PixelEncoder::APA102_PB:
+      EncodePixels<APA102PBPixel>(format, input, output, count);
+      break;
+  }
+}
+}  // namespace
+
+bool StringToColorOrder(const string &input, ColorOrder *order) {
+  string value = input;
+  ToUpper(&value);
+  for (unsigned int i = 0; i <= COLOR_ORDER_BGR; i++) {
+    if (value == COLOR_ORDERS[i]) {
+      *order = static_cast<ColorOrder>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+string ColorOrderToString(ColorOrder order) {
+  return COLOR_ORDERS[order];
+}
+
+PixelFormat::PixelFormat()
+    : m_linear(true) {
+  SetColorOrder(COLOR_ORDER_RGB);
+  SetCorrection(1.0, 255, 255, 255);
+}
+
+void PixelFormat::SetColorOrder(ColorOrder order) {
+  const string colors = COLOR_ORDERS[order];
+  m_color_order = order;
+  m_offsets[RED] = colors.find('R');
+  m_offsets[GREEN] = colors.find('G');
+  m_offsets[BLUE] = colors.find('B');
+}
+
+void PixelFormat::SetCorrection(double gamma, uint8_t red_max,
+                                uint8_t green_max, uint8_t blue_max) {
+  if (gamma <= 0) {
+    gamma = 1.0;
+  }
+  const uint8_t maximums[] = {red_max, green_max, blue_max};
+  m_linear = true;
+  for (unsigned int color = 0; color < 3; color++) {
+    for (unsigned int i = 0; i < 256; i++) {
+      const double value = maximums[color] * pow(i / 255.0, gamma);
+      m_tables[color][i] = static_cast<uint8_t>(value + 0.5);
+      m_linear &= m_tables[color][i] == i;
+    }
+
+    // The levels never exceed maximum << 8, so dithering can't overflow.
+    for (unsigned int i = 0; i < WIDE_TABLE_SIZE - 1; i++) {
+      const double value = maximums[color] * 256.0 * pow(i / 256.0, gamma);
+      m_wide_tables[color][i] = static_cast<uint16_t>(value + 0.5);
+    }
+    m_wide_tables[color][WIDE_TABLE_SIZE - 1] =
+        m_wide_tables[color][WIDE_TABLE_SIZE - 2];
+  }
+}
+
+unsigned int PixelEncoder::SlotsPerPixel(Chip chip) {
+  switch (chip) {
+    case WS2801:
+      return WS2801Pixel::SLOTS;
+    case LPD8806:
+      return LPD8806Pixel::SLOTS;
+    case P9813:
+      return P9813Pixel::SLOTS;
+    case APA102:
+      return APA102Pixel::SLOTS;
+    case APA102_PB:
+      return APA102PBPixel::SLOTS;
+  }
+  return 0;
+}
+
+unsigned int PixelEncoder::BytesPerPixel(Chip chip) {
+  switch (chip) {
+    case WS2801:
+      return WS2801Pixel::BYTES;
+    case LPD8806:
+      return LPD8806Pixel::BYTES;
+    case P9813:
+      return P9813Pixel::BYTES;
+    case APA102:
+      return APA102Pixel::BYTES;
+    case APA102_PB:
+      return APA102PBPixel::BYTES;
+  }
+  return 0;
+}
+
+unsigned int PixelEncoder::Encode(Chip chip, const PixelFormat &format,
+                                  const uint8_t *input, unsigned int length,
+                                  uint8_t *output, unsigned int pixel_count) {
+  const unsigned int slots = SlotsPerPixel(chip);
+  const unsigned int count = min(length / slots, pixel_count);
+  EncodeString(chip, format, input, output, count);
+
+  if (chip == WS2801 && count < pixel_count && length > count * slots) {
+    EncodePartialWS2801Pixel(format, input + count * slots,
+                             length - count * slots,
+                             output + count * WS2801Pixel::BYTES);
+  }
+  return count;
+}
+
+void PixelEncoder::Fill(Chip chip, const PixelFormat &format,
+                        const uint8_t *input, uint8_t *output,
+                        unsigned int pixel_count) {
+  if (!pixel_count) {
+    return;
+  }
+  const unsigned int bytes = BytesPerPixel(chip);
+  EncodeString(chip, format, input, output, 1);
+  for (unsigned int i = 1; i < pixel_count; i++) {
+    memcpy(output + i * bytes, output, bytes);
+  }
+}
+
+unsigned int PixelEncoder::EncodeWide(Chip chip, const PixelFormat &format,
+                                      const uint8_t *input, unsigned int length,
+                                      uint8_t *output, uint8_t *fraction,
+                                      unsigned int pixel_count) {
+  const unsigned int count = min(length / WideSlotsPerPixel(chip),
+                                 pixel_count);
+  switch (chip) {
+    case WS2801:
+      EncodeWidePixels<WS2801Pixel>(format, input, output, fraction, count);
+      return count;
+    case APA102:
+      EncodeWidePixels<APA102Pixel>(format, input, output, fraction, count);
+      return count;
+    default:
+      return 0;
+  }
+}
+
+void PixelEncoder::Dither(const uint8_t *input, const uint8_t *fraction,
+                          uint8_t *error, uint8_t *output,
+                          unsigned int length) {
+  unsigned int i = 0;
+#if defined(__SSE2__)
+  // The sum overflows when the saturating and wrapping adds differ.
+  const __m128i one = _mm_set1_epi8(1);
+  for (; i + 16 <= length; i += 16) {
+    const __m128i errors =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(error + i));
+    const __m128i fractions =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(fraction + i));
+    const __m128i sum = _mm_add_epi8(errors, fractions);
+    const __m128i no_carry =
+        _mm_cmpeq_epi8(sum, _mm_adds_epu8(errors, fractions));
+    const __m128i data =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                     _mm_add_epi8(data, _mm_andnot_si128(no_carry, one)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(error + i), sum);
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint8x16_t one = vdupq_n_u8(1);
+  for (; i + 16 <= length; i += 16) {
+    const uint8x16_t errors = vld1q_u8(error + i);
+    const uint8x16_t fractions = vld1q_u8(fraction + i);
+    const uint8x16_t sum = vaddq_u8(errors, fractions);
+    const uint8x16_t carry = vbicq_u8(
+        one, vceqq_u8(sum, vqaddq_u8(errors, fractions)));
+    vst1q_u8(output + i, vaddq_u8(vld1q_u8(input + i), carry));
+    vst1q_u8(error + i, sum);
+  }
+#endif  // __SSE2__
+  for (; i < length; i++) {
+    const unsigned int sum = error[i] + fraction[i];
+    output[i] = input[i] + (sum >> 8);
+    error[i] = sum & 0xff;
+  }
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
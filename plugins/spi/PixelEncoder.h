@@ -0,0 +1,232 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelEncoder.h
+ * Converts DMX data to the byte stream for a pixel chip.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_SPI_PIXELENCODER_H_
+#define PLUGINS_SPI_PIXELENCODER_H_
+
+#include <stdint.h>
+#include <string>
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * The order of the colors in the DMX data for each pixel.
+ */
+enum ColorOrder {
+  COLOR_ORDER_RGB,
+  COLOR_ORDER_RBG,
+  COLOR_ORDER_GRB,
+  COLOR_ORDER_GBR,
+  COLOR_ORDER_BRG,
+  COLOR_ORDER_BGR,
+};
+
+/**
+ * Convert a string like "GRB" to a ColorOrder.
+ * @returns true if the string was valid, false otherwise.
+ */
+bool StringToColorOrder(const std::string &input, ColorOrder *order);
+
+/**
+ * Convert a ColorOrder to a string.
+ */
+std::string ColorOrderToString(ColorOrder order);
+
+/**
+ * How the DMX data for each pixel is interpreted by an output.
+ *
+ * This holds the color order, and a lookup table for each color which applies
+ * the gamma and white balance correction. Building the tables is slow, so
+ * this should be done when the output is configured, not for each frame.
+ *
+ * There is also a wide table for each color, used for 16 bit data. Each entry
+ * is an 8.8 fixed point level, and the entries are 256 input steps apart,
+ * so the levels between them are interpolated.
+ */
+class PixelFormat {
+ public:
+  enum Color {
+    RED = 0,
+    GREEN = 1,
+    BLUE = 2,
+  };
+
+  /**
+   * Create a PixelFormat for RGB data without any correction.
+   */
+  PixelFormat();
+
+  ColorOrder GetColorOrder() const { return m_color_order; }
+  void SetColorOrder(ColorOrder order);
+
+  /**
+   * Set the correction to apply.
+   * @param gamma the gamma exponent, 1.0 is linear.
+   * @param red_max the value sent for a red level of 255.
+   * @param green_max the value sent for a green level of 255.
+   * @param blue_max the value sent for a blue level of 255.
+   */
+  void SetCorrection(double gamma, uint8_t red_max, uint8_t green_max,
+                     uint8_t blue_max);
+
+  /**
+   * The offset of a color in the DMX data for a pixel.
+   */
+  unsigned int Offset(Color color) const { return m_offsets[color]; }
+
+  /**
+   * The lookup table for a color.
+   */
+  const uint8_t *Table(Color color) const { return m_tables[color]; }
+
+  /**
+   * The wide lookup table for a color, this has WIDE_TABLE_SIZE entries.
+   */
+  const uint16_t *WideTable(Color color) const { return m_wide_tables[color]; }
+
+  /**
+   * True if the tables don't change the values.
+   */
+  bool IsLinear() const { return m_linear; }
+
+  // 257 steps, plus a copy of the last so the interpolation doesn't need to
+  // check for the end of the table.
+  static const unsigned int WIDE_TABLE_SIZE = 258;
+
+ private:
+  ColorOrder m_color_order;
+  unsigned int m_offsets[3];
+  uint8_t m_tables[3][256];
+  uint16_t m_wide_tables[3][WIDE_TABLE_SIZE];
+  bool m_linear;
+};
+
+/**
+ * Converts DMX data to the bytes sent to a string of pixels.
+ *
+ * There is a kernel for each chip, which is specialized at compile time. The
+ * kernels work on the raw DMX data, and use the PixelFormat's tables for the
+ * correction. If the compiler targets SSSE3 or NEON, the data for chips which
+ * only reorder the bytes is shuffled with SIMD instructions.
+ */
+class PixelEncoder {
+ public:
+  enum Chip {
+    WS2801,
+    LPD8806,
+    P9813,
+    APA102,
+    APA102_PB,  // APA102 with a pixel brightness slot.
+  };
+
+  /**
+   * The number of DMX slots used by each pixel.
+   */
+  static unsigned int SlotsPerPixel(Chip chip);
+
+  /**
+   * The number of bytes sent for each pixel.
+   */
+  static unsigned int BytesPerPixel(Chip chip);
+
+  /**
+   * Encode a string of pixels.
+   * @param chip the type of pixel.
+   * @param format the PixelFormat to use.
+   * @param input the DMX data.
+   * @param length the number of slots of DMX data.
+   * @param output the memory to write the pixels to, this must hold
+   *   BytesPerPixel() * pixel_count bytes.
+   * @param pixel_count the maximum number of pixels to encode.
+   * @returns the number of complete pixels written.
+   *
+   * Only complete pixels are written, except for the WS2801 where any
+   * trailing slots update the bytes for the colors they contain.
+   */
+  static unsigned int Encode(Chip chip, const PixelFormat &format,
+                             const uint8_t *input, unsigned int length,
+                             uint8_t *output, unsigned int pixel_count);
+
+  /**
+   * Encode a single pixel, and copy it to each pixel of the output.
+   * @param chip the type of pixel.
+   * @param format the PixelFormat to use.
+   * @param input the DMX data, this must hold SlotsPerPixel() slots.
+   * @param output the memory to write the pixels to, this must hold
+   *   BytesPerPixel() * pixel_count bytes.
+   * @param pixel_count the number of pixels to write.
+   */
+  static void Fill(Chip chip, const PixelFormat &format, const uint8_t *input,
+                   uint8_t *output, unsigned int pixel_count);
+
+  /**
+   * The number of DMX slots used by each 16 bit pixel.
+   */
+  static unsigned int WideSlotsPerPixel(Chip chip) {
+    return 2 * SlotsPerPixel(chip);
+  }
+
+  /**
+   * True if the chip supports 16 bit data. Only the chips where each color
+   * is sent as a byte are supported.
+   */
+  static bool SupportsWide(Chip chip) {
+    return chip == WS2801 || chip == APA102;
+  }
+
+  /**
+   * Encode a string of pixels from 16 bit data, where each color is a pair of
+   * coarse and fine slots. Each byte is split into the integer part, and the
+   * fraction in 1/256ths, which is used for temporal dithering.
+   * @param chip the type of pixel, SupportsWide() must be true.
+   * @param format the PixelFormat to use.
+   * @param input the DMX data.
+   * @param length the number of slots of DMX data.
+   * @param output the memory to write the integer part of the pixels to, this
+   *   must hold BytesPerPixel() * pixel_count bytes.
+   * @param fraction the memory to write the fractional part to, this is the
+   *   same size as output.
+   * @param pixel_count the maximum number of pixels to encode.
+   * @returns the number of complete pixels written.
+   */
+  static unsigned int EncodeWide(Chip chip, const PixelFormat &format,
+                                 const uint8_t *input, unsigned int length,
+                                 uint8_t *output, uint8_t *fraction,
+                                 unsigned int pixel_count);
+
+  /**
+   * Apply temporal dithering to a frame. The fraction of each byte is added
+   * to an error accumulator, and the byte is rounded up each time that
+   * overflows, so over 256 frames the average is the exact level.
+   * @param input the integer part of each byte.
+   * @param fraction the fractional part of each byte.
+   * @param error the error accumulator for each byte, this is updated.
+   * @param output the bytes to send.
+   * @param length the number of bytes.
+   */
+  static void Dither(const uint8_t *input, const uint8_t *fraction,
+                     uint8_t *error, uint8_t *output, unsigned int length);
+};
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_PIXELENCODER_H_
@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelEncoderBenchmark.cpp
+ * Measure the pixel encoding throughput.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "plugins/spi/PixelEncoder.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeStamp;
+using ola::plugin::spi::COLOR_ORDER_GRB;
+using ola::plugin::spi::PixelEncoder;
+using ola::plugin::spi::PixelFormat;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(frames, f, 20000, "The number of frames to encode");
+DEFINE_s_uint32(pixels, p, 170, "The number of pixels in each frame");
+
+/*
+ * The per slot loop the APA102 personality used, for comparison.
+ */
+void EncodeWithGet(const DmxBuffer &buffer, uint8_t *output,
+                   unsigned int pixel_count) {
+  for (unsigned int i = 0; i < pixel_count; i++) {
+    const unsigned int offset = i * 3;
+    output[i * 4] = 0xFF;
+    if (buffer.Size() - offset >= 3) {
+      output[i * 4 + 1] = buffer.Get(offset + 2);
+      output[i * 4 + 2] = buffer.Get(offset + 1);
+      output[i * 4 + 3] = buffer.Get(offset);
+    }
+  }
+}
+
+// Keeps the output live, so the loops aren't optimized away.
+volatile uint8_t sink = 0;
+
+void PrintResult(const string &name, const TimeStamp &start,
+                 const TimeStamp &end) {
+  const int64_t usecs = (end - start).AsInt();
+  const double pixels = static_cast<double>(FLAGS_frames) * FLAGS_pixels;
+  cout << std::left << std::setw(24) << name << std::right << std::fixed
+       << std::setprecision(1) << std::setw(10)
+       << (usecs ? pixels / usecs : 0) << " Mpixels/s" << endl;
+}
+
+void RunGet(const vector<uint8_t> &input) {
+  DmxBuffer buffer(&input[0], FLAGS_pixels * 3);
+  vector<uint8_t> output(FLAGS_pixels * 4);
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    EncodeWithGet(buffer, &output[0], FLAGS_pixels);
+  }
+  clock.CurrentTime(&end);
+  sink = output[FLAGS_pixels];
+  PrintResult("APA102 DmxBuffer::Get()", start, end);
+}
+
+void Run(const string &name, PixelEncoder::Chip chip,
+         const PixelFormat &format, const vector<uint8_t> &input) {
+  vector<uint8_t> output(FLAGS_pixels * PixelEncoder::BytesPerPixel(chip));
+  const unsigned int length = FLAGS_pixels * PixelEncoder::SlotsPerPixel(chip);
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    PixelEncoder::Encode(chip, format, &input[0], length, &output[0],
+                         FLAGS_pixels);
+  }
+  clock.CurrentTime(&end);
+  sink = output[FLAGS_pixels];
+  PrintResult(name, start, end);
+}
+
+void RunWide(const string &name, PixelEncoder::Chip chip,
+             const PixelFormat &format, const vector<uint8_t> &input) {
+  const unsigned int bytes = FLAGS_pixels * PixelEncoder::BytesPerPixel(chip);
+  vector<uint8_t> output(bytes);
+  vector<uint8_t> fraction(bytes);
+  vector<uint8_t> error(bytes);
+  vector<uint8_t> dithered(bytes);
+  const unsigned int length =
+      FLAGS_pixels * PixelEncoder::WideSlotsPerPixel(chip);
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    PixelEncoder::EncodeWide(chip, format, &input[0], length, &output[0],
+                             &fraction[0], FLAGS_pixels);
+  }
+  clock.CurrentTime(&end);
+  PrintResult(name, start, end);
+
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_frames; i++) {
+    PixelEncoder::Dither(&output[0], &fraction[0], &error[0], &dithered[0],
+                         bytes);
+  }
+  clock.CurrentTime(&end);
+  sink = dithered[FLAGS_pixels];
+  PrintResult(name + " dither", start, end);
+}
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Measure the pixel encoding throughput.");
+
+  if (!FLAGS_pixels) {
+    cout << "--pixels must be at least 1" << endl;
+    return 1;
+  }
+
+  // Pixel strings can span more than one universe, and 16 bit pixels use 6
+  // slots.
+  vector<uint8_t> input(FLAGS_pixels * 6);
+  for (unsigned int i = 0; i < input.size(); i++) {
+    input[i] = static_cast<uint8_t>(i * 37);
+  }
+
+  PixelFormat linear;
+  PixelFormat corrected;
+  corrected.SetColorOrder(COLOR_ORDER_GRB);
+  corrected.SetCorrection(2.2, 255, 220, 200);
+
+  cout << FLAGS_frames << " frames of " << FLAGS_pixels << " pixels" << endl;
+  if (FLAGS_pixels * 3 <= ola::DMX_UNIVERSE_SIZE) {
+    RunGet(input);
+  }
+  Run("WS2801", PixelEncoder::WS2801, linear, input);
+  Run("WS2801 corrected", PixelEncoder::WS2801, corrected, input);
+  Run("LPD8806", PixelEncoder::LPD8806, linear, input);
+  Run("LPD8806 corrected", PixelEncoder::LPD8806, corrected, input);
+  Run("P9813", PixelEncoder::P9813, linear, input);
+  Run("APA102", PixelEncoder::APA102, linear, input);
+  Run("APA102 corrected", PixelEncoder::APA102, corrected, input);
+  Run("APA102 Pixel Brightness", PixelEncoder::APA102_PB, linear, input);
+  RunWide("WS2801 16 bit", PixelEncoder::WS2801, corrected, input);
+  RunWide("APA102 16 bit", PixelEncoder::APA102, corrected, input);
+  return 0;
+}
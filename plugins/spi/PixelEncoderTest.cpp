@@ -0,0 +1,364 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelEncoderTest.cpp
+ * Test fixture for the PixelEncoder.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/base/Array.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/PixelEncoder.h"
+
+using ola::plugin::spi::COLOR_ORDER_BGR;
+using ola::plugin::spi::COLOR_ORDER_GRB;
+using ola::plugin::spi::COLOR_ORDER_RGB;
+using ola::plugin::spi::ColorOrder;
+using ola::plugin::spi::ColorOrderToString;
+using ola::plugin::spi::PixelEncoder;
+using ola::plugin::spi::PixelFormat;
+using ola::plugin::spi::StringToColorOrder;
+using std::string;
+
+class PixelEncoderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelEncoderTest);
+  CPPUNIT_TEST(testColorOrder);
+  CPPUNIT_TEST(testCorrection);
+  CPPUNIT_TEST(testEncode);
+  CPPUNIT_TEST(testPartialPixels);
+  CPPUNIT_TEST(testFill);
+  CPPUNIT_TEST(testLongStrings);
+  CPPUNIT_TEST(testEncodeWide);
+  CPPUNIT_TEST(testDither);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testColorOrder();
+  void testCorrection();
+  void testEncode();
+  void testPartialPixels();
+  void testFill();
+  void testLongStrings();
+  void testEncodeWide();
+  void testDither();
+
+ private:
+  void CheckLongString(PixelEncoder::Chip chip, const PixelFormat &format);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelEncoderTest);
+
+/**
+ * Check the color orders.
+ */
+void PixelEncoderTest::testColorOrder() {
+  ColorOrder order;
+  OLA_ASSERT_TRUE(StringToColorOrder("GRB", &order));
+  OLA_ASSERT_EQ(COLOR_ORDER_GRB, order);
+  OLA_ASSERT_TRUE(StringToColorOrder("bgr", &order));
+  OLA_ASSERT_EQ(COLOR_ORDER_BGR, order);
+  OLA_ASSERT_FALSE(StringToColorOrder("", &order));
+  OLA_ASSERT_FALSE(StringToColorOrder("RGBW", &order));
+  OLA_ASSERT_FALSE(StringToColorOrder("RRB", &order));
+  OLA_ASSERT_EQ(string("GRB"), ColorOrderToString(COLOR_ORDER_GRB));
+
+  PixelFormat format;
+  OLA_ASSERT_EQ(COLOR_ORDER_RGB, format.GetColorOrder());
+  OLA_ASSERT_EQ(0u, format.Offset(PixelFormat::RED));
+  OLA_ASSERT_EQ(1u, format.Offset(PixelFormat::GREEN));
+  OLA_ASSERT_EQ(2u, format.Offset(PixelFormat::BLUE));
+
+  format.SetColorOrder(COLOR_ORDER_GRB);
+  OLA_ASSERT_EQ(COLOR_ORDER_GRB, format.GetColorOrder());
+  OLA_ASSERT_EQ(1u, format.Offset(PixelFormat::RED));
+  OLA_ASSERT_EQ(0u, format.Offset(PixelFormat::GREEN));
+  OLA_ASSERT_EQ(2u, format.Offset(PixelFormat::BLUE));
+}
+
+/**
+ * Check the gamma and white balance tables.
+ */
+void PixelEncoderTest::testCorrection() {
+  PixelFormat format;
+  OLA_ASSERT_TRUE(format.IsLinear());
+  for (unsigned int i = 0; i < 256; i++) {
+    OLA_ASSERT_EQ(i, static_cast<unsigned int>(
+        format.Table(PixelFormat::GREEN)[i]));
+  }
+
+  format.SetCorrection(1.0, 255, 128, 0);
+  OLA_ASSERT_FALSE(format.IsLinear());
+  OLA_ASSERT_EQ(255, static_cast<int>(format.Table(PixelFormat::RED)[255]));
+  OLA_ASSERT_EQ(128, static_cast<int>(format.Table(PixelFormat::GREEN)[255]));
+  OLA_ASSERT_EQ(64, static_cast<int>(format.Table(PixelFormat::GREEN)[128]));
+  OLA_ASSERT_EQ(0, static_cast<int>(format.Table(PixelFormat::BLUE)[255]));
+
+  format.SetCorrection(2.0, 255, 255, 255);
+  OLA_ASSERT_FALSE(format.IsLinear());
+  OLA_ASSERT_EQ(0, static_cast<int>(format.Table(PixelFormat::RED)[0]));
+  OLA_ASSERT_EQ(64, static_cast<int>(format.Table(PixelFormat::RED)[128]));
+  OLA_ASSERT_EQ(255, static_cast<int>(format.Table(PixelFormat::RED)[255]));
+
+  // Invalid values are linear
+  format.SetCorrection(0, 255, 255, 255);
+  OLA_ASSERT_TRUE(format.IsLinear());
+}
+
+/**
+ * Check a pixel is encoded correctly for each chip.
+ */
+void PixelEncoderTest::testEncode() {
+  PixelFormat format;
+  const uint8_t input[] = {255, 128, 1, 10};
+  uint8_t output[4];
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::WS2801, format, input,
+                                         3, output, 1));
+  const uint8_t WS2801[] = {255, 128, 1};
+  OLA_ASSERT_DATA_EQUALS(WS2801, arraysize(WS2801), output, 3);
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::LPD8806, format, input,
+                                         3, output, 1));
+  const uint8_t LPD8806[] = {0xC0, 0xFF, 0x80};
+  OLA_ASSERT_DATA_EQUALS(LPD8806, arraysize(LPD8806), output, 3);
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::P9813, format, input,
+                                         3, output, 1));
+  const uint8_t P9813[] = {0xF4, 1, 128, 255};
+  OLA_ASSERT_DATA_EQUALS(P9813, arraysize(P9813), output, 4);
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::APA102, format, input,
+                                         3, output, 1));
+  const uint8_t APA102[] = {0xFF, 1, 128, 255};
+  OLA_ASSERT_DATA_EQUALS(APA102, arraysize(APA102), output, 4);
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::APA102_PB, format,
+                                         input, 4, output, 1));
+  const uint8_t APA102_PB[] = {0xFF, 10, 1, 128};
+  OLA_ASSERT_DATA_EQUALS(APA102_PB, arraysize(APA102_PB), output, 4);
+
+  // Now try a different color order and a white balance
+  format.SetColorOrder(COLOR_ORDER_GRB);
+  format.SetCorrection(1.0, 255, 255, 128);
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::WS2801, format, input,
+                                         3, output, 1));
+  const uint8_t WS2801_GRB[] = {128, 255, 1};
+  OLA_ASSERT_DATA_EQUALS(WS2801_GRB, arraysize(WS2801_GRB), output, 3);
+
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::APA102_PB, format,
+                                         input, 4, output, 1));
+  const uint8_t APA102_PB_GRB[] = {0xFF, 5, 128, 1};
+  OLA_ASSERT_DATA_EQUALS(APA102_PB_GRB, arraysize(APA102_PB_GRB), output, 4);
+}
+
+/**
+ * Check what happens when there isn't enough data.
+ */
+void PixelEncoderTest::testPartialPixels() {
+  PixelFormat format;
+  const uint8_t input[] = {1, 2, 3, 4, 5};
+  uint8_t output[9];
+
+  // The WS2801 updates the colors we have.
+  memset(output, 0xAA, sizeof(output));
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::WS2801, format, input,
+                                         arraysize(input), output, 3));
+  const uint8_t WS2801[] = {1, 2, 3, 4, 5, 0xAA, 0xAA, 0xAA, 0xAA};
+  OLA_ASSERT_DATA_EQUALS(WS2801, arraysize(WS2801), output, sizeof(output));
+
+  memset(output, 0xAA, sizeof(output));
+  format.SetColorOrder(COLOR_ORDER_BGR);
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::WS2801, format, input,
+                                         arraysize(input), output, 3));
+  const uint8_t WS2801_BGR[] = {3, 2, 1, 0xAA, 5, 4, 0xAA, 0xAA, 0xAA};
+  OLA_ASSERT_DATA_EQUALS(WS2801_BGR, arraysize(WS2801_BGR), output,
+                         sizeof(output));
+
+  // The other chips skip partial pixels
+  memset(output, 0xAA, sizeof(output));
+  OLA_ASSERT_EQ(1u, PixelEncoder::Encode(PixelEncoder::LPD8806, format, input,
+                                         arraysize(input), output, 3));
+  const uint8_t LPD8806[] = {0x81, 0x81, 0x80, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+                             0xAA};
+  OLA_ASSERT_DATA_EQUALS(LPD8806, arraysize(LPD8806), output, sizeof(output));
+
+  // And the pixel count limits the output
+  memset(output, 0xAA, sizeof(output));
+  OLA_ASSERT_EQ(0u, PixelEncoder::Encode(PixelEncoder::APA102, format, input,
+                                         arraysize(input), output, 0));
+  OLA_ASSERT_EQ(0xAA, static_cast<int>(output[0]));
+}
+
+/**
+ * Check Fill() copies the first pixel.
+ */
+void PixelEncoderTest::testFill() {
+  PixelFormat format;
+  const uint8_t input[] = {255, 128, 1, 10, 20, 30};
+  uint8_t output[12];
+  PixelEncoder::Fill(PixelEncoder::APA102, format, input, output, 3);
+  const uint8_t APA102[] = {0xFF, 1, 128, 255, 0xFF, 1, 128, 255,
+                            0xFF, 1, 128, 255};
+  OLA_ASSERT_DATA_EQUALS(APA102, arraysize(APA102), output, sizeof(output));
+
+  memset(output, 0, sizeof(output));
+  PixelEncoder::Fill(PixelEncoder::APA102, format, input, output, 0);
+  OLA_ASSERT_EQ(0, static_cast<int>(output[0]));
+}
+
+/**
+ * Check long strings, which may be encoded with SIMD instructions, match the
+ * pixels encoded one at a time.
+ */
+void PixelEncoderTest::testLongStrings() {
+  const PixelEncoder::Chip chips[] = {
+    PixelEncoder::WS2801,
+    PixelEncoder::LPD8806,
+    PixelEncoder::P9813,
+    PixelEncoder::APA102,
+    PixelEncoder::APA102_PB,
+  };
+
+  for (unsigned int i = 0; i < arraysize(chips); i++) {
+    PixelFormat format;
+    CheckLongString(chips[i], format);
+    format.SetColorOrder(COLOR_ORDER_BGR);
+    CheckLongString(chips[i], format);
+    format.SetColorOrder(COLOR_ORDER_GRB);
+    format.SetCorrection(2.2, 255, 200, 180);
+    CheckLongString(chips[i], format);
+  }
+}
+
+/**
+ * Check 16 bit pixels are split into the integer and fractional parts.
+ */
+void PixelEncoderTest::testEncodeWide() {
+  PixelFormat format;
+  const uint8_t input[] = {0xff, 0xff, 0x80, 0, 0, 0,
+                           0, 0x80, 0x12, 0x34, 1, 0};
+  uint8_t output[6];
+  uint8_t fraction[6];
+  OLA_ASSERT_EQ(6u, PixelEncoder::WideSlotsPerPixel(PixelEncoder::WS2801));
+  OLA_ASSERT_EQ(2u, PixelEncoder::EncodeWide(PixelEncoder::WS2801, format,
+                                             input, sizeof(input), output,
+                                             fraction, 2));
+  const uint8_t WS2801[] = {255, 127, 0, 0, 18, 0};
+  const uint8_t WS2801_FRACTION[] = {0, 128, 0, 127, 33, 255};
+  OLA_ASSERT_DATA_EQUALS(WS2801, arraysize(WS2801), output, sizeof(output));
+  OLA_ASSERT_DATA_EQUALS(WS2801_FRACTION, arraysize(WS2801_FRACTION),
+                         fraction, sizeof(fraction));
+
+  // Only whole pixels are encoded.
+  OLA_ASSERT_EQ(1u, PixelEncoder::EncodeWide(PixelEncoder::WS2801, format,
+                                             input, sizeof(input) - 1, output,
+                                             fraction, 2));
+
+  // The gamma correction is applied to the 16 bit value. 0x1000 is 1/16, so
+  // with a gamma of 2 it's 1/256 of full scale, which would round down to 0
+  // or up to 1 with 8 bits.
+  format.SetColorOrder(COLOR_ORDER_GRB);
+  format.SetCorrection(2.0, 255, 255, 255);
+  const uint8_t gamma_input[] = {0x10, 0, 0xff, 0xff, 0, 0};
+  OLA_ASSERT_EQ(1u, PixelEncoder::EncodeWide(PixelEncoder::APA102, format,
+                                             gamma_input, sizeof(gamma_input),
+                                             output, fraction, 1));
+  const uint8_t APA102[] = {0xFF, 0, 0, 255};
+  const uint8_t APA102_FRACTION[] = {0, 0, 255, 0};
+  OLA_ASSERT_DATA_EQUALS(APA102, arraysize(APA102), output, 4);
+  OLA_ASSERT_DATA_EQUALS(APA102_FRACTION, arraysize(APA102_FRACTION),
+                         fraction, 4);
+
+  OLA_ASSERT_FALSE(PixelEncoder::SupportsWide(PixelEncoder::LPD8806));
+  OLA_ASSERT_EQ(0u, PixelEncoder::EncodeWide(PixelEncoder::LPD8806, format,
+                                             input, sizeof(input), output,
+                                             fraction, 2));
+}
+
+/**
+ * Check the average of the dithered bytes is the exact level.
+ */
+void PixelEncoderTest::testDither() {
+  // Long enough for the SIMD loop, with some left over.
+  const unsigned int length = 20;
+  uint8_t input[length];
+  uint8_t fraction[length];
+  uint8_t error[length];
+  uint8_t output[length];
+  unsigned int sums[length];
+  for (unsigned int i = 0; i < length; i++) {
+    input[i] = static_cast<uint8_t>(i * 10);
+    fraction[i] = static_cast<uint8_t>(i * 13);
+    error[i] = 0;
+    sums[i] = 0;
+  }
+
+  for (unsigned int frame = 0; frame < 256; frame++) {
+    PixelEncoder::Dither(input, fraction, error, output, length);
+    for (unsigned int i = 0; i < length; i++) {
+      OLA_ASSERT_TRUE(output[i] == input[i] || output[i] == input[i] + 1);
+      sums[i] += output[i];
+    }
+  }
+  for (unsigned int i = 0; i < length; i++) {
+    OLA_ASSERT_EQ(input[i] * 256u + fraction[i], sums[i]);
+    OLA_ASSERT_EQ(0, static_cast<int>(error[i]));
+  }
+
+  // The fraction carries into the integer part when the error overflows.
+  const uint8_t high_input[] = {254, 255, 10};
+  const uint8_t high_fraction[] = {255, 0, 128};
+  uint8_t high_error[] = {1, 255, 127};
+  PixelEncoder::Dither(high_input, high_fraction, high_error, output, 3);
+  const uint8_t EXPECTED[] = {255, 255, 10};
+  const uint8_t EXPECTED_ERROR[] = {0, 255, 255};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), output, 3);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED_ERROR, arraysize(EXPECTED_ERROR),
+                         high_error, arraysize(high_error));
+}
+
+void PixelEncoderTest::CheckLongString(PixelEncoder::Chip chip,
+                                       const PixelFormat &format) {
+  const unsigned int slots = PixelEncoder::SlotsPerPixel(chip);
+  const unsigned int bytes = PixelEncoder::BytesPerPixel(chip);
+
+  // Try each length, so the SIMD loops finish in different places.
+  for (unsigned int pixel_count = 1; pixel_count < 100; pixel_count++) {
+    uint8_t input[512];
+    for (unsigned int i = 0; i < sizeof(input); i++) {
+      input[i] = static_cast<uint8_t>(i * 37 + pixel_count);
+    }
+    uint8_t output[400];
+    uint8_t expected[400];
+    memset(output, 0, sizeof(output));
+    memset(expected, 0, sizeof(expected));
+
+    OLA_ASSERT_EQ(pixel_count,
+                  PixelEncoder::Encode(chip, format, input,
+                                       pixel_count * slots, output,
+                                       pixel_count));
+    for (unsigned int i = 0; i < pixel_count; i++) {
+      PixelEncoder::Encode(chip, format, input + i * slots, slots,
+                           expected + i * bytes, 1);
+    }
+    OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), output,
+                           sizeof(output));
+  }
+}
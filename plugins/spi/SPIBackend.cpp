@@ -26,7 +26,6 @@
 #include <string.h>
 #include <sys/ioctl.h>
 
-#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -35,6 +34,7 @@
 #include "ola/io/IOUtils.h"
 #include "ola/network/SocketCloser.h"
 #include "ola/stl/STLUtils.h"
+#include "plugins/spi/PixelEncoder.h"
 #include "plugins/spi/SPIBackend.h"
 
 namespace ola {
@@ -48,50 +48,54 @@ using std::vector;
 const char SPIBackendInterface::SPI_DROP_VAR[] = "spi-drops";
 const char SPIBackendInterface::SPI_DROP_VAR_KEY[] = "device";
 
-uint8_t *HardwareBackend::OutputData::Resize(unsigned int length) {
-  if (length < m_size) {
-    m_size = length;
-    return m_data;
-  } else if (length == m_size) {
-    return m_data;
-  }
-
-  if (length <= m_actual_size) {
-    m_size = length;
-    return m_data;
-  }
+namespace {
 
-  delete[] m_data;
-  m_data = new uint8_t[length];
-  if (m_data) {
-    m_size = m_data ? length : 0;
-    m_actual_size = m_size;
-    memset(m_data, 0, length);
+TimeInterval RefreshInterval(unsigned int refresh_rate) {
+  if (!refresh_rate) {
+    return TimeInterval();
   }
-  return m_data;
-}
-
-void HardwareBackend::OutputData::SetPending() {
-  m_write_pending = true;
+  return TimeInterval(static_cast<int64_t>(1000000 / refresh_rate));
 }
 
-void HardwareBackend::OutputData::SetLatchBytes(unsigned int latch_bytes) {
-  m_latch_bytes = latch_bytes;
+/**
+ * Wait until either a frame is pending, or the refresh time has passed.
+ * @returns true if the refresh time passed.
+ */
+bool WaitForFrame(ola::thread::ConditionVariable *cond_var,
+                  ola::thread::Mutex *mutex, const bool &pending,
+                  const bool &exit, const TimeInterval &refresh_interval,
+                  const TimeStamp &next_refresh) {
+  while (!pending && !exit) {
+    if (refresh_interval.IsZero()) {
+      cond_var->Wait(mutex);
+    } else if (!cond_var->TimedWait(mutex, next_refresh)) {
+      return true;
+    }
+  }
+  return false;
 }
-
-HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
-    const HardwareBackend::OutputData &other) {
-  if (this != &other) {
-    uint8_t *data = Resize(other.m_size + other.m_latch_bytes);
-    if (data) {
-      memcpy(data, other.m_data, other.m_size);
-      memset(data + other.m_size, 0, other.m_latch_bytes);
-      m_write_pending = true;
-    } else {
-      m_write_pending = false;
+}  // namespace
+
+const uint8_t *OutputDither::Render(const TripleBuffer &buffer) {
+  const uint8_t *fraction = buffer.Fraction();
+  const unsigned int length = buffer.Length();
+  if (!fraction || !length) {
+    return buffer.Data();
+  }
+
+  const unsigned int size = length + buffer.LatchBytes();
+  if (m_error.size() != length || m_output.size() != size) {
+    // Start each byte at a different point, so the bytes with the same
+    // fraction don't all change on the same frame.
+    m_error.resize(length);
+    for (unsigned int i = 0; i < length; i++) {
+      m_error[i] = static_cast<uint8_t>(i * 159);
     }
+    m_output.assign(size, 0);
   }
-  return *this;
+  PixelEncoder::Dither(buffer.Data(), fraction, &m_error[0], &m_output[0],
+                       length);
+  return &m_output[0];
 }
 
 HardwareBackend::HardwareBackend(const Options &options,
@@ -100,9 +104,14 @@ HardwareBackend::HardwareBackend(const Options &options,
     : m_spi_writer(writer),
       m_drop_map(NULL),
       m_output_count(1 << options.gpio_pins.size()),
+      m_frame_pending(false),
       m_exit(false),
+      m_refresh_interval(RefreshInterval(options.refresh_rate)),
+      m_dither(m_output_count),
       m_gpio_pins(options.gpio_pins) {
-  SetupOutputs(&m_output_data);
+  for (unsigned int i = 0; i < m_output_count; i++) {
+    m_outputs.push_back(new TripleBuffer());
+  }
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
@@ -120,7 +129,7 @@ HardwareBackend::~HardwareBackend() {
   m_cond_var.Signal();
   Join();
 
-  STLDeleteElements(&m_output_data);
+  STLDeleteElements(&m_outputs);
   CloseGPIOFDs();
 }
 
@@ -142,16 +151,17 @@ uint8_t *HardwareBackend::Checkout(uint8_t output_id,
   if (output_id >= m_output_count) {
     return NULL;
   }
+  return m_outputs[output_id]->Checkout(length, latch_bytes);
+}
 
-  m_mutex.Lock();
-  uint8_t *output = m_output_data[output_id]->Resize(length);
-  if (!output) {
-    m_mutex.Unlock();
+uint8_t *HardwareBackend::CheckoutDithered(uint8_t output_id,
+                                           unsigned int length,
+                                           unsigned int latch_bytes,
+                                           uint8_t **fraction) {
+  if (output_id >= m_output_count) {
+    return NULL;
   }
-  m_output_data[output_id]->SetLatchBytes(latch_bytes);
-  // We return with the Mutex locked, the caller must then call Commit()
-  // coverity[LOCK]
-  return output;
+  return m_outputs[output_id]->Checkout(length, latch_bytes, fraction);
 }
 
 void HardwareBackend::Commit(uint8_t output) {
@@ -159,72 +169,47 @@ void HardwareBackend::Commit(uint8_t output) {
     return;
   }
 
-  OutputData *output_data = m_output_data[output];
-  if (output_data->IsPending() && m_drop_map) {
-    // There was already another write pending which we're now stomping on
+  if (!m_outputs[output]->Commit() && m_drop_map) {
+    // The writer never saw the previous frame.
     (*m_drop_map)[m_spi_writer->DevicePath()]++;
   }
-  output_data->SetPending();
-  m_mutex.Unlock();
+
+  {
+    MutexLocker lock(&m_mutex);
+    m_frame_pending = true;
+  }
   m_cond_var.Signal();
 }
 
 void *HardwareBackend::Run() {
-  Outputs outputs;
-  SetupOutputs(&outputs);
-
+  TimeStamp next_refresh;
   while (true) {
-    m_mutex.Lock();
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
-
-    bool action_pending = false;
-    Outputs::const_iterator iter = m_output_data.begin();
-    for (; iter != m_output_data.end(); ++iter) {
-      if ((*iter)->IsPending()) {
-        action_pending = true;
-        break;
-      }
-    }
-    if (!action_pending) {
-      m_cond_var.Wait(&m_mutex);
-    }
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
-
-    for (unsigned int i = 0; i < m_output_data.size(); i++) {
-      if (m_output_data[i]->IsPending()) {
-        // take a copy
-        *outputs[i] = *m_output_data[i];
-        m_output_data[i]->ResetPending();
+    bool refresh;
+    {
+      MutexLocker lock(&m_mutex);
+      refresh = WaitForFrame(&m_cond_var, &m_mutex, m_frame_pending, m_exit,
+                             m_refresh_interval, next_refresh);
+      if (m_exit) {
+        return NULL;
       }
+      m_frame_pending = false;
     }
-    m_mutex.Unlock();
-
-    for (unsigned int i = 0; i < outputs.size(); i++) {
-      if (outputs[i]->IsPending()) {
-        WriteOutput(i, outputs[i]);
-        outputs[i]->ResetPending();
+    // Like the SoftwareBackend, the refresh interval runs from the start of
+    // the writes.
+    m_clock.CurrentTime(&next_refresh);
+    next_refresh += m_refresh_interval;
+
+    // Dithered outputs are resent on each refresh, even without a new frame.
+    for (unsigned int i = 0; i < m_outputs.size(); i++) {
+      if (m_outputs[i]->Fetch() || (refresh && m_outputs[i]->Fraction())) {
+        WriteOutput(i, *m_outputs[i]);
       }
     }
   }
 }
 
-void HardwareBackend::SetupOutputs(Outputs *outputs) {
-  for (unsigned int i = 0; i < m_output_count; i++) {
-    outputs->push_back(new OutputData());
-  }
-}
-
-void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
+void HardwareBackend::WriteOutput(uint8_t output_id,
+                                  const TripleBuffer &output) {
   const string on("1");
   const string off("0");
 
@@ -247,7 +232,8 @@ void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
     }
   }
 
-  m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  m_spi_writer->WriteSPIData(m_dither[output_id].Render(output),
+                             output.Length() + output.LatchBytes());
 }
 
 bool HardwareBackend::SetupGPIO() {
@@ -310,8 +296,11 @@ SoftwareBackend::SoftwareBackend(const Options &options,
       m_sync_output(options.sync_output),
       m_output_sizes(options.outputs, 0),
       m_latch_bytes(options.outputs, 0),
-      m_output(NULL),
-      m_length(0) {
+      m_refresh_interval(RefreshInterval(options.refresh_rate)),
+      m_dither(options.outputs) {
+  for (unsigned int i = 0; i < options.outputs; i++) {
+    m_outputs.push_back(new TripleBuffer());
+  }
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
@@ -328,7 +317,7 @@ SoftwareBackend::~SoftwareBackend() {
   m_cond_var.Signal();
   Join();
 
-  delete[] m_output;
+  STLDeleteElements(&m_outputs);
 }
 
 bool SoftwareBackend::Init() {
@@ -342,107 +331,101 @@ bool SoftwareBackend::Init() {
   return true;
 }
 
-uint8_t *SoftwareBackend::Checkout(uint8_t output,
-                                   unsigned int length,
-                                   unsigned int latch_bytes) {
-  if (output >= m_output_sizes.size()) {
+uint8_t *SoftwareBackend::CheckoutFrame(uint8_t output,
+                                        unsigned int length,
+                                        unsigned int latch_bytes,
+                                        uint8_t **fraction) {
+  if (output >= m_outputs.size()) {
     OLA_WARN << "Invalid SPI output " << static_cast<int>(output);
     return NULL;
   }
 
-  m_mutex.Lock();
-
-  unsigned int leading = 0;
-  unsigned int trailing = 0;
-  for (uint8_t i = 0; i < m_output_sizes.size(); i++) {
-    if (i < output) {
-      leading += m_output_sizes[i];
-    } else if (i > output) {
-      trailing += m_output_sizes[i];
+  uint8_t *data = m_outputs[output]->Checkout(length, latch_bytes, fraction);
+  if (length != m_output_sizes[output] ||
+      latch_bytes != m_latch_bytes[output]) {
+    // The layout of the message changed, so start from a blank frame.
+    memset(data, 0, length);
+    if (fraction) {
+      memset(*fraction, 0, length);
     }
-  }
-
-  m_latch_bytes[output] = latch_bytes;
-  const unsigned int total_latch_bytes = std::accumulate(
-      m_latch_bytes.begin(), m_latch_bytes.end(), 0);
-  const unsigned int required_size = (
-      leading + length + trailing + total_latch_bytes);
-
-  // Check if the current buffer is large enough to hold our data.
-  if (required_size != m_length) {
-    // The length changed
-    uint8_t *new_output = new uint8_t[required_size];
-    memcpy(new_output, m_output, leading);
-    memset(new_output + leading, 0, length);
-    memcpy(new_output + leading + length, m_output + leading, trailing);
-    memset(new_output + leading + length + trailing, 0, total_latch_bytes);
-    delete[] m_output;
-    m_output = new_output;
-    m_length = required_size;
     m_output_sizes[output] = length;
+    m_latch_bytes[output] = latch_bytes;
   }
-  return m_output + leading;
+  return data;
 }
 
 void SoftwareBackend::Commit(uint8_t output) {
-  if (output >= m_output_sizes.size()) {
+  if (output >= m_outputs.size()) {
     OLA_WARN << "Invalid SPI output " << static_cast<int>(output);
     return;
   }
 
-  bool should_write = m_sync_output < 0 || output == m_sync_output;
-  if (should_write) {
+  m_outputs[output]->Commit();
+  if (m_sync_output >= 0 && output != m_sync_output) {
+    return;
+  }
+
+  {
+    MutexLocker lock(&m_mutex);
     if (m_write_pending && m_drop_map) {
       // There was already another write pending which we're now stomping on
       (*m_drop_map)[m_spi_writer->DevicePath()]++;
     }
-    m_write_pending = should_write;
-  }
-  m_mutex.Unlock();
-  if (should_write) {
-    m_cond_var.Signal();
+    m_write_pending = true;
   }
+  m_cond_var.Signal();
 }
 
 void *SoftwareBackend::Run() {
-  uint8_t *output_data = NULL;
-  unsigned int length = 0;
+  vector<SPITransfer> transfers;
+  vector<uint8_t> latch;
+  TimeStamp next_refresh;
 
   while (true) {
-    m_mutex.Lock();
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      delete output_data;
-      return NULL;
+    bool refresh;
+    {
+      MutexLocker lock(&m_mutex);
+      refresh = WaitForFrame(&m_cond_var, &m_mutex, m_write_pending, m_exit,
+                             m_refresh_interval, next_refresh);
+      if (m_exit) {
+        return NULL;
+      }
+      m_write_pending = false;
     }
-
-    if (!m_write_pending) {
-      m_cond_var.Wait(&m_mutex);
+    m_clock.CurrentTime(&next_refresh);
+    next_refresh += m_refresh_interval;
+
+    // Each output is a separate transfer, followed by the latch bytes for all
+    // of them. These go out in a single message so chip select is held for
+    // the entire frame.
+    transfers.clear();
+    unsigned int latch_bytes = 0;
+    bool dithered = false;
+    for (unsigned int i = 0; i < m_outputs.size(); i++) {
+      TripleBuffer *output = m_outputs[i];
+      output->Fetch();
+      if (output->Length()) {
+        transfers.push_back(SPITransfer(m_dither[i].Render(*output),
+                                        output->Length()));
+      }
+      dithered |= output->Fraction() != NULL;
+      latch_bytes += output->LatchBytes();
     }
 
-    if (m_exit) {
-      m_mutex.Unlock();
-      delete[] output_data;
-      return NULL;
+    if (refresh && !dithered) {
+      // Nothing changes between refreshes.
+      continue;
     }
 
-    bool write_pending = m_write_pending;
-    m_write_pending = false;
-    if (write_pending) {
-      if (length < m_length) {
-        delete[] output_data;
-        output_data = new uint8_t[m_length];
-        length = m_length;
+    if (latch_bytes) {
+      if (latch.size() < latch_bytes) {
+        latch.resize(latch_bytes, 0);
       }
-      // TODO(simon) Add an actual size here
-      length = m_length;
-      memcpy(output_data, m_output, m_length);
+      transfers.push_back(SPITransfer(&latch[0], latch_bytes));
     }
-    m_mutex.Unlock();
 
-    if (write_pending) {
-      m_spi_writer->WriteSPIData(output_data, length);
+    if (!transfers.empty()) {
+      m_spi_writer->WriteSPITransfers(&transfers[0], transfers.size());
     }
   }
 }
@@ -457,20 +440,28 @@ FakeSPIBackend::~FakeSPIBackend() {
   STLDeleteElements(&m_outputs);
 }
 
-uint8_t *FakeSPIBackend::Checkout(uint8_t output_id,
-                                  unsigned int length,
-                                  unsigned int latch_bytes) {
+uint8_t *FakeSPIBackend::CheckoutFrame(uint8_t output_id,
+                                       unsigned int length,
+                                       unsigned int latch_bytes,
+                                       uint8_t **fraction) {
   if (output_id >= m_outputs.size()) {
     return NULL;
   }
 
   Output *output = m_outputs[output_id];
 
-  if (output->length != length + latch_bytes) {
+  // The fraction follows the data and latch bytes.
+  const unsigned int size = length + latch_bytes + (fraction ? length : 0);
+  if (output->length != length + latch_bytes || output->size != size) {
     delete[] output->data;
-    output->data = new uint8_t[length + latch_bytes];
-    memset(output->data, 0, length + latch_bytes);
+    output->data = new uint8_t[size];
+    memset(output->data, 0, size);
     output->length = length + latch_bytes;
+    output->size = size;
+  }
+  output->fraction = fraction ? output->data + output->length : NULL;
+  if (fraction) {
+    *fraction = output->fraction;
   }
   return output->data;
 }
@@ -492,6 +483,13 @@ const uint8_t *FakeSPIBackend::GetData(uint8_t output_id,
   return output->data;
 }
 
+const uint8_t *FakeSPIBackend::GetFraction(uint8_t output_id) {
+  if (output_id >= m_outputs.size()) {
+    return NULL;
+  }
+  return m_outputs[output_id]->fraction;
+}
+
 
 unsigned int FakeSPIBackend::Writes(uint8_t output) const {
   if (output >= m_outputs.size()) {
@@ -23,12 +23,14 @@
 #define PLUGINS_SPI_SPIBACKEND_H_
 
 #include <stdint.h>
+#include <ola/Clock.h>
 #include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
 #include <string>
 #include <vector>
 
 #include "plugins/spi/SPIWriter.h"
+#include "plugins/spi/TripleBuffer.h"
 
 namespace ola {
 namespace plugin {
@@ -36,6 +38,8 @@ namespace spi {
 
 /**
  * The interface for all SPI Backends.
+ *
+ * Checkout() and Commit() must be called from a single thread.
  */
 class SPIBackendInterface {
  public:
@@ -45,6 +49,23 @@ class SPIBackendInterface {
   virtual uint8_t *Checkout(uint8_t output,
                             unsigned int length,
                             unsigned int latch_bytes) = 0;
+
+  /**
+   * Checkout a frame which is temporally dithered. As well as the data, the
+   * frame has the fractional part of each byte, and the backend rounds each
+   * byte up or down on every write so the average is the exact level.
+   * @param output the output to checkout.
+   * @param length the size of the frame.
+   * @param latch_bytes the number of zero bytes to send after the frame.
+   * @param fraction set to the fractional part of the frame, which is length
+   *   bytes.
+   * @returns the integer part of the frame.
+   */
+  virtual uint8_t *CheckoutDithered(uint8_t output,
+                                    unsigned int length,
+                                    unsigned int latch_bytes,
+                                    uint8_t **fraction) = 0;
+
   virtual void Commit(uint8_t output) = 0;
 
   virtual std::string DevicePath() const = 0;
@@ -57,6 +78,27 @@ class SPIBackendInterface {
 };
 
 
+/**
+ * The temporal dithering state for an output. This is only used by the
+ * writer thread.
+ */
+class OutputDither {
+ public:
+  OutputDither() {}
+
+  /**
+   * Render the front frame of a buffer.
+   * @returns the data to write, which is followed by the latch bytes. This is
+   *   the frame itself if it isn't dithered.
+   */
+  const uint8_t *Render(const TripleBuffer &buffer);
+
+ private:
+  std::vector<uint8_t> m_error;
+  std::vector<uint8_t> m_output;
+};
+
+
 /**
  * A HardwareBackend which uses GPIO pins and an external de-multiplexer
  */
@@ -67,6 +109,11 @@ class HardwareBackend : public ola::thread::Thread,
     // Which GPIO bits to use to select the output. The number of outputs
     // will be 2 ** gpio_pins.size();
     std::vector<uint16_t> gpio_pins;
+    // How often to resend dithered outputs when there are no new frames, in
+    // Hz. 0 only writes new frames.
+    unsigned int refresh_rate;
+
+    Options() : refresh_rate(0) {}
   };
 
   HardwareBackend(const Options &options,
@@ -83,6 +130,10 @@ class HardwareBackend : public ola::thread::Thread,
   uint8_t *Checkout(uint8_t output,
                     unsigned int length,
                     unsigned int latch_bytes);
+  uint8_t *CheckoutDithered(uint8_t output,
+                            unsigned int length,
+                            unsigned int latch_bytes,
+                            uint8_t **fraction);
   void Commit(uint8_t output);
 
   std::string DevicePath() const { return m_spi_writer->DevicePath(); }
@@ -91,65 +142,37 @@ class HardwareBackend : public ola::thread::Thread,
   void* Run();
 
  private:
-  class OutputData {
-   public:
-    OutputData()
-        : m_data(NULL),
-          m_write_pending(false),
-          m_size(0),
-          m_actual_size(0),
-          m_latch_bytes(0) {
-    }
-
-    ~OutputData() { delete[] m_data; }
-
-    uint8_t *Resize(unsigned int length);
-    void SetLatchBytes(unsigned int latch_bytes);
-    void SetPending();
-    bool IsPending() const { return m_write_pending; }
-    void ResetPending() { m_write_pending = false; }
-    const uint8_t *GetData() const { return m_data; }
-    unsigned int Size() const { return m_size; }
-
-    OutputData& operator=(const OutputData &other);
-
-   private:
-    uint8_t *m_data;
-    bool m_write_pending;
-    unsigned int m_size;
-    unsigned int m_actual_size;
-    unsigned int m_latch_bytes;
-
-    OutputData(const OutputData&);
-  };
-
   typedef std::vector<int> GPIOFds;
-  typedef std::vector<OutputData*> Outputs;
+  typedef std::vector<TripleBuffer*> Outputs;
 
   SPIWriterInterface *m_spi_writer;
   UIntMap *m_drop_map;
   const uint8_t m_output_count;
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
-  bool m_exit;
+  bool m_frame_pending;  // GUARDED_BY(m_mutex)
+  bool m_exit;  // GUARDED_BY(m_mutex)
 
-  Outputs m_output_data;
+  Outputs m_outputs;
+  const TimeInterval m_refresh_interval;
+  // Only used by the writer thread.
+  std::vector<OutputDither> m_dither;
+  Clock m_clock;
 
   // GPIO members
   GPIOFds m_gpio_fds;
   const std::vector<uint16_t> m_gpio_pins;
   std::vector<bool> m_gpio_pin_state;
 
-  void SetupOutputs(Outputs *outputs);
-  void WriteOutput(uint8_t output_id, OutputData *output);
+  void WriteOutput(uint8_t output_id, const TripleBuffer &output);
   bool SetupGPIO();
   void CloseGPIOFDs();
 };
 
 
 /**
- * An SPI Backend which uses a software multipliexer. This accumulates all data
- * into a single buffer and then writes it to the SPI bus.
+ * An SPI Backend which uses a software multipliexer. This writes the data for
+ * all outputs to the SPI bus as a single message.
  */
 class SoftwareBackend : public SPIBackendInterface,
                         public ola::thread::Thread {
@@ -165,8 +188,13 @@ class SoftwareBackend : public SPIBackendInterface,
      * If set to -1, we perform an SPI write on each update.
      */
     int16_t sync_output;
+    /*
+     * How often to resend the message when it contains dithered outputs, in
+     * Hz. 0 only writes new frames.
+     */
+    unsigned int refresh_rate;
 
-    Options() : outputs(1), sync_output(0) {}
+    Options() : outputs(1), sync_output(0), refresh_rate(0) {}
   };
 
   SoftwareBackend(const Options &options,
@@ -182,7 +210,17 @@ class SoftwareBackend : public SPIBackendInterface,
 
   uint8_t *Checkout(uint8_t output,
                     unsigned int length,
-                    unsigned int latch_bytes);
+                    unsigned int latch_bytes) {
+    return CheckoutFrame(output, length, latch_bytes, NULL);
+  }
+
+  uint8_t *CheckoutDithered(uint8_t output,
+                            unsigned int length,
+                            unsigned int latch_bytes,
+                            uint8_t **fraction) {
+    return CheckoutFrame(output, length, latch_bytes, fraction);
+  }
+
   void Commit(uint8_t output);
 
   std::string DevicePath() const { return m_spi_writer->DevicePath(); }
@@ -195,14 +233,23 @@ class SoftwareBackend : public SPIBackendInterface,
   UIntMap *m_drop_map;
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
-  bool m_write_pending;
-  bool m_exit;
+  bool m_write_pending;  // GUARDED_BY(m_mutex)
+  bool m_exit;  // GUARDED_BY(m_mutex)
 
   const int16_t m_sync_output;
+  std::vector<TripleBuffer*> m_outputs;
+  // The last size checked out for each output, only used by the producer.
   std::vector<unsigned int> m_output_sizes;
   std::vector<unsigned int> m_latch_bytes;
-  uint8_t *m_output;
-  unsigned int m_length;
+  const TimeInterval m_refresh_interval;
+  // Only used by the writer thread.
+  std::vector<OutputDither> m_dither;
+  Clock m_clock;
+
+  uint8_t *CheckoutFrame(uint8_t output,
+                         unsigned int length,
+                         unsigned int latch_bytes,
+                         uint8_t **fraction);
 };
 
 
@@ -221,10 +268,21 @@ class FakeSPIBackend : public SPIBackendInterface {
 
   uint8_t *Checkout(uint8_t output,
                     unsigned int length,
-                    unsigned int latch_bytes);
+                    unsigned int latch_bytes) {
+    return CheckoutFrame(output, length, latch_bytes, NULL);
+  }
+
+  uint8_t *CheckoutDithered(uint8_t output,
+                            unsigned int length,
+                            unsigned int latch_bytes,
+                            uint8_t **fraction) {
+    return CheckoutFrame(output, length, latch_bytes, fraction);
+  }
 
   void Commit(uint8_t output);
   const uint8_t *GetData(uint8_t output, unsigned int *length);
+  // Returns NULL unless the last checkout was dithered.
+  const uint8_t *GetFraction(uint8_t output);
 
   std::string DevicePath() const { return "/dev/test"; }
 
@@ -235,16 +293,23 @@ class FakeSPIBackend : public SPIBackendInterface {
  private:
   class Output {
    public:
-    Output() : data(NULL), length(0), writes(0) {}
+    Output() : data(NULL), fraction(NULL), length(0), size(0), writes(0) {}
     ~Output() { delete[] data; }
 
     uint8_t *data;
+    uint8_t *fraction;
     unsigned int length;
+    unsigned int size;
     unsigned int writes;
   };
 
   typedef std::vector<Output*> Outputs;
   Outputs m_outputs;
+
+  uint8_t *CheckoutFrame(uint8_t output,
+                         unsigned int length,
+                         unsigned int latch_bytes,
+                         uint8_t **fraction);
 };
 }  // namespace spi
 }  // namespace plugin
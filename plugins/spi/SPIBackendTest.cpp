@@ -31,6 +31,8 @@
 
 using ola::DmxBuffer;
 using ola::ExportMap;
+using ola::TimeInterval;
+using ola::TimeStamp;
 using ola::plugin::spi::FakeSPIWriter;
 using ola::plugin::spi::HardwareBackend;
 using ola::plugin::spi::SoftwareBackend;
@@ -40,9 +42,14 @@ using ola::UIntMap;
 class SPIBackendTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SPIBackendTest);
   CPPUNIT_TEST(testHardwareDrops);
+  CPPUNIT_TEST(testHardwareNewestFrame);
+  CPPUNIT_TEST(testHardwareDithering);
   CPPUNIT_TEST(testHardwareVariousFrameLengths);
   CPPUNIT_TEST(testInvalidOutputs);
   CPPUNIT_TEST(testSoftwareDrops);
+  CPPUNIT_TEST(testSoftwareSlowWriter);
+  CPPUNIT_TEST(testSoftwareMultipleOutputs);
+  CPPUNIT_TEST(testSoftwareRefresh);
   CPPUNIT_TEST(testSoftwareVariousFrameLengths);
   CPPUNIT_TEST_SUITE_END();
 
@@ -59,9 +66,14 @@ class SPIBackendTest: public CppUnit::TestFixture {
                     unsigned int latch_bytes = 0);
 
   void testHardwareDrops();
+  void testHardwareNewestFrame();
+  void testHardwareDithering();
   void testHardwareVariousFrameLengths();
   void testInvalidOutputs();
   void testSoftwareDrops();
+  void testSoftwareSlowWriter();
+  void testSoftwareMultipleOutputs();
+  void testSoftwareRefresh();
   void testSoftwareVariousFrameLengths();
 
  private:
@@ -76,6 +88,9 @@ class SPIBackendTest: public CppUnit::TestFixture {
   static const uint8_t EXPECTED2[];
   static const uint8_t EXPECTED3[];
   static const uint8_t EXPECTED4[];
+  static const uint8_t EXPECTED5[];
+  static const uint8_t DITHER_DATA[];
+  static const uint8_t DITHER_FRACTION[];
   static const char DEVICE_NAME[];
   static const char SPI_DROP_VAR[];
   static const char SPI_DROP_VAR_KEY[];
@@ -112,6 +127,17 @@ const uint8_t SPIBackendTest::EXPECTED4[] = {
   0, 0, 0, 0
 };
 
+const uint8_t SPIBackendTest::EXPECTED5[] = {
+  1, 2, 3, 4, 5, 6, 7, 8, 9, 0,
+  0xa, 0xb, 0xc, 0xd, 0xe, 0xf,
+  1, 2, 3, 4, 5, 6, 7, 8, 9, 0,
+  0, 0, 0, 0, 0, 0
+};
+
+const uint8_t SPIBackendTest::DITHER_DATA[] = {10, 20, 254, 0};
+
+const uint8_t SPIBackendTest::DITHER_FRACTION[] = {64, 0, 255, 128};
+
 const char SPIBackendTest::DEVICE_NAME[] = "Fake Device";
 const char SPIBackendTest::SPI_DROP_VAR[] = "spi-drops";
 const char SPIBackendTest::SPI_DROP_VAR_KEY[] = "device";
@@ -172,6 +198,72 @@ void SPIBackendTest::testHardwareDrops() {
   OLA_ASSERT_EQ(2u, m_writer.WriteCount());
 }
 
+/**
+ * Check that once the writer is free it sends the most recent frame.
+ */
+void SPIBackendTest::testHardwareNewestFrame() {
+  HardwareBackend backend(HardwareBackend::Options(), &m_writer,
+                          &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  m_writer.BlockWriter();
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1),
+                          arraysize(DATA1)));
+  m_writer.WaitForWrite();
+
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1),
+                          arraysize(DATA1)));
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA3, arraysize(DATA3),
+                          arraysize(DATA3)));
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA2, arraysize(DATA2),
+                          arraysize(DATA2)));
+  OLA_ASSERT_EQ(2u, DropCount());
+  m_writer.UnblockWriter();
+
+  OLA_ASSERT(m_writer.WaitForWriteCount(2, TimeInterval(5, 0)));
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA2, arraysize(DATA2));
+
+  // Every frame was either written or dropped.
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1),
+                          arraysize(DATA1)));
+  OLA_ASSERT(m_writer.WaitForWriteCount(3, TimeInterval(5, 0)));
+  OLA_ASSERT_EQ(5u, m_writer.WriteCount() + DropCount());
+}
+
+/**
+ * Check that dithered frames round each byte up or down on every write.
+ */
+void SPIBackendTest::testHardwareDithering() {
+  HardwareBackend backend(HardwareBackend::Options(), &m_writer,
+                          &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  // The error for each byte starts at a different point, the fourth byte
+  // starts at 221.
+  const uint8_t expected[][6] = {
+    {10, 20, 255, 1, 0, 0},
+    {10, 20, 255, 0, 0, 0},
+    {10, 20, 255, 1, 0, 0},
+    {11, 20, 255, 0, 0, 0},
+  };
+
+  for (unsigned int i = 0; i < arraysize(expected); i++) {
+    uint8_t *fraction = NULL;
+    uint8_t *data = backend.CheckoutDithered(0, arraysize(DITHER_DATA), 2,
+                                             &fraction);
+    OLA_ASSERT_NOT_NULL(data);
+    if (i == 0) {
+      memcpy(data, DITHER_DATA, arraysize(DITHER_DATA));
+      memcpy(fraction, DITHER_FRACTION, arraysize(DITHER_FRACTION));
+    }
+    backend.Commit(0);
+    OLA_ASSERT(m_writer.WaitForWriteCount(i + 1, TimeInterval(5, 0)));
+    m_writer.CheckDataMatches(OLA_SOURCELINE(), expected[i],
+                              arraysize(expected[i]));
+  }
+  OLA_ASSERT_EQ(0u, DropCount());
+}
+
 /**
  * Check that we handle the case of frame lengths changing.
  */
@@ -271,6 +363,97 @@ void SPIBackendTest::testSoftwareDrops() {
   OLA_ASSERT_EQ(2u, m_writer.WriteCount());
 }
 
+/**
+ * Check that a slow write doesn't block the caller, and that the newest frame
+ * is sent as soon as the write completes.
+ */
+void SPIBackendTest::testSoftwareSlowWriter() {
+  const TimeInterval write_time(0, 100000);
+  SoftwareBackend backend(SoftwareBackend::Options(), &m_writer,
+                          &m_export_map);
+  OLA_ASSERT(backend.Init());
+  m_writer.SetWriteTime(write_time);
+
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1),
+                          arraysize(DATA3)));
+  m_writer.WaitForWrite();
+  const TimeStamp first_write = m_writer.LastWriteTime();
+
+  ola::Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA2, arraysize(DATA2),
+                          arraysize(DATA3)));
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA3, arraysize(DATA3),
+                          arraysize(DATA3)));
+  clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start < write_time);
+  OLA_ASSERT_EQ(1u, DropCount());
+
+  OLA_ASSERT(m_writer.WaitForWriteCount(2, TimeInterval(5, 0)));
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA3, arraysize(DATA3));
+  // The second write had to wait for the first to complete.
+  OLA_ASSERT_TRUE(m_writer.LastWriteTime() - first_write >= write_time);
+  OLA_ASSERT_EQ(2u, m_writer.WriteCount());
+}
+
+/**
+ * Check that all outputs are written in one message.
+ */
+void SPIBackendTest::testSoftwareMultipleOutputs() {
+  SoftwareBackend::Options options;
+  options.outputs = 3;
+  options.sync_output = 2;
+  SoftwareBackend backend(options, &m_writer, &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  OLA_ASSERT(
+      SendSomeData(&backend, 0, DATA1, arraysize(DATA1), arraysize(DATA1), 2));
+  OLA_ASSERT(
+      SendSomeData(&backend, 1, DATA2, arraysize(DATA2), arraysize(DATA2)));
+  OLA_ASSERT_EQ(0u, m_writer.WriteCount());
+  OLA_ASSERT(
+      SendSomeData(&backend, 2, DATA1, arraysize(DATA1), arraysize(DATA1), 4));
+  m_writer.WaitForWrite();
+
+  OLA_ASSERT_EQ(1u, m_writer.WriteCount());
+  // One transfer per output, and one for the latch bytes.
+  OLA_ASSERT_EQ(4u, m_writer.LastTransferCount());
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), EXPECTED5, arraysize(EXPECTED5));
+}
+
+/**
+ * Check that dithered outputs are resent at the refresh rate.
+ */
+void SPIBackendTest::testSoftwareRefresh() {
+  SoftwareBackend::Options options;
+  options.refresh_rate = 200;
+  SoftwareBackend backend(options, &m_writer, &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  // Frames which aren't dithered are only sent once.
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1),
+                          arraysize(DATA1)));
+  OLA_ASSERT(m_writer.WaitForWriteCount(1, TimeInterval(5, 0)));
+  OLA_ASSERT_FALSE(m_writer.WaitForWriteCount(2, TimeInterval(0, 50000)));
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA1, arraysize(DATA1));
+
+  uint8_t *fraction = NULL;
+  uint8_t *data = backend.CheckoutDithered(0, arraysize(DITHER_DATA), 0,
+                                           &fraction);
+  OLA_ASSERT_NOT_NULL(data);
+  OLA_ASSERT_NOT_NULL(fraction);
+  memcpy(data, DITHER_DATA, arraysize(DITHER_DATA));
+  memcpy(fraction, DITHER_FRACTION, arraysize(DITHER_FRACTION));
+  backend.Commit(0);
+
+  // The frame keeps being sent without any new commits.
+  OLA_ASSERT(m_writer.WaitForWriteCount(6, TimeInterval(5, 0)));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(arraysize(DITHER_DATA)),
+                m_writer.LastWriteSize());
+  OLA_ASSERT_EQ(0u, DropCount());
+}
+
 /**
  * Check that we handle the case of frame lengths changing.
  */
@@ -18,13 +18,18 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <algorithm>
 #include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Array.h"
 #include "ola/file/Util.h"
 #include "ola/network/NetworkUtils.h"
 #include "olad/PluginAdaptor.h"
@@ -60,7 +65,9 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
     : Device(owner, SPI_DEVICE_NAME),
       m_preferences(prefs),
       m_plugin_adaptor(plugin_adaptor),
-      m_spi_device_name(spi_device) {
+      m_spi_device_name(spi_device),
+      m_use_frame_clock(false),
+      m_frame_timeout(ola::thread::INVALID_TIMEOUT) {
   m_spi_device_name = ola::file::FilenameFromPathOrPath(m_spi_device_name);
 
   ostringstream str;
@@ -110,10 +117,29 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
           m_preferences->GetValue(DeviceLabelKey(i));
     }
 
-    uint8_t pixel_count;
+    uint16_t pixel_count;
     if (StringToInt(m_preferences->GetValue(PixelCountKey(i)), &pixel_count)) {
+      if (pixel_count > MAX_PIXEL_COUNT) {
+        OLA_WARN << "Invalid pixel count for " << PixelCountKey(i)
+                 << ", must be <= " << static_cast<int>(MAX_PIXEL_COUNT);
+        pixel_count = MAX_PIXEL_COUNT;
+      }
       spi_output_options.pixel_count = pixel_count;
     }
+    PopulatePixelFormat(i, &spi_output_options.pixel_format);
+
+    uint8_t universe_count;
+    if (m_preferences->HasKey(UniverseCountKey(i))) {
+      if (StringToInt(m_preferences->GetValue(UniverseCountKey(i)),
+                      &universe_count) &&
+          universe_count >= 1 && universe_count <= MAX_UNIVERSE_COUNT) {
+        spi_output_options.universe_count = universe_count;
+      } else {
+        OLA_WARN << "Invalid universe count for " << UniverseCountKey(i)
+                 << ", must be between 1 and "
+                 << static_cast<int>(MAX_UNIVERSE_COUNT);
+      }
+    }
 
     auto_ptr<UID> uid(uid_allocator->AllocateNext());
     if (!uid.get()) {
@@ -126,6 +152,17 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
         new SPIOutputPort(this, m_backend.get(), *uid.get(),
                           spi_output_options));
   }
+
+  // The ports for the other universes of multi-universe outputs are numbered
+  // after the outputs.
+  SPIPorts::iterator iter = m_spi_ports.begin();
+  for (; iter != m_spi_ports.end(); ++iter) {
+    for (uint8_t i = 1; i < (*iter)->UniverseCount(); i++) {
+      m_universe_ports.push_back(
+          new SPIUniversePort(this, port_count + m_universe_ports.size(),
+                              *iter, i));
+    }
+  }
 }
 
 
@@ -140,6 +177,7 @@ string SPIDevice::DeviceId() const {
 bool SPIDevice::StartHook() {
   if (!m_backend->Init()) {
     STLDeleteElements(&m_spi_ports);
+    STLDeleteElements(&m_universe_ports);
     return false;
   }
 
@@ -159,11 +197,39 @@ bool SPIDevice::StartHook() {
 
     AddPort(*iter);
   }
+
+  UniversePorts::iterator universe_iter = m_universe_ports.begin();
+  for (; universe_iter != m_universe_ports.end(); ++universe_iter) {
+    AddPort(*universe_iter);
+  }
+
+  // Multi-universe outputs are sent on a frame clock, so that the data from
+  // all universes goes out together. If olad has a frame clock, the universes
+  // write the ports on its ticks, and each tick's writes are sent as one
+  // transfer, so a second clock would only add latency.
+  if (m_plugin_adaptor->GetFrameClock()) {
+    m_use_frame_clock = !m_universe_ports.empty();
+  } else if (!m_universe_ports.empty()) {
+    unsigned int frame_rate;
+    if (!StringToInt(m_preferences->GetValue(FrameRateKey()), &frame_rate) ||
+        frame_rate == 0) {
+      OLA_WARN << "Invalid frame rate for " << FrameRateKey();
+      frame_rate = DEFAULT_FRAME_RATE;
+    }
+    m_frame_timeout = m_plugin_adaptor->RegisterRepeatingTimeout(
+        TimeInterval(static_cast<int64_t>(1000000 / frame_rate)),
+        NewCallback(this, &SPIDevice::EmitFrames));
+  }
   return true;
 }
 
 
 void SPIDevice::PrePortStop() {
+  if (m_frame_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_plugin_adaptor->RemoveTimeout(m_frame_timeout);
+    m_frame_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
   SPIPorts::iterator iter = m_spi_ports.begin();
   for (uint8_t i = 0; iter != m_spi_ports.end(); iter++, i++) {
     ostringstream str;
@@ -204,6 +270,14 @@ string SPIDevice::GPIOPinKey() const {
   return m_spi_device_name + "-gpio-pin";
 }
 
+string SPIDevice::FrameRateKey() const {
+  return m_spi_device_name + "-frame-rate";
+}
+
+string SPIDevice::RefreshRateKey() const {
+  return m_spi_device_name + "-refresh-rate";
+}
+
 string SPIDevice::DeviceLabelKey(uint8_t port) const {
   return GetPortKey("device-label", port);
 }
@@ -220,6 +294,22 @@ string SPIDevice::PixelCountKey(uint8_t port) const {
   return GetPortKey("pixel-count", port);
 }
 
+string SPIDevice::ColorOrderKey(uint8_t port) const {
+  return GetPortKey("color-order", port);
+}
+
+string SPIDevice::GammaKey(uint8_t port) const {
+  return GetPortKey("gamma", port);
+}
+
+string SPIDevice::WhiteBalanceKey(uint8_t port) const {
+  return GetPortKey("white-balance", port);
+}
+
+string SPIDevice::UniverseCountKey(uint8_t port) const {
+  return GetPortKey("universes", port);
+}
+
 string SPIDevice::GetPortKey(const string &suffix, uint8_t port) const {
   std::ostringstream str;
   str << m_spi_device_name << "-" << static_cast<int>(port) << "-" << suffix;
@@ -241,6 +331,11 @@ void SPIDevice::SetDefaults() {
                                  UIntValidator(1, MAX_PORT_COUNT), 1);
   m_preferences->SetDefaultValue(SyncPortKey(),
                                  IntValidator(-2, MAX_PORT_COUNT), 0);
+  m_preferences->SetDefaultValue(FrameRateKey(),
+                                 UIntValidator(1, MAX_FRAME_RATE),
+                                 DEFAULT_FRAME_RATE);
+  m_preferences->SetDefaultValue(RefreshRateKey(),
+                                 UIntValidator(0, MAX_REFRESH_RATE), 0);
   m_preferences->Save();
 }
 
@@ -263,6 +358,7 @@ void SPIDevice::PopulateHardwareBackendOptions(
 
     options->gpio_pins.push_back(pin);
   }
+  options->refresh_rate = RefreshRate();
 }
 
 void SPIDevice::PopulateSoftwareBackendOptions(
@@ -279,6 +375,17 @@ void SPIDevice::PopulateSoftwareBackendOptions(
   if (options->sync_output == -2) {
     options->sync_output = options->outputs - 1;
   }
+  options->refresh_rate = RefreshRate();
+}
+
+unsigned int SPIDevice::RefreshRate() {
+  unsigned int refresh_rate;
+  if (!StringToInt(m_preferences->GetValue(RefreshRateKey()),
+                   &refresh_rate)) {
+    OLA_WARN << "Invalid integer value for " << RefreshRateKey();
+    return 0;
+  }
+  return refresh_rate;
 }
 
 void SPIDevice::PopulateWriterOptions(SPIWriter::Options *options) {
@@ -291,6 +398,67 @@ void SPIDevice::PopulateWriterOptions(SPIWriter::Options *options) {
     options->cs_enable_high = ce_high;
   }
 }
+
+void SPIDevice::FramePending() {
+  if (!m_use_frame_clock || m_frame_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  // Send once the other universes written on this tick have arrived.
+  m_frame_timeout = m_plugin_adaptor->RegisterSingleTimeout(
+      0, NewSingleCallback(this, &SPIDevice::EmitClockedFrames));
+}
+
+void SPIDevice::EmitClockedFrames() {
+  m_frame_timeout = ola::thread::INVALID_TIMEOUT;
+  EmitFrames();
+}
+
+bool SPIDevice::EmitFrames() {
+  SPIPorts::iterator iter = m_spi_ports.begin();
+  for (; iter != m_spi_ports.end(); ++iter) {
+    (*iter)->EmitFrame();
+  }
+  return true;
+}
+
+void SPIDevice::PopulatePixelFormat(uint8_t port, PixelFormat *format) {
+  if (m_preferences->HasKey(ColorOrderKey(port))) {
+    ColorOrder order;
+    if (StringToColorOrder(m_preferences->GetValue(ColorOrderKey(port)),
+                           &order)) {
+      format->SetColorOrder(order);
+    } else {
+      OLA_WARN << "Invalid color order for " << ColorOrderKey(port);
+    }
+  }
+
+  double gamma = 1.0;
+  if (m_preferences->HasKey(GammaKey(port))) {
+    std::istringstream str(m_preferences->GetValue(GammaKey(port)));
+    if (!(str >> gamma) || gamma <= 0) {
+      OLA_WARN << "Invalid gamma for " << GammaKey(port);
+      gamma = 1.0;
+    }
+  }
+
+  uint8_t maximums[] = {DMX_MAX_SLOT_VALUE, DMX_MAX_SLOT_VALUE,
+                        DMX_MAX_SLOT_VALUE};
+  if (m_preferences->HasKey(WhiteBalanceKey(port))) {
+    vector<string> values;
+    StringSplit(m_preferences->GetValue(WhiteBalanceKey(port)), &values, ",");
+    bool ok = values.size() == arraysize(maximums);
+    for (unsigned int i = 0; ok && i < values.size(); i++) {
+      StringTrim(&values[i]);
+      ok = StringToInt(values[i], &maximums[i]);
+    }
+    if (!ok) {
+      OLA_WARN << "Invalid white balance for " << WhiteBalanceKey(port)
+               << ", expected <red>,<green>,<blue>";
+      std::fill(maximums, maximums + arraysize(maximums), DMX_MAX_SLOT_VALUE);
+    }
+  }
+  format->SetCorrection(gamma, maximums[0], maximums[1], maximums[2]);
+}
 }  // namespace spi
 }  // namespace plugin
 }  // namespace ola
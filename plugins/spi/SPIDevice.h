@@ -29,6 +29,8 @@
 #include "ola/io/SelectServer.h"
 #include "ola/rdm/UIDAllocator.h"
 #include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "plugins/spi/PixelEncoder.h"
 #include "plugins/spi/SPIBackend.h"
 #include "plugins/spi/SPIWriter.h"
 
@@ -49,19 +51,30 @@ class SPIDevice: public ola::Device {
 
   bool AllowMultiPortPatching() const { return true; }
 
+  /*
+   * Called when a multi-universe port has new data to send.
+   */
+  void FramePending();
+
  protected:
   bool StartHook();
   void PrePortStop();
 
  private:
   typedef std::vector<class SPIOutputPort*> SPIPorts;
+  typedef std::vector<class SPIUniversePort*> UniversePorts;
 
   std::auto_ptr<SPIWriterInterface> m_writer;
   std::auto_ptr<SPIBackendInterface> m_backend;
   class Preferences *m_preferences;
   class PluginAdaptor *m_plugin_adaptor;
   SPIPorts m_spi_ports;
+  UniversePorts m_universe_ports;
   std::string m_spi_device_name;
+  // True if the universes write the ports on the olad frame clock.
+  bool m_use_frame_clock;
+  // The frame rate timer, or with the frame clock, the pending send.
+  ola::thread::timeout_id m_frame_timeout;
 
   // Per device options
   std::string SPIBackendKey() const;
@@ -70,18 +83,28 @@ class SPIDevice: public ola::Device {
   std::string PortCountKey() const;
   std::string SyncPortKey() const;
   std::string GPIOPinKey() const;
+  std::string FrameRateKey() const;
+  std::string RefreshRateKey() const;
 
   // Per port options
   std::string DeviceLabelKey(uint8_t port) const;
   std::string PersonalityKey(uint8_t port) const;
   std::string PixelCountKey(uint8_t port) const;
   std::string StartAddressKey(uint8_t port) const;
+  std::string ColorOrderKey(uint8_t port) const;
+  std::string GammaKey(uint8_t port) const;
+  std::string WhiteBalanceKey(uint8_t port) const;
+  std::string UniverseCountKey(uint8_t port) const;
   std::string GetPortKey(const std::string &suffix, uint8_t port) const;
 
   void SetDefaults();
   void PopulateHardwareBackendOptions(HardwareBackend::Options *options);
   void PopulateSoftwareBackendOptions(SoftwareBackend::Options *options);
   void PopulateWriterOptions(SPIWriter::Options *options);
+  unsigned int RefreshRate();
+  void PopulatePixelFormat(uint8_t port, PixelFormat *format);
+  bool EmitFrames();
+  void EmitClockedFrames();
 
   static const char SPI_DEVICE_NAME[];
   static const char HARDWARE_BACKEND[];
@@ -89,6 +112,11 @@ class SPIDevice: public ola::Device {
   static const uint16_t MAX_GPIO_PIN = 1023;
   static const uint32_t MAX_SPI_SPEED = 32000000;
   static const uint16_t MAX_PORT_COUNT = 32;
+  static const uint16_t MAX_PIXEL_COUNT = 4080;
+  static const uint8_t MAX_UNIVERSE_COUNT = 24;
+  static const unsigned int DEFAULT_FRAME_RATE = 40;
+  static const unsigned int MAX_FRAME_RATE = 1000;
+  static const unsigned int MAX_REFRESH_RATE = 2000;
 };
 }  // namespace spi
 }  // namespace plugin
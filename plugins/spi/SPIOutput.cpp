@@ -16,9 +16,6 @@
  * SPIOutput.cpp
  * An RDM-controllable SPI device. Takes up to one universe of DMX.
  * Copyright (C) 2013 Simon Newton
- *
- * The LPD8806 code was based on
- * https://github.com/adafruit/LPD8806/blob/master/LPD8806.cpp
  */
 
 #if HAVE_CONFIG_H
@@ -69,7 +66,6 @@ using ola::rdm::RDMResponse;
 using ola::rdm::ResponderHelper;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
-using std::min;
 using std::string;
 using std::vector;
 
@@ -87,14 +83,14 @@ const uint16_t SPIOutput::LPD8806_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::P9813_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::APA102_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::APA102_PB_SLOTS_PER_PIXEL = 4;
+const uint16_t SPIOutput::WS2801_16BIT_SLOTS_PER_PIXEL = 6;
+const uint16_t SPIOutput::APA102_16BIT_SLOTS_PER_PIXEL = 6;
 
 // Number of bytes that each pixel uses on the SPI wires
 // (if it differs from 1:1 with colors)
 const uint16_t SPIOutput::P9813_SPI_BYTES_PER_PIXEL = 4;
-const uint16_t SPIOutput::APA102_SPI_BYTES_PER_PIXEL = 4;
 
 const uint16_t SPIOutput::APA102_START_FRAME_BYTES = 4;
-const uint8_t SPIOutput::APA102_LEDFRAME_START_MARK = 0xE0;
 
 SPIOutput::RDMOps *SPIOutput::RDMOps::instance = NULL;
 
@@ -178,9 +174,13 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
       m_output_number(options.output_number),
       m_uid(uid),
       m_pixel_count(options.pixel_count),
+      m_universe_count(std::max(options.universe_count,
+                                static_cast<uint8_t>(1))),
+      m_pixel_format(options.pixel_format),
       m_device_label(options.device_label),
       m_start_address(1),
-      m_identify_mode(false) {
+      m_identify_mode(false),
+      m_frame_pending(false) {
   m_spi_device_name = FilenameFromPathOrPath(m_backend->DevicePath());
 
   PersonalityCollection::PersonalityList personalities;
@@ -211,7 +211,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 
   personalities.insert(
       personalities.begin() + PERS_WS2801_INDIVIDUAL - 1,
-      Personality(m_pixel_count * WS2801_SLOTS_PER_PIXEL,
+      Personality(FootprintPixels(WS2801_SLOTS_PER_PIXEL) *
+                      WS2801_SLOTS_PER_PIXEL,
                   "WS2801 Individual Control"));
   personalities.insert(
       personalities.begin() + PERS_WS2801_COMBINED - 1,
@@ -221,7 +222,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 
   personalities.insert(
       personalities.begin() + PERS_LDP8806_INDIVIDUAL - 1,
-      Personality(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
+      Personality(FootprintPixels(LPD8806_SLOTS_PER_PIXEL) *
+                      LPD8806_SLOTS_PER_PIXEL,
                   "LPD8806 Individual Control"));
   personalities.insert(
       personalities.begin() + PERS_LDP8806_COMBINED - 1,
@@ -231,7 +233,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 
   personalities.insert(
       personalities.begin() + PERS_P9813_INDIVIDUAL - 1,
-      Personality(m_pixel_count * P9813_SLOTS_PER_PIXEL,
+      Personality(FootprintPixels(P9813_SLOTS_PER_PIXEL) *
+                      P9813_SLOTS_PER_PIXEL,
                   "P9813 Individual Control"));
   personalities.insert(
       personalities.begin() + PERS_P9813_COMBINED - 1,
@@ -241,7 +244,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 
   personalities.insert(
       personalities.begin() + PERS_APA102_INDIVIDUAL - 1,
-      Personality(m_pixel_count * APA102_SLOTS_PER_PIXEL,
+      Personality(FootprintPixels(APA102_SLOTS_PER_PIXEL) *
+                      APA102_SLOTS_PER_PIXEL,
                   "APA102 Individual Control"));
 
   personalities.insert(
@@ -252,7 +256,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 
   personalities.insert(
       personalities.begin() + PERS_APA102_PB_INDIVIDUAL - 1,
-      Personality(m_pixel_count * APA102_PB_SLOTS_PER_PIXEL,
+      Personality(FootprintPixels(APA102_PB_SLOTS_PER_PIXEL) *
+                      APA102_PB_SLOTS_PER_PIXEL,
                   "APA102 Pixel Brightness Individ."));
 
   personalities.insert(
@@ -261,6 +266,18 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
                   "APA102 Pixel Brightness Combined",
                   sdc_irgb_combined));
 
+  personalities.insert(
+      personalities.begin() + PERS_WS2801_16BIT_INDIVIDUAL - 1,
+      Personality(FootprintPixels(WS2801_16BIT_SLOTS_PER_PIXEL) *
+                      WS2801_16BIT_SLOTS_PER_PIXEL,
+                  "WS2801 16 bit Individual Control"));
+
+  personalities.insert(
+      personalities.begin() + PERS_APA102_16BIT_INDIVIDUAL - 1,
+      Personality(FootprintPixels(APA102_16BIT_SLOTS_PER_PIXEL) *
+                      APA102_16BIT_SLOTS_PER_PIXEL,
+                  "APA102 16 bit Individual Control"));
+
   m_personality_collection.reset(new PersonalityCollection(personalities));
   m_personality_manager.reset(new PersonalityManager(
       m_personality_collection.get()));
@@ -276,6 +293,9 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
 #endif  // HAVE_GETLOADAVG
 
   m_network_manager.reset(new ola::rdm::NetworkManager());
+  if (m_universe_count > 1) {
+    m_universe_data.resize(m_universe_count);
+  }
 }
 
 SPIOutput::~SPIOutput() {
@@ -319,7 +339,11 @@ string SPIOutput::Description() const {
   str << "Output " << static_cast<int>(m_output_number) << ", "
       << m_personality_manager->ActivePersonalityDescription() << ", "
       << m_personality_manager->ActivePersonalityFootprint()
-      << " slots @ " << m_start_address << ". (" << m_uid << ")";
+      << " slots @ " << m_start_address;
+  if (m_universe_count > 1) {
+    str << ", " << static_cast<int>(m_universe_count) << " universes";
+  }
+  str << ". (" << m_uid << ")";
   return str.str();
 }
 
@@ -327,10 +351,30 @@ string SPIOutput::Description() const {
  * Send DMX data over SPI.
  */
 bool SPIOutput::WriteDMX(const DmxBuffer &buffer) {
+  if (m_universe_count > 1) {
+    return WriteUniverseDMX(0, buffer);
+  }
   if (m_identify_mode) {
     return true;
   }
-  return InternalWriteDMX(buffer);
+  return InternalWriteDMX(&buffer, 1);
+}
+
+bool SPIOutput::WriteUniverseDMX(uint8_t universe, const DmxBuffer &buffer) {
+  if (universe >= m_universe_data.size()) {
+    return false;
+  }
+  m_universe_data[universe] = buffer;
+  m_frame_pending = true;
+  return true;
+}
+
+void SPIOutput::EmitFrame() {
+  if (!m_frame_pending || m_identify_mode) {
+    return;
+  }
+  m_frame_pending = false;
+  InternalWriteDMX(&m_universe_data[0], m_universe_data.size());
 }
 
 
@@ -355,37 +399,45 @@ void SPIOutput::SendRDMRequest(RDMRequest *request,
                                        request, callback);
 }
 
-bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
+bool SPIOutput::InternalWriteDMX(const DmxBuffer *universes,
+                                 unsigned int count) {
+  const DmxBuffer &buffer = universes[0];
   switch (m_personality_manager->ActivePersonalityNumber()) {
     case PERS_WS2801_INDIVIDUAL:
-      IndividualWS2801Control(buffer);
+      IndividualControl(PixelEncoder::WS2801, universes, count, false);
       break;
     case PERS_WS2801_COMBINED:
-      CombinedWS2801Control(buffer);
+      CombinedControl(PixelEncoder::WS2801, buffer);
       break;
     case PERS_LDP8806_INDIVIDUAL:
-      IndividualLPD8806Control(buffer);
+      IndividualControl(PixelEncoder::LPD8806, universes, count, false);
       break;
     case PERS_LDP8806_COMBINED:
-      CombinedLPD8806Control(buffer);
+      CombinedControl(PixelEncoder::LPD8806, buffer);
       break;
     case PERS_P9813_INDIVIDUAL:
-      IndividualP9813Control(buffer);
+      IndividualControl(PixelEncoder::P9813, universes, count, false);
       break;
     case PERS_P9813_COMBINED:
-      CombinedP9813Control(buffer);
+      CombinedControl(PixelEncoder::P9813, buffer);
       break;
     case PERS_APA102_INDIVIDUAL:
-      IndividualAPA102Control(buffer);
+      IndividualControl(PixelEncoder::APA102, universes, count, false);
       break;
     case PERS_APA102_COMBINED:
-      CombinedAPA102Control(buffer);
+      CombinedControl(PixelEncoder::APA102, buffer);
       break;
     case PERS_APA102_PB_INDIVIDUAL:
-      IndividualAPA102ControlPixelBrightness(buffer);
+      IndividualControl(PixelEncoder::APA102_PB, universes, count, false);
       break;
     case PERS_APA102_PB_COMBINED:
-      CombinedAPA102ControlPixelBrightness(buffer);
+      CombinedControl(PixelEncoder::APA102_PB, buffer);
+      break;
+    case PERS_WS2801_16BIT_INDIVIDUAL:
+      IndividualControl(PixelEncoder::WS2801, universes, count, true);
+      break;
+    case PERS_APA102_16BIT_INDIVIDUAL:
+      IndividualControl(PixelEncoder::APA102, universes, count, true);
       break;
     default:
       break;
@@ -394,455 +446,172 @@ bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
 }
 
 
-void SPIOutput::IndividualWS2801Control(const DmxBuffer &buffer) {
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  const unsigned int output_length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length);
-  if (!output) {
-    return;
-  }
-
-  unsigned int new_length = output_length;
-  buffer.GetRange(m_start_address - 1, output, &new_length);
-  m_backend->Commit(m_output_number);
-}
+void SPIOutput::IndividualControl(PixelEncoder::Chip chip,
+                                  const DmxBuffer *universes,
+                                  unsigned int count,
+                                  bool sixteen_bit) {
+  const unsigned int slots_per_pixel = sixteen_bit ?
+      PixelEncoder::WideSlotsPerPixel(chip) :
+      PixelEncoder::SlotsPerPixel(chip);
+  unsigned int length = 0;
+  const uint8_t *data = SlotData(universes[0], &length);
 
-void SPIOutput::CombinedWS2801Control(const DmxBuffer &buffer) {
-  unsigned int pixel_data_length = WS2801_SLOTS_PER_PIXEL;
-  uint8_t pixel_data[WS2801_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
-  if (pixel_data_length != WS2801_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << WS2801_SLOTS_PER_PIXEL
-             << ", got " << pixel_data_length;
-    return;
-  }
-
-  const unsigned int length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length);
-  if (!output) {
-    return;
-  }
-
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(output + (i * WS2801_SLOTS_PER_PIXEL), pixel_data,
-           pixel_data_length);
-  }
-  m_backend->Commit(m_output_number);
-}
-
-void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < LPD8806_SLOTS_PER_PIXEL) {
-    // not even 3 bytes of data, don't bother updating
+  // The WS2801 is updated with whatever data we have, the others need at
+  // least one pixel.
+  if (chip != PixelEncoder::WS2801 && length < slots_per_pixel) {
+    OLA_INFO << "Insufficient DMX data, required " << slots_per_pixel
+             << ", got " << length;
     return;
   }
 
   // We always check out the entire string length, even if we only have data
   // for part of it
-  const unsigned int output_length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
-                                        latch_bytes);
-  if (!output)
+  const unsigned int bytes_per_pixel = PixelEncoder::BytesPerPixel(chip);
+  const unsigned int start_bytes = StartFrameBytes(chip);
+  const unsigned int frame_length = start_bytes +
+      m_pixel_count * bytes_per_pixel;
+  // 16 bit data is temporally dithered by the backend, so the fraction of
+  // each byte is written as well.
+  uint8_t *fraction = NULL;
+  uint8_t *output = sixteen_bit ?
+      m_backend->CheckoutDithered(m_output_number, frame_length,
+                                  LatchBytes(chip), &fraction) :
+      m_backend->Checkout(m_output_number, frame_length, LatchBytes(chip));
+  if (!output) {
     return;
-
-  const unsigned int length = min(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       buffer.Size() - first_slot);
-
-  for (unsigned int i = 0; i < length / LPD8806_SLOTS_PER_PIXEL; i++) {
-    // Convert RGB to GRB
-    unsigned int offset = first_slot + i * LPD8806_SLOTS_PER_PIXEL;
-    uint8_t r = buffer.Get(offset);
-    uint8_t g = buffer.Get(offset + 1);
-    uint8_t b = buffer.Get(offset + 2);
-    output[i * LPD8806_SLOTS_PER_PIXEL] = 0x80 | (g >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 1] = 0x80 | (r >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 2] = 0x80 | (b >> 1);
   }
-  m_backend->Commit(m_output_number);
-}
 
-void SPIOutput::CombinedLPD8806Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
-  unsigned int pixel_data_length = LPD8806_SLOTS_PER_PIXEL;
-
-  uint8_t pixel_data[LPD8806_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
-  if (pixel_data_length != LPD8806_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << LPD8806_SLOTS_PER_PIXEL
-             << ", got " << pixel_data_length;
-    return;
+  memset(output, 0, start_bytes);
+  if (fraction) {
+    memset(fraction, 0, start_bytes);
   }
 
-  // The leds are GRB format so convert here
-  uint8_t temp = pixel_data[1];
-  pixel_data[1] = pixel_data[0];
-  pixel_data[0] = temp;
-
-  const unsigned int length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
-  if (!output)
-    return;
-
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    for (unsigned int j = 0; j < LPD8806_SLOTS_PER_PIXEL; j++) {
-      output[i * LPD8806_SLOTS_PER_PIXEL + j] = 0x80 | (pixel_data[j] >> 1);
+  // Each universe holds the same number of pixels, except the last which
+  // holds the rest of the string.
+  const unsigned int pixels_per_universe = (
+      DMX_UNIVERSE_SIZE / slots_per_pixel);
+  unsigned int first_pixel = 0;
+  for (unsigned int i = 0; i < count && first_pixel < m_pixel_count; i++) {
+    if (i) {
+      data = universes[i].GetRaw();
+      length = universes[i].Size();
     }
-  }
-  m_backend->Commit(m_output_number);
-}
-
-void SPIOutput::IndividualP9813Control(const DmxBuffer &buffer) {
-  // We need 4 bytes of zeros in the beginning and 8 bytes at
-  // the end
-  const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
-    // not even 3 bytes of data, don't bother updating
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  const unsigned int output_length = m_pixel_count * P9813_SPI_BYTES_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
-                                        latch_bytes);
-
-  if (!output) {
-    return;
-  }
-
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to P9813 Pixel
-    unsigned int offset = first_slot + i * P9813_SLOTS_PER_PIXEL;
-    // We need to avoid the first 4 bytes of the buffer since that acts as a
-    // start of frame delimiter
-    unsigned int spi_offset = (i + 1) * P9813_SPI_BYTES_PER_PIXEL;
-    uint8_t r = 0;
-    uint8_t b = 0;
-    uint8_t g = 0;
-    if (buffer.Size() - offset >= P9813_SLOTS_PER_PIXEL) {
-      r = buffer.Get(offset);
-      g = buffer.Get(offset + 1);
-      b = buffer.Get(offset + 2);
+    const unsigned int pixel_count = (i + 1 == count ?
+        m_pixel_count - first_pixel :
+        std::min(pixels_per_universe, m_pixel_count - first_pixel));
+
+    const unsigned int offset = start_bytes + first_pixel * bytes_per_pixel;
+    uint8_t *pixels = output + offset;
+    const unsigned int updated = sixteen_bit ?
+        PixelEncoder::EncodeWide(chip, m_pixel_format, data, length, pixels,
+                                 fraction + offset, pixel_count) :
+        PixelEncoder::Encode(chip, m_pixel_format, data, length, pixels,
+                             pixel_count);
+
+    // Pixels without data keep their previous values, except that the P9813
+    // is turned off and the APA102 keeps its start mark.
+    if (chip == PixelEncoder::P9813) {
+      const uint8_t black[P9813_SLOTS_PER_PIXEL] = {0, 0, 0};
+      PixelEncoder::Fill(chip, m_pixel_format, black,
+                         pixels + updated * bytes_per_pixel,
+                         pixel_count - updated);
+    } else if (chip == PixelEncoder::APA102) {
+      for (unsigned int j = updated; j < pixel_count; j++) {
+        pixels[j * bytes_per_pixel] = 0xFF;
+      }
     }
-    output[spi_offset] = P9813CreateFlag(r, g, b);
-    output[spi_offset + 1] = b;
-    output[spi_offset + 2] = g;
-    output[spi_offset + 3] = r;
+    first_pixel += pixel_count;
   }
   m_backend->Commit(m_output_number);
 }
 
-void SPIOutput::CombinedP9813Control(const DmxBuffer &buffer) {
-  const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << P9813_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
+void SPIOutput::CombinedControl(PixelEncoder::Chip chip,
+                                const DmxBuffer &buffer) {
+  const unsigned int slots_per_pixel = PixelEncoder::SlotsPerPixel(chip);
+  unsigned int length = 0;
+  const uint8_t *data = SlotData(buffer, &length);
+  if (length < slots_per_pixel) {
+    OLA_INFO << "Insufficient DMX data, required " << slots_per_pixel
+             << ", got " << length;
     return;
   }
 
-  uint8_t pixel_data[P9813_SPI_BYTES_PER_PIXEL];
-  pixel_data[3] = buffer.Get(first_slot);  // Get Red
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[0] = P9813CreateFlag(pixel_data[3], pixel_data[2],
-                                  pixel_data[1]);
-
-  const unsigned int length = m_pixel_count * P9813_SPI_BYTES_PER_PIXEL;
-  uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
+  const unsigned int start_bytes = StartFrameBytes(chip);
+  uint8_t *output = m_backend->Checkout(
+      m_output_number,
+      start_bytes + m_pixel_count * PixelEncoder::BytesPerPixel(chip),
+      LatchBytes(chip));
   if (!output) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(&output[(i + 1) * P9813_SPI_BYTES_PER_PIXEL], pixel_data,
-           P9813_SPI_BYTES_PER_PIXEL);
-  }
+  memset(output, 0, start_bytes);
+  PixelEncoder::Fill(chip, m_pixel_format, data, output + start_bytes,
+                     m_pixel_count);
   m_backend->Commit(m_output_number);
 }
 
 /**
- * For more information please visit:
- * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
+ * Return the DMX data from the start address onwards.
+ * @param buffer the DMX data.
+ * @param[out] length the number of slots.
+ * @returns a pointer to the first slot, or NULL if there isn't one.
  */
-uint8_t SPIOutput::P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue) {
-  uint8_t flag = 0;
-  flag =  (red & 0xc0) >> 6;
-  flag |= (green & 0xc0) >> 4;
-  flag |= (blue & 0xc0) >> 2;
-  return ~flag;
-}
-
-
-void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
-  // some detailed information on the protocol:
-  // https://cpldcpu.wordpress.com/2014/11/30/understanding-the-apa102-superled/
-  // Data-Struct
-  // StartFrame: 4 bytes = 32 bits zeros (APA102_START_FRAME_BYTES)
-  // LEDFrame: 1 byte FF ; 3 bytes color info (Blue, Green, Red)
-  // EndFrame: (n/2)bits; n = pixel_count
-
-  // calculate DMX-start-address
+const uint8_t *SPIOutput::SlotData(const DmxBuffer &buffer,
+                                   unsigned int *length) const {
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-
-  // only do something if at least 1 pixel can be updated..
-  if ((buffer.Size() - first_slot) < APA102_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
-  uint8_t *output = m_backend->Checkout(
-      m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
-  if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
+  if (buffer.Size() <= first_slot) {
+    *length = 0;
+    return NULL;
   }
-
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_SLOTS_PER_PIXEL);
-
-
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // first Byte contains:
-    // 3 bits start mark (111) + 5 bits global brightness
-    // set global brightness fixed to 31 --> that reduces flickering
-    // that can be written as 0xE0 & 0x1F
-    output[spi_offset] = 0xFF;
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_SLOTS_PER_PIXEL) {
-      // Convert RGB to APA102 Pixel
-      // skip spi_offset + 0 (is already set)
-      output[spi_offset + 1] = buffer.Get(offset + 2);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 1);  // green
-      output[spi_offset + 3] = buffer.Get(offset);      // red
-    }
-  }
-
-  // write output back
-  m_backend->Commit(m_output_number);
+  *length = buffer.Size() - first_slot;
+  return buffer.GetRaw() + first_slot;
 }
 
-
-void SPIOutput::IndividualAPA102ControlPixelBrightness(
-    const DmxBuffer &buffer) {
-  // some detailed information on the protocol:
-  // https://cpldcpu.wordpress.com/2014/11/30/understanding-the-apa102-superled/
-  // Data-Struct
-  // StartFrame: 4 bytes = 32 bits zeros (APA102_START_FRAME_BYTES)
-  // LEDFrame:
-  //    1 byte START_MARK + pixel brightness
-  //    3 bytes color info (Blue, Green, Red)
-  // EndFrame: (n/2)bits; n = pixel_count
-
-  // calculate DMX-start-address
-  const unsigned int first_slot = m_start_address - 1;  // 0 offset
-
-  // only do something if at least 1 pixel can be updated..
-  if ((buffer.Size() - first_slot) < APA102_PB_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_PB_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
-  uint8_t *output = m_backend->Checkout(
-      m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
-  if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
-  }
-
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_PB_SLOTS_PER_PIXEL);
-
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_PB_SLOTS_PER_PIXEL) {
-      // first Byte:
-      // 3 bits start mark (111) (APA102_LEDFRAME_START_MARK) +
-      // 5 bits pixel brightness (datasheet name: global brightness)
-      output[spi_offset + 0] = (SPIOutput::APA102_LEDFRAME_START_MARK |
-          CalculateAPA102PixelBrightness(buffer.Get(offset + 0)));
-      // Convert RGB to APA102 Pixel
-      output[spi_offset + 1] = buffer.Get(offset + 3);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 2);  // green
-      output[spi_offset + 3] = buffer.Get(offset + 1);  // red
-    }
+/**
+ * The number of zero bytes sent before the pixel data.
+ */
+unsigned int SPIOutput::StartFrameBytes(PixelEncoder::Chip chip) const {
+  switch (chip) {
+    case PixelEncoder::P9813:
+      // 32 zero bits
+      return P9813_SPI_BYTES_PER_PIXEL;
+    case PixelEncoder::APA102:
+    case PixelEncoder::APA102_PB:
+      // only add the APA102_START_FRAME_BYTES on the first port!!
+      return m_output_number == 0 ? APA102_START_FRAME_BYTES : 0;
+    default:
+      return 0;
   }
-
-  // write output back
-  m_backend->Commit(m_output_number);
 }
 
-void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
-  // for Protocol details see IndividualAPA102Control
-
-  // calculate DMX-start-address
-  const uint16_t first_slot = m_start_address - 1;  // 0 offset
-
-  // check if enough data is there.
-  if ((buffer.Size() - first_slot) < APA102_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
-  uint8_t *output = m_backend->Checkout(
-      m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
-  if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
-  }
-
-  // create Pixel Data
-  uint8_t pixel_data[APA102_SPI_BYTES_PER_PIXEL];
-  pixel_data[0] = 0xFF;
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[3] = buffer.Get(first_slot);      // Get Red
-
-  // set all pixel to same value
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    if (m_output_number == 0) {
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    memcpy(&output[spi_offset], pixel_data,
-           APA102_SPI_BYTES_PER_PIXEL);
+/**
+ * The number of zero bytes sent after the pixel data.
+ */
+unsigned int SPIOutput::LatchBytes(PixelEncoder::Chip chip) const {
+  switch (chip) {
+    case PixelEncoder::LPD8806:
+      return (m_pixel_count + 31) / 32;
+    case PixelEncoder::P9813:
+      // 64 zero bits
+      return 2 * P9813_SPI_BYTES_PER_PIXEL;
+    case PixelEncoder::APA102:
+    case PixelEncoder::APA102_PB:
+      return CalculateAPA102LatchBytes(m_pixel_count);
+    default:
+      return 0;
   }
-
-  // write output back...
-  m_backend->Commit(m_output_number);
 }
 
-
-void SPIOutput::CombinedAPA102ControlPixelBrightness(const DmxBuffer &buffer) {
-  // for Protocol details see IndividualAPA102Control
-  // calculate DMX-start-address
-  const uint16_t first_slot = m_start_address - 1;  // 0 offset
-
-  // check if enough data is there.
-  if ((buffer.Size() - first_slot) < APA102_PB_SLOTS_PER_PIXEL) {
-    OLA_INFO << "Insufficient DMX data, required " << APA102_PB_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
-    return;
-  }
-
-  // We always check out the entire string length, even if we only have data
-  // for part of it
-  uint16_t output_length = (m_pixel_count * APA102_SPI_BYTES_PER_PIXEL);
-  // only add the APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    output_length += APA102_START_FRAME_BYTES;
-  }
-  uint8_t *output = m_backend->Checkout(
-      m_output_number,
-      output_length,
-      CalculateAPA102LatchBytes(m_pixel_count));
-
-  // only update SPI data if possible
-  if (!output) {
-    return;
-  }
-
-  // only write to APA102_START_FRAME_BYTES on the first port!!
-  if (m_output_number == 0) {
-    // set APA102_START_FRAME_BYTES to zero
-    memset(output, 0, APA102_START_FRAME_BYTES);
-  }
-
-  // create Pixel Data
-  uint8_t pixel_data[APA102_SPI_BYTES_PER_PIXEL];
-  // first Byte:
-  // 3 bits start mark (111) (APA102_LEDFRAME_START_MARK) +
-  // 5 bits pixel brightness (datasheet name: global brightness)
-  pixel_data[0] = (SPIOutput::APA102_LEDFRAME_START_MARK |
-      CalculateAPA102PixelBrightness(buffer.Get(first_slot + 0)));
-  // color data
-  pixel_data[1] = buffer.Get(first_slot + 3);  // Get Blue
-  pixel_data[2] = buffer.Get(first_slot + 2);  // Get Green
-  pixel_data[3] = buffer.Get(first_slot + 1);  // Get Red
-
-  // set all pixel to same value
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    if (m_output_number == 0) {
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    memcpy(&output[spi_offset], pixel_data,
-           APA102_SPI_BYTES_PER_PIXEL);
-  }
-
-  // write output back...
-  m_backend->Commit(m_output_number);
+/**
+ * The number of pixels controlled by the first universe. A single universe
+ * can't address more than DMX_UNIVERSE_SIZE slots, so longer strings need
+ * more universes to control the remaining pixels.
+ */
+unsigned int SPIOutput::FootprintPixels(uint16_t slots_per_pixel) const {
+  return std::min(m_pixel_count,
+                  static_cast<unsigned int>(DMX_UNIVERSE_SIZE) /
+                  slots_per_pixel);
 }
 
 /**
@@ -857,28 +626,18 @@ void SPIOutput::CombinedAPA102ControlPixelBrightness(const DmxBuffer &buffer) {
  */
 uint8_t SPIOutput::CalculateAPA102LatchBytes(uint16_t pixel_count) {
   // round up so that we get definitely enough bits
-  const uint8_t latch_bits = (pixel_count + 1) / 2;
+  const uint16_t latch_bits = (pixel_count + 1) / 2;
   const uint8_t latch_bytes = (latch_bits + 7) / 8;
   return latch_bytes;
 }
 
-/**
- * Calculate Pixel Brightness for APA102:
- * Map Input to Output range:
- * Input is 8bit value (0..255)
- * Output is 5bit value (0..31)
- */
-uint8_t SPIOutput::CalculateAPA102PixelBrightness(uint8_t brightness) {
-  return (brightness >> 3);
-}
-
 
 
 RDMResponse *SPIOutput::GetDeviceInfo(const RDMRequest *request) {
   return ResponderHelper::GetDeviceInfo(
       request, ola::rdm::OLA_SPI_DEVICE_MODEL,
       ola::rdm::PRODUCT_CATEGORY_FIXTURE,
-      5,  // RDM software version (increment on personality changes)
+      6,  // RDM software version (increment on personality changes)
       m_personality_manager.get(),
       m_start_address,
       0, m_sensors.size());
@@ -959,7 +718,8 @@ RDMResponse *SPIOutput::SetIdentify(const RDMRequest *request) {
     } else {
       identify_buffer.Blackout();
     }
-    InternalWriteDMX(identify_buffer);
+    const vector<DmxBuffer> universes(m_universe_count, identify_buffer);
+    InternalWriteDMX(&universes[0], universes.size());
   }
   return response;
 }
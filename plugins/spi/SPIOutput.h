@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/rdm/NetworkManager.h"
 #include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMControllerInterface.h"
@@ -31,6 +32,7 @@
 #include "ola/rdm/ResponderOps.h"
 #include "ola/rdm/ResponderPersonality.h"
 #include "ola/rdm/ResponderSensor.h"
+#include "plugins/spi/PixelEncoder.h"
 
 namespace ola {
 namespace plugin {
@@ -57,17 +59,26 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     PERS_APA102_COMBINED = 8,
     PERS_APA102_PB_INDIVIDUAL,
     PERS_APA102_PB_COMBINED,
+    PERS_WS2801_16BIT_INDIVIDUAL,
+    PERS_APA102_16BIT_INDIVIDUAL,
   };
 
   struct Options {
     std::string device_label;
-    uint8_t pixel_count;
+    uint16_t pixel_count;
     uint8_t output_number;
+    PixelFormat pixel_format;
+    /*
+     * The number of consecutive universes the pixel string spans. If this is
+     * more than one, the data is held until EmitFrame() is called.
+     */
+    uint8_t universe_count;
 
     explicit Options(uint8_t output_number, const std::string &spi_device_name)
         : device_label("SPI Device - " + spi_device_name),
           pixel_count(25),  // For the https://www.adafruit.com/products/738
-          output_number(output_number) {
+          output_number(output_number),
+          universe_count(1) {
     }
   };
 
@@ -83,10 +94,25 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   uint16_t GetStartAddress() const;
   bool SetStartAddress(uint16_t start_address);
   unsigned int PixelCount() const { return m_pixel_count; }
+  uint8_t UniverseCount() const { return m_universe_count; }
 
   std::string Description() const;
   bool WriteDMX(const DmxBuffer &buffer);
 
+  /**
+   * Set the data for one of the universes of a multi-universe string.
+   * @param universe the index of the universe, universe 0 is the same as
+   *   WriteDMX().
+   * @param buffer the DMX data.
+   */
+  bool WriteUniverseDMX(uint8_t universe, const DmxBuffer &buffer);
+
+  /**
+   * Send a multi-universe string, if any of the universes have changed. The
+   * frame is built from the latest data for each universe.
+   */
+  void EmitFrame();
+
   void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void SendRDMRequest(ola::rdm::RDMRequest *request,
@@ -115,6 +141,8 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::string m_spi_device_name;
   const ola::rdm::UID m_uid;
   const unsigned int m_pixel_count;
+  const uint8_t m_universe_count;
+  const PixelFormat m_pixel_format;
   std::string m_device_label;
   uint16_t m_start_address;  // starts from 1
   bool m_identify_mode;
@@ -122,20 +150,20 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::auto_ptr<ola::rdm::PersonalityManager> m_personality_manager;
   ola::rdm::Sensors m_sensors;
   std::auto_ptr<ola::rdm::NetworkManagerInterface> m_network_manager;
+  std::vector<DmxBuffer> m_universe_data;
+  bool m_frame_pending;
 
   // DMX methods
-  bool InternalWriteDMX(const DmxBuffer &buffer);
-
-  void IndividualWS2801Control(const DmxBuffer &buffer);
-  void CombinedWS2801Control(const DmxBuffer &buffer);
-  void IndividualLPD8806Control(const DmxBuffer &buffer);
-  void CombinedLPD8806Control(const DmxBuffer &buffer);
-  void IndividualP9813Control(const DmxBuffer &buffer);
-  void CombinedP9813Control(const DmxBuffer &buffer);
-  void IndividualAPA102Control(const DmxBuffer &buffer);
-  void CombinedAPA102Control(const DmxBuffer &buffer);
-  void IndividualAPA102ControlPixelBrightness(const DmxBuffer &buffer);
-  void CombinedAPA102ControlPixelBrightness(const DmxBuffer &buffer);
+  bool InternalWriteDMX(const DmxBuffer *universes, unsigned int count);
+
+  void IndividualControl(PixelEncoder::Chip chip, const DmxBuffer *universes,
+                         unsigned int count, bool sixteen_bit);
+  void CombinedControl(PixelEncoder::Chip chip, const DmxBuffer &buffer);
+  const uint8_t *SlotData(const DmxBuffer &buffer,
+                          unsigned int *length) const;
+  unsigned int StartFrameBytes(PixelEncoder::Chip chip) const;
+  unsigned int LatchBytes(PixelEncoder::Chip chip) const;
+  unsigned int FootprintPixels(uint16_t slots_per_pixel) const;
 
   unsigned int LPD8806BufferSize() const;
   void WriteSPIData(const uint8_t *data, unsigned int length);
@@ -197,9 +225,7 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
       const ola::rdm::RDMRequest *request);
 
   // Helpers
-  uint8_t P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue);
   static uint8_t CalculateAPA102LatchBytes(uint16_t pixel_count);
-  static uint8_t CalculateAPA102PixelBrightness(uint8_t brightness);
 
   static const uint8_t SPI_MODE;
   static const uint8_t SPI_BITS_PER_WORD;
@@ -211,9 +237,9 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   static const uint16_t P9813_SPI_BYTES_PER_PIXEL;
   static const uint16_t APA102_SLOTS_PER_PIXEL;
   static const uint16_t APA102_PB_SLOTS_PER_PIXEL;
-  static const uint16_t APA102_SPI_BYTES_PER_PIXEL;
+  static const uint16_t WS2801_16BIT_SLOTS_PER_PIXEL;
+  static const uint16_t APA102_16BIT_SLOTS_PER_PIXEL;
   static const uint16_t APA102_START_FRAME_BYTES;
-  static const uint8_t APA102_LEDFRAME_START_MARK;
 
   static const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
       PARAM_HANDLERS[];
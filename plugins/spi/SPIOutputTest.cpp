@@ -30,6 +30,7 @@
 #include "plugins/spi/SPIOutput.h"
 
 using ola::DmxBuffer;
+using ola::plugin::spi::COLOR_ORDER_GRB;
 using ola::plugin::spi::FakeSPIBackend;
 using ola::plugin::spi::SPIBackendInterface;
 using ola::plugin::spi::SPIOutput;
@@ -49,6 +50,9 @@ class SPIOutputTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testCombinedAPA102Control);
   CPPUNIT_TEST(testIndividualAPA102ControlPixelBrightness);
   CPPUNIT_TEST(testCombinedAPA102ControlPixelBrightness);
+  CPPUNIT_TEST(testPixelFormat);
+  CPPUNIT_TEST(testMultipleUniverses);
+  CPPUNIT_TEST(testSixteenBitControl);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,6 +73,9 @@ class SPIOutputTest: public CppUnit::TestFixture {
   void testCombinedAPA102Control();
   void testIndividualAPA102ControlPixelBrightness();
   void testCombinedAPA102ControlPixelBrightness();
+  void testPixelFormat();
+  void testMultipleUniverses();
+  void testSixteenBitControl();
 
  private:
   UID m_uid;
@@ -1139,3 +1146,183 @@ void SPIOutputTest::testCombinedAPA102ControlPixelBrightness() {
   OLA_ASSERT_DATA_EQUALS(EXPECTED8, arraysize(EXPECTED8), data, length);
   OLA_ASSERT_EQ(5u, backend.Writes(0));
 }
+
+/**
+ * Test the color order and correction are applied.
+ */
+void SPIOutputTest::testPixelFormat() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.pixel_format.SetColorOrder(COLOR_ORDER_GRB);
+  options.pixel_format.SetCorrection(1.0, 255, 128, 255);
+  SPIOutput output(m_uid, &backend, options);
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  buffer.SetFromString("10, 20, 30, 255, 1, 2");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = { 20, 5, 30, 1, 128, 2 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, length);
+
+  output.SetPersonality(SPIOutput::PERS_APA102_COMBINED);
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED2[] = { 0, 0, 0, 0,
+                                0xFF, 30, 5, 20,
+                                0xFF, 30, 5, 20,
+                                0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data, length);
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+}
+
+/**
+ * Test a pixel string spanning more than one universe.
+ */
+void SPIOutputTest::testMultipleUniverses() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 300;
+
+  // With a single universe, the footprint is limited to what the universe
+  // can address.
+  {
+    SPIOutput output(m_uid, &backend, options);
+    OLA_ASSERT_EQ(
+        string("Output 0, WS2801 Individual Control, 510 slots @ 1. "
+               "(707a:00000000)"),
+        output.Description());
+    OLA_ASSERT_TRUE(
+        output.SetPersonality(SPIOutput::PERS_APA102_PB_INDIVIDUAL));
+    OLA_ASSERT_NE(string::npos, output.Description().find("512 slots @ 1."));
+    OLA_ASSERT_TRUE(
+        output.SetPersonality(SPIOutput::PERS_WS2801_16BIT_INDIVIDUAL));
+    OLA_ASSERT_NE(string::npos, output.Description().find("510 slots @ 1."));
+  }
+
+  options.pixel_count = 172;
+  options.universe_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+
+  // The footprint only covers the first universe.
+  OLA_ASSERT_EQ(
+      string("Output 0, WS2801 Individual Control, 510 slots @ 1, "
+             "2 universes. (707a:00000000)"),
+      output.Description());
+  OLA_ASSERT_TRUE(output.SetStartAddress(3));
+  OLA_ASSERT_FALSE(output.SetStartAddress(4));
+  OLA_ASSERT_TRUE(output.SetStartAddress(1));
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  // Nothing is sent until the frame is emitted.
+  buffer.SetFromString("1, 2, 3");
+  OLA_ASSERT_TRUE(output.WriteDMX(buffer));
+  buffer.SetFromString("4, 5, 6, 7, 8, 9");
+  OLA_ASSERT_TRUE(output.WriteUniverseDMX(1, buffer));
+  OLA_ASSERT_FALSE(output.WriteUniverseDMX(2, buffer));
+  OLA_ASSERT_EQ(0u, backend.Writes(0));
+
+  output.EmitFrame();
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+  data = backend.GetData(0, &length);
+  OLA_ASSERT_EQ(172u * 3, length);
+  const uint8_t EXPECTED1[] = { 1, 2, 3 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, 3);
+  // The second universe starts at pixel 170.
+  const uint8_t EXPECTED2[] = { 4, 5, 6, 7, 8, 9 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data + 510, 6);
+
+  // Without any new data, nothing is sent.
+  output.EmitFrame();
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  // Updates to one universe keep the data from the others.
+  buffer.SetFromString("10, 11, 12");
+  output.WriteUniverseDMX(1, buffer);
+  buffer.SetFromString("20, 21, 22");
+  output.WriteUniverseDMX(1, buffer);
+  output.EmitFrame();
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  data = backend.GetData(0, &length);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, 3);
+  const uint8_t EXPECTED3[] = { 20, 21, 22, 7, 8, 9 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED3, arraysize(EXPECTED3), data + 510, 6);
+
+  // A long APA102 string, with a start frame and 38 latch bytes.
+  FakeSPIBackend apa102_backend(1);
+  options.pixel_count = 600;
+  options.universe_count = 4;
+  SPIOutput apa102_output(m_uid, &apa102_backend, options);
+  apa102_output.SetPersonality(SPIOutput::PERS_APA102_INDIVIDUAL);
+  buffer.SetFromString("1, 2, 3");
+  apa102_output.WriteUniverseDMX(3, buffer);
+  apa102_output.WriteDMX(buffer);
+  apa102_output.EmitFrame();
+  data = apa102_backend.GetData(0, &length);
+  OLA_ASSERT_EQ(4u + 600 * 4 + 38, length);
+  const uint8_t EXPECTED4[] = { 0, 0, 0, 0, 0xFF, 3, 2, 1, 0xFF };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED4, arraysize(EXPECTED4), data, 9);
+  // Pixel 510 is the first in the last universe.
+  const uint8_t EXPECTED5[] = { 0xFF, 3, 2, 1, 0xFF };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED5, arraysize(EXPECTED5),
+                         data + 4 + 510 * 4, 5);
+}
+
+/**
+ * Test DMX writes in the 16 bit modes.
+ */
+void SPIOutputTest::testSixteenBitControl() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+  output.SetPersonality(SPIOutput::PERS_WS2801_16BIT_INDIVIDUAL);
+  OLA_ASSERT_EQ(
+      string("Output 0, WS2801 16 bit Individual Control, 12 slots @ 1."
+             " (707a:00000000)"),
+      output.Description());
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  buffer.SetFromString("255, 255, 128, 0, 0, 0, 0, 128, 18, 52, 1, 0");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = { 255, 127, 0, 0, 18, 0 };
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, length);
+  const uint8_t FRACTION1[] = { 0, 128, 0, 127, 33, 255 };
+  OLA_ASSERT_NOT_NULL(backend.GetFraction(0));
+  OLA_ASSERT_DATA_EQUALS(FRACTION1, arraysize(FRACTION1),
+                         backend.GetFraction(0), length);
+
+  // The APA102 keeps the start mark for pixels without data, and the header
+  // bytes have no fraction.
+  FakeSPIBackend apa102_backend(1);
+  SPIOutput apa102_output(m_uid, &apa102_backend, options);
+  apa102_output.SetPersonality(SPIOutput::PERS_APA102_16BIT_INDIVIDUAL);
+  buffer.SetFromString("255, 255, 0, 0, 128, 0");
+  apa102_output.WriteDMX(buffer);
+  data = apa102_backend.GetData(0, &length);
+  const uint8_t EXPECTED2[] = { 0, 0, 0, 0,
+                                0xFF, 127, 0, 255,
+                                0xFF, 0, 0, 0,
+                                0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED2, arraysize(EXPECTED2), data, length);
+  const uint8_t FRACTION2[] = { 0, 0, 0, 0,
+                                0, 128, 0, 0,
+                                0, 0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(FRACTION2, arraysize(FRACTION2),
+                         apa102_backend.GetFraction(0), arraysize(FRACTION2));
+
+  // The 8 bit personalities aren't dithered.
+  apa102_output.SetPersonality(SPIOutput::PERS_APA102_INDIVIDUAL);
+  apa102_output.WriteDMX(buffer);
+  OLA_ASSERT_NULL(apa102_backend.GetFraction(0));
+}
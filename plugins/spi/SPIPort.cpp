@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <sstream>
 #include <string>
 #include "ola/Constants.h"
 #include "ola/rdm/RDMCommand.h"
@@ -40,6 +41,7 @@ SPIOutputPort::SPIOutputPort(SPIDevice *parent, SPIBackendInterface *backend,
                              const UID &uid,
                              const SPIOutput::Options &options)
     : BasicOutputPort(parent, options.output_number, true),
+      m_device(parent),
       m_spi_output(uid, backend, options) {
 }
 
@@ -72,14 +74,34 @@ unsigned int SPIOutputPort::PixelCount() const {
   return m_spi_output.PixelCount();
 }
 
+uint8_t SPIOutputPort::UniverseCount() const {
+  return m_spi_output.UniverseCount();
+}
+
 string SPIOutputPort::Description() const {
   return m_spi_output.Description();
 }
 
 bool SPIOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t) {
+  if (m_spi_output.UniverseCount() > 1) {
+    return WriteUniverseDMX(0, buffer);
+  }
   return m_spi_output.WriteDMX(buffer);
 }
 
+bool SPIOutputPort::WriteUniverseDMX(uint8_t universe,
+                                     const DmxBuffer &buffer) {
+  if (!m_spi_output.WriteUniverseDMX(universe, buffer)) {
+    return false;
+  }
+  m_device->FramePending();
+  return true;
+}
+
+void SPIOutputPort::EmitFrame() {
+  m_spi_output.EmitFrame();
+}
+
 void SPIOutputPort::RunFullDiscovery(RDMDiscoveryCallback *callback) {
   return m_spi_output.RunFullDiscovery(callback);
 }
@@ -92,6 +114,25 @@ void SPIOutputPort::SendRDMRequest(ola::rdm::RDMRequest *request,
                                    ola::rdm::RDMCallback *callback) {
   return m_spi_output.SendRDMRequest(request, callback);
 }
+
+SPIUniversePort::SPIUniversePort(SPIDevice *parent, unsigned int port_id,
+                                 SPIOutputPort *output_port, uint8_t universe)
+    : BasicOutputPort(parent, port_id),
+      m_output_port(output_port),
+      m_universe(universe) {
+}
+
+string SPIUniversePort::Description() const {
+  std::ostringstream str;
+  str << "Output " << m_output_port->PortId() << ", universe "
+      << static_cast<int>(m_universe) + 1 << " of "
+      << static_cast<int>(m_output_port->UniverseCount());
+  return str.str();
+}
+
+bool SPIUniversePort::WriteDMX(const DmxBuffer &buffer, uint8_t) {
+  return m_output_port->WriteUniverseDMX(m_universe, buffer);
+}
 }  // namespace spi
 }  // namespace plugin
 }  // namespace ola
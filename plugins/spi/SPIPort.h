@@ -44,9 +44,12 @@ class SPIOutputPort: public BasicOutputPort {
   uint16_t GetStartAddress() const;
   bool SetStartAddress(uint16_t start_address);
   unsigned int PixelCount() const;
+  uint8_t UniverseCount() const;
 
   std::string Description() const;
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+  bool WriteUniverseDMX(uint8_t universe, const DmxBuffer &buffer);
+  void EmitFrame();
 
   void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
@@ -54,8 +57,28 @@ class SPIOutputPort: public BasicOutputPort {
                       ola::rdm::RDMCallback *callback);
 
  private:
+  SPIDevice *m_device;
   SPIOutput m_spi_output;
 };
+
+
+/**
+ * A port which receives one of the universes of a multi-universe
+ * SPIOutputPort. The SPIOutputPort receives the first universe.
+ */
+class SPIUniversePort: public BasicOutputPort {
+ public:
+  SPIUniversePort(SPIDevice *parent, unsigned int port_id,
+                  SPIOutputPort *output_port, uint8_t universe);
+  ~SPIUniversePort() {}
+
+  std::string Description() const;
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+
+ private:
+  SPIOutputPort *m_output_port;
+  const uint8_t m_universe;
+};
 }  // namespace spi
 }  // namespace plugin
 }  // namespace ola
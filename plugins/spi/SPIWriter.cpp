@@ -46,6 +46,7 @@ const uint8_t SPIWriter::SPI_MODE = 0;
 const char SPIWriter::SPI_DEVICE_KEY[] = "device";
 const char SPIWriter::SPI_ERROR_VAR[] = "spi-write-errors";
 const char SPIWriter::SPI_WRITE_VAR[] = "spi-writes";
+const unsigned int SPIWriter::MAX_TRANSFERS;
 
 SPIWriter::SPIWriter(const string &spi_device,
                      const Options &options,
@@ -105,16 +106,34 @@ bool SPIWriter::Init() {
 }
 
 bool SPIWriter::WriteSPIData(const uint8_t *data, unsigned int length) {
-  struct spi_ioc_transfer spi;
-  memset(&spi, 0, sizeof(spi));
-  spi.tx_buf = reinterpret_cast<__u64>(data);
-  spi.len = length;
+  SPITransfer transfer(data, length);
+  return WriteSPITransfers(&transfer, 1);
+}
+
+bool SPIWriter::WriteSPITransfers(const SPITransfer *transfers,
+                                  unsigned int count) {
+  if (count == 0 || count > MAX_TRANSFERS) {
+    OLA_WARN << "Invalid number of SPI transfers: " << count;
+    return false;
+  }
+
+  m_transfers.resize(count);
+  memset(&m_transfers[0], 0, count * sizeof(m_transfers[0]));
+  unsigned int length = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    m_transfers[i].tx_buf = reinterpret_cast<__u64>(transfers[i].data);
+    m_transfers[i].len = transfers[i].length;
+    length += transfers[i].length;
+  }
 
   if (m_write_map_var) {
     (*m_write_map_var)[m_device_path]++;
   }
 
-  int bytes_written = ioctl(m_fd, SPI_IOC_MESSAGE(1), &spi);
+  // SPI_IOC_MESSAGE() needs a constant, so build the request ourselves.
+  unsigned long request;  // NOLINT(runtime/int)
+  request = _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0, SPI_MSGSIZE(count));
+  int bytes_written = ioctl(m_fd, request, &m_transfers[0]);
   if (bytes_written != static_cast<int>(length)) {
     OLA_WARN << "Failed to write all the SPI data: " << strerror(errno);
     if (m_error_map_var) {
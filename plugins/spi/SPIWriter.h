@@ -21,15 +21,30 @@
 #ifndef PLUGINS_SPI_SPIWRITER_H_
 #define PLUGINS_SPI_SPIWRITER_H_
 
+#include <linux/spi/spidev.h>
 #include <ola/ExportMap.h>
 #include <ola/thread/Mutex.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace plugin {
 namespace spi {
 
+/**
+ * A block of data to write as part of an SPI message.
+ */
+struct SPITransfer {
+  const uint8_t *data;
+  unsigned int length;
+
+  SPITransfer(const uint8_t *data, unsigned int length)
+      : data(data),
+        length(length) {
+  }
+};
+
 /**
  * The interface for the SPI Writer
  */
@@ -40,6 +55,15 @@ class SPIWriterInterface {
   virtual std::string DevicePath() const = 0;
   virtual bool Init() = 0;
   virtual bool WriteSPIData(const uint8_t *data, unsigned int length) = 0;
+
+  /**
+   * Write several blocks of data as a single SPI message, so the chip select
+   * stays asserted between them.
+   * @param transfers the blocks of data.
+   * @param count the number of blocks.
+   */
+  virtual bool WriteSPITransfers(const SPITransfer *transfers,
+                                 unsigned int count) = 0;
 };
 
 /**
@@ -70,6 +94,7 @@ class SPIWriter : public SPIWriterInterface {
   bool Init();
 
   bool WriteSPIData(const uint8_t *data, unsigned int length);
+  bool WriteSPITransfers(const SPITransfer *transfers, unsigned int count);
 
  private:
   const std::string m_device_path;
@@ -78,12 +103,15 @@ class SPIWriter : public SPIWriterInterface {
   int m_fd;
   UIntMap *m_error_map_var;
   UIntMap *m_write_map_var;
+  std::vector<struct spi_ioc_transfer> m_transfers;
 
   static const uint8_t SPI_MODE;
   static const uint8_t SPI_BITS_PER_WORD;
   static const char SPI_DEVICE_KEY[];
   static const char SPI_ERROR_VAR[];
   static const char SPI_WRITE_VAR[];
+  // The ioctl request holds the size of the transfers in 14 bits.
+  static const unsigned int MAX_TRANSFERS = 511;
 };
 }  // namespace spi
 }  // namespace plugin
@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBuffer.cpp
+ * Passes frames of SPI data from one thread to another without locking.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "plugins/spi/TripleBuffer.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+const uint32_t TripleBuffer::FRESH;
+const uint32_t TripleBuffer::INDEX_MASK;
+
+namespace {
+
+#ifdef __ATOMIC_ACQ_REL
+inline uint32_t Exchange(uint32_t *value, uint32_t new_value) {
+  return __atomic_exchange_n(value, new_value, __ATOMIC_ACQ_REL);
+}
+
+inline uint32_t Load(const uint32_t *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+#else
+inline uint32_t Exchange(uint32_t *value, uint32_t new_value) {
+  __sync_synchronize();
+  uint32_t old_value = __sync_lock_test_and_set(value, new_value);
+  __sync_synchronize();
+  return old_value;
+}
+
+inline uint32_t Load(const uint32_t *value) {
+  return *const_cast<const volatile uint32_t*>(value);
+}
+#endif  // __ATOMIC_ACQ_REL
+}  // namespace
+
+TripleBuffer::TripleBuffer()
+    : m_back(0),
+      m_last(0),
+      m_front(1),
+      m_middle(2) {
+  for (unsigned int i = 0; i < 3; i++) {
+    m_frames[i].data = NULL;
+    m_frames[i].length = 0;
+    m_frames[i].latch_bytes = 0;
+    m_frames[i].capacity = 0;
+    m_frames[i].dithered = false;
+  }
+}
+
+TripleBuffer::~TripleBuffer() {
+  for (unsigned int i = 0; i < 3; i++) {
+    delete[] m_frames[i].data;
+  }
+}
+
+uint8_t *TripleBuffer::Checkout(unsigned int length,
+                                unsigned int latch_bytes,
+                                uint8_t **fraction) {
+  Frame *frame = &m_frames[m_back];
+  const unsigned int size = length + latch_bytes;
+  const unsigned int capacity = fraction ? size + length : size;
+  if (capacity > frame->capacity) {
+    // The old data may still be needed if this is a second Checkout().
+    uint8_t *data = new uint8_t[capacity];
+    if (m_last == m_back && frame->data) {
+      memcpy(data, frame->data, frame->capacity);
+    }
+    delete[] frame->data;
+    frame->data = data;
+    frame->capacity = capacity;
+  }
+
+  // Unless this is a second Checkout() without a Commit(), the back buffer
+  // holds an older frame, so copy the last one. The consumer may be reading
+  // it, but nothing writes to it until it's swapped back.
+  const Frame &last = m_frames[m_last];
+  const unsigned int copied = std::min(length, last.length);
+  const uint8_t *last_fraction = last.dithered ?
+      last.data + last.length + last.latch_bytes : NULL;
+  uint8_t *new_fraction = frame->data + size;
+  if (fraction) {
+    // Copy the fraction first, a second Checkout() can move it forwards.
+    if (last_fraction) {
+      memmove(new_fraction, last_fraction, copied);
+      memset(new_fraction + copied, 0, length - copied);
+    } else {
+      memset(new_fraction, 0, length);
+    }
+    *fraction = new_fraction;
+  }
+  if (m_last != m_back) {
+    memcpy(frame->data, last.data, copied);
+  }
+  memset(frame->data + copied, 0, size - copied);
+  frame->length = length;
+  frame->latch_bytes = latch_bytes;
+  frame->dithered = fraction != NULL;
+  m_last = m_back;
+  return frame->data;
+}
+
+bool TripleBuffer::Commit() {
+  const uint32_t previous = Exchange(&m_middle, m_back | FRESH);
+  m_last = m_back;
+  m_back = previous & INDEX_MASK;
+  return !(previous & FRESH);
+}
+
+bool TripleBuffer::Fetch() {
+  if (!(Load(&m_middle) & FRESH)) {
+    return false;
+  }
+  m_front = Exchange(&m_middle, m_front) & INDEX_MASK;
+  return true;
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
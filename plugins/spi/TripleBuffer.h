@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBuffer.h
+ * Passes frames of SPI data from one thread to another without locking.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_SPI_TRIPLEBUFFER_H_
+#define PLUGINS_SPI_TRIPLEBUFFER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * A triple buffer holding the frames for an SPI output.
+ *
+ * The producer writes a frame into the back buffer, and Commit() swaps it
+ * with the middle buffer. The consumer calls Fetch() which swaps the middle
+ * buffer with the front buffer if a new frame has been committed. Neither
+ * side ever waits for the other, and the consumer always gets the most
+ * recent frame.
+ *
+ * A frame can also have a fraction plane, which holds the fractional part of
+ * each byte for temporal dithering.
+ *
+ * Checkout() and Commit() must be called from one thread, and Fetch(), Data(),
+ * Fraction(), Length() and LatchBytes() from another.
+ */
+class TripleBuffer {
+ public:
+  TripleBuffer();
+  ~TripleBuffer();
+
+  /**
+   * Get the back buffer to write a frame into.
+   * @param length the size of the frame.
+   * @param latch_bytes the number of zero bytes to send after the frame.
+   * @param fraction if not NULL, this is set to the fraction plane of the
+   *   frame, which is length bytes.
+   * @returns the frame, which contains the data from the last committed frame.
+   */
+  uint8_t *Checkout(unsigned int length, unsigned int latch_bytes,
+                    uint8_t **fraction = NULL);
+
+  /**
+   * Make the frame returned by Checkout() available to the consumer.
+   * @returns false if the previous frame hadn't been fetched, and was dropped.
+   */
+  bool Commit();
+
+  /**
+   * Fetch the most recent frame.
+   * @returns true if there was a new frame, false if the front buffer is
+   *   unchanged.
+   */
+  bool Fetch();
+
+  /**
+   * The frame data in the front buffer, this is followed by LatchBytes()
+   * zeros.
+   */
+  const uint8_t *Data() const { return m_frames[m_front].data; }
+
+  /**
+   * The fraction plane of the front buffer, or NULL if it doesn't have one.
+   */
+  const uint8_t *Fraction() const {
+    const Frame &frame = m_frames[m_front];
+    return frame.dithered ? frame.data + frame.length + frame.latch_bytes :
+        NULL;
+  }
+
+  /**
+   * The size of the frame in the front buffer.
+   */
+  unsigned int Length() const { return m_frames[m_front].length; }
+
+  /**
+   * The number of latch bytes for the front buffer.
+   */
+  unsigned int LatchBytes() const { return m_frames[m_front].latch_bytes; }
+
+ private:
+  struct Frame {
+    uint8_t *data;
+    unsigned int length;
+    unsigned int latch_bytes;
+    unsigned int capacity;
+    bool dithered;
+  };
+
+  Frame m_frames[3];
+  unsigned int m_back;  // Only used by the producer.
+  // The frame with the most recent data, only used by the producer.
+  unsigned int m_last;
+  unsigned int m_front;  // Only used by the consumer.
+  // The index of the middle buffer, and the FRESH bit if it hasn't been
+  // fetched.
+  uint32_t m_middle;
+
+  static const uint32_t FRESH = 0x4;
+  static const uint32_t INDEX_MASK = 0x3;
+
+  TripleBuffer(const TripleBuffer&);
+  TripleBuffer& operator=(const TripleBuffer&);
+};
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_TRIPLEBUFFER_H_
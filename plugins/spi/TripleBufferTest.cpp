@@ -0,0 +1,285 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TripleBufferTest.cpp
+ * Test fixture for the TripleBuffer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+#include "ola/base/Array.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "plugins/spi/TripleBuffer.h"
+
+using ola::plugin::spi::TripleBuffer;
+
+class TripleBufferTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TripleBufferTest);
+  CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testCommitAndFetch);
+  CPPUNIT_TEST(testNewestFrame);
+  CPPUNIT_TEST(testCheckoutCopiesLastFrame);
+  CPPUNIT_TEST(testFraction);
+  CPPUNIT_TEST(testConcurrentAccess);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testEmpty();
+  void testCommitAndFetch();
+  void testNewestFrame();
+  void testCheckoutCopiesLastFrame();
+  void testFraction();
+  void testConcurrentAccess();
+
+ private:
+  static const uint8_t DATA1[];
+  static const uint8_t DATA2[];
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TripleBufferTest);
+
+const uint8_t TripleBufferTest::DATA1[] = {1, 2, 3, 4, 5, 6, 7, 8};
+const uint8_t TripleBufferTest::DATA2[] = {0xa, 0xb, 0xc, 0xd};
+
+namespace {
+
+/**
+ * Commits frames where every byte is the low byte of the frame number.
+ */
+class Producer : public ola::thread::Thread {
+ public:
+  Producer(TripleBuffer *buffer, unsigned int frames)
+      : m_buffer(buffer),
+        m_frames(frames),
+        m_drops(0),
+        m_done(false) {
+  }
+
+  unsigned int Drops() const { return m_drops; }
+
+  bool Done() {
+    ola::thread::MutexLocker lock(&m_mutex);
+    return m_done;
+  }
+
+  static const unsigned int FRAME_SIZE = 512;
+
+ protected:
+  void *Run() {
+    for (unsigned int i = 1; i <= m_frames; i++) {
+      uint8_t *data = m_buffer->Checkout(FRAME_SIZE, 0);
+      memset(data, i & 0xff, FRAME_SIZE);
+      if (!m_buffer->Commit()) {
+        m_drops++;
+      }
+    }
+    ola::thread::MutexLocker lock(&m_mutex);
+    m_done = true;
+    return NULL;
+  }
+
+ private:
+  TripleBuffer *m_buffer;
+  const unsigned int m_frames;
+  unsigned int m_drops;
+  bool m_done;  // GUARDED_BY(m_mutex)
+  ola::thread::Mutex m_mutex;
+};
+
+const unsigned int Producer::FRAME_SIZE;
+}  // namespace
+
+/**
+ * Check nothing is fetched before the first commit.
+ */
+void TripleBufferTest::testEmpty() {
+  TripleBuffer buffer;
+  OLA_ASSERT_FALSE(buffer.Fetch());
+  OLA_ASSERT_EQ(0u, buffer.Length());
+  OLA_ASSERT_EQ(0u, buffer.LatchBytes());
+}
+
+/**
+ * Check a committed frame is fetched once, followed by the latch bytes.
+ */
+void TripleBufferTest::testCommitAndFetch() {
+  TripleBuffer buffer;
+  uint8_t *data = buffer.Checkout(arraysize(DATA1), 2);
+  OLA_ASSERT_NOT_NULL(data);
+  memcpy(data, DATA1, arraysize(DATA1));
+  OLA_ASSERT_TRUE(buffer.Commit());
+
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  const uint8_t expected[] = {1, 2, 3, 4, 5, 6, 7, 8, 0, 0};
+  OLA_ASSERT_EQ(8u, buffer.Length());
+  OLA_ASSERT_EQ(2u, buffer.LatchBytes());
+  OLA_ASSERT_DATA_EQUALS(expected, arraysize(expected), buffer.Data(),
+                         buffer.Length() + buffer.LatchBytes());
+
+  // Nothing new to fetch, the front buffer is unchanged.
+  OLA_ASSERT_FALSE(buffer.Fetch());
+  OLA_ASSERT_DATA_EQUALS(expected, arraysize(expected), buffer.Data(),
+                         buffer.Length() + buffer.LatchBytes());
+}
+
+/**
+ * Check that the consumer only sees the most recent frame.
+ */
+void TripleBufferTest::testNewestFrame() {
+  TripleBuffer buffer;
+  uint8_t *data = buffer.Checkout(arraysize(DATA1), 0);
+  memcpy(data, DATA1, arraysize(DATA1));
+  OLA_ASSERT_TRUE(buffer.Commit());
+
+  data = buffer.Checkout(arraysize(DATA2), 0);
+  memcpy(data, DATA2, arraysize(DATA2));
+  // The first frame was never fetched.
+  OLA_ASSERT_FALSE(buffer.Commit());
+
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  OLA_ASSERT_DATA_EQUALS(DATA2, arraysize(DATA2), buffer.Data(),
+                         buffer.Length());
+  OLA_ASSERT_FALSE(buffer.Fetch());
+
+  // Once the front buffer is held by the consumer, the producer can commit
+  // again without dropping.
+  data = buffer.Checkout(arraysize(DATA1), 0);
+  memcpy(data, DATA1, arraysize(DATA1));
+  OLA_ASSERT_TRUE(buffer.Commit());
+  OLA_ASSERT_DATA_EQUALS(DATA2, arraysize(DATA2), buffer.Data(),
+                         buffer.Length());
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  OLA_ASSERT_DATA_EQUALS(DATA1, arraysize(DATA1), buffer.Data(),
+                         buffer.Length());
+}
+
+/**
+ * Check that Checkout() returns the data from the last committed frame.
+ */
+void TripleBufferTest::testCheckoutCopiesLastFrame() {
+  TripleBuffer buffer;
+  uint8_t *data = buffer.Checkout(arraysize(DATA1), 0);
+  memcpy(data, DATA1, arraysize(DATA1));
+  buffer.Commit();
+
+  // A longer frame is padded with zeros.
+  data = buffer.Checkout(10, 0);
+  const uint8_t expected1[] = {1, 2, 3, 4, 5, 6, 7, 8, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(expected1, arraysize(expected1), data, 10);
+  memcpy(data, DATA2, arraysize(DATA2));
+  buffer.Commit();
+
+  // A shorter frame is truncated, and the latch bytes are zero.
+  data = buffer.Checkout(6, 2);
+  const uint8_t expected2[] = {0xa, 0xb, 0xc, 0xd, 5, 6, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(expected2, arraysize(expected2), data, 8);
+
+  // Checking out again without a commit keeps the changes.
+  data[0] = 0xff;
+  data = buffer.Checkout(6, 2);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xff), data[0]);
+  buffer.Commit();
+
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  const uint8_t expected3[] = {0xff, 0xb, 0xc, 0xd, 5, 6, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(expected3, arraysize(expected3), buffer.Data(),
+                         buffer.Length() + buffer.LatchBytes());
+}
+
+/**
+ * Check frames with a fraction plane.
+ */
+void TripleBufferTest::testFraction() {
+  TripleBuffer buffer;
+  uint8_t *fraction = NULL;
+  uint8_t *data = buffer.Checkout(arraysize(DATA2), 2, &fraction);
+  OLA_ASSERT_NOT_NULL(fraction);
+  const uint8_t zeros[] = {0, 0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(zeros, arraysize(zeros), fraction, 4);
+  memcpy(data, DATA2, arraysize(DATA2));
+  memcpy(fraction, DATA1, 4);
+  OLA_ASSERT_TRUE(buffer.Commit());
+
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  const uint8_t expected1[] = {0xa, 0xb, 0xc, 0xd, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(expected1, arraysize(expected1), buffer.Data(),
+                         buffer.Length() + buffer.LatchBytes());
+  OLA_ASSERT_NOT_NULL(buffer.Fraction());
+  OLA_ASSERT_DATA_EQUALS(DATA1, 4, buffer.Fraction(), buffer.Length());
+
+  // The fraction is copied from the last frame, and padded with zeros.
+  data = buffer.Checkout(6, 2, &fraction);
+  const uint8_t expected2[] = {1, 2, 3, 4, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(expected2, arraysize(expected2), fraction, 6);
+
+  // Checking out a smaller frame without a commit keeps the fraction.
+  data = buffer.Checkout(4, 0, &fraction);
+  OLA_ASSERT_DATA_EQUALS(DATA1, 4, fraction, 4);
+  OLA_ASSERT_DATA_EQUALS(DATA2, arraysize(DATA2), data, 4);
+  buffer.Commit();
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  OLA_ASSERT_EQ(0u, buffer.LatchBytes());
+  OLA_ASSERT_DATA_EQUALS(DATA1, 4, buffer.Fraction(), buffer.Length());
+
+  // A frame without a fraction.
+  buffer.Checkout(4, 0);
+  buffer.Commit();
+  OLA_ASSERT_TRUE(buffer.Fetch());
+  OLA_ASSERT_NULL(buffer.Fraction());
+  OLA_ASSERT_DATA_EQUALS(DATA2, arraysize(DATA2), buffer.Data(),
+                         buffer.Length());
+}
+
+/**
+ * Check the consumer never sees a partially written frame, and that every
+ * frame is either fetched or counted as a drop.
+ */
+void TripleBufferTest::testConcurrentAccess() {
+  const unsigned int frames = 50000;
+  TripleBuffer buffer;
+  Producer producer(&buffer, frames);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  unsigned int fetched = 0;
+  unsigned int last_value = 0;
+  bool torn = false;
+  while (true) {
+    const bool done = producer.Done();
+    if (!buffer.Fetch()) {
+      if (done) {
+        break;
+      }
+      continue;
+    }
+    fetched++;
+    OLA_ASSERT_EQ(Producer::FRAME_SIZE, buffer.Length());
+    const uint8_t *data = buffer.Data();
+    for (unsigned int i = 1; i < Producer::FRAME_SIZE; i++) {
+      if (data[i] != data[0]) {
+        torn = true;
+      }
+    }
+    last_value = data[0];
+  }
+  producer.Join();
+
+  OLA_ASSERT_FALSE(torn);
+  OLA_ASSERT_EQ(frames & 0xff, last_value);
+  OLA_ASSERT_EQ(frames, fetched + producer.Drops());
+}
@@ -36,6 +36,8 @@ const char UartDmxDevice::K_MALF[] = "-malf";
 const char UartDmxDevice::K_BREAK[] = "-break";
 const unsigned int UartDmxDevice::DEFAULT_BREAK = 100;
 const unsigned int UartDmxDevice::DEFAULT_MALF = 100;
+const char UartDmxDevice::K_SPIN_WAIT[] = "-spin-wait";
+const unsigned int UartDmxDevice::DEFAULT_SPIN_WAIT = 0;
 
 
 UartDmxDevice::UartDmxDevice(AbstractPlugin *owner,
@@ -57,6 +59,11 @@ UartDmxDevice::UartDmxDevice(AbstractPlugin *owner,
   if (!StringToInt(m_preferences->GetValue(DeviceMalfKey()), &m_malft)) {
     m_malft = DEFAULT_MALF;
   }
+  // Maximum busy wait in microseconds
+  if (!StringToInt(m_preferences->GetValue(DeviceSpinWaitKey()),
+                   &m_spin_wait)) {
+    m_spin_wait = DEFAULT_SPIN_WAIT;
+  }
   m_widget.reset(new UartWidget(path));
 }
 
@@ -67,7 +74,8 @@ UartDmxDevice::~UartDmxDevice() {
 }
 
 bool UartDmxDevice::StartHook() {
-  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_breakt, m_malft));
+  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_breakt, m_malft,
+                                m_spin_wait));
   return true;
 }
 
@@ -77,6 +85,9 @@ string UartDmxDevice::DeviceMalfKey() const {
 string UartDmxDevice::DeviceBreakKey() const {
   return m_path + K_BREAK;
 }
+string UartDmxDevice::DeviceSpinWaitKey() const {
+  return m_path + K_SPIN_WAIT;
+}
 
 /**
  * Set the default preferences for this one Device
@@ -94,6 +105,9 @@ void UartDmxDevice::SetDefaults() {
   save |= m_preferences->SetDefaultValue(DeviceMalfKey(),
                                          UIntValidator(8, 1000000),
                                          DEFAULT_MALF);
+  save |= m_preferences->SetDefaultValue(DeviceSpinWaitKey(),
+                                         UIntValidator(0, 5000),
+                                         DEFAULT_SPIN_WAIT);
   if (save) {
     m_preferences->Save();
   }
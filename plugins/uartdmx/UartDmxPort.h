@@ -41,10 +41,11 @@ class UartDmxOutputPort : public ola::BasicOutputPort {
                     unsigned int id,
                     UartWidget *widget,
                     unsigned int breakt,
-                    unsigned int malft)
+                    unsigned int malft,
+                    unsigned int spin_wait)
       : BasicOutputPort(parent, id),
         m_widget(widget),
-        m_thread(widget, breakt, malft) {
+        m_thread(widget, breakt, malft, spin_wait) {
     m_thread.Start();
   }
   ~UartDmxOutputPort() { m_thread.Stop(); }
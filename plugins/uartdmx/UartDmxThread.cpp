@@ -19,12 +19,11 @@
  * Copyright (C) 2014 Richard Ash
  */
 
-#include <math.h>
-#include <unistd.h>
 #include <string>
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/FrameTimer.h"
 #include "plugins/uartdmx/UartWidget.h"
 #include "plugins/uartdmx/UartDmxThread.h"
 
@@ -33,12 +32,12 @@ namespace plugin {
 namespace uartdmx {
 
 UartDmxThread::UartDmxThread(UartWidget *widget, unsigned int breakt,
-                             unsigned int malft)
-  : m_granularity(UNKNOWN),
-    m_widget(widget),
+                             unsigned int malft, unsigned int spin_wait)
+  : m_widget(widget),
     m_term(false),
     m_breakt(breakt),
-    m_malft(malft) {
+    m_malft(malft),
+    m_spin_wait(spin_wait) {
 }
 
 UartDmxThread::~UartDmxThread() {
@@ -72,9 +71,9 @@ bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * The method called by the thread
  */
 void *UartDmxThread::Run() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  CheckTimeGranularity();
+  // The frames are sent back to back, so we only use the timer for the
+  // delays.
+  ola::thread::FrameTimer timer((TimeInterval()), TimeInterval(m_spin_wait));
   DmxBuffer buffer;
 
   // Setup the widget
@@ -93,49 +92,19 @@ void *UartDmxThread::Run() {
       buffer.Set(m_buffer);
     }
 
-    if (!m_widget->SetBreak(true))
-      goto framesleep;
-
-    if (m_granularity == GOOD)
-      usleep(m_breakt);
-
-    if (!m_widget->SetBreak(false))
-      goto framesleep;
-
-    if (m_granularity == GOOD)
-      usleep(DMX_MAB);
-
-    if (!m_widget->Write(buffer))
-      goto framesleep;
+    if (m_widget->SetBreak(true)) {
+      timer.Sleep(TimeInterval(m_breakt));
+      if (m_widget->SetBreak(false)) {
+        timer.Sleep(TimeInterval(DMX_MAB));
+        m_widget->Write(buffer);
+      }
+    }
 
-  framesleep:
     // Sleep for the remainder of the DMX frame time
-    usleep(m_malft);
+    timer.Sleep(TimeInterval(m_malft));
   }
   return NULL;
 }
-
-
-/**
- * Check the granularity of usleep.
- */
-void UartDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  /** If sleeping for 1ms takes longer than this, don't trust
-   * usleep for this session
-   */
-  const int threshold = 3;
-
-  clock.CurrentTime(&ts1);
-  usleep(1000);
-  clock.CurrentTime(&ts2);
-
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = interval.InMilliSeconds() > threshold ? BAD : GOOD;
-  OLA_INFO << "Granularity for UART thread is "
-           << (m_granularity == GOOD ? "GOOD" : "BAD");
-}
 }  // namespace uartdmx
 }  // namespace plugin
 }  // namespace ola
@@ -31,7 +31,8 @@ namespace uartdmx {
 
 class UartDmxThread : public ola::thread::Thread {
  public:
-  UartDmxThread(UartWidget *widget, unsigned int breakt, unsigned int malft);
+  UartDmxThread(UartWidget *widget, unsigned int breakt, unsigned int malft,
+                unsigned int spin_wait = 0);
   ~UartDmxThread();
 
   bool Stop();
@@ -39,19 +40,15 @@ class UartDmxThread : public ola::thread::Thread {
   bool WriteDMX(const DmxBuffer &buffer);
 
  private:
-  enum TimerGranularity { UNKNOWN, GOOD, BAD };
-
-  TimerGranularity m_granularity;
   UartWidget *m_widget;
   bool m_term;
   unsigned int m_breakt;
   unsigned int m_malft;
+  unsigned int m_spin_wait;
   DmxBuffer m_buffer;
   ola::thread::Mutex m_term_mutex;
   ola::thread::Mutex m_buffer_mutex;
 
-  void CheckTimeGranularity();
-
   static const uint32_t DMX_MAB = 16;
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxThread);
@@ -0,0 +1,346 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * AsyncUsbSenderTest.cpp
+ * Test fixture for the asynchronous widgets, using a FakeLibUsbAdaptor.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <libusb.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/usbdmx/AnymauDMX.h"
+#include "plugins/usbdmx/DMXCProjectsNodleU1.h"
+#include "plugins/usbdmx/DMXCreator512Basic.h"
+#include "plugins/usbdmx/EurolitePro.h"
+#include "plugins/usbdmx/FakeLibUsbAdaptor.h"
+#include "plugins/usbdmx/Sunlite.h"
+#include "plugins/usbdmx/Widget.h"
+
+using ola::DmxBuffer;
+using ola::plugin::usbdmx::AsynchronousAnymauDMX;
+using ola::plugin::usbdmx::AsynchronousDMXCProjectsNodleU1;
+using ola::plugin::usbdmx::AsynchronousDMXCreator512Basic;
+using ola::plugin::usbdmx::AsynchronousEurolitePro;
+using ola::plugin::usbdmx::DMXCProjectsNodleU1;
+using ola::plugin::usbdmx::AsynchronousSunlite;
+using ola::plugin::usbdmx::FakeLibUsbAdaptor;
+using ola::plugin::usbdmx::WidgetInterface;
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * A widget under test, and what was delivered to it.
+ */
+struct TestWidget {
+  string name;
+  WidgetInterface *widget;
+  libusb_device_handle *handle;
+  // The number of transfers used to send one frame.
+  unsigned int transfers_per_frame;
+  // The offset of a DMX slot in the buffer of the last transfer.
+  unsigned int slot_offset;
+
+  // When the transfer in flight was submitted, or -1 if there isn't one.
+  int64_t started;
+  unsigned int transfers;
+  unsigned int frames;
+  // The frames which completed within the duration of the run.
+  unsigned int frames_in_duration;
+  int64_t max_latency;
+  uint8_t last_frame;
+  bool overlapped;
+};
+}  // namespace
+
+class AsyncUsbSenderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(AsyncUsbSenderTest);
+  CPPUNIT_TEST(testSlowInput);
+  CPPUNIT_TEST(testCoalescing);
+  CPPUNIT_TEST(testDisconnect);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testSlowInput();
+  void testCoalescing();
+  void testDisconnect();
+
+ private:
+  FakeLibUsbAdaptor m_adaptor;
+  vector<TestWidget> m_widgets;
+  // The time each frame id was last sent.
+  int64_t m_sent[256];
+  int64_t m_now;
+
+  // Fake libusb_devices, only the addresses are used.
+  uint8_t m_devices[5];
+  // The most transfers any widget uses to send one frame.
+  unsigned int m_max_transfers_per_frame;
+
+  void AddWidget(const string &name, WidgetInterface *widget,
+                 uint8_t *device, unsigned int transfers_per_frame,
+                 unsigned int slot_offset);
+  void Run(int64_t duration, int64_t input_period, int64_t wire_time);
+  void SendFrame(unsigned int frame);
+  void UpdateTransfers(int64_t wire_time);
+
+  static const int64_t STEP = 50;  // in microseconds
+  static const int64_t DURATION = 1000000;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AsyncUsbSenderTest);
+
+const int64_t AsyncUsbSenderTest::STEP;
+const int64_t AsyncUsbSenderTest::DURATION;
+
+void AsyncUsbSenderTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_now = 0;
+  m_max_transfers_per_frame = 0;
+  for (unsigned int i = 0; i < 256; i++) {
+    m_sent[i] = -1;
+  }
+
+  AddWidget("Anyma",
+            new AsynchronousAnymauDMX(
+                &m_adaptor, FakeLibUsbAdaptor::FakeDevice(&m_devices[0]), ""),
+            &m_devices[0], 1, LIBUSB_CONTROL_SETUP_SIZE);
+  AddWidget("DMXCreator512Basic",
+            new AsynchronousDMXCreator512Basic(
+                &m_adaptor, FakeLibUsbAdaptor::FakeDevice(&m_devices[1]), ""),
+            &m_devices[1], 3, 0);
+  AddWidget("Sunlite",
+            new AsynchronousSunlite(
+                &m_adaptor, FakeLibUsbAdaptor::FakeDevice(&m_devices[2])),
+            &m_devices[2], 1, 3);
+  AddWidget("EurolitePro",
+            new AsynchronousEurolitePro(
+                &m_adaptor, FakeLibUsbAdaptor::FakeDevice(&m_devices[3]), "",
+                false),
+            &m_devices[3], 1, 5);
+  // Output only, the fake adaptor can't feed the receiver. The Nodle sends 32
+  // slots per transfer, after a block number.
+  AddWidget("DMXCProjectsNodleU1",
+            new AsynchronousDMXCProjectsNodleU1(
+                &m_adaptor, FakeLibUsbAdaptor::FakeDevice(&m_devices[4]),
+                NULL, "", DMXCProjectsNodleU1::OUTPUT_ENABLE_MASK),
+            &m_devices[4], ola::DMX_UNIVERSE_SIZE / 32, 1);
+}
+
+void AsyncUsbSenderTest::tearDown() {
+  // The fake adaptor can't cancel transfers, so complete them first.
+  vector<TestWidget>::iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    while (m_adaptor.CompleteTransfer(iter->handle)) {}
+    delete iter->widget;
+  }
+  m_widgets.clear();
+}
+
+/*
+ * Check every frame is delivered when the input is slower than the wire.
+ */
+void AsyncUsbSenderTest::testSlowInput() {
+  const int64_t wire_time = 1000;
+  // Longer than the slowest widget takes to send a frame.
+  const int64_t input_period = 20000;
+  OLA_ASSERT_TRUE(m_max_transfers_per_frame * wire_time < input_period);
+  Run(DURATION, input_period, wire_time);
+
+  const unsigned int frames = DURATION / input_period;
+  vector<TestWidget>::const_iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    OLA_ASSERT_FALSE_MSG(iter->overlapped, iter->name);
+    OLA_ASSERT_EQ_MSG(frames, iter->frames, iter->name);
+    OLA_ASSERT_EQ_MSG(frames * iter->transfers_per_frame, iter->transfers,
+                      iter->name);
+    OLA_ASSERT_EQ_MSG(
+        static_cast<uint8_t>(frames), iter->last_frame, iter->name);
+    // Each frame goes straight out.
+    OLA_ASSERT_EQ_MSG(iter->transfers_per_frame * wire_time,
+                      iter->max_latency, iter->name);
+  }
+}
+
+/*
+ * Check frames are coalesced when the input is faster than the wire. Each
+ * widget should run at the rate the wire allows, the newest frame should
+ * always go out, and no frame should wait more than two frame times.
+ */
+void AsyncUsbSenderTest::testCoalescing() {
+  const int64_t wire_time = 1000;
+  const int64_t input_period = 250;
+  Run(DURATION, input_period, wire_time);
+
+  const unsigned int frames = DURATION / input_period;
+  vector<TestWidget>::const_iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    OLA_ASSERT_FALSE_MSG(iter->overlapped, iter->name);
+    const int64_t frame_time = iter->transfers_per_frame * wire_time;
+    const unsigned int expected = DURATION / frame_time;
+    OLA_ASSERT_TRUE_MSG(iter->frames_in_duration + 1 >= expected,
+                        iter->name);
+    OLA_ASSERT_TRUE_MSG(iter->frames_in_duration <= expected, iter->name);
+    OLA_ASSERT_EQ_MSG(static_cast<uint8_t>(frames), iter->last_frame,
+                      iter->name);
+    OLA_ASSERT_TRUE_MSG(iter->max_latency <= 2 * frame_time, iter->name);
+    OLA_INFO << iter->name << ": " << iter->frames_in_duration
+             << " frames/s, max latency " << iter->max_latency << "us";
+  }
+}
+
+/*
+ * Check a widget stops sending once the device is unplugged, without
+ * affecting the other widgets.
+ */
+void AsyncUsbSenderTest::testDisconnect() {
+  SendFrame(1);
+  const TestWidget &unplugged = m_widgets[0];
+  OLA_ASSERT_EQ(1u, m_adaptor.PendingTransfers(unplugged.handle));
+  OLA_ASSERT_TRUE(m_adaptor.CompleteTransfer(unplugged.handle,
+                                             LIBUSB_TRANSFER_NO_DEVICE));
+
+  SendFrame(2);
+  OLA_ASSERT_EQ(0u, m_adaptor.PendingTransfers(unplugged.handle));
+  for (unsigned int i = 1; i < m_widgets.size(); i++) {
+    OLA_ASSERT_EQ(1u, m_adaptor.PendingTransfers(m_widgets[i].handle));
+  }
+
+  // A failed submit leaves the widget idle, so the next frame is tried.
+  const TestWidget &sunlite = m_widgets[2];
+  OLA_ASSERT_TRUE(m_adaptor.CompleteTransfer(sunlite.handle));
+  OLA_ASSERT_TRUE(m_adaptor.CompleteTransfer(sunlite.handle));
+  m_adaptor.SetSubmitError(LIBUSB_ERROR_IO);
+  OLA_ASSERT_TRUE(sunlite.widget->SendDMX(DmxBuffer()));
+  OLA_ASSERT_EQ(0u, m_adaptor.PendingTransfers(sunlite.handle));
+  m_adaptor.SetSubmitError(0);
+  OLA_ASSERT_TRUE(sunlite.widget->SendDMX(DmxBuffer()));
+  OLA_ASSERT_EQ(1u, m_adaptor.PendingTransfers(sunlite.handle));
+}
+
+void AsyncUsbSenderTest::AddWidget(const string &name,
+                                   WidgetInterface *widget,
+                                   uint8_t *device,
+                                   unsigned int transfers_per_frame,
+                                   unsigned int slot_offset) {
+  OLA_ASSERT_TRUE_MSG(widget->Init(), name);
+  TestWidget test_widget;
+  test_widget.name = name;
+  test_widget.widget = widget;
+  test_widget.handle = FakeLibUsbAdaptor::FakeHandle(
+      FakeLibUsbAdaptor::FakeDevice(device));
+  test_widget.transfers_per_frame = transfers_per_frame;
+  test_widget.slot_offset = slot_offset;
+  test_widget.started = -1;
+  test_widget.transfers = 0;
+  test_widget.frames = 0;
+  test_widget.frames_in_duration = 0;
+  test_widget.max_latency = 0;
+  test_widget.last_frame = 0;
+  test_widget.overlapped = false;
+  m_widgets.push_back(test_widget);
+  if (transfers_per_frame > m_max_transfers_per_frame) {
+    m_max_transfers_per_frame = transfers_per_frame;
+  }
+}
+
+/*
+ * Send a frame to all widgets every input_period, each transfer takes
+ * wire_time to complete.
+ */
+void AsyncUsbSenderTest::Run(int64_t duration, int64_t input_period,
+                             int64_t wire_time) {
+  unsigned int frame = 0;
+  for (m_now = 0; m_now < duration; m_now += STEP) {
+    UpdateTransfers(wire_time);
+    if (m_now % input_period == 0) {
+      SendFrame(++frame);
+    }
+  }
+  vector<TestWidget>::iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    iter->frames_in_duration = iter->frames;
+  }
+
+  // Let the last frame go out, after the one in flight.
+  const int64_t drain_time = 3 * m_max_transfers_per_frame * wire_time;
+  for (; m_now < duration + drain_time; m_now += STEP) {
+    UpdateTransfers(wire_time);
+  }
+}
+
+/*
+ * Send a frame where every slot is the low byte of the frame number.
+ */
+void AsyncUsbSenderTest::SendFrame(unsigned int frame) {
+  const uint8_t id = frame & 0xff;
+  DmxBuffer buffer;
+  buffer.SetRangeToValue(0, id, ola::DMX_UNIVERSE_SIZE);
+  m_sent[id] = m_now;
+
+  vector<TestWidget>::iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    OLA_ASSERT_TRUE_MSG(iter->widget->SendDMX(buffer), iter->name);
+  }
+  UpdateTransfers(0);
+}
+
+/*
+ * Complete the transfers which have been on the wire for wire_time, and note
+ * when the new ones start.
+ */
+void AsyncUsbSenderTest::UpdateTransfers(int64_t wire_time) {
+  vector<TestWidget>::iterator iter = m_widgets.begin();
+  for (; iter != m_widgets.end(); ++iter) {
+    if (wire_time && iter->started >= 0 &&
+        m_now - iter->started >= wire_time) {
+      const struct libusb_transfer *transfer =
+          m_adaptor.PendingTransfer(iter->handle);
+      const uint8_t id = transfer->buffer[iter->slot_offset];
+      iter->transfers++;
+      iter->started = -1;
+      OLA_ASSERT_TRUE(m_adaptor.CompleteTransfer(iter->handle));
+
+      // The transfer which ends a frame.
+      if (iter->transfers % iter->transfers_per_frame == 0) {
+        iter->frames++;
+        iter->last_frame = id;
+        if (m_now - m_sent[id] > iter->max_latency) {
+          iter->max_latency = m_now - m_sent[id];
+        }
+      }
+    }
+
+    const unsigned int pending = m_adaptor.PendingTransfers(iter->handle);
+    if (pending > 1) {
+      iter->overlapped = true;
+    }
+    if (pending && iter->started < 0) {
+      iter->started = m_now;
+    }
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FakeLibUsbAdaptor.cpp
+ * A LibUsbAdaptor which doesn't talk to any hardware, used for testing.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/usbdmx/FakeLibUsbAdaptor.h"
+
+#include <libusb.h>
+#include <string.h>
+#include <deque>
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+FakeLibUsbAdaptor::FakeLibUsbAdaptor()
+    : m_submit_error(0) {
+  memset(&m_endpoint, 0, sizeof(m_endpoint));
+  m_endpoint.bLength = LIBUSB_DT_ENDPOINT_SIZE;
+  m_endpoint.bDescriptorType = LIBUSB_DT_ENDPOINT;
+  m_endpoint.bEndpointAddress = 0x02;
+  m_endpoint.bmAttributes = LIBUSB_TRANSFER_TYPE_BULK;
+  m_endpoint.wMaxPacketSize = 64;
+
+  memset(&m_interface_descriptor, 0, sizeof(m_interface_descriptor));
+  m_interface_descriptor.bLength = LIBUSB_DT_INTERFACE_SIZE;
+  m_interface_descriptor.bDescriptorType = LIBUSB_DT_INTERFACE;
+  m_interface_descriptor.bNumEndpoints = 1;
+  m_interface_descriptor.endpoint = &m_endpoint;
+
+  m_interface.altsetting = &m_interface_descriptor;
+  m_interface.num_altsetting = 1;
+
+  memset(&m_config, 0, sizeof(m_config));
+  m_config.bLength = LIBUSB_DT_CONFIG_SIZE;
+  m_config.bDescriptorType = LIBUSB_DT_CONFIG;
+  m_config.bNumInterfaces = 1;
+  m_config.bConfigurationValue = 1;
+  m_config.interface = &m_interface;
+}
+
+bool FakeLibUsbAdaptor::OpenDevice(libusb_device *usb_device,
+                                   libusb_device_handle **usb_handle) {
+  *usb_handle = FakeHandle(usb_device);
+  return true;
+}
+
+bool FakeLibUsbAdaptor::OpenDeviceAndClaimInterface(
+    libusb_device *usb_device,
+    int,
+    libusb_device_handle **usb_handle) {
+  return OpenDevice(usb_device, usb_handle);
+}
+
+int FakeLibUsbAdaptor::GetConfigDescriptor(
+    libusb_device*,
+    uint8_t config_index,
+    struct libusb_config_descriptor **config) {
+  if (config_index != 0) {
+    return LIBUSB_ERROR_NOT_FOUND;
+  }
+  *config = &m_config;
+  return 0;
+}
+
+int FakeLibUsbAdaptor::SubmitTransfer(struct libusb_transfer *transfer) {
+  if (m_submit_error) {
+    return m_submit_error;
+  }
+  m_transfers.push_back(transfer);
+  return 0;
+}
+
+int FakeLibUsbAdaptor::ControlTransfer(libusb_device_handle*,
+                                       uint8_t,
+                                       uint8_t,
+                                       uint16_t,
+                                       uint16_t,
+                                       unsigned char*,
+                                       uint16_t wLength,
+                                       unsigned int) {
+  return wLength;
+}
+
+int FakeLibUsbAdaptor::BulkTransfer(struct libusb_device_handle*,
+                                    unsigned char,
+                                    unsigned char*,
+                                    int length,
+                                    int *transferred,
+                                    unsigned int) {
+  *transferred = length;
+  return 0;
+}
+
+int FakeLibUsbAdaptor::InterruptTransfer(libusb_device_handle*,
+                                         unsigned char,
+                                         unsigned char*,
+                                         int length,
+                                         int *actual_length,
+                                         unsigned int) {
+  *actual_length = length;
+  return 0;
+}
+
+unsigned int FakeLibUsbAdaptor::PendingTransfers(
+    libusb_device_handle *handle) const {
+  unsigned int count = 0;
+  TransferQueue::const_iterator iter = m_transfers.begin();
+  for (; iter != m_transfers.end(); ++iter) {
+    if ((*iter)->dev_handle == handle) {
+      count++;
+    }
+  }
+  return count;
+}
+
+const struct libusb_transfer *FakeLibUsbAdaptor::PendingTransfer(
+    libusb_device_handle *handle) const {
+  TransferQueue::const_iterator iter = m_transfers.begin();
+  for (; iter != m_transfers.end(); ++iter) {
+    if ((*iter)->dev_handle == handle) {
+      return *iter;
+    }
+  }
+  return NULL;
+}
+
+bool FakeLibUsbAdaptor::CompleteTransfer(libusb_device_handle *handle,
+                                         libusb_transfer_status status) {
+  TransferQueue::iterator iter = FindTransfer(handle);
+  if (iter == m_transfers.end()) {
+    return false;
+  }
+  struct libusb_transfer *transfer = *iter;
+  // The callback may submit another transfer, so remove this one first.
+  m_transfers.erase(iter);
+  transfer->status = status;
+  transfer->actual_length =
+      status == LIBUSB_TRANSFER_COMPLETED ? transfer->length : 0;
+  transfer->callback(transfer);
+  return true;
+}
+
+FakeLibUsbAdaptor::TransferQueue::iterator FakeLibUsbAdaptor::FindTransfer(
+    libusb_device_handle *handle) {
+  TransferQueue::iterator iter = m_transfers.begin();
+  for (; iter != m_transfers.end(); ++iter) {
+    if ((*iter)->dev_handle == handle) {
+      return iter;
+    }
+  }
+  return m_transfers.end();
+}
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,189 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FakeLibUsbAdaptor.h
+ * A LibUsbAdaptor which doesn't talk to any hardware, used for testing.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_USBDMX_FAKELIBUSBADAPTOR_H_
+#define PLUGINS_USBDMX_FAKELIBUSBADAPTOR_H_
+
+#include <libusb.h>
+#include <deque>
+#include <string>
+
+#include "libs/usb/LibUsbAdaptor.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+/**
+ * @brief A LibUsbAdaptor for testing widgets without hardware.
+ *
+ * Any pointer can be used as a libusb_device, and opening it returns the same
+ * pointer as the libusb_device_handle. Asynchronous transfers are queued
+ * rather than submitted, and the test completes them with CompleteTransfer(),
+ * which runs the callback on the calling thread, just as the LibUsbThread
+ * would. Synchronous transfers always succeed.
+ *
+ * Every fake device has a single configuration with one interface, which has
+ * a bulk OUT endpoint at 0x02.
+ *
+ * The transfer memory and the Fill methods come from BaseLibUsbAdaptor, none
+ * of these need a libusb context.
+ */
+class FakeLibUsbAdaptor : public ola::usb::BaseLibUsbAdaptor {
+ public:
+  FakeLibUsbAdaptor();
+
+  /**
+   * @brief Return a libusb_device for a fake device.
+   * @param id any address that is unique to the device.
+   */
+  static libusb_device *FakeDevice(void *id) {
+    return reinterpret_cast<libusb_device*>(id);
+  }
+
+  /**
+   * @brief The handle returned when a fake device is opened.
+   */
+  static libusb_device_handle *FakeHandle(libusb_device *usb_device) {
+    return reinterpret_cast<libusb_device_handle*>(usb_device);
+  }
+
+  // Device handling and enumeration
+  libusb_device* RefDevice(libusb_device *dev) { return dev; }
+  void UnrefDevice(libusb_device*) {}
+
+  bool OpenDevice(libusb_device *usb_device,
+                  libusb_device_handle **usb_handle);
+  bool OpenDeviceAndClaimInterface(libusb_device *usb_device,
+                                   int interface,
+                                   libusb_device_handle **usb_handle);
+  void Close(libusb_device_handle*) {}
+
+  int SetConfiguration(libusb_device_handle*, int) { return 0; }
+  int ClaimInterface(libusb_device_handle*, int) { return 0; }
+  int DetachKernelDriver(libusb_device_handle*, int) { return 0; }
+
+  // USB descriptors
+  int GetDeviceDescriptor(libusb_device*, struct libusb_device_descriptor*) {
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+  }
+
+  int GetActiveConfigDescriptor(libusb_device*,
+                                struct libusb_config_descriptor**) {
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+  }
+
+  int GetConfigDescriptor(libusb_device*, uint8_t config_index,
+                          struct libusb_config_descriptor **config);
+
+  void FreeConfigDescriptor(struct libusb_config_descriptor*) {}
+
+  bool GetStringDescriptor(libusb_device_handle*, uint8_t, std::string*) {
+    return false;
+  }
+
+  // Asynchronous device I/O
+  int SubmitTransfer(struct libusb_transfer *transfer);
+
+  /**
+   * @brief Cancelling isn't supported, the test should complete all the
+   *   transfers before destroying the widgets.
+   */
+  int CancelTransfer(struct libusb_transfer*) {
+    return LIBUSB_ERROR_NOT_FOUND;
+  }
+
+  // Synchronous device I/O
+  int ControlTransfer(libusb_device_handle *dev_handle,
+                      uint8_t bmRequestType,
+                      uint8_t bRequest,
+                      uint16_t wValue,
+                      uint16_t wIndex,
+                      unsigned char *data,
+                      uint16_t wLength,
+                      unsigned int timeout);
+
+  int BulkTransfer(struct libusb_device_handle *dev_handle,
+                   unsigned char endpoint,
+                   unsigned char *data,
+                   int length,
+                   int *transferred,
+                   unsigned int timeout);
+
+  int InterruptTransfer(libusb_device_handle *dev_handle,
+                        unsigned char endpoint,
+                        unsigned char *data,
+                        int length,
+                        int *actual_length,
+                        unsigned int timeout);
+
+  ola::usb::USBDeviceID GetDeviceId(libusb_device*) const {
+    return ola::usb::USBDeviceID(0, 0);
+  }
+
+  // Methods used for testing
+
+  /**
+   * @brief Make SubmitTransfer() fail with this error, 0 for success.
+   */
+  void SetSubmitError(int error) { m_submit_error = error; }
+
+  /**
+   * @brief The number of transfers waiting to complete for a device.
+   */
+  unsigned int PendingTransfers(libusb_device_handle *handle) const;
+
+  /**
+   * @brief The oldest transfer waiting to complete for a device.
+   * @returns the transfer, or NULL if there isn't one.
+   */
+  const struct libusb_transfer *PendingTransfer(
+      libusb_device_handle *handle) const;
+
+  /**
+   * @brief Complete the oldest transfer for a device, and run the callback.
+   * @param handle the device handle.
+   * @param status the status of the transfer.
+   * @returns false if there wasn't a transfer to complete.
+   */
+  bool CompleteTransfer(
+      libusb_device_handle *handle,
+      libusb_transfer_status status = LIBUSB_TRANSFER_COMPLETED);
+
+ private:
+  typedef std::deque<struct libusb_transfer*> TransferQueue;
+
+  TransferQueue m_transfers;
+  int m_submit_error;
+
+  struct libusb_endpoint_descriptor m_endpoint;
+  struct libusb_interface_descriptor m_interface_descriptor;
+  struct libusb_interface m_interface;
+  struct libusb_config_descriptor m_config;
+
+  TransferQueue::iterator FindTransfer(libusb_device_handle *handle);
+
+  DISALLOW_COPY_AND_ASSIGN(FakeLibUsbAdaptor);
+};
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBDMX_FAKELIBUSBADAPTOR_H_
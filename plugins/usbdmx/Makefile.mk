@@ -101,6 +101,20 @@ plugins_usbdmx_libolausbdmx_la_CXXFLAGS = $(COMMON_CXXFLAGS) $(libusb_CFLAGS)
 plugins_usbdmx_libolausbdmx_la_LIBADD = \
     olad/plugin_api/libolaserverplugininterface.la \
     plugins/usbdmx/libolausbdmxwidget.la
+
+# TESTS
+##################################################
+test_programs += plugins/usbdmx/UsbDmxTester
+
+plugins_usbdmx_UsbDmxTester_SOURCES = \
+    plugins/usbdmx/AsyncUsbSenderTest.cpp \
+    plugins/usbdmx/FakeLibUsbAdaptor.cpp \
+    plugins/usbdmx/FakeLibUsbAdaptor.h
+plugins_usbdmx_UsbDmxTester_CXXFLAGS = $(COMMON_TESTING_FLAGS) \
+                                       $(libusb_CFLAGS)
+plugins_usbdmx_UsbDmxTester_LDADD = $(COMMON_TESTING_LIBS) \
+                                    $(libusb_LIBS) \
+                                    plugins/usbdmx/libolausbdmxwidget.la
 endif
 
 EXTRA_DIST += \
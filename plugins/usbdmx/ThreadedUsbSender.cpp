@@ -71,7 +71,7 @@ void *ThreadedUsbSender::Run() {
 
     {
       ola::thread::MutexLocker locker(&m_data_mutex);
-      buffer.Set(m_buffer);
+      buffer = m_buffer;
     }
 
     if (buffer.Size()) {
@@ -90,9 +90,9 @@ void *ThreadedUsbSender::Run() {
 }
 
 bool ThreadedUsbSender::SendDMX(const DmxBuffer &buffer) {
-  // Store the new data in the shared buffer.
+  // Share the new data with the sender thread, this doesn't copy the slots.
   ola::thread::MutexLocker locker(&m_data_mutex);
-  m_buffer.Set(buffer);
+  m_buffer = buffer;
   return true;
 }
 }  // namespace usbdmx